@@ -598,3 +598,159 @@ int lwfs_verify_caps(
     return rc; 
 }
 
+
+/**
+ *  @brief Register a server-side cache of verified capabilities. 
+ *
+ *  Servers that cache the result of \ref lwfs_verify_caps (e.g., 
+ *  the storage server) call this method once at startup. When 
+ *  an ACL changes, the authorization server sends a 
+ *  \ref lwfs_revoke_caps request to every registered service so 
+ *  the service can drop the affected caps from its cache. 
+ * 
+ * @param authr_svc @input the authorization service.
+ * @param svc    @input the service that caches verified caps.
+ * @param req    @output the request handle (used to test for completion). 
+ */
+int lwfs_register_cap_cache(
+		const lwfs_service *authr_svc,
+		const lwfs_service *svc,
+		lwfs_request *req)
+{
+	int rc = LWFS_OK; 
+	lwfs_register_cap_cache_args args; 
+
+	/* initialize client */
+	client_init();
+
+	/* copy arguments to the args structure */
+	args.svc = (lwfs_service *)svc; 
+
+	/* call the remote procedure */
+	rc = lwfs_call_rpc(authr_svc, LWFS_OP_REGISTER_CAP_CACHE, 
+			&args, NULL, 0, NULL, req);
+	if (rc != LWFS_OK) {
+		log_error(authr_debug_level, "unable to call remote method");
+	}
+
+	return rc; 
+}
+
+/**
+ *  @brief Revoke the cached caps for a container. 
+ *
+ *  The authorization server calls this method on each service 
+ *  registered with \ref lwfs_register_cap_cache when the ACLs of
+ *  a container change. The receiving service removes every cached 
+ *  cap for \em cid that enables one of the operations in 
+ *  \em container_op. 
+ * 
+ * @param svc    @input the service that caches verified caps.
+ * @param cid    @input the container ID.
+ * @param container_op @input the revoked operations (or'd together).
+ * @param generation @input the key generation of the authorization server. 
+ * @param req    @output the request handle (used to test for completion). 
+ */
+int lwfs_revoke_caps(
+		const lwfs_service *svc,
+		const lwfs_cid cid,
+		const lwfs_container_op container_op,
+		const unsigned int generation,
+		lwfs_request *req)
+{
+	int rc = LWFS_OK; 
+	lwfs_revoke_caps_args args; 
+
+	/* initialize client */
+	client_init();
+
+	/* copy arguments to the args structure */
+	args.cid = cid; 
+	args.container_op = container_op; 
+	args.generation = generation; 
+
+	/* call the remote procedure */
+	rc = lwfs_call_rpc(svc, LWFS_OP_REVOKE_CAPS, 
+			&args, NULL, 0, NULL, req);
+	if (rc != LWFS_OK) {
+		log_error(authr_debug_level, "unable to call remote method");
+	}
+
+	return rc; 
+}
+
+/**
+ *  @brief Get the key used to verify caps. 
+ *
+ *  Services that verify caps locally (instead of calling 
+ *  \ref lwfs_verify_caps for every operation) call this method once 
+ *  at startup.  The authorization server also registers \em svc 
+ *  to receive \ref lwfs_revoke_caps and \ref lwfs_set_cap_key
+ *  requests.  The authorization server only hands out the key if 
+ *  it was started with key sharing enabled and \em svc is the 
+ *  caller and one of the servers it trusts with the key; otherwise 
+ *  the remote method returns \ref LWFS_ERR_ACCESS. 
+ * 
+ * @param authr_svc @input the authorization service.
+ * @param svc    @input the service that verifies caps. 
+ * @param result @output the key information. 
+ * @param req    @output the request handle (used to test for completion). 
+ */
+int lwfs_get_cap_key(
+		const lwfs_service *authr_svc,
+		const lwfs_service *svc,
+		lwfs_cap_key_info *result,
+		lwfs_request *req)
+{
+	int rc = LWFS_OK; 
+	lwfs_get_cap_key_args args; 
+
+	/* initialize client */
+	client_init();
+
+	/* copy arguments to the args structure */
+	args.svc = (lwfs_service *)svc; 
+
+	/* call the remote procedure */
+	rc = lwfs_call_rpc(authr_svc, LWFS_OP_GET_CAP_KEY, 
+			&args, NULL, 0, result, req);
+	if (rc != LWFS_OK) {
+		log_error(authr_debug_level, "unable to call remote method");
+	}
+
+	return rc; 
+}
+
+/**
+ *  @brief Replace the key used to verify caps. 
+ *
+ *  The authorization server calls this method on each service 
+ *  registered with \ref lwfs_get_cap_key after it rotates its key. 
+ * 
+ * @param svc    @input the service that verifies caps. 
+ * @param info   @input the new key information. 
+ * @param req    @output the request handle (used to test for completion). 
+ */
+int lwfs_set_cap_key(
+		const lwfs_service *svc,
+		const lwfs_cap_key_info *info,
+		lwfs_request *req)
+{
+	int rc = LWFS_OK; 
+	lwfs_set_cap_key_args args; 
+
+	/* initialize client */
+	client_init();
+
+	/* copy arguments to the args structure */
+	args.info = (lwfs_cap_key_info *)info; 
+
+	/* call the remote procedure */
+	rc = lwfs_call_rpc(svc, LWFS_OP_SET_CAP_KEY, 
+			&args, NULL, 0, NULL, req);
+	if (rc != LWFS_OK) {
+		log_error(authr_debug_level, "unable to call remote method");
+	}
+
+	return rc; 
+}
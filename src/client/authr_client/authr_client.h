@@ -284,6 +284,11 @@ extern "C" {
 	 * lists, the implementation first grants access to the users 
 	 * in the set list, then removes access from users in the unset list. 
 	 *
+	 * @note Revocation is asynchronous.  Storage and naming servers 
+	 * that cache or locally verify caps learn about removed users 
+	 * after the call returns, so a cap issued before the change can 
+	 * still work there for a while (up to a cap-cache TTL). 
+	 *
 	 * @param authr_svc @input_type  Points to the descriptor for the authorization service. 
 	 * @param txn_id @input_type  If not null, points to a structure that 
      *                       holds information about the transaction. 
@@ -372,6 +377,108 @@ extern "C" {
 			const int num_caps,
 			lwfs_request *req);
 
+	/**
+	 *  @brief Register a server-side cache of verified capabilities. 
+	 *
+	 *  @ingroup authr_api
+	 *
+	 *  Servers that cache the results of <tt>\ref lwfs_verify_caps</tt>
+	 *  register the cache with the authorization service.  When the ACLs 
+	 *  of a container change, the authorization service calls 
+	 *  <tt>\ref lwfs_revoke_caps</tt> on every registered service. 
+	 * 
+	 * @param authr_svc @input_type  Points to the descriptor for the authorization service. 
+	 * @param svc    @input_type  Points to the descriptor of the service 
+	 *                       that caches verified caps. 
+	 * @param req    @output_type Points to the request structure. 
+	 *
+     * @return <b>\ref LWFS_OK</b> Indicates success. 
+	 * @return <b>\ref LWFS_ERR_RPC</b> Indicates an failure in the 
+	 *                                  communication library. 
+	 */
+	extern int lwfs_register_cap_cache(
+			const lwfs_service *authr_svc,
+			const lwfs_service *svc,
+			lwfs_request *req);
+
+	/**
+	 *  @brief Revoke cached capabilities for a container. 
+	 *
+	 *  @ingroup authr_api
+	 *
+	 *  The authorization service calls this function on each 
+	 *  registered cap cache after it changes the ACLs of a container. 
+	 *  The receiving service drops all cached caps for \em cid that 
+	 *  enable any of the operations in \em container_op. 
+	 * 
+	 * @param svc    @input_type  Points to the descriptor of the service 
+	 *                       that caches verified caps. 
+	 * @param cid    @input_type  The ID of the container. 
+	 * @param container_op @input_type  The revoked operations (or'd together).
+	 * @param generation @input_type  The key generation of the authorization 
+	 *                       service when it revoked the operations. 
+	 * @param req    @output_type Points to the request structure. 
+	 *
+     * @return <b>\ref LWFS_OK</b> Indicates success. 
+	 * @return <b>\ref LWFS_ERR_RPC</b> Indicates an failure in the 
+	 *                                  communication library. 
+	 */
+	extern int lwfs_revoke_caps(
+			const lwfs_service *svc,
+			const lwfs_cid cid,
+			const lwfs_container_op container_op,
+			const unsigned int generation,
+			lwfs_request *req);
+
+
+	/**
+	 *  @brief Get the key used to verify capabilities. 
+	 *
+	 *  @ingroup authr_api
+	 *
+	 *  Servers that verify caps without calling the authorization 
+	 *  service fetch the key at startup.  The authorization service 
+	 *  registers \em svc to receive <tt>\ref lwfs_revoke_caps</tt> and 
+	 *  <tt>\ref lwfs_set_cap_key</tt> requests. 
+	 * 
+	 * @param authr_svc @input_type  Points to the descriptor for the authorization service. 
+	 * @param svc    @input_type  Points to the descriptor of the service 
+	 *                       that verifies caps. 
+	 * @param result @output_type The key information. 
+	 * @param req    @output_type Points to the request structure. 
+	 *
+     * @return <b>\ref LWFS_OK</b> Indicates success. 
+	 * @return <b>\ref LWFS_ERR_RPC</b> Indicates an failure in the 
+	 *                                  communication library. 
+	 */
+	extern int lwfs_get_cap_key(
+			const lwfs_service *authr_svc,
+			const lwfs_service *svc,
+			lwfs_cap_key_info *result,
+			lwfs_request *req);
+
+	/**
+	 *  @brief Replace the key used to verify capabilities. 
+	 *
+	 *  @ingroup authr_api
+	 *
+	 *  The authorization service calls this function on each 
+	 *  registered service after it rotates its key. 
+	 * 
+	 * @param svc    @input_type  Points to the descriptor of the service 
+	 *                       that verifies caps. 
+	 * @param info   @input_type  The new key information. 
+	 * @param req    @output_type Points to the request structure. 
+	 *
+     * @return <b>\ref LWFS_OK</b> Indicates success. 
+	 * @return <b>\ref LWFS_ERR_RPC</b> Indicates an failure in the 
+	 *                                  communication library. 
+	 */
+	extern int lwfs_set_cap_key(
+			const lwfs_service *svc,
+			const lwfs_cap_key_info *info,
+			lwfs_request *req);
+
 
 #else /* K&R C */
 
@@ -414,3 +414,78 @@ int lwfs_verify_caps_sync(
     return rc;
 }
 
+
+/**
+ *  @brief Register a server-side cache of verified capabilities. 
+ *
+ * @param authr_svc @input the authorization service.
+ * @param svc    @input the service that caches verified caps.
+ */
+int lwfs_register_cap_cache_sync(
+		const lwfs_service *authr_svc,
+		const lwfs_service *svc)
+{
+    int rc = LWFS_OK;
+    int rc2 = LWFS_OK;
+    lwfs_request req; 
+
+    /* register the cache with the authr server */
+    rc = lwfs_register_cap_cache(authr_svc, svc, &req); 
+    if (rc != LWFS_OK) {
+	log_error(authr_debug_level, "could not call lwfs_register_cap_cache: %s",
+		lwfs_err_str(rc));
+	return rc;
+    }
+
+    /* wait for response from server */
+    rc2 = lwfs_wait(&req, &rc); 
+
+    if (rc2 != LWFS_OK) {
+	log_error(authr_debug_level, "error waiting on request: %s",
+		lwfs_err_str(rc2));
+	return rc2; 
+    }
+
+    if (rc != LWFS_OK) {
+	log_warn(authr_debug_level, "error in remote method: %s",
+		lwfs_err_str(rc));
+	return rc; 
+    }
+
+    return rc;
+}
+
+int lwfs_get_cap_key_sync(
+		const lwfs_service *authr_svc,
+		const lwfs_service *svc,
+		lwfs_cap_key_info *result)
+{
+    int rc = LWFS_OK;
+    int rc2 = LWFS_OK;
+    lwfs_request req; 
+
+    /* get the key from the authr server */
+    rc = lwfs_get_cap_key(authr_svc, svc, result, &req); 
+    if (rc != LWFS_OK) {
+	log_error(authr_debug_level, "could not call lwfs_get_cap_key: %s",
+		lwfs_err_str(rc));
+	return rc;
+    }
+
+    /* wait for response from server */
+    rc2 = lwfs_wait(&req, &rc); 
+
+    if (rc2 != LWFS_OK) {
+	log_error(authr_debug_level, "error waiting on request: %s",
+		lwfs_err_str(rc2));
+	return rc2; 
+    }
+
+    if (rc != LWFS_OK) {
+	log_warn(authr_debug_level, "error in remote method: %s",
+		lwfs_err_str(rc));
+	return rc; 
+    }
+
+    return rc;
+}
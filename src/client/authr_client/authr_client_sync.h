@@ -178,6 +178,11 @@ extern "C" {
 	 * lists, the implementation first grants access to the users 
 	 * in the set list, then removes access from users in the unset list. 
 	 *
+	 * @note Revocation is asynchronous.  Storage and naming servers 
+	 * that cache or locally verify caps learn about removed users 
+	 * after the call returns, so a cap issued before the change can 
+	 * still work there for a while (up to a cap-cache TTL). 
+	 *
 	 * @param txn_id @input_type  If not null, points to a structure that 
      *                       holds information about the transaction. 
 	 * @param cid    @input_type  The ID of the container. 
@@ -260,6 +265,42 @@ extern "C" {
 			const lwfs_cap *caps,
 			const int num_caps);
 
+	/**
+	 *  @brief Register a server-side cache of verified capabilities. 
+	 *
+	 *  @ingroup authr_api
+	 *
+	 * @param authr_svc @input_type  Points to the descriptor for the authorization service. 
+	 * @param svc    @input_type  Points to the descriptor of the service 
+	 *                       that caches verified caps. 
+	 *
+     * @return <b>\ref LWFS_OK</b> Indicates success. 
+	 * @return <b>\ref LWFS_ERR_RPC</b> Indicates an failure in the 
+	 *                                  communication library. 
+	 */
+	extern int lwfs_register_cap_cache_sync(
+			const lwfs_service *authr_svc,
+			const lwfs_service *svc);
+
+	/**
+	 *  @brief Get the key used to verify capabilities. 
+	 *
+	 *  @ingroup authr_api
+	 *
+	 * @param authr_svc @input_type  Points to the descriptor for the authorization service. 
+	 * @param svc    @input_type  Points to the descriptor of the service 
+	 *                       that verifies caps. 
+	 * @param result @output_type The key information. 
+	 *
+     * @return <b>\ref LWFS_OK</b> Indicates success. 
+	 * @return <b>\ref LWFS_ERR_RPC</b> Indicates an failure in the 
+	 *                                  communication library. 
+	 */
+	extern int lwfs_get_cap_key_sync(
+			const lwfs_service *authr_svc,
+			const lwfs_service *svc,
+			lwfs_cap_key_info *result);
+
 
 #else /* K&R C */
 
@@ -475,6 +475,75 @@ int lwfs_create_file(
 	return rc;
 }
 
+/**
+ * @brief Create many files in one directory.
+ *
+ * The \b lwfs_create_files method creates a file entry for 
+ * each name in one request.  Like \b lwfs_create_file, the 
+ * client creates the storage objects first (see 
+ * \b lwfs_create_objs_sync).
+ *
+ * @param txn_id @input transaction ID.
+ * @param parent @input the parent directory.
+ * @param names  @input the names of the new files.
+ * @param objs   @input the object to associate with each file.
+ * @param count  @input the number of files (at most \ref LWFS_CREATE_FILES_MAX).
+ * @param cap    @input the capability that allows the operation.
+ * @param result @output the files created and the error of the first 
+ *                       file that failed (free with xdr_lwfs_create_files_res).
+ * @param req    @output the request handle (used to test for completion)
+ */
+int lwfs_create_files(
+		const lwfs_service *svc,
+		const lwfs_txn *txn_id,
+		const lwfs_ns_entry *parent,
+		const char **names,
+		const lwfs_obj *objs,
+		const int count,
+		const lwfs_cap *cap,
+		lwfs_create_files_res *result,
+		lwfs_request *req)
+{
+	int rc = LWFS_OK;
+	lwfs_create_files_args args;
+
+	log_debug(naming_debug_level, "starting lwfs_create_files(..., %d files, ...)",
+			count);
+
+	if ((count < 0) || (count > LWFS_CREATE_FILES_MAX)) {
+		log_error(naming_debug_level, "can not create %d files in one request", count);
+		return LWFS_ERR;
+	}
+
+	/* initialize the naming client (executed only once) */
+	naming_client_init(svc);
+
+	memset(&args, 0, sizeof(args));
+	args.txn_id = (lwfs_txn *)txn_id;
+	args.parent = (lwfs_ns_entry *)parent;
+	args.names.names_len = count;
+	args.names.names_val = (lwfs_name *)names;
+	args.objs.objs_len = count;
+	args.objs.objs_val = (lwfs_obj *)objs;
+	args.cap = (lwfs_cap *)cap;
+
+	/* make sure the result is zero'd out */
+	memset(result, 0, sizeof(lwfs_create_files_res));
+
+	/* call the remote procedure */
+	rc = lwfs_call_rpc(svc, LWFS_OP_CREATE_FILES,
+			&args, NULL, 0, result, req);
+	if (rc != LWFS_OK) {
+		log_error(naming_debug_level, "unable to call remote method: %s",
+				lwfs_err_str(rc));
+	}
+
+	log_debug(naming_debug_level, "finished lwfs_create_files(..., %d files, ...)",
+			count);
+
+	return rc;
+}
+
 /**
  * @brief Create a link.
  *
@@ -639,6 +708,66 @@ int lwfs_lookup(
 }
 
 
+/**
+ * @brief Resolve a path in one request.
+ *
+ * @param svc    @input Points to the naming service descriptor.
+ * @param txn_id @input the transaction ID.
+ * @param start  @input the directory to start from.
+ * @param names  @input the names on the path.
+ * @param num_names @input the number of names.
+ * @param caps   @input caps that allow us to read the directories.
+ * @param num_caps @input the number of caps.
+ * @param want_all @input return the entry of every name, not just the last.
+ * @param result @output the entries (the last one is the target) and where the server stopped.
+ * @param req @output the request handle (used to test for completion).
+ */
+int lwfs_resolve_path(
+		const lwfs_service *svc,
+		const lwfs_txn *txn_id,
+		const lwfs_ns_entry *start,
+		const char **names,
+		const int num_names,
+		const lwfs_cap *caps,
+		const int num_caps,
+		const lwfs_bool want_all,
+		lwfs_resolve_path_res *result,
+		lwfs_request *req)
+{
+	int rc = LWFS_OK;
+	lwfs_resolve_path_args args;
+
+	/* initialize the naming client (executed only once) */
+	naming_client_init(svc);
+
+	if ((num_names <= 0) || (num_names > LWFS_RESOLVE_MAX_DEPTH)) {
+		log_error(naming_debug_level, "can not resolve %d names", num_names);
+		return LWFS_ERR;
+	}
+
+	memset(&args, 0, sizeof(args));
+	args.txn_id = (lwfs_txn *)txn_id;
+	args.start = (lwfs_ns_entry *)start;
+	args.names.names_len = num_names;
+	args.names.names_val = (lwfs_name *)names;
+	args.want_all = want_all;
+	args.caps.lwfs_cap_array_len = num_caps;
+	args.caps.lwfs_cap_array_val = (lwfs_cap *)caps;
+
+	/* initialize the result */
+	memset(result, 0, sizeof(lwfs_resolve_path_res));
+
+	/* call the remote procedure */
+	rc = lwfs_call_rpc(svc, LWFS_OP_RESOLVE_PATH, &args, NULL, 0, result, req);
+	if (rc != LWFS_OK) {
+		log_error(naming_debug_level, "unable to call remote method: %s",
+				lwfs_err_str(rc));
+	}
+
+	return rc;
+}
+
+
 /**
  * @brief Read the contents of a directory.
  *
@@ -687,3 +816,58 @@ int lwfs_list_dir(
 
 	return rc;
 }
+
+/**
+ * @brief Read one page of the contents of a directory.
+ *
+ * The \b lwfs_list_dir_page method returns up to \em max_entries 
+ * entries of the parent directory, in name order, starting after 
+ * \em cookie.  Pass "" to get the first page and the cookie of 
+ * the result to get the next one, until \em result->eof is set.
+ *
+ * @param parent      @input the parent directory.
+ * @param cookie      @input where to start ("" for the first page).
+ * @param max_entries @input the most entries to return (0 for the server's limit).
+ * @param names_only  @input only return the names and oids (cheaper on the server).
+ * @param pattern     @input only return names that match this fnmatch(3) pattern (NULL for all).
+ * @param cap         @input the capability that allows us to read the contents of the parent.
+ * @param result      @output space for the result (free with xdr_lwfs_list_dir_page_res).
+ * @param req         @output the request handle (used to test for completion).
+ */
+int lwfs_list_dir_page(
+		const lwfs_service *svc,
+		const lwfs_ns_entry *parent,
+		const char *cookie,
+		const int max_entries,
+		const lwfs_bool names_only,
+		const char *pattern,
+		const lwfs_cap *cap,
+		lwfs_list_dir_page_res *result,
+		lwfs_request *req)
+{
+	int rc = LWFS_OK;
+	lwfs_list_dir_page_args args;
+
+	/* initialize the naming client (executed only once) */
+	naming_client_init(svc);
+
+	memset(&args, 0, sizeof(args));
+	args.parent = (lwfs_ns_entry *)parent;
+	args.cookie = (char *)((cookie)? cookie : "");
+	args.max_entries = max_entries;
+	args.names_only = names_only;
+	args.pattern = (char *)((pattern)? pattern : "");
+	args.cap = (lwfs_cap *)cap;
+
+	/* initialize the result */
+	memset(result, 0, sizeof(lwfs_list_dir_page_res));
+
+	/* call the remote procedure */
+	rc = lwfs_call_rpc(svc, LWFS_OP_LIST_DIR_PAGE, &args, NULL, 0, result, req);
+	if (rc != LWFS_OK) {
+		log_error(naming_debug_level, "unable to call remote method: %s",
+				lwfs_err_str(rc));
+	}
+
+	return rc;
+}
@@ -352,6 +352,46 @@ extern "C" {
 			lwfs_ns_entry *result, 
 			lwfs_request *req);
 
+	/**
+	 * @brief Create many files in one directory.
+	 *
+	 * @ingroup naming_api
+	 *
+	 * The \b lwfs_create_files method does what \ref lwfs_create_file 
+	 * does for a list of names in one request: the server checks the 
+	 * cap once and puts the entries in its database as one batch.  
+	 * Use it when one client creates many files at once (e.g., the 
+	 * files of an N-to-N checkpoint).  The client creates the storage 
+	 * objects first (\ref lwfs_create_objs_sync creates them in one 
+	 * request per storage server). 
+	 *
+	 * The server creates the files in order and stops at the first one 
+	 * that fails.  \em result has the entries it created and, in 
+	 * \em result->rc, why it stopped.  Free it with 
+	 * <tt>xdr_free((xdrproc_t)xdr_lwfs_create_files_res, result)</tt>. 
+	 *
+	 * @param svc    @input_type Points to the naming service descriptor. 
+	 * @param txn_id @input_type transaction ID.
+	 * @param parent @input_type the parent directory.
+	 * @param names  @input_type the names of the new files. 
+	 * @param objs   @input_type the object to associate with each file. 
+	 * @param count  @input_type the number of files (at most 
+	 *                           \ref LWFS_CREATE_FILES_MAX). 
+	 * @param cap    @input_type the capability that allows the operation.
+	 * @param result @output_type the resulting file entries. 
+	 * @param req    @output_type the request handle (used to test for completion)
+	 */
+	extern int lwfs_create_files(
+			const lwfs_service *svc,
+			const lwfs_txn *txn_id,
+			const lwfs_ns_entry *parent, 
+			const char **names, 
+			const lwfs_obj *objs,
+			const int count,
+			const lwfs_cap *cap, 
+			lwfs_create_files_res *result, 
+			lwfs_request *req);
+
 
 
 	/** 
@@ -452,6 +492,45 @@ extern "C" {
 			lwfs_request *req);
 
 
+	/** 
+	 * @brief Resolve a path in one request.
+	 *
+	 * @ingroup naming_api
+	 *
+	 * The \b lwfs_resolve_path method looks up each name of a path
+	 * in turn, starting from \em start, on the server.  A cold lookup
+	 * of a deep path costs one round trip instead of one per name.
+	 * The caps have to cover the container of every directory on the
+	 * path (\ref LWFS_ERR_ACCESS otherwise).  The server stops at the
+	 * first name it can not resolve; \em result then has the entries
+	 * found before it, the error in \em result->rc, and the index of
+	 * the name in \em result->failed.  Free the result with
+	 * <tt>xdr_free((xdrproc_t)xdr_lwfs_resolve_path_res, result)</tt>.
+	 * 
+	 * @param svc    @input_type Points to the naming service descriptor. 
+	 * @param txn_id @input_type the transaction ID. 
+	 * @param start  @input_type the directory to start from.
+	 * @param names  @input_type the names on the path (at most \ref LWFS_RESOLVE_MAX_DEPTH). 
+	 * @param num_names @input_type the number of names. 
+	 * @param caps   @input_type caps that allow us to read the directories.
+	 * @param num_caps @input_type the number of caps.
+	 * @param want_all @input_type return the entry of every name, not just the last.
+	 * @param result @output_type the entries (the last one is the target) and where the server stopped.
+	 * @param req @output_type the request handle (used to test for completion).
+	 */
+	extern int lwfs_resolve_path(
+			const lwfs_service *svc,
+			const lwfs_txn *txn_id, 
+			const lwfs_ns_entry *start, 
+			const char **names, 
+			const int num_names, 
+			const lwfs_cap *caps, 
+			const int num_caps, 
+			const lwfs_bool want_all, 
+			lwfs_resolve_path_res *result,
+			lwfs_request *req);
+
+
 	/*
 	 * @remarks <b>Ron (12/01/2004):</b> We've considered a much more complex 
 	 *          version of this method that incorporates implicit locking and 
@@ -546,6 +625,7 @@ extern "C" {
 	 * @remark <b>Ron (12/7/2004):</b> I wonder if we should add another argument 
 	 *         to filter to results on the server.  For example, only return 
 	 *         results that match the provided regular expression. 
+	 *         (See \ref lwfs_list_dir_page.)
 	 */
 	extern int lwfs_list_dir(
 			const lwfs_service *svc,
@@ -554,6 +634,44 @@ extern "C" {
 			lwfs_ns_entry_array *result,
 			lwfs_request *req); 
 
+	/** 
+	 * @brief Read one page of the contents of a directory.
+	 *
+	 * @ingroup naming_api
+	 *
+	 * The \b lwfs_list_dir_page method returns up to \em max_entries 
+	 * entries of the parent directory, in name order, starting after 
+	 * \em cookie.  Unlike \ref lwfs_list_dir, the size of the reply 
+	 * does not grow with the directory, and the server filters the 
+	 * names with \em pattern. 
+	 *
+	 * @param svc         @input_type Points to the naming service descriptor. 
+	 * @param parent      @input_type the parent directory. 
+	 * @param cookie      @input_type where to start: "" for the first page, 
+	 *                                then the cookie of the previous result.
+	 * @param max_entries @input_type the most entries to return (0 for 
+	 *                                \ref LWFS_LIST_DIR_MAX_ENTRIES).
+	 * @param names_only  @input_type only return the names and oids of the 
+	 *                                entries (the server skips the inodes).
+	 * @param pattern     @input_type only return names that match this 
+	 *                                fnmatch(3) pattern (NULL for all).
+	 * @param cap         @input_type the capability that allows us to read the contents of the parent.
+	 * @param result      @output_type the entries, the next cookie and whether 
+	 *                                 this is the last page (free with 
+	 *                                 xdr_lwfs_list_dir_page_res).
+	 * @param req         @output_type the request handle (used to test for completion). 
+	 */
+	extern int lwfs_list_dir_page(
+			const lwfs_service *svc,
+			const lwfs_ns_entry *parent,
+			const char *cookie,
+			const int max_entries,
+			const lwfs_bool names_only,
+			const char *pattern,
+			const lwfs_cap *cap,
+			lwfs_list_dir_page_res *result,
+			lwfs_request *req); 
+
 	
 #else /* K&R C */
 
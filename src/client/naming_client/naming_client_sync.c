@@ -392,6 +392,53 @@ int lwfs_create_file_sync(
 	return rc; 
 }
 
+/** 
+ * @brief Create many files in one directory.
+ * 
+ * Blocking version of \b lwfs_create_files.  Returns the error 
+ * of the first file the server could not create; \em result 
+ * has the files it did create. 
+ */
+int lwfs_create_files_sync(
+		const lwfs_service *svc, 
+		const lwfs_txn *txn_id,
+		const lwfs_ns_entry *parent, 
+		const char **names, 
+		const lwfs_obj *objs,
+		const int count,
+		const lwfs_cap *cap, 
+		lwfs_create_files_res *result)
+{
+	int rc = LWFS_OK; 
+	int rc2 = LWFS_OK; 
+	lwfs_request req; 
+
+	/* call the asynchronous function */
+	rc = lwfs_create_files(svc, txn_id, parent, names, objs, count, cap, result, &req); 
+	if (rc != LWFS_OK) {
+		log_error(naming_debug_level, "could not call lwfs_create_files: %s",
+				lwfs_err_str(rc));
+		return rc; 
+	}
+
+	/* wait for completion */
+	rc2 = lwfs_wait(&req, &rc); 
+	if (rc2 != LWFS_OK) {
+		log_error(naming_debug_level, "error waiting for request: %s",
+				lwfs_err_str(rc2)); 
+		return rc2; 
+	}
+
+	if (rc != LWFS_OK) {
+		log_warn(naming_debug_level, "error in remote operation: %s",
+				lwfs_err_str(rc));
+		return rc; 
+	}
+
+	/* the server stops at the first file it can not create */
+	return result->rc; 
+}
+
 /** 
  * @brief Create a link. 
  * 
@@ -563,6 +610,56 @@ int lwfs_lookup_sync(
 }
 
 
+/** 
+ * @brief Resolve a path in one request.
+ *
+ * Blocking version of \b lwfs_resolve_path.  Returns the error 
+ * of the first name the server could not resolve; \em result 
+ * has the entries it did resolve. 
+ */
+int lwfs_resolve_path_sync(
+		const lwfs_service *svc,
+		const lwfs_txn *txn_id, 
+		const lwfs_ns_entry *start, 
+		const char **names, 
+		const int num_names, 
+		const lwfs_cap *caps, 
+		const int num_caps, 
+		const lwfs_bool want_all, 
+		lwfs_resolve_path_res *result)
+{
+    int rc = LWFS_OK; 
+    int rc2 = LWFS_OK; 
+    lwfs_request req; 
+
+    /* call the asynchronous function */
+    rc = lwfs_resolve_path(svc, txn_id, start, names, num_names, 
+	    caps, num_caps, want_all, result, &req); 
+    if (rc != LWFS_OK) {
+	log_error(naming_debug_level, "could not call lwfs_resolve_path: %s",
+		lwfs_err_str(rc));
+	return rc; 
+    }
+
+    /* wait for completion */
+    rc2 = lwfs_wait(&req, &rc); 
+    if (rc2 != LWFS_OK) {
+	log_error(naming_debug_level, "error waiting for request: %s",
+		lwfs_err_str(rc2)); 
+	return rc2; 
+    }
+
+    if (rc != LWFS_OK) {
+	log_debug(naming_debug_level, "error in remote operation..."
+		" could not resolve path: %s", lwfs_err_str(rc));
+	return rc; 
+    }
+
+    /* the server stops at the first name it can not resolve */
+    return result->rc; 
+}
+
+
 /** 
  * @brief Read the contents of a directory.
  *
@@ -616,3 +713,48 @@ int lwfs_list_dir_sync(
 
 	return rc; 
 }
+
+/** 
+ * @brief Read one page of the contents of a directory.
+ *
+ * Blocking version of \ref lwfs_list_dir_page. 
+ */
+int lwfs_list_dir_page_sync(
+		const lwfs_service *svc, 
+		const lwfs_ns_entry *parent,
+		const char *cookie,
+		const int max_entries,
+		const lwfs_bool names_only,
+		const char *pattern,
+		const lwfs_cap *cap,
+		lwfs_list_dir_page_res *result)
+{
+	int rc = LWFS_OK; 
+	int rc2 = LWFS_OK; 
+	lwfs_request req; 
+
+	/* call the asynchronous function */
+	rc = lwfs_list_dir_page(svc, parent, cookie, max_entries, 
+			names_only, pattern, cap, result, &req); 
+	if (rc != LWFS_OK) {
+		log_error(naming_debug_level, "could not call lwfs_list_dir_page: %s",
+				lwfs_err_str(rc));
+		return rc; 
+	}
+
+	/* wait for completion */
+	rc2 = lwfs_wait(&req, &rc); 
+	if (rc2 != LWFS_OK) {
+		log_error(naming_debug_level, "error waiting for request: %s",
+				lwfs_err_str(rc2)); 
+		return rc2; 
+	}
+
+	if (rc != LWFS_OK) {
+		log_warn(naming_debug_level, "error in remote operation: %s",
+				lwfs_err_str(rc));
+		return rc; 
+	}
+
+	return rc; 
+}
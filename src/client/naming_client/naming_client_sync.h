@@ -214,6 +214,26 @@ extern "C" {
 			const lwfs_cap *cap, 
 			lwfs_ns_entry *result);
 
+	/** 
+	 * @brief Create many files in one directory.
+	 *
+	 * @ingroup naming_api
+	 *
+	 * Blocking version of \ref lwfs_create_files. 
+	 *
+	 * @returns the error of the first file the server could not 
+	 *          create (\em result has the files it did create). 
+	 */
+	extern int lwfs_create_files_sync(
+			const lwfs_service *svc, 
+			const lwfs_txn *txn_id,
+			const lwfs_ns_entry *parent, 
+			const char **names, 
+			const lwfs_obj *objs,
+			const int count,
+			const lwfs_cap *cap, 
+			lwfs_create_files_res *result);
+
 	/** 
 	 * @brief Create a link. 
 	 * 
@@ -308,6 +328,45 @@ extern "C" {
 			lwfs_ns_entry *result);
 
 
+	/** 
+	 * @brief Resolve a path in one request.
+	 *
+	 * @ingroup naming_api
+	 *
+	 * The \b lwfs_resolve_path method looks up each name of a path
+	 * in turn, starting from \em start, on the server.  A cold lookup
+	 * of a deep path costs one round trip instead of one per name.
+	 * The caps have to cover the container of every directory on the
+	 * path (\ref LWFS_ERR_ACCESS otherwise).  The server stops at the
+	 * first name it can not resolve; \em result then has the entries
+	 * found before it, the error in \em result->rc, and the index of
+	 * the name in \em result->failed.  Free the result with
+	 * <tt>xdr_free((xdrproc_t)xdr_lwfs_resolve_path_res, result)</tt>.
+	 * 
+	 * @param svc    @input_type Points to the naming service descriptor. 
+	 * @param txn_id @input_type the transaction ID. 
+	 * @param start  @input_type the directory to start from.
+	 * @param names  @input_type the names on the path (at most \ref LWFS_RESOLVE_MAX_DEPTH). 
+	 * @param num_names @input_type the number of names. 
+	 * @param caps   @input_type caps that allow us to read the directories.
+	 * @param num_caps @input_type the number of caps.
+	 * @param want_all @input_type return the entry of every name, not just the last.
+	 * @param result @output_type the entries (the last one is the target) and where the server stopped.
+	 *
+	 * @return the error of the first name the server could not resolve.
+	 */
+	extern int lwfs_resolve_path_sync(
+			const lwfs_service *svc,
+			const lwfs_txn *txn_id, 
+			const lwfs_ns_entry *start, 
+			const char **names, 
+			const int num_names, 
+			const lwfs_cap *caps, 
+			const int num_caps, 
+			const lwfs_bool want_all, 
+			lwfs_resolve_path_res *result);
+
+
 	/** 
 	 * @brief Read the contents of a directory.
 	 *
@@ -336,6 +395,23 @@ extern "C" {
 			const lwfs_cap *cap,
 			lwfs_ns_entry_array *result);
 
+	/** 
+	 * @brief Read one page of the contents of a directory.
+	 *
+	 * @ingroup naming_api
+	 *
+	 * Blocking version of \ref lwfs_list_dir_page. 
+	 */
+	extern int lwfs_list_dir_page_sync(
+			const lwfs_service *svc, 
+			const lwfs_ns_entry *parent,
+			const char *cookie,
+			const int max_entries,
+			const lwfs_bool names_only,
+			const char *pattern,
+			const lwfs_cap *cap,
+			lwfs_list_dir_page_res *result);
+
 
 #else /* K&R C */
 
@@ -0,0 +1,487 @@
+/**
+ *   @file ns_cache.c
+ *
+ *   @brief Implementation of the client-side cache of namespace entries.
+ *
+ *   The cache owns a deep copy of each entry (the file object and
+ *   the distributed object hang off the entry); lookups hand out
+ *   another deep copy, so callers free results from the cache the
+ *   same way they free results from the server.
+ */
+#include "config.h"
+
+#if STDC_HEADERS
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+#include "support/hashtable/hash_funcs.h"
+#include "support/timer/timer.h"
+
+#include "naming_client.h"
+#include "naming_client_sync.h"
+#include "ns_cache.h"
+
+
+/* ------------------ PRIVATE TYPES/FUNCTIONS ---------------- */
+
+struct ns_cache_key {
+	lwfs_oid parent;
+	char name[LWFS_NAME_LEN];
+};
+
+struct ns_cache_val {
+	/* FALSE for a negative entry */
+	lwfs_bool exists;
+	lwfs_ns_entry entry;
+	double expires;
+};
+
+static DEFINE_HASHTABLE_INSERT(insert_ent, struct ns_cache_key, struct ns_cache_val);
+static DEFINE_HASHTABLE_SEARCH(search_ent, struct ns_cache_key, struct ns_cache_val);
+static DEFINE_HASHTABLE_REMOVE(remove_ent, struct ns_cache_key, struct ns_cache_val);
+
+static unsigned int
+hashfromkey(void *key)
+{
+	return RSHash(key, sizeof(struct ns_cache_key));
+}
+
+static int
+equalkeys(void *k1, void *k2)
+{
+	struct ns_cache_key *key1 = (struct ns_cache_key *)k1;
+	struct ns_cache_key *key2 = (struct ns_cache_key *)k2;
+
+	if ((memcmp(key1->parent, key2->parent, sizeof(lwfs_oid)) == 0) &&
+	    (strcmp(key1->name, key2->name) == 0))
+		return TRUE;
+	else
+		return FALSE;
+}
+
+static void
+init_key(struct ns_cache_key *key, const lwfs_ns_entry *parent, const char *name)
+{
+	memset(key, 0, sizeof(struct ns_cache_key));
+	memcpy(key->parent, parent->dirent_oid, sizeof(lwfs_oid));
+	strncpy(key->name, name, LWFS_NAME_LEN-1);
+}
+
+/* free what hangs off an entry (not the entry itself) */
+static void
+free_entry(lwfs_ns_entry *entry)
+{
+	if (entry->file_obj != NULL) {
+		free(entry->file_obj);
+		entry->file_obj = NULL;
+	}
+	if (entry->d_obj != NULL) {
+		if (entry->d_obj->ss_obj != NULL) {
+			free(entry->d_obj->ss_obj);
+		}
+		free(entry->d_obj);
+		entry->d_obj = NULL;
+	}
+}
+
+static int
+copy_entry(lwfs_ns_entry *dst, const lwfs_ns_entry *src)
+{
+	memcpy(dst, src, sizeof(lwfs_ns_entry));
+	dst->file_obj = NULL;
+	dst->d_obj = NULL;
+
+	if (src->file_obj != NULL) {
+		dst->file_obj = (lwfs_obj *)malloc(sizeof(lwfs_obj));
+		if (dst->file_obj == NULL) {
+			goto nomem;
+		}
+		memcpy(dst->file_obj, src->file_obj, sizeof(lwfs_obj));
+	}
+
+	if (src->d_obj != NULL) {
+		dst->d_obj = (lwfs_distributed_obj *)malloc(sizeof(lwfs_distributed_obj));
+		if (dst->d_obj == NULL) {
+			goto nomem;
+		}
+		memcpy(dst->d_obj, src->d_obj, sizeof(lwfs_distributed_obj));
+		dst->d_obj->ss_obj = NULL;
+
+		if ((src->d_obj->ss_obj != NULL) && (src->d_obj->ss_obj_count > 0)) {
+			dst->d_obj->ss_obj = (lwfs_obj *)malloc(
+					src->d_obj->ss_obj_count*sizeof(lwfs_obj));
+			if (dst->d_obj->ss_obj == NULL) {
+				goto nomem;
+			}
+			memcpy(dst->d_obj->ss_obj, src->d_obj->ss_obj,
+					src->d_obj->ss_obj_count*sizeof(lwfs_obj));
+		}
+	}
+
+	return LWFS_OK;
+
+nomem:
+	log_error(naming_debug_level, "could not allocate cache entry");
+	free_entry(dst);
+	return LWFS_ERR_NOSPACE;
+}
+
+static void
+free_val(void *v)
+{
+	struct ns_cache_val *val = (struct ns_cache_val *)v;
+
+	if (val == NULL) {
+		return;
+	}
+
+	free_entry(&val->entry);
+	free(val);
+}
+
+/* drop every entry (the mutex is held) */
+static int
+clear_cache(lwfs_ns_cache *cache)
+{
+	hashtable_destroy(&cache->ht, free_val);
+	if (!create_hashtable(cache->max_entries, hashfromkey, equalkeys, &cache->ht)) {
+		log_error(naming_debug_level, "could not create namespace cache");
+		return LWFS_ERR_NOSPACE;
+	}
+
+	return LWFS_OK;
+}
+
+
+/* ------------------ PUBLIC FUNCTIONS ---------------- */
+
+int lwfs_ns_cache_init(
+		lwfs_ns_cache *cache,
+		const int max_entries,
+		const double ttl,
+		const double neg_ttl)
+{
+	memset(cache, 0, sizeof(lwfs_ns_cache));
+
+	cache->max_entries = (max_entries > 0) ? max_entries : LWFS_NS_CACHE_SIZE;
+	cache->ttl = (ttl > 0.0) ? ttl : 0.0;
+	cache->neg_ttl = (neg_ttl > 0.0) ? neg_ttl : 0.0;
+
+	pthread_mutex_init(&cache->mutex, NULL);
+
+	if (!create_hashtable(cache->max_entries, hashfromkey, equalkeys, &cache->ht)) {
+		log_error(naming_debug_level, "could not create namespace cache");
+		return LWFS_ERR_NOSPACE;
+	}
+
+	return LWFS_OK;
+}
+
+void lwfs_ns_cache_fini(
+		lwfs_ns_cache *cache)
+{
+	pthread_mutex_lock(&cache->mutex);
+	hashtable_destroy(&cache->ht, free_val);
+	pthread_mutex_unlock(&cache->mutex);
+
+	pthread_mutex_destroy(&cache->mutex);
+}
+
+int lwfs_ns_cache_lookup(
+		lwfs_ns_cache *cache,
+		const lwfs_ns_entry *parent,
+		const char *name,
+		lwfs_ns_entry *result)
+{
+	int rc = LWFS_ERR;
+	struct ns_cache_key key;
+	struct ns_cache_val *val;
+
+	if (cache->ttl <= 0.0) {
+		return LWFS_ERR;
+	}
+
+	init_key(&key, parent, name);
+
+	pthread_mutex_lock(&cache->mutex);
+
+	val = search_ent(&cache->ht, &key);
+	if (val == NULL) {
+		cache->stats.misses++;
+		goto cleanup;
+	}
+
+	/* the lease ran out */
+	if (val->expires < lwfs_get_time()) {
+		cache->stats.expired++;
+		cache->stats.misses++;
+		free_val(remove_ent(&cache->ht, &key));
+		goto cleanup;
+	}
+
+	if (!val->exists) {
+		cache->stats.neg_hits++;
+		rc = LWFS_ERR_NOENT;
+		goto cleanup;
+	}
+
+	rc = copy_entry(result, &val->entry);
+	if (rc != LWFS_OK) {
+		goto cleanup;
+	}
+	cache->stats.hits++;
+
+cleanup:
+	pthread_mutex_unlock(&cache->mutex);
+
+	return rc;
+}
+
+int lwfs_ns_cache_insert(
+		lwfs_ns_cache *cache,
+		const lwfs_ns_entry *parent,
+		const char *name,
+		const lwfs_ns_entry *entry)
+{
+	int rc = LWFS_OK;
+	double ttl = (entry != NULL) ? cache->ttl : cache->neg_ttl;
+	struct ns_cache_key *key = NULL;
+	struct ns_cache_val *val = NULL;
+
+	if ((cache->ttl <= 0.0) || (ttl <= 0.0)) {
+		return LWFS_OK;
+	}
+
+	key = (struct ns_cache_key *)malloc(sizeof(struct ns_cache_key));
+	val = (struct ns_cache_val *)calloc(1, sizeof(struct ns_cache_val));
+	if ((key == NULL) || (val == NULL)) {
+		log_error(naming_debug_level, "could not allocate cache entry");
+		rc = LWFS_ERR_NOSPACE;
+		goto cleanup;
+	}
+
+	init_key(key, parent, name);
+
+	if (entry != NULL) {
+		rc = copy_entry(&val->entry, entry);
+		if (rc != LWFS_OK) {
+			goto cleanup;
+		}
+		val->exists = TRUE;
+	}
+	val->expires = lwfs_get_time() + ttl;
+
+	pthread_mutex_lock(&cache->mutex);
+
+	/* replace an older entry for the same name */
+	free_val(remove_ent(&cache->ht, key));
+
+	/* full: start over rather than track an LRU order */
+	if ((int)hashtable_count(&cache->ht) >= cache->max_entries) {
+		cache->stats.flushes++;
+		rc = clear_cache(cache);
+		if (rc != LWFS_OK) {
+			pthread_mutex_unlock(&cache->mutex);
+			goto cleanup;
+		}
+	}
+
+	if (!insert_ent(&cache->ht, key, val)) {
+		pthread_mutex_unlock(&cache->mutex);
+		log_error(naming_debug_level, "could not insert into cache");
+		rc = LWFS_ERR;
+		goto cleanup;
+	}
+
+	pthread_mutex_unlock(&cache->mutex);
+
+	return LWFS_OK;
+
+cleanup:
+	free(key);
+	free_val(val);
+
+	return rc;
+}
+
+void lwfs_ns_cache_invalidate(
+		lwfs_ns_cache *cache,
+		const lwfs_ns_entry *parent,
+		const char *name)
+{
+	struct ns_cache_key key;
+	struct ns_cache_val *val;
+
+	init_key(&key, parent, name);
+
+	pthread_mutex_lock(&cache->mutex);
+	val = remove_ent(&cache->ht, &key);
+	if (val != NULL) {
+		cache->stats.invalidations++;
+		free_val(val);
+	}
+	pthread_mutex_unlock(&cache->mutex);
+}
+
+void lwfs_ns_cache_invalidate_all(
+		lwfs_ns_cache *cache)
+{
+	pthread_mutex_lock(&cache->mutex);
+	cache->stats.invalidations += hashtable_count(&cache->ht);
+	clear_cache(cache);
+	pthread_mutex_unlock(&cache->mutex);
+}
+
+int lwfs_ns_cache_lookup_sync(
+		lwfs_ns_cache *cache,
+		const lwfs_service *svc,
+		const lwfs_txn *txn_id,
+		const lwfs_ns_entry *parent,
+		const char *name,
+		const lwfs_lock_type lock_type,
+		const lwfs_cap *cap,
+		lwfs_ns_entry *result)
+{
+	int rc = LWFS_OK;
+
+	/* a lock has to come from the server */
+	if (lock_type == LWFS_LOCK_NULL) {
+		rc = lwfs_ns_cache_lookup(cache, parent, name, result);
+		if ((rc == LWFS_OK) || (rc == LWFS_ERR_NOENT)) {
+			log_debug(naming_debug_level, "cached lookup of \"%s\": %s",
+					name, lwfs_err_str(rc));
+			return rc;
+		}
+	}
+
+	rc = lwfs_lookup_sync(svc, txn_id, parent, name, lock_type, cap, result);
+	if (rc == LWFS_OK) {
+		lwfs_ns_cache_insert(cache, parent, name, result);
+	}
+	else if (rc == LWFS_ERR_NOENT) {
+		lwfs_ns_cache_insert(cache, parent, name, NULL);
+	}
+
+	return rc;
+}
+
+int lwfs_ns_cache_resolve_sync(
+		lwfs_ns_cache *cache,
+		const lwfs_service *svc,
+		const lwfs_txn *txn_id,
+		const lwfs_ns_entry *start,
+		const char **names,
+		const int num_names,
+		const lwfs_cap *caps,
+		const int num_caps,
+		lwfs_ns_entry *result)
+{
+	int rc = LWFS_OK;
+	int i;
+	u_int j;
+	lwfs_ns_entry cur;   /* the deepest entry found so far */
+	lwfs_ns_entry next;
+	lwfs_resolve_path_res res;
+	lwfs_ns_entry *ents;
+	u_int num_ents;
+
+	memset(&res, 0, sizeof(lwfs_resolve_path_res));
+
+	rc = copy_entry(&cur, start);
+	if (rc != LWFS_OK) {
+		return rc;
+	}
+
+	/* walk the part of the path the cache knows */
+	for (i=0; i<num_names; i++) {
+		rc = lwfs_ns_cache_lookup(cache, &cur, names[i], &next);
+		if (rc == LWFS_ERR_NOENT) {
+			goto cleanup;
+		}
+		if (rc != LWFS_OK) {
+			break;
+		}
+		free_entry(&cur);
+		memcpy(&cur, &next, sizeof(lwfs_ns_entry));
+	}
+
+	/* one request for the rest */
+	if (i < num_names) {
+		rc = lwfs_resolve_path_sync(svc, txn_id, &cur, &names[i], num_names-i,
+				caps, num_caps, TRUE, &res);
+
+		ents = res.entries.lwfs_ns_entry_array_val;
+		num_ents = res.entries.lwfs_ns_entry_array_len;
+		if (num_ents > (u_int)(num_names-i)) {
+			log_error(naming_debug_level, "expected at most %d entries, got %u",
+					num_names-i, num_ents);
+			rc = LWFS_ERR_NAMING;
+			goto cleanup;
+		}
+
+		/* cache what the server found, even if it stopped early */
+		for (j=0; j<num_ents; j++) {
+			lwfs_ns_cache_insert(cache,
+					(j == 0) ? &cur : &ents[j-1],
+					names[i+j], &ents[j]);
+		}
+
+		/* and remember the name that is not there */
+		if ((res.rc == LWFS_ERR_NOENT) && ((u_int)res.failed == num_ents) && 
+				(res.failed < num_names-i)) {
+			lwfs_ns_cache_insert(cache,
+					(num_ents == 0) ? &cur : &ents[num_ents-1],
+					names[i+res.failed], NULL);
+		}
+
+		if (rc != LWFS_OK) {
+			goto cleanup;
+		}
+		if (num_ents != (u_int)(num_names-i)) {
+			log_error(naming_debug_level, "expected %d entries, got %u",
+					num_names-i, num_ents);
+			rc = LWFS_ERR_NAMING;
+			goto cleanup;
+		}
+
+		free_entry(&cur);
+		rc = copy_entry(&cur, &ents[num_ents-1]);
+		if (rc != LWFS_OK) {
+			goto cleanup;
+		}
+	}
+
+	/* the caller owns the last entry */
+	memcpy(result, &cur, sizeof(lwfs_ns_entry));
+	memset(&cur, 0, sizeof(lwfs_ns_entry));
+
+cleanup:
+	free_entry(&cur);
+	xdr_free((xdrproc_t)xdr_lwfs_resolve_path_res, (char *)&res);
+
+	return rc;
+}
+
+void fprint_lwfs_ns_cache_stats(
+		FILE *fp,
+		const char *prefix,
+		lwfs_ns_cache *cache)
+{
+	lwfs_ns_cache_stats stats;
+	int count;
+
+	pthread_mutex_lock(&cache->mutex);
+	memcpy(&stats, &cache->stats, sizeof(lwfs_ns_cache_stats));
+	count = hashtable_count(&cache->ht);
+	pthread_mutex_unlock(&cache->mutex);
+
+	fprintf(fp, "%s Namespace cache:\n", prefix);
+	fprintf(fp, "%s   entries = %d\n", prefix, count);
+	fprintf(fp, "%s   hits = %ld\n", prefix, stats.hits);
+	fprintf(fp, "%s   negative hits = %ld\n", prefix, stats.neg_hits);
+	fprintf(fp, "%s   misses = %ld\n", prefix, stats.misses);
+	fprintf(fp, "%s   expired = %ld\n", prefix, stats.expired);
+	fprintf(fp, "%s   invalidations = %ld\n", prefix, stats.invalidations);
+	fprintf(fp, "%s   flushes = %ld\n", prefix, stats.flushes);
+}
@@ -0,0 +1,206 @@
+/**
+ *   @file ns_cache.h
+ *
+ *   @brief A client-side cache of namespace entries (dentries).
+ *
+ *   Path traversal looks up every component of a path with a
+ *   naming RPC.  The cache keeps the entries it found, keyed by
+ *   (parent dirent_oid, name), for a short lease, so resolving
+ *   the same paths again (e.g., thousands of ranks opening the
+ *   same input deck) costs no RPCs.  Names the server did not
+ *   find are cached too (negative entries), with their own lease.
+ *
+ *   Entries are not kept coherent with other clients; they simply
+ *   expire.  Callers invalidate the names they create, remove, or
+ *   rename themselves.
+ */
+
+#include "common/types/types.h"
+#include "support/hashtable/hashtable.h"
+
+#include "client/naming_client/naming_client.h"
+
+#ifndef _LWFS_NS_CACHE_H_
+#define _LWFS_NS_CACHE_H_
+
+#include <stdio.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	/** @brief Default lease of a cached entry (sec). */
+#define LWFS_NS_CACHE_TTL 5.0
+
+	/** @brief Default lease of a cached "no such entry" (sec). */
+#define LWFS_NS_CACHE_NEG_TTL 1.0
+
+	/** @brief Default most entries in the cache. */
+#define LWFS_NS_CACHE_SIZE 4096
+
+	/**
+	 * @brief Counters kept by a namespace cache.
+	 */
+	typedef struct {
+		/** @brief Lookups answered with a cached entry. */
+		long hits;
+
+		/** @brief Lookups answered with a cached "no such entry". */
+		long neg_hits;
+
+		/** @brief Lookups that went to the server. */
+		long misses;
+
+		/** @brief Cached entries found with an expired lease. */
+		long expired;
+
+		/** @brief Entries dropped by the client. */
+		long invalidations;
+
+		/** @brief Times the cache was full and got emptied. */
+		long flushes;
+	} lwfs_ns_cache_stats;
+
+	/**
+	 * @brief A cache of namespace entries.
+	 */
+	typedef struct {
+		/** @brief (parent, name) -> cached entry. */
+		struct hashtable ht;
+
+		/** @brief Most entries to keep. */
+		int max_entries;
+
+		/** @brief Lease of a cached entry (sec); 0 disables the cache. */
+		double ttl;
+
+		/** @brief Lease of a negative entry (sec); 0 disables negative entries. */
+		double neg_ttl;
+
+		/** @brief Protects the table and the counters. */
+		pthread_mutex_t mutex;
+
+		lwfs_ns_cache_stats stats;
+	} lwfs_ns_cache;
+
+
+#if defined(__STDC__) || defined(__cplusplus)
+
+	/**
+	 * @brief Initialize a namespace cache.
+	 *
+	 * @param cache       @output_type the cache.
+	 * @param max_entries @input_type most entries to keep.
+	 * @param ttl         @input_type lease of a cached entry (sec).
+	 * @param neg_ttl     @input_type lease of a negative entry (sec).
+	 */
+	extern int lwfs_ns_cache_init(
+			lwfs_ns_cache *cache,
+			const int max_entries,
+			const double ttl,
+			const double neg_ttl);
+
+	/**
+	 * @brief Free the entries and the table of a namespace cache.
+	 */
+	extern void lwfs_ns_cache_fini(
+			lwfs_ns_cache *cache);
+
+	/**
+	 * @brief Look for an entry in the cache.
+	 *
+	 * On a hit, \em result gets a copy of the entry that the
+	 * caller owns (like the result of \ref lwfs_lookup).
+	 *
+	 * @returns \ref LWFS_OK if the entry is cached, \ref LWFS_ERR_NOENT
+	 *          if the cache knows the entry does not exist, and
+	 *          \ref LWFS_ERR if the server has to be asked.
+	 */
+	extern int lwfs_ns_cache_lookup(
+			lwfs_ns_cache *cache,
+			const lwfs_ns_entry *parent,
+			const char *name,
+			lwfs_ns_entry *result);
+
+	/**
+	 * @brief Add an entry to the cache.
+	 *
+	 * A NULL \em entry records that \em name does not exist
+	 * in \em parent.
+	 */
+	extern int lwfs_ns_cache_insert(
+			lwfs_ns_cache *cache,
+			const lwfs_ns_entry *parent,
+			const char *name,
+			const lwfs_ns_entry *entry);
+
+	/**
+	 * @brief Drop the cached entry (or negative entry) for a name.
+	 *
+	 * Call after creating, removing or renaming the entry.
+	 */
+	extern void lwfs_ns_cache_invalidate(
+			lwfs_ns_cache *cache,
+			const lwfs_ns_entry *parent,
+			const char *name);
+
+	/**
+	 * @brief Drop every entry in the cache.
+	 */
+	extern void lwfs_ns_cache_invalidate_all(
+			lwfs_ns_cache *cache);
+
+	/**
+	 * @brief Look up an entry, asking the server only on a cache miss.
+	 *
+	 * Same arguments and results as \ref lwfs_lookup_sync.  Lookups
+	 * that take a lock always go to the server.
+	 */
+	extern int lwfs_ns_cache_lookup_sync(
+			lwfs_ns_cache *cache,
+			const lwfs_service *svc,
+			const lwfs_txn *txn_id,
+			const lwfs_ns_entry *parent,
+			const char *name,
+			const lwfs_lock_type lock_type,
+			const lwfs_cap *cap,
+			lwfs_ns_entry *result);
+
+	/**
+	 * @brief Resolve a path, asking the server only for what the 
+	 * cache does not know.
+	 *
+	 * Walks the names through the cache from \em start and resolves
+	 * the rest with one \ref lwfs_resolve_path request, caching every
+	 * entry it returns (and a negative entry for a name that does not
+	 * exist).  \em result gets the entry of the last name.
+	 */
+	extern int lwfs_ns_cache_resolve_sync(
+			lwfs_ns_cache *cache,
+			const lwfs_service *svc,
+			const lwfs_txn *txn_id,
+			const lwfs_ns_entry *start,
+			const char **names,
+			const int num_names,
+			const lwfs_cap *caps,
+			const int num_caps,
+			lwfs_ns_entry *result);
+
+	/**
+	 * @brief Print the counters of a namespace cache.
+	 */
+	extern void fprint_lwfs_ns_cache_stats(
+			FILE *fp,
+			const char *prefix,
+			lwfs_ns_cache *cache);
+
+#else /* K&R C */
+#endif
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -15,6 +15,9 @@
 
 #include <stdio.h>
 #include <assert.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
 
 #if STDC_HEADERS
 #include <stdlib.h>
@@ -33,13 +36,39 @@
 #include "common/rpc_common/rpc_common.h"
 #include "common/rpc_common/lwfs_ptls.h"
 #include "common/rpc_common/ptl_wrap.h"
+#include "common/rpc_common/ptl_pool.h"
 #include "common/rpc_common/rpc_opcodes.h"
 #include "common/rpc_common/service_args.h"
 #include "common/config_parser/config_parser.h"
+#include "support/timer/timer.h"
 #include "rpc_client.h"
 
 #define MIN_TIMEOUT 1000
 
+/* lwfs_waitany() keeps this many EQ handles on the stack */
+#define WAITANY_LOCAL_EQS 32
+
+/* first delay (msec) before sending a request the server was too busy for */
+#define BUSY_MIN_BACKOFF 1
+
+/* events of a short result on a completion queue */
+#define CQ_GOT_PUT_START  0x1
+#define CQ_GOT_PUT_END    0x2
+#define CQ_GOT_UNLINK     0x4
+#define CQ_GOT_ALL        (CQ_GOT_PUT_START|CQ_GOT_PUT_END|CQ_GOT_UNLINK)
+
+/* requests lwfs_waitall and lwfs_waitany collect per harvest */
+#define CQ_HARVEST_BATCH  32
+
+/* retries of busy requests (see lwfs_rpc_set_busy_retries) */
+static int busy_max_retries = 10;
+static int busy_max_backoff = 200;  /* msec */
+
+static int attach_result_md(
+	const lwfs_rma *req_addr,
+	const ptl_match_bits_t match_bits,
+	lwfs_request *request);
+
 
 /**
  *   @addtogroup rpc_ptl_impl
@@ -560,16 +589,18 @@ static int cleanup_long_args(
 			}
 		}
 
-		/* free the event queue */
-		log_debug(rpc_debug_level,"freeing req->args_eq_h..."); 
-		rc2 = lwfs_PtlEQFree(req->args_eq_h); 
-		if (rc2 != PTL_OK) {
-			log_error(rpc_debug_level, "unable to free EQ");
+		/* recycle the event queue */
+		log_debug(rpc_debug_level,"releasing req->args_eq_h..."); 
+		rc2 = (rc == LWFS_OK)? lwfs_ptl_pool_eq_put(req->args_eq_h) : 
+			lwfs_ptl_pool_eq_discard(req->args_eq_h); 
+		if (rc2 != LWFS_OK) {
+			log_error(rpc_debug_level, "unable to release EQ");
 			rc = LWFS_ERR_RPC; 
 		}
 
 		/* free the buffer for the args */
-		free(event.md.start); 
+		free(req->args_buf); 
+		req->args_buf = NULL; 
 
 		/* reset args_eq_h */
 		req->args_eq_h = 0; 
@@ -578,6 +609,215 @@ static int cleanup_long_args(
 	return rc; 
 }
 
+/** 
+ * @brief Take back long args the server never fetched.
+ *
+ * A server that answers \ref LWFS_ERR_BUSY has not touched 
+ * the args, so there are no events to wait for. 
+ */
+static int abandon_long_args(
+	lwfs_request *req)
+{
+	int rc = LWFS_OK; 
+
+	if (req->args_eq_h != 0) {
+		rc = lwfs_PtlMDUnlink(req->args_md_h); 
+		if (rc != PTL_OK) {
+			log_warn(rpc_debug_level, "unable to unlink args MD: %s",
+					ptl_err_str[rc]);
+		}
+		rc = lwfs_ptl_pool_eq_discard(req->args_eq_h); 
+
+		free(req->args_buf); 
+		req->args_buf = NULL; 
+		req->args_eq_h = 0; 
+	}
+
+	return rc; 
+}
+
+/**
+ * @brief Schedule another try of a request the server was too busy for.
+ *
+ * Picks a random delay (the upper bound doubles with every retry,
+ * so clients turned away together do not all come back together) 
+ * and records when the request is due.  The caller keeps waiting
+ * on its other requests and sends this one with \ref send_retry 
+ * once the time is up. 
+ */
+static int schedule_retry(
+	lwfs_request *request)
+{
+	static pthread_mutex_t seed_mutex = PTHREAD_MUTEX_INITIALIZER; 
+	static unsigned int seed = 0; 
+
+	int rc = LWFS_OK; 
+	int max_delay = BUSY_MIN_BACKOFF; 
+	int delay; 
+	int i; 
+
+	request->busy_retries++; 
+
+	/* pick a delay in [max_delay/2, max_delay] msec */
+	for (i=1; (i<request->busy_retries) && (max_delay < busy_max_backoff); i++) {
+		max_delay *= 2; 
+	}
+	if (max_delay > busy_max_backoff) {
+		max_delay = busy_max_backoff; 
+	}
+
+	pthread_mutex_lock(&seed_mutex); 
+	if (seed == 0) {
+		struct timeval now; 
+		gettimeofday(&now, NULL); 
+		seed = (unsigned int)(getpid() ^ now.tv_usec ^ now.tv_sec); 
+	}
+	delay = max_delay*500 + rand_r(&seed) % (max_delay*500 + 1);  /* usec */
+	pthread_mutex_unlock(&seed_mutex); 
+
+	log_debug(rpc_debug_level, "server busy, retry %d of request %lu in %d usec", 
+			request->busy_retries, request->id, delay); 
+
+	/* the old result queue saw all its events */
+	if (request->cq == NULL) {
+		rc = lwfs_ptl_pool_eq_put(request->short_res_eq_h); 
+		if (rc != LWFS_OK) {
+			log_error(rpc_debug_level, "unable to release short result EQ"); 
+			return rc; 
+		}
+	}
+	request->cq_events = 0; 
+
+	request->status = LWFS_PROCESSING_REQUEST; 
+	request->error_code = LWFS_OK; 
+	request->busy_retry_at = lwfs_get_time() + delay/1.0e6; 
+
+	return rc; 
+}
+
+/**
+ * @brief Send a request the server was too busy for again.
+ *
+ * Posts the short result MD again with the same match bits and 
+ * sends the same short request.  The server did not touch the long
+ * args or the data, so those MDs are still good.
+ */
+static int send_retry(
+	lwfs_request *request)
+{
+	int rc = LWFS_OK; 
+
+	request->busy_retry_at = 0.0; 
+
+	rc = attach_result_md(&request->req_addr, request->res_match_bits, request); 
+	if (rc != LWFS_OK) {
+		log_error(rpc_debug_level, "could not post md for result"); 
+		return rc; 
+	}
+
+	rc = lwfs_ptl_put(request->short_req_buf, request->short_req_len, 
+			&request->req_addr); 
+	if (rc != LWFS_OK) {
+		log_error(rpc_debug_level, "unable to PUT the short request"); 
+		return rc; 
+	}
+
+	return rc; 
+}
+
+/**
+ * @brief Send the busy requests of a completion queue that are due.
+ *
+ * @param next_retry  @output_type When the next busy request is due 
+ *                                 (0 if none is left). 
+ */
+static int send_due_retries(
+	lwfs_completion_queue *cq,
+	double *next_retry)
+{
+	int rc = LWFS_OK; 
+	double now = lwfs_get_time(); 
+	lwfs_request *request; 
+	int i = 0; 
+
+	*next_retry = 0.0; 
+
+	while (i < cq->num_busy) {
+		request = cq->busy[i]; 
+
+		if (request->busy_retry_at > now) {
+			if ((*next_retry == 0.0) || (request->busy_retry_at < *next_retry)) {
+				*next_retry = request->busy_retry_at; 
+			}
+			i++; 
+			continue; 
+		}
+
+		cq->busy[i] = cq->busy[--cq->num_busy]; 
+
+		rc = send_retry(request); 
+		if (rc != LWFS_OK) {
+			log_error(rpc_debug_level, "unable to retry busy request"); 
+			return rc; 
+		}
+	}
+
+	return rc; 
+}
+
+/**
+ * @brief Harvest a completion queue until a request of an array is done.
+ *
+ * Other requests on the queue may finish too; their owners find
+ * them done when they wait. 
+ */
+static int cq_wait(
+	lwfs_completion_queue *cq,
+	lwfs_request *req_array, 
+	lwfs_size size, 
+	int timeout)
+{
+	int rc = LWFS_OK; 
+	lwfs_request *done[CQ_HARVEST_BATCH]; 
+	int num_done; 
+	double deadline = (timeout > 0)? lwfs_get_time() + timeout/1000.0 : 0.0; 
+	int wait; 
+	int i; 
+
+	while (TRUE) {
+		for (i=0; i<size; i++) {
+			if (req_array[i].status != LWFS_PROCESSING_REQUEST) {
+				return LWFS_OK; 
+			}
+		}
+
+		wait = timeout; 
+		if (timeout > 0) {
+			wait = (int)((deadline - lwfs_get_time())*1000.0); 
+			if (wait <= 0) {
+				return LWFS_ERR_TIMEDOUT; 
+			}
+		}
+
+		rc = lwfs_cq_harvest(cq, wait, done, CQ_HARVEST_BATCH, &num_done); 
+		if (rc != LWFS_OK) {
+			return rc; 
+		}
+	}
+}
+
+/**
+ * @brief Configure retries of requests the server was too busy for.
+ */
+void lwfs_rpc_set_busy_retries(
+	const int max_retries,
+	const int max_backoff_ms)
+{
+	busy_max_retries = (max_retries > 0)? max_retries : 0; 
+	busy_max_backoff = (max_backoff_ms > BUSY_MIN_BACKOFF)? 
+		max_backoff_ms : BUSY_MIN_BACKOFF; 
+}
+
 /**
  * @brief Wait for all requests to complete. 
  *
@@ -598,8 +838,22 @@ int lwfs_waitall(
 	int rc2; 
 	int i; 
 
-	/* wait for each request to complete */
+	/* harvest the requests on completion queues (each pass 
+	 * collects every request that already finished) */
 	for (i=0; i<size; i++) {
+		if (req_array[i].cq != NULL) {
+			rc = cq_wait(req_array[i].cq, &req_array[i], 1, timeout); 
+			if (rc != LWFS_OK) {
+				goto complete;
+			}
+		}
+	}
+
+	/* wait for each of the other requests to complete */
+	for (i=0; i<size; i++) {
+		if (req_array[i].cq != NULL) {
+			continue; 
+		}
 		rc = lwfs_timedwait(&req_array[i], timeout, &rc2); 
 		if (rc != LWFS_OK) {
 			goto complete;
@@ -628,15 +882,28 @@ int lwfs_waitany(
 	int rc = LWFS_OK;  /* return code */
 	int i; 
 
-	ptl_handle_eq_t *eq_handles; 
+	ptl_handle_eq_t local_eqs[WAITANY_LOCAL_EQS]; 
+	ptl_handle_eq_t *eq_handles = local_eqs; 
+	int local_index[WAITANY_LOCAL_EQS]; 
+	int *eq_index = local_index;   /* request of each EQ in eq_handles */
+	int num_eqs; 
+
+	double deadline = (timeout > 0)? lwfs_get_time() + timeout/1000.0 : 0.0; 
+	double next_retry;   /* when the next busy request is due (0 if none) */
+	double now; 
+	int poll_timeout; 
 
 	/* initialize which */
 	*which = -1;
 
-	/* allocate handles */
-	eq_handles = (ptl_handle_eq_t *)malloc(size * sizeof(ptl_handle_eq_t));
+	/* only large request arrays need space for the handles */
+	if (size > WAITANY_LOCAL_EQS) {
+		eq_handles = (ptl_handle_eq_t *)malloc(size * sizeof(ptl_handle_eq_t));
+		eq_index = (int *)malloc(size * sizeof(int));
+	}
 
 
+wait_again:
 	/* check the request status of each request */
 	for (i=0; i<size; i++) {
 		if (req_array[i].status != LWFS_PROCESSING_REQUEST) {
@@ -645,10 +912,66 @@ int lwfs_waitany(
 		}
 	}
 
+	/* requests on a completion queue finish through its harvest */
+	if (req_array[0].cq != NULL) {
+		rc = cq_wait(req_array[0].cq, req_array, size, timeout); 
+		if (rc != LWFS_OK) {
+			goto complete; 
+		}
+		goto wait_again; 
+	}
+
 
-	/* setup the event queue array */
+	/* send the busy requests that are due, wait on all the others */
+	now = lwfs_get_time(); 
+	next_retry = 0.0; 
+	num_eqs = 0; 
 	for (i=0; i<size; i++) {
-		eq_handles[i] = req_array[i].short_res_eq_h; 
+		if (req_array[i].busy_retry_at != 0.0) {
+			if (req_array[i].busy_retry_at > now) {
+				if ((next_retry == 0.0) || (req_array[i].busy_retry_at < next_retry)) {
+					next_retry = req_array[i].busy_retry_at; 
+				}
+				continue; 
+			}
+
+			rc = send_retry(&req_array[i]); 
+			if (rc != LWFS_OK) {
+				log_error(rpc_debug_level, "unable to retry busy request"); 
+				*which = i; 
+				goto complete; 
+			}
+		}
+
+		eq_handles[num_eqs] = req_array[i].short_res_eq_h; 
+		eq_index[num_eqs] = i; 
+		num_eqs++; 
+	}
+
+	/* do not wait past the caller's timeout ... */
+	poll_timeout = timeout; 
+	if (timeout > 0) {
+		poll_timeout = (int)((deadline - now)*1000.0); 
+		if (poll_timeout <= 0) {
+			log_debug(rpc_debug_level, "timed out waiting for busy requests"); 
+			rc = LWFS_ERR_TIMEDOUT; 
+			goto complete; 
+		}
+	}
+
+	/* ... or past the next retry */
+	if (next_retry != 0.0) {
+		int until_retry = (int)((next_retry - now)*1000.0) + 1; 
+
+		if ((poll_timeout <= 0) || (until_retry < poll_timeout)) {
+			poll_timeout = until_retry; 
+		}
+
+		/* nothing to wait on but the retries */
+		if (num_eqs == 0) {
+			usleep((useconds_t)(poll_timeout*1000)); 
+			goto wait_again; 
+		}
 	}
 	
 //	if (timeout == -1) {
@@ -670,7 +993,17 @@ int lwfs_waitany(
 			/* wait for next event on the short result queue */
 			if (*which == -1) {
 				log_debug(rpc_debug_level, "using poll for short result");
-				rc = lwfs_ptl_eq_poll(eq_handles, size, timeout, &event, which); 
+				rc = lwfs_ptl_eq_poll(eq_handles, num_eqs, poll_timeout, &event, which); 
+
+				/* time to send a busy request again */
+				if ((rc == LWFS_ERR_TIMEDOUT) && (next_retry != 0.0)) {
+					*which = -1; 
+					rc = LWFS_OK; 
+					goto wait_again; 
+				}
+				if ((*which >= 0) && (*which < num_eqs)) {
+					*which = eq_index[*which]; 
+				}
 			}
 			else {
 				log_debug(rpc_debug_level, "using timedwait for short result");
@@ -717,11 +1050,31 @@ int lwfs_waitany(
 
 		log_debug(rpc_debug_level,"A");
 
-		/* free the memory for the short result buffer */
-		free(event.md.start); 
+		/* recycle the short result buffer */
+		lwfs_ptl_pool_buf_put(event.md.start, LWFS_SHORT_RESULT_SIZE); 
 
 		log_debug(rpc_debug_level,"B");
 
+		/* the server was too busy for the request */
+		if ((req_array[*which].status == LWFS_REQUEST_ERROR) && 
+				(req_array[*which].error_code == LWFS_ERR_BUSY)) {
+
+			if (req_array[*which].busy_retries < busy_max_retries) {
+				rc = schedule_retry(&req_array[*which]); 
+				if (rc != LWFS_OK) {
+					log_error(rpc_debug_level, "unable to retry busy request"); 
+					goto complete; 
+				}
+				*which = -1; 
+				goto wait_again; 
+			}
+
+			/* out of retries, the server never fetched the args */
+			log_debug(rpc_debug_level, "server still busy after %d retries", 
+					req_array[*which].busy_retries); 
+			abandon_long_args(&req_array[*which]); 
+		}
+
 		/* Now we need to clean up the long arguments (if they were used) */
 		rc = cleanup_long_args(&req_array[*which], timeout);
 		if (rc != LWFS_OK) {
@@ -735,10 +1088,15 @@ int lwfs_waitany(
 
 free_req_eq:
 	/* release the event queue for the short result */
-	log_debug(rpc_debug_level,"freeing req_array[*which].short_res_eq_h..."); 
-	rc = lwfs_PtlEQFree(req_array[*which].short_res_eq_h); 
-	if (rc != PTL_OK) {
-		log_error(rpc_debug_level, "failed to free short result EQ");
+	log_debug(rpc_debug_level,"releasing req_array[*which].short_res_eq_h..."); 
+	if (rc == LWFS_OK) {
+		rc = lwfs_ptl_pool_eq_put(req_array[*which].short_res_eq_h); 
+	}
+	else {
+		lwfs_ptl_pool_eq_discard(req_array[*which].short_res_eq_h); 
+	}
+	if (rc != LWFS_OK) {
+		log_error(rpc_debug_level, "failed to release short result EQ");
 		return LWFS_ERR_RPC; 
 	}
 
@@ -755,11 +1113,11 @@ free_req_eq:
 			return LWFS_ERR_RPC; 
 		}
 
-		/* free the EQ for the data */
-		log_debug(rpc_debug_level, "freeing req_array[*which].data_eq_h");
-		rc = lwfs_PtlEQFree(req_array[*which].data_eq_h); 
-		if (rc != PTL_OK) {
-			log_error(rpc_debug_level, "failed to free data EQ");
+		/* recycle the EQ for the data (drops the data events) */
+		log_debug(rpc_debug_level, "releasing req_array[*which].data_eq_h");
+		rc = lwfs_ptl_pool_eq_put(req_array[*which].data_eq_h); 
+		if (rc != LWFS_OK) {
+			log_error(rpc_debug_level, "failed to release data EQ");
 			return LWFS_ERR_RPC;
 		}
 	}
@@ -771,7 +1129,17 @@ free_req_eq:
 complete:
 
 	/* at this point, the status should either be complete or error */
-	free(eq_handles);
+	if (eq_handles != local_eqs) {
+		free(eq_handles);
+		free(eq_index);
+	}
+
+	/* we will not send the short request again */
+	if (*which >= 0) {
+		lwfs_ptl_pool_buf_put(req_array[*which].short_req_buf, 
+				req_array[*which].short_req_size); 
+		req_array[*which].short_req_buf = NULL; 
+	}
 
 	/* check for an error in this code */
 	if (rc != LWFS_OK) {
@@ -949,11 +1317,10 @@ static int encode_args(
 			 * the memory later. */
 			encoded_args_buf = (char *)malloc(args_size);
 
-			/* create an event queue */
-			/* TODO: should we share an event queue? */
-			rc = lwfs_PtlEQAlloc(ni_h, 5, PTL_EQ_HANDLER_NONE, &eq_h); 
-			if (rc != PTL_OK) {
-				log_error(rpc_debug_level, "failed to allocate eventq");
+			/* get an event queue */
+			rc = lwfs_ptl_pool_eq_get(&eq_h); 
+			if (rc != LWFS_OK) {
+				log_error(rpc_debug_level, "failed to get eventq");
 				return LWFS_ERR_RPC;
 			}
 
@@ -999,8 +1366,10 @@ static int encode_args(
 			header->args_addr.match_bits = match_bits; 
 			header->args_addr.len = args_size; 
 
-			/* store the event queue for the long args */
+			/* store the event queue, MD, and buffer for the long args */
 			request->args_eq_h = eq_h; 
+			request->args_md_h = md_h; 
+			request->args_buf = encoded_args_buf; 
 
 			/* create an xdr memory stream for the encoded args */
 			xdrmem_create(&args_xdrs, encoded_args_buf, 
@@ -1038,24 +1407,18 @@ cleanup:
 
 
 /** 
- * @brief Post a Portals memory descriptor for the result. 
+ * @brief Attach a Portals memory descriptor for the short result. 
  *
- * This function allocates Portals data structures for the 
- * result.  The LWFS network protocols require the server 
- * to "put" a short result header into a buffer on the client.
- * If the actual result is short enough to fit in the result
- * header, it is sent along with the header. Otherwise, the 
- * client fetches the result from the server. 
+ * The server "puts" the short result into this MD, using the 
+ * given match bits. 
  */
-static int post_result_md(
-	const lwfs_service *svc,
-	lwfs_request_header *header,
-	char *result, 
+static int attach_result_md(
+	const lwfs_rma *req_addr,
+	const ptl_match_bits_t match_bits,
 	lwfs_request *request)
 {	
 	int rc = LWFS_OK;
 	char *short_result_buf = NULL; 
-	static int local_count = 0; 
 
 	/* portals structs */
 	ptl_handle_eq_t eq_h; 
@@ -1064,14 +1427,14 @@ static int post_result_md(
 	ptl_handle_me_t me_h; 
 	ptl_handle_ni_t ni_h; 
 	ptl_process_id_t match_id;
-	ptl_match_bits_t match_bits;
 	ptl_match_bits_t ignore_bits;
 
-	/* increment the counter */
-	local_count++;
-
-	/* allocate memory for the result header */
-	short_result_buf = (char *)malloc(LWFS_SHORT_RESULT_SIZE);
+	/* get a buffer for the result header */
+	short_result_buf = (char *)lwfs_ptl_pool_buf_get(LWFS_SHORT_RESULT_SIZE);
+	if (short_result_buf == NULL) {
+		log_error(rpc_debug_level, "out of space for the short result");
+		return LWFS_ERR_NOSPACE; 
+	}
 	
 	/* get the network interface handle from portals */
 	rc = lwfs_ptl_get_ni(&ni_h); 
@@ -1080,19 +1443,23 @@ static int post_result_md(
 		goto cleanup; 
 	}
 
-	/* create an event queue */
-	rc = lwfs_PtlEQAlloc(ni_h, 5, PTL_EQ_HANDLER_NONE, &eq_h); 
-	if (rc != PTL_OK) {
-		log_error(rpc_debug_level, "failed to allocate eventq");
-		rc = LWFS_ERR_RPC;
-		goto cleanup;
+	/* get an event queue (or share the one of the completion queue) */
+	if (request->cq != NULL) {
+		eq_h = request->cq->eq_h; 
+	}
+	else {
+		rc = lwfs_ptl_pool_eq_get(&eq_h); 
+		if (rc != LWFS_OK) {
+			log_error(rpc_debug_level, "failed to get eventq");
+			rc = LWFS_ERR_RPC;
+			goto cleanup;
+		}
 	}
 
 
 	/* We expect the result to come from "dest" */
-	match_bits = (ptl_match_bits_t)local_count; 
-	match_id.nid = svc->req_addr.match_id.nid;
-	match_id.pid = svc->req_addr.match_id.pid;
+	match_id.nid = req_addr->match_id.nid;
+	match_id.pid = req_addr->match_id.pid;
 	ignore_bits = 0; 
 
 
@@ -1114,7 +1481,7 @@ static int post_result_md(
 	md.length = LWFS_SHORT_RESULT_SIZE;
 	md.threshold = 1;    /* only expect one put request */
 	md.options = PTL_MD_OP_PUT | PTL_MD_TRUNCATE;
-	md.user_ptr = NULL; 
+	md.user_ptr = request;   /* tells completion queues whose result it is */
 	md.eq_handle = eq_h; 
 
 	/* attach the memory descriptor to the match entry 
@@ -1126,6 +1493,42 @@ static int post_result_md(
 		goto cleanup;
 	}
 
+	/* store the event queue for the short result */
+	request->short_res_eq_h = eq_h; 
+
+cleanup:
+	return rc; 
+}
+
+/** 
+ * @brief Post a Portals memory descriptor for the result. 
+ *
+ * This function allocates Portals data structures for the 
+ * result.  The LWFS network protocols require the server 
+ * to "put" a short result header into a buffer on the client.
+ * If the actual result is short enough to fit in the result
+ * header, it is sent along with the header. Otherwise, the 
+ * client fetches the result from the server. 
+ */
+static int post_result_md(
+	const lwfs_service *svc,
+	lwfs_request_header *header,
+	char *result, 
+	lwfs_request *request)
+{	
+	int rc = LWFS_OK;
+	static int local_count = 0; 
+	ptl_match_bits_t match_bits;
+
+	/* increment the counter */
+	local_count++;
+	match_bits = (ptl_match_bits_t)local_count; 
+
+	rc = attach_result_md(&svc->req_addr, match_bits, request); 
+	if (rc != LWFS_OK) {
+		goto cleanup; 
+	}
+
 	/* initialize the result address */ 
 	memset(&header->res_addr, 0, sizeof(lwfs_rma)); 
 	lwfs_get_id(&header->res_addr.match_id);
@@ -1134,8 +1537,8 @@ static int post_result_md(
 	header->res_addr.match_bits = match_bits;
 	header->res_addr.len = LWFS_SHORT_RESULT_SIZE;
 
-	/* store the event queue for the short result */
-	request->short_res_eq_h = eq_h; 
+	/* a retry reuses the match bits */
+	request->res_match_bits = match_bits; 
 
 	log_debug(rpc_debug_level, "!!!!******** RESULT_COUNT = %d", local_count);
 	if (logging_debug(rpc_debug_level)) {
@@ -1194,10 +1597,10 @@ static int post_data_md(
 			goto cleanup;
 		}
 
-		/* create an event queue */
-		rc = lwfs_PtlEQAlloc(ni_h, 5, PTL_EQ_HANDLER_NONE, &eq_h); 
-		if (rc != PTL_OK) {
-			log_error(rpc_debug_level, "failed to allocate eventq (error_code==%d)", rc);
+		/* get an event queue */
+		rc = lwfs_ptl_pool_eq_get(&eq_h); 
+		if (rc != LWFS_OK) {
+			log_error(rpc_debug_level, "failed to get eventq");
 			rc = LWFS_ERR_RPC;
 			goto cleanup;
 		}
@@ -1256,6 +1659,21 @@ cleanup:
 }
 
 
+/** 
+ * @brief Send a request whose short result goes to \em cq 
+ * (or to an event queue of its own if \em cq is NULL).
+ */
+static int send_rpc(
+		const lwfs_service *svc, 
+		const lwfs_opcode opcode, 
+		void *args, 
+		void *data,
+		uint32_t data_size,
+		void *result,
+		lwfs_completion_queue *cq,
+		lwfs_request *request);
+
+
 /** 
  * @brief Send an RPC request to an LWFS server.
  *
@@ -1284,6 +1702,19 @@ int lwfs_call_rpc(
 		uint32_t data_size,
 		void *result,
 		lwfs_request *request)
+{
+	return send_rpc(svc, opcode, args, data, data_size, result, NULL, request); 
+}
+
+static int send_rpc(
+		const lwfs_service *svc, 
+		const lwfs_opcode opcode, 
+		void *args, 
+		void *data,
+		uint32_t data_size,
+		void *result,
+		lwfs_completion_queue *cq,
+		lwfs_request *request)
 {
 	/* global counter that needs mutex protection */
 	static unsigned long global_count = 0; 
@@ -1316,6 +1747,7 @@ int lwfs_call_rpc(
 	request->data = (data_size > 0)? data : NULL; 
 	request->error_code = LWFS_OK;                /* return code of remote method */
 	request->status = LWFS_SENDING_REQUEST;       /* status of this request */
+	request->cq = cq;                             /* where the short result goes */
 
 
 
@@ -1344,9 +1776,14 @@ int lwfs_call_rpc(
 	}
 
 
-	/* allocate memory for the short request buffer */
+	/* get a buffer for the short request */
 	short_req_len = svc->req_addr.len; 
-	short_req_buf = (char *)malloc(short_req_len); 
+	short_req_buf = (char *)lwfs_ptl_pool_buf_get(short_req_len); 
+	if (short_req_buf == NULL) {
+		log_error(rpc_debug_level, "out of space for the short request");
+		rc = LWFS_ERR_NOSPACE; 
+		goto cleanup; 
+	}
 
 
 	/* --- encode the arguments (might place args in the short request) --- */
@@ -1377,12 +1814,309 @@ int lwfs_call_rpc(
 	}
 	log_debug(rpc_debug_level,"message sent"); 
 
+	/* keep the short request until the result arrives (in case 
+	 * the server is busy and we have to send it again) */
+	memcpy(&request->req_addr, &svc->req_addr, sizeof(lwfs_rma)); 
+	request->short_req_buf = short_req_buf; 
+	request->short_req_size = short_req_len; 
+	request->short_req_len = len; 
+	short_req_buf = NULL; 
+
 	/* change the state of the pending request */
 	request->status = LWFS_PROCESSING_REQUEST; 
 
 cleanup:
-	free(short_req_buf); 
+	lwfs_ptl_pool_buf_put(short_req_buf, short_req_len); 
 
 	return rc;
 }
 
+
+
+/* ----------- Vectors of requests and completion queues ----------- */
+
+/**
+ * @brief Create a completion queue.
+ */
+int lwfs_cq_init(
+		const int size,
+		lwfs_completion_queue *cq)
+{
+	int rc = LWFS_OK; 
+	ptl_handle_ni_t ni_h; 
+
+	memset(cq, 0, sizeof(lwfs_completion_queue)); 
+
+	if (size <= 0) {
+		log_error(rpc_debug_level, "invalid size for a completion queue (%d)", size); 
+		return LWFS_ERR; 
+	}
+
+	rc = lwfs_ptl_get_ni(&ni_h); 
+	if (rc != LWFS_OK) {
+		log_error(rpc_debug_level, "unable to get ni_h");
+		return rc; 
+	}
+
+	cq->busy = (lwfs_request **)calloc(size, sizeof(lwfs_request *)); 
+	if (cq->busy == NULL) {
+		log_error(rpc_debug_level, "out of space for the busy requests");
+		return LWFS_ERR_NOSPACE; 
+	}
+
+	/* three events (put start, put end, unlink) per short result */
+	rc = lwfs_ptl_eq_alloc(ni_h, 3*size, PTL_EQ_HANDLER_NONE, &cq->eq_h); 
+	if (rc != LWFS_OK) {
+		log_error(rpc_debug_level, "unable to allocate event queue");
+		free(cq->busy); 
+		cq->busy = NULL; 
+		return rc; 
+	}
+
+	cq->size = size; 
+	cq->num_pending = 0; 
+
+	return rc; 
+}
+
+/**
+ * @brief Free a completion queue.
+ */
+int lwfs_cq_fini(
+		lwfs_completion_queue *cq)
+{
+	if (cq->num_pending > 0) {
+		log_warn(rpc_debug_level, "freeing completion queue with %d pending requests",
+				cq->num_pending); 
+	}
+
+	free(cq->busy); 
+	cq->busy = NULL; 
+	cq->num_busy = 0; 
+
+	return lwfs_ptl_eq_free(cq->eq_h); 
+}
+
+/**
+ * @brief Call a vector of remote procedures. 
+ */
+int lwfs_call_rpcv(
+		const lwfs_rpc_call *calls, 
+		const int count, 
+		lwfs_completion_queue *cq, 
+		lwfs_request *reqs, 
+		int *num_sent)
+{
+	int rc = LWFS_OK; 
+	int i; 
+
+	*num_sent = 0; 
+
+	if (cq->num_pending + count > cq->size) {
+		log_error(rpc_debug_level, "no room for %d requests on completion queue "
+				"(pending=%d, size=%d)", count, cq->num_pending, cq->size); 
+		return LWFS_ERR_NOSPACE; 
+	}
+
+	for (i=0; i<count; i++) {
+		rc = send_rpc(calls[i].svc, calls[i].opcode, calls[i].args, 
+				calls[i].data, calls[i].data_len, calls[i].result, 
+				cq, &reqs[i]); 
+		if (rc != LWFS_OK) {
+			log_error(rpc_debug_level, "unable to send request %d of %d", i, count); 
+			break; 
+		}
+
+		cq->num_pending++; 
+		(*num_sent)++; 
+	}
+
+	return rc; 
+}
+
+/**
+ * @brief Finish a request whose short result arrived on a completion queue.
+ *
+ * @returns TRUE if the request is done, FALSE if we had to send
+ * it again (the server was busy).
+ */
+static lwfs_bool finish_cq_request(
+		lwfs_completion_queue *cq, 
+		lwfs_request *req, 
+		char *short_res_buf,
+		int timeout)
+{
+	int rc = LWFS_OK; 
+
+	rc = process_result(short_res_buf, req); 
+	lwfs_ptl_pool_buf_put(short_res_buf, LWFS_SHORT_RESULT_SIZE); 
+	if (rc != LWFS_OK) {
+		log_error(rpc_debug_level, "unable to process result"); 
+		req->status = LWFS_REQUEST_ERROR; 
+		req->error_code = rc; 
+	}
+
+	/* the server was too busy for the request */
+	if ((req->status == LWFS_REQUEST_ERROR) && 
+			(req->error_code == LWFS_ERR_BUSY)) {
+
+		/* the harvest sends it again when it is due */
+		if (req->busy_retries < busy_max_retries) {
+			rc = schedule_retry(req); 
+			if (rc == LWFS_OK) {
+				cq->busy[cq->num_busy++] = req; 
+				return FALSE; 
+			}
+			log_error(rpc_debug_level, "unable to retry busy request"); 
+			req->error_code = rc; 
+		}
+
+		/* the server never fetched the args */
+		abandon_long_args(req); 
+	}
+
+	/* wait for the server to fetch the long arguments (if used) */
+	rc = cleanup_long_args(req, timeout); 
+	if ((rc != LWFS_OK) && (req->status != LWFS_REQUEST_ERROR)) {
+		log_error(rpc_debug_level, "failed to cleanup long args");
+		req->status = LWFS_REQUEST_ERROR; 
+		req->error_code = LWFS_ERR_RPC; 
+	}
+
+	/* the server is done with the data */
+	if (req->data != NULL) {
+		rc = lwfs_PtlMDUnlink(req->data_md_h); 
+		if (rc != PTL_OK) {
+			log_error(rpc_debug_level, "failed to unlink data MD");
+			lwfs_ptl_pool_eq_discard(req->data_eq_h); 
+		}
+		else {
+			lwfs_ptl_pool_eq_put(req->data_eq_h); 
+		}
+	}
+
+	/* we will not send the short request again */
+	lwfs_ptl_pool_buf_put(req->short_req_buf, req->short_req_size); 
+	req->short_req_buf = NULL; 
+
+	cq->num_pending--; 
+
+	return TRUE; 
+}
+
+/**
+ * @brief Collect finished requests from a completion queue. 
+ *
+ * Events of different requests interleave on the queue, so 
+ * each request counts its own; a request is finished when all
+ * three events of its short result are in. 
+ */
+int lwfs_cq_harvest(
+		lwfs_completion_queue *cq, 
+		int timeout, 
+		lwfs_request **done, 
+		const int max_done, 
+		int *num_done)
+{
+	int rc = LWFS_OK; 
+	ptl_event_t event; 
+	lwfs_request *req; 
+	double deadline = (timeout > 0)? lwfs_get_time() + timeout/1000.0 : 0.0; 
+	double next_retry; 
+	double now; 
+	int wait; 
+	lwfs_bool until_retry; 
+
+	*num_done = 0; 
+
+	if (cq->num_pending == 0) {
+		log_error(rpc_debug_level, "no pending requests on completion queue"); 
+		return LWFS_ERR_NOENT; 
+	}
+
+	while ((*num_done < max_done) && (cq->num_pending > 0)) {
+
+		rc = send_due_retries(cq, &next_retry); 
+		if (rc != LWFS_OK) {
+			break; 
+		}
+
+		/* only wait until the first request finishes, and 
+		 * not past the caller's timeout or the next retry */
+		wait = 0; 
+		until_retry = FALSE; 
+		if (*num_done == 0) {
+			now = lwfs_get_time(); 
+			wait = timeout; 
+			if (timeout > 0) {
+				wait = (int)((deadline - now)*1000.0); 
+				if (wait <= 0) {
+					rc = LWFS_ERR_TIMEDOUT; 
+					break; 
+				}
+			}
+			if (next_retry != 0.0) {
+				int until = (int)((next_retry - now)*1000.0) + 1; 
+				if ((wait < 0) || (until < wait)) {
+					wait = until; 
+					until_retry = TRUE; 
+				}
+			}
+		}
+
+		/* the timed wait does not return with a timeout of 0 */
+		if (wait == 0) {
+			rc = lwfs_ptl_eq_get(cq->eq_h, &event); 
+		}
+		else {
+			rc = lwfs_ptl_eq_timedwait(cq->eq_h, wait, &event); 
+		}
+		if (rc == LWFS_ERR_TIMEDOUT) {
+			if (*num_done > 0) {
+				/* nothing else finished */
+				rc = LWFS_OK; 
+				break; 
+			}
+			if (until_retry) {
+				/* time to send a busy request again */
+				continue; 
+			}
+			break; 
+		}
+		if (rc != LWFS_OK) {
+			log_error(rpc_debug_level, "error waiting for event: %s",
+					lwfs_err_str(rc));
+			break; 
+		}
+
+		req = (lwfs_request *)event.md.user_ptr; 
+
+		switch (event.type) {
+			case PTL_EVENT_PUT_START:
+				req->cq_events |= CQ_GOT_PUT_START; 
+				break;
+			case PTL_EVENT_PUT_END:
+				req->cq_events |= CQ_GOT_PUT_END; 
+				break;
+			case PTL_EVENT_UNLINK:
+				req->cq_events |= CQ_GOT_UNLINK; 
+				break;
+			default:
+				log_error(rpc_debug_level, "unexpected event (%d)", event.type);
+				return LWFS_ERR_RPC; 
+		}
+
+		if (req->cq_events != CQ_GOT_ALL) {
+			continue; 
+		}
+
+		log_debug(rpc_debug_level, "received short result of request %lu", req->id); 
+
+		req->cq_events = 0; 
+		if (finish_cq_request(cq, req, event.md.start + event.offset, timeout)) {
+			done[(*num_done)++] = req; 
+		}
+	}
+
+	return rc; 
+}
@@ -91,6 +91,8 @@ extern "C" {
 
 	typedef enum lwfs_request_status lwfs_request_status;
 
+	struct lwfs_completion_queue; 
+
 
 	/* 
 	 * @ingroup rpc_client_api_test
@@ -145,6 +147,14 @@ extern "C" {
 		  This field is implementation specific. */
 		ptl_handle_eq_t args_eq_h; 
 
+		/** @brief Handle for the Portals memory descriptor for the long 
+		  arguments.  This field is implementation specific. */
+		ptl_handle_md_t args_md_h; 
+
+		/** @brief The encoded long arguments (NULL if the args fit 
+		  in the short request).  This field is implementation specific. */
+		char *args_buf; 
+
 		/** @brief Handle for the Portals event queue for bulk data.  
 		  This field is implementation specific. */
 		ptl_handle_eq_t data_eq_h;
@@ -157,8 +167,100 @@ extern "C" {
 		  results. This field is implementation specific.*/
 		ptl_handle_eq_t short_res_eq_h;
 
+		/** @brief Where the short request went.  This field 
+		  is implementation specific. */
+		lwfs_rma req_addr; 
+
+		/** @brief The encoded short request, kept so we can send it
+		  again if the server is busy.  This field is implementation specific. */
+		char *short_req_buf; 
+
+		/** @brief Size of the short request buffer.  This field 
+		  is implementation specific. */
+		uint32_t short_req_size; 
+
+		/** @brief Valid bytes in the short request buffer.  This field 
+		  is implementation specific. */
+		uint32_t short_req_len; 
+
+		/** @brief Match bits of the short result.  This field 
+		  is implementation specific. */
+		lwfs_match_bits res_match_bits; 
+
+		/** @brief Number of times the server answered \ref LWFS_ERR_BUSY. */
+		int busy_retries; 
+
+		/** @brief When to send the request again after \ref LWFS_ERR_BUSY
+		  (0 if no retry is pending).  This field is implementation specific. */
+		double busy_retry_at; 
+
+		/** @brief Completion queue for the short result (NULL if the
+		  request has an event queue of its own).  This field is 
+		  implementation specific. */
+		struct lwfs_completion_queue *cq; 
+
+		/** @brief Events of the short result seen on the completion 
+		  queue.  This field is implementation specific. */
+		int cq_events; 
+
 	} lwfs_request;
 
+	/** 
+	 * @ingroup rpc_client_api
+	 *
+	 * @brief A queue shared by many pending requests. 
+	 *
+	 * Requests sent by \ref lwfs_call_rpcv deliver their short 
+	 * results through the event queue of a completion queue, 
+	 * so \ref lwfs_cq_harvest finds every finished request in 
+	 * one pass instead of polling one event queue per request. 
+	 * A completion queue belongs to one thread. 
+	 */
+	typedef struct lwfs_completion_queue {
+		/** @brief Event queue for the short results. */
+		ptl_handle_eq_t eq_h; 
+
+		/** @brief Most requests that can be pending at once. */
+		int size; 
+
+		/** @brief Requests sent, but not harvested yet. */
+		int num_pending; 
+
+		/** @brief Pending requests the server was too busy for 
+		  (the harvest sends them again when they are due). */
+		struct lwfs_request **busy; 
+
+		/** @brief Number of entries in \em busy. */
+		int num_busy; 
+	} lwfs_completion_queue; 
+
+	/** 
+	 * @ingroup rpc_client_api
+	 *
+	 * @brief One call in a vector of remote procedure calls. 
+	 *
+	 * The fields are the arguments of \ref lwfs_call_rpc. 
+	 */
+	typedef struct {
+		/** @brief The remote service. */
+		const lwfs_service *svc; 
+
+		/** @brief The remote operation. */
+		lwfs_opcode opcode; 
+
+		/** @brief The unencoded arguments. */
+		void *args; 
+
+		/** @brief Memory for bulk data (NULL if not used). */
+		void *data; 
+
+		/** @brief Length of the data buffer. */
+		uint32_t data_len; 
+
+		/** @brief Memory for the result. */
+		void *result; 
+	} lwfs_rpc_call; 
+
 	/** 
 	 * @brief The core of the LWFS includes service
 	 *        descriptions for authorization, 
@@ -404,6 +506,93 @@ extern "C" {
 				lwfs_request *req); 
 
 
+	/**
+	 * @brief Create a completion queue.
+	 *
+	 * @ingroup rpc_client_api
+	 *
+	 * @param size  @input_type  Most requests that can be pending on the queue.
+	 * @param cq    @output_type The completion queue.
+	 */
+	extern int lwfs_cq_init(
+			const int size,
+			lwfs_completion_queue *cq); 
+
+	/**
+	 * @brief Free a completion queue.
+	 *
+	 * @ingroup rpc_client_api
+	 *
+	 * Harvest every pending request first.
+	 */
+	extern int lwfs_cq_fini(
+			lwfs_completion_queue *cq); 
+
+	/**  
+	 * @brief Call a vector of remote procedures. 
+	 *
+	 * @ingroup rpc_client_api
+	 *  
+	 * The <tt>\ref lwfs_call_rpcv</tt> function sends \em count 
+	 * requests, possibly to different services, that complete 
+	 * through the completion queue \em cq.  Like 
+	 * <tt>\ref lwfs_call_rpc</tt>, it does not wait for the 
+	 * remote methods. 
+	 *
+	 * If sending a request fails, the function returns the error 
+	 * without sending the rest.  The requests already sent 
+	 * (\em num_sent) are pending and must be harvested. 
+	 *
+	 * @param calls     @input_type  The calls.
+	 * @param count     @input_type  The number of calls.
+	 * @param cq        @input_type  The completion queue for the requests.
+	 * @param reqs      @output_type Array of \em count pending requests. 
+	 * @param num_sent  @output_type The number of requests sent. 
+	 *
+	 * @return <b>\ref LWFS_ERR_NOSPACE</b> Indicates that the completion 
+	 *                              queue has no room for the requests. 
+	 */
+	extern int lwfs_call_rpcv(
+			const lwfs_rpc_call *calls, 
+			const int count, 
+			lwfs_completion_queue *cq, 
+			lwfs_request *reqs, 
+			int *num_sent); 
+
+	/** 
+	 * @brief Collect finished requests from a completion queue. 
+	 *
+	 * @ingroup rpc_client_api
+	 *
+	 * The <tt>\ref lwfs_cq_harvest</tt> function blocks for no more 
+	 * than \em timeout milliseconds waiting for a request on the 
+	 * queue to complete, then collects every other request that 
+	 * already finished, up to \em max_done.  The status and 
+	 * error_code fields of each collected request hold the 
+	 * outcome of the remote method. 
+	 *
+	 * Requests the server was too busy for are sent again 
+	 * (see \ref lwfs_rpc_set_busy_retries) and stay pending. 
+	 *
+	 * @param cq        @input_type  The completion queue. 
+	 * @param timeout   @input_type  The time to wait for the first request (-1 waits forever).
+	 * @param done      @output_type Array of \em max_done pointers to finished requests. 
+	 * @param max_done  @input_type  The size of the done array. 
+	 * @param num_done  @output_type The number of finished requests. 
+	 *
+	 * @return <b>\ref LWFS_OK</b> Indicates that at least one request completed. 
+	 * @return <b>\ref LWFS_ERR_TIMEDOUT</b> Indicates that no request completed
+	 *                                within the alloted time. 
+	 * @return <b>\ref LWFS_ERR_RPC</b> Indicates failure in the low-level transport mechanism. 
+	 */
+	extern int lwfs_cq_harvest(
+			lwfs_completion_queue *cq, 
+			int timeout, 
+			lwfs_request **done, 
+			const int max_done, 
+			int *num_done); 
+
+
 	/**  
 	 * @brief Test for completion of an RPC request. 
 	 * 
@@ -478,7 +667,9 @@ extern "C" {
 	 * @brief Wait for all requests to complete. 
 	 *
 	 * A request is not complete unless we receive the short
-	 * result. 
+	 * result.  Requests sent by \ref lwfs_call_rpcv are harvested 
+	 * from their completion queue, so each pass collects every 
+	 * request that already finished. 
 	 *
 	 * @param req_array  @input_type  The array of pending requests.
 	 * @param size       @input_type  The number of pending requests.
@@ -497,7 +688,8 @@ extern "C" {
 	 *
 	 * The <tt>\ref lwfs_waitany</tt> function blocks for no more than 
 	 * \em timeout milliseconds waiting for any one of an array of requests
-	 * to complete. 
+	 * to complete.  If the requests were sent by \ref lwfs_call_rpcv, they 
+	 * must all share one completion queue. 
 	 * 
 	 * @param req_array  @input_type Points to an array of requests.
 	 * @param size       @input_type The size of the request array. 
@@ -543,6 +735,23 @@ extern "C" {
 			lwfs_request_status *status,
 			int *rc); 
 
+	/**
+	 * @brief Configure retries of requests the server was too busy for.
+	 *
+	 * @ingroup rpc_client_api
+	 *
+	 * When a server answers \ref LWFS_ERR_BUSY, the wait functions
+	 * send the request again after a random delay (up to twice
+	 * as long each time, but at most \em max_backoff_ms).  After
+	 * \em max_retries retries, the caller gets \ref LWFS_ERR_BUSY.
+	 *
+	 * @param max_retries     @input_type Retries per request (0 disables retries).
+	 * @param max_backoff_ms  @input_type Longest delay between retries (msec).
+	 */
+	extern void lwfs_rpc_set_busy_retries(
+			const int max_retries,
+			const int max_backoff_ms);
+
 #else /* K&R C */
 #endif
 
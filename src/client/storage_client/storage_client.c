@@ -327,6 +327,166 @@ int lwfs_write(
 
 } /* lwfs_write() */
 
+
+/** 
+ * @brief Read from many objects at once. 
+ *
+ * @ingroup ss_api
+ *  
+ * The \b lwfs_readv method sends a read for each extent 
+ * through the completion queue \em cq. 
+ *
+ * @param txn_id @input transaction ID.
+ * @param extents @input the ranges to read. 
+ * @param count @input the number of extents. 
+ * @param cap @input the capability that allows the operation.
+ * @param results @output the number of bytes read for each extent. 
+ * @param cq @input the completion queue for the requests.
+ * @param reqs @output the request handles (used to test for completion). 
+ * @param num_sent @output the number of requests sent. 
+ */
+int lwfs_readv(
+		const lwfs_txn *txn_id,
+		const lwfs_obj_extent *extents, 
+		const int count, 
+		const lwfs_cap *cap, 
+		lwfs_size *results,
+		lwfs_completion_queue *cq, 
+		lwfs_request *reqs, 
+		int *num_sent)
+{
+	int rc = LWFS_OK;
+	ss_read_args *args = NULL;
+	lwfs_rpc_call *calls = NULL;
+	int i;
+
+	*num_sent = 0; 
+
+	/* initialize the storage client (if necessary) */
+	rc = ss_init(); 
+	if (rc != LWFS_OK) {
+		log_error(ss_debug_level, "failed to initialize storage client");
+		return rc;
+	}
+
+	/* the args only have to live until they are encoded */
+	args = (ss_read_args *)calloc(count, sizeof(ss_read_args));
+	calls = (lwfs_rpc_call *)calloc(count, sizeof(lwfs_rpc_call));
+	if ((args == NULL) || (calls == NULL)) {
+		log_error(ss_debug_level, "out of space for %d reads", count);
+		rc = LWFS_ERR_NOSPACE; 
+		goto cleanup; 
+	}
+
+	for (i=0; i<count; i++) {
+		args[i].txn_id = (lwfs_txn *)txn_id;
+		args[i].src_obj = (lwfs_obj *)extents[i].obj; 
+		args[i].src_offset = extents[i].offset; 
+		args[i].len = extents[i].len; 
+		args[i].cap = (lwfs_cap *)cap; 
+
+		calls[i].svc = &extents[i].obj->svc; 
+		calls[i].opcode = LWFS_OP_READ; 
+		calls[i].args = &args[i]; 
+		calls[i].data = extents[i].buf; 
+		calls[i].data_len = extents[i].len; 
+		calls[i].result = &results[i]; 
+	}
+
+	/* send the requests to execute the remote procedures */
+	rc = lwfs_call_rpcv(calls, count, cq, reqs, num_sent);
+	if (rc != LWFS_OK) {
+		log_error(ss_debug_level, "unable to call remote methods: %s",
+				lwfs_err_str(rc));
+		goto cleanup; 
+	}
+
+cleanup:
+	free(args); 
+	free(calls); 
+
+	return rc;
+} /* lwfs_readv() */
+
+
+/** 
+ * @brief Write to many objects at once. 
+ *
+ * @ingroup ss_api 
+ *
+ * The \b lwfs_writev method sends a write for each extent 
+ * through the completion queue \em cq. 
+ *
+ * @param txn_id @input transaction ID.
+ * @param extents @input the ranges to write. 
+ * @param count @input the number of extents. 
+ * @param cap @input the capability that allows the operation.
+ * @param cq @input the completion queue for the requests.
+ * @param reqs @output the request handles (used to test for completion). 
+ * @param num_sent @output the number of requests sent. 
+ */
+int lwfs_writev(
+		const lwfs_txn *txn_id,
+		const lwfs_obj_extent *extents, 
+		const int count, 
+		const lwfs_cap *cap, 
+		lwfs_completion_queue *cq, 
+		lwfs_request *reqs, 
+		int *num_sent)
+{
+	int rc = LWFS_OK;
+	ss_write_args *args = NULL;
+	lwfs_rpc_call *calls = NULL;
+	int i;
+
+	*num_sent = 0; 
+
+	/* initialize the storage client (if necessary) */
+	rc = ss_init(); 
+	if (rc != LWFS_OK) {
+		log_error(ss_debug_level, "failed to initialize storage client");
+		return rc;
+	}
+
+	/* the args only have to live until they are encoded */
+	args = (ss_write_args *)calloc(count, sizeof(ss_write_args));
+	calls = (lwfs_rpc_call *)calloc(count, sizeof(lwfs_rpc_call));
+	if ((args == NULL) || (calls == NULL)) {
+		log_error(ss_debug_level, "out of space for %d writes", count);
+		rc = LWFS_ERR_NOSPACE; 
+		goto cleanup; 
+	}
+
+	for (i=0; i<count; i++) {
+		args[i].txn_id = (lwfs_txn *)txn_id; 
+		args[i].dest_obj = (lwfs_obj *)extents[i].obj;
+		args[i].dest_offset = extents[i].offset; 
+		args[i].len = extents[i].len; 
+		args[i].cap = (lwfs_cap *)cap; 
+
+		calls[i].svc = &extents[i].obj->svc; 
+		calls[i].opcode = LWFS_OP_WRITE; 
+		calls[i].args = &args[i]; 
+		calls[i].data = extents[i].buf; 
+		calls[i].data_len = extents[i].len; 
+		calls[i].result = NULL; 
+	}
+
+	/* send the requests to execute the remote procedures */
+	rc = lwfs_call_rpcv(calls, count, cq, reqs, num_sent);
+	if (rc != LWFS_OK) {
+		log_error(ss_debug_level, "unable to call remote methods: %s",
+				lwfs_err_str(rc));
+		goto cleanup; 
+	}
+
+cleanup:
+	free(args); 
+	free(calls); 
+
+	return rc;
+} /* lwfs_writev() */
+
 	
 int lwfs_fsync(
         const lwfs_txn *txn_id,
@@ -955,3 +1115,68 @@ int lwfs_truncate(
 
 	return rc;
 } /* lwfs_truncate() */
+
+
+/**
+ * @brief Run a list of operations on one storage server. 
+ *
+ * @param txn_id @input transaction ID.
+ * @param ops @input the operations. 
+ * @param count @input the number of operations. 
+ * @param cap @input the capability that allows the operations.
+ * @param res @output the results of the operations.
+ * @param req @output the request handle (used to test for completion)
+ */
+int lwfs_compound(
+		const lwfs_txn *txn_id,
+		const ss_compound_op *ops, 
+		const int count, 
+		const lwfs_cap *cap, 
+		ss_compound_res *res, 
+		lwfs_request *req)
+{
+	int rc = LWFS_OK;
+	int i; 
+
+	ss_compound_args args;
+
+	/* initialize the storage client (if necessary) */
+	if (ss_init() != LWFS_OK) {
+		log_error(ss_debug_level, "failed to initialize storage client");
+		return rc;
+	}
+
+	if (count <= 0) {
+		log_error(ss_debug_level, "empty compound request");
+		return LWFS_ERR;
+	}
+
+	/* one request goes to one server */
+	for (i=1; i<count; i++) {
+		if ((ops[i].obj.svc.req_addr.match_id.nid != ops[0].obj.svc.req_addr.match_id.nid) || 
+			(ops[i].obj.svc.req_addr.match_id.pid != ops[0].obj.svc.req_addr.match_id.pid)) {
+			log_error(ss_debug_level, "compound request spans storage servers");
+			return LWFS_ERR;
+		}
+	}
+
+	/* initialize the args */
+	memset(&args, 0, sizeof(ss_compound_args));
+	args.txn_id = (lwfs_txn *)txn_id;
+	args.ops.ops_len = count;
+	args.ops.ops_val = (ss_compound_op *)ops;
+	args.cap = (lwfs_cap *)cap; 
+
+	memset(res, 0, sizeof(ss_compound_res));
+
+	/* send a request to execute the remote procedure */
+	rc = lwfs_call_rpc(&ops[0].obj.svc, LWFS_OP_COMPOUND, 
+			&args, NULL, 0, res, req);
+	if (rc != LWFS_OK) {
+		log_error(ss_debug_level, "unable to call remote method: %s",
+				lwfs_err_str(rc));
+		return rc; 
+	}
+
+	return rc;
+} /* lwfs_compound() */
@@ -54,6 +54,23 @@
 extern "C" {
 #endif
 
+	/**
+	 * @brief A range of bytes of an object (see \ref lwfs_readv).
+	 */
+	typedef struct {
+		/** @brief The object. */
+		const lwfs_obj *obj; 
+
+		/** @brief Where the range starts in the object. */
+		lwfs_size offset; 
+
+		/** @brief The local memory for the range. */
+		void *buf; 
+
+		/** @brief The number of bytes in the range. */
+		lwfs_size len; 
+	} lwfs_obj_extent; 
+
 #if defined(__STDC__) || defined(__cplusplus)
 
 	/**
@@ -215,6 +232,77 @@ extern "C" {
 			const lwfs_cap *cap, 
 			lwfs_request *req); 
 
+	/** 
+	 * @brief Read from many objects at once. 
+	 *
+	 * @ingroup ss_api
+	 *  
+	 * The <tt>\ref lwfs_readv</tt> function sends one read for 
+	 * each extent, possibly to different storage servers, with 
+	 * <tt>\ref lwfs_call_rpcv</tt>.  The reads complete through the 
+	 * completion queue \em cq, so <tt>\ref lwfs_waitall</tt> (or 
+	 * <tt>\ref lwfs_cq_harvest</tt>) collects the finished reads 
+	 * in one pass. 
+	 *
+	 * @param txn  @input_type Points to the transaction ID (NULL if no transaction).
+	 * @param extents @input_type The ranges to read. 
+	 * @param count @input_type The number of extents. 
+	 * @param cap @input_type The capability that allows the holder to read
+	 *                   the objects (they share one container).
+	 * @param results @output_type The number of bytes read for each extent. 
+	 * @param cq @input_type The completion queue for the requests. 
+	 * @param reqs @output_type Array of \em count request handles. 
+	 * @param num_sent @output_type The number of requests sent (see 
+	 *                   <tt>\ref lwfs_call_rpcv</tt>). 
+	 *
+	 * @return <b>\ref LWFS_OK</b> Success.
+	 * @return <b>\ref LWFS_ERR_NOSPACE</b> The completion queue has no room
+	 *                                  for the requests. 
+	 * @return <b>\ref LWFS_ERR_RPC</b> Failure in the 
+	 *                                  communication library. 
+	 */
+	extern int lwfs_readv(
+			const lwfs_txn *txn,
+			const lwfs_obj_extent *extents, 
+			const int count, 
+			const lwfs_cap *cap, 
+			lwfs_size *results,
+			lwfs_completion_queue *cq, 
+			lwfs_request *reqs, 
+			int *num_sent);
+
+	/** 
+	 * @brief Write to many objects at once. 
+	 *
+	 * @ingroup ss_api 
+	 *  
+	 * The <tt>\ref lwfs_writev</tt> function is the 
+	 * <tt>\ref lwfs_readv</tt> of writes.  The buffers of the 
+	 * extents must not change until the requests complete. 
+	 *
+	 * @param txn  @input_type Points to the transaction ID (NULL if no transaction).
+	 * @param extents @input_type The ranges to write. 
+	 * @param count @input_type The number of extents. 
+	 * @param cap @input_type The capability that allows the holder to write
+	 *                   the objects (they share one container).
+	 * @param cq @input_type The completion queue for the requests. 
+	 * @param reqs @output_type Array of \em count request handles. 
+	 * @param num_sent @output_type The number of requests sent. 
+	 *
+	 * @return <b>\ref LWFS_OK</b> Success.
+	 * @return <b>\ref LWFS_ERR_NOSPACE</b> The completion queue has no room
+	 *                                  for the requests. 
+	 * @return <b>\ref LWFS_ERR_RPC</b> Failure in the communication library. 
+	 */
+	extern int lwfs_writev(
+			const lwfs_txn *txn,
+			const lwfs_obj_extent *extents, 
+			const int count, 
+			const lwfs_cap *cap, 
+			lwfs_completion_queue *cq, 
+			lwfs_request *reqs, 
+			int *num_sent); 
+
 	/** 
 	 * @brief Sync to an object. 
 	 *
@@ -549,6 +637,38 @@ extern "C" {
 			const lwfs_cap *cap, 
 			lwfs_request *req);
 
+	/** 
+	 * @brief Run a list of operations on one storage server. 
+	 *
+	 * The \b lwfs_compound method sends an ordered list of 
+	 * operations (create, small write, setattr, truncate, fsync, 
+	 * stat) in a single request.  The server checks the cap once 
+	 * and runs the operations in order, stopping at the first 
+	 * one that fails.  All objects must be on the same storage 
+	 * server and in the container of the cap. 
+	 *
+	 * The result has one entry per operation that ran.  Free it 
+	 * with <tt>xdr_free((xdrproc_t)xdr_ss_compound_res, res)</tt>. 
+	 *
+	 * @param txn @input_type transaction ID.
+	 * @param ops @input_type the operations. 
+	 * @param count @input_type the number of operations. 
+	 * @param cap @input_type the capability that allows the operations.
+	 * @param res @output_type the results of the operations.
+	 * @param req @output_type the request handle (used to test for completion)
+	 *
+	 * @return <b>\ref LWFS_OK</b> Indicates success. 
+	 * @return <b>\ref LWFS_ERR_RPC</b> Indicates an failure in the 
+	 *                                  communication library. 
+	 */
+	extern int lwfs_compound(
+			const lwfs_txn *txn,
+			const ss_compound_op *ops, 
+			const int count, 
+			const lwfs_cap *cap, 
+			ss_compound_res *res, 
+			lwfs_request *req);
+
 
 #else /* K&R C */
 
@@ -60,6 +60,106 @@ int lwfs_create_obj_sync(
 	return rc; 
 }
 
+/* TRUE if two services are the same server */
+static lwfs_bool same_server(
+		const lwfs_service *a, 
+		const lwfs_service *b)
+{
+	return (a->req_addr.match_id.nid == b->req_addr.match_id.nid) && 
+		(a->req_addr.match_id.pid == b->req_addr.match_id.pid); 
+}
+
+/** 
+ * @brief Create many objects. 
+ *
+ * The objects of each storage server (wherever they are in 
+ * \em objs) go out in one compound request of creates, so the 
+ * server checks the cap once for all of them. 
+ *
+ * @param txn_id @input transaction ID.
+ * @param objs @input the new objects (see \ref lwfs_init_obj).
+ * @param count @input the number of objects. 
+ * @param cap @input the capability that allows creation of the objects. 
+ * @param created @output the number of objects created (may be NULL).
+ */
+int lwfs_create_objs_sync(
+		const lwfs_txn *txn_id,
+		const lwfs_obj *objs,
+		const int count,
+		const lwfs_cap *cap, 
+		int *created)
+{
+	int rc = LWFS_OK; 
+	int i, j, n, first, len; 
+	ss_compound_op *ops = NULL; 
+	lwfs_bool *grouped = NULL; 
+	ss_compound_res res; 
+
+	if (created) {
+		*created = 0; 
+	}
+
+	if (count <= 0) {
+		return LWFS_OK; 
+	}
+
+	ops = (ss_compound_op *)calloc(count, sizeof(ss_compound_op)); 
+	grouped = (lwfs_bool *)calloc(count, sizeof(lwfs_bool)); 
+	if ((ops == NULL) || (grouped == NULL)) {
+		log_error(ss_debug_level, "out of memory");
+		rc = LWFS_ERR_NOSPACE; 
+		goto cleanup; 
+	}
+
+	/* put the objects of each server next to each other */
+	n = 0; 
+	for (i=0; i<count; i++) {
+		if (grouped[i]) {
+			continue; 
+		}
+		for (j=i; j<count; j++) {
+			if (!grouped[j] && same_server(&objs[i].svc, &objs[j].svc)) {
+				memcpy(&ops[n].obj, &objs[j], sizeof(lwfs_obj)); 
+				ops[n].args.op = SS_COMPOUND_CREATE; 
+				grouped[j] = TRUE; 
+				n++; 
+			}
+		}
+	}
+
+	for (first=0; first<count; first+=len) {
+
+		/* the objects of one server */
+		for (len=1; first+len<count; len++) {
+			if (!same_server(&ops[first+len].obj.svc, &ops[first].obj.svc)) {
+				break; 
+			}
+		}
+
+		memset(&res, 0, sizeof(ss_compound_res)); 
+		rc = lwfs_compound_sync(txn_id, &ops[first], len, cap, &res); 
+		if (created) {
+			*created += res.results.results_len; 
+			if ((rc != LWFS_OK) && (res.results.results_len > 0)) {
+				(*created)--;   /* the last one failed */
+			}
+		}
+		xdr_free((xdrproc_t)xdr_ss_compound_res, (char *)&res); 
+
+		if (rc != LWFS_OK) {
+			log_error(ss_debug_level, "unable to create objects: %s",
+				lwfs_err_str(rc));
+			break; 
+		}
+	}
+
+cleanup:
+	free(ops); 
+	free(grouped); 
+
+	return rc; 
+}
+
 
 /** 
  * @brief Remove an object. 
@@ -604,3 +704,38 @@ int lwfs_truncate_sync(
 
 	return rc; 
 }
+
+int lwfs_compound_sync(
+		const lwfs_txn *txn_id,
+		const ss_compound_op *ops, 
+		const int count, 
+		const lwfs_cap *cap, 
+		ss_compound_res *res)
+{
+	int rc = LWFS_OK; 
+	int rc2 = LWFS_OK; 
+	lwfs_request req; 
+	u_int last; 
+
+	rc = lwfs_compound(txn_id, ops, count, cap, res, &req);
+	if (rc != LWFS_OK) {
+		log_error(ss_debug_level, "failed compound method: %s",
+			lwfs_err_str(rc));
+		return rc; 
+	}
+	
+	rc2 = lwfs_wait(&req, &rc); 
+	if (rc2 != LWFS_OK) {
+		log_error(ss_debug_level, "failed waiting for result:%s",
+			lwfs_err_str(rc));
+		return rc2; 
+	}
+
+	/* the server stops at the first operation that fails */
+	if ((rc == LWFS_OK) && (res->results.results_len > 0)) {
+		last = res->results.results_len - 1; 
+		rc = res->results.results_val[last].rc; 
+	}
+
+	return rc; 
+}
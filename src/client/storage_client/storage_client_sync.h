@@ -57,6 +57,29 @@ extern "C" {
 			const lwfs_obj *obj, 
 			const lwfs_cap *cap);
 
+	/** 
+	 * @brief Create many objects. 
+	 *
+	 * Sends one compound request of creates (see \ref lwfs_compound) 
+	 * to each storage server, instead of one request per object. 
+	 * The objects of a server do not have to be next to each other 
+	 * in \em objs.  The servers are done one after another; on an 
+	 * error the objects of the servers not reached yet are not 
+	 * created. 
+	 *
+	 * @param txn_id @input_type transaction ID.
+	 * @param objs @input_type the new objects (see \ref lwfs_init_obj).
+	 * @param count @input_type the number of objects. 
+	 * @param cap @input_type the capability that allows creation of the objects. 
+	 * @param created @output_type the number of objects created (may be NULL).
+	 */
+	extern int lwfs_create_objs_sync(
+			const lwfs_txn *txn_id,
+			const lwfs_obj *objs,
+			const int count,
+			const lwfs_cap *cap, 
+			int *created);
+
 
 	/** 
 	 * @brief Remove an object. 
@@ -425,6 +448,20 @@ extern "C" {
 			const lwfs_ssize size, 
 			const lwfs_cap *cap);
 
+	/** 
+	 * @brief Run a list of operations on one storage server (blocking). 
+	 *
+	 * See \ref lwfs_compound.  Returns the error of the operation 
+	 * that failed, if one did; \em res still holds the results of 
+	 * the operations that ran. 
+	 */
+	extern int lwfs_compound_sync(
+			const lwfs_txn *txn,
+			const ss_compound_op *ops, 
+			const int count, 
+			const lwfs_cap *cap, 
+			ss_compound_res *res);
+
 #else /* K&R C */
 
 #endif
@@ -48,6 +48,7 @@
 #include "client/authr_client/authr_client_sync.h"
 #include "client/storage_client/storage_client_sync.h"
 #include "client/naming_client/naming_client_sync.h"
+#include "client/naming_client/ns_cache.h"
 #include "common/config_parser/config_parser.h"
 #include "common/rpc_common/rpc_common.h"
 
@@ -159,6 +160,8 @@ typedef struct {
 	_SYSIO_OFF_T fpos;              /* current position */
 	time_t attrtim;
 	int use_fake_io;		/* if true, then fake the i/o */
+	char dir_cookie[LWFS_NAME_LEN+1]; /* last name readdir returned */
+	_SYSIO_OFF_T dir_pos;           /* readdir position after dir_cookie */
 } lwfs_inode;
 
 /* ------ Function Prototypes -------- */
@@ -183,6 +186,12 @@ struct cap_key {
 };
 
 
+/* ------ NAMESPACE CACHE -------- */
+
+/* entries found by traverse_path (see ns_cache.h) */
+static lwfs_ns_cache ns_cache; 
+
+
 /* make the hashtable functions type-safe */
 DEFINE_HASHTABLE_INSERT(insert_cap, struct cap_key, lwfs_cap);
 DEFINE_HASHTABLE_SEARCH(search_cap, struct cap_key, lwfs_cap);
@@ -301,7 +310,9 @@ static struct filesys_ops lwfs_inodesys_ops = {
 };
 
 struct request_entry {
-	lwfs_request *req;
+	lwfs_request *reqs;	/* a vector of stripe requests */
+	lwfs_size *results;	/* bytes read by each request */
+	int num_reqs;
 	TAILQ_ENTRY(request_entry) np; /* next and prev pointer for the list */
 };
 TAILQ_HEAD(request_list, request_entry);
@@ -314,6 +325,7 @@ typedef struct {
 	struct inode        *lio_ino;	/* cache the inode */
 	lwfs_filesystem     *lio_fs;
 	struct request_list *lio_outstanding_requests; /* AIO requests */
+	lwfs_completion_queue *lio_cq;	/* where the AIO requests complete */
 } lwfs_io;
 
 
@@ -322,6 +334,10 @@ static int traverse_path(
 	lwfs_filesystem *lwfs_fs,
 	const char *path,
 	lwfs_ns_entry *result);
+static int lookup_path(
+	lwfs_filesystem *lwfs_fs,
+	const char *path,
+	lwfs_ns_entry *result);
 
 
 /*
@@ -916,54 +932,53 @@ sso_store_mo(
 	int dso_count)
 {
 	int rc = LWFS_OK;
+	int i; 
 
 	int offset=0;
 	int csize = chunk_size; 
 
+	ss_compound_op ops[3]; 
+	ss_compound_res res; 
+
 	log_debug(sysio_debug_level, "entered sso_store_mo");
 
-	/* put header info in the MO */
-	rc = lwfs_write_sync(txn, 
-			     mo,
-			     offset, (void *)&csize, sizeof(int),
-			     cap);
-	if (rc != LWFS_OK) {
-		log_error(sysio_debug_level, "could not write chunk_size: %s",
-			lwfs_err_str(rc));
-		errno = EIO;
-		goto cleanup;
-	}
-	log_debug(sysio_debug_level, "wrote the header");
+	memset(ops, 0, sizeof(ops)); 
+	memset(&res, 0, sizeof(res)); 
 
-	offset += sizeof(int);
-	rc = lwfs_write_sync(txn, 
-			     mo,
-			     offset, (void *)&dso_count, sizeof(int),
-			     cap);
-	if (rc != LWFS_OK) {
-		log_error(sysio_debug_level, "could not write the dso_count: %s",
-			lwfs_err_str(rc));
-		errno = EIO;
-		goto cleanup;
+	/* the header (chunk_size, dso_count) and the obj refs to the 
+	 * DSOs go to the MO in one request */
+	for (i=0; i<3; i++) {
+		ops[i].obj = *mo; 
+		ops[i].args.op = SS_COMPOUND_WRITE; 
 	}
 
-	log_debug(sysio_debug_level, "wrote dso_count");
+	ops[0].args.ss_compound_op_args_u.write.offset = offset; 
+	ops[0].args.ss_compound_op_args_u.write.data.data_len = sizeof(int); 
+	ops[0].args.ss_compound_op_args_u.write.data.data_val = (char *)&csize; 
+	offset += sizeof(int);
 
+	ops[1].args.ss_compound_op_args_u.write.offset = offset; 
+	ops[1].args.ss_compound_op_args_u.write.data.data_len = sizeof(int); 
+	ops[1].args.ss_compound_op_args_u.write.data.data_val = (char *)&dso_count; 
 	offset += sizeof(int);
-	/* put obj refs to DSOs in the MO */
-	rc = lwfs_write_sync(txn, 
-			     mo,
-			     offset, (void *)dso, (dso_count * sizeof(lwfs_obj)),
-			     cap);
+
+	ops[2].args.ss_compound_op_args_u.write.offset = offset; 
+	ops[2].args.ss_compound_op_args_u.write.data.data_len = dso_count * sizeof(lwfs_obj); 
+	ops[2].args.ss_compound_op_args_u.write.data.data_val = (char *)dso; 
+	offset += (dso_count * sizeof(lwfs_obj));
+
+	rc = lwfs_compound_sync(txn, ops, 3, cap, &res);
 	if (rc != LWFS_OK) {
-		log_error(sysio_debug_level, "could not write the dso array: %s",
-			lwfs_err_str(rc));
+		log_error(sysio_debug_level, "could not write the MO (%d of 3 writes ran): %s",
+			res.results.results_len, lwfs_err_str(rc));
 		errno = EIO;
 		goto cleanup;
 	}
-	offset += (dso_count * sizeof(lwfs_obj));
+	log_debug(sysio_debug_level, "wrote the header and dso array");
 
 cleanup:
+	xdr_free((xdrproc_t)xdr_ss_compound_res, (char *)&res); 
+
 	log_debug(sysio_debug_level, "finished sso_store_mo");
 
 	return rc;
@@ -1228,129 +1243,157 @@ sso_calc_first_bytes_to_io(lwfs_ns_entry *ns_entry,
 	return bytes_to_io;
 }
 
-static int
-sso_doio(
+/* most stripe requests of one I/O pending at once */
+#define SSO_CQ_SIZE 64
+
+/*
+ * Fake I/O does not touch the storage servers.
+ */
+static void
+sso_fake_io(
 	lwfs_io *lio_session, 
-	lwfs_obj *obj, 
-	_SYSIO_OFF_T off, 
-	void *buf, 
-	size_t count, 
+	const lwfs_obj_extent *ext, 
 	lwfs_size *nbytes)
 {
-    int rc = LWFS_OK;
-    lwfs_cap cap;
-    lwfs_cid cid = obj->cid; 
     char ostr[33];
 
+    if (lio_session->lio_op == 'r') {
+	log_debug(sysio_debug_level, "lwfs_read faking read from oid (%s)", 
+		lwfs_oid_to_string(ext->obj->oid, ostr));
+	if (lio_session->lio_ino->i_stbuf.st_size >= (ext->offset+ext->len)) {
+		*nbytes = ext->len;
+	} else {
+		*nbytes = lio_session->lio_ino->i_stbuf.st_size - ext->offset;
+	}
+	memset(ext->buf, 0, ext->len);
+	/* THK TODO:  */
+	I2LI(lio_session->lio_ino)->fpos = (ext->offset + ext->len);
+    }
+    if (lio_session->lio_op == 'w') {
+	log_debug(sysio_debug_level, "lwfs_write faking write to oid (%s)", 
+		lwfs_oid_to_string(ext->obj->oid, ostr));
+	*nbytes = ext->len;
+	/* THK TODO:  */
+	I2LI(lio_session->lio_ino)->fpos = (ext->offset + ext->len);
+	if ((ext->offset + ext->len) > lio_session->lio_ino->i_stbuf.st_size) {
+		lio_session->lio_ino->i_stbuf.st_size = (ext->offset + ext->len);
+	}
+    }
+}
+
+/*
+ * Send the stripe requests of an I/O as one vector. 
+ *
+ * The requests complete through the completion queue of the 
+ * session, so lwfs_inop_iodone collects the finished stripes 
+ * from every storage server in one pass. 
+ */
+static int
+sso_submit(
+	lwfs_io *lio_session, 
+	const lwfs_obj_extent *extents, 
+	int count)
+{
+    int rc = LWFS_OK;
+    lwfs_cap cap;
+    lwfs_cid cid = extents[0].obj->cid; 
     lwfs_filesystem *lwfs_fs = lio_session->lio_fs;
-    /* lwfs_ns_entry *ns_entry = &I2LI(lio_session->lio_ino)->ns_entry; */
+    lwfs_completion_queue *cq = NULL;
     struct request_entry *entry = NULL;
-    lwfs_request *req = calloc(1, sizeof(lwfs_request));
-    if (req == NULL) {
-	goto cleanup;
-    }
+    lwfs_request *done[SSO_CQ_SIZE];
+    int num_done;
+    int num_sent;
+    int n;
 
-    log_debug(sysio_debug_level, "entered sso_doio");
+    log_debug(sysio_debug_level, "entered sso_submit");
 
-    if (lio_session->lio_op == 'r') {
+    /* get the cap that allows me to access the objs in the container */
+    rc = check_cap_cache(&lwfs_fs->authr_svc, cid,
+	    (lio_session->lio_op == 'r')? LWFS_CONTAINER_READ : LWFS_CONTAINER_WRITE, 
+	    &lwfs_fs->cred, &cap); 
+    if (rc != LWFS_OK) {
+	log_error(sysio_debug_level, "unable to get cap: %s",
+		lwfs_err_str(rc));
+	return rc;
+    }
 
-	/* get the cap that allows me to read from objs in a container */
-	rc = check_cap_cache(&lwfs_fs->authr_svc, cid,
-		LWFS_CONTAINER_READ, &lwfs_fs->cred, &cap); 
-	if (rc != LWFS_OK) {
-		log_error(sysio_debug_level, "unable to get cap: %s",
-			lwfs_err_str(rc));
-		return rc;
+    /* one completion queue for all the requests of the session */
+    if (lio_session->lio_cq == NULL) {
+	cq = calloc(1, sizeof(lwfs_completion_queue));
+	if (cq == NULL) {
+	    return -ENOMEM;
 	}
-	log_debug(sysio_debug_level, "read from obj with cid=%d with cap for cid=%d", 
-		obj->cid, cap.data.cid);
-	log_debug(sysio_debug_level, "read(offset==%d, count==%d)", (int)off, (int)count);
-
-	if (I2LI(lio_session->lio_ino)->use_fake_io == FALSE) {
-		/* read from the object */
-		rc = lwfs_read(&lwfs_fs->txn, obj,
-			off, buf, count,
-			&cap, nbytes,
-			req);
-		log_debug(sysio_debug_level, "lwfs_read result: %s", lwfs_err_str(rc));
-		if (rc != LWFS_OK) {
-		    log_error(sysio_debug_level, "could not issue async read: %s",
-			    lwfs_err_str(rc));
-		    errno = EIO;
-		    rc = -EIO;
-		    goto cleanup;
-		}
-	} else {
-		log_debug(sysio_debug_level, "lwfs_read faking read from oid (%s)", 
-			lwfs_oid_to_string(obj->oid, ostr));
-		free(req);
-		req = NULL;
-		if (lio_session->lio_ino->i_stbuf.st_size >= (off+count)) {
-			*nbytes = count;
-		} else {
-			*nbytes = lio_session->lio_ino->i_stbuf.st_size - off;
-		}
-		memset(buf, 0, count);
-		/* THK TODO:  */
-		I2LI(lio_session->lio_ino)->fpos = (off + count);
+	rc = lwfs_cq_init(SSO_CQ_SIZE, cq);
+	if (rc != LWFS_OK) {
+	    log_error(sysio_debug_level, "could not create completion queue: %s",
+		    lwfs_err_str(rc));
+	    free(cq);
+	    return rc;
 	}
+	lio_session->lio_cq = cq;
     }
-    if (lio_session->lio_op == 'w') {
+    cq = lio_session->lio_cq;
 
-	/* get the cap that allows me to read from objs in a container */
-	rc = check_cap_cache(&lwfs_fs->authr_svc, cid,
-		LWFS_CONTAINER_WRITE, &lwfs_fs->cred, &cap); 
-	if (rc != LWFS_OK) {
-		log_error(sysio_debug_level, "unable to get cap: %s",
+    while (count > 0) {
+	n = (count < cq->size)? count : cq->size;
+
+	/* make room by collecting stripes that already finished 
+	 * (iodone finds them done and checks their status) */
+	while (cq->num_pending + n > cq->size) {
+	    rc = lwfs_cq_harvest(cq, -1, done, SSO_CQ_SIZE, &num_done);
+	    if (rc != LWFS_OK) {
+		log_error(sysio_debug_level, "could not harvest requests: %s",
 			lwfs_err_str(rc));
 		return rc;
+	    }
 	}
-	log_debug(sysio_debug_level, "write to obj with cid=%d with cap for cid=%d", 
-		obj->cid, cap.data.cid);
-	log_debug(sysio_debug_level, "offset==%d; count==%d", (int)off, (int)count);
-		
-	if (I2LI(lio_session->lio_ino)->use_fake_io == FALSE) {
-		/* write to the object */
-		rc = lwfs_write(&lwfs_fs->txn, obj,
-			off, buf, count,
-			&cap,
-			req);
-		log_debug(sysio_debug_level, "lwfs_write result: %s", lwfs_err_str(rc));
-		if (rc != LWFS_OK) {
-		    log_error(sysio_debug_level, "could not issue async write: %s",
-			    lwfs_err_str(rc));
-		    errno = EIO;
-		    rc = -EIO;
-		    goto cleanup;
-		}
+
+	entry = calloc(1, sizeof(struct request_entry));
+	if (entry != NULL) {
+	    entry->reqs = calloc(n, sizeof(lwfs_request));
+	    entry->results = calloc(n, sizeof(lwfs_size));
+	}
+	if ((entry == NULL) || (entry->reqs == NULL) || (entry->results == NULL)) {
+	    if (entry != NULL) {
+		free(entry->reqs);
+		free(entry->results);
+		free(entry);
+	    }
+	    return -ENOMEM;
+	}
+
+	if (lio_session->lio_op == 'r') {
+	    rc = lwfs_readv(&lwfs_fs->txn, extents, n, &cap, 
+		    entry->results, cq, entry->reqs, &num_sent);
 	} else {
-		log_debug(sysio_debug_level, "lwfs_write faking write to oid (%s)", 
-			lwfs_oid_to_string(obj->oid, ostr));
-		free(req);
-		req = NULL;
-		/* THK TODO:  */
-		I2LI(lio_session->lio_ino)->fpos = (off + count);
-		if ((off + count) > lio_session->lio_ino->i_stbuf.st_size) {
-			lio_session->lio_ino->i_stbuf.st_size = (off + count);
-		}
+	    rc = lwfs_writev(&lwfs_fs->txn, extents, n, &cap, 
+		    cq, entry->reqs, &num_sent);
 	}
-    }
 
-    *nbytes = count;
+	/* iodone waits for the requests that went out */
+	entry->num_reqs = num_sent;
+	if (num_sent > 0) {
+	    log_debug(LOG_ALL, "entry==%p, reqs==%p, num_reqs==%d", entry, entry->reqs, num_sent);
+	    TAILQ_INSERT_TAIL(lio_session->lio_outstanding_requests, entry, np);
+	} else {
+	    free(entry->reqs);
+	    free(entry->results);
+	    free(entry);
+	}
+
+	if (rc != LWFS_OK) {
+	    log_error(sysio_debug_level, "could not issue async %s: %s",
+		    (lio_session->lio_op == 'r')? "reads" : "writes", 
+		    lwfs_err_str(rc));
+	    errno = EIO;
+	    return -EIO;
+	}
 
-    entry = calloc(1, sizeof(struct request_entry));
-    if (entry == NULL) {
-    	free(req);
-    	rc = -ENOMEM;
-    	goto cleanup;
+	extents += n;
+	count -= n;
     }
-    entry->req = req;
-    log_debug(LOG_ALL, "entry==%p, req==%p", entry, req);
-    TAILQ_INSERT_TAIL(lio_session->lio_outstanding_requests, entry, np);
-//    lio_session->lio_outstanding_request = req;
 
-cleanup:
-    log_debug(sysio_debug_level, "finished sso_doio");
+    log_debug(sysio_debug_level, "finished sso_submit");
 
     return rc;
 }
@@ -1381,6 +1424,12 @@ sso_io(void *buf, size_t count, _SYSIO_OFF_T off, lwfs_io *lio_session)
 	/* the number of bytes read/written during to round of I/O */
 	lwfs_size nbytes=0;
 
+	/* one extent per stripe chunk */
+	lwfs_obj_extent *extents = NULL;
+	int max_extents;
+	int num_extents = 0;
+	int i;
+
 	log_debug(sysio_debug_level, "entered sso_io");
 	
 	if ((lio_session->lio_op == 'r') &&
@@ -1413,69 +1462,68 @@ sso_io(void *buf, size_t count, _SYSIO_OFF_T off, lwfs_io *lio_session)
 	log_debug(sysio_debug_level, "performing I/O on container %d", ns_entry->entry_obj.cid);
 	assert(ns_entry->entry_obj.cid == ns_entry->d_obj->ss_obj[first_obj_index].cid);
 
-	rc = sso_doio(lio_session, 
-		      &ns_entry->d_obj->ss_obj[first_obj_index], 
-		      first_obj_offset, 
-		      buf, 
-		      bytes_this_io, 
-		      &nbytes);
-	if (rc != LWFS_OK) {
-		log_error(sysio_debug_level, "the I/O failed: %s",
-			lwfs_err_str(rc));
+	/* the first chunk plus one extent per whole or partial chunk */
+	max_extents = 2 + bytes_left/ns_entry->d_obj->chunk_size;
+	extents = calloc(max_extents, sizeof(lwfs_obj_extent));
+	if (extents == NULL) {
+		errno = ENOMEM;
+		rc = -ENOMEM;
+		goto cleanup;
 	}
-//	if (nbytes == 0) {
-//		/* reached EOF */
-//		log_debug(sysio_debug_level, "reached EOF");
-//		rc = 0;
-//		goto cleanup;
-//	}
-	bytes_left -= nbytes;
-	buf_offset += nbytes;
-	file_offset += nbytes;
-	
-	log_debug(sysio_debug_level, "bytes_left == %d", bytes_left);
-	log_debug(sysio_debug_level, "buf_offset == %ld", buf_offset);
-	log_debug(sysio_debug_level, "file_offset == %ld", file_offset);
 
-	sso_calc_obj_index_offset(lwfs_fs, ns_entry, file_offset, &obj_index, &obj_offset);
-	while (bytes_left > 0) {
+	/* split the I/O into stripe chunks */
+	obj_index = first_obj_index;
+	obj_offset = first_obj_offset;
+	while ((bytes_left > 0) && (num_extents < max_extents)) {
+		extents[num_extents].obj = &ns_entry->d_obj->ss_obj[obj_index];
+		extents[num_extents].offset = obj_offset;
+		extents[num_extents].buf = buf + buf_offset;
+		extents[num_extents].len = bytes_this_io;
+		num_extents++;
+
+		bytes_left -= bytes_this_io;
+		buf_offset += bytes_this_io;
+		file_offset += bytes_this_io;
+
+		log_debug(sysio_debug_level, "bytes_left == %d", bytes_left);
+		log_debug(sysio_debug_level, "buf_offset == %ld", buf_offset);
+		log_debug(sysio_debug_level, "file_offset == %ld", file_offset);
+
 		if (bytes_left > ns_entry->d_obj->chunk_size) {
 			bytes_this_io = ns_entry->d_obj->chunk_size;
 		} else {
 			bytes_this_io = bytes_left;
 		}
-		rc = sso_doio(lio_session, 
-			      &ns_entry->d_obj->ss_obj[obj_index], 
-			      obj_offset, 
-			      buf + buf_offset, 
-			      bytes_this_io, 
-			      &nbytes);
-		if (rc != LWFS_OK) {
-			log_error(sysio_debug_level, "the I/O failed: %s",
-				lwfs_err_str(rc));
-			goto cleanup;
-		}
-		
-		bytes_left -= nbytes;
-		buf_offset += nbytes;
-		file_offset += nbytes;
-
-		log_debug(sysio_debug_level, "bytes_left == %d", bytes_left);
-		log_debug(sysio_debug_level, "buf_offset == %ld", buf_offset);
-		log_debug(sysio_debug_level, "file_offset == %ld", file_offset);
+		sso_calc_obj_index_offset(lwfs_fs, ns_entry, file_offset, &obj_index, &obj_offset);
+	}
 
-		if (nbytes < bytes_this_io) {
-			log_debug(sysio_debug_level, "short I/O, jumping out");
-			rc = buf_offset;
-			goto cleanup;
+	if (I2LI(lio_session->lio_ino)->use_fake_io == TRUE) {
+		buf_offset = 0;
+		for (i=0; i<num_extents; i++) {
+			sso_fake_io(lio_session, &extents[i], &nbytes);
+			buf_offset += nbytes;
+			if (nbytes < extents[i].len) {
+				log_debug(sysio_debug_level, "short I/O, jumping out");
+				break;
+			}
 		}
+		rc = buf_offset;
+		goto cleanup;
+	}
 
-		sso_calc_obj_index_offset(lwfs_fs, ns_entry, file_offset, &obj_index, &obj_offset);
+	/* send every chunk at once, lwfs_inop_iodone waits for them */
+	rc = sso_submit(lio_session, extents, num_extents);
+	if (rc != LWFS_OK) {
+		log_error(sysio_debug_level, "the I/O failed: %s",
+			lwfs_err_str(rc));
+		goto cleanup;
 	}
 	
 	rc = buf_offset;
 
 cleanup:
+	free(extents);
+
 	log_debug(sysio_debug_level, "finished sso_io");
 
 	return rc;
@@ -2416,6 +2464,28 @@ lwfs_fsswop_mount(const char *source,
 	    return LWFS_ERR_NOSPACE;
 	}
 
+	/* allocate the namespace cache (LWFS_NS_CACHE_TTL=0 disables it) */
+	{
+	    double ttl = LWFS_NS_CACHE_TTL; 
+	    double neg_ttl = LWFS_NS_CACHE_NEG_TTL; 
+	    char *env; 
+
+	    env = getenv("LWFS_NS_CACHE_TTL");
+	    if (env != NULL) {
+		ttl = atof(env);
+	    }
+	    env = getenv("LWFS_NS_CACHE_NEG_TTL");
+	    if (env != NULL) {
+		neg_ttl = atof(env);
+	    }
+
+	    err = lwfs_ns_cache_init(&ns_cache, LWFS_NS_CACHE_SIZE, ttl, neg_ttl);
+	    if (err != LWFS_OK) {
+		log_error(sysio_debug_level, "unable to create namespace cache");
+		return LWFS_ERR_NOSPACE;
+	    }
+	}
+
 
 	/*
 	 * Caller must use fully qualified path names when specifying
@@ -2646,16 +2716,131 @@ cleanup:
 }
 #endif
 
+/**
+ * @brief Resolve a path from the root with one request to the 
+ * naming server (less the part the namespace cache knows).
+ *
+ * Returns an error (other than -ENOENT) when the server cannot 
+ * resolve the path for us, e.g., because it crosses a container 
+ * we did not send a cap for; the caller then looks up one name 
+ * at a time.
+ */
+static int resolve_path(
+	lwfs_filesystem *lwfs_fs,
+	const char *path,
+	lwfs_ns_entry *result)
+{
+	int rc = LWFS_OK;
+	int num_names = 0;
+	int num_caps = 0;
+	char *buf = NULL;
+	char *name;
+	char *saveptr = NULL;
+	const char *names[LWFS_RESOLVE_MAX_DEPTH];
+	lwfs_cap caps[2];
+	lwfs_cid root_cid = lwfs_fs->namespace.ns_entry.entry_obj.cid;
+
+	log_debug(sysio_debug_level, "entered resolve_path(path=%s)", path);
+
+	buf = strdup(path);
+	if (buf == NULL) {
+		rc = LWFS_ERR_NOSPACE;
+		goto cleanup;
+	}
+
+	/* split the path into names */
+	for (name = strtok_r(buf, "/", &saveptr); name != NULL; 
+	     name = strtok_r(NULL, "/", &saveptr)) {
+		if (num_names == LWFS_RESOLVE_MAX_DEPTH) {
+			rc = LWFS_ERR_NOTSUPP;
+			goto cleanup;
+		}
+		names[num_names++] = name;
+	}
+
+	/* caps for the root container and the container of the fs */
+	rc = check_cap_cache(&lwfs_fs->authr_svc, root_cid,
+		LWFS_CONTAINER_READ, &lwfs_fs->cred, &caps[num_caps]);
+	if (rc != LWFS_OK) {
+		goto cleanup;
+	}
+	num_caps++;
+
+	if (lwfs_fs->cid != root_cid) {
+		rc = check_cap_cache(&lwfs_fs->authr_svc, lwfs_fs->cid,
+			LWFS_CONTAINER_READ, &lwfs_fs->cred, &caps[num_caps]);
+		if (rc == LWFS_OK) {
+			num_caps++;
+		}
+	}
+
+	rc = lwfs_ns_cache_resolve_sync(&ns_cache, &lwfs_fs->naming_svc, 
+			&lwfs_fs->txn, &lwfs_fs->namespace.ns_entry, 
+			names, num_names, caps, num_caps, result);
+	if ((rc == LWFS_ERR_NOENT) || (rc == LWFS_ERR_NOTDIR)) {
+		errno = ENOENT;
+		rc = -ENOENT;
+	}
+
+cleanup:
+	free(buf);
+
+	log_debug(sysio_debug_level, "finished resolve_path(path=%s): %d", path, rc);
+
+	return rc;
+}
+
 /**
  * @brief Find the entry associated with the directory path.
  *
+ * Tries to resolve the whole path in one request; if the server 
+ * cannot, looks up one name at a time.
+ *
+ * @param path @input the full path.
+ * @param result @output the entry.
+ */
+static int traverse_path(
+	lwfs_filesystem *lwfs_fs,
+	const char *path,
+	lwfs_ns_entry *result)
+{
+	int rc = LWFS_OK;
+
+	/* error case */
+	if (path == NULL) {
+		log_error(sysio_debug_level, "invalid path");
+		errno = ENOENT;
+		return -errno;
+	}
+
+	/* Are we looking up the root? */
+	if (strcmp(path, "/") == 0) {
+		memcpy(result, &lwfs_fs->namespace.ns_entry, sizeof(lwfs_ns_entry));
+		return LWFS_OK;
+	}
+
+	rc = resolve_path(lwfs_fs, path, result);
+	if ((rc == LWFS_OK) || (rc == -ENOENT)) {
+		return rc;
+	}
+
+	log_debug(sysio_debug_level, "could not resolve %s in one request (%d), "
+		"looking up one name at a time", path, rc);
+
+	return lookup_path(lwfs_fs, path, result);
+}
+
+/**
+ * @brief Find the entry associated with the directory path,
+ * one name at a time.
+ *
  * @param path @input the full path.
  * @param parent @input the object for the resulting
  *                      parent directory.
  * @param name  @input the name, extracted from the
  *                     end of the path.
  */
-static int traverse_path(
+static int lookup_path(
 	lwfs_filesystem *lwfs_fs,
 	const char *path,
 	lwfs_ns_entry *result)
@@ -2667,12 +2852,12 @@ static int traverse_path(
 	lwfs_cid parent_cid; 
 	lwfs_cap parent_cap;
 
-	log_debug(sysio_debug_level, "entered traverse_path(path=%s)", path);
+	log_debug(sysio_debug_level, "entered lookup_path(path=%s)", path);
 	
 	memset(&parent_ent, 0, sizeof(lwfs_ns_entry));
 	
 	if (logging_debug(sysio_debug_level)) {
-		fprint_lwfs_ns_entry(logger_get_file(), "result", "DEBUG fs_lwfs.c:traverse_path", result);
+		fprint_lwfs_ns_entry(logger_get_file(), "result", "DEBUG fs_lwfs.c:lookup_path", result);
 	}
 
 	/* error case */
@@ -2684,9 +2869,6 @@ static int traverse_path(
 	}
 
 
-	/* TODO: look for the entry in a cache */
-
-
 	/* Are we looking up the root? */
 	if (strcmp(path, "/") == 0) {
 		memcpy(result, &lwfs_fs->namespace.ns_entry, sizeof(lwfs_ns_entry));
@@ -2708,7 +2890,7 @@ static int traverse_path(
 	get_prefix(parent_path, path, strlen(path));
 
 	/* recursive call to get the parent object */
-	rc = traverse_path(lwfs_fs, parent_path, &parent_ent);
+	rc = lookup_path(lwfs_fs, parent_path, &parent_ent);
 	if (rc != LWFS_OK) {
 		log_warn(sysio_debug_level, "could not traverse path: %s",
 				lwfs_err_str(rc));
@@ -2726,9 +2908,10 @@ static int traverse_path(
 	    return rc;
 	}
 
-	/* lookup the entry */
+	/* lookup the entry (the cache answers repeated lookups) */
 	log_debug(sysio_debug_level, "lookup %s", name);
-	rc = lwfs_lookup_sync(&lwfs_fs->naming_svc, &lwfs_fs->txn, &parent_ent, name,
+	rc = lwfs_ns_cache_lookup_sync(&ns_cache, &lwfs_fs->naming_svc, 
+			&lwfs_fs->txn, &parent_ent, name,
 			LWFS_LOCK_NULL, &parent_cap, result);
 	if (rc != LWFS_OK) {
 		errno = ENOENT;
@@ -2738,7 +2921,7 @@ static int traverse_path(
 		goto cleanup;
 	}
 	if (logging_debug(sysio_debug_level))
-		fprint_lwfs_ns_entry(logger_get_file(), "traverse_path.parent_ent", "DEBUG fs_lwfs.c:traverse_path", &parent_ent);
+		fprint_lwfs_ns_entry(logger_get_file(), "lookup_path.parent_ent", "DEBUG fs_lwfs.c:lookup_path", &parent_ent);
 
 cleanup:
 	if (parent_path != NULL) {
@@ -2747,10 +2930,10 @@ cleanup:
 	}
 
 	if (logging_debug(sysio_debug_level)) {
-		fprint_lwfs_ns_entry(logger_get_file(), "result", "DEBUG fs_lwfs.c:traverse_path cleanup", result);
+		fprint_lwfs_ns_entry(logger_get_file(), "result", "DEBUG fs_lwfs.c:lookup_path cleanup", result);
 	}
 
-	log_debug(sysio_debug_level, "finished traverse_path(path=%s)", path);
+	log_debug(sysio_debug_level, "finished lookup_path(path=%s)", path);
 
 	return rc;
 }
@@ -3237,13 +3420,18 @@ lwfs_filldirentries(struct inode *ino,
 	int rc = 0;
 	int cc = 0;
 	int i;
-	lwfs_ns_entry *parent = &(I2LI(ino)->ns_entry);
-	lwfs_ns_entry_array listing;
+	lwfs_inode *lino = I2LI(ino);
+	lwfs_ns_entry *parent = &(lino->ns_entry);
+	lwfs_list_dir_page_res page;
 	lwfs_filesystem *lwfs_fs = FS2LFS(INODE_FS(ino));
 	struct intnl_dirent *d_entry = NULL;
-	int entries_found = 0;
-	int starting_index = 0;
-	int bytes_left = nbytes;
+	char cookie[LWFS_NAME_LEN+1];
+	_SYSIO_OFF_T skip = 0;
+	int max_entries;
+	lwfs_bool eof = FALSE;
+	lwfs_bool full = FALSE;
+	size_t bytes_left = nbytes;
+	size_t reclen;
 	lwfs_cid parent_cid; 
 	lwfs_cap parent_cap; 
 	int interval_id;
@@ -3260,7 +3448,7 @@ lwfs_filldirentries(struct inode *ino,
 	log_debug(sysio_debug_level, "on enter - *posp == %d", *posp);
 	log_debug(sysio_debug_level, "on enter -  posp == 0x%08x", posp);
 
-	memset(&listing, 0, sizeof(lwfs_ns_entry_array));
+	memset(&page, 0, sizeof(lwfs_list_dir_page_res));
 	memset(&parent_cap, 0, sizeof(lwfs_cap));
 
 	parent_cid = parent->entry_obj.cid; 
@@ -3277,14 +3465,26 @@ lwfs_filldirentries(struct inode *ino,
 	if (logging_debug(sysio_debug_level)) 
 		fprint_lwfs_ns_entry(logger_get_file(), "parent", "DEBUG", parent);
 
-	/* get the contents of the directory */
-	rc = lwfs_list_dir_sync(&lwfs_fs->naming_svc, parent, &parent_cap, &listing);
-	if (rc != LWFS_OK) {
-		log_warn(sysio_debug_level, "error getting listing: %s",
-			lwfs_err_str(rc));
-		errno = EBADF;
-		rc = -errno;
-		goto cleanup;
+	/* Pick up where the last call stopped.  The server returns the 
+	 * entries in name order, so the last name we returned is enough 
+	 * to find the next page.  Any other position (e.g., after a 
+	 * seekdir) has to be counted from the start of the directory. 
+	 */
+	memset(cookie, 0, sizeof(cookie));
+	if ((*posp != 0) && (*posp == lino->dir_pos)) {
+		strncpy(cookie, lino->dir_cookie, LWFS_NAME_LEN);
+	}
+	else {
+		skip = *posp;
+	}
+
+	/* ask for about as many entries as fit in the buffer */
+	max_entries = nbytes / LWFS_D_RECLEN(0);
+	if (max_entries < 1) {
+		max_entries = 1;
+	}
+	if (max_entries > LWFS_LIST_DIR_MAX_ENTRIES) {
+		max_entries = LWFS_LIST_DIR_MAX_ENTRIES;
 	}
 
 #ifdef ADD_FAKE_DOT_DOTDOT
@@ -3303,23 +3503,54 @@ lwfs_filldirentries(struct inode *ino,
 #endif
 
 	d_entry = (struct intnl_dirent *)buf;
-	/* skip over entries that have been processed previously */
-	starting_index = *posp;
-	/* entries found in parent */
-	entries_found = listing.lwfs_ns_entry_array_len;
-	/* fill intnl_dirents from the ns_entries */
-	for (i=starting_index; i<entries_found; i++) {
-		int n;
-		if ((bytes_left - LWFS_D_RECLEN(strlen(listing.lwfs_ns_entry_array_val[i].name))) < 0) {
-			break;
+
+	/* fetch pages until the buffer has something in it (or is full) */
+	while (!eof && !full && (cc == 0)) {
+
+		/* get the next page of the directory */
+		rc = lwfs_list_dir_page_sync(&lwfs_fs->naming_svc, parent, cookie, 
+				max_entries, FALSE, NULL, &parent_cap, &page);
+		if (rc != LWFS_OK) {
+			log_warn(sysio_debug_level, "error getting listing: %s",
+				lwfs_err_str(rc));
+			errno = EBADF;
+			rc = -errno;
+			goto cleanup;
+		}
+
+		/* fill intnl_dirents from the ns_entries */
+		for (i=0; i<page.entries.lwfs_ns_entry_array_len; i++) {
+			lwfs_ns_entry *ns_entry = &page.entries.lwfs_ns_entry_array_val[i];
+			int n;
+
+			/* skip over entries that have been processed previously */
+			if (skip > 0) {
+				skip--;
+				continue;
+			}
+
+			reclen = LWFS_D_RECLEN(strlen(ns_entry->name));
+			if (bytes_left < reclen) {
+				full = TRUE;
+				break;
+			}
+
+			(*posp)++;
+			lwfs_dirent_filler(d_entry, ns_entry);
+			d_entry->d_off = *posp;
+			n = d_entry->d_reclen;
+			cc += n;
+			bytes_left -= n;
+			d_entry = (struct intnl_dirent *)((char *)d_entry + n);
+
+			/* remember where the next call starts */
+			strncpy(lino->dir_cookie, ns_entry->name, LWFS_NAME_LEN);
+			lino->dir_pos = *posp;
 		}
-		(*posp)++;
-		lwfs_dirent_filler(d_entry, &listing.lwfs_ns_entry_array_val[i]);
-		d_entry->d_off = *posp;
-		n = d_entry->d_reclen;
-		cc += n;
-		bytes_left -= n;
-		d_entry = (struct intnl_dirent *)((char *)d_entry + n);
+
+		eof = page.eof;
+		strncpy(cookie, page.cookie, LWFS_NAME_LEN);
+		xdr_free((xdrproc_t)xdr_lwfs_list_dir_page_res, (char *)&page);
 	}
 
 	rc = cc;
@@ -3381,6 +3612,7 @@ lwfs_inop_mkdir(struct pnode *pno, mode_t mode)
 				  parent->entry_obj.cid,
 				  &parent_cap,
 				  &dir_ent);
+	lwfs_ns_cache_invalidate(&ns_cache, parent, name);
 	if (rc != LWFS_OK) {
 		log_error(sysio_debug_level, "error creating dir (%s): %s",
 				name, lwfs_err_str(rc));
@@ -3442,6 +3674,7 @@ lwfs_inop_rmdir(struct pnode *pno)
 				  name,
 				  &parent_cap,
 				  &entry);
+	lwfs_ns_cache_invalidate(&ns_cache, parent, name);
 	if (rc != LWFS_OK) {
 		log_error(sysio_debug_level, "error removing directory (%s): %s",
 				name, lwfs_err_str(rc));
@@ -3653,6 +3886,7 @@ create_file(struct pnode *pno, mode_t mode)
 		entry.file_obj,
 		&create_file_cap,
 		&new_entry);
+	lwfs_ns_cache_invalidate(&ns_cache, parent, name);
 	if ((rc != LWFS_OK) && (rc != LWFS_ERR_EXIST)) {
 	    log_error(sysio_debug_level, "error creating ns_entry for %s: %s", name, lwfs_err_str(rc));
 	    /*
@@ -3866,6 +4100,9 @@ lwfs_inop_link(struct pnode *target, struct pnode *link)
 				   target_parent, target_name,
 				   &lwfs_fs->cap,
 				   &link_entry);
+	lwfs_ns_cache_invalidate(&ns_cache, link_parent, link_name);
+	/* the target's link count changed */
+	lwfs_ns_cache_invalidate(&ns_cache, target_parent, target_name);
 	if (rc != LWFS_OK) {
 		log_error(sysio_debug_level, "error creating link: %s",
 				lwfs_err_str(rc));
@@ -3923,6 +4160,7 @@ lwfs_inop_unlink(struct pnode *pno)
 	/* remove the file from the namespace */
 	rc = lwfs_unlink_sync(&lwfs_fs->naming_svc, &lwfs_fs->txn, 
 		parent, name, &parent_cap, &entry);
+	lwfs_ns_cache_invalidate(&ns_cache, parent, name);
 	if (rc != LWFS_OK) {
 		log_error(sysio_debug_level, "error removing file: %s",
 				lwfs_err_str(rc));
@@ -4106,6 +4344,7 @@ doio(char op, struct ioctx *ioctx)
 	lio_session->lio_fs = FS2LFS(INODE_FS(ioctx->ioctx_ino));
 	lio_session->lio_outstanding_requests = calloc(1, sizeof(struct request_list));
 	TAILQ_INIT(lio_session->lio_outstanding_requests);
+	lio_session->lio_cq = NULL; /* created by the first real I/O */
 	
 	log_debug(LOG_ALL, "lio_session==%p, lio_outstanding_requests==%p", lio_session, lio_session->lio_outstanding_requests);
 	
@@ -4223,9 +4462,8 @@ lwfs_inop_iodone(struct ioctx *ioctxp)
 	
 	lwfs_io *lio_session = (lwfs_io *)ioctxp->ioctx_private;
 	int wait_rc;   /* result of the wait call */
-	int remote_rc; /* result of the remote operation */
 	struct request_entry *entry = NULL;
-	lwfs_request *req = NULL;
+	int i;
 	int interval_id;
 	char event_data[max_event_data];
 
@@ -4247,31 +4485,29 @@ lwfs_inop_iodone(struct ioctx *ioctxp)
 
 	while ((entry = TAILQ_FIRST(lio_session->lio_outstanding_requests)) != NULL) {
 		TAILQ_REMOVE(lio_session->lio_outstanding_requests, entry, np);
-		req = entry->req;
-//	if (lio_session->lio_outstanding_request != NULL) {
-//		req = lio_session->lio_outstanding_request;
-		log_debug(LOG_ALL, "entry==%p, req==%p", entry, req);
-		if (req != NULL) {
-			wait_rc = lwfs_wait(req, &remote_rc);
-			if (wait_rc != LWFS_OK) {
-				log_error(sysio_debug_level, "wait failed: %s",
-					  lwfs_err_str(wait_rc));
-				rc = 0; /* failure */
-				goto cleanup; 
-			}
-			if (remote_rc != LWFS_OK) {
+		log_debug(LOG_ALL, "entry==%p, reqs==%p, num_reqs==%d", entry, entry->reqs, entry->num_reqs);
+
+		/* the stripes of the vector complete on the session's 
+		 * completion queue, so one wait collects all of them. 
+		 * keep waiting after a failure; the queue still holds 
+		 * the buffers of the other entries. */
+		wait_rc = lwfs_waitall(entry->reqs, entry->num_reqs, -1);
+		if (wait_rc != LWFS_OK) {
+			log_error(sysio_debug_level, "wait failed: %s",
+				  lwfs_err_str(wait_rc));
+			rc = 0; /* failure */
+		}
+		for (i=0; i<entry->num_reqs; i++) {
+			if (entry->reqs[i].status == LWFS_REQUEST_ERROR) {
 				log_error(sysio_debug_level, "remote operation failed: %s",
-					  lwfs_err_str(remote_rc));
+					  lwfs_err_str(entry->reqs[i].error_code));
 				rc = 0; /* failure */
-				goto cleanup; 
 			}
-			free(req);
-			req = NULL;
-			
-			/* THK TODO:  update fpos and st_size */
-		} else {
-			log_debug(sysio_debug_level, "req is NULL.  must be doing fake I/O.");
 		}
+
+		/* THK TODO:  update fpos and st_size */
+		free(entry->reqs);
+		free(entry->results);
 		free(entry);
 		entry = NULL;
 	}
@@ -4287,12 +4523,13 @@ lwfs_inop_iodone(struct ioctx *ioctxp)
 
 cleanup:
 	if (lio_session != NULL) {
+		if (lio_session->lio_cq != NULL) {
+			lwfs_cq_fini(lio_session->lio_cq);
+			free(lio_session->lio_cq);
+		}
 //		free(lio_session->lio_outstanding_requests);
 		free(lio_session);
 	}
-	
-	if (req != NULL) free(req);
-	if (entry != NULL) free(entry);
 
 	log_debug(sysio_debug_level, "finished lwfs_inop_iodone");
 
@@ -4589,6 +4826,12 @@ lwfs_fsop_gone(struct filesys *fs)
 	hashtable_destroy(&cap_ht, free); 
 
 	log_debug(sysio_debug_level, "cache_hits=%d, cache_misses=%d\n",cache_hits, cache_misses);
+
+	/* release the namespace cache */
+	if (logging_debug(sysio_debug_level)) {
+		fprint_lwfs_ns_cache_stats(logger_get_file(), "DEBUG", &ns_cache);
+	}
+	lwfs_ns_cache_fini(&ns_cache);
 	
 //	malloc_report();
 
@@ -108,3 +108,78 @@ xdr_lwfs_verify_caps_args (XDR *xdrs, lwfs_verify_caps_args *objp)
 		 return FALSE;
 	return TRUE;
 }
+
+bool_t
+xdr_lwfs_register_cap_cache_args (XDR *xdrs, lwfs_register_cap_cache_args *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_pointer (xdrs, (char **)&objp->svc, sizeof (lwfs_service), (xdrproc_t) xdr_lwfs_service))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_lwfs_revoke_caps_args (XDR *xdrs, lwfs_revoke_caps_args *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_lwfs_cid (xdrs, &objp->cid))
+		 return FALSE;
+	 if (!xdr_lwfs_container_op (xdrs, &objp->container_op))
+		 return FALSE;
+	 if (!xdr_u_int (xdrs, &objp->generation))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_lwfs_revoked_cid (XDR *xdrs, lwfs_revoked_cid *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_lwfs_cid (xdrs, &objp->cid))
+		 return FALSE;
+	 if (!xdr_lwfs_container_op (xdrs, &objp->container_op))
+		 return FALSE;
+	 if (!xdr_u_int (xdrs, &objp->generation))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_lwfs_cap_key_info (XDR *xdrs, lwfs_cap_key_info *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_u_int (xdrs, &objp->generation))
+		 return FALSE;
+	 if (!xdr_lwfs_key (xdrs, &objp->key))
+		 return FALSE;
+	 if (!xdr_lwfs_key (xdrs, &objp->prev_key))
+		 return FALSE;
+	 if (!xdr_array (xdrs, (char **)&objp->revoked.revoked_val, (u_int *) &objp->revoked.revoked_len, ~0,
+		sizeof (lwfs_revoked_cid), (xdrproc_t) xdr_lwfs_revoked_cid))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_lwfs_get_cap_key_args (XDR *xdrs, lwfs_get_cap_key_args *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_pointer (xdrs, (char **)&objp->svc, sizeof (lwfs_service), (xdrproc_t) xdr_lwfs_service))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_lwfs_set_cap_key_args (XDR *xdrs, lwfs_set_cap_key_args *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_pointer (xdrs, (char **)&objp->info, sizeof (lwfs_cap_key_info), (xdrproc_t) xdr_lwfs_cap_key_info))
+		 return FALSE;
+	return TRUE;
+}
@@ -67,6 +67,46 @@ struct lwfs_verify_caps_args {
 };
 typedef struct lwfs_verify_caps_args lwfs_verify_caps_args;
 
+struct lwfs_register_cap_cache_args {
+	lwfs_service *svc;
+};
+typedef struct lwfs_register_cap_cache_args lwfs_register_cap_cache_args;
+
+struct lwfs_revoke_caps_args {
+	lwfs_cid cid;
+	lwfs_container_op container_op;
+	u_int generation;
+};
+typedef struct lwfs_revoke_caps_args lwfs_revoke_caps_args;
+
+struct lwfs_revoked_cid {
+	lwfs_cid cid;
+	lwfs_container_op container_op;
+	u_int generation;
+};
+typedef struct lwfs_revoked_cid lwfs_revoked_cid;
+
+struct lwfs_cap_key_info {
+	u_int generation;
+	lwfs_key key;
+	lwfs_key prev_key;
+	struct {
+		u_int revoked_len;
+		lwfs_revoked_cid *revoked_val;
+	} revoked;
+};
+typedef struct lwfs_cap_key_info lwfs_cap_key_info;
+
+struct lwfs_get_cap_key_args {
+	lwfs_service *svc;
+};
+typedef struct lwfs_get_cap_key_args lwfs_get_cap_key_args;
+
+struct lwfs_set_cap_key_args {
+	lwfs_cap_key_info *info;
+};
+typedef struct lwfs_set_cap_key_args lwfs_set_cap_key_args;
+
 /* the xdr functions */
 
 #if defined(__STDC__) || defined(__cplusplus)
@@ -77,6 +117,12 @@ extern  bool_t xdr_lwfs_get_acl_args (XDR *, lwfs_get_acl_args*);
 extern  bool_t xdr_lwfs_mod_acl_args (XDR *, lwfs_mod_acl_args*);
 extern  bool_t xdr_lwfs_get_cap_args (XDR *, lwfs_get_cap_args*);
 extern  bool_t xdr_lwfs_verify_caps_args (XDR *, lwfs_verify_caps_args*);
+extern  bool_t xdr_lwfs_register_cap_cache_args (XDR *, lwfs_register_cap_cache_args*);
+extern  bool_t xdr_lwfs_revoke_caps_args (XDR *, lwfs_revoke_caps_args*);
+extern  bool_t xdr_lwfs_revoked_cid (XDR *, lwfs_revoked_cid*);
+extern  bool_t xdr_lwfs_cap_key_info (XDR *, lwfs_cap_key_info*);
+extern  bool_t xdr_lwfs_get_cap_key_args (XDR *, lwfs_get_cap_key_args*);
+extern  bool_t xdr_lwfs_set_cap_key_args (XDR *, lwfs_set_cap_key_args*);
 
 #else /* K&R C */
 extern bool_t xdr_lwfs_create_container_args ();
@@ -86,6 +132,12 @@ extern bool_t xdr_lwfs_get_acl_args ();
 extern bool_t xdr_lwfs_mod_acl_args ();
 extern bool_t xdr_lwfs_get_cap_args ();
 extern bool_t xdr_lwfs_verify_caps_args ();
+extern bool_t xdr_lwfs_register_cap_cache_args ();
+extern bool_t xdr_lwfs_revoke_caps_args ();
+extern bool_t xdr_lwfs_revoked_cid ();
+extern bool_t xdr_lwfs_cap_key_info ();
+extern bool_t xdr_lwfs_get_cap_key_args ();
+extern bool_t xdr_lwfs_set_cap_key_args ();
 
 #endif /* K&R C */
 
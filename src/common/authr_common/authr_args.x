@@ -134,3 +134,78 @@ struct lwfs_verify_caps_args {
 
 
 
+/** 
+ * @brief Arguments to the \ref lwfs_register_cap_cache method that 
+ * have to be sent to the authorization server.
+ */
+struct lwfs_register_cap_cache_args {
+	/** @brief The service that caches verified caps. */
+	lwfs_service *svc;
+};
+
+/** 
+ * @brief Arguments to the \ref lwfs_revoke_caps method that the 
+ * authorization server sends to a registered cap cache.
+ */
+struct lwfs_revoke_caps_args {
+	/** @brief The container ID of the revoked caps. */
+	lwfs_cid cid;
+
+	/** @brief The container operations to revoke. */
+	lwfs_container_op container_op; 
+
+	/** @brief The key generation when the operations were revoked. */
+	unsigned int generation;
+};
+
+
+/** 
+ * @brief A container that lost ACL entries (see \ref lwfs_cap_key_info).
+ */
+struct lwfs_revoked_cid {
+	/** @brief The container ID. */
+	lwfs_cid cid;
+
+	/** @brief The revoked container operations (or'd together). */
+	lwfs_container_op container_op; 
+
+	/** @brief The key generation of the latest revocation. */
+	unsigned int generation;
+};
+
+/** 
+ * @brief The information a service needs to verify caps without 
+ * calling the authorization server. 
+ */
+struct lwfs_cap_key_info {
+	/** @brief Number of key rotations (caps from keys older than 
+	 *  generation-1 are invalid, and so are their revocations). */
+	unsigned int generation;
+
+	/** @brief The key used to generate new caps. */
+	lwfs_key key;
+
+	/** @brief The key used before the last rotation. */
+	lwfs_key prev_key;
+
+	/** @brief Containers with revoked operations (ACL checks required). */
+	lwfs_revoked_cid revoked<>;
+};
+
+/** 
+ * @brief Arguments to the \ref lwfs_get_cap_key method that 
+ * have to be sent to the authorization server.
+ */
+struct lwfs_get_cap_key_args {
+	/** @brief The service that verifies caps locally. */
+	lwfs_service *svc;
+};
+
+/** 
+ * @brief Arguments to the \ref lwfs_set_cap_key method that the 
+ * authorization server sends after rotating its key.
+ */
+struct lwfs_set_cap_key_args {
+	/** @brief The new keys. */
+	lwfs_cap_key_info *info;
+};
@@ -36,7 +36,19 @@ extern "C" {
 		LWFS_OP_GET_CAP=106, 
 
 		/** @brief Verify capabilities. */
-		LWFS_OP_VERIFY_CAPS=107
+		LWFS_OP_VERIFY_CAPS=107,
+
+		/** @brief Register a server-side cache of verified caps. */
+		LWFS_OP_REGISTER_CAP_CACHE=108,
+
+		/** @brief Revoke cached caps (sent to registered caches). */
+		LWFS_OP_REVOKE_CAPS=109,
+
+		/** @brief Get the key used to verify caps locally. */
+		LWFS_OP_GET_CAP_KEY=110,
+
+		/** @brief Replace the key (sent to registered services after a rotation). */
+		LWFS_OP_SET_CAP_KEY=111
 	};
 
 
@@ -65,6 +65,30 @@ int register_authr_encodings(void)
 			(xdrproc_t)NULL,
 			(xdrproc_t)&xdr_void);
 
+	/* register cap cache */
+	lwfs_register_xdr_encoding(LWFS_OP_REGISTER_CAP_CACHE,
+			(xdrproc_t)&xdr_lwfs_register_cap_cache_args,
+			(xdrproc_t)NULL,
+			(xdrproc_t)&xdr_void);
+
+	/* revoke caps */
+	lwfs_register_xdr_encoding(LWFS_OP_REVOKE_CAPS,
+			(xdrproc_t)&xdr_lwfs_revoke_caps_args,
+			(xdrproc_t)NULL,
+			(xdrproc_t)&xdr_void);
+
+	/* get cap key */
+	lwfs_register_xdr_encoding(LWFS_OP_GET_CAP_KEY,
+			(xdrproc_t)&xdr_lwfs_get_cap_key_args,
+			(xdrproc_t)NULL,
+			(xdrproc_t)&xdr_lwfs_cap_key_info);
+
+	/* set cap key */
+	lwfs_register_xdr_encoding(LWFS_OP_SET_CAP_KEY,
+			(xdrproc_t)&xdr_lwfs_set_cap_key_args,
+			(xdrproc_t)NULL,
+			(xdrproc_t)&xdr_void);
+
 	return rc;
 }
 
@@ -95,6 +95,38 @@ xdr_lwfs_create_file_args (XDR *xdrs, lwfs_create_file_args *objp)
 	return TRUE;
 }
 
+bool_t
+xdr_lwfs_create_files_args (XDR *xdrs, lwfs_create_files_args *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_pointer (xdrs, (char **)&objp->txn_id, sizeof (lwfs_txn), (xdrproc_t) xdr_lwfs_txn))
+		 return FALSE;
+	 if (!xdr_pointer (xdrs, (char **)&objp->parent, sizeof (lwfs_ns_entry), (xdrproc_t) xdr_lwfs_ns_entry))
+		 return FALSE;
+	 if (!xdr_array (xdrs, (char **)&objp->names.names_val, (u_int *) &objp->names.names_len, LWFS_CREATE_FILES_MAX,
+		sizeof (lwfs_name), (xdrproc_t) xdr_lwfs_name))
+		 return FALSE;
+	 if (!xdr_array (xdrs, (char **)&objp->objs.objs_val, (u_int *) &objp->objs.objs_len, LWFS_CREATE_FILES_MAX,
+		sizeof (lwfs_obj), (xdrproc_t) xdr_lwfs_obj))
+		 return FALSE;
+	 if (!xdr_pointer (xdrs, (char **)&objp->cap, sizeof (lwfs_cap), (xdrproc_t) xdr_lwfs_cap))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_lwfs_create_files_res (XDR *xdrs, lwfs_create_files_res *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_lwfs_ns_entry_array (xdrs, &objp->entries))
+		 return FALSE;
+	 if (!xdr_int (xdrs, &objp->rc))
+		 return FALSE;
+	return TRUE;
+}
+
 bool_t
 xdr_lwfs_remove_file_args (XDR *xdrs, lwfs_remove_file_args *objp)
 {
@@ -161,6 +193,40 @@ xdr_lwfs_list_dir_args (XDR *xdrs, lwfs_list_dir_args *objp)
 	return TRUE;
 }
 
+bool_t
+xdr_lwfs_list_dir_page_args (XDR *xdrs, lwfs_list_dir_page_args *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_pointer (xdrs, (char **)&objp->parent, sizeof (lwfs_ns_entry), (xdrproc_t) xdr_lwfs_ns_entry))
+		 return FALSE;
+	 if (!xdr_lwfs_name (xdrs, &objp->cookie))
+		 return FALSE;
+	 if (!xdr_int (xdrs, &objp->max_entries))
+		 return FALSE;
+	 if (!xdr_bool (xdrs, &objp->names_only))
+		 return FALSE;
+	 if (!xdr_lwfs_name (xdrs, &objp->pattern))
+		 return FALSE;
+	 if (!xdr_pointer (xdrs, (char **)&objp->cap, sizeof (lwfs_cap), (xdrproc_t) xdr_lwfs_cap))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_lwfs_list_dir_page_res (XDR *xdrs, lwfs_list_dir_page_res *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_lwfs_ns_entry_array (xdrs, &objp->entries))
+		 return FALSE;
+	 if (!xdr_lwfs_name (xdrs, &objp->cookie))
+		 return FALSE;
+	 if (!xdr_bool (xdrs, &objp->eof))
+		 return FALSE;
+	return TRUE;
+}
+
 bool_t
 xdr_lwfs_lookup_args (XDR *xdrs, lwfs_lookup_args *objp)
 {
@@ -179,6 +245,39 @@ xdr_lwfs_lookup_args (XDR *xdrs, lwfs_lookup_args *objp)
 	return TRUE;
 }
 
+bool_t
+xdr_lwfs_resolve_path_args (XDR *xdrs, lwfs_resolve_path_args *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_pointer (xdrs, (char **)&objp->txn_id, sizeof (lwfs_txn), (xdrproc_t) xdr_lwfs_txn))
+		 return FALSE;
+	 if (!xdr_pointer (xdrs, (char **)&objp->start, sizeof (lwfs_ns_entry), (xdrproc_t) xdr_lwfs_ns_entry))
+		 return FALSE;
+	 if (!xdr_array (xdrs, (char **)&objp->names.names_val, (u_int *) &objp->names.names_len, LWFS_RESOLVE_MAX_DEPTH,
+		sizeof (lwfs_name), (xdrproc_t) xdr_lwfs_name))
+		 return FALSE;
+	 if (!xdr_bool (xdrs, &objp->want_all))
+		 return FALSE;
+	 if (!xdr_lwfs_cap_array (xdrs, &objp->caps))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_lwfs_resolve_path_res (XDR *xdrs, lwfs_resolve_path_res *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_lwfs_ns_entry_array (xdrs, &objp->entries))
+		 return FALSE;
+	 if (!xdr_int (xdrs, &objp->rc))
+		 return FALSE;
+	 if (!xdr_int (xdrs, &objp->failed))
+		 return FALSE;
+	return TRUE;
+}
+
 bool_t
 xdr_lwfs_name_stat_args (XDR *xdrs, lwfs_name_stat_args *objp)
 {
@@ -59,6 +59,28 @@ struct lwfs_create_file_args {
 	lwfs_cap *cap;
 };
 typedef struct lwfs_create_file_args lwfs_create_file_args;
+#define LWFS_CREATE_FILES_MAX 1024
+
+struct lwfs_create_files_args {
+	lwfs_txn *txn_id;
+	lwfs_ns_entry *parent;
+	struct {
+		u_int names_len;
+		lwfs_name *names_val;
+	} names;
+	struct {
+		u_int objs_len;
+		lwfs_obj *objs_val;
+	} objs;
+	lwfs_cap *cap;
+};
+typedef struct lwfs_create_files_args lwfs_create_files_args;
+
+struct lwfs_create_files_res {
+	lwfs_ns_entry_array entries;
+	int rc;
+};
+typedef struct lwfs_create_files_res lwfs_create_files_res;
 
 struct lwfs_remove_file_args {
 	lwfs_txn *txn_id;
@@ -92,6 +114,24 @@ struct lwfs_list_dir_args {
 	lwfs_cap *cap;
 };
 typedef struct lwfs_list_dir_args lwfs_list_dir_args;
+#define LWFS_LIST_DIR_MAX_ENTRIES 1024
+
+struct lwfs_list_dir_page_args {
+	lwfs_ns_entry *parent;
+	lwfs_name cookie;
+	int max_entries;
+	bool_t names_only;
+	lwfs_name pattern;
+	lwfs_cap *cap;
+};
+typedef struct lwfs_list_dir_page_args lwfs_list_dir_page_args;
+
+struct lwfs_list_dir_page_res {
+	lwfs_ns_entry_array entries;
+	lwfs_name cookie;
+	bool_t eof;
+};
+typedef struct lwfs_list_dir_page_res lwfs_list_dir_page_res;
 
 struct lwfs_lookup_args {
 	lwfs_txn *txn_id;
@@ -101,6 +141,26 @@ struct lwfs_lookup_args {
 	lwfs_cap *cap;
 };
 typedef struct lwfs_lookup_args lwfs_lookup_args;
+#define LWFS_RESOLVE_MAX_DEPTH 256
+
+struct lwfs_resolve_path_args {
+	lwfs_txn *txn_id;
+	lwfs_ns_entry *start;
+	struct {
+		u_int names_len;
+		lwfs_name *names_val;
+	} names;
+	bool_t want_all;
+	lwfs_cap_array caps;
+};
+typedef struct lwfs_resolve_path_args lwfs_resolve_path_args;
+
+struct lwfs_resolve_path_res {
+	lwfs_ns_entry_array entries;
+	int rc;
+	int failed;
+};
+typedef struct lwfs_resolve_path_res lwfs_resolve_path_res;
 
 struct lwfs_name_stat_args {
 	lwfs_txn *txn_id;
@@ -118,11 +178,17 @@ extern  bool_t xdr_lwfs_get_namespace_args (XDR *, lwfs_get_namespace_args*);
 extern  bool_t xdr_lwfs_create_dir_args (XDR *, lwfs_create_dir_args*);
 extern  bool_t xdr_lwfs_remove_dir_args (XDR *, lwfs_remove_dir_args*);
 extern  bool_t xdr_lwfs_create_file_args (XDR *, lwfs_create_file_args*);
+extern  bool_t xdr_lwfs_create_files_args (XDR *, lwfs_create_files_args*);
+extern  bool_t xdr_lwfs_create_files_res (XDR *, lwfs_create_files_res*);
 extern  bool_t xdr_lwfs_remove_file_args (XDR *, lwfs_remove_file_args*);
 extern  bool_t xdr_lwfs_create_link_args (XDR *, lwfs_create_link_args*);
 extern  bool_t xdr_lwfs_unlink_args (XDR *, lwfs_unlink_args*);
 extern  bool_t xdr_lwfs_list_dir_args (XDR *, lwfs_list_dir_args*);
+extern  bool_t xdr_lwfs_list_dir_page_args (XDR *, lwfs_list_dir_page_args*);
+extern  bool_t xdr_lwfs_list_dir_page_res (XDR *, lwfs_list_dir_page_res*);
 extern  bool_t xdr_lwfs_lookup_args (XDR *, lwfs_lookup_args*);
+extern  bool_t xdr_lwfs_resolve_path_args (XDR *, lwfs_resolve_path_args*);
+extern  bool_t xdr_lwfs_resolve_path_res (XDR *, lwfs_resolve_path_res*);
 extern  bool_t xdr_lwfs_name_stat_args (XDR *, lwfs_name_stat_args*);
 
 #else /* K&R C */
@@ -132,11 +198,17 @@ extern bool_t xdr_lwfs_get_namespace_args ();
 extern bool_t xdr_lwfs_create_dir_args ();
 extern bool_t xdr_lwfs_remove_dir_args ();
 extern bool_t xdr_lwfs_create_file_args ();
+extern bool_t xdr_lwfs_create_files_args ();
+extern bool_t xdr_lwfs_create_files_res ();
 extern bool_t xdr_lwfs_remove_file_args ();
 extern bool_t xdr_lwfs_create_link_args ();
 extern bool_t xdr_lwfs_unlink_args ();
 extern bool_t xdr_lwfs_list_dir_args ();
+extern bool_t xdr_lwfs_list_dir_page_args ();
+extern bool_t xdr_lwfs_list_dir_page_res ();
 extern bool_t xdr_lwfs_lookup_args ();
+extern bool_t xdr_lwfs_resolve_path_args ();
+extern bool_t xdr_lwfs_resolve_path_res ();
 extern bool_t xdr_lwfs_name_stat_args ();
 
 #endif /* K&R C */
@@ -123,6 +123,45 @@ struct lwfs_create_file_args {
 	lwfs_cap *cap;
 };
 
+/**
+ * @brief Most files one \ref lwfs_create_files request creates.
+ */
+const LWFS_CREATE_FILES_MAX = 1024;
+
+/**
+ * @brief Arguments for the \ref lwfs_create_files method that 
+ * have to be passed to the naming server. 
+ */
+struct lwfs_create_files_args {
+
+	/** @brief The transaction ID of the operation. */
+	lwfs_txn *txn_id;
+
+	/** @brief The parent directory. */
+	lwfs_ns_entry *parent;
+
+	/** @brief The names of the new files. */
+	lwfs_name names<LWFS_CREATE_FILES_MAX>;
+
+	/** @brief The object to associate with each file (one per name). */
+	lwfs_obj objs<LWFS_CREATE_FILES_MAX>;
+
+	/** @brief The capability that allows the operation. */
+	lwfs_cap *cap;
+};
+
+/**
+ * @brief Result of the \ref lwfs_create_files method. 
+ */
+struct lwfs_create_files_res {
+
+	/** @brief The files created, in the order of the names. */
+	lwfs_ns_entry_array entries;
+
+	/** @brief Why the server stopped early (\ref LWFS_OK if it created them all). */
+	int rc;
+};
+
 /**
  * @brief Arguments for the \ref lwfs_remove_file method that 
  * have to be passed to the naming server. 
@@ -209,6 +248,51 @@ struct lwfs_list_dir_args {
 	lwfs_cap *cap;
 };
 
+/**
+ * @brief Most entries one \ref lwfs_list_dir_page returns.
+ */
+const LWFS_LIST_DIR_MAX_ENTRIES = 1024;
+
+/**
+ * @brief Arguments for the \ref lwfs_list_dir_page method that 
+ * have to be passed to the naming server. 
+ */
+struct lwfs_list_dir_page_args {
+
+	/** @brief The parent directory. */
+	lwfs_ns_entry *parent;
+
+	/** @brief Where to start: the cookie of the previous page ("" for the first page). */
+	lwfs_name cookie;
+
+	/** @brief Most entries to return. */
+	int max_entries;
+
+	/** @brief Return only the names and oids of the entries (no inode lookups). */
+	bool names_only;
+
+	/** @brief Return only names that match this fnmatch(3) pattern ("" for all). */
+	lwfs_name pattern;
+
+	/** @brief The capability that allows the operation. */
+	lwfs_cap *cap;
+};
+
+/**
+ * @brief Result of the \ref lwfs_list_dir_page method. 
+ */
+struct lwfs_list_dir_page_res {
+
+	/** @brief The entries, in name order. */
+	lwfs_ns_entry_array entries;
+
+	/** @brief Pass this to get the next page. */
+	lwfs_name cookie;
+
+	/** @brief True if there are no more entries. */
+	bool eof;
+};
+
 /**
  * @brief Arguments for the \ref lwfs_lookup method that 
  * have to be passed to the naming server. 
@@ -232,6 +316,49 @@ struct lwfs_lookup_args {
 };
 
 
+/**
+ * @brief Most path components \ref lwfs_resolve_path takes.
+ */
+const LWFS_RESOLVE_MAX_DEPTH = 256;
+
+/**
+ * @brief Arguments for the \ref lwfs_resolve_path method that 
+ * have to be passed to the naming server. 
+ */
+struct lwfs_resolve_path_args {
+
+	/** @brief The transaction ID of the operation. */
+	lwfs_txn *txn_id;
+
+	/** @brief The directory to start from. */
+	lwfs_ns_entry *start;
+
+	/** @brief The components of the path (relative to start). */
+	lwfs_name names<LWFS_RESOLVE_MAX_DEPTH>;
+
+	/** @brief Return every entry on the path, not just the last one. */
+	bool want_all;
+
+	/** @brief Capabilities for the containers of the directories on the path. */
+	lwfs_cap_array caps;
+};
+
+/**
+ * @brief Result of the \ref lwfs_resolve_path method. 
+ */
+struct lwfs_resolve_path_res {
+
+	/** @brief The entries resolved, in path order (only the deepest one without want_all). */
+	lwfs_ns_entry_array entries;
+
+	/** @brief Why the server stopped early (\ref LWFS_OK if it resolved them all). */
+	int rc;
+
+	/** @brief Index of the name the server stopped at (the number of names if none). */
+	int failed;
+};
+
+
 /**
  * @brief Arguments for the \ref lwfs_name_stat method that 
  * have to be passed to the naming server. 
@@ -82,6 +82,21 @@ extern "C" {
 		 */
 		LWFS_OP_LIST_NAMESPACES,
 
+		/**
+		 * @brief Resolve a whole path in one request.
+		 */
+		LWFS_OP_RESOLVE_PATH,
+
+		/**
+		 * @brief List one page of a directory.
+		 */
+		LWFS_OP_LIST_DIR_PAGE,
+
+		/**
+		 * @brief Create many files in one request.
+		 */
+		LWFS_OP_CREATE_FILES,
+
 	};
 
 
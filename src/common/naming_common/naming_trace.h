@@ -30,7 +30,10 @@ extern "C" {
 		TRACE_NAMING_UNLINK,
 		TRACE_NAMING_LOOKUP,
 		TRACE_NAMING_LS,
-		TRACE_NAMING_STAT
+		TRACE_NAMING_STAT,
+		TRACE_NAMING_RESOLVE,
+		TRACE_NAMING_LS_PAGE,
+		TRACE_NAMING_CREAT_BULK
 	};
 
 #if defined(__STDC__) || defined(__cplusplus)
@@ -38,6 +38,11 @@ int register_naming_encodings(void)
 			(xdrproc_t)NULL,
 			(xdrproc_t)&xdr_lwfs_ns_entry);
 
+	lwfs_register_xdr_encoding(LWFS_OP_CREATE_FILES,
+			(xdrproc_t)&xdr_lwfs_create_files_args,
+			(xdrproc_t)NULL,
+			(xdrproc_t)&xdr_lwfs_create_files_res);
+
 	lwfs_register_xdr_encoding(LWFS_OP_CREATE_LINK,
 			(xdrproc_t)&xdr_lwfs_create_link_args,
 			(xdrproc_t)NULL,
@@ -53,11 +58,21 @@ int register_naming_encodings(void)
 			(xdrproc_t)NULL,
 			(xdrproc_t)&xdr_lwfs_ns_entry);
 
+	lwfs_register_xdr_encoding(LWFS_OP_RESOLVE_PATH,
+			(xdrproc_t)&xdr_lwfs_resolve_path_args,
+			(xdrproc_t)NULL,
+			(xdrproc_t)&xdr_lwfs_resolve_path_res);
+
 	lwfs_register_xdr_encoding(LWFS_OP_LIST_DIR,
 			(xdrproc_t)&xdr_lwfs_list_dir_args,
 			(xdrproc_t)NULL,
 			(xdrproc_t)&xdr_lwfs_ns_entry_array);
 
+	lwfs_register_xdr_encoding(LWFS_OP_LIST_DIR_PAGE,
+			(xdrproc_t)&xdr_lwfs_list_dir_page_args,
+			(xdrproc_t)NULL,
+			(xdrproc_t)&xdr_lwfs_list_dir_page_res);
+
 	lwfs_register_xdr_encoding(LWFS_OP_NAME_STAT,
 			(xdrproc_t)&xdr_lwfs_name_stat_args,
 			(xdrproc_t)NULL,
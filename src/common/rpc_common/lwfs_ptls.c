@@ -15,10 +15,15 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <sched.h>
 
 #include <sys/socket.h>
 #include "config.h"
 
+#include <time.h>
+#include <pthread.h>
+
 #include PORTALS_HEADER
 #include PORTALS_NAL_HEADER
 
@@ -26,10 +31,12 @@
 #include "common/types/fprint_types.h"
 #include "support/logger/logger.h"
 #include "support/signal/lwfs_signal.h"
+#include "support/timer/timer.h"
 
 #include "lwfs_ptls.h"
 #include "rpc_debug.h"
 #include "ptl_wrap.h"
+#include "ptl_pool.h"
 
 #ifndef HAVE_PTHREAD
 #define pthread_self() 0
@@ -39,6 +46,27 @@
 
 static const int MIN_TIMEOUT = 100;  /* in milliseconds */
 
+/* With locks on, we never block in PtlEQPoll while holding the
+ * portals mutex.  Instead we check the queues and, if they are
+ * empty, sleep outside the lock for up to max_poll_backoff usecs. 
+ * An event that arrives during the sleep waits for the next check, 
+ * so the last sleep before an event is latency the backoff added 
+ * (see struct lwfs_ptl_poll_stats). */
+static const int MAX_POLL_BACKOFF = 1000;  /* in microseconds */
+static int max_poll_backoff = 1000;  /* see lwfs_ptl_set_poll_backoff */
+
+static struct lwfs_ptl_poll_stats poll_stats;
+static pthread_mutex_t poll_stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Wakes lwfs_ptl_eq_wait_drain when the library deposits an event 
+ * in an EQ allocated with lwfs_ptl_eq_notify as its handler. */
+static unsigned long notify_count = 0;
+static pthread_mutex_t notify_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t notify_cond = PTHREAD_COND_INITIALIZER;
+
+/* TRUE if more than one thread calls into this file */
+static int use_locks=0;
+
 /* The UTCP NAL requires that the application defines where the Portals
  * API and library should send any output.
  */
@@ -50,7 +78,13 @@ FILE *utcp_lib_out;
 /* locally global portals variables */
 static ptl_handle_ni_t ni_h;        /* handle for the network interface */
 
-/* to synchronize access to portals calls */
+/* to synchronize access to portals calls 
+ *
+ * The mutex protects single calls into the Portals library, never a
+ * whole transfer, so threads that move data for different requests
+ * overlap.  Each put and get uses its own EQ and MD, which only the
+ * calling thread ever waits on. 
+ */
 /*
  *  On BSD (Darwin/MacOS), pthread_mutex_t is not recursive by default, and so the static
  *  initializer here doesn't work.  Instead, we have to play a little compiler trick, 
@@ -148,6 +182,8 @@ int lwfs_ptl_init(ptl_interface_t iface, lwfs_pid my_pid)
 }
 
 int lwfs_ptl_fini() {
+    log_debug(rpc_debug_level, "freeing pooled event queues");
+    lwfs_ptl_pool_fini();
     log_debug(rpc_debug_level, "shutting down PTL Network interface");
     lwfs_PtlNIFini(ni_h);
     log_debug(rpc_debug_level, "shutting down PTL library");
@@ -181,6 +217,113 @@ int lwfs_ptl_eq_wait(
 }
 
 
+/**
+ * @brief EQ handler that wakes \ref lwfs_ptl_eq_wait_drain.
+ *
+ * Pass this to \ref lwfs_ptl_eq_alloc for an EQ that a thread 
+ * drains with \ref lwfs_ptl_eq_wait_drain.  The library calls 
+ * the handler when it deposits an event in the EQ (P3.3 API spec: 
+ * section 3.11, the eq_handler argument of PtlEQAlloc), possibly 
+ * from its own progress thread, so it must not call Portals. 
+ */
+void lwfs_ptl_eq_notify(
+        ptl_event_t *event) 
+{
+	pthread_mutex_lock(&notify_mutex);
+	notify_count++;
+	pthread_cond_signal(&notify_cond);
+	pthread_mutex_unlock(&notify_mutex);
+}
+
+/**
+ * @brief Wait for an event on an EQ that only the caller drains.
+ *
+ * The backoff in \ref lwfs_ptl_eq_poll costs a request up to 
+ * max_poll_backoff usecs of latency.  A service's request EQ has 
+ * a single reader and uses \ref lwfs_ptl_eq_notify as its handler, 
+ * so the dispatcher checks the EQ with the portals mutex held (the 
+ * P3.3 spec does not say the library may be entered concurrently 
+ * on one NI, and the mutex exists because ours may not) and then 
+ * sleeps outside the lock until the handler signals an event.  
+ * Until the handler has run once, we can't tell whether the NAL 
+ * calls handlers at all, so we wake up after max_poll_backoff 
+ * usecs; after that, only every MIN_TIMEOUT msecs in case we miss 
+ * a signal. 
+ */
+int lwfs_ptl_eq_wait_drain(
+        ptl_handle_eq_t eq_handle, 
+        ptl_event_t *event) 
+{
+	int rc = PTL_EQ_EMPTY; 
+	int which; 
+	unsigned long seen; 
+	double wait_usecs; 
+	double deadline; 
+	struct timespec abstime; 
+
+	if (!use_locks) {
+		/* nobody else calls Portals, so block in the library */
+		return lwfs_ptl_eq_wait(eq_handle, event); 
+	}
+
+	while (!lwfs_exit_now()) {
+		pthread_mutex_lock(&notify_mutex);
+		seen = notify_count; 
+		pthread_mutex_unlock(&notify_mutex);
+
+		lwfs_ptl_lock();
+		rc = lwfs_PtlEQPoll(&eq_handle, 1, 0, event, &which); 
+		lwfs_ptl_unlock();
+
+		if ((rc == PTL_OK) || (rc == PTL_EQ_DROPPED)) {
+			if (rc == PTL_EQ_DROPPED) {
+				log_warn(rpc_debug_level, "lwfs_PtlEQPoll dropped some events");
+			}
+			rc = LWFS_OK;
+			break;
+		}
+		else if (rc != PTL_EQ_EMPTY) {
+			log_error(rpc_debug_level, "lwfs_PtlEQPoll failed: %s",
+					ptl_err_str[rc]);
+			return LWFS_ERR_RPC;
+		}
+
+		/* sleep until the handler counts a new event */
+		pthread_mutex_lock(&notify_mutex);
+		wait_usecs = (notify_count > 0)? 1000.0*MIN_TIMEOUT : max_poll_backoff; 
+		deadline = lwfs_get_time() + wait_usecs/1000000.0; 
+		abstime.tv_sec = (time_t)deadline; 
+		abstime.tv_nsec = (long)((deadline - abstime.tv_sec)*1.0e9); 
+		while ((notify_count == seen) && !lwfs_exit_now()) {
+			if (pthread_cond_timedwait(&notify_cond, &notify_mutex, &abstime) != 0) {
+				break; 
+			}
+		}
+		pthread_mutex_unlock(&notify_mutex);
+
+		pthread_mutex_lock(&poll_stats_mutex);
+		if (notify_count != seen) poll_stats.wakeups++; 
+		else poll_stats.drain_timeouts++; 
+		pthread_mutex_unlock(&poll_stats_mutex);
+	}
+
+	if (rc != LWFS_OK) {
+		/* asked to exit */
+		return LWFS_ERR_TIMEDOUT; 
+	}
+
+	if (event->ni_fail_type != PTL_NI_OK) {
+		ptl_handle_ni_t ni_h; 
+		lwfs_ptl_get_ni(&ni_h); 
+		log_error(rpc_debug_level, "NI reported error: ni_fail_type=%s",
+				PtlNIFailStr(ni_h, event->ni_fail_type)); 
+		rc = LWFS_ERR_RPC; 
+	}
+
+	return rc; 
+}
+
+
 int lwfs_ptl_eq_poll(
 		ptl_handle_eq_t *eq_handle, 
 		int size, 
@@ -191,6 +334,12 @@ int lwfs_ptl_eq_poll(
 	int rc = PTL_EQ_EMPTY; 
 	int elapsed_time = 0; 
 	int timeout_per_call;
+	int backoff = 0;   /* usecs to sleep after an empty poll */
+	double slice_start = lwfs_get_time(); 
+	double sleep_start; 
+	double last_sleep = 0.0;  /* usecs */
+	double slept = 0.0;       /* usecs */
+	long empty = 0; 
 	int i;
 	
 	if (timeout < 0) 
@@ -203,10 +352,37 @@ int lwfs_ptl_eq_poll(
 //		for (i=0;i<size;i++) {
 //			log_debug(rpc_debug_level, "                              eq_h==%u", eq_handle[i]);
 //		}
-		lwfs_ptl_lock();
-		//rc = lwfs_PtlEQGet(eq_handle, event); 
-		rc = lwfs_PtlEQPoll(eq_handle, size, timeout_per_call, event, which); 
-		lwfs_ptl_unlock();
+		if (use_locks) {
+			/* check without blocking, then wait outside the lock */
+			lwfs_ptl_lock();
+			rc = lwfs_PtlEQPoll(eq_handle, size, 0, event, which); 
+			lwfs_ptl_unlock();
+
+			if (rc == PTL_EQ_EMPTY) {
+				sleep_start = lwfs_get_time(); 
+				if ((backoff == 0) || (max_poll_backoff == 0)) {
+					sched_yield();
+					backoff = 1;
+				}
+				else {
+					usleep(backoff);
+					backoff = (2*backoff < max_poll_backoff)? 2*backoff : max_poll_backoff;
+				}
+				last_sleep = (lwfs_get_time() - sleep_start)*1000000.0; 
+				slept += last_sleep; 
+				empty++; 
+
+				/* count the time in slices, like the blocking poll */
+				if ((lwfs_get_time() - slice_start)*1000.0 < timeout_per_call) {
+					continue;
+				}
+				slice_start = lwfs_get_time();
+			}
+		}
+		else {
+			//rc = lwfs_PtlEQGet(eq_handle, event); 
+			rc = lwfs_PtlEQPoll(eq_handle, size, timeout_per_call, event, which); 
+		}
 //		log_debug(rpc_debug_level, "thread_id(%d): polling status is %s", lwfs_thread_pool_getrank(), ptl_err_str[rc]);
 
 		/* case 1: success */
@@ -248,6 +424,18 @@ int lwfs_ptl_eq_poll(
 		}
 	}
 
+	if (use_locks) {
+		pthread_mutex_lock(&poll_stats_mutex);
+		if (rc == LWFS_OK) {
+			poll_stats.events++; 
+			/* the event arrived during the last sleep, at worst at its start */
+			if (empty > 0) poll_stats.late_usecs += last_sleep; 
+		}
+		poll_stats.empty_polls += empty; 
+		poll_stats.backoff_usecs += slept; 
+		pthread_mutex_unlock(&poll_stats_mutex);
+	}
+
 //        log_debug(rpc_debug_level, "Poll Event= {");
 //        log_debug(rpc_debug_level, "\ttype = %d", event->type);
 //        log_debug(rpc_debug_level, "\tinitiator = (%llu, %llu)", 
@@ -284,6 +472,37 @@ int lwfs_ptl_eq_timedwait(
 }
 
 
+/**
+ * @brief Take the next event from a queue without waiting.
+ *
+ * @returns \ref LWFS_ERR_TIMEDOUT if the queue is empty.
+ */
+int lwfs_ptl_eq_get(
+        ptl_handle_eq_t eq_handle, 
+        ptl_event_t *event) 
+{
+	int rc; 
+
+	lwfs_ptl_lock();
+	rc = lwfs_PtlEQGet(eq_handle, event); 
+	lwfs_ptl_unlock();
+
+	if (rc == PTL_OK) {
+		return LWFS_OK;
+	}
+	else if (rc == PTL_EQ_DROPPED) {
+		log_warn(rpc_debug_level, "lwfs_PtlEQGet succeeded, but at least one event was dropped");
+		return LWFS_OK;
+	}
+	else if (rc == PTL_EQ_EMPTY) {
+		return LWFS_ERR_TIMEDOUT;
+	}
+
+	log_error(rpc_debug_level, "lwfs_PtlEQGet failed: %s", ptl_err_str[rc]);
+	return LWFS_ERR_RPC;
+}
+
+
 int lwfs_ptl_eq_alloc(
 	ptl_handle_ni_t ni_handle, 
 	ptl_size_t count,
@@ -322,8 +541,6 @@ int lwfs_ptl_put(
     int rc = LWFS_OK; 
     int rc2; 
 
-    int num_eq_slots = 5; 
-
     ptl_handle_eq_t eq_h;         /* event queue  */
     ptl_event_t event;            /* event */
     ptl_md_t md;                  /* memory descriptor */
@@ -342,17 +559,13 @@ int lwfs_ptl_put(
     snd_target.nid = dest_addr->match_id.nid; 
     snd_target.pid = dest_addr->match_id.pid; 
 
-    lwfs_ptl_lock();
-
     log_debug(rpc_debug_level, "enter lwfs_ptl_put");
 
-    /* allocate an event queue for the send */
-    rc = lwfs_PtlEQAlloc(ni_h, num_eq_slots, PTL_EQ_HANDLER_NONE, &eq_h); 
-    if (rc) {
-        log_fatal(rpc_debug_level,"lwfs_PtlEQAlloc() failed, %s", 
-                ptl_err_str[rc]);
-        rc = LWFS_ERR_RPC;
-        goto unlock;
+    /* get an event queue for the send */
+    rc = lwfs_ptl_pool_eq_get(&eq_h); 
+    if (rc != LWFS_OK) {
+        log_fatal(rpc_debug_level,"could not get an event queue");
+        return rc;
     }
     
     log_debug(rpc_debug_level, "thread_id(%d): eq_h == %d", lwfs_thread_pool_getrank(), eq_h);
@@ -375,7 +588,9 @@ int lwfs_ptl_put(
     md.user_ptr = NULL;  /* unused */
 
     /* bind the md */
+    lwfs_ptl_lock();
     rc = lwfs_PtlMDBind(ni_h, md, PTL_UNLINK, &md_h); 
+    lwfs_ptl_unlock();
     if (rc) {
         log_fatal(rpc_debug_level,"lwfs_PtlMDBind() failed, %s", 
                 ptl_err_str[rc]);
@@ -394,8 +609,10 @@ int lwfs_ptl_put(
                 "DEBUG ", dest_addr);
     }
 
+    lwfs_ptl_lock();
     rc = lwfs_PtlPut(md_h, PTL_ACK_REQ, snd_target, dest_addr->buffer_id, 0, 
             dest_addr->match_bits, dest_addr->offset, 0);
+    lwfs_ptl_unlock();
     if (rc) {
         log_fatal(rpc_debug_level,"lwfs_PtlPut() failed, %s", ptl_err_str[rc]);
         rc = LWFS_ERR_RPC;
@@ -417,7 +634,7 @@ int lwfs_ptl_put(
         }
         if (rc == LWFS_ERR_TIMEDOUT) {
         	log_debug(rpc_debug_level, "lwfs_ptl_eq_poll timed out with empty EQ");
-        	if (iter >= max_iters) {
+        	if (++iter < max_iters) {
 	        	log_debug(rpc_debug_level, "retrying after timeout");
         		continue;
         	}
@@ -533,17 +750,19 @@ cleanup:
     }
     */
 
-    /* free the event queue */
-    rc2 = lwfs_PtlEQFree(eq_h); 
-    if (rc2 != PTL_OK) {
-        log_error(rpc_debug_level,"thread_id(%d); failed to free event queue (%s)",
-                lwfs_thread_pool_getrank(), ptl_err_str[rc2]);
+    /* recycle the event queue (events may still come after a failure) */
+    if (rc == LWFS_OK) {
+        rc2 = lwfs_ptl_pool_eq_put(eq_h); 
+    }
+    else {
+        rc2 = lwfs_ptl_pool_eq_discard(eq_h); 
+    }
+    if (rc2 != LWFS_OK) {
+        log_error(rpc_debug_level,"thread_id(%d); failed to release event queue",
+                lwfs_thread_pool_getrank());
         rc = LWFS_ERR_RPC;
     }
 
-unlock:
-    lwfs_ptl_unlock();
-
     return rc; 
 }
 
@@ -565,7 +784,7 @@ int lwfs_ptl_get(
 
     ptl_md_t md;              /* the memory descriptor */
     ptl_handle_md_t md_h;     /* handle to the memory descriptor */
-    ptl_handle_md_t eq_h;     /* handle to the event queue */
+    ptl_handle_eq_t eq_h;     /* handle to the event queue */
     ptl_event_t event; 
 
     lwfs_bool got_send_start = FALSE;
@@ -575,25 +794,19 @@ int lwfs_ptl_get(
     lwfs_bool got_unlink = FALSE; 
     lwfs_bool done = FALSE;
 
-    int num_eq_slots = 10;  /* no more than 10 entries in the event queue */
-
     int iter, max_iters;
 
-    lwfs_ptl_lock();
-    
     int old_debug_level = rpc_debug_level;
 //    rpc_debug_level=rpc_debug_level;
 
     log_debug(rpc_debug_level, "%d: enter lwfs_ptl_get", pthread_self());
 
-    /* create the event queue */
-    log_debug(rpc_debug_level,"%d: allocating event queue for \"get\"", pthread_self());
-    rc = lwfs_PtlEQAlloc(ni_h, num_eq_slots, NULL, &eq_h); 
-    if (rc) {
-        log_fatal(rpc_debug_level,"lwfs_PtlEQAlloc() failed, %s", 
-                ptl_err_str[rc]);
-        rc = LWFS_ERR_RPC;
-        goto unlock;
+    /* get an event queue */
+    log_debug(rpc_debug_level,"%d: getting event queue for \"get\"", pthread_self());
+    rc = lwfs_ptl_pool_eq_get(&eq_h); 
+    if (rc != LWFS_OK) {
+        log_fatal(rpc_debug_level,"could not get an event queue");
+        goto out;
     }
 
     /* create the memory descriptor */
@@ -608,7 +821,9 @@ int lwfs_ptl_get(
 
     /* bind the memory descriptor */
     log_debug(rpc_debug_level,"binding memory descriptor for \"get\"");
+    lwfs_ptl_lock();
     rc = lwfs_PtlMDBind(ni_h, md, PTL_UNLINK, &md_h); 
+    lwfs_ptl_unlock();
     if (rc) {
         log_fatal(rpc_debug_level,"lwfs_PtlMDBind() failed, %s",rc);
         rc = LWFS_ERR_RPC;
@@ -628,8 +843,10 @@ int lwfs_ptl_get(
 
 
     /* get the data */
+    lwfs_ptl_lock();
     rc = lwfs_PtlGet(md_h, src_target, src_addr->buffer_id, 0, 
             src_addr->match_bits, src_addr->offset);
+    lwfs_ptl_unlock();
     if (rc) {
         log_fatal(rpc_debug_level,"lwfs_PtlGet() failed, %s", ptl_err_str[rc]);
         rc = LWFS_ERR_RPC;
@@ -659,7 +876,7 @@ int lwfs_ptl_get(
         }
         if (rc == LWFS_ERR_TIMEDOUT) {
         	log_debug(rpc_debug_level, "lwfs_ptl_eq_poll timed out with empty EQ");
-        	if (iter >= max_iters) {
+        	if (++iter < max_iters) {
 	        	log_debug(rpc_debug_level, "retrying after timeout");
         		continue;
         	}
@@ -779,15 +996,14 @@ int lwfs_ptl_get(
 
 failed:
 cleanup:   
-    log_debug(rpc_debug_level,"freeing eq_h..."); 
-    int rc2 = lwfs_PtlEQFree(eq_h); 
-    if (rc2 != PTL_OK) {
-        log_error(rpc_debug_level,"unable to free eq");
+    log_debug(rpc_debug_level,"releasing eq_h..."); 
+    int rc2 = (rc == LWFS_OK)? lwfs_ptl_pool_eq_put(eq_h) : lwfs_ptl_pool_eq_discard(eq_h); 
+    if (rc2 != LWFS_OK) {
+        log_error(rpc_debug_level,"unable to release eq");
         rc = LWFS_ERR_RPC;
     }
 
-unlock:
-    lwfs_ptl_unlock();
+out:
 
     rpc_debug_level = old_debug_level;
     return rc;
@@ -889,6 +1105,26 @@ int lwfs_ptl_md_unlink(
         return (rc);
 }
 
+int lwfs_ptl_me_unlink(
+		ptl_handle_me_t me_handle)
+{
+        int rc; /* return code */
+
+        lwfs_ptl_lock();
+
+        log_debug(rpc_debug_level, "enter lwfs_ptl_me_unlink");
+
+	rc = lwfs_PtlMEUnlink(me_handle); 
+        lwfs_ptl_unlock();
+        if (rc != PTL_OK) {
+            log_error(rpc_debug_level, "could not unlink ME: %s",
+                    ptl_err_str[rc]);
+            rc = LWFS_ERR_RPC; 
+        }
+        
+        return (rc);
+}
+
 int lwfs_ptl_eq_free(
 		ptl_handle_eq_t eq_handle)
 {
@@ -909,12 +1145,58 @@ int lwfs_ptl_eq_free(
         return (rc);
 }
 
-static int use_locks=0;
 void lwfs_ptl_use_locks(int should_lock)
 {
 	use_locks = should_lock;
 }
 
+/**
+ * @brief Set the longest sleep (in usecs) between polls of a shared EQ.
+ *
+ * Zero makes \ref lwfs_ptl_eq_poll yield the processor instead of 
+ * sleeping, which trades CPU time for latency. 
+ */
+void lwfs_ptl_set_poll_backoff(int usecs)
+{
+	max_poll_backoff = (usecs < 0)? MAX_POLL_BACKOFF : usecs;
+}
+
+/**
+ * @brief Get a copy of the poll counters.
+ */
+void lwfs_ptl_get_poll_stats(
+		struct lwfs_ptl_poll_stats *stats)
+{
+	pthread_mutex_lock(&poll_stats_mutex);
+	memcpy(stats, &poll_stats, sizeof(struct lwfs_ptl_poll_stats));
+	pthread_mutex_unlock(&poll_stats_mutex);
+}
+
+/**
+ * @brief Print the poll counters.
+ *
+ * The late time is an upper bound on the latency the backoff 
+ * added to the events that worker threads waited for. 
+ */
+void fprint_lwfs_ptl_poll_stats(
+		FILE *fp,
+		const char *prefix)
+{
+	struct lwfs_ptl_poll_stats stats;
+
+	lwfs_ptl_get_poll_stats(&stats);
+
+	fprintf(fp, "%s Portals polls (max backoff = %d usecs):\n", prefix, max_poll_backoff);
+	fprintf(fp, "%s   events = %ld\n", prefix, stats.events);
+	fprintf(fp, "%s   empty polls = %ld\n", prefix, stats.empty_polls);
+	fprintf(fp, "%s   backoff usecs = %.0f\n", prefix, stats.backoff_usecs);
+	fprintf(fp, "%s   late usecs = %.0f\n", prefix, stats.late_usecs);
+	fprintf(fp, "%s   late usecs/event = %.2f\n", prefix, 
+			(stats.events > 0)? stats.late_usecs/stats.events : 0.0);
+	fprintf(fp, "%s   drain wakeups = %ld\n", prefix, stats.wakeups);
+	fprintf(fp, "%s   drain timeouts = %ld\n", prefix, stats.drain_timeouts);
+}
+
 int lwfs_ptl_lock()
 {
 	int rc=LWFS_OK;
@@ -935,7 +1217,6 @@ int lwfs_ptl_unlock()
             log_debug(rpc_debug_level, "thread_id(%d): attempting unlock of portals_mutex=%p", lwfs_thread_pool_getrank(), &portals_mutex, rc);
             rc = pthread_mutex_unlock(&portals_mutex);
             log_debug(rpc_debug_level, "thread_id(%d): unlocked using portals_mutex=%p, rc=%d", lwfs_thread_pool_getrank(), &portals_mutex, rc);
-            pthread_yield();
 	}        
         return(rc);
 }
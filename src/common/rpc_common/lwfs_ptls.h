@@ -34,7 +34,28 @@ extern "C" {
 
 	/*------------- Data structures ---------------*/
 
-	/*------------- Data structures ---------------*/
+	/**
+	 * @brief Counters for threads that poll EQs with locks on.
+	 */
+	struct lwfs_ptl_poll_stats {
+		/** @brief Events returned by lwfs_ptl_eq_poll. */
+		long events;
+
+		/** @brief Polls that found the EQs empty. */
+		long empty_polls;
+
+		/** @brief Microseconds spent sleeping (or yielding) between polls. */
+		double backoff_usecs;
+
+		/** @brief Microseconds of the sleeps that ended with an event waiting. */
+		double late_usecs;
+
+		/** @brief Times the EQ handler woke lwfs_ptl_eq_wait_drain. */
+		long wakeups;
+
+		/** @brief Times lwfs_ptl_eq_wait_drain polled again without a wakeup. */
+		long drain_timeouts;
+	};
 
 	/*------------- Method prototypes ---------------*/
 
@@ -61,10 +82,21 @@ extern "C" {
 			int timeout, 
 			ptl_event_t *event);
 
+	extern int lwfs_ptl_eq_get(
+			ptl_handle_eq_t eq_handle, 
+			ptl_event_t *event);
+
 	extern int lwfs_ptl_eq_wait(
 			ptl_handle_eq_t eq_handle, 
 			ptl_event_t *event);
 
+	extern int lwfs_ptl_eq_wait_drain(
+			ptl_handle_eq_t eq_handle, 
+			ptl_event_t *event);
+
+	extern void lwfs_ptl_eq_notify(
+			ptl_event_t *event);
+
 	extern int lwfs_ptl_eq_alloc(
 			ptl_handle_ni_t ni_handle, 
 			ptl_size_t count,
@@ -102,11 +134,23 @@ extern "C" {
 	extern int lwfs_ptl_md_unlink(
 			ptl_handle_md_t md_handle);
 
+	extern int lwfs_ptl_me_unlink(
+			ptl_handle_me_t me_handle);
+
 	extern int lwfs_ptl_eq_free(
 			ptl_handle_eq_t eq_handle);
 
 	void lwfs_ptl_use_locks(int should_lock);
 
+	void lwfs_ptl_set_poll_backoff(int usecs);
+
+	void lwfs_ptl_get_poll_stats(
+			struct lwfs_ptl_poll_stats *stats);
+
+	void fprint_lwfs_ptl_poll_stats(
+			FILE *fp,
+			const char *prefix);
+
 	int lwfs_ptl_lock();
 
 	int lwfs_ptl_unlock();
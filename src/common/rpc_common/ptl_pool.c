@@ -0,0 +1,264 @@
+/*-------------------------------------------------------------------------*/
+/**  @file ptl_pool.c
+ *
+ *   @brief Pools of Portals event queues and short message buffers.
+ *
+ *   Every RPC used to allocate (and free) an event queue for the
+ *   request, one for the short result, and one for the data, plus
+ *   heap buffers for the short request and result.  We keep the
+ *   idle queues and buffers here instead, so a client or server
+ *   in steady state allocates nothing on the small-message path.
+ *
+ *   A queue goes back to the pool only after the caller saw every
+ *   event it expected; we drain anything left (e.g., data events
+ *   nobody waits for) before reusing it.  After an error, callers
+ *   discard the queue, since late events could still arrive.
+ *
+ *   @author Ron Oldfield (raoldfi\@sandia.gov)
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include PORTALS_HEADER
+
+#include "common/types/types.h"
+#include "support/logger/logger.h"
+
+#include "lwfs_ptls.h"
+#include "rpc_debug.h"
+#include "ptl_wrap.h"
+#include "ptl_pool.h"
+
+
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* idle event queues (a stack, so the warmest queue goes out first) */
+static ptl_handle_eq_t idle_eqs[LWFS_PTL_POOL_MAX];
+static int num_idle_eqs = 0;
+
+/* idle buffers of LWFS_PTL_POOL_BUF_SIZE bytes */
+static void *idle_bufs[LWFS_PTL_POOL_MAX];
+static int num_idle_bufs = 0;
+
+static struct lwfs_ptl_pool_stats pool_stats;
+
+
+/* free_eq()
+ *
+ * gives an event queue back to Portals;
+ */
+static int free_eq(ptl_handle_eq_t eq_h)
+{
+	int rc;
+
+	lwfs_ptl_lock();
+	rc = lwfs_PtlEQFree(eq_h);
+	lwfs_ptl_unlock();
+	if (rc != PTL_OK) {
+		log_error(rpc_debug_level, "failed to free event queue: %s",
+				ptl_err_str[rc]);
+		return LWFS_ERR_RPC;
+	}
+
+	return LWFS_OK;
+}
+
+
+/**
+ * @brief Get an empty event queue.
+ *
+ * The queue has \ref LWFS_PTL_POOL_EQ_SLOTS slots and no
+ * event handler.
+ */
+int lwfs_ptl_pool_eq_get(
+		ptl_handle_eq_t *eq_handle)
+{
+	int rc;
+	ptl_handle_ni_t ni_h;
+
+	pthread_mutex_lock(&pool_mutex);
+	if (num_idle_eqs > 0) {
+		*eq_handle = idle_eqs[--num_idle_eqs];
+		pool_stats.eq_reuses++;
+		pthread_mutex_unlock(&pool_mutex);
+		return LWFS_OK;
+	}
+	pool_stats.eq_allocs++;
+	pthread_mutex_unlock(&pool_mutex);
+
+	lwfs_ptl_get_ni(&ni_h);
+
+	lwfs_ptl_lock();
+	rc = lwfs_PtlEQAlloc(ni_h, LWFS_PTL_POOL_EQ_SLOTS,
+			PTL_EQ_HANDLER_NONE, eq_handle);
+	lwfs_ptl_unlock();
+	if (rc != PTL_OK) {
+		log_error(rpc_debug_level, "lwfs_PtlEQAlloc() failed: %s",
+				ptl_err_str[rc]);
+		return LWFS_ERR_RPC;
+	}
+
+	return LWFS_OK;
+}
+
+/**
+ * @brief Return an event queue to the pool.
+ *
+ * Call this only when no more events can arrive on the queue.
+ * Events still in the queue are dropped.
+ */
+int lwfs_ptl_pool_eq_put(
+		ptl_handle_eq_t eq_handle)
+{
+	int rc;
+	ptl_event_t event;
+
+	/* drain the queue */
+	lwfs_ptl_lock();
+	do {
+		rc = lwfs_PtlEQGet(eq_handle, &event);
+	} while ((rc == PTL_OK) || (rc == PTL_EQ_DROPPED));
+	lwfs_ptl_unlock();
+
+	if (rc != PTL_EQ_EMPTY) {
+		log_warn(rpc_debug_level, "could not drain event queue: %s",
+				ptl_err_str[rc]);
+		return lwfs_ptl_pool_eq_discard(eq_handle);
+	}
+
+	pthread_mutex_lock(&pool_mutex);
+	if (num_idle_eqs < LWFS_PTL_POOL_MAX) {
+		idle_eqs[num_idle_eqs++] = eq_handle;
+		pthread_mutex_unlock(&pool_mutex);
+		return LWFS_OK;
+	}
+	pthread_mutex_unlock(&pool_mutex);
+
+	return lwfs_ptl_pool_eq_discard(eq_handle);
+}
+
+/**
+ * @brief Free an event queue that should not be reused
+ * (e.g., after a failed transfer).
+ */
+int lwfs_ptl_pool_eq_discard(
+		ptl_handle_eq_t eq_handle)
+{
+	pthread_mutex_lock(&pool_mutex);
+	pool_stats.eq_frees++;
+	pthread_mutex_unlock(&pool_mutex);
+
+	return free_eq(eq_handle);
+}
+
+
+/**
+ * @brief Get a buffer of at least \em len bytes.
+ *
+ * Buffers up to \ref LWFS_PTL_POOL_BUF_SIZE bytes come from
+ * the pool; larger ones from malloc.  Give the buffer back
+ * with \ref lwfs_ptl_pool_buf_put and the same length.
+ */
+void *lwfs_ptl_pool_buf_get(
+		const lwfs_size len)
+{
+	void *buf = NULL;
+
+	if (len <= LWFS_PTL_POOL_BUF_SIZE) {
+		pthread_mutex_lock(&pool_mutex);
+		if (num_idle_bufs > 0) {
+			buf = idle_bufs[--num_idle_bufs];
+			pool_stats.buf_reuses++;
+			pthread_mutex_unlock(&pool_mutex);
+			return buf;
+		}
+		pool_stats.buf_allocs++;
+		pthread_mutex_unlock(&pool_mutex);
+
+		return malloc(LWFS_PTL_POOL_BUF_SIZE);
+	}
+
+	pthread_mutex_lock(&pool_mutex);
+	pool_stats.buf_allocs++;
+	pthread_mutex_unlock(&pool_mutex);
+
+	return malloc(len);
+}
+
+/**
+ * @brief Return a buffer from \ref lwfs_ptl_pool_buf_get.
+ */
+void lwfs_ptl_pool_buf_put(
+		void *buf,
+		const lwfs_size len)
+{
+	if (buf == NULL) {
+		return;
+	}
+
+	if (len <= LWFS_PTL_POOL_BUF_SIZE) {
+		pthread_mutex_lock(&pool_mutex);
+		if (num_idle_bufs < LWFS_PTL_POOL_MAX) {
+			idle_bufs[num_idle_bufs++] = buf;
+			pthread_mutex_unlock(&pool_mutex);
+			return;
+		}
+		pthread_mutex_unlock(&pool_mutex);
+	}
+
+	free(buf);
+}
+
+
+/**
+ * @brief Get a copy of the pool counters.
+ */
+void lwfs_ptl_pool_get_stats(
+		struct lwfs_ptl_pool_stats *stats)
+{
+	pthread_mutex_lock(&pool_mutex);
+	memcpy(stats, &pool_stats, sizeof(struct lwfs_ptl_pool_stats));
+	pthread_mutex_unlock(&pool_mutex);
+}
+
+/**
+ * @brief Print the pool counters.
+ */
+void fprint_lwfs_ptl_pool_stats(
+		FILE *fp,
+		const char *prefix)
+{
+	struct lwfs_ptl_pool_stats stats;
+
+	lwfs_ptl_pool_get_stats(&stats);
+
+	fprintf(fp, "%s Portals pools:\n", prefix);
+	fprintf(fp, "%s   eq allocs = %ld\n", prefix, stats.eq_allocs);
+	fprintf(fp, "%s   eq reuses = %ld\n", prefix, stats.eq_reuses);
+	fprintf(fp, "%s   eq frees = %ld\n", prefix, stats.eq_frees);
+	fprintf(fp, "%s   buf allocs = %ld\n", prefix, stats.buf_allocs);
+	fprintf(fp, "%s   buf reuses = %ld\n", prefix, stats.buf_reuses);
+}
+
+/**
+ * @brief Free everything in the pools (before the NI goes away).
+ */
+void lwfs_ptl_pool_fini(void)
+{
+	pthread_mutex_lock(&pool_mutex);
+	while (num_idle_eqs > 0) {
+		free_eq(idle_eqs[--num_idle_eqs]);
+	}
+	while (num_idle_bufs > 0) {
+		free(idle_bufs[--num_idle_bufs]);
+	}
+	pthread_mutex_unlock(&pool_mutex);
+}
@@ -0,0 +1,89 @@
+/*-------------------------------------------------------------------------*/
+/**
+ *   @file ptl_pool.h
+ *
+ *   @brief Pools of Portals event queues and short message buffers.
+ *
+ *   @author Ron Oldfield (raoldfi\@sandia.gov)
+ *
+ */
+
+#ifndef _PTL_POOL_H_
+#define _PTL_POOL_H_
+
+#include <stdio.h>
+
+#include "config.h"
+#include PORTALS_HEADER
+
+#include "common/types/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	/** @brief Slots in every pooled event queue (enough for any transfer). */
+#define LWFS_PTL_POOL_EQ_SLOTS 16
+
+	/** @brief Size of a pooled buffer (short requests and short results). */
+#define LWFS_PTL_POOL_BUF_SIZE 512
+
+	/** @brief Most idle event queues (or buffers) a pool keeps. */
+#define LWFS_PTL_POOL_MAX 128
+
+	/**
+	 * @brief Counters for the event queue and buffer pools.
+	 */
+	struct lwfs_ptl_pool_stats {
+		/** @brief Event queues allocated from Portals. */
+		long eq_allocs;
+
+		/** @brief Event queues taken from the pool. */
+		long eq_reuses;
+
+		/** @brief Event queues freed (pool full or not reusable). */
+		long eq_frees;
+
+		/** @brief Buffers allocated with malloc. */
+		long buf_allocs;
+
+		/** @brief Buffers taken from the pool. */
+		long buf_reuses;
+	};
+
+#if defined(__STDC__) || defined(__cplusplus)
+
+	extern int lwfs_ptl_pool_eq_get(
+			ptl_handle_eq_t *eq_handle);
+
+	extern int lwfs_ptl_pool_eq_put(
+			ptl_handle_eq_t eq_handle);
+
+	extern int lwfs_ptl_pool_eq_discard(
+			ptl_handle_eq_t eq_handle);
+
+	extern void *lwfs_ptl_pool_buf_get(
+			const lwfs_size len);
+
+	extern void lwfs_ptl_pool_buf_put(
+			void *buf,
+			const lwfs_size len);
+
+	extern void lwfs_ptl_pool_get_stats(
+			struct lwfs_ptl_pool_stats *stats);
+
+	extern void fprint_lwfs_ptl_pool_stats(
+			FILE *fp,
+			const char *prefix);
+
+	extern void lwfs_ptl_pool_fini(void);
+
+#else /* K&R C */
+
+#endif /* K&R C */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -222,3 +222,119 @@ xdr_ss_truncate_args (XDR *xdrs, ss_truncate_args *objp)
 		 return FALSE;
 	return TRUE;
 }
+
+bool_t
+xdr_ss_compound_opcode (XDR *xdrs, ss_compound_opcode *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_enum (xdrs, (enum_t *) objp))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_ss_compound_write (XDR *xdrs, ss_compound_write *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_lwfs_size (xdrs, &objp->offset))
+		 return FALSE;
+	 if (!xdr_bytes (xdrs, (char **)&objp->data.data_val, (u_int *) &objp->data.data_len, ~0))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_ss_compound_op_args (XDR *xdrs, ss_compound_op_args *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_ss_compound_opcode (xdrs, &objp->op))
+		 return FALSE;
+	switch (objp->op) {
+	case SS_COMPOUND_WRITE:
+		 if (!xdr_ss_compound_write (xdrs, &objp->ss_compound_op_args_u.write))
+			 return FALSE;
+		break;
+	case SS_COMPOUND_SETATTR:
+		 if (!xdr_lwfs_attr (xdrs, &objp->ss_compound_op_args_u.attr))
+			 return FALSE;
+		break;
+	case SS_COMPOUND_TRUNCATE:
+		 if (!xdr_lwfs_ssize (xdrs, &objp->ss_compound_op_args_u.size))
+			 return FALSE;
+		break;
+	default:
+		break;
+	}
+	return TRUE;
+}
+
+bool_t
+xdr_ss_compound_op (XDR *xdrs, ss_compound_op *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_lwfs_obj (xdrs, &objp->obj))
+		 return FALSE;
+	 if (!xdr_ss_compound_op_args (xdrs, &objp->args))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_ss_compound_args (XDR *xdrs, ss_compound_args *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_pointer (xdrs, (char **)&objp->txn_id, sizeof (lwfs_txn), (xdrproc_t) xdr_lwfs_txn))
+		 return FALSE;
+	 if (!xdr_array (xdrs, (char **)&objp->ops.ops_val, (u_int *) &objp->ops.ops_len, ~0,
+		sizeof (ss_compound_op), (xdrproc_t) xdr_ss_compound_op))
+		 return FALSE;
+	 if (!xdr_pointer (xdrs, (char **)&objp->cap, sizeof (lwfs_cap), (xdrproc_t) xdr_lwfs_cap))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_ss_compound_op_res (XDR *xdrs, ss_compound_op_res *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_ss_compound_opcode (xdrs, &objp->op))
+		 return FALSE;
+	switch (objp->op) {
+	case SS_COMPOUND_STAT:
+		 if (!xdr_lwfs_stat_data (xdrs, &objp->ss_compound_op_res_u.stat))
+			 return FALSE;
+		break;
+	default:
+		break;
+	}
+	return TRUE;
+}
+
+bool_t
+xdr_ss_compound_result (XDR *xdrs, ss_compound_result *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_int (xdrs, &objp->rc))
+		 return FALSE;
+	 if (!xdr_ss_compound_op_res (xdrs, &objp->res))
+		 return FALSE;
+	return TRUE;
+}
+
+bool_t
+xdr_ss_compound_res (XDR *xdrs, ss_compound_res *objp)
+{
+	register int32_t *buf;
+
+	 if (!xdr_array (xdrs, (char **)&objp->results.results_val, (u_int *) &objp->results.results_len, ~0,
+		sizeof (ss_compound_result), (xdrproc_t) xdr_ss_compound_result))
+		 return FALSE;
+	return TRUE;
+}
@@ -124,6 +124,73 @@ struct ss_truncate_args {
 };
 typedef struct ss_truncate_args ss_truncate_args;
 
+enum ss_compound_opcode {
+	SS_COMPOUND_CREATE = 1,
+	SS_COMPOUND_WRITE = 2,
+	SS_COMPOUND_SETATTR = 3,
+	SS_COMPOUND_TRUNCATE = 4,
+	SS_COMPOUND_FSYNC = 5,
+	SS_COMPOUND_STAT = 6,
+};
+typedef enum ss_compound_opcode ss_compound_opcode;
+
+struct ss_compound_write {
+	lwfs_size offset;
+	struct {
+		u_int data_len;
+		char *data_val;
+	} data;
+};
+typedef struct ss_compound_write ss_compound_write;
+
+struct ss_compound_op_args {
+	ss_compound_opcode op;
+	union {
+		ss_compound_write write;
+		lwfs_attr attr;
+		lwfs_ssize size;
+	} ss_compound_op_args_u;
+};
+typedef struct ss_compound_op_args ss_compound_op_args;
+
+struct ss_compound_op {
+	lwfs_obj obj;
+	ss_compound_op_args args;
+};
+typedef struct ss_compound_op ss_compound_op;
+
+struct ss_compound_args {
+	lwfs_txn *txn_id;
+	struct {
+		u_int ops_len;
+		ss_compound_op *ops_val;
+	} ops;
+	lwfs_cap *cap;
+};
+typedef struct ss_compound_args ss_compound_args;
+
+struct ss_compound_op_res {
+	ss_compound_opcode op;
+	union {
+		lwfs_stat_data stat;
+	} ss_compound_op_res_u;
+};
+typedef struct ss_compound_op_res ss_compound_op_res;
+
+struct ss_compound_result {
+	int rc;
+	ss_compound_op_res res;
+};
+typedef struct ss_compound_result ss_compound_result;
+
+struct ss_compound_res {
+	struct {
+		u_int results_len;
+		ss_compound_result *results_val;
+	} results;
+};
+typedef struct ss_compound_res ss_compound_res;
+
 /* the xdr functions */
 
 #if defined(__STDC__) || defined(__cplusplus)
@@ -141,6 +208,14 @@ extern  bool_t xdr_ss_getattr_args (XDR *, ss_getattr_args*);
 extern  bool_t xdr_ss_setattr_args (XDR *, ss_setattr_args*);
 extern  bool_t xdr_ss_rmattr_args (XDR *, ss_rmattr_args*);
 extern  bool_t xdr_ss_truncate_args (XDR *, ss_truncate_args*);
+extern  bool_t xdr_ss_compound_opcode (XDR *, ss_compound_opcode*);
+extern  bool_t xdr_ss_compound_write (XDR *, ss_compound_write*);
+extern  bool_t xdr_ss_compound_op_args (XDR *, ss_compound_op_args*);
+extern  bool_t xdr_ss_compound_op (XDR *, ss_compound_op*);
+extern  bool_t xdr_ss_compound_args (XDR *, ss_compound_args*);
+extern  bool_t xdr_ss_compound_op_res (XDR *, ss_compound_op_res*);
+extern  bool_t xdr_ss_compound_result (XDR *, ss_compound_result*);
+extern  bool_t xdr_ss_compound_res (XDR *, ss_compound_res*);
 
 #else /* K&R C */
 extern bool_t xdr_ss_create_obj_args ();
@@ -157,6 +232,14 @@ extern bool_t xdr_ss_getattr_args ();
 extern bool_t xdr_ss_setattr_args ();
 extern bool_t xdr_ss_rmattr_args ();
 extern bool_t xdr_ss_truncate_args ();
+extern bool_t xdr_ss_compound_opcode ();
+extern bool_t xdr_ss_compound_write ();
+extern bool_t xdr_ss_compound_op_args ();
+extern bool_t xdr_ss_compound_op ();
+extern bool_t xdr_ss_compound_args ();
+extern bool_t xdr_ss_compound_op_res ();
+extern bool_t xdr_ss_compound_result ();
+extern bool_t xdr_ss_compound_res ();
 
 #endif /* K&R C */
 
@@ -109,3 +109,82 @@ struct ss_truncate_args {
 	 lwfs_ssize size; 
 	 lwfs_cap *cap; 
 };
+
+
+/* ---------- compound requests ---------- */
+
+/**
+ * @brief Operations allowed inside a compound request.
+ */
+enum ss_compound_opcode {
+	SS_COMPOUND_CREATE = 1,
+	SS_COMPOUND_WRITE = 2,
+	SS_COMPOUND_SETATTR = 3,
+	SS_COMPOUND_TRUNCATE = 4,
+	SS_COMPOUND_FSYNC = 5,
+	SS_COMPOUND_STAT = 6
+};
+
+/**
+ * @brief A small write.  The data travels with the request
+ * (use \ref lwfs_write for bulk data).
+ */
+struct ss_compound_write {
+	lwfs_size offset;
+	opaque data<>;
+};
+
+union ss_compound_op_args switch (ss_compound_opcode op) {
+	case SS_COMPOUND_WRITE:
+		ss_compound_write write;
+	case SS_COMPOUND_SETATTR:
+		lwfs_attr attr;
+	case SS_COMPOUND_TRUNCATE:
+		lwfs_ssize size;
+	default:
+		void;
+};
+
+/**
+ * @brief One operation of a compound request.
+ */
+struct ss_compound_op {
+	lwfs_obj obj;
+	ss_compound_op_args args;
+};
+
+/**
+ * @brief An ordered list of operations for one storage server.
+ *
+ * Every object has to be in the container of the cap. 
+ */
+struct ss_compound_args {
+	lwfs_txn *txn_id;
+	ss_compound_op ops<>;
+	lwfs_cap *cap;
+};
+
+union ss_compound_op_res switch (ss_compound_opcode op) {
+	case SS_COMPOUND_STAT:
+		lwfs_stat_data stat;
+	default:
+		void;
+};
+
+/**
+ * @brief Result of one operation of a compound request.
+ */
+struct ss_compound_result {
+	int rc;
+	ss_compound_op_res res;
+};
+
+/**
+ * @brief Results of a compound request, one per operation that ran.
+ *
+ * The server stops at the first operation that fails, so fewer 
+ * results than operations means the last result has the error.
+ */
+struct ss_compound_res {
+	ss_compound_result results<>;
+};
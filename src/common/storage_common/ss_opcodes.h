@@ -62,6 +62,9 @@ extern "C" {
 		/** @brief Revoke access to an object. */
 		LWFS_OP_REVOKE,
 
+		/** @brief Run a list of operations in one request. */
+		LWFS_OP_COMPOUND,
+
 		/** @brief Lock an object. */
 		LWFS_OP_LOCK = 216,
 
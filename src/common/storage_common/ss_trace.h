@@ -34,7 +34,8 @@ extern "C" {
 	    TRACE_SS_VALID_HIT,
 	    TRACE_SS_VALID_MISS,
 	    TRACE_AIO_WRITE,
-	    TRACE_SYSIO_WRITE
+	    TRACE_SYSIO_WRITE,
+	    TRACE_SS_COMPOUND
 	};
 
 #if defined(__STDC__) || defined(__cplusplus)
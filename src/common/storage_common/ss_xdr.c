@@ -106,5 +106,11 @@ int register_ss_encodings()
 			(xdrproc_t)NULL,
 			(xdrproc_t)&xdr_lwfs_stat_data);
 
+	/* compound */
+	lwfs_register_xdr_encoding(LWFS_OP_COMPOUND, 
+			(xdrproc_t)&xdr_ss_compound_args, 
+			(xdrproc_t)NULL,
+			(xdrproc_t)&xdr_ss_compound_res);
+
 	return rc; 
 }
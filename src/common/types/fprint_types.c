@@ -116,6 +116,9 @@ const char *lwfs_err_str(int rc)
 		case LWFS_ERR_DECODE:
 			return "LWFS_ERR_DECODE";
 
+		case LWFS_ERR_BUSY:
+			return "LWFS_ERR_BUSY";
+
 		case LWFS_ERR_SEC:
 			return "LWFS_ERR_SEC";
 
@@ -50,6 +50,7 @@ enum lwfs_return_code {
 	LWFS_ERR_LOCK_EXISTS = 0 + 23,
 	LWFS_ERR_NO_LOCK = 0 + 24,
 	LWFS_ERR_TXN = 0 + 25,
+	LWFS_ERR_BUSY = 0 + 26,
 };
 typedef enum lwfs_return_code lwfs_return_code;
 #define LWFS_UUIDSIZE 16
@@ -170,7 +170,12 @@ enum lwfs_return_code {
 	/* ----------- Transaction error codes ---- */
 
 	/** @brief The transaction is invalid. */
-	LWFS_ERR_TXN
+	LWFS_ERR_TXN,
+
+	/* ----------- Flow control error codes ---- */
+
+	/** @brief The server is too busy for the request; try again later. */
+	LWFS_ERR_BUSY
 
 };
 
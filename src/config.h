@@ -40,6 +40,9 @@
 /* Define to 1 if you have the <inttypes.h> header file. */
 #define HAVE_INTTYPES_H 1
 
+/* Define if you have the Linux kernel aio library. */
+/* #undef HAVE_LIBAIO */
+
 /* Define if you have the libsysio. */
 #define HAVE_LIBSYSIO 1
 
@@ -58,9 +61,18 @@
 /* Define if you have the Portals. */
 #define HAVE_PORTALS 1
 
+/* Define to 1 if you have the `preadv' function. */
+#define HAVE_PREADV 1
+
+/* Define to 1 if you have the `pwritev' function. */
+#define HAVE_PWRITEV 1
+
 /* Define if you have POSIX threads libraries and header files. */
 /* #undef HAVE_PTHREAD */
 
+/* Define to 1 if you have the `pthread_setaffinity_np' function. */
+#define HAVE_PTHREAD_SETAFFINITY_NP 1
+
 /* Define to 1 if you have the `PtlACEntry' function. */
 #define HAVE_PTLACENTRY 1
 
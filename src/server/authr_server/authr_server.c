@@ -12,6 +12,9 @@
 #include <db.h>
 #include <assert.h>
 #include <math.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
 
 
 #include "server/rpc_server/rpc_server.h"
@@ -24,6 +27,9 @@
 #include "common/authr_common/authr_opcodes.h"
 
 #include "support/trace/trace.h"
+#include "support/timer/timer.h"
+
+#include "client/authr_client/authr_client.h"
 
 #include "cap.h"
 #include "authr_server.h"
@@ -40,11 +46,43 @@
 /* --------- type definitions ------------ */
 typedef int (*compare_proc)(const void *, const void *);
 
+/** @brief Time (in ms) to wait for a service to acknowledge a revocation or a new key. */
+#define REVOKE_TIMEOUT 5000
+
+/** @brief Revoked containers that make us rotate the key early (see \ref record_revoked). */
+#define MAX_REVOKED_CIDS 1024
+
+/** @brief First and longest pause (in seconds) before resending a revocation. */
+#define REVOKE_MIN_BACKOFF 0.25
+#define REVOKE_MAX_BACKOFF 8.0
+
 /* ----------------- global variables -------------------------------*/
 
 /** @brief The key used to generate/verify caps. */
 static lwfs_key authr_svc_key; 
 
+/** @brief The key used before the last rotation (still accepted). */
+static lwfs_key authr_prev_key; 
+
+/** @brief Number of key rotations (protected by key_mutex). */
+static unsigned int key_generation = 0; 
+static pthread_mutex_t key_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/** @brief Give the key to services that verify caps locally. */
+static lwfs_bool share_key = FALSE; 
+
+/** @brief The only processes that may fetch the key (see \ref get_cap_key). */
+static lwfs_remote_pid *trusted_ids = NULL; 
+static int num_trusted_ids = 0; 
+
+/** @brief Seconds between key rotations (0 disables rotation). */
+static int key_lifetime = 0; 
+static pthread_t rotate_thread; 
+static pthread_mutex_t rotate_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t rotate_cond = PTHREAD_COND_INITIALIZER;
+static lwfs_bool rotate_done = FALSE; 
+static lwfs_bool rotate_now = FALSE; 
+
 /** @brief Flags to enable/disable some functionality. */
 static lwfs_bool acl_db_enabled = TRUE;
 static lwfs_bool caps_enabled = TRUE; 
@@ -57,10 +95,47 @@ struct authr_counter {
     long modacl;
     long getcap;
     long verify;
+    long revoke;
+    long getkey;
+    long rotate;
 };
 
 static struct authr_counter authr_counter;
 
+/** @brief Services that receive revocations (see \ref register_cap_cache
+ * and \ref get_cap_key). */
+static lwfs_service *cap_caches = NULL; 
+static int num_cap_caches = 0; 
+static pthread_mutex_t cap_caches_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/** @brief Services that verify caps locally (protected by cap_caches_mutex). */
+static lwfs_service *key_holders = NULL; 
+static int num_key_holders = 0; 
+
+/** @brief Containers with revoked operations (protected by cap_caches_mutex). */
+static lwfs_revoked_cid *revoked_cids = NULL; 
+static int num_revoked_cids = 0; 
+
+/** @brief A revocation a cap cache has not acknowledged yet. */
+struct pending_revoke {
+	lwfs_service svc; 
+	lwfs_cid cid; 
+	lwfs_container_op container_op; 
+	unsigned int generation; 
+	int attempts; 
+	double next_try;   /* lwfs_get_time() of the next send */
+	double give_up;    /* lwfs_get_time() after which we drop it */
+	lwfs_request req; 
+	struct pending_revoke *next; 
+};
+
+/** @brief Revocations waiting for the revoke thread (protected by revoke_mutex). */
+static struct pending_revoke *revoke_queue = NULL; 
+static pthread_t revoke_thread; 
+static pthread_mutex_t revoke_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t revoke_cond = PTHREAD_COND_INITIALIZER;
+static lwfs_bool revoke_done = FALSE; 
+
 /**
   * @brief array of supported operation descriptions. 
   */
@@ -126,6 +201,26 @@ static const lwfs_svc_op op_array[] = {
 		(xdrproc_t)&xdr_void
 	},
 
+	/* register cap cache */
+	{
+		LWFS_OP_REGISTER_CAP_CACHE,
+		(lwfs_rpc_proc)&register_cap_cache,
+		sizeof(lwfs_register_cap_cache_args),
+		(xdrproc_t)&xdr_lwfs_register_cap_cache_args,
+		sizeof(void),
+		(xdrproc_t)&xdr_void
+	},
+
+	/* get cap key */
+	{
+		LWFS_OP_GET_CAP_KEY,
+		(lwfs_rpc_proc)&get_cap_key,
+		sizeof(lwfs_get_cap_key_args),
+		(xdrproc_t)&xdr_lwfs_get_cap_key_args,
+		sizeof(lwfs_cap_key_info),
+		(xdrproc_t)&xdr_lwfs_cap_key_info
+	},
+
 	/* always ends with a null op */
 	{LWFS_OP_NULL}
 };
@@ -512,6 +607,35 @@ static int check_cred(const lwfs_cred *cred)
 	return rc; 
 }
 
+/**
+ * @brief Copy the current (and previous) key used to generate caps. 
+ *
+ * @param key      @output_type The current key (may be NULL).
+ * @param prev_key @output_type The key used before the last rotation (may be NULL).
+ * @param generation @output_type The number of rotations (may be NULL).
+ */
+static void copy_keys(lwfs_key *key, lwfs_key *prev_key, unsigned int *generation)
+{
+	pthread_mutex_lock(&key_mutex); 
+	if (key) memcpy(*key, authr_svc_key, sizeof(lwfs_key)); 
+	if (prev_key) memcpy(*prev_key, authr_prev_key, sizeof(lwfs_key)); 
+	if (generation) *generation = key_generation; 
+	pthread_mutex_unlock(&key_mutex); 
+}
+
+/**
+ * @brief Generate a capability with the current key. 
+ */
+static int new_cap(const lwfs_cap_data *data, lwfs_cap *cap)
+{
+	lwfs_key key; 
+
+	copy_keys(&key, NULL, NULL); 
+
+	/* call the security library to generate the capability */
+	return generate_cap((const lwfs_key *)&key, data, cap); 
+}
+
 /**
  * @brief Check a capability. 
  *
@@ -530,8 +654,17 @@ static int check_cap(const lwfs_cap *cap)
 
 	/* only run this check if caps are enabled */
 	if (caps_enabled) {
+		lwfs_key key; 
+		lwfs_key prev_key; 
+
+		copy_keys(&key, &prev_key, NULL); 
+
 		/* the verify_capability method is part of the security library (in cap.c) */
-		rc = verify_cap((const lwfs_key *)(&authr_svc_key), cap); 
+		rc = verify_cap((const lwfs_key *)(&key), cap); 
+		if (rc != LWFS_OK) {
+			/* the cap may be from before the last rotation */
+			rc = verify_cap((const lwfs_key *)(&prev_key), cap); 
+		}
 		if (rc != LWFS_OK) {
 			log_error(authr_debug_level, "could not verify cap: %s",
 					lwfs_err_str(rc));
@@ -623,6 +756,673 @@ static int check_authorization(
 }
 
 
+/**
+ * @brief Add a service to a list of registered services. 
+ *
+ * Call with cap_caches_mutex held. Adding the same service 
+ * twice has no effect. 
+ */
+static int add_service(
+		lwfs_service **list, 
+		int *count, 
+		const lwfs_service *svc)
+{
+	int i; 
+	lwfs_service *new_list = NULL; 
+
+	/* ignore duplicate registrations */
+	for (i=0; i<*count; i++) {
+		if (((*list)[i].req_addr.match_id.nid == svc->req_addr.match_id.nid) &&
+		    ((*list)[i].req_addr.match_id.pid == svc->req_addr.match_id.pid) &&
+		    ((*list)[i].req_addr.match_bits == svc->req_addr.match_bits)) {
+			log_debug(authr_debug_level, "service already registered");
+			return LWFS_OK; 
+		}
+	}
+
+	new_list = (lwfs_service *)realloc(*list, (*count+1)*sizeof(lwfs_service));
+	if (new_list == NULL) {
+		log_error(authr_debug_level, "could not allocate service entry");
+		return LWFS_ERR_NOSPACE; 
+	}
+
+	memcpy(&new_list[*count], svc, sizeof(lwfs_service));
+	*list = new_list; 
+	(*count)++; 
+
+	log_debug(authr_debug_level, "registered service (nid=%llu, pid=%llu)",
+			(unsigned long long)svc->req_addr.match_id.nid,
+			(unsigned long long)svc->req_addr.match_id.pid);
+
+	return LWFS_OK; 
+}
+
+/**
+ * @brief Remove a service from a list of registered services. 
+ *
+ * Call with cap_caches_mutex held. 
+ *
+ * @returns TRUE if the service was in the list. 
+ */
+static lwfs_bool remove_service(
+		lwfs_service *list, 
+		int *count, 
+		const lwfs_service *svc)
+{
+	int i; 
+
+	for (i=0; i<*count; i++) {
+		if ((list[i].req_addr.match_id.nid == svc->req_addr.match_id.nid) &&
+		    (list[i].req_addr.match_id.pid == svc->req_addr.match_id.pid) &&
+		    (list[i].req_addr.match_bits == svc->req_addr.match_bits)) {
+			list[i] = list[*count-1]; 
+			(*count)--; 
+			return TRUE; 
+		}
+	}
+
+	return FALSE; 
+}
+
+/**
+ * @brief Copy a list of registered services. 
+ *
+ * We copy the list so we don't hold the lock while calling the 
+ * services.  The caller frees the result. 
+ */
+static int copy_services(
+		lwfs_service **list, 
+		int *count, 
+		lwfs_service **result, 
+		int *result_count)
+{
+	int rc = LWFS_OK; 
+
+	*result = NULL; 
+
+	pthread_mutex_lock(&cap_caches_mutex); 
+	*result_count = *count; 
+	if (*count > 0) {
+		*result = (lwfs_service *)malloc(*count*sizeof(lwfs_service));
+		if (*result != NULL) {
+			memcpy(*result, *list, *count*sizeof(lwfs_service));
+		}
+		else {
+			rc = LWFS_ERR_NOSPACE; 
+		}
+	}
+	pthread_mutex_unlock(&cap_caches_mutex); 
+
+	return rc; 
+}
+
+/**
+ * @brief Ask the rotation thread for a new key now. 
+ */
+static void request_rotation()
+{
+	pthread_mutex_lock(&rotate_mutex); 
+	rotate_now = TRUE; 
+	pthread_cond_signal(&rotate_cond); 
+	pthread_mutex_unlock(&rotate_mutex); 
+}
+
+/**
+ * @brief Remember the revoked operations of a container. 
+ *
+ * Call with cap_caches_mutex held.  Services that register after 
+ * the revocation get the list from \ref get_cap_key. 
+ *
+ * An entry only matters for caps generated with the key of 
+ * generation \em generation (or older), so \ref prune_revoked 
+ * drops it two rotations later.  If the list grows past 
+ * \ref MAX_REVOKED_CIDS, we rotate the key early instead of 
+ * waiting for key_lifetime. 
+ */
+static int record_revoked(
+		const lwfs_cid cid,
+		const lwfs_container_op container_op,
+		const unsigned int generation)
+{
+	int i; 
+	lwfs_revoked_cid *new_list = NULL; 
+
+	for (i=0; i<num_revoked_cids; i++) {
+		if (revoked_cids[i].cid == cid) {
+			revoked_cids[i].container_op |= container_op; 
+			if (generation > revoked_cids[i].generation) {
+				revoked_cids[i].generation = generation; 
+			}
+			return LWFS_OK; 
+		}
+	}
+
+	new_list = (lwfs_revoked_cid *)realloc(revoked_cids, 
+			(num_revoked_cids+1)*sizeof(lwfs_revoked_cid));
+	if (new_list == NULL) {
+		log_error(authr_debug_level, "could not allocate revoked entry");
+		return LWFS_ERR_NOSPACE; 
+	}
+
+	revoked_cids = new_list; 
+	revoked_cids[num_revoked_cids].cid = cid; 
+	revoked_cids[num_revoked_cids].container_op = container_op; 
+	revoked_cids[num_revoked_cids].generation = generation; 
+	num_revoked_cids++; 
+
+	if (num_revoked_cids >= MAX_REVOKED_CIDS) {
+		log_debug(authr_debug_level, "%d revoked containers, rotating key", 
+				num_revoked_cids);
+		request_rotation(); 
+	}
+
+	return LWFS_OK; 
+}
+
+/**
+ * @brief Drop the revocations that no valid key needs. 
+ *
+ * Call with cap_caches_mutex held.  Caps generated with a key 
+ * older than the previous key are invalid, so we no longer have 
+ * to remember what the ACLs took away from them. 
+ */
+static void prune_revoked(const unsigned int generation)
+{
+	int i; 
+	int n = 0; 
+
+	for (i=0; i<num_revoked_cids; i++) {
+		if (revoked_cids[i].generation + 2 > generation) {
+			revoked_cids[n++] = revoked_cids[i]; 
+		}
+	}
+
+	log_debug(authr_debug_level, "pruned %d revoked containers", 
+			num_revoked_cids - n);
+	num_revoked_cids = n; 
+}
+
+/**
+ * @brief Copy the revoked containers for a \ref lwfs_cap_key_info.
+ *
+ * Call with cap_caches_mutex held.  The caller frees the list 
+ * (the rpc server does it with xdr_free for results). 
+ */
+static int copy_revoked(lwfs_cap_key_info *info)
+{
+	lwfs_revoked_cid *revoked = NULL; 
+
+	if (num_revoked_cids > 0) {
+		revoked = (lwfs_revoked_cid *)malloc(num_revoked_cids*sizeof(lwfs_revoked_cid));
+		if (revoked == NULL) {
+			log_error(authr_debug_level, "could not allocate revoked list");
+			return LWFS_ERR_NOSPACE; 
+		}
+		memcpy(revoked, revoked_cids, num_revoked_cids*sizeof(lwfs_revoked_cid)); 
+	}
+	info->revoked.revoked_len = num_revoked_cids; 
+	info->revoked.revoked_val = revoked; 
+
+	return LWFS_OK; 
+}
+
+/**
+ * @brief Wait (with a timeout) for registered services to reply. 
+ *
+ * @param reqs   @input_type The requests (skips requests with an error status).
+ * @param count  @input_type The number of requests.
+ * @param what   @input_type What we sent (for the log).
+ */
+static int wait_for_services(
+		lwfs_request *reqs, 
+		const int count, 
+		const char *what)
+{
+	int rc = LWFS_OK; 
+	int rc2 = LWFS_OK; 
+	int remote_rc = LWFS_OK; 
+	int i; 
+
+	for (i=0; i<count; i++) {
+		if (reqs[i].status == LWFS_REQUEST_ERROR) {
+			continue; 
+		}
+
+		rc2 = lwfs_timedwait(&reqs[i], REVOKE_TIMEOUT, &remote_rc); 
+		if ((rc2 != LWFS_OK) || (remote_rc != LWFS_OK)) {
+			log_warn(authr_debug_level, "service %d did not acknowledge "
+					"%s: %s", i, what, 
+					lwfs_err_str((rc2 != LWFS_OK)? rc2 : remote_rc));
+			rc = (rc2 != LWFS_OK)? rc2 : remote_rc;
+		}
+	}
+
+	return rc; 
+}
+
+/**
+ * @brief Queue a revocation for one cap cache. 
+ *
+ * Call with revoke_mutex held.  A revocation for the same cache 
+ * and container that has not been sent yet absorbs the new operations. 
+ */
+static int queue_revoke(
+		const lwfs_service *svc, 
+		const lwfs_cid cid,
+		const lwfs_container_op container_op, 
+		const unsigned int generation, 
+		const double now)
+{
+	struct pending_revoke *entry = NULL; 
+
+	for (entry = revoke_queue; entry != NULL; entry = entry->next) {
+		if ((entry->cid == cid) && 
+		    (entry->attempts == 0) && 
+		    (memcmp(&entry->svc, svc, sizeof(lwfs_service)) == 0)) {
+			entry->container_op |= container_op; 
+			if (generation > entry->generation) {
+				entry->generation = generation; 
+			}
+			return LWFS_OK; 
+		}
+	}
+
+	entry = (struct pending_revoke *)calloc(1, sizeof(struct pending_revoke));
+	if (entry == NULL) {
+		log_error(authr_debug_level, "could not allocate revocation");
+		return LWFS_ERR_NOSPACE; 
+	}
+
+	memcpy(&entry->svc, svc, sizeof(lwfs_service)); 
+	entry->cid = cid; 
+	entry->container_op = container_op; 
+	entry->generation = generation; 
+	entry->next_try = now; 
+	entry->give_up = now + LWFS_REVOKE_RETRY_WINDOW; 
+	entry->next = revoke_queue; 
+	revoke_queue = entry; 
+
+	return LWFS_OK; 
+}
+
+/**
+ * @brief Revoke cached caps on every registered cap cache. 
+ *
+ * We call this function after changing the ACLs of a container
+ * so that services caching verified caps (see \ref register_cap_cache)
+ * or verifying caps locally (see \ref get_cap_key) stop honoring caps 
+ * the ACLs no longer allow.  We only queue the revocations here; the 
+ * revoke thread sends them in parallel and resends the ones a cache 
+ * does not acknowledge (see \ref revoke_caps_thread), so a slow or 
+ * dead cache never holds up the handler thread that changed the ACL. 
+ *
+ * @param cid    @input_type The container ID.
+ * @param container_op @input_type The operations to revoke.
+ */
+static int revoke_cached_caps(
+		const lwfs_cid cid,
+		const lwfs_container_op container_op)
+{
+	int rc = LWFS_OK; 
+	int i; 
+	int count = 0; 
+	unsigned int generation = 0; 
+	double now = lwfs_get_time(); 
+	lwfs_service *caches = NULL; 
+
+	copy_keys(NULL, NULL, &generation); 
+
+	/* services that get the key later have to know about this revocation */
+	if (share_key) {
+		pthread_mutex_lock(&cap_caches_mutex); 
+		rc = record_revoked(cid, container_op, generation); 
+		pthread_mutex_unlock(&cap_caches_mutex); 
+		if (rc != LWFS_OK) {
+			return rc; 
+		}
+	}
+
+	rc = copy_services(&cap_caches, &num_cap_caches, &caches, &count); 
+	if (rc != LWFS_OK) {
+		log_error(authr_debug_level, "could not copy cap caches");
+		goto cleanup; 
+	}
+
+	if (count == 0) {
+		return rc; 
+	}
+
+	authr_counter.revoke++; 
+
+	log_debug(authr_debug_level, "queueing revocation of cid=%llu for %d caches", 
+			(unsigned long long)cid, count);
+
+	pthread_mutex_lock(&revoke_mutex); 
+	for (i=0; i<count; i++) {
+		rc = queue_revoke(&caches[i], cid, container_op, generation, now); 
+		if (rc != LWFS_OK) {
+			break; 
+		}
+	}
+	pthread_cond_signal(&revoke_cond); 
+	pthread_mutex_unlock(&revoke_mutex); 
+
+cleanup:
+	if (caches) free(caches); 
+
+	return rc; 
+}
+
+/**
+ * @brief Stop sending revocations to a service that does not answer. 
+ *
+ * A cap cache forgets caps after its TTL, which is shorter than 
+ * \ref LWFS_REVOKE_RETRY_WINDOW (see cap_cache_init), so dropping the 
+ * revocation is enough.  A key holder keeps verifying caps with 
+ * our key and never learns that the ACLs changed, so we also 
+ * deregister it and rotate the key.  Caps generated with the new 
+ * key do not match the holder's key, so it sends them to us and, 
+ * once we accept one, fetches the key and the revoked containers 
+ * again (see cap_verifier_confirm). 
+ */
+static void give_up_revoke(
+		const struct pending_revoke *entry, 
+		const int rc)
+{
+	lwfs_bool holder = FALSE; 
+
+	pthread_mutex_lock(&cap_caches_mutex); 
+	holder = remove_service(key_holders, &num_key_holders, &entry->svc); 
+	if (holder) {
+		remove_service(cap_caches, &num_cap_caches, &entry->svc); 
+	}
+	pthread_mutex_unlock(&cap_caches_mutex); 
+
+	log_error(authr_debug_level, "%s (nid=%llu, pid=%llu) never "
+			"acknowledged revocation of cid=%llu: %s%s", 
+			(holder)? "key holder" : "cache", 
+			(unsigned long long)entry->svc.req_addr.match_id.nid,
+			(unsigned long long)entry->svc.req_addr.match_id.pid,
+			(unsigned long long)entry->cid, lwfs_err_str(rc), 
+			(holder)? ", deregistering it and rotating the key" : "");
+
+	if (holder) {
+		request_rotation(); 
+	}
+}
+
+/**
+ * @brief Send the due revocations and collect the acknowledgements. 
+ *
+ * The revocations go out in parallel before we wait for any of them.  
+ * A revocation that fails or times out goes back on the queue with 
+ * an exponential backoff until \ref LWFS_REVOKE_RETRY_WINDOW seconds 
+ * have passed.  Then \ref give_up_revoke decides what the service 
+ * missed. 
+ *
+ * @param due  @input_type The revocations to send (taken off the queue).
+ * @param retry @output_type The revocations to queue again. 
+ */
+static void send_revocations(
+		struct pending_revoke *due, 
+		struct pending_revoke **retry)
+{
+	int rc = LWFS_OK; 
+	int remote_rc = LWFS_OK; 
+	double backoff; 
+	struct pending_revoke *entry = NULL; 
+	struct pending_revoke *next = NULL; 
+
+	*retry = NULL; 
+
+	/* send the revocations */
+	for (entry = due; entry != NULL; entry = entry->next) {
+		entry->attempts++; 
+		rc = lwfs_revoke_caps(&entry->svc, entry->cid, 
+				entry->container_op, entry->generation, &entry->req);
+		if (rc != LWFS_OK) {
+			log_warn(authr_debug_level, "could not send revocation "
+					"of cid=%llu: %s", (unsigned long long)entry->cid, 
+					lwfs_err_str(rc));
+			entry->req.status = LWFS_REQUEST_ERROR; 
+		}
+	}
+
+	/* wait for the acknowledgements */
+	for (entry = due; entry != NULL; entry = next) {
+		next = entry->next; 
+
+		rc = LWFS_ERR_RPC; 
+		remote_rc = LWFS_OK; 
+		if (entry->req.status != LWFS_REQUEST_ERROR) {
+			rc = lwfs_timedwait(&entry->req, REVOKE_TIMEOUT, &remote_rc); 
+		}
+		if ((rc == LWFS_OK) && (remote_rc == LWFS_OK)) {
+			free(entry); 
+			continue; 
+		}
+
+		rc = (rc != LWFS_OK)? rc : remote_rc; 
+		if (lwfs_get_time() > entry->give_up) {
+			give_up_revoke(entry, rc); 
+			free(entry); 
+			continue; 
+		}
+
+		backoff = REVOKE_MIN_BACKOFF * pow(2.0, entry->attempts - 1); 
+		if (backoff > REVOKE_MAX_BACKOFF) {
+			backoff = REVOKE_MAX_BACKOFF; 
+		}
+		log_warn(authr_debug_level, "retrying revocation of cid=%llu "
+				"in %g sec (attempt %d): %s", (unsigned long long)entry->cid, 
+				backoff, entry->attempts, lwfs_err_str(rc));
+
+		memset(&entry->req, 0, sizeof(lwfs_request)); 
+		entry->next_try = lwfs_get_time() + backoff; 
+		entry->next = *retry; 
+		*retry = entry; 
+	}
+}
+
+/**
+ * @brief Thread that sends queued revocations to the cap caches. 
+ */
+static void *revoke_caps_thread(void *arg)
+{
+	double now; 
+	double wake; 
+	struct timespec abstime; 
+	struct pending_revoke *due = NULL; 
+	struct pending_revoke *retry = NULL; 
+	struct pending_revoke **link = NULL; 
+	struct pending_revoke *entry = NULL; 
+
+	pthread_mutex_lock(&revoke_mutex); 
+	while (!revoke_done) {
+
+		/* take the revocations that are due off the queue */
+		now = lwfs_get_time(); 
+		wake = now + LWFS_REVOKE_RETRY_WINDOW; 
+		due = NULL; 
+		link = &revoke_queue; 
+		while (*link != NULL) {
+			entry = *link; 
+			if (entry->next_try <= now) {
+				*link = entry->next; 
+				entry->next = due; 
+				due = entry; 
+			}
+			else {
+				if (entry->next_try < wake) {
+					wake = entry->next_try; 
+				}
+				link = &entry->next; 
+			}
+		}
+
+		if (due == NULL) {
+			/* wait for a new revocation or for the next retry */
+			abstime.tv_sec = (time_t)wake; 
+			abstime.tv_nsec = (long)((wake - (double)abstime.tv_sec) * 1.0e9); 
+			pthread_cond_timedwait(&revoke_cond, &revoke_mutex, &abstime); 
+			continue; 
+		}
+
+		pthread_mutex_unlock(&revoke_mutex); 
+		send_revocations(due, &retry); 
+		pthread_mutex_lock(&revoke_mutex); 
+
+		/* put the failures back on the queue */
+		while (retry != NULL) {
+			entry = retry; 
+			retry = entry->next; 
+			entry->next = revoke_queue; 
+			revoke_queue = entry; 
+		}
+	}
+
+	/* drop what is left, the caches let the caps expire */
+	while (revoke_queue != NULL) {
+		entry = revoke_queue; 
+		revoke_queue = entry->next; 
+		free(entry); 
+	}
+	pthread_mutex_unlock(&revoke_mutex); 
+
+	return NULL; 
+}
+
+/**
+ * @brief Replace the key used to generate caps. 
+ *
+ * Caps generated with the previous key remain valid until the 
+ * next rotation.  If key sharing is enabled, we send the new 
+ * key to every service registered with \ref get_cap_key. 
+ */
+static int rotate_key()
+{
+	int rc = LWFS_OK; 
+	int rc2 = LWFS_OK; 
+	int i; 
+	int count = 0; 
+	lwfs_key new_key; 
+	lwfs_cap_key_info info; 
+	lwfs_service *holders = NULL; 
+	lwfs_request *reqs = NULL; 
+
+	rc = generate_cap_key(&new_key); 
+	if (rc != LWFS_OK) {
+		log_error(authr_debug_level, "could not generate key");
+		return rc; 
+	}
+
+	pthread_mutex_lock(&key_mutex); 
+	memcpy(authr_prev_key, authr_svc_key, sizeof(lwfs_key)); 
+	memcpy(authr_svc_key, new_key, sizeof(lwfs_key)); 
+	key_generation++; 
+	pthread_mutex_unlock(&key_mutex); 
+
+	authr_counter.rotate++; 
+
+	log_debug(authr_debug_level, "rotated cap key");
+
+	if (!share_key) {
+		return rc; 
+	}
+
+	memset(&info, 0, sizeof(lwfs_cap_key_info)); 
+	copy_keys(&info.key, &info.prev_key, &info.generation); 
+
+	/* the new key makes the oldest revocations unnecessary */
+	pthread_mutex_lock(&cap_caches_mutex); 
+	prune_revoked(info.generation); 
+	rc = copy_revoked(&info); 
+	pthread_mutex_unlock(&cap_caches_mutex); 
+	if (rc != LWFS_OK) {
+		goto cleanup; 
+	}
+
+	rc = copy_services(&key_holders, &num_key_holders, &holders, &count); 
+	if ((rc != LWFS_OK) || (count == 0)) {
+		goto cleanup; 
+	}
+
+	reqs = (lwfs_request *)calloc(count, sizeof(lwfs_request));
+	if (reqs == NULL) {
+		log_error(authr_debug_level, "could not allocate key requests");
+		rc = LWFS_ERR_NOSPACE;
+		goto cleanup; 
+	}
+
+	/* send the new key */
+	for (i=0; i<count; i++) {
+		rc2 = lwfs_set_cap_key(&holders[i], &info, &reqs[i]);
+		if (rc2 != LWFS_OK) {
+			log_error(authr_debug_level, "could not send key to service %d: %s",
+					i, lwfs_err_str(rc2));
+			rc = rc2; 
+			reqs[i].status = LWFS_REQUEST_ERROR; 
+		}
+	}
+
+	/* services that miss the key send their caps to us */
+	rc2 = wait_for_services(reqs, count, "new key"); 
+	if (rc2 != LWFS_OK) {
+		rc = rc2; 
+	}
+
+cleanup:
+	if (info.revoked.revoked_val) free(info.revoked.revoked_val); 
+	memset(&info, 0, sizeof(lwfs_cap_key_info)); 
+	memset(new_key, 0, sizeof(lwfs_key)); 
+	if (holders) free(holders); 
+	if (reqs) free(reqs); 
+
+	return rc; 
+}
+
+/**
+ * @brief Thread that rotates the key. 
+ *
+ * The key changes every key_lifetime seconds (if key_lifetime > 0) 
+ * and whenever \ref record_revoked asks for it because the list 
+ * of revoked containers is full. 
+ */
+static void *rotate_key_thread(void *arg)
+{
+	int rc = 0; 
+	struct timespec abstime; 
+
+	pthread_mutex_lock(&rotate_mutex); 
+	while (!rotate_done) {
+		abstime.tv_sec = time(NULL) + key_lifetime; 
+		abstime.tv_nsec = 0; 
+
+		/* wait for the deadline, a request, or the server to shut down */
+		rc = 0; 
+		while ((!rotate_done) && (!rotate_now) && (rc != ETIMEDOUT)) {
+			if (key_lifetime > 0) {
+				rc = pthread_cond_timedwait(&rotate_cond, &rotate_mutex, &abstime); 
+			}
+			else {
+				pthread_cond_wait(&rotate_cond, &rotate_mutex); 
+			}
+		}
+		if (rotate_done) {
+			break; 
+		}
+		rotate_now = FALSE; 
+
+		pthread_mutex_unlock(&rotate_mutex); 
+		rotate_key(); 
+		pthread_mutex_lock(&rotate_mutex); 
+	}
+	pthread_mutex_unlock(&rotate_mutex); 
+
+	return NULL; 
+}
+
+
 /* -------- Methods used by the server -------------- */
 
 int lwfs_authr_srvr_init(
@@ -630,6 +1430,10 @@ int lwfs_authr_srvr_init(
 		const char *db_path,
 		const lwfs_bool db_clear,
 		const lwfs_bool db_recover,
+		const lwfs_bool share, 
+		const int lifetime, 
+		const lwfs_remote_pid *holder_ids, 
+		const int num_holder_ids, 
 		lwfs_service *svc) 
 {
 	int rc = LWFS_OK; 
@@ -637,6 +1441,23 @@ int lwfs_authr_srvr_init(
 	acl_db_enabled = verify_caps; 
 	caps_enabled = verify_caps;
 	creds_enabled = FALSE;
+	share_key = share; 
+	key_lifetime = lifetime; 
+
+	/* only these servers may fetch the key */
+	if (num_holder_ids > 0) {
+		trusted_ids = (lwfs_remote_pid *)malloc(num_holder_ids*sizeof(lwfs_remote_pid));
+		if (trusted_ids == NULL) {
+			log_error(authr_debug_level, "could not allocate key holder ids");
+			return LWFS_ERR_NOSPACE; 
+		}
+		memcpy(trusted_ids, holder_ids, num_holder_ids*sizeof(lwfs_remote_pid)); 
+	}
+	num_trusted_ids = num_holder_ids; 
+
+	if (share_key && (num_trusted_ids == 0)) {
+		log_warn(authr_debug_level, "sharing the key, but no servers may fetch it");
+	}
 
 	/* initialize the counters */
 	memset(&authr_counter, 0, sizeof(struct authr_counter));
@@ -668,8 +1489,9 @@ int lwfs_authr_srvr_init(
 		return rc; 
 	}
 
-	/* add the 7 authorization operations to the list of supported ops */
-	rc = lwfs_service_add_ops(svc, lwfs_authr_op_array(), 7);
+	/* add the authorization operations to the list of supported ops */
+	rc = lwfs_service_add_ops(svc, lwfs_authr_op_array(), 
+			lwfs_svc_op_count(lwfs_authr_op_array()));
 	if (rc != LWFS_OK) {
 		log_error(authr_debug_level, "could not add authorization ops");
 		return rc; 
@@ -683,6 +1505,24 @@ int lwfs_authr_srvr_init(
 		log_error(authr_debug_level, "could not generate key");
 		return rc; 
 	}
+	memcpy(authr_prev_key, authr_svc_key, sizeof(lwfs_key)); 
+
+	/* start the thread that sends revocations to the cap caches */
+	revoke_done = FALSE; 
+	if (pthread_create(&revoke_thread, NULL, revoke_caps_thread, NULL) != 0) {
+		log_error(authr_debug_level, "could not start revocation thread");
+		return LWFS_ERR; 
+	}
+
+	/* start the thread that rotates the key */
+	if (share_key || (key_lifetime > 0)) {
+		rotate_done = FALSE; 
+		rotate_now = FALSE; 
+		if (pthread_create(&rotate_thread, NULL, rotate_key_thread, NULL) != 0) {
+			log_error(authr_debug_level, "could not start key rotation thread");
+			return LWFS_ERR; 
+		}
+	}
 
 	/* initialize the auth svc database */
 	if (acl_db_enabled) {
@@ -702,6 +1542,26 @@ int lwfs_authr_srvr_fini(const lwfs_service *svc)
 {
 	int rc = LWFS_OK; 
 
+	/* stop rotating the key */
+	if (share_key || (key_lifetime > 0)) {
+		pthread_mutex_lock(&rotate_mutex); 
+		rotate_done = TRUE; 
+		pthread_cond_signal(&rotate_cond); 
+		pthread_mutex_unlock(&rotate_mutex); 
+		pthread_join(rotate_thread, NULL); 
+	}
+
+	/* stop sending revocations */
+	pthread_mutex_lock(&revoke_mutex); 
+	revoke_done = TRUE; 
+	pthread_cond_signal(&revoke_cond); 
+	pthread_mutex_unlock(&revoke_mutex); 
+	pthread_join(revoke_thread, NULL); 
+
+	if (trusted_ids) free(trusted_ids); 
+	trusted_ids = NULL; 
+	num_trusted_ids = 0; 
+
 	/* close the database */
 	rc = authr_db_fini(); 
 	if (rc != LWFS_OK) {
@@ -736,6 +1596,9 @@ int lwfs_authr_srvr_fini(const lwfs_service *svc)
 	fprintf(logger_get_file(), "\tmod_acl = %ld\n",authr_counter.modacl);
 	fprintf(logger_get_file(), "\tget_cap = %ld\n",authr_counter.getcap);
 	fprintf(logger_get_file(), "\tverify = %ld\n",authr_counter.verify);
+	fprintf(logger_get_file(), "\trevoke = %ld\n",authr_counter.revoke);
+	fprintf(logger_get_file(), "\tget_cap_key = %ld\n",authr_counter.getkey);
+	fprintf(logger_get_file(), "\trotate_key = %ld\n",authr_counter.rotate);
 	fprintf(logger_get_file(), "---------------------------\n");
 
 
@@ -885,9 +1748,8 @@ int create_container(
 		}
 	}
 
-	/* call the security library to generate the capability */
-	rc = generate_cap((const lwfs_key *)&authr_svc_key, 
-			&cap_data, result);
+	/* generate the capability */
+	rc = new_cap(&cap_data, result);
 	if (rc != LWFS_OK) {
 		log_error(authr_debug_level, "unable to generate cap: %s",
 				lwfs_err_str(rc));
@@ -980,6 +1842,15 @@ int remove_container(
 	
 	/* remove the remaining remnants of the container */
 	rc = authr_db_remove_container(cid);
+	if (rc != LWFS_OK) {
+		goto cleanup; 
+	}
+
+	/* no cap for this container is valid anymore */
+	if (revoke_cached_caps(cid, (lwfs_container_op)~0) != LWFS_OK) {
+		log_warn(authr_debug_level, "could not revoke cached caps for cid=%llu",
+				(long long unsigned int)cid);
+	}
 
 cleanup:
 	snprintf(newdata, maxlen, "remove cid %llu",(long long unsigned int)cid); 
@@ -1059,6 +1930,14 @@ cleanup:
  * To resolve conflicts that occur when a user ID appears in both
  * lists, the implementation first grants access to the users 
  * in the set list, then removes access from users in the unset list. 
+ *
+ * Removing users does not wait for the services that cache caps 
+ * or verify them with our key.  The revocations go out in the 
+ * background (see \ref revoke_caps_thread), so a service may 
+ * accept an old cap for a short time after this call returns.  A 
+ * cap cache keeps a cap at most \ref LWFS_MAX_CAP_CACHE_TTL seconds; 
+ * a key holder that does not acknowledge the revocation within 
+ * \ref LWFS_REVOKE_RETRY_WINDOW seconds has to fetch the key again. 
  *
 	 * @param caller @input_type the client's PID
 	 * @param args @input_type arguments needed to modify the ACL
@@ -1200,6 +2079,16 @@ int mod_acl(
 	    /* shift the bit one space to the left */
 	    testop = testop << 1; 
 	}
+
+	/* Caps for removed uids are no longer valid. Adding uids does 
+	 * not invalidate anything, so we only revoke if there is an 
+	 * unset list. */
+	if ((unset != NULL) && (unset->lwfs_uid_array_len > 0)) {
+	    if (revoke_cached_caps(cid, container_op) != LWFS_OK) {
+		log_warn(authr_debug_level, "could not revoke cached caps for cid=%llu",
+			(long long unsigned int)cid);
+	    }
+	}
     }
 
 cleanup:
@@ -1288,8 +2177,7 @@ int get_cap(
 	cap_data.container_op = container_op; 
 
 	/* create the cap */
-	rc = generate_cap((const lwfs_key *)(&authr_svc_key), 
-			&cap_data, result); 
+	rc = new_cap(&cap_data, result); 
 	if (rc != LWFS_OK) {
 		log_error(authr_debug_level, "unable to generate caps: %s",
 				lwfs_err_str(rc));
@@ -1387,8 +2275,10 @@ int verify_caps(
 	    }
 
 
-	    /* TODO: we need to register the calling process for revocation */
-
+	    /* We do not register individual callers for revocation. 
+	     * Servers that cache verified caps register once with 
+	     * register_cap_cache() and receive revocations for every
+	     * container whose ACLs change. */
 
 	}
 
@@ -1399,3 +2289,139 @@ cleanup:
 
 	return rc; 
 }
+
+
+/**
+ *  @brief Register a service that caches verified capabilities. 
+ *
+ *  After registration, the authorization server sends a 
+ *  \ref LWFS_OP_REVOKE_CAPS request to the service whenever the 
+ *  ACLs of a container change (see \ref mod_acl and 
+ *  \ref remove_container).  Registering the same service twice 
+ *  has no effect. 
+ * 
+ * @param caller @input_type the client's PID
+ * @param args @input_type the service to register
+ * @param data_addr @input_type address at which the bulk data can be found
+ * @param result @output_type no result
+ */
+int register_cap_cache(
+		const lwfs_remote_pid *caller, 
+		const lwfs_register_cap_cache_args *args, 
+		const lwfs_rma *data_addr,
+		void *result)
+{
+	int rc = LWFS_OK; 
+
+	pthread_mutex_lock(&cap_caches_mutex); 
+	rc = add_service(&cap_caches, &num_cap_caches, args->svc); 
+	pthread_mutex_unlock(&cap_caches_mutex); 
+
+	return rc; 
+}
+
+
+/**
+ * @brief Is the caller a server that may have the cap key? 
+ *
+ * The caller has to be one of the trusted servers and the service 
+ * it registers has to be its own (otherwise a trusted server could 
+ * be made to register somebody else's service). 
+ */
+static lwfs_bool is_trusted(
+		const lwfs_remote_pid *caller, 
+		const lwfs_service *svc)
+{
+	int i; 
+
+	if ((caller->nid != svc->req_addr.match_id.nid) ||
+	    (caller->pid != svc->req_addr.match_id.pid)) {
+		return FALSE; 
+	}
+
+	for (i=0; i<num_trusted_ids; i++) {
+		if ((caller->nid == trusted_ids[i].nid) && 
+		    (caller->pid == trusted_ids[i].pid)) {
+			return TRUE; 
+		}
+	}
+
+	return FALSE; 
+}
+
+
+/**
+ *  @brief Give the cap key to a service that verifies caps locally. 
+ *
+ *  Storage and naming servers call this method at startup so they 
+ *  can check the MAC of a cap without calling \ref verify_caps.  
+ *  The service is registered to receive revocations (like 
+ *  \ref register_cap_cache) and new keys after a rotation.  The 
+ *  result also lists the containers that lost operations since the 
+ *  server started; the service sends caps for those containers to 
+ *  us because only the ACL database can tell if they are still valid. 
+ * 
+ * @param caller @input_type the client's PID
+ * @param args @input_type the service to register
+ * @param data_addr @input_type address at which the bulk data can be found
+ * @param result @output_type the key information
+ *
+ * Anyone with the key can forge caps, so we only give it to the 
+ * servers listed at startup (\ref lwfs_authr_srvr_init), and only 
+ * if the caller is the service it registers. 
+ *
+ * @returns \ref LWFS_ERR_ACCESS if key sharing or cap verification is 
+ *          disabled, or if the caller is not a trusted server. 
+ */
+int get_cap_key(
+		const lwfs_remote_pid *caller, 
+		const lwfs_get_cap_key_args *args, 
+		const lwfs_rma *data_addr,
+		lwfs_cap_key_info *result)
+{
+	int rc = LWFS_OK; 
+
+	memset(result, 0, sizeof(lwfs_cap_key_info)); 
+
+	if ((!share_key) || (!caps_enabled)) {
+		log_warn(authr_debug_level, "key sharing is disabled");
+		return LWFS_ERR_ACCESS; 
+	}
+
+	if (!is_trusted(caller, args->svc)) {
+		log_warn(authr_debug_level, "rejecting key request from "
+				"(nid=%llu, pid=%llu)", 
+				(unsigned long long)caller->nid, 
+				(unsigned long long)caller->pid);
+		return LWFS_ERR_ACCESS; 
+	}
+
+	authr_counter.getkey++; 
+
+	pthread_mutex_lock(&cap_caches_mutex); 
+
+	rc = add_service(&cap_caches, &num_cap_caches, args->svc); 
+	if (rc != LWFS_OK) {
+		goto unlock; 
+	}
+
+	rc = add_service(&key_holders, &num_key_holders, args->svc); 
+	if (rc != LWFS_OK) {
+		goto unlock; 
+	}
+
+	/* the rpc server frees the result (with xdr_free) */
+	rc = copy_revoked(result); 
+	if (rc != LWFS_OK) {
+		goto unlock; 
+	}
+
+	/* copy the keys while we hold the lock so a rotation either 
+	 * happens before this or sends us the new key */
+	copy_keys(&result->key, &result->prev_key, &result->generation); 
+
+unlock:
+	pthread_mutex_unlock(&cap_caches_mutex); 
+
+	return rc; 
+}
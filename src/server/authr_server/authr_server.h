@@ -21,6 +21,16 @@
 #ifndef _LWFS_AUTH_SRVR_H_
 #define _LWFS_AUTH_SRVR_H_
 
+/** @brief Seconds the authr server keeps resending a revocation to a cap cache. */
+#define LWFS_REVOKE_RETRY_WINDOW 120
+
+/** @brief Longest time (in seconds) a cap cache may keep a verified cap. 
+ *
+ *  A cache that misses a revocation must forget the cap before 
+ *  the authr server stops resending it. 
+ */
+#define LWFS_MAX_CAP_CACHE_TTL (LWFS_REVOKE_RETRY_WINDOW/2)
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -37,6 +47,10 @@ extern "C" {
 			const char *db_path,
 			const lwfs_bool db_clear,
 			const lwfs_bool db_recover,
+			const lwfs_bool share_key,
+			const int key_lifetime,
+			const lwfs_remote_pid *key_holders, 
+			const int num_key_holders, 
 			lwfs_service *svc); 
 
 	/** 
@@ -179,6 +193,40 @@ extern "C" {
 			const lwfs_rma *data_addr,
 			void *result);
 
+	/**
+	 *  @brief Register a service that caches verified capabilities. 
+	 *
+	 *  The authorization server sends revocations to every 
+	 *  registered service when the ACLs of a container change. 
+	 * 
+	 * @param caller @input_type the client's PID
+	 * @param args @input_type the service to register
+	 * @param data_addr @input_type address at which the bulk data can be found
+	 * @param result @output_type no result
+	 */
+	extern int register_cap_cache(
+			const lwfs_remote_pid *caller,
+			const lwfs_register_cap_cache_args *args, 
+			const lwfs_rma *data_addr,
+			void *result);
+
+	/**
+	 *  @brief Give the cap key to a service that verifies caps locally. 
+	 *
+	 *  The service is also registered to receive revocations and 
+	 *  new keys.
+	 * 
+	 * @param caller @input_type the client's PID
+	 * @param args @input_type the service to register
+	 * @param data_addr @input_type address at which the bulk data can be found
+	 * @param result @output_type the key information
+	 */
+	extern int get_cap_key(
+			const lwfs_remote_pid *caller,
+			const lwfs_get_cap_key_args *args, 
+			const lwfs_rma *data_addr,
+			lwfs_cap_key_info *result);
+
 
 #else /* K&R C */
 
@@ -0,0 +1,580 @@
+/**
+ *   @file cap_verifier.c
+ *
+ *   @brief Verify capabilities without calling the authr server.
+ *
+ *   A capability is valid if (1) the authorization server generated
+ *   it, and (2) the ACLs of the container still allow the operations
+ *   in the cap.  The first check is an HMAC over the cap data
+ *   (see \ref verify_cap), so a service that knows the key of the
+ *   authorization server can do it locally.  The second check
+ *   requires the ACL database, but it only fails for caps generated
+ *   before a uid was removed from an ACL.
+ *
+ *   Services call \ref cap_verifier_init at startup to fetch the key
+ *   (and the list of containers that already lost ACL entries) from
+ *   the authorization server.  The authorization server then sends
+ *   every revocation (\ref cap_verifier_revoke) and every new key
+ *   (\ref cap_verifier_set_key) to the service.  \ref cap_verifier_check
+ *   accepts a cap if the MAC matches and no operation of the cap was
+ *   revoked for its container.  Otherwise, it returns \ref LWFS_ERR_NOENT
+ *   and the caller has to ask the authorization server.
+ *
+ *   Every revocation carries the key generation of the authorization
+ *   server.  Caps generated with keys older than the previous key are
+ *   invalid anyway, so \ref cap_verifier_set_key drops the revocations
+ *   that are older than that (the authorization server prunes its list
+ *   the same way).  Only the authorization server may send keys and
+ *   revocations (see \ref cap_verifier_check_sender).
+ *
+ *   If the service does not acknowledge a revocation, the authorization
+ *   server stops sending it keys and rotates its key.  The first cap
+ *   with the new key fails the local check, and when the authorization
+ *   server accepts it, \ref cap_verifier_confirm fetches the key and
+ *   the revoked containers again (which registers the service again).
+ *
+ *   @author Ron Oldfield (raoldfi\@sandia.gov)
+ */
+#include "config.h"
+
+#include <pthread.h>
+
+#if STDC_HEADERS
+#include <string.h>
+#include <stdlib.h>
+#endif
+
+#include "common/types/types.h"
+#include "common/authr_common/authr_debug.h"
+#include "client/authr_client/authr_client_sync.h"
+#include "support/hashtable/hashtable.h"
+#include "support/hashtable/hashtable_itr.h"
+#include "support/hashtable/hash_funcs.h"
+#include "support/logger/logger.h"
+
+#include "cap.h"
+#include "cap_verifier.h"
+
+
+/**
+ * @brief An entry in the table of revoked containers.
+ */
+struct revoked_entry {
+	lwfs_container_op container_op;
+	unsigned int generation;
+};
+
+static struct hashtable revoked_ht;
+
+static pthread_mutex_t verifier_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static lwfs_bool table_ready = FALSE;
+static volatile lwfs_bool enabled = FALSE;
+static unsigned int generation = 0;
+static lwfs_key key;
+static lwfs_key prev_key;
+
+/* the services we passed to lwfs_get_cap_key_sync */
+static lwfs_service authr;
+static lwfs_service self;
+static lwfs_bool refetching = FALSE;
+
+static struct cap_verifier_stats stats;
+
+
+/* make the hashtable functions a little more type-safe */
+static DEFINE_HASHTABLE_INSERT(insert_entry, lwfs_cid, struct revoked_entry);
+static DEFINE_HASHTABLE_SEARCH(search_entry, lwfs_cid, struct revoked_entry);
+
+static unsigned int hashfromkey(void *k)
+{
+	return RSHash(k, sizeof(lwfs_cid));
+}
+
+static int equalkeys(void *k1, void *k2)
+{
+	return (*(lwfs_cid *)k1 == *(lwfs_cid *)k2);
+}
+
+
+/* ---- Private methods (call with verifier_mutex held) ---- */
+
+/* caps generated with keys before generation-1 are invalid */
+static lwfs_bool expired(const unsigned int gen)
+{
+	return (gen + 2 <= generation);
+}
+
+static int add_revoked(
+		const lwfs_cid cid,
+		const lwfs_container_op container_op,
+		const unsigned int gen)
+{
+	struct revoked_entry *entry = NULL;
+	lwfs_cid *k = NULL;
+
+	/* a late revocation for caps that are invalid anyway */
+	if (expired(gen)) {
+		return LWFS_OK;
+	}
+
+	entry = search_entry(&revoked_ht, (lwfs_cid *)&cid);
+	if (entry != NULL) {
+		entry->container_op |= container_op;
+		if (gen > entry->generation) {
+			entry->generation = gen;
+		}
+		return LWFS_OK;
+	}
+
+	entry = (struct revoked_entry *)malloc(sizeof(struct revoked_entry));
+	k = (lwfs_cid *)malloc(sizeof(lwfs_cid));
+	if ((entry == NULL) || (k == NULL)) {
+		log_error(authr_debug_level, "could not allocate revoked entry");
+		goto error;
+	}
+
+	entry->container_op = container_op;
+	entry->generation = gen;
+	*k = cid;
+
+	/* the hashtable owns the key and the entry */
+	if (!insert_entry(&revoked_ht, k, entry)) {
+		log_error(authr_debug_level, "could not insert revoked entry");
+		goto error;
+	}
+
+	return LWFS_OK;
+
+error:
+	if (entry) free(entry);
+	if (k) free(k);
+	return LWFS_ERR_NOSPACE;
+}
+
+static int add_revoked_list(
+		const lwfs_cap_key_info *info)
+{
+	int rc = LWFS_OK;
+	int i;
+
+	for (i=0; i<(int)info->revoked.revoked_len; i++) {
+		rc = add_revoked(info->revoked.revoked_val[i].cid,
+				info->revoked.revoked_val[i].container_op,
+				info->revoked.revoked_val[i].generation);
+		if (rc != LWFS_OK) {
+			break;
+		}
+	}
+
+	return rc;
+}
+
+/* drop the revocations of caps that no key accepts anymore */
+static void prune_revoked()
+{
+	int more;
+	struct hashtable_itr *itr = NULL;
+	struct revoked_entry *entry = NULL;
+
+	if (hashtable_count(&revoked_ht) == 0) {
+		return;
+	}
+
+	itr = hashtable_iterator(&revoked_ht);
+	if (itr == NULL) {
+		return;
+	}
+
+	more = 1;
+	while (more) {
+		entry = (struct revoked_entry *)hashtable_iterator_value(itr);
+		if (expired(entry->generation)) {
+			free(entry);
+			more = hashtable_iterator_remove(itr);
+		}
+		else {
+			more = hashtable_iterator_advance(itr);
+		}
+	}
+	free(itr);
+}
+
+static void copy_key_info(
+		const lwfs_cap_key_info *info)
+{
+	generation = info->generation;
+	memcpy(key, info->key, sizeof(lwfs_key));
+	memcpy(prev_key, info->prev_key, sizeof(lwfs_key));
+}
+
+
+/* ---- Public methods ---- */
+
+/**
+ * @brief Fetch the key from the authr server.
+ *
+ * If the authorization server does not share its key, the
+ * verifier stays disabled and the caller should keep sending
+ * caps to the authorization server.
+ *
+ * @param authr_svc  @input The authorization service.
+ * @param svc        @input The service that verifies caps (it must
+ *                          handle \ref LWFS_OP_REVOKE_CAPS and
+ *                          \ref LWFS_OP_SET_CAP_KEY requests).
+ */
+int cap_verifier_init(
+		const lwfs_service *authr_svc,
+		const lwfs_service *svc)
+{
+	int rc = LWFS_OK;
+	lwfs_cap_key_info info;
+
+	memset(&stats, 0, sizeof(struct cap_verifier_stats));
+	memset(&info, 0, sizeof(lwfs_cap_key_info));
+	memcpy(&authr, authr_svc, sizeof(lwfs_service));
+	memcpy(&self, svc, sizeof(lwfs_service));
+
+	/* The authr server may send revocations as soon as it
+	 * registers us, so the table has to exist before we ask
+	 * for the key. */
+	pthread_mutex_lock(&verifier_mutex);
+	enabled = FALSE;
+	generation = 0;
+	table_ready = create_hashtable(64, hashfromkey, equalkeys, &revoked_ht);
+	pthread_mutex_unlock(&verifier_mutex);
+
+	if (!table_ready) {
+		log_error(authr_debug_level, "could not create revoked table");
+		return LWFS_ERR_NOSPACE;
+	}
+
+	rc = lwfs_get_cap_key_sync(authr_svc, svc, &info);
+	if (rc != LWFS_OK) {
+		log_warn(authr_debug_level, "could not get cap key: %s",
+				lwfs_err_str(rc));
+		cap_verifier_fini();
+		return rc;
+	}
+
+	pthread_mutex_lock(&verifier_mutex);
+	/* don't overwrite a key from a rotation that raced with the reply */
+	if (info.generation >= generation) {
+		copy_key_info(&info);
+	}
+	rc = add_revoked_list(&info);
+	enabled = (rc == LWFS_OK);
+	pthread_mutex_unlock(&verifier_mutex);
+
+	xdr_free((xdrproc_t)&xdr_lwfs_cap_key_info, (char *)&info);
+
+	if (rc != LWFS_OK) {
+		cap_verifier_fini();
+		return rc;
+	}
+
+	log_debug(authr_debug_level, "verifying caps locally (%d revoked containers)",
+			hashtable_count(&revoked_ht));
+
+	return rc;
+}
+
+/**
+ * @brief Release the resources used by the verifier.
+ */
+int cap_verifier_fini()
+{
+	pthread_mutex_lock(&verifier_mutex);
+
+	enabled = FALSE;
+	if (table_ready) {
+		table_ready = FALSE;
+		hashtable_destroy(&revoked_ht, free);
+	}
+
+	memset(key, 0, sizeof(lwfs_key));
+	memset(prev_key, 0, sizeof(lwfs_key));
+
+	pthread_mutex_unlock(&verifier_mutex);
+
+	return LWFS_OK;
+}
+
+/**
+ * @brief Returns true if caps are verified locally.
+ */
+lwfs_bool cap_verifier_enabled()
+{
+	return enabled;
+}
+
+/**
+ * @brief Make sure a key or a revocation came from the authr server.
+ *
+ * @param authr_svc  @input The authorization service.
+ * @param caller     @input The process that sent the request.
+ *
+ * @returns \ref LWFS_ERR_ACCESS if \em caller is not the authr server.
+ */
+int cap_verifier_check_sender(
+		const lwfs_service *authr_svc,
+		const lwfs_remote_pid *caller)
+{
+	if ((caller->nid != authr_svc->req_addr.match_id.nid) ||
+	    (caller->pid != authr_svc->req_addr.match_id.pid)) {
+		log_warn(authr_debug_level, "rejecting key/revocation from "
+				"(nid=%llu, pid=%llu)",
+				(unsigned long long)caller->nid,
+				(unsigned long long)caller->pid);
+		return LWFS_ERR_ACCESS;
+	}
+
+	return LWFS_OK;
+}
+
+/**
+ * @brief Replace the keys after the authr server rotated its key.
+ *
+ * We ignore keys older than the ones we have (replies can
+ * arrive out of order) and drop the revocations the new keys
+ * made obsolete.
+ */
+int cap_verifier_set_key(
+		const lwfs_cap_key_info *info)
+{
+	int rc = LWFS_OK;
+
+	pthread_mutex_lock(&verifier_mutex);
+
+	if (table_ready && (info->generation >= generation)) {
+		copy_key_info(info);
+		stats.key_updates++;
+
+		rc = add_revoked_list(info);
+		if (rc != LWFS_OK) {
+			/* we cannot track the ACLs anymore */
+			log_error(authr_debug_level, "disabling local cap verification");
+			enabled = FALSE;
+			table_ready = FALSE;
+			hashtable_destroy(&revoked_ht, free);
+		}
+		else {
+			prune_revoked();
+		}
+	}
+
+	pthread_mutex_unlock(&verifier_mutex);
+
+	log_debug(authr_debug_level, "received cap key (generation %u)",
+			info->generation);
+
+	return rc;
+}
+
+/**
+ * @brief Record a revocation from the authr server.
+ *
+ * Caps for \em cid that enable any of the operations in
+ * \em container_op are sent to the authr server from now on.
+ *
+ * @param cid    @input The container ID.
+ * @param container_op @input The revoked operations.
+ * @param gen    @input The key generation of the authr server.
+ */
+int cap_verifier_revoke(
+		const lwfs_cid cid,
+		const lwfs_container_op container_op,
+		const unsigned int gen)
+{
+	int rc = LWFS_OK;
+
+	pthread_mutex_lock(&verifier_mutex);
+
+	if (table_ready) {
+		stats.revocations++;
+		rc = add_revoked(cid, container_op, gen);
+		if (rc != LWFS_OK) {
+			/* we cannot track the ACLs anymore */
+			log_error(authr_debug_level, "disabling local cap verification");
+			enabled = FALSE;
+			table_ready = FALSE;
+			hashtable_destroy(&revoked_ht, free);
+		}
+	}
+
+	pthread_mutex_unlock(&verifier_mutex);
+
+	return rc;
+}
+
+/**
+ * @brief Verify a cap without calling the authr server.
+ *
+ * @param cap @input The cap to verify.
+ *
+ * @returns \ref LWFS_OK if the cap is valid, \ref LWFS_ERR_NOENT
+ *          if only the authr server can decide.
+ */
+int cap_verifier_check(
+		const lwfs_cap *cap)
+{
+	int rc = LWFS_ERR_NOENT;
+	struct revoked_entry *entry = NULL;
+	lwfs_key cur;
+	lwfs_key prev;
+
+	if (!enabled) {
+		return rc;
+	}
+
+	pthread_mutex_lock(&verifier_mutex);
+
+	if (!enabled) {
+		pthread_mutex_unlock(&verifier_mutex);
+		return rc;
+	}
+
+	/* the ACLs changed after the cap was generated */
+	entry = search_entry(&revoked_ht, (lwfs_cid *)&cap->data.cid);
+	if ((entry != NULL) && (entry->container_op & cap->data.container_op)) {
+		stats.acl_fallbacks++;
+		pthread_mutex_unlock(&verifier_mutex);
+		return rc;
+	}
+
+	/* copy the keys so we compute the MAC without the lock */
+	memcpy(cur, key, sizeof(lwfs_key));
+	memcpy(prev, prev_key, sizeof(lwfs_key));
+
+	pthread_mutex_unlock(&verifier_mutex);
+
+	/* If the MAC does not match, the authr server may have rotated
+	 * its key before we received the new one.  Let it decide. */
+	if ((verify_cap((const lwfs_key *)&cur, cap) == LWFS_OK) ||
+	    (verify_cap((const lwfs_key *)&prev, cap) == LWFS_OK)) {
+		rc = LWFS_OK;
+	}
+
+	pthread_mutex_lock(&verifier_mutex);
+	if (rc == LWFS_OK) stats.local++;
+	else stats.mac_fallbacks++;
+	pthread_mutex_unlock(&verifier_mutex);
+
+	return rc;
+}
+
+/**
+ * @brief Tell the verifier that the authr server accepted a cap.
+ *
+ * Call this after the authr server verified a cap that
+ * \ref cap_verifier_check sent to it.  If the MAC matches
+ * neither of our keys, we missed a key (and maybe some
+ * revocations), so we fetch the key and the revoked
+ * containers again.
+ *
+ * @param cap @input The cap the authr server accepted.
+ */
+int cap_verifier_confirm(
+		const lwfs_cap *cap)
+{
+	int rc = LWFS_OK;
+	lwfs_cap_key_info info;
+	lwfs_key cur;
+	lwfs_key prev;
+
+	if (!enabled) {
+		return rc;
+	}
+
+	pthread_mutex_lock(&verifier_mutex);
+	if ((!enabled) || refetching) {
+		pthread_mutex_unlock(&verifier_mutex);
+		return rc;
+	}
+	memcpy(cur, key, sizeof(lwfs_key));
+	memcpy(prev, prev_key, sizeof(lwfs_key));
+	pthread_mutex_unlock(&verifier_mutex);
+
+	/* a revoked container, not a missed key */
+	if ((verify_cap((const lwfs_key *)&cur, cap) == LWFS_OK) ||
+	    (verify_cap((const lwfs_key *)&prev, cap) == LWFS_OK)) {
+		return rc;
+	}
+
+	/* one thread fetches, the others keep asking the authr server */
+	pthread_mutex_lock(&verifier_mutex);
+	if (refetching) {
+		pthread_mutex_unlock(&verifier_mutex);
+		return rc;
+	}
+	refetching = TRUE;
+	pthread_mutex_unlock(&verifier_mutex);
+
+	log_warn(authr_debug_level, "missed a cap key, fetching it again");
+
+	memset(&info, 0, sizeof(lwfs_cap_key_info));
+	rc = lwfs_get_cap_key_sync(&authr, &self, &info);
+	if (rc != LWFS_OK) {
+		log_warn(authr_debug_level, "could not get cap key: %s",
+				lwfs_err_str(rc));
+		pthread_mutex_lock(&verifier_mutex);
+		refetching = FALSE;
+		pthread_mutex_unlock(&verifier_mutex);
+		return rc;
+	}
+
+	pthread_mutex_lock(&verifier_mutex);
+	if (table_ready) {
+		stats.refetches++;
+		if (info.generation >= generation) {
+			copy_key_info(&info);
+		}
+		rc = add_revoked_list(&info);
+		if (rc != LWFS_OK) {
+			/* we cannot track the ACLs anymore */
+			log_error(authr_debug_level, "disabling local cap verification");
+			enabled = FALSE;
+			table_ready = FALSE;
+			hashtable_destroy(&revoked_ht, free);
+		}
+		else {
+			prune_revoked();
+		}
+	}
+	refetching = FALSE;
+	pthread_mutex_unlock(&verifier_mutex);
+
+	xdr_free((xdrproc_t)&xdr_lwfs_cap_key_info, (char *)&info);
+
+	return rc;
+}
+
+/**
+ * @brief Get a copy of the verifier counters.
+ */
+void cap_verifier_get_stats(
+		struct cap_verifier_stats *result)
+{
+	pthread_mutex_lock(&verifier_mutex);
+	memcpy(result, &stats, sizeof(struct cap_verifier_stats));
+	pthread_mutex_unlock(&verifier_mutex);
+}
+
+/**
+ * @brief Print the verifier counters.
+ */
+void fprint_cap_verifier_stats(
+		FILE *fp)
+{
+	struct cap_verifier_stats s;
+
+	cap_verifier_get_stats(&s);
+
+	fprintf(fp, "  Cap verifier:\n");
+	fprintf(fp, "\tlocal = %ld\n", s.local);
+	fprintf(fp, "\tmac_fallbacks = %ld\n", s.mac_fallbacks);
+	fprintf(fp, "\tacl_fallbacks = %ld\n", s.acl_fallbacks);
+	fprintf(fp, "\tkey_updates = %ld\n", s.key_updates);
+	fprintf(fp, "\trevocations = %ld\n", s.revocations);
+	fprintf(fp, "\trefetches = %ld\n", s.refetches);
+}
@@ -0,0 +1,83 @@
+/**
+ *   @file cap_verifier.h
+ *
+ *   @brief Prototypes for verifying capabilities without the authr server.
+ *
+ *   @author Ron Oldfield (raoldfi\@sandia.gov)
+ */
+
+#ifndef _CAP_VERIFIER_H_
+#define _CAP_VERIFIER_H_
+
+#include <stdio.h>
+#include "common/types/types.h"
+#include "common/authr_common/authr_args.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	/**
+	 * @brief Counters for the cap verifier.
+	 */
+	struct cap_verifier_stats {
+		/** @brief Caps verified with the local key. */
+		long local;
+
+		/** @brief Caps sent to the authr server because the MAC did not match. */
+		long mac_fallbacks;
+
+		/** @brief Caps sent to the authr server because of a revocation. */
+		long acl_fallbacks;
+
+		/** @brief Keys received from the authr server. */
+		long key_updates;
+
+		/** @brief Revocations received from the authr server. */
+		long revocations;
+
+		/** @brief Keys fetched again after we missed a key. */
+		long refetches;
+	};
+
+#if defined(__STDC__) || defined(__cplusplus)
+
+	extern int cap_verifier_init(
+			const lwfs_service *authr_svc,
+			const lwfs_service *svc);
+
+	extern int cap_verifier_fini(void);
+
+	extern lwfs_bool cap_verifier_enabled(void);
+
+	extern int cap_verifier_check_sender(
+			const lwfs_service *authr_svc,
+			const lwfs_remote_pid *caller);
+
+	extern int cap_verifier_set_key(
+			const lwfs_cap_key_info *info);
+
+	extern int cap_verifier_revoke(
+			const lwfs_cid cid,
+			const lwfs_container_op container_op,
+			const unsigned int gen);
+
+	extern int cap_verifier_check(
+			const lwfs_cap *cap);
+
+	extern int cap_verifier_confirm(
+			const lwfs_cap *cap);
+
+	extern void cap_verifier_get_stats(
+			struct cap_verifier_stats *stats);
+
+	extern void fprint_cap_verifier_stats(
+			FILE *fp);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -39,13 +39,25 @@ const char *gengetopt_args_info_help[] = {
   "      --authr-trace             Enable tracing  (default=off)",
   "      --authr-tracefile=STRING  Path to the trace file  \n                                  (default=`authr-trace.sddf')",
   "      --authr-traceftype=INT    File type of tracefile (0=binary, 1=ASCII)  \n                                  (default=`0')",
+  "      --authr-share-key         Flag to give the cap key to storage/naming \n                                  servers that verify caps locally  \n                                  (default=off)",
+  "      --authr-key-lifetime=INT  Seconds between cap key rotations (0=never); \n                                  caps older than two rotations become invalid  \n                                  (default=`0')",
+  "      --authr-key-holders=STRING\n                                LWFS config file that lists the naming and \n                                  storage servers allowed to fetch the cap key",
   "      --verbose=INT             Debug level of logger [0-5]  (default=`5')",
   "      --logfile=STRING          Path to logfile",
   "      --tp-init-thread-count=INT\n                                Initial number of thread in the pool  \n                                  (default=`1')",
   "      --tp-min-thread-count=INT Minimum number of thread in the pool  \n                                  (default=`1')",
-  "      --tp-max-thread-count=INT Maximum number of thread in the pool  \n                                  (default=`1')",
+  "      --tp-max-thread-count=INT Maximum number of thread in the pool  \n                                  (default=`999999999')",
   "      --tp-low-watermark=INT    Request queue size at which threads are removed \n                                  from the pool  (default=`1')",
-  "      --tp-high-watermark=INT   Request queue size at which threads are added \n                                  to the pool  (default=`1')",
+  "      --tp-high-watermark=INT   Request queue size at which threads are added \n                                  to the pool  (default=`999999999')",
+  "      --tp-queue-high-watermark=INT\n                                Request queue size at which the server turns \n                                  away new requests (0=default)  (default=`0')",
+  "      --tp-queue-low-watermark=INT\n                                Request queue size at which the pool accepts \n                                  requests again  (default=`0')",
+  "      --tp-metadata-weight=INT  Share of the threads for metadata requests \n                                  (0=default)  (default=`0')",
+  "      --tp-bulk-weight=INT      Share of the threads for bulk data requests \n                                  (0=default)  (default=`0')",
+  "      --tp-batch-size=INT       Requests a thread takes from the queue at once; \n                                  idle threads steal the rest (0=default)  \n                                  (default=`0')",
+  "      --tp-pin-threads          Run each thread on its own CPU  (default=off)",
+  "      --max-mem-allowed=INT     System memory usage in kilobytes above which \n                                  the server rejects new requests  (default=`0')",
+  "      --rpc-req-segments=INT    Segments in the ring of request buffers (0 = \n                                  default)  (default=`0')",
+  "      --rpc-reqs-per-segment=INT\n                                Requests each segment of the ring holds (0 = \n                                  default)  (default=`0')",
     0
 };
 
@@ -101,6 +113,9 @@ void clear_given (struct gengetopt_args_info *args_info)
   args_info->authr_trace_given = 0 ;
   args_info->authr_tracefile_given = 0 ;
   args_info->authr_traceftype_given = 0 ;
+  args_info->authr_share_key_given = 0 ;
+  args_info->authr_key_lifetime_given = 0 ;
+  args_info->authr_key_holders_given = 0 ;
   args_info->verbose_given = 0 ;
   args_info->logfile_given = 0 ;
   args_info->tp_init_thread_count_given = 0 ;
@@ -108,6 +123,15 @@ void clear_given (struct gengetopt_args_info *args_info)
   args_info->tp_max_thread_count_given = 0 ;
   args_info->tp_low_watermark_given = 0 ;
   args_info->tp_high_watermark_given = 0 ;
+  args_info->tp_queue_high_watermark_given = 0 ;
+  args_info->tp_queue_low_watermark_given = 0 ;
+  args_info->tp_metadata_weight_given = 0 ;
+  args_info->tp_bulk_weight_given = 0 ;
+  args_info->tp_batch_size_given = 0 ;
+  args_info->tp_pin_threads_given = 0 ;
+  args_info->max_mem_allowed_given = 0 ;
+  args_info->rpc_req_segments_given = 0 ;
+  args_info->rpc_reqs_per_segment_given = 0 ;
 }
 
 static
@@ -129,6 +153,11 @@ void clear_args (struct gengetopt_args_info *args_info)
   args_info->authr_tracefile_orig = NULL;
   args_info->authr_traceftype_arg = 0;
   args_info->authr_traceftype_orig = NULL;
+  args_info->authr_share_key_flag = 0;
+  args_info->authr_key_lifetime_arg = 0;
+  args_info->authr_key_lifetime_orig = NULL;
+  args_info->authr_key_holders_arg = NULL;
+  args_info->authr_key_holders_orig = NULL;
   args_info->verbose_arg = 5;
   args_info->verbose_orig = NULL;
   args_info->logfile_arg = NULL;
@@ -137,12 +166,29 @@ void clear_args (struct gengetopt_args_info *args_info)
   args_info->tp_init_thread_count_orig = NULL;
   args_info->tp_min_thread_count_arg = 1;
   args_info->tp_min_thread_count_orig = NULL;
-  args_info->tp_max_thread_count_arg = 1;
+  args_info->tp_max_thread_count_arg = 999999999;
   args_info->tp_max_thread_count_orig = NULL;
   args_info->tp_low_watermark_arg = 1;
   args_info->tp_low_watermark_orig = NULL;
-  args_info->tp_high_watermark_arg = 1;
+  args_info->tp_high_watermark_arg = 999999999;
   args_info->tp_high_watermark_orig = NULL;
+  args_info->tp_queue_high_watermark_arg = 0;
+  args_info->tp_queue_high_watermark_orig = NULL;
+  args_info->tp_queue_low_watermark_arg = 0;
+  args_info->tp_queue_low_watermark_orig = NULL;
+  args_info->tp_metadata_weight_arg = 0;
+  args_info->tp_metadata_weight_orig = NULL;
+  args_info->tp_bulk_weight_arg = 0;
+  args_info->tp_bulk_weight_orig = NULL;
+  args_info->tp_batch_size_arg = 0;
+  args_info->tp_batch_size_orig = NULL;
+  args_info->tp_pin_threads_flag = 0;
+  args_info->max_mem_allowed_arg = 0;
+  args_info->max_mem_allowed_orig = NULL;
+  args_info->rpc_req_segments_arg = 0;
+  args_info->rpc_req_segments_orig = NULL;
+  args_info->rpc_reqs_per_segment_arg = 0;
+  args_info->rpc_reqs_per_segment_orig = NULL;
   
 }
 
@@ -162,13 +208,25 @@ void init_args_info(struct gengetopt_args_info *args_info)
   args_info->authr_trace_help = gengetopt_args_info_help[10] ;
   args_info->authr_tracefile_help = gengetopt_args_info_help[11] ;
   args_info->authr_traceftype_help = gengetopt_args_info_help[12] ;
-  args_info->verbose_help = gengetopt_args_info_help[13] ;
-  args_info->logfile_help = gengetopt_args_info_help[14] ;
-  args_info->tp_init_thread_count_help = gengetopt_args_info_help[15] ;
-  args_info->tp_min_thread_count_help = gengetopt_args_info_help[16] ;
-  args_info->tp_max_thread_count_help = gengetopt_args_info_help[17] ;
-  args_info->tp_low_watermark_help = gengetopt_args_info_help[18] ;
-  args_info->tp_high_watermark_help = gengetopt_args_info_help[19] ;
+  args_info->authr_share_key_help = gengetopt_args_info_help[13] ;
+  args_info->authr_key_lifetime_help = gengetopt_args_info_help[14] ;
+  args_info->authr_key_holders_help = gengetopt_args_info_help[15] ;
+  args_info->verbose_help = gengetopt_args_info_help[16] ;
+  args_info->logfile_help = gengetopt_args_info_help[17] ;
+  args_info->tp_init_thread_count_help = gengetopt_args_info_help[18] ;
+  args_info->tp_min_thread_count_help = gengetopt_args_info_help[19] ;
+  args_info->tp_max_thread_count_help = gengetopt_args_info_help[20] ;
+  args_info->tp_low_watermark_help = gengetopt_args_info_help[21] ;
+  args_info->tp_high_watermark_help = gengetopt_args_info_help[22] ;
+  args_info->tp_queue_high_watermark_help = gengetopt_args_info_help[23] ;
+  args_info->tp_queue_low_watermark_help = gengetopt_args_info_help[24] ;
+  args_info->tp_metadata_weight_help = gengetopt_args_info_help[25] ;
+  args_info->tp_bulk_weight_help = gengetopt_args_info_help[26] ;
+  args_info->tp_batch_size_help = gengetopt_args_info_help[27] ;
+  args_info->tp_pin_threads_help = gengetopt_args_info_help[28] ;
+  args_info->max_mem_allowed_help = gengetopt_args_info_help[29] ;
+  args_info->rpc_req_segments_help = gengetopt_args_info_help[30] ;
+  args_info->rpc_reqs_per_segment_help = gengetopt_args_info_help[31] ;
   
 }
 
@@ -239,6 +297,21 @@ cmdline_parser_release (struct gengetopt_args_info *args_info)
       free (args_info->authr_traceftype_orig); /* free previous argument */
       args_info->authr_traceftype_orig = 0;
     }
+  if (args_info->authr_key_lifetime_orig)
+    {
+      free (args_info->authr_key_lifetime_orig); /* free previous argument */
+      args_info->authr_key_lifetime_orig = 0;
+    }
+  if (args_info->authr_key_holders_arg)
+    {
+      free (args_info->authr_key_holders_arg); /* free previous argument */
+      args_info->authr_key_holders_arg = 0;
+    }
+  if (args_info->authr_key_holders_orig)
+    {
+      free (args_info->authr_key_holders_orig); /* free previous argument */
+      args_info->authr_key_holders_orig = 0;
+    }
   if (args_info->verbose_orig)
     {
       free (args_info->verbose_orig); /* free previous argument */
@@ -279,6 +352,46 @@ cmdline_parser_release (struct gengetopt_args_info *args_info)
       free (args_info->tp_high_watermark_orig); /* free previous argument */
       args_info->tp_high_watermark_orig = 0;
     }
+  if (args_info->tp_queue_high_watermark_orig)
+    {
+      free (args_info->tp_queue_high_watermark_orig); /* free previous argument */
+      args_info->tp_queue_high_watermark_orig = 0;
+    }
+  if (args_info->tp_queue_low_watermark_orig)
+    {
+      free (args_info->tp_queue_low_watermark_orig); /* free previous argument */
+      args_info->tp_queue_low_watermark_orig = 0;
+    }
+  if (args_info->tp_metadata_weight_orig)
+    {
+      free (args_info->tp_metadata_weight_orig); /* free previous argument */
+      args_info->tp_metadata_weight_orig = 0;
+    }
+  if (args_info->tp_bulk_weight_orig)
+    {
+      free (args_info->tp_bulk_weight_orig); /* free previous argument */
+      args_info->tp_bulk_weight_orig = 0;
+    }
+  if (args_info->tp_batch_size_orig)
+    {
+      free (args_info->tp_batch_size_orig); /* free previous argument */
+      args_info->tp_batch_size_orig = 0;
+    }
+  if (args_info->max_mem_allowed_orig)
+    {
+      free (args_info->max_mem_allowed_orig); /* free previous argument */
+      args_info->max_mem_allowed_orig = 0;
+    }
+  if (args_info->rpc_req_segments_orig)
+    {
+      free (args_info->rpc_req_segments_orig); /* free previous argument */
+      args_info->rpc_req_segments_orig = 0;
+    }
+  if (args_info->rpc_reqs_per_segment_orig)
+    {
+      free (args_info->rpc_reqs_per_segment_orig); /* free previous argument */
+      args_info->rpc_reqs_per_segment_orig = 0;
+    }
   
   clear_given (args_info);
 }
@@ -356,6 +469,23 @@ cmdline_parser_file_save(const char *filename, struct gengetopt_args_info *args_
       fprintf(outfile, "%s\n", "authr-traceftype");
     }
   }
+  if (args_info->authr_share_key_given) {
+    fprintf(outfile, "%s\n", "authr-share-key");
+  }
+  if (args_info->authr_key_lifetime_given) {
+    if (args_info->authr_key_lifetime_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "authr-key-lifetime", args_info->authr_key_lifetime_orig);
+    } else {
+      fprintf(outfile, "%s\n", "authr-key-lifetime");
+    }
+  }
+  if (args_info->authr_key_holders_given) {
+    if (args_info->authr_key_holders_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "authr-key-holders", args_info->authr_key_holders_orig);
+    } else {
+      fprintf(outfile, "%s\n", "authr-key-holders");
+    }
+  }
   if (args_info->verbose_given) {
     if (args_info->verbose_orig) {
       fprintf(outfile, "%s=\"%s\"\n", "verbose", args_info->verbose_orig);
@@ -405,6 +535,65 @@ cmdline_parser_file_save(const char *filename, struct gengetopt_args_info *args_
       fprintf(outfile, "%s\n", "tp-high-watermark");
     }
   }
+  if (args_info->tp_queue_high_watermark_given) {
+    if (args_info->tp_queue_high_watermark_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "tp-queue-high-watermark", args_info->tp_queue_high_watermark_orig);
+    } else {
+      fprintf(outfile, "%s\n", "tp-queue-high-watermark");
+    }
+  }
+  if (args_info->tp_queue_low_watermark_given) {
+    if (args_info->tp_queue_low_watermark_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "tp-queue-low-watermark", args_info->tp_queue_low_watermark_orig);
+    } else {
+      fprintf(outfile, "%s\n", "tp-queue-low-watermark");
+    }
+  }
+  if (args_info->tp_metadata_weight_given) {
+    if (args_info->tp_metadata_weight_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "tp-metadata-weight", args_info->tp_metadata_weight_orig);
+    } else {
+      fprintf(outfile, "%s\n", "tp-metadata-weight");
+    }
+  }
+  if (args_info->tp_bulk_weight_given) {
+    if (args_info->tp_bulk_weight_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "tp-bulk-weight", args_info->tp_bulk_weight_orig);
+    } else {
+      fprintf(outfile, "%s\n", "tp-bulk-weight");
+    }
+  }
+  if (args_info->tp_batch_size_given) {
+    if (args_info->tp_batch_size_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "tp-batch-size", args_info->tp_batch_size_orig);
+    } else {
+      fprintf(outfile, "%s\n", "tp-batch-size");
+    }
+  }
+  if (args_info->tp_pin_threads_given) {
+    fprintf(outfile, "%s\n", "tp-pin-threads");
+  }
+  if (args_info->max_mem_allowed_given) {
+    if (args_info->max_mem_allowed_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "max-mem-allowed", args_info->max_mem_allowed_orig);
+    } else {
+      fprintf(outfile, "%s\n", "max-mem-allowed");
+    }
+  }
+  if (args_info->rpc_req_segments_given) {
+    if (args_info->rpc_req_segments_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "rpc-req-segments", args_info->rpc_req_segments_orig);
+    } else {
+      fprintf(outfile, "%s\n", "rpc-req-segments");
+    }
+  }
+  if (args_info->rpc_reqs_per_segment_given) {
+    if (args_info->rpc_reqs_per_segment_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "rpc-reqs-per-segment", args_info->rpc_reqs_per_segment_orig);
+    } else {
+      fprintf(outfile, "%s\n", "rpc-reqs-per-segment");
+    }
+  }
   
   fclose (outfile);
 
@@ -500,6 +689,9 @@ cmdline_parser_internal (int argc, char * const *argv, struct gengetopt_args_inf
         { "authr-trace",	0, NULL, 0 },
         { "authr-tracefile",	1, NULL, 0 },
         { "authr-traceftype",	1, NULL, 0 },
+        { "authr-share-key",	0, NULL, 0 },
+        { "authr-key-lifetime",	1, NULL, 0 },
+        { "authr-key-holders",	1, NULL, 0 },
         { "verbose",	1, NULL, 0 },
         { "logfile",	1, NULL, 0 },
         { "tp-init-thread-count",	1, NULL, 0 },
@@ -507,6 +699,15 @@ cmdline_parser_internal (int argc, char * const *argv, struct gengetopt_args_inf
         { "tp-max-thread-count",	1, NULL, 0 },
         { "tp-low-watermark",	1, NULL, 0 },
         { "tp-high-watermark",	1, NULL, 0 },
+        { "tp-queue-high-watermark",	1, NULL, 0 },
+        { "tp-queue-low-watermark",	1, NULL, 0 },
+        { "tp-metadata-weight",	1, NULL, 0 },
+        { "tp-bulk-weight",	1, NULL, 0 },
+        { "tp-batch-size",	1, NULL, 0 },
+        { "tp-pin-threads",	0, NULL, 0 },
+        { "max-mem-allowed",	1, NULL, 0 },
+        { "rpc-req-segments",	1, NULL, 0 },
+        { "rpc-reqs-per-segment",	1, NULL, 0 },
         { NULL,	0, NULL, 0 }
       };
 
@@ -714,6 +915,60 @@ cmdline_parser_internal (int argc, char * const *argv, struct gengetopt_args_inf
               free (args_info->authr_traceftype_orig); /* free previous string */
             args_info->authr_traceftype_orig = gengetopt_strdup (optarg);
           }
+          /* Flag to give the cap key to storage/naming servers that verify caps locally.  */
+          else if (strcmp (long_options[option_index].name, "authr-share-key") == 0)
+          {
+            if (local_args_info.authr_share_key_given)
+              {
+                fprintf (stderr, "%s: `--authr-share-key' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->authr_share_key_given && ! override)
+              continue;
+            local_args_info.authr_share_key_given = 1;
+            args_info->authr_share_key_given = 1;
+            args_info->authr_share_key_flag = !(args_info->authr_share_key_flag);
+          }
+          /* Seconds between cap key rotations (0=never); caps older than two rotations become invalid.  */
+          else if (strcmp (long_options[option_index].name, "authr-key-lifetime") == 0)
+          {
+            if (local_args_info.authr_key_lifetime_given)
+              {
+                fprintf (stderr, "%s: `--authr-key-lifetime' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->authr_key_lifetime_given && ! override)
+              continue;
+            local_args_info.authr_key_lifetime_given = 1;
+            args_info->authr_key_lifetime_given = 1;
+            args_info->authr_key_lifetime_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->authr_key_lifetime_orig)
+              free (args_info->authr_key_lifetime_orig); /* free previous string */
+            args_info->authr_key_lifetime_orig = gengetopt_strdup (optarg);
+          }
+          /* LWFS config file that lists the naming and storage servers allowed to fetch the cap key.  */
+          else if (strcmp (long_options[option_index].name, "authr-key-holders") == 0)
+          {
+            if (local_args_info.authr_key_holders_given)
+              {
+                fprintf (stderr, "%s: `--authr-key-holders' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->authr_key_holders_given && ! override)
+              continue;
+            local_args_info.authr_key_holders_given = 1;
+            args_info->authr_key_holders_given = 1;
+            if (args_info->authr_key_holders_arg)
+              free (args_info->authr_key_holders_arg); /* free previous string */
+            args_info->authr_key_holders_arg = gengetopt_strdup (optarg);
+            if (args_info->authr_key_holders_orig)
+              free (args_info->authr_key_holders_orig); /* free previous string */
+            args_info->authr_key_holders_orig = gengetopt_strdup (optarg);
+          }
           /* Debug level of logger [0-5].  */
           else if (strcmp (long_options[option_index].name, "verbose") == 0)
           {
@@ -859,6 +1114,188 @@ cmdline_parser_internal (int argc, char * const *argv, struct gengetopt_args_inf
               free (args_info->tp_high_watermark_orig); /* free previous string */
             args_info->tp_high_watermark_orig = gengetopt_strdup (optarg);
           }
+          /* Request queue size at which the server turns away new requests (0=default).  */
+          else if (strcmp (long_options[option_index].name, "tp-queue-high-watermark") == 0)
+          {
+            if (local_args_info.tp_queue_high_watermark_given)
+              {
+                fprintf (stderr, "%s: `--tp-queue-high-watermark' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->tp_queue_high_watermark_given && ! override)
+              continue;
+            local_args_info.tp_queue_high_watermark_given = 1;
+            args_info->tp_queue_high_watermark_given = 1;
+            args_info->tp_queue_high_watermark_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->tp_queue_high_watermark_orig)
+              free (args_info->tp_queue_high_watermark_orig); /* free previous string */
+            args_info->tp_queue_high_watermark_orig = gengetopt_strdup (optarg);
+          }
+          /* Request queue size at which the pool accepts requests again.  */
+          else if (strcmp (long_options[option_index].name, "tp-queue-low-watermark") == 0)
+          {
+            if (local_args_info.tp_queue_low_watermark_given)
+              {
+                fprintf (stderr, "%s: `--tp-queue-low-watermark' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->tp_queue_low_watermark_given && ! override)
+              continue;
+            local_args_info.tp_queue_low_watermark_given = 1;
+            args_info->tp_queue_low_watermark_given = 1;
+            args_info->tp_queue_low_watermark_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->tp_queue_low_watermark_orig)
+              free (args_info->tp_queue_low_watermark_orig); /* free previous string */
+            args_info->tp_queue_low_watermark_orig = gengetopt_strdup (optarg);
+          }
+          /* Share of the threads for metadata requests (0=default).  */
+          else if (strcmp (long_options[option_index].name, "tp-metadata-weight") == 0)
+          {
+            if (local_args_info.tp_metadata_weight_given)
+              {
+                fprintf (stderr, "%s: `--tp-metadata-weight' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->tp_metadata_weight_given && ! override)
+              continue;
+            local_args_info.tp_metadata_weight_given = 1;
+            args_info->tp_metadata_weight_given = 1;
+            args_info->tp_metadata_weight_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->tp_metadata_weight_orig)
+              free (args_info->tp_metadata_weight_orig); /* free previous string */
+            args_info->tp_metadata_weight_orig = gengetopt_strdup (optarg);
+          }
+          /* Share of the threads for bulk data requests (0=default).  */
+          else if (strcmp (long_options[option_index].name, "tp-bulk-weight") == 0)
+          {
+            if (local_args_info.tp_bulk_weight_given)
+              {
+                fprintf (stderr, "%s: `--tp-bulk-weight' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->tp_bulk_weight_given && ! override)
+              continue;
+            local_args_info.tp_bulk_weight_given = 1;
+            args_info->tp_bulk_weight_given = 1;
+            args_info->tp_bulk_weight_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->tp_bulk_weight_orig)
+              free (args_info->tp_bulk_weight_orig); /* free previous string */
+            args_info->tp_bulk_weight_orig = gengetopt_strdup (optarg);
+          }
+          /* Requests a thread takes from the queue at once; idle threads steal the rest (0=default).  */
+          else if (strcmp (long_options[option_index].name, "tp-batch-size") == 0)
+          {
+            if (local_args_info.tp_batch_size_given)
+              {
+                fprintf (stderr, "%s: `--tp-batch-size' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->tp_batch_size_given && ! override)
+              continue;
+            local_args_info.tp_batch_size_given = 1;
+            args_info->tp_batch_size_given = 1;
+            args_info->tp_batch_size_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->tp_batch_size_orig)
+              free (args_info->tp_batch_size_orig); /* free previous string */
+            args_info->tp_batch_size_orig = gengetopt_strdup (optarg);
+          }
+          /* Run each thread on its own CPU.  */
+          else if (strcmp (long_options[option_index].name, "tp-pin-threads") == 0)
+          {
+            if (local_args_info.tp_pin_threads_given)
+              {
+                fprintf (stderr, "%s: `--tp-pin-threads' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->tp_pin_threads_given && ! override)
+              continue;
+            local_args_info.tp_pin_threads_given = 1;
+            args_info->tp_pin_threads_given = 1;
+            args_info->tp_pin_threads_flag = !(args_info->tp_pin_threads_flag);
+          }
+          /* System memory usage in kilobytes above which the server rejects new requests.  */
+          else if (strcmp (long_options[option_index].name, "max-mem-allowed") == 0)
+          {
+            if (local_args_info.max_mem_allowed_given)
+              {
+                fprintf (stderr, "%s: `--max-mem-allowed' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->max_mem_allowed_given && ! override)
+              continue;
+            local_args_info.max_mem_allowed_given = 1;
+            args_info->max_mem_allowed_given = 1;
+            args_info->max_mem_allowed_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->max_mem_allowed_orig)
+              free (args_info->max_mem_allowed_orig); /* free previous string */
+            args_info->max_mem_allowed_orig = gengetopt_strdup (optarg);
+          }
+          /* Segments in the ring of request buffers (0 = default).  */
+          else if (strcmp (long_options[option_index].name, "rpc-req-segments") == 0)
+          {
+            if (local_args_info.rpc_req_segments_given)
+              {
+                fprintf (stderr, "%s: `--rpc-req-segments' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->rpc_req_segments_given && ! override)
+              continue;
+            local_args_info.rpc_req_segments_given = 1;
+            args_info->rpc_req_segments_given = 1;
+            args_info->rpc_req_segments_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->rpc_req_segments_orig)
+              free (args_info->rpc_req_segments_orig); /* free previous string */
+            args_info->rpc_req_segments_orig = gengetopt_strdup (optarg);
+          }
+          /* Requests each segment of the ring holds (0 = default).  */
+          else if (strcmp (long_options[option_index].name, "rpc-reqs-per-segment") == 0)
+          {
+            if (local_args_info.rpc_reqs_per_segment_given)
+              {
+                fprintf (stderr, "%s: `--rpc-reqs-per-segment' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->rpc_reqs_per_segment_given && ! override)
+              continue;
+            local_args_info.rpc_reqs_per_segment_given = 1;
+            args_info->rpc_reqs_per_segment_given = 1;
+            args_info->rpc_reqs_per_segment_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->rpc_reqs_per_segment_orig)
+              free (args_info->rpc_reqs_per_segment_orig); /* free previous string */
+            args_info->rpc_reqs_per_segment_orig = gengetopt_strdup (optarg);
+          }
           
           break;
         case '?':	/* Invalid option.  */
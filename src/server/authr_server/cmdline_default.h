@@ -53,6 +53,14 @@ struct gengetopt_args_info
   int authr_traceftype_arg;	/* File type of tracefile (0=binary, 1=ASCII) (default='0').  */
   char * authr_traceftype_orig;	/* File type of tracefile (0=binary, 1=ASCII) original value given at command line.  */
   const char *authr_traceftype_help; /* File type of tracefile (0=binary, 1=ASCII) help description.  */
+  int authr_share_key_flag;	/* Flag to give the cap key to storage/naming servers that verify caps locally (default=off).  */
+  const char *authr_share_key_help; /* Flag to give the cap key to storage/naming servers that verify caps locally help description.  */
+  int authr_key_lifetime_arg;	/* Seconds between cap key rotations (0=never); caps older than two rotations become invalid (default='0').  */
+  char * authr_key_lifetime_orig;	/* Seconds between cap key rotations (0=never); caps older than two rotations become invalid original value given at command line.  */
+  const char *authr_key_lifetime_help; /* Seconds between cap key rotations (0=never); caps older than two rotations become invalid help description.  */
+  char * authr_key_holders_arg;	/* LWFS config file that lists the naming and storage servers allowed to fetch the cap key.  */
+  char * authr_key_holders_orig;	/* LWFS config file that lists the naming and storage servers allowed to fetch the cap key original value given at command line.  */
+  const char *authr_key_holders_help; /* LWFS config file that lists the naming and storage servers allowed to fetch the cap key help description.  */
   int verbose_arg;	/* Debug level of logger [0-5] (default='5').  */
   char * verbose_orig;	/* Debug level of logger [0-5] original value given at command line.  */
   const char *verbose_help; /* Debug level of logger [0-5] help description.  */
@@ -65,15 +73,41 @@ struct gengetopt_args_info
   int tp_min_thread_count_arg;	/* Minimum number of thread in the pool (default='1').  */
   char * tp_min_thread_count_orig;	/* Minimum number of thread in the pool original value given at command line.  */
   const char *tp_min_thread_count_help; /* Minimum number of thread in the pool help description.  */
-  int tp_max_thread_count_arg;	/* Maximum number of thread in the pool (default='1').  */
+  int tp_max_thread_count_arg;	/* Maximum number of thread in the pool (default='999999999').  */
   char * tp_max_thread_count_orig;	/* Maximum number of thread in the pool original value given at command line.  */
   const char *tp_max_thread_count_help; /* Maximum number of thread in the pool help description.  */
   int tp_low_watermark_arg;	/* Request queue size at which threads are removed from the pool (default='1').  */
   char * tp_low_watermark_orig;	/* Request queue size at which threads are removed from the pool original value given at command line.  */
   const char *tp_low_watermark_help; /* Request queue size at which threads are removed from the pool help description.  */
-  int tp_high_watermark_arg;	/* Request queue size at which threads are added to the pool (default='1').  */
+  int tp_high_watermark_arg;	/* Request queue size at which threads are added to the pool (default='999999999').  */
   char * tp_high_watermark_orig;	/* Request queue size at which threads are added to the pool original value given at command line.  */
   const char *tp_high_watermark_help; /* Request queue size at which threads are added to the pool help description.  */
+  int tp_queue_high_watermark_arg;	/* Request queue size at which the server turns away new requests (0=default) (default='0').  */
+  char * tp_queue_high_watermark_orig;	/* Request queue size at which the server turns away new requests (0=default) original value given at command line.  */
+  const char *tp_queue_high_watermark_help; /* Request queue size at which the server turns away new requests (0=default) help description.  */
+  int tp_queue_low_watermark_arg;	/* Request queue size at which the pool accepts requests again (default='0').  */
+  char * tp_queue_low_watermark_orig;	/* Request queue size at which the pool accepts requests again original value given at command line.  */
+  const char *tp_queue_low_watermark_help; /* Request queue size at which the pool accepts requests again help description.  */
+  int tp_metadata_weight_arg;	/* Share of the threads for metadata requests (0=default) (default='0').  */
+  char * tp_metadata_weight_orig;	/* Share of the threads for metadata requests (0=default) original value given at command line.  */
+  const char *tp_metadata_weight_help; /* Share of the threads for metadata requests (0=default) help description.  */
+  int tp_bulk_weight_arg;	/* Share of the threads for bulk data requests (0=default) (default='0').  */
+  char * tp_bulk_weight_orig;	/* Share of the threads for bulk data requests (0=default) original value given at command line.  */
+  const char *tp_bulk_weight_help; /* Share of the threads for bulk data requests (0=default) help description.  */
+  int tp_batch_size_arg;	/* Requests a thread takes from the queue at once; idle threads steal the rest (0=default) (default='0').  */
+  char * tp_batch_size_orig;	/* Requests a thread takes from the queue at once; idle threads steal the rest (0=default) original value given at command line.  */
+  const char *tp_batch_size_help; /* Requests a thread takes from the queue at once; idle threads steal the rest (0=default) help description.  */
+  int tp_pin_threads_flag;	/* Run each thread on its own CPU (default=off).  */
+  const char *tp_pin_threads_help; /* Run each thread on its own CPU help description.  */
+  int max_mem_allowed_arg;	/* System memory usage in kilobytes above which the server rejects new requests (default='0').  */
+  char * max_mem_allowed_orig;	/* System memory usage in kilobytes above which the server rejects new requests original value given at command line.  */
+  const char *max_mem_allowed_help; /* System memory usage in kilobytes above which the server rejects new requests help description.  */
+  int rpc_req_segments_arg;	/* Segments in the ring of request buffers (0 = default) (default='0').  */
+  char * rpc_req_segments_orig;	/* Segments in the ring of request buffers (0 = default) original value given at command line.  */
+  const char *rpc_req_segments_help; /* Segments in the ring of request buffers (0 = default) help description.  */
+  int rpc_reqs_per_segment_arg;	/* Requests each segment of the ring holds (0 = default) (default='0').  */
+  char * rpc_reqs_per_segment_orig;	/* Requests each segment of the ring holds (0 = default) original value given at command line.  */
+  const char *rpc_reqs_per_segment_help; /* Requests each segment of the ring holds (0 = default) help description.  */
   
   int help_given ;	/* Whether help was given.  */
   int version_given ;	/* Whether version was given.  */
@@ -88,6 +122,9 @@ struct gengetopt_args_info
   int authr_trace_given ;	/* Whether authr-trace was given.  */
   int authr_tracefile_given ;	/* Whether authr-tracefile was given.  */
   int authr_traceftype_given ;	/* Whether authr-traceftype was given.  */
+  int authr_share_key_given ;	/* Whether authr-share-key was given.  */
+  int authr_key_lifetime_given ;	/* Whether authr-key-lifetime was given.  */
+  int authr_key_holders_given ;	/* Whether authr-key-holders was given.  */
   int verbose_given ;	/* Whether verbose was given.  */
   int logfile_given ;	/* Whether logfile was given.  */
   int tp_init_thread_count_given ;	/* Whether tp-init-thread-count was given.  */
@@ -95,6 +132,15 @@ struct gengetopt_args_info
   int tp_max_thread_count_given ;	/* Whether tp-max-thread-count was given.  */
   int tp_low_watermark_given ;	/* Whether tp-low-watermark was given.  */
   int tp_high_watermark_given ;	/* Whether tp-high-watermark was given.  */
+  int tp_queue_high_watermark_given ;	/* Whether tp-queue-high-watermark was given.  */
+  int tp_queue_low_watermark_given ;	/* Whether tp-queue-low-watermark was given.  */
+  int tp_metadata_weight_given ;	/* Whether tp-metadata-weight was given.  */
+  int tp_bulk_weight_given ;	/* Whether tp-bulk-weight was given.  */
+  int tp_batch_size_given ;	/* Whether tp-batch-size was given.  */
+  int tp_pin_threads_given ;	/* Whether tp-pin-threads was given.  */
+  int max_mem_allowed_given ;	/* Whether max-mem-allowed was given.  */
+  int rpc_req_segments_given ;	/* Whether rpc-req-segments was given.  */
+  int rpc_reqs_per_segment_given ;	/* Whether rpc-reqs-per-segment was given.  */
 
 } ;
 
@@ -35,6 +35,7 @@
 #include "support/trace/trace.h"
 
 #include "support/sysmon/sysmon_opts.h"
+#include "server/rpc_server/rpc_server_opts.h"
 
 #include "common/types/types.h"
 #include "common/types/fprint_types.h"
@@ -42,6 +43,7 @@
 #include "common/rpc_common/lwfs_ptls.h"
 #include "common/rpc_common/ptl_wrap.h"
 #include "common/authr_common/authr_debug.h"
+#include "common/config_parser/config_parser.h"
 
 #include "server/rpc_server/rpc_server.h"
 
@@ -83,6 +85,11 @@ static void print_opts(
 			(args_info->authr_db_clear_flag)?"true":"false");
     fprintf(fp, "%s \tauthr-db-recover = %s\n", prefix, 
 			(args_info->authr_db_recover_flag)?"true":"false");
+    fprintf(fp, "%s \tauthr-share-key = %s\n", prefix, 
+			(args_info->authr_share_key_flag)?"true":"false");
+    fprintf(fp, "%s \tauthr-key-lifetime = %d\n", prefix, args_info->authr_key_lifetime_arg);
+    fprintf(fp, "%s \tauthr-key-holders = %s\n", prefix, 
+			(args_info->authr_key_holders_given)?args_info->authr_key_holders_arg:"none");
 
 	print_logger_opts(fp, args_info, prefix); 
 
@@ -91,12 +98,58 @@ static void print_opts(
     }
 
 	print_sysmon_opts(fp, args_info, prefix);
+	print_rpc_server_opts(fp, args_info, prefix);
 
     fprintf(fp, "%s -----------------------------------\n", prefix);
 }
 
 
 
+/**
+ * @brief Read the servers that may fetch the cap key. 
+ *
+ * The naming server and the storage servers of an LWFS config 
+ * file are the only services allowed to verify caps locally. 
+ */
+static int read_key_holders(
+		const char *fname, 
+		lwfs_remote_pid **ids, 
+		int *num_ids)
+{
+	int rc = LWFS_OK; 
+	int i; 
+	struct lwfs_config cfg; 
+
+	*ids = NULL; 
+	*num_ids = 0; 
+
+	memset(&cfg, 0, sizeof(struct lwfs_config)); 
+	rc = parse_lwfs_config_file(fname, &cfg); 
+	if (rc != LWFS_OK) {
+		log_error(authr_debug_level, "could not parse %s", fname);
+		return rc; 
+	}
+
+	*ids = (lwfs_remote_pid *)malloc((cfg.ss_num_servers+1)*sizeof(lwfs_remote_pid));
+	if (*ids == NULL) {
+		log_error(authr_debug_level, "could not allocate key holder ids");
+		rc = LWFS_ERR_NOSPACE; 
+		goto cleanup; 
+	}
+
+	(*ids)[0] = cfg.naming_id; 
+	for (i=0; i<cfg.ss_num_servers; i++) {
+		(*ids)[i+1] = cfg.ss_server_ids[i]; 
+	}
+	*num_ids = cfg.ss_num_servers+1; 
+
+cleanup:
+	lwfs_config_free(&cfg); 
+
+	return rc; 
+}
+
+
 /**
  * @brief The LWFS authorization server.
  */
@@ -105,6 +158,8 @@ int main(int argc, char **argv)
 	int rc = LWFS_OK; 
 	struct gengetopt_args_info args_info; 
 	int daemon_pid = 0;
+	lwfs_remote_pid *key_holders = NULL; 
+	int num_key_holders = 0; 
 
 	/* service descriptors (only need one) */
 	lwfs_service service;  
@@ -158,13 +213,28 @@ int main(int argc, char **argv)
 	/* print the arguments to standard out */
 	print_opts(logger_get_file(), &args_info, ""); 
 
+	/* servers that may verify caps with our key */
+	if (args_info.authr_key_holders_given) {
+		rc = read_key_holders(args_info.authr_key_holders_arg, 
+				&key_holders, &num_key_holders); 
+		if (rc != LWFS_OK) {
+			log_error(authr_debug_level, "could not read key holders");
+			return rc; 
+		}
+	}
+
 	/* initialize the auth server */
 	lwfs_authr_srvr_init(
 			args_info.authr_verify_caps_flag, 
 			args_info.authr_db_path_arg, 
 			args_info.authr_db_clear_flag, 
 			args_info.authr_db_recover_flag, 
+			args_info.authr_share_key_flag, 
+			args_info.authr_key_lifetime_arg, 
+			key_holders, 
+			num_key_holders, 
 			&service); 
+	if (key_holders) free(key_holders); 
 
 	/* start the server  */
 	log_debug(authr_debug_level, "starting server");
@@ -175,6 +245,9 @@ int main(int argc, char **argv)
 		max_mem_allowed = args_info.max_mem_allowed_arg;
 	}
 
+	lwfs_service_set_request_ring(args_info.rpc_req_segments_arg,
+			args_info.rpc_reqs_per_segment_arg);
+
 	if (logging_debug(authr_debug_level)) {
 		log_debug(authr_debug_level, "printing authr_svc");
 		fprint_lwfs_service(logger_get_file(), "authr_svc", "", &service); 
@@ -187,6 +260,12 @@ int main(int argc, char **argv)
 		tp_opts.max_thread_count = args_info.tp_max_thread_count_arg; 
 		tp_opts.low_watermark = args_info.tp_low_watermark_arg; 
 		tp_opts.high_watermark = args_info.tp_high_watermark_arg; 
+		tp_opts.queue_low_watermark = args_info.tp_queue_low_watermark_arg; 
+		tp_opts.queue_high_watermark = args_info.tp_queue_high_watermark_arg; 
+		tp_opts.metadata_weight = args_info.tp_metadata_weight_arg;
+		tp_opts.bulk_weight = args_info.tp_bulk_weight_arg;
+		tp_opts.batch_size = args_info.tp_batch_size_arg;
+		tp_opts.pin_threads = args_info.tp_pin_threads_flag;
 		rc = lwfs_service_start(&service, &tp_opts); 
 	}
 	else {
@@ -34,14 +34,24 @@ const char *gengetopt_args_info_help[] = {
   "      --naming-pid=INT          The process ID to use for the naming server  \n                                  (default=`126')",
   "      --naming-db-path=STRING   Path to the naming database  \n                                  (default=`naming.db')",
   "      --naming-db-clear         Clear the naming database before use  \n                                  (default=off)",
-  "      --naming-db-recover       Recover the naming database after a crash  \n                                  (default=off)",
+  "      --naming-db-recover       Run catastrophic recovery on the naming \n                                  database (normal recovery runs at every \n                                  start)  (default=off)",
+  "      --naming-local-caps       Verify caps with the key of the authr server \n                                  (requires authr-share-key)  (default=off)",
   "      --verbose=INT             Debug level of logger [0-5]  (default=`5')",
   "      --logfile=STRING          Path to logfile",
   "      --tp-init-thread-count=INT\n                                Initial number of thread in the pool  \n                                  (default=`1')",
   "      --tp-min-thread-count=INT Minimum number of thread in the pool  \n                                  (default=`1')",
-  "      --tp-max-thread-count=INT Maximum number of thread in the pool  \n                                  (default=`1')",
+  "      --tp-max-thread-count=INT Maximum number of thread in the pool  \n                                  (default=`999999999')",
   "      --tp-low-watermark=INT    Request queue size at which threads are removed \n                                  from the pool  (default=`1')",
-  "      --tp-high-watermark=INT   Request queue size at which threads are added \n                                  to the pool  (default=`1')",
+  "      --tp-high-watermark=INT   Request queue size at which threads are added \n                                  to the pool  (default=`999999999')",
+  "      --tp-queue-high-watermark=INT\n                                Request queue size at which the server turns \n                                  away new requests (0=default)  (default=`0')",
+  "      --tp-queue-low-watermark=INT\n                                Request queue size at which the pool accepts \n                                  requests again  (default=`0')",
+  "      --tp-metadata-weight=INT  Share of the threads for metadata requests \n                                  (0=default)  (default=`0')",
+  "      --tp-bulk-weight=INT      Share of the threads for bulk data requests \n                                  (0=default)  (default=`0')",
+  "      --tp-batch-size=INT       Requests a thread takes from the queue at once; \n                                  idle threads steal the rest (0=default)  \n                                  (default=`0')",
+  "      --tp-pin-threads          Run each thread on its own CPU  (default=off)",
+  "      --max-mem-allowed=INT     System memory usage in kilobytes above which \n                                  the server rejects new requests  (default=`0')",
+  "      --rpc-req-segments=INT    Segments in the ring of request buffers (0 = \n                                  default)  (default=`0')",
+  "      --rpc-reqs-per-segment=INT\n                                Requests each segment of the ring holds (0 = \n                                  default)  (default=`0')",
   "      --authr-pid=LONG          PID of the authr server  (default=`124')",
   "      --authr-nid=LONG          NID of the authr server  (default=`0')",
   "      --authr-cache-caps        Cache caps on the client  (default=off)",
@@ -96,6 +106,7 @@ void clear_given (struct gengetopt_args_info *args_info)
   args_info->naming_db_path_given = 0 ;
   args_info->naming_db_clear_given = 0 ;
   args_info->naming_db_recover_given = 0 ;
+  args_info->naming_local_caps_given = 0 ;
   args_info->verbose_given = 0 ;
   args_info->logfile_given = 0 ;
   args_info->tp_init_thread_count_given = 0 ;
@@ -103,6 +114,15 @@ void clear_given (struct gengetopt_args_info *args_info)
   args_info->tp_max_thread_count_given = 0 ;
   args_info->tp_low_watermark_given = 0 ;
   args_info->tp_high_watermark_given = 0 ;
+  args_info->tp_queue_high_watermark_given = 0 ;
+  args_info->tp_queue_low_watermark_given = 0 ;
+  args_info->tp_metadata_weight_given = 0 ;
+  args_info->tp_bulk_weight_given = 0 ;
+  args_info->tp_batch_size_given = 0 ;
+  args_info->tp_pin_threads_given = 0 ;
+  args_info->max_mem_allowed_given = 0 ;
+  args_info->rpc_req_segments_given = 0 ;
+  args_info->rpc_reqs_per_segment_given = 0 ;
   args_info->authr_pid_given = 0 ;
   args_info->authr_nid_given = 0 ;
   args_info->authr_cache_caps_given = 0 ;
@@ -121,6 +141,7 @@ void clear_args (struct gengetopt_args_info *args_info)
   args_info->naming_db_path_orig = NULL;
   args_info->naming_db_clear_flag = 0;
   args_info->naming_db_recover_flag = 0;
+  args_info->naming_local_caps_flag = 0;
   args_info->verbose_arg = 5;
   args_info->verbose_orig = NULL;
   args_info->logfile_arg = NULL;
@@ -129,12 +150,29 @@ void clear_args (struct gengetopt_args_info *args_info)
   args_info->tp_init_thread_count_orig = NULL;
   args_info->tp_min_thread_count_arg = 1;
   args_info->tp_min_thread_count_orig = NULL;
-  args_info->tp_max_thread_count_arg = 1;
+  args_info->tp_max_thread_count_arg = 999999999;
   args_info->tp_max_thread_count_orig = NULL;
   args_info->tp_low_watermark_arg = 1;
   args_info->tp_low_watermark_orig = NULL;
-  args_info->tp_high_watermark_arg = 1;
+  args_info->tp_high_watermark_arg = 999999999;
   args_info->tp_high_watermark_orig = NULL;
+  args_info->tp_queue_high_watermark_arg = 0;
+  args_info->tp_queue_high_watermark_orig = NULL;
+  args_info->tp_queue_low_watermark_arg = 0;
+  args_info->tp_queue_low_watermark_orig = NULL;
+  args_info->tp_metadata_weight_arg = 0;
+  args_info->tp_metadata_weight_orig = NULL;
+  args_info->tp_bulk_weight_arg = 0;
+  args_info->tp_bulk_weight_orig = NULL;
+  args_info->tp_batch_size_arg = 0;
+  args_info->tp_batch_size_orig = NULL;
+  args_info->tp_pin_threads_flag = 0;
+  args_info->max_mem_allowed_arg = 0;
+  args_info->max_mem_allowed_orig = NULL;
+  args_info->rpc_req_segments_arg = 0;
+  args_info->rpc_req_segments_orig = NULL;
+  args_info->rpc_reqs_per_segment_arg = 0;
+  args_info->rpc_reqs_per_segment_orig = NULL;
   args_info->authr_pid_arg = 124;
   args_info->authr_pid_orig = NULL;
   args_info->authr_nid_arg = 0;
@@ -155,16 +193,26 @@ void init_args_info(struct gengetopt_args_info *args_info)
   args_info->naming_db_path_help = gengetopt_args_info_help[6] ;
   args_info->naming_db_clear_help = gengetopt_args_info_help[7] ;
   args_info->naming_db_recover_help = gengetopt_args_info_help[8] ;
-  args_info->verbose_help = gengetopt_args_info_help[9] ;
-  args_info->logfile_help = gengetopt_args_info_help[10] ;
-  args_info->tp_init_thread_count_help = gengetopt_args_info_help[11] ;
-  args_info->tp_min_thread_count_help = gengetopt_args_info_help[12] ;
-  args_info->tp_max_thread_count_help = gengetopt_args_info_help[13] ;
-  args_info->tp_low_watermark_help = gengetopt_args_info_help[14] ;
-  args_info->tp_high_watermark_help = gengetopt_args_info_help[15] ;
-  args_info->authr_pid_help = gengetopt_args_info_help[16] ;
-  args_info->authr_nid_help = gengetopt_args_info_help[17] ;
-  args_info->authr_cache_caps_help = gengetopt_args_info_help[18] ;
+  args_info->naming_local_caps_help = gengetopt_args_info_help[9] ;
+  args_info->verbose_help = gengetopt_args_info_help[10] ;
+  args_info->logfile_help = gengetopt_args_info_help[11] ;
+  args_info->tp_init_thread_count_help = gengetopt_args_info_help[12] ;
+  args_info->tp_min_thread_count_help = gengetopt_args_info_help[13] ;
+  args_info->tp_max_thread_count_help = gengetopt_args_info_help[14] ;
+  args_info->tp_low_watermark_help = gengetopt_args_info_help[15] ;
+  args_info->tp_high_watermark_help = gengetopt_args_info_help[16] ;
+  args_info->tp_queue_high_watermark_help = gengetopt_args_info_help[17] ;
+  args_info->tp_queue_low_watermark_help = gengetopt_args_info_help[18] ;
+  args_info->tp_metadata_weight_help = gengetopt_args_info_help[19] ;
+  args_info->tp_bulk_weight_help = gengetopt_args_info_help[20] ;
+  args_info->tp_batch_size_help = gengetopt_args_info_help[21] ;
+  args_info->tp_pin_threads_help = gengetopt_args_info_help[22] ;
+  args_info->max_mem_allowed_help = gengetopt_args_info_help[23] ;
+  args_info->rpc_req_segments_help = gengetopt_args_info_help[24] ;
+  args_info->rpc_reqs_per_segment_help = gengetopt_args_info_help[25] ;
+  args_info->authr_pid_help = gengetopt_args_info_help[26] ;
+  args_info->authr_nid_help = gengetopt_args_info_help[27] ;
+  args_info->authr_cache_caps_help = gengetopt_args_info_help[28] ;
   
 }
 
@@ -260,6 +308,46 @@ cmdline_parser_release (struct gengetopt_args_info *args_info)
       free (args_info->tp_high_watermark_orig); /* free previous argument */
       args_info->tp_high_watermark_orig = 0;
     }
+  if (args_info->tp_queue_high_watermark_orig)
+    {
+      free (args_info->tp_queue_high_watermark_orig); /* free previous argument */
+      args_info->tp_queue_high_watermark_orig = 0;
+    }
+  if (args_info->tp_queue_low_watermark_orig)
+    {
+      free (args_info->tp_queue_low_watermark_orig); /* free previous argument */
+      args_info->tp_queue_low_watermark_orig = 0;
+    }
+  if (args_info->tp_metadata_weight_orig)
+    {
+      free (args_info->tp_metadata_weight_orig); /* free previous argument */
+      args_info->tp_metadata_weight_orig = 0;
+    }
+  if (args_info->tp_bulk_weight_orig)
+    {
+      free (args_info->tp_bulk_weight_orig); /* free previous argument */
+      args_info->tp_bulk_weight_orig = 0;
+    }
+  if (args_info->tp_batch_size_orig)
+    {
+      free (args_info->tp_batch_size_orig); /* free previous argument */
+      args_info->tp_batch_size_orig = 0;
+    }
+  if (args_info->max_mem_allowed_orig)
+    {
+      free (args_info->max_mem_allowed_orig); /* free previous argument */
+      args_info->max_mem_allowed_orig = 0;
+    }
+  if (args_info->rpc_req_segments_orig)
+    {
+      free (args_info->rpc_req_segments_orig); /* free previous argument */
+      args_info->rpc_req_segments_orig = 0;
+    }
+  if (args_info->rpc_reqs_per_segment_orig)
+    {
+      free (args_info->rpc_reqs_per_segment_orig); /* free previous argument */
+      args_info->rpc_reqs_per_segment_orig = 0;
+    }
   if (args_info->authr_pid_orig)
     {
       free (args_info->authr_pid_orig); /* free previous argument */
@@ -327,6 +415,9 @@ cmdline_parser_file_save(const char *filename, struct gengetopt_args_info *args_
   if (args_info->naming_db_recover_given) {
     fprintf(outfile, "%s\n", "naming-db-recover");
   }
+  if (args_info->naming_local_caps_given) {
+    fprintf(outfile, "%s\n", "naming-local-caps");
+  }
   if (args_info->verbose_given) {
     if (args_info->verbose_orig) {
       fprintf(outfile, "%s=\"%s\"\n", "verbose", args_info->verbose_orig);
@@ -376,6 +467,65 @@ cmdline_parser_file_save(const char *filename, struct gengetopt_args_info *args_
       fprintf(outfile, "%s\n", "tp-high-watermark");
     }
   }
+  if (args_info->tp_queue_high_watermark_given) {
+    if (args_info->tp_queue_high_watermark_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "tp-queue-high-watermark", args_info->tp_queue_high_watermark_orig);
+    } else {
+      fprintf(outfile, "%s\n", "tp-queue-high-watermark");
+    }
+  }
+  if (args_info->tp_queue_low_watermark_given) {
+    if (args_info->tp_queue_low_watermark_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "tp-queue-low-watermark", args_info->tp_queue_low_watermark_orig);
+    } else {
+      fprintf(outfile, "%s\n", "tp-queue-low-watermark");
+    }
+  }
+  if (args_info->tp_metadata_weight_given) {
+    if (args_info->tp_metadata_weight_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "tp-metadata-weight", args_info->tp_metadata_weight_orig);
+    } else {
+      fprintf(outfile, "%s\n", "tp-metadata-weight");
+    }
+  }
+  if (args_info->tp_bulk_weight_given) {
+    if (args_info->tp_bulk_weight_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "tp-bulk-weight", args_info->tp_bulk_weight_orig);
+    } else {
+      fprintf(outfile, "%s\n", "tp-bulk-weight");
+    }
+  }
+  if (args_info->tp_batch_size_given) {
+    if (args_info->tp_batch_size_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "tp-batch-size", args_info->tp_batch_size_orig);
+    } else {
+      fprintf(outfile, "%s\n", "tp-batch-size");
+    }
+  }
+  if (args_info->tp_pin_threads_given) {
+    fprintf(outfile, "%s\n", "tp-pin-threads");
+  }
+  if (args_info->max_mem_allowed_given) {
+    if (args_info->max_mem_allowed_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "max-mem-allowed", args_info->max_mem_allowed_orig);
+    } else {
+      fprintf(outfile, "%s\n", "max-mem-allowed");
+    }
+  }
+  if (args_info->rpc_req_segments_given) {
+    if (args_info->rpc_req_segments_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "rpc-req-segments", args_info->rpc_req_segments_orig);
+    } else {
+      fprintf(outfile, "%s\n", "rpc-req-segments");
+    }
+  }
+  if (args_info->rpc_reqs_per_segment_given) {
+    if (args_info->rpc_reqs_per_segment_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "rpc-reqs-per-segment", args_info->rpc_reqs_per_segment_orig);
+    } else {
+      fprintf(outfile, "%s\n", "rpc-reqs-per-segment");
+    }
+  }
   if (args_info->authr_pid_given) {
     if (args_info->authr_pid_orig) {
       fprintf(outfile, "%s=\"%s\"\n", "authr-pid", args_info->authr_pid_orig);
@@ -484,6 +634,7 @@ cmdline_parser_internal (int argc, char * const *argv, struct gengetopt_args_inf
         { "naming-db-path",	1, NULL, 0 },
         { "naming-db-clear",	0, NULL, 0 },
         { "naming-db-recover",	0, NULL, 0 },
+        { "naming-local-caps",	0, NULL, 0 },
         { "verbose",	1, NULL, 0 },
         { "logfile",	1, NULL, 0 },
         { "tp-init-thread-count",	1, NULL, 0 },
@@ -491,6 +642,15 @@ cmdline_parser_internal (int argc, char * const *argv, struct gengetopt_args_inf
         { "tp-max-thread-count",	1, NULL, 0 },
         { "tp-low-watermark",	1, NULL, 0 },
         { "tp-high-watermark",	1, NULL, 0 },
+        { "tp-queue-high-watermark",	1, NULL, 0 },
+        { "tp-queue-low-watermark",	1, NULL, 0 },
+        { "tp-metadata-weight",	1, NULL, 0 },
+        { "tp-bulk-weight",	1, NULL, 0 },
+        { "tp-batch-size",	1, NULL, 0 },
+        { "tp-pin-threads",	0, NULL, 0 },
+        { "max-mem-allowed",	1, NULL, 0 },
+        { "rpc-req-segments",	1, NULL, 0 },
+        { "rpc-reqs-per-segment",	1, NULL, 0 },
         { "authr-pid",	1, NULL, 0 },
         { "authr-nid",	1, NULL, 0 },
         { "authr-cache-caps",	0, NULL, 0 },
@@ -619,7 +779,7 @@ cmdline_parser_internal (int argc, char * const *argv, struct gengetopt_args_inf
             args_info->naming_db_clear_given = 1;
             args_info->naming_db_clear_flag = !(args_info->naming_db_clear_flag);
           }
-          /* Recover the naming database after a crash.  */
+          /* Run catastrophic recovery on the naming database (normal recovery runs at every start).  */
           else if (strcmp (long_options[option_index].name, "naming-db-recover") == 0)
           {
             if (local_args_info.naming_db_recover_given)
@@ -633,6 +793,20 @@ cmdline_parser_internal (int argc, char * const *argv, struct gengetopt_args_inf
             args_info->naming_db_recover_given = 1;
             args_info->naming_db_recover_flag = !(args_info->naming_db_recover_flag);
           }
+          /* Verify caps with the key of the authr server (requires authr-share-key).  */
+          else if (strcmp (long_options[option_index].name, "naming-local-caps") == 0)
+          {
+            if (local_args_info.naming_local_caps_given)
+              {
+                fprintf (stderr, "%s: `--naming-local-caps' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->naming_local_caps_given && ! override)
+              continue;
+            local_args_info.naming_local_caps_given = 1;
+            args_info->naming_local_caps_given = 1;
+            args_info->naming_local_caps_flag = !(args_info->naming_local_caps_flag);
+          }
           /* Debug level of logger [0-5].  */
           else if (strcmp (long_options[option_index].name, "verbose") == 0)
           {
@@ -778,6 +952,188 @@ cmdline_parser_internal (int argc, char * const *argv, struct gengetopt_args_inf
               free (args_info->tp_high_watermark_orig); /* free previous string */
             args_info->tp_high_watermark_orig = gengetopt_strdup (optarg);
           }
+          /* Request queue size at which the server turns away new requests (0=default).  */
+          else if (strcmp (long_options[option_index].name, "tp-queue-high-watermark") == 0)
+          {
+            if (local_args_info.tp_queue_high_watermark_given)
+              {
+                fprintf (stderr, "%s: `--tp-queue-high-watermark' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->tp_queue_high_watermark_given && ! override)
+              continue;
+            local_args_info.tp_queue_high_watermark_given = 1;
+            args_info->tp_queue_high_watermark_given = 1;
+            args_info->tp_queue_high_watermark_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->tp_queue_high_watermark_orig)
+              free (args_info->tp_queue_high_watermark_orig); /* free previous string */
+            args_info->tp_queue_high_watermark_orig = gengetopt_strdup (optarg);
+          }
+          /* Request queue size at which the pool accepts requests again.  */
+          else if (strcmp (long_options[option_index].name, "tp-queue-low-watermark") == 0)
+          {
+            if (local_args_info.tp_queue_low_watermark_given)
+              {
+                fprintf (stderr, "%s: `--tp-queue-low-watermark' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->tp_queue_low_watermark_given && ! override)
+              continue;
+            local_args_info.tp_queue_low_watermark_given = 1;
+            args_info->tp_queue_low_watermark_given = 1;
+            args_info->tp_queue_low_watermark_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->tp_queue_low_watermark_orig)
+              free (args_info->tp_queue_low_watermark_orig); /* free previous string */
+            args_info->tp_queue_low_watermark_orig = gengetopt_strdup (optarg);
+          }
+          /* Share of the threads for metadata requests (0=default).  */
+          else if (strcmp (long_options[option_index].name, "tp-metadata-weight") == 0)
+          {
+            if (local_args_info.tp_metadata_weight_given)
+              {
+                fprintf (stderr, "%s: `--tp-metadata-weight' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->tp_metadata_weight_given && ! override)
+              continue;
+            local_args_info.tp_metadata_weight_given = 1;
+            args_info->tp_metadata_weight_given = 1;
+            args_info->tp_metadata_weight_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->tp_metadata_weight_orig)
+              free (args_info->tp_metadata_weight_orig); /* free previous string */
+            args_info->tp_metadata_weight_orig = gengetopt_strdup (optarg);
+          }
+          /* Share of the threads for bulk data requests (0=default).  */
+          else if (strcmp (long_options[option_index].name, "tp-bulk-weight") == 0)
+          {
+            if (local_args_info.tp_bulk_weight_given)
+              {
+                fprintf (stderr, "%s: `--tp-bulk-weight' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->tp_bulk_weight_given && ! override)
+              continue;
+            local_args_info.tp_bulk_weight_given = 1;
+            args_info->tp_bulk_weight_given = 1;
+            args_info->tp_bulk_weight_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->tp_bulk_weight_orig)
+              free (args_info->tp_bulk_weight_orig); /* free previous string */
+            args_info->tp_bulk_weight_orig = gengetopt_strdup (optarg);
+          }
+          /* Requests a thread takes from the queue at once; idle threads steal the rest (0=default).  */
+          else if (strcmp (long_options[option_index].name, "tp-batch-size") == 0)
+          {
+            if (local_args_info.tp_batch_size_given)
+              {
+                fprintf (stderr, "%s: `--tp-batch-size' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->tp_batch_size_given && ! override)
+              continue;
+            local_args_info.tp_batch_size_given = 1;
+            args_info->tp_batch_size_given = 1;
+            args_info->tp_batch_size_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->tp_batch_size_orig)
+              free (args_info->tp_batch_size_orig); /* free previous string */
+            args_info->tp_batch_size_orig = gengetopt_strdup (optarg);
+          }
+          /* Run each thread on its own CPU.  */
+          else if (strcmp (long_options[option_index].name, "tp-pin-threads") == 0)
+          {
+            if (local_args_info.tp_pin_threads_given)
+              {
+                fprintf (stderr, "%s: `--tp-pin-threads' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->tp_pin_threads_given && ! override)
+              continue;
+            local_args_info.tp_pin_threads_given = 1;
+            args_info->tp_pin_threads_given = 1;
+            args_info->tp_pin_threads_flag = !(args_info->tp_pin_threads_flag);
+          }
+          /* System memory usage in kilobytes above which the server rejects new requests.  */
+          else if (strcmp (long_options[option_index].name, "max-mem-allowed") == 0)
+          {
+            if (local_args_info.max_mem_allowed_given)
+              {
+                fprintf (stderr, "%s: `--max-mem-allowed' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->max_mem_allowed_given && ! override)
+              continue;
+            local_args_info.max_mem_allowed_given = 1;
+            args_info->max_mem_allowed_given = 1;
+            args_info->max_mem_allowed_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->max_mem_allowed_orig)
+              free (args_info->max_mem_allowed_orig); /* free previous string */
+            args_info->max_mem_allowed_orig = gengetopt_strdup (optarg);
+          }
+          /* Segments in the ring of request buffers (0 = default).  */
+          else if (strcmp (long_options[option_index].name, "rpc-req-segments") == 0)
+          {
+            if (local_args_info.rpc_req_segments_given)
+              {
+                fprintf (stderr, "%s: `--rpc-req-segments' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->rpc_req_segments_given && ! override)
+              continue;
+            local_args_info.rpc_req_segments_given = 1;
+            args_info->rpc_req_segments_given = 1;
+            args_info->rpc_req_segments_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->rpc_req_segments_orig)
+              free (args_info->rpc_req_segments_orig); /* free previous string */
+            args_info->rpc_req_segments_orig = gengetopt_strdup (optarg);
+          }
+          /* Requests each segment of the ring holds (0 = default).  */
+          else if (strcmp (long_options[option_index].name, "rpc-reqs-per-segment") == 0)
+          {
+            if (local_args_info.rpc_reqs_per_segment_given)
+              {
+                fprintf (stderr, "%s: `--rpc-reqs-per-segment' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->rpc_reqs_per_segment_given && ! override)
+              continue;
+            local_args_info.rpc_reqs_per_segment_given = 1;
+            args_info->rpc_reqs_per_segment_given = 1;
+            args_info->rpc_reqs_per_segment_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->rpc_reqs_per_segment_orig)
+              free (args_info->rpc_reqs_per_segment_orig); /* free previous string */
+            args_info->rpc_reqs_per_segment_orig = gengetopt_strdup (optarg);
+          }
           /* PID of the authr server.  */
           else if (strcmp (long_options[option_index].name, "authr-pid") == 0)
           {
@@ -41,8 +41,10 @@ struct gengetopt_args_info
   const char *naming_db_path_help; /* Path to the naming database help description.  */
   int naming_db_clear_flag;	/* Clear the naming database before use (default=off).  */
   const char *naming_db_clear_help; /* Clear the naming database before use help description.  */
-  int naming_db_recover_flag;	/* Recover the naming database after a crash (default=off).  */
-  const char *naming_db_recover_help; /* Recover the naming database after a crash help description.  */
+  int naming_db_recover_flag;	/* Run catastrophic recovery on the naming database (normal recovery runs at every start) (default=off).  */
+  const char *naming_db_recover_help; /* Run catastrophic recovery on the naming database (normal recovery runs at every start) help description.  */
+  int naming_local_caps_flag;	/* Verify caps with the key of the authr server (requires authr-share-key) (default=off).  */
+  const char *naming_local_caps_help; /* Verify caps with the key of the authr server (requires authr-share-key) help description.  */
   int verbose_arg;	/* Debug level of logger [0-5] (default='5').  */
   char * verbose_orig;	/* Debug level of logger [0-5] original value given at command line.  */
   const char *verbose_help; /* Debug level of logger [0-5] help description.  */
@@ -55,15 +57,41 @@ struct gengetopt_args_info
   int tp_min_thread_count_arg;	/* Minimum number of thread in the pool (default='1').  */
   char * tp_min_thread_count_orig;	/* Minimum number of thread in the pool original value given at command line.  */
   const char *tp_min_thread_count_help; /* Minimum number of thread in the pool help description.  */
-  int tp_max_thread_count_arg;	/* Maximum number of thread in the pool (default='1').  */
+  int tp_max_thread_count_arg;	/* Maximum number of thread in the pool (default='999999999').  */
   char * tp_max_thread_count_orig;	/* Maximum number of thread in the pool original value given at command line.  */
   const char *tp_max_thread_count_help; /* Maximum number of thread in the pool help description.  */
   int tp_low_watermark_arg;	/* Request queue size at which threads are removed from the pool (default='1').  */
   char * tp_low_watermark_orig;	/* Request queue size at which threads are removed from the pool original value given at command line.  */
   const char *tp_low_watermark_help; /* Request queue size at which threads are removed from the pool help description.  */
-  int tp_high_watermark_arg;	/* Request queue size at which threads are added to the pool (default='1').  */
+  int tp_high_watermark_arg;	/* Request queue size at which threads are added to the pool (default='999999999').  */
   char * tp_high_watermark_orig;	/* Request queue size at which threads are added to the pool original value given at command line.  */
   const char *tp_high_watermark_help; /* Request queue size at which threads are added to the pool help description.  */
+  int tp_queue_high_watermark_arg;	/* Request queue size at which the server turns away new requests (0=default) (default='0').  */
+  char * tp_queue_high_watermark_orig;	/* Request queue size at which the server turns away new requests (0=default) original value given at command line.  */
+  const char *tp_queue_high_watermark_help; /* Request queue size at which the server turns away new requests (0=default) help description.  */
+  int tp_queue_low_watermark_arg;	/* Request queue size at which the pool accepts requests again (default='0').  */
+  char * tp_queue_low_watermark_orig;	/* Request queue size at which the pool accepts requests again original value given at command line.  */
+  const char *tp_queue_low_watermark_help; /* Request queue size at which the pool accepts requests again help description.  */
+  int tp_metadata_weight_arg;	/* Share of the threads for metadata requests (0=default) (default='0').  */
+  char * tp_metadata_weight_orig;	/* Share of the threads for metadata requests (0=default) original value given at command line.  */
+  const char *tp_metadata_weight_help; /* Share of the threads for metadata requests (0=default) help description.  */
+  int tp_bulk_weight_arg;	/* Share of the threads for bulk data requests (0=default) (default='0').  */
+  char * tp_bulk_weight_orig;	/* Share of the threads for bulk data requests (0=default) original value given at command line.  */
+  const char *tp_bulk_weight_help; /* Share of the threads for bulk data requests (0=default) help description.  */
+  int tp_batch_size_arg;	/* Requests a thread takes from the queue at once; idle threads steal the rest (0=default) (default='0').  */
+  char * tp_batch_size_orig;	/* Requests a thread takes from the queue at once; idle threads steal the rest (0=default) original value given at command line.  */
+  const char *tp_batch_size_help; /* Requests a thread takes from the queue at once; idle threads steal the rest (0=default) help description.  */
+  int tp_pin_threads_flag;	/* Run each thread on its own CPU (default=off).  */
+  const char *tp_pin_threads_help; /* Run each thread on its own CPU help description.  */
+  int max_mem_allowed_arg;	/* System memory usage in kilobytes above which the server rejects new requests (default='0').  */
+  char * max_mem_allowed_orig;	/* System memory usage in kilobytes above which the server rejects new requests original value given at command line.  */
+  const char *max_mem_allowed_help; /* System memory usage in kilobytes above which the server rejects new requests help description.  */
+  int rpc_req_segments_arg;	/* Segments in the ring of request buffers (0 = default) (default='0').  */
+  char * rpc_req_segments_orig;	/* Segments in the ring of request buffers (0 = default) original value given at command line.  */
+  const char *rpc_req_segments_help; /* Segments in the ring of request buffers (0 = default) help description.  */
+  int rpc_reqs_per_segment_arg;	/* Requests each segment of the ring holds (0 = default) (default='0').  */
+  char * rpc_reqs_per_segment_orig;	/* Requests each segment of the ring holds (0 = default) original value given at command line.  */
+  const char *rpc_reqs_per_segment_help; /* Requests each segment of the ring holds (0 = default) help description.  */
   long authr_pid_arg;	/* PID of the authr server (default='124').  */
   char * authr_pid_orig;	/* PID of the authr server original value given at command line.  */
   const char *authr_pid_help; /* PID of the authr server help description.  */
@@ -82,6 +110,7 @@ struct gengetopt_args_info
   int naming_db_path_given ;	/* Whether naming-db-path was given.  */
   int naming_db_clear_given ;	/* Whether naming-db-clear was given.  */
   int naming_db_recover_given ;	/* Whether naming-db-recover was given.  */
+  int naming_local_caps_given ;	/* Whether naming-local-caps was given.  */
   int verbose_given ;	/* Whether verbose was given.  */
   int logfile_given ;	/* Whether logfile was given.  */
   int tp_init_thread_count_given ;	/* Whether tp-init-thread-count was given.  */
@@ -89,6 +118,15 @@ struct gengetopt_args_info
   int tp_max_thread_count_given ;	/* Whether tp-max-thread-count was given.  */
   int tp_low_watermark_given ;	/* Whether tp-low-watermark was given.  */
   int tp_high_watermark_given ;	/* Whether tp-high-watermark was given.  */
+  int tp_queue_high_watermark_given ;	/* Whether tp-queue-high-watermark was given.  */
+  int tp_queue_low_watermark_given ;	/* Whether tp-queue-low-watermark was given.  */
+  int tp_metadata_weight_given ;	/* Whether tp-metadata-weight was given.  */
+  int tp_bulk_weight_given ;	/* Whether tp-bulk-weight was given.  */
+  int tp_batch_size_given ;	/* Whether tp-batch-size was given.  */
+  int tp_pin_threads_given ;	/* Whether tp-pin-threads was given.  */
+  int max_mem_allowed_given ;	/* Whether max-mem-allowed was given.  */
+  int rpc_req_segments_given ;	/* Whether rpc-req-segments was given.  */
+  int rpc_reqs_per_segment_given ;	/* Whether rpc-reqs-per-segment was given.  */
   int authr_pid_given ;	/* Whether authr-pid was given.  */
   int authr_nid_given ;	/* Whether authr-nid was given.  */
   int authr_cache_caps_given ;	/* Whether authr-cache-caps was given.  */
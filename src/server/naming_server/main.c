@@ -33,6 +33,7 @@
 #include "support/logger/logger_opts.h"
 #include "support/threadpool/threadpool_opts.h"
 #include "support/sysmon/sysmon_opts.h"
+#include "server/rpc_server/rpc_server_opts.h"
 
 
 #include "common/rpc_common/lwfs_ptls.h"
@@ -65,6 +66,7 @@ static int print_args(
 	print_naming_server_opts(fp, args_info, prefix); 
 
 	print_sysmon_opts(fp, args_info, prefix);
+	print_rpc_server_opts(fp, args_info, prefix);
 
 	fprintf(fp, "%s -----------------------------------\n", prefix);
 
@@ -140,6 +142,7 @@ int main(int argc, char **argv)
 			args_info.naming_db_path_arg, 
 			args_info.naming_db_clear_flag, 
 			args_info.naming_db_recover_flag,
+			args_info.naming_local_caps_flag,
 			&authr_svc, 
 			&naming_svc); 
 	if (rc != LWFS_OK) {
@@ -159,6 +162,9 @@ int main(int argc, char **argv)
 		max_mem_allowed = args_info.max_mem_allowed_arg;
 	}
 
+	lwfs_service_set_request_ring(args_info.rpc_req_segments_arg,
+			args_info.rpc_reqs_per_segment_arg);
+
 	if (args_info.use_threads_flag) {
 		lwfs_thread_pool_args tp_opts; 
 		tp_opts.initial_thread_count = args_info.tp_init_thread_count_arg; 
@@ -166,6 +172,12 @@ int main(int argc, char **argv)
 		tp_opts.max_thread_count = args_info.tp_max_thread_count_arg; 
 		tp_opts.low_watermark = args_info.tp_low_watermark_arg; 
 		tp_opts.high_watermark = args_info.tp_high_watermark_arg;
+		tp_opts.queue_low_watermark = args_info.tp_queue_low_watermark_arg; 
+		tp_opts.queue_high_watermark = args_info.tp_queue_high_watermark_arg;
+		tp_opts.metadata_weight = args_info.tp_metadata_weight_arg;
+		tp_opts.bulk_weight = args_info.tp_bulk_weight_arg;
+		tp_opts.batch_size = args_info.tp_batch_size_arg;
+		tp_opts.pin_threads = args_info.tp_pin_threads_flag;
 		rc = lwfs_service_start(&naming_svc, &tp_opts);
 	}
 	else {
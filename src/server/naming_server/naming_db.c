@@ -11,6 +11,12 @@
 
 #include <db.h>
 #include <unistd.h>
+#include <fnmatch.h>
+#include <errno.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/types.h>
 
 #if STDC_HEADERS
 #include <string.h>
@@ -29,6 +35,7 @@
 
 /* ----------------- global variables and structs ------------------*/
 
+static DB_ENV *dbenv;
 static DB *dbp1;
 static DB *dbp2;
 static DB *dbp3;
@@ -38,6 +45,63 @@ static const char *GLOBAL_DB_KEY = "The latest generated ID";
 static const char *DB2_NAME_EXTENSION = ".2nd";
 static const char *DB3_NAME_EXTENSION = ".3rd";
 static const char *INODE_NAME_EXTENSION = ".inode";
+static const char *ENV_NAME_EXTENSION = ".env";
+
+/* size of the shared buffer pool of the environment */
+#define NAMING_DB_CACHE_SIZE (32*1024*1024)
+
+/* size of the in-memory log buffer (holds the commits of a group) */
+#define NAMING_DB_LOG_BUFFER_SIZE (1024*1024)
+
+/* checkpoint after this much log (KB) */
+#define NAMING_DB_CHECKPOINT_KBYTES 1024
+
+/* times we retry a mutation that lost a deadlock */
+#define NAMING_DB_TXN_RETRIES 8
+
+/**
+ * @brief The transaction of the mutation a thread is running.
+ *
+ * Every DB call made while a mutation runs has to use its
+ * transaction, so we keep it in thread-specific data instead
+ * of passing it down through all the helpers.
+ */
+typedef struct {
+	DB_TXN *txn;
+
+	/** @brief A DB call in the transaction lost a deadlock. */
+	lwfs_bool deadlock;
+} txn_state;
+
+static pthread_key_t txn_key;
+
+/* one writer at a time (readers do not take it) */
+static pthread_mutex_t write_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief State of the group commit.
+ *
+ * Writers commit without flushing the log.  The first one to
+ * need a flush does it for every commit made so far, while the
+ * others wait for it (and whoever commits during the flush is
+ * in the next group).
+ */
+static struct {
+	pthread_mutex_t mutex;
+	pthread_cond_t flushed;
+
+	/** @brief Transactions committed (in the log buffer). */
+	unsigned long committed;
+
+	/** @brief Transactions on disk. */
+	unsigned long durable;
+
+	/** @brief A flush is running. */
+	lwfs_bool flushing;
+
+	/** @brief Number of log flushes. */
+	unsigned long flushes;
+} group = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0, 0, FALSE, 0};
 
 static lwfs_oid ORPHAN_OID;
 
@@ -118,6 +182,15 @@ static int db3_size(
 	const db3_key *key,
 	db_recno_t *result);
 
+static int db3_get_page(
+	const db3_key *key,
+	const char *cookie,
+	const char *pattern,
+	naming_db_dirent *result,
+	const int maxlen,
+	int *count,
+	lwfs_bool *eof);
+
 
 /* methods for inode */
 
@@ -155,6 +228,23 @@ static int pto3rd(
 	const DBT *pdata,
 	DBT *skey);
 
+/* methods for transactions */
+
+static DB_TXN *cur_txn();
+
+static int txn_note(
+	const int dbrc);
+
+static int txn_begin(
+	txn_state *state);
+
+static int txn_end(
+	txn_state *state,
+	const int rc,
+	lwfs_bool *retry);
+
+static int group_commit();
+
 /* util methods */
 
 static int create_entry(const naming_db_dirent *dirent,
@@ -164,6 +254,199 @@ static int create_entry(const naming_db_dirent *dirent,
 
 /* ----------------- private method definitions ----------------------*/
 
+/* ----------- Methods for transactions ------------- */
+
+/**
+ * @brief The transaction of the calling thread (NULL outside a mutation).
+ */
+static DB_TXN *cur_txn()
+{
+	txn_state *state = (txn_state *)pthread_getspecific(txn_key);
+
+	return (state == NULL) ? NULL : state->txn;
+}
+
+/**
+ * @brief Note a lost deadlock in the transaction of the calling thread.
+ *
+ * @param dbrc  @input the result of a DB call.
+ *
+ * @returns \em dbrc.
+ */
+static int txn_note(
+	const int dbrc)
+{
+	txn_state *state;
+
+	if (dbrc == DB_LOCK_DEADLOCK) {
+		state = (txn_state *)pthread_getspecific(txn_key);
+		if (state != NULL) {
+			state->deadlock = TRUE;
+		}
+	}
+
+	return dbrc;
+}
+
+/**
+ * @brief Start the transaction of a mutation.
+ *
+ * Mutations run one at a time; the transaction keeps the
+ * write lock until \ref txn_end.
+ *
+ * @param state  @output the transaction.
+ */
+static int txn_begin(
+	txn_state *state)
+{
+	int rc = LWFS_OK;
+
+	memset(state, 0, sizeof(txn_state));
+
+	pthread_mutex_lock(&write_mutex);
+
+	rc = dbenv->txn_begin(dbenv, NULL, &state->txn, 0);
+	if (rc != 0) {
+		log_error(naming_debug_level, "unable to begin transaction: %s",
+				db_strerror(rc));
+		pthread_mutex_unlock(&write_mutex);
+		return LWFS_ERR_NAMING;
+	}
+
+	pthread_setspecific(txn_key, state);
+
+	return rc;
+}
+
+/**
+ * @brief Commit (or abort) the transaction of a mutation.
+ *
+ * A commit only goes to the log buffer here.  We let go of
+ * the write lock before we wait for the log to reach the disk,
+ * so the next mutations can commit in the same flush.
+ *
+ * @param state  @input the transaction.
+ * @param rc     @input result of the mutation (abort if not \ref LWFS_OK).
+ * @param retry  @output TRUE if the mutation lost a deadlock and
+ *                       should run again.
+ *
+ * @returns \em rc, or \ref LWFS_ERR_NAMING if the commit failed.
+ */
+static int txn_end(
+	txn_state *state,
+	const int rc,
+	lwfs_bool *retry)
+{
+	int result = rc;
+	int dbrc;
+
+	pthread_setspecific(txn_key, NULL);
+
+	if (rc == LWFS_OK) {
+		dbrc = state->txn->commit(state->txn, DB_TXN_NOSYNC);
+		if (dbrc != 0) {
+			log_error(naming_debug_level, "unable to commit transaction: %s",
+					db_strerror(dbrc));
+			txn_note(dbrc);
+			result = LWFS_ERR_NAMING;
+		}
+	} else {
+		dbrc = state->txn->abort(state->txn);
+		if (dbrc != 0) {
+			log_error(naming_debug_level, "unable to abort transaction: %s",
+					db_strerror(dbrc));
+		}
+	}
+	state->txn = NULL;
+
+	pthread_mutex_unlock(&write_mutex);
+
+	*retry = (result != LWFS_OK) && state->deadlock;
+	if (*retry) {
+		log_debug(naming_debug_level, "transaction lost a deadlock, retrying");
+	}
+
+	/* wait until the commit is on disk */
+	if (result == LWFS_OK) {
+		result = group_commit();
+	}
+
+	return result;
+}
+
+/**
+ * @brief Wait until the last commit of the calling thread is on disk.
+ *
+ * If no flush is running, the caller flushes the log for every 
+ * transaction committed so far.  Otherwise it waits for the running 
+ * flush, and one of the threads that committed after that flush 
+ * started runs the next one.  One fsync serves every mutation that 
+ * committed while the previous one ran.
+ *
+ * A failed flush aborts the server (see the comment below).
+ */
+static int group_commit()
+{
+	int rc = LWFS_OK;
+	int dbrc;
+	unsigned long mine;
+	unsigned long target;
+	lwfs_bool leader = FALSE;
+
+	pthread_mutex_lock(&group.mutex);
+
+	mine = ++group.committed;
+
+	while (group.durable < mine) {
+
+		if (group.flushing) {
+			pthread_cond_wait(&group.flushed, &group.mutex);
+			continue;
+		}
+
+		/* flush the log for everybody that committed so far */
+		group.flushing = TRUE;
+		target = group.committed;
+		pthread_mutex_unlock(&group.mutex);
+
+		dbrc = dbenv->log_flush(dbenv, NULL);
+
+		pthread_mutex_lock(&group.mutex);
+		group.flushing = FALSE;
+		if (dbrc == 0) {
+			group.durable = target;
+			group.flushes++;
+			leader = TRUE;
+		}
+		pthread_cond_broadcast(&group.flushed);
+
+		/* The transactions of this group are committed and visible 
+		 * to other clients, but not on disk.  Returning an error 
+		 * would make clients retry a mutation that may or may not 
+		 * survive a crash, so stop here and let the restart run 
+		 * recovery. */
+		if (dbrc != 0) {
+			log_fatal(naming_debug_level, "unable to flush the log: %s",
+					db_strerror(dbrc));
+			abort();
+		}
+	}
+
+	pthread_mutex_unlock(&group.mutex);
+
+	/* checkpoint once enough log piled up (keeps recovery short) */
+	if (leader) {
+		dbrc = dbenv->txn_checkpoint(dbenv, NAMING_DB_CHECKPOINT_KBYTES, 0, 0);
+		if (dbrc != 0) {
+			log_warn(naming_debug_level, "unable to checkpoint: %s",
+					db_strerror(dbrc));
+		}
+	}
+
+	return rc;
+}
+
+
 static const char *db1_keystr(
 		const db1_key *key)
 {
@@ -375,7 +658,7 @@ static lwfs_bool db1_exists(
 	data.dlen = 0;
 	data.flags = DB_DBT_PARTIAL;
 
-	rc = dbp1->get(dbp1, NULL, &key, &data, 0);
+	rc = txn_note(dbp1->get(dbp1, cur_txn(), &key, &data, 0));
 	switch (rc) {
 		case 0:
 			/* entry found */
@@ -420,7 +703,7 @@ static int db1_put(
     data.size = sizeof(naming_db_dirent);
 
     /* Put the entry in the primary database. */
-    rc = dbp1->put(dbp1, NULL, &key, &data, flags);
+    rc = txn_note(dbp1->put(dbp1, cur_txn(), &key, &data, flags));
     if (rc == DB_KEYEXIST) {
 	/*
 	   log_error(naming_debug_level, "could not put entry in db1: %s",
@@ -434,9 +717,7 @@ static int db1_put(
 	return LWFS_ERR_NAMING;
     }
 
-    /* sync the database */
-    /*rc = dbp1->sync(dbp1, 0);
-     */
+    /* no sync: the transaction log is the commit point (see txn_end) */
 
 
     return rc;
@@ -460,7 +741,7 @@ static int db1_print_all()
 	
 
 	/* acquire a cursor for database 1 */
-	rc = dbp1->cursor(dbp1, NULL, &dbc, 0);
+	rc = dbp1->cursor(dbp1, cur_txn(), &dbc, 0);
 	if (rc != 0) {
 		log_error(naming_debug_level, "could not get cursor for db1: %s",
 				db_strerror(rc));
@@ -542,7 +823,7 @@ static int db1_get(
 	data.ulen = sizeof(naming_db_dirent);
 	data.flags = DB_DBT_USERMEM;
 
-	rc = dbp1->get(dbp1, NULL, &key, &data, 0);
+	rc = txn_note(dbp1->get(dbp1, cur_txn(), &key, &data, 0));
 	switch (rc) {
 		case 0:
 			/* entry found */
@@ -618,7 +899,7 @@ static int db2_get(
 	data.ulen = sizeof(naming_db_dirent);
 	data.flags = DB_DBT_USERMEM;
 
-	rc = dbp2->get(dbp2, NULL, &key, &data, 0);
+	rc = txn_note(dbp2->get(dbp2, cur_txn(), &key, &data, 0));
 	if (rc != LWFS_OK) {
 		log_error(naming_debug_level, "unable to get entry (%s): %s",
 				db2_keystr(key2), db_strerror(rc));
@@ -653,7 +934,7 @@ static int db_del(
 
 
 	/* delete the entry from the database (may re-insert it as an orphan later) */
-	rc = dbp2->del(dbp2, NULL, &key, 0);
+	rc = txn_note(dbp2->del(dbp2, cur_txn(), &key, 0));
 	if (rc != LWFS_OK) {
 		log_error(naming_debug_level, "unable to remove entry: %s",
 				db_strerror(rc));
@@ -664,11 +945,11 @@ static int db_del(
 	
 	if (entry->inode.ref_cnt == 0) {
 		/* the dearly departed dirent was the last ref to this inode, remove the inode */
-		inode_del(&entry->inode);
+		rc = inode_del(&entry->inode);
 	} else if (entry->inode.ref_cnt > 0) {
 		/* other inode refs exists.  update inode ref count. */
 		inode_keygen((const lwfs_oid *)&entry->inode.entry_obj.oid, &ikey);
-		inode_put(&ikey, &entry->inode, 0);
+		rc = inode_put(&ikey, &entry->inode, 0);
 	} else {
 		char ostr[33];
 		/* negative ref count.  concurrency error.  abort. */
@@ -730,7 +1011,7 @@ static int db3_get(
 			db3_keystr(key3), maxlen);
 
 	/* acquire a cursor for database 3 */
-	rc = dbp3->cursor(dbp3, NULL, &dbc, 0);
+	rc = dbp3->cursor(dbp3, cur_txn(), &dbc, 0);
 	if (rc != 0) {
 		log_error(naming_debug_level, "could not get cursor in db3: %s",
 				db_strerror(rc));
@@ -824,7 +1105,7 @@ static int db3_size(
 	naming_db_dirent db_ent;
 
 	/* acquire a cursor for database 3 */
-	rc = dbp3->cursor(dbp3, NULL, &dbc, 0);
+	rc = dbp3->cursor(dbp3, cur_txn(), &dbc, 0);
 	if (rc != 0) {
 		log_error(naming_debug_level, "could not get cursor in db3: %s",
 				db_strerror(rc));
@@ -881,6 +1162,126 @@ cleanup:
 }
 
 
+/**
+ * @brief Lookup one page of the entries in the third database 
+ *        that have the same key (i.e., the same parent directory).
+ *
+ * The duplicates of a key are the primary keys of the entries,
+ * sorted, so the entries come back in name order and a page
+ * starts right after the name of the last entry of the previous
+ * page (the cookie).
+ *
+ * @param key        @input the key of the entries to look up.
+ * @param cookie     @input the last name of the previous page ("" for the first page).
+ * @param pattern    @input fnmatch(3) pattern the names have to match ("" for all).
+ * @param result     @output the entries.
+ * @param maxlen     @input the most entries to return.
+ * @param count      @output the number of entries returned.
+ * @param eof        @output true if there are no entries after these.
+ */
+static int db3_get_page(
+		const db3_key *key3,
+		const char *cookie,
+		const char *pattern,
+		naming_db_dirent *result,
+		const int maxlen,
+		int *count,
+		lwfs_bool *eof)
+{
+	int rc = LWFS_OK;
+	int rc2 = LWFS_OK;
+	DBT key;
+	DBT pkey;
+	DBT data;
+	DBC *dbc;
+	db3_key skey;
+	db1_key start;
+	naming_db_dirent db_ent;
+	u_int32_t flags = DB_GET_BOTH_RANGE;
+
+	log_debug(naming_debug_level, "getting page for db3 - key(%s):cookie(%s):maxlen(%d)",
+			db3_keystr(key3), cookie, maxlen);
+
+	*count = 0;
+	*eof = FALSE;
+
+	/* acquire a cursor for database 3 */
+	rc = dbp3->cursor(dbp3, cur_txn(), &dbc, 0);
+	if (rc != 0) {
+		log_error(naming_debug_level, "could not get cursor in db3: %s",
+				db_strerror(rc));
+		return LWFS_ERR_NAMING;
+	}
+
+	/* the cursor writes the keys back, so give it copies */
+	memcpy(&skey, key3, sizeof(db3_key));
+	db1_keygen(&key3->parent_oid, cookie, &start);
+
+	/* initialize the key */
+	memset(&key, 0, sizeof(DBT));
+	key.data = &skey;
+	key.size = sizeof(db3_key);
+	key.ulen = sizeof(db3_key);
+	key.flags = DB_DBT_USERMEM;
+
+	/* initialize the primary key (where to start) */
+	memset(&pkey, 0, sizeof(DBT));
+	pkey.data = &start;
+	pkey.size = sizeof(db1_key);
+	pkey.ulen = sizeof(db1_key);
+	pkey.flags = DB_DBT_USERMEM;
+
+	/* initialize the data */
+	memset(&data, 0, sizeof(DBT));
+	data.data = &db_ent;
+	data.ulen = sizeof(naming_db_dirent);
+	data.flags = DB_DBT_USERMEM;
+
+	/* the first entry at or after the cookie, then the rest in order */
+	while ((*count < maxlen) &&
+	       ((rc = dbc->c_pget(dbc, &key, &pkey, &data, flags)) == 0)) {
+
+		flags = DB_NEXT_DUP;
+
+		/* the cookie itself was on the previous page */
+		if ((cookie[0] != '\0') && (strncmp(db_ent.name, cookie, LWFS_NAME_LEN) == 0)) {
+			continue;
+		}
+
+		if ((pattern[0] != '\0') && (fnmatch(pattern, db_ent.name, 0) != 0)) {
+			continue;
+		}
+
+		memcpy(&result[(*count)++], &db_ent, sizeof(naming_db_dirent));
+	}
+
+	if (rc == DB_NOTFOUND) {
+		*eof = TRUE;
+		rc = LWFS_OK;
+	}
+	else if (rc != 0) {
+		log_error(naming_debug_level, "error iterating through dir: %s",
+				db_strerror(rc));
+		rc = LWFS_ERR_NAMING;
+		goto cleanup;
+	}
+
+	log_debug(naming_debug_level, "directory <%s> page has %d entries (eof=%d)",
+		db3_keystr(key3), *count, *eof);
+
+cleanup:
+	/* close the database cursor */
+	rc2 = dbc->c_close(dbc);
+	if (rc2 != 0) {
+		log_error(naming_debug_level, "unable to close db cursor: %s",
+				db_strerror(rc2));
+		rc = LWFS_ERR_NAMING;
+	}
+
+	return rc;
+}
+
+
 /* ----------- Methods for inode ------------- */
 
 
@@ -927,7 +1328,7 @@ static lwfs_bool inode_exists(
 	data.dlen = 0;
 	data.flags = DB_DBT_PARTIAL;
 
-	rc = dbp_inode->get(dbp_inode, NULL, &key, &data, 0);
+	rc = txn_note(dbp_inode->get(dbp_inode, cur_txn(), &key, &data, 0));
 	switch (rc) {
 		case 0:
 			/* inode found */
@@ -971,7 +1372,7 @@ static int inode_del(
 
 
 	/* delete the inode from the database */
-	rc = dbp_inode->del(dbp_inode, NULL, &key, 0);
+	rc = txn_note(dbp_inode->del(dbp_inode, cur_txn(), &key, 0));
 	if (rc != LWFS_OK) {
 		log_error(naming_debug_level, "unable to remove inode: %s",
 				db_strerror(rc));
@@ -1007,7 +1408,7 @@ static int inode_put(
 	data.size = sizeof(naming_db_inode);
 
 	/* Put the inode in the inode database. */
-	rc = dbp_inode->put(dbp_inode, NULL, &key, &data, flags);
+	rc = txn_note(dbp_inode->put(dbp_inode, cur_txn(), &key, &data, flags));
 	if (rc == DB_KEYEXIST) {
 		log_error(naming_debug_level, "could not put inode in inode: %s",
 				db_strerror(rc));
@@ -1019,9 +1420,7 @@ static int inode_put(
 		return LWFS_ERR_NAMING;
 	}
 
-	/* sync the database */
-	/*rc = dbp_inode->sync(dbp_inode, 0);
-	*/
+	/* no sync: the transaction log is the commit point (see txn_end) */
 	
 
 	return rc;
@@ -1044,7 +1443,7 @@ static int inode_print_all()
 	DBC *dbc;
 
 	/* acquire a cursor for database 1 */
-	rc = dbp_inode->cursor(dbp_inode, NULL, &dbc, 0);
+	rc = dbp_inode->cursor(dbp_inode, cur_txn(), &dbc, 0);
 	if (rc != 0) {
 		log_error(naming_debug_level, "could not get cursor for inode: %s",
 				db_strerror(rc));
@@ -1159,7 +1558,7 @@ static int inode_get(
 	data.ulen = sizeof(naming_db_inode);
 	data.flags = DB_DBT_USERMEM;
 
-	rc = dbp_inode->get(dbp_inode, NULL, &key, &data, 0);
+	rc = txn_note(dbp_inode->get(dbp_inode, cur_txn(), &key, &data, 0));
 	switch (rc) {
 		case 0:
 			/* inode found */
@@ -1224,17 +1623,170 @@ cleanup:
 }
 
 
+/* ----------------- The DB environment -----------------*/
+
+/**
+ * @brief Remove the files (regions and logs) of a DB environment.
+ *
+ * @param home  @input the home directory of the environment.
+ */
+static int clear_env(
+	const char *home)
+{
+	int rc = LWFS_OK;
+	DIR *dir = NULL;
+	struct dirent *dent = NULL;
+	char *fname = NULL;
+
+	dir = opendir(home);
+	if (dir == NULL) {
+		if (errno == ENOENT) {
+			return LWFS_OK;
+		}
+		log_error(naming_debug_level, "unable to open %s: %s",
+				home, strerror(errno));
+		return LWFS_ERR_NAMING;
+	}
+
+	while ((dent = readdir(dir)) != NULL) {
+		if ((strcmp(dent->d_name, ".") == 0) || (strcmp(dent->d_name, "..") == 0)) {
+			continue;
+		}
+
+		fname = malloc(strlen(home) + strlen(dent->d_name) + 2);
+		if (fname == NULL) {
+			log_fatal(naming_debug_level, "could not allocate space for fname");
+			rc = LWFS_ERR_NOSPACE;
+			break;
+		}
+		sprintf(fname, "%s/%s", home, dent->d_name);
+
+		if (remove(fname) != 0) {
+			log_error(naming_debug_level, "unable to remove %s: %s",
+					fname, strerror(errno));
+			rc = LWFS_ERR_NAMING;
+		}
+		free(fname);
+	}
+
+	closedir(dir);
+
+	return rc;
+}
+
+/**
+ * @brief Create (or join) and recover the transactional DB environment.
+ *
+ * Normal recovery runs every time we open the environment, so
+ * a crash loses nothing that committed.  Catastrophic recovery
+ * replays every log file still around.
+ *
+ * @param home   @input the home directory (holds the regions and logs).
+ * @param fatal  @input flag to run catastrophic recovery.
+ */
+static int open_env(
+	const char *home,
+	const lwfs_bool fatal)
+{
+	int rc = LWFS_OK;
+	uint32_t flags = DB_CREATE | DB_INIT_LOCK | DB_INIT_LOG |
+		DB_INIT_MPOOL | DB_INIT_TXN | DB_THREAD;
+
+	if ((mkdir(home, S_IRWXU) != 0) && (errno != EEXIST)) {
+		log_error(naming_debug_level, "unable to create %s: %s",
+				home, strerror(errno));
+		return LWFS_ERR_NAMING;
+	}
+
+	rc = db_env_create(&dbenv, 0);
+	if (rc != 0) {
+		log_error(naming_debug_level, "unable to create environment: %s",
+				db_strerror(rc));
+		dbenv = NULL;
+		return LWFS_ERR_NAMING;
+	}
+
+	rc = dbenv->set_cachesize(dbenv, 0, NAMING_DB_CACHE_SIZE, 1);
+	if (rc != 0) {
+		log_error(naming_debug_level, "unable to set cache size: %s",
+				db_strerror(rc));
+		rc = LWFS_ERR_NAMING;
+		goto cleanup;
+	}
+
+	/* big enough for the commits of a group */
+	rc = dbenv->set_lg_bsize(dbenv, NAMING_DB_LOG_BUFFER_SIZE);
+	if (rc != 0) {
+		log_error(naming_debug_level, "unable to set log buffer size: %s",
+				db_strerror(rc));
+		rc = LWFS_ERR_NAMING;
+		goto cleanup;
+	}
+
+	/* readers run without a transaction and may deadlock with a writer */
+	rc = dbenv->set_lk_detect(dbenv, DB_LOCK_DEFAULT);
+	if (rc != 0) {
+		log_error(naming_debug_level, "unable to set deadlock detection: %s",
+				db_strerror(rc));
+		rc = LWFS_ERR_NAMING;
+		goto cleanup;
+	}
+
+	/* opens (and the odd write outside a mutation) commit on their own */
+	rc = dbenv->set_flags(dbenv, DB_AUTO_COMMIT, 1);
+	if (rc != 0) {
+		log_error(naming_debug_level, "unable to set auto commit: %s",
+				db_strerror(rc));
+		rc = LWFS_ERR_NAMING;
+		goto cleanup;
+	}
+
+	/* drop log files once a checkpoint no longer needs them */
+#ifdef DB_LOG_AUTO_REMOVE
+	rc = dbenv->log_set_config(dbenv, DB_LOG_AUTO_REMOVE, 1);
+#else
+	rc = dbenv->set_flags(dbenv, DB_LOG_AUTOREMOVE, 1);
+#endif
+	if (rc != 0) {
+		log_error(naming_debug_level, "unable to set log autoremove: %s",
+				db_strerror(rc));
+		rc = LWFS_ERR_NAMING;
+		goto cleanup;
+	}
+
+	flags |= (fatal) ? DB_RECOVER_FATAL : DB_RECOVER;
+
+	rc = dbenv->open(dbenv, home, flags, 0664);
+	if (rc != 0) {
+		log_error(naming_debug_level, "unable to open environment \"%s\": %s",
+				home, db_strerror(rc));
+		rc = LWFS_ERR_NAMING;
+		goto cleanup;
+	}
+
+cleanup:
+	if (rc != LWFS_OK) {
+		dbenv->close(dbenv, 0);
+		dbenv = NULL;
+	}
+
+	return rc;
+}
+
+
 /* ----------------- The naming_db API -----------------*/
 
 /**
  * @brief Initialize the database.
  *
  * This function creates or opens three sleepycat databases to store
- * information used by the lwfs naming service.
+ * information used by the lwfs naming service.  The databases live 
+ * in a transactional environment (home is the database path plus 
+ * ".env"), which we recover every time we open it.
  *
  * @param acl_db_fname @input path to the database file.
  * @param dbclear @input  flag to signal a fresh start.
- * @param dbrecover @input flag to signal recovery from crash.
+ * @param dbrecover @input flag to run catastrophic recovery.
  * @param root_entry @output the root of the directory.
  * @param orphan_entry @output the root of the orphan directory.
  */
@@ -1248,9 +1800,49 @@ int naming_db_init(
 	int rc = LWFS_OK;
 	lwfs_bool newfile = FALSE;
 
+	char *db1_path = NULL;     /* absolute fname for primary DB */
 	char *db2_fname = NULL;    /* fname for secondary DB */
 	char *db3_fname = NULL;    /* fname for tertiary DB */
 	char *inode_fname = NULL;  /* fname for inode DB */
+	char *env_home = NULL;     /* home of the DB environment */
+	char cwd[1024];
+
+	rc = pthread_key_create(&txn_key, NULL);
+	if (rc != 0) {
+		log_error(naming_debug_level, "unable to create txn key: %s",
+				strerror(rc));
+		return LWFS_ERR_NAMING;
+	}
+
+	/* The environment resolves relative names in its home, so we 
+	 * use absolute names to keep the files where they always were. */
+	if (db1_fname[0] == '/') {
+		cwd[0] = '\0';
+	} else if (getcwd(cwd, sizeof(cwd)-1) == NULL) {
+		log_error(naming_debug_level, "unable to get working directory: %s",
+				strerror(errno));
+		rc = LWFS_ERR_NAMING;
+		goto cleanup;
+	} else {
+		strcat(cwd, "/");
+	}
+	db1_path = malloc(strlen(cwd) + strlen(db1_fname) + 1);
+	if (db1_path == NULL) {
+		log_fatal(naming_debug_level, "could not allocate space for db1_path");
+		rc = LWFS_ERR_NOSPACE;
+		goto cleanup;
+	}
+	sprintf(db1_path, "%s%s", cwd, db1_fname);
+	db1_fname = db1_path;
+
+	/* initialize the home of the environment */
+	env_home = malloc(strlen(db1_fname) + strlen(ENV_NAME_EXTENSION)+1);
+	if (env_home == NULL) {
+		log_fatal(naming_debug_level, "could not allocate space for env_home");
+		rc = LWFS_ERR_NOSPACE;
+		goto cleanup;
+	}
+	sprintf(env_home, "%s%s", db1_fname, ENV_NAME_EXTENSION);
 
 	/* initialize the file name of the secondary DB */
 	db2_fname = malloc(strlen(db1_fname) + strlen(DB2_NAME_EXTENSION)+1);
@@ -1324,11 +1916,28 @@ int naming_db_init(
 		}
 	}
 
+	/* the logs of the old databases have to go too */
+	if (dbclear) {
+		rc = clear_env(env_home);
+		if (rc != LWFS_OK) {
+			goto cleanup;
+		}
+	}
+
+	/* open the environment (runs recovery) */
+	rc = open_env(env_home, dbrecover);
+	if (rc != LWFS_OK) {
+		goto cleanup;
+	}
+
+	/* recovery may have brought back the files of a crashed start */
+	newfile = (access(db1_fname, F_OK) != 0);
+
 	/* create and open the primary db */
 	if (db1_fname != NULL) {
 
 		/* create the database */
-		rc = db_create(&dbp1, NULL, 0);
+		rc = db_create(&dbp1, dbenv, 0);
 		if (rc != 0) {
 			log_error(naming_debug_level, "unable to create database: %s",
 					db_strerror(rc));
@@ -1359,7 +1968,7 @@ int naming_db_init(
 	if (db2_fname != NULL) {
 
 		/* create the database */
-		rc = db_create(&dbp2, NULL, 0);
+		rc = db_create(&dbp2, dbenv, 0);
 		if (rc != 0) {
 			log_error(naming_debug_level, "unable to create database: %s",
 					db_strerror(rc));
@@ -1379,7 +1988,7 @@ int naming_db_init(
 
 	/* create and open the tertiary db */
 	if (db3_fname != NULL) {
-		rc = db_create(&dbp3, NULL, 0);
+		rc = db_create(&dbp3, dbenv, 0);
 		if (rc != 0) {
 			log_error(naming_debug_level, "unable to open database: %s",db_strerror(rc));
 			rc = LWFS_ERR_NAMING;
@@ -1409,7 +2018,7 @@ int naming_db_init(
 
 	/* create and open the inode db */
 	if (inode_fname != NULL) {
-		rc = db_create(&dbp_inode, NULL, 0);
+		rc = db_create(&dbp_inode, dbenv, 0);
 		if (rc != 0) {
 			log_error(naming_debug_level, "unable to open database: %s",db_strerror(rc));
 			rc = LWFS_ERR_NAMING;
@@ -1594,18 +2203,33 @@ int naming_db_init(
 
 cleanup:
 	/* free the name buffers */
+	free(db1_path);
 	free(db2_fname);
 	free(db3_fname);
 	free(inode_fname);
+	free(env_home);
 
 
 
 	/* close the databases if there was an error */
 	if (rc != LWFS_OK) {
-		dbp1->close(dbp1, 0);
-		dbp2->close(dbp2, 0);
-		dbp3->close(dbp3, 0);
-		dbp_inode->close(dbp_inode, 0);
+		if (dbp1 != NULL) {
+			dbp1->close(dbp1, 0);
+		}
+		if (dbp2 != NULL) {
+			dbp2->close(dbp2, 0);
+		}
+		if (dbp3 != NULL) {
+			dbp3->close(dbp3, 0);
+		}
+		if (dbp_inode != NULL) {
+			dbp_inode->close(dbp_inode, 0);
+		}
+		if (dbenv != NULL) {
+			dbenv->close(dbenv, 0);
+		}
+		dbp1 = dbp2 = dbp3 = dbp_inode = NULL;
+		dbenv = NULL;
 	}
 
 	return rc;
@@ -1644,6 +2268,11 @@ int naming_db_fini()
 	//dbp1->stat_print(dbp1, 0);
 	//print_hash_stats(&stats);
 
+	/* a last checkpoint, so the next start has nothing to recover */
+	if ((dbenv != NULL) && (dbenv->txn_checkpoint(dbenv, 0, 0, DB_FORCE) != 0)) {
+		log_warn(naming_debug_level, "unable to checkpoint the naming database");
+	}
+
 
 	if ((dbp1 != NULL) && ((rc = dbp1->close(dbp1, 0)) != 0)) {
 		rc = LWFS_ERR_NAMING;
@@ -1661,6 +2290,20 @@ int naming_db_fini()
 		rc = LWFS_ERR_NAMING;
 	}
 
+	dbp1 = dbp2 = dbp3 = dbp_inode = NULL;
+
+	if (dbenv != NULL) {
+		log_debug(naming_debug_level, "%lu transactions committed with %lu log flushes",
+				group.committed, group.flushes);
+
+		if (dbenv->close(dbenv, 0) != 0) {
+			rc = LWFS_ERR_NAMING;
+		}
+		dbenv = NULL;
+	}
+
+	pthread_key_delete(txn_key);
+
 	return rc;
 }
 
@@ -1875,6 +2518,78 @@ cleanup:
 	return rc;
 }
 
+int naming_db_get_page_by_parent(
+	const lwfs_oid *parent_oid,
+	const char *cookie,
+	const char *pattern,
+	const lwfs_bool names_only,
+	naming_db_entry *result,
+	const int maxlen,
+	int *count,
+	lwfs_bool *eof)
+{
+	int rc = LWFS_OK;
+	int i = 0;
+	db3_key key3;
+	naming_db_dirent *dirent = NULL;
+	naming_db_inode  inode;
+
+	log_debug(naming_debug_level, "entered naming_db_get_page_by_parent");
+
+	*count = 0;
+
+	/* generate a hash key for the tertiary database */
+	rc = db3_keygen(parent_oid, &key3);
+	if (rc != LWFS_OK) {
+		log_error(naming_debug_level, "could not generate key");
+		goto cleanup;
+	}
+
+	dirent = (naming_db_dirent *)malloc(maxlen * sizeof(naming_db_dirent));
+	if (dirent == NULL) {
+		rc = LWFS_ERR_NOSPACE;
+		goto cleanup;
+	}
+
+	/* get one page of the entries associated with the parent */
+	rc = db3_get_page(&key3, cookie, pattern, dirent, maxlen, count, eof);
+	if (rc != LWFS_OK) {
+		log_error(naming_debug_level, "could not get page: %s",
+				lwfs_err_str(rc));
+		goto cleanup;
+	}
+
+	for (i=0; i < *count; i++) {
+		if (names_only) {
+			/* the caller only wants the dirents, skip the inodes */
+			memset(&result[i], 0, sizeof(naming_db_entry));
+			memcpy(&result[i].dirent, &dirent[i], sizeof(naming_db_dirent));
+			continue;
+		}
+
+		rc = inode_get_by_dirent(&(dirent[i]), &inode);
+		if (rc != LWFS_OK) {
+			log_error(naming_debug_level, "could not lookup inode by dirent: %s",
+					lwfs_err_str(rc));
+			goto cleanup;
+		}
+
+		rc = create_entry(&(dirent[i]), &inode, &(result[i]));
+		if (rc != LWFS_OK) {
+			log_error(naming_debug_level, "could not create naming_db_entry: %s",
+					lwfs_err_str(rc));
+			goto cleanup;
+		}
+	}
+
+cleanup:
+	free(dirent);
+
+	log_debug(naming_debug_level, "finished naming_db_get_page_by_parent");
+
+	return rc;
+}
+
 int naming_db_get_size(
 	const lwfs_oid *parent_oid,
 	db_recno_t *result)
@@ -1924,13 +2639,11 @@ lwfs_bool naming_db_exists(const naming_db_entry *db_entry)
 }
 
 /**
- * @brief Put a new entry in the database.
+ * @brief Put a new entry in the database (in the transaction of the caller).
  *
  * @param  db_entry @input the entry to insert into the database.
- *
- * This function puts a
  */
-int naming_db_put(
+static int put_entry(
 	const naming_db_entry *db_entry,
 	const uint32_t options)
 {
@@ -2003,14 +2716,141 @@ cleanup:
 }
 
 /**
- * @brief Remove an entry from the database.
+ * @brief Put a new entry in the database.
  *
- * @param parent_oid @input the oid of the parent.
- * @param name       @input the name of the entry to remove.
- * @param result     @output the database entry that was removed.
+ * @param  db_entry @input the entry to insert into the database.
  *
+ * The dirent and the inode go in as one transaction, so a crash
+ * leaves both or neither.  We return once the commit is on disk.
  */
-int naming_db_del(
+int naming_db_put(
+	const naming_db_entry *db_entry,
+	const uint32_t options)
+{
+	int rc = LWFS_OK;
+	int tries = 0;
+	lwfs_bool retry = FALSE;
+	txn_state state;
+
+	do {
+		rc = txn_begin(&state);
+		if (rc != LWFS_OK) {
+			break;
+		}
+
+		rc = put_entry(db_entry, options);
+
+		rc = txn_end(&state, rc, &retry);
+	} while (retry && (++tries < NAMING_DB_TXN_RETRIES));
+
+	return rc;
+}
+
+/**
+ * @brief Put a batch of entries in the transaction of the caller.
+ *
+ * Each entry gets a child transaction, so a failed entry leaves
+ * nothing behind and the entries before it stay.
+ */
+static int put_entries(
+	txn_state *state,
+	const naming_db_entry *entries,
+	const int count,
+	const uint32_t options,
+	int *done)
+{
+	int rc = LWFS_OK;
+	int dbrc;
+	int i;
+	DB_TXN *parent = state->txn;
+	DB_TXN *child = NULL;
+
+	for (i=0; i<count; i++) {
+		dbrc = dbenv->txn_begin(dbenv, parent, &child, 0);
+		if (dbrc != 0) {
+			log_error(naming_debug_level, "unable to begin transaction: %s",
+					db_strerror(dbrc));
+			rc = LWFS_ERR_NAMING;
+			break;
+		}
+
+		state->txn = child;
+		rc = put_entry(&entries[i], options);
+		state->txn = parent;
+
+		if (rc != LWFS_OK) {
+			log_debug(naming_debug_level, "put %d of %d failed: %s",
+					i, count, lwfs_err_str(rc));
+			child->abort(child);
+			break;
+		}
+
+		dbrc = txn_note(child->commit(child, 0));
+		if (dbrc != 0) {
+			log_error(naming_debug_level, "unable to commit transaction: %s",
+					db_strerror(dbrc));
+			rc = LWFS_ERR_NAMING;
+			break;
+		}
+
+		(*done)++;
+	}
+
+	return rc;
+}
+
+/**
+ * @brief Put a batch of entries in the database.
+ *
+ * The entries go in in order; we stop at the first one that 
+ * fails (e.g., \ref LWFS_ERR_EXIST) and leave the ones before 
+ * it in the database.  The whole batch commits as one transaction
+ * (one log flush).
+ *
+ * @param entries    @input the entries.
+ * @param count      @input the number of entries.
+ * @param options    @input options for each put (e.g., DB_NOOVERWRITE).
+ * @param done       @output the number of entries put.
+ */
+int naming_db_put_batch(
+	const naming_db_entry *entries,
+	const int count,
+	const uint32_t options,
+	int *done)
+{
+	int rc = LWFS_OK;
+	int rc2;
+	int tries = 0;
+	lwfs_bool retry = FALSE;
+	txn_state state;
+
+	log_debug(naming_debug_level, "naming_db_put_batch(%d entries)", count);
+
+	do {
+		*done = 0;
+
+		rc = txn_begin(&state);
+		if (rc != LWFS_OK) {
+			break;
+		}
+
+		rc = put_entries(&state, entries, count, options, done);
+
+		/* keep what went in before a failed entry, unless we lost a deadlock */
+		rc2 = txn_end(&state, (state.deadlock) ? rc : LWFS_OK, &retry);
+		if (rc2 != LWFS_OK) {
+			*done = 0;
+			rc = rc2;
+		}
+	} while (retry && (++tries < NAMING_DB_TXN_RETRIES));
+
+	return rc;
+}
+
+/**
+ * @brief Remove an entry from the database (in the transaction of the caller).
+ */
+static int del_entry(
 	const lwfs_oid *parent_oid,
 	const char *name,
 	naming_db_entry *result)
@@ -2037,6 +2877,41 @@ int naming_db_del(
 	return rc;
 }
 
+/**
+ * @brief Remove an entry from the database.
+ *
+ * The lookup, the removal of the dirent, and the update of the 
+ * inode run as one transaction.
+ *
+ * @param parent_oid @input the oid of the parent.
+ * @param name       @input the name of the entry to remove.
+ * @param result     @output the database entry that was removed.
+ *
+ */
+int naming_db_del(
+	const lwfs_oid *parent_oid,
+	const char *name,
+	naming_db_entry *result)
+{
+	int rc = LWFS_OK;
+	int tries = 0;
+	lwfs_bool retry = FALSE;
+	txn_state state;
+
+	do {
+		rc = txn_begin(&state);
+		if (rc != LWFS_OK) {
+			break;
+		}
+
+		rc = del_entry(parent_oid, name, result);
+
+		rc = txn_end(&state, rc, &retry);
+	} while (retry && (++tries < NAMING_DB_TXN_RETRIES));
+
+	return rc;
+}
+
 
 int naming_db_print_all() {
 #if 0
@@ -104,11 +104,13 @@ extern "C" {
 	 * @brief Initialize the database.
 	 *
 	 * This function initializes the sleepycat database used to store
-	 * namespace entries for the naming server
+	 * namespace entries for the naming server.  The database lives in
+	 * a transactional environment that is recovered at every start;
+	 * each put or delete is one transaction, durable when it returns.
 	 *
 	 * @param acl_db_fname @input_type path to the database file.
 	 * @param dbclear @input_type  flag to signal a fresh start.
-	 * @param dbrecover @input_type flag to signal recovery from crash.
+	 * @param dbrecover @input_type flag to run catastrophic recovery.
 	 */
 	extern int naming_db_init(
 			const char *acl_db_fname,
@@ -135,6 +137,28 @@ extern "C" {
 			naming_db_entry *result,
 			const int maxlen);
 
+	/**
+	 * @brief Get one page of the entries of a directory, in name order.
+	 *
+	 * @param parent     @input the oid of the directory.
+	 * @param cookie     @input the last name of the previous page ("" for the first page).
+	 * @param pattern    @input fnmatch(3) pattern the names have to match ("" for all).
+	 * @param names_only @input only fill in the dirents (no inode lookups).
+	 * @param result     @output the entries.
+	 * @param maxlen     @input the most entries to return.
+	 * @param count      @output the number of entries returned.
+	 * @param eof        @output true if the page is the last one.
+	 */
+	extern int naming_db_get_page_by_parent(
+			const lwfs_oid *parent,
+			const char *cookie,
+			const char *pattern,
+			const lwfs_bool names_only,
+			naming_db_entry *result,
+			const int maxlen,
+			int *count,
+			lwfs_bool *eof);
+
 	extern int naming_db_get_size(
 			const lwfs_oid *parent,
 			uint32_t *result);
@@ -143,6 +167,12 @@ extern "C" {
 			const naming_db_entry *entry,
 			const uint32_t options);
 
+	extern int naming_db_put_batch(
+			const naming_db_entry *entries,
+			const int count,
+			const uint32_t options,
+			int *done);
+
 	extern int naming_db_del(
 			const lwfs_oid *parent_oid,
 			const char *name,
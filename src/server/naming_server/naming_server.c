@@ -13,6 +13,7 @@
 #include <time.h>
 #include "client/authr_client/authr_client_sync.h"
 #include "client/authr_client/authr_client.h"
+#include "server/authr_server/cap_verifier.h"
 #include "support/trace/trace.h"
 #include "common/naming_common/naming_trace.h"
 #include "naming_server.h"
@@ -69,6 +70,14 @@ static const lwfs_svc_op naming_op_array[] = {
 		sizeof(lwfs_ns_entry),                    /* sizeof res */
 		(xdrproc_t)&xdr_lwfs_ns_entry             /* encode res */
 	},
+	{
+		LWFS_OP_CREATE_FILES,                   /* opcode */
+		(lwfs_rpc_proc)&naming_create_files, /* func */
+		sizeof(lwfs_create_files_args),         /* sizeof args */
+		(xdrproc_t)&xdr_lwfs_create_files_args, /* decode args */
+		sizeof(lwfs_create_files_res),          /* sizeof res */
+		(xdrproc_t)&xdr_lwfs_create_files_res   /* encode res */
+	},
 	{
 		LWFS_OP_CREATE_LINK,                   /* opcode */
 		(lwfs_rpc_proc)&naming_create_link, /* func */
@@ -101,6 +110,22 @@ static const lwfs_svc_op naming_op_array[] = {
 		sizeof(lwfs_ns_entry),          /* sizeof res */
 		(xdrproc_t)&xdr_lwfs_ns_entry   /* encode res */
 	},
+	{
+		LWFS_OP_RESOLVE_PATH,                   /* opcode */
+		(lwfs_rpc_proc)&naming_resolve_path, /* func */
+		sizeof(lwfs_resolve_path_args),         /* sizeof args */
+		(xdrproc_t)&xdr_lwfs_resolve_path_args, /* decode args */
+		sizeof(lwfs_resolve_path_res),          /* sizeof res */
+		(xdrproc_t)&xdr_lwfs_resolve_path_res   /* encode res */
+	},
+	{
+		LWFS_OP_LIST_DIR_PAGE,                   /* opcode */
+		(lwfs_rpc_proc)&naming_list_dir_page, /* func */
+		sizeof(lwfs_list_dir_page_args),         /* sizeof args */
+		(xdrproc_t)&xdr_lwfs_list_dir_page_args, /* decode args */
+		sizeof(lwfs_list_dir_page_res),          /* sizeof res */
+		(xdrproc_t)&xdr_lwfs_list_dir_page_res   /* encode res */
+	},
 	{
 		LWFS_OP_NAME_STAT,           	/* opcode */
 		(lwfs_rpc_proc)&naming_stat, /* func */
@@ -141,6 +166,22 @@ static const lwfs_svc_op naming_op_array[] = {
 		sizeof(lwfs_namespace_array),          /* sizeof res */
 		(xdrproc_t)&xdr_lwfs_namespace_array   /* encode res */
 	},
+	{
+		LWFS_OP_REVOKE_CAPS,           	/* opcode */
+		(lwfs_rpc_proc)&naming_revoke_caps, /* func */
+		sizeof(lwfs_revoke_caps_args),         /* sizeof args */
+		(xdrproc_t)&xdr_lwfs_revoke_caps_args, /* decode args */
+		sizeof(void),          /* sizeof res */
+		(xdrproc_t)&xdr_void   /* encode res */
+	},
+	{
+		LWFS_OP_SET_CAP_KEY,           	/* opcode */
+		(lwfs_rpc_proc)&naming_set_cap_key, /* func */
+		sizeof(lwfs_set_cap_key_args),         /* sizeof args */
+		(xdrproc_t)&xdr_lwfs_set_cap_key_args, /* decode args */
+		sizeof(void),          /* sizeof res */
+		(xdrproc_t)&xdr_void   /* encode res */
+	},
 	{LWFS_OP_NULL}
 };
 
@@ -186,50 +227,31 @@ int update_time(lwfs_time *t)
 	return rc;
 }
 
-static int check_perm(
-	const lwfs_oid *oid,
+/**
+  * @brief Check that a cap allows an operation on a container.
+  */
+static int check_cap(
+	const lwfs_cid cid,
 	const lwfs_cap *cap,
 	const lwfs_container_op container_op)
 {
 	int rc = LWFS_OK;
 
-	naming_db_entry db_ent;
-
-	if (logging_debug(naming_debug_level) && print_args) {
-		FILE *fp = logger_get_file();
-		fprint_lwfs_cap(fp, "cap", "DEBUG\t", cap);
-		fprint_lwfs_oid(fp, "oid", "DEBUG\t", oid);
-	}
-	
-	/* Look up the entry */
-	rc = naming_db_get_by_oid(oid, &db_ent);
-	if (rc != LWFS_OK) {
-		log_error(naming_debug_level, "could not lookup target entry: %s",
-				lwfs_err_str(rc));
-		return rc;
-	}
-
-	if (logging_debug(naming_debug_level) && print_args) {
-		FILE *fp = logger_get_file();
-		fprint_lwfs_obj(fp, "db_ent.inode.entry_obj", "DEBUG\t", &db_ent.inode.entry_obj);
-		fprint_lwfs_cap(fp, "cap", "DEBUG\t", cap);
-	}
-	
 	log_debug(naming_debug_level, "------------------------------------------------");
 	log_debug(naming_debug_level, "------------------------------------------------");
 	log_debug(naming_debug_level, "------------------------------------------------");
 	log_debug(naming_debug_level,
 		  "db_ent.cid==0x%08x;cap.cid==0x%08x;LWFS_CID_ANY==0x%08x",
-		  (unsigned long)db_ent.inode.entry_obj.cid, (unsigned long)cap->data.cid, LWFS_CID_ANY);
+		  (unsigned long)cid, (unsigned long)cap->data.cid, LWFS_CID_ANY);
 	log_debug(naming_debug_level, "------------------------------------------------");
 	log_debug(naming_debug_level, "------------------------------------------------");
 	log_debug(naming_debug_level, "------------------------------------------------");
 
 	/* Verify that the cid matches the cap cid */
-	if ((db_ent.inode.entry_obj.cid != LWFS_CID_ANY) &&
-			(db_ent.inode.entry_obj.cid != cap->data.cid)) {
+	if ((cid != LWFS_CID_ANY) &&
+			(cid != cap->data.cid)) {
 		log_error(naming_debug_level, "cid does not match cid of cap (db_ent.cid==0x%08x;cap.cid==0x%08x)",
-			  (unsigned long)db_ent.inode.entry_obj.cid, (unsigned long)cap->data.cid);
+			  (unsigned long)cid, (unsigned long)cap->data.cid);
 		return LWFS_ERR_ACCESS;
 	}
 
@@ -244,8 +266,13 @@ static int check_perm(
 	}
 
 	/* Verify the capability was generated by the authr server and
-	 * that it has not changed.
+	 * that it has not changed. If we have the key of the authr 
+	 * server, we only call it for caps with revoked operations.
 	 */
+	if (cap_verifier_check(cap) == LWFS_OK) {
+		return LWFS_OK;
+	}
+
 	rc = lwfs_verify_caps_sync(&authr_svc, cap, 1);
 	if (rc != LWFS_OK) {
 		log_error(naming_debug_level, "could not verify caps: %s",
@@ -253,10 +280,46 @@ static int check_perm(
 		return rc;
 	}
 
+	/* fetch the key again if we missed a rotation */
+	cap_verifier_confirm(cap);
+
 	return rc;
 }
 
 
+static int check_perm(
+	const lwfs_oid *oid,
+	const lwfs_cap *cap,
+	const lwfs_container_op container_op)
+{
+	int rc = LWFS_OK;
+
+	naming_db_entry db_ent;
+
+	if (logging_debug(naming_debug_level) && print_args) {
+		FILE *fp = logger_get_file();
+		fprint_lwfs_cap(fp, "cap", "DEBUG\t", cap);
+		fprint_lwfs_oid(fp, "oid", "DEBUG\t", oid);
+	}
+	
+	/* Look up the entry */
+	rc = naming_db_get_by_oid(oid, &db_ent);
+	if (rc != LWFS_OK) {
+		log_error(naming_debug_level, "could not lookup target entry: %s",
+				lwfs_err_str(rc));
+		return rc;
+	}
+
+	if (logging_debug(naming_debug_level) && print_args) {
+		FILE *fp = logger_get_file();
+		fprint_lwfs_obj(fp, "db_ent.inode.entry_obj", "DEBUG\t", &db_ent.inode.entry_obj);
+		fprint_lwfs_cap(fp, "cap", "DEBUG\t", cap);
+	}
+	
+	return check_cap(db_ent.inode.entry_obj.cid, cap, container_op);
+}
+
+
 static lwfs_obj *get_file_obj(
 	const naming_db_entry *db_entry)
 {
@@ -323,6 +386,7 @@ int naming_server_init(
 		const char *db_path,
 		const lwfs_bool db_clear,
 		const lwfs_bool db_recover,
+		const lwfs_bool local_caps,
 		const lwfs_service *a_svc,
 		lwfs_service *n_svc)
 {
@@ -340,7 +404,8 @@ int naming_server_init(
 	}
 
 	/* add naming service ops to our list of supported ops */
-	rc = lwfs_service_add_ops(n_svc, lwfs_naming_op_array(), 12);
+	rc = lwfs_service_add_ops(n_svc, lwfs_naming_op_array(), 
+			lwfs_svc_op_count(lwfs_naming_op_array()));
 	if (rc != LWFS_OK) {
 		log_error(naming_debug_level, "unable to add naming ops: %s",
 			lwfs_err_str(rc));
@@ -371,6 +436,15 @@ int naming_server_init(
 		return rc;
 	}
 
+	/* get the key to verify caps without the authr server */
+	if (local_caps) {
+		rc = cap_verifier_init(&authr_svc, n_svc);
+		if (rc != LWFS_OK) {
+			log_warn(naming_debug_level, "could not get cap key, "
+					"verifying caps with authr server: %s", lwfs_err_str(rc));
+		}
+	}
+
 	/* does the container for the root entry exist? */
 
 	/* if it does not exist, create a new container for the root entry */
@@ -391,6 +465,11 @@ int naming_server_fini(lwfs_service *n_svc)
 	/* close the database */
 	naming_db_fini();
 
+	if (cap_verifier_enabled()) {
+		fprint_cap_verifier_stats(logger_get_file());
+	}
+	cap_verifier_fini();
+
 	rc = lwfs_service_fini(n_svc);
 	if (rc != LWFS_OK) {
 		log_error(naming_debug_level, "unable to shutdown naming service");
@@ -923,6 +1002,40 @@ int naming_remove_dir(
 	return rc;
 }
 
+/**
+ * @brief Fill in the database entry for a new file.
+ */
+static void init_file_entry(
+	const lwfs_ns_entry *parent,
+	const char *name,
+	const lwfs_obj *obj,
+	naming_db_entry *db_entry)
+{
+	memset(db_entry, 0, sizeof(naming_db_entry));
+	strncpy(db_entry->dirent.name, name, LWFS_NAME_LEN);
+	memcpy(&db_entry->dirent.parent_oid, &parent->dirent_oid, sizeof(lwfs_oid));
+	naming_db_gen_oid(&db_entry->dirent.oid);  /* generate a new oid */
+
+	/* initialize the entry object */
+	memcpy(&db_entry->inode.entry_obj.svc, &naming_svc, sizeof(lwfs_service));
+	db_entry->inode.entry_obj.type = LWFS_FILE_ENTRY;
+	db_entry->inode.entry_obj.cid = obj->cid;
+	naming_db_gen_oid(&db_entry->inode.entry_obj.oid);  /* generate a new oid */
+	db_entry->inode.ref_cnt = 1;
+
+	/* set the attributes */
+	db_entry->inode.stat_data.size = 0;
+	update_time(&db_entry->inode.stat_data.atime);
+	memcpy(&db_entry->inode.stat_data.mtime, &db_entry->inode.stat_data.atime, sizeof(lwfs_time));
+	memcpy(&db_entry->inode.stat_data.ctime, &db_entry->inode.stat_data.atime, sizeof(lwfs_time));
+
+	memcpy(&db_entry->dirent.inode_oid, &db_entry->inode.entry_obj.oid, sizeof(lwfs_oid));
+
+	/* copy the supplied object into the file object */
+	db_entry->inode.file_obj_valid = TRUE;
+	memcpy(&db_entry->inode.file_obj, obj, sizeof(lwfs_obj));
+}
+
 /**
  * @brief Create a new file.
  *
@@ -983,29 +1096,7 @@ int naming_create_file(
 	}
 
 	/* store info in the db_entry */
-	memset(&db_entry, 0, sizeof(naming_db_entry));
-	strncpy(db_entry.dirent.name, name, LWFS_NAME_LEN);
-	memcpy(&db_entry.dirent.parent_oid, &parent->dirent_oid, sizeof(lwfs_oid));
-	naming_db_gen_oid(&db_entry.dirent.oid);  /* generate a new oid */
-
-	/* initialize the entry object */
-	memcpy(&db_entry.inode.entry_obj.svc, &naming_svc, sizeof(lwfs_service));
-	db_entry.inode.entry_obj.type = LWFS_FILE_ENTRY;
-	db_entry.inode.entry_obj.cid = obj->cid;
-	naming_db_gen_oid(&db_entry.inode.entry_obj.oid);  /* generate a new oid */
-	db_entry.inode.ref_cnt = 1;
-
-	/* set the attributes */
-	db_entry.inode.stat_data.size = 0;
-	update_time(&db_entry.inode.stat_data.atime);
-	memcpy(&db_entry.inode.stat_data.mtime, &db_entry.inode.stat_data.atime, sizeof(lwfs_time));
-	memcpy(&db_entry.inode.stat_data.ctime, &db_entry.inode.stat_data.atime, sizeof(lwfs_time));
-
-	memcpy(&db_entry.dirent.inode_oid, &db_entry.inode.entry_obj.oid, sizeof(lwfs_oid));
-
-	/* copy the supplied object into the file object */
-	db_entry.inode.file_obj_valid = TRUE;
-	memcpy(&db_entry.inode.file_obj, obj, sizeof(lwfs_obj));
+	init_file_entry(parent, name, obj, &db_entry);
 
 	/* Insert the entry into the database */
 	rc = naming_db_put(&db_entry, DB_NOOVERWRITE);
@@ -1032,6 +1123,107 @@ cleanup:
 	return rc;
 }
 
+/**
+ * @brief Create many files in one directory.
+ *
+ * The \b lwfs_create_files method does what \b lwfs_create_file 
+ * does for a list of names (and their storage objects), with one 
+ * check of the cap and one batch of database puts.  The files 
+ * are created in order; the server stops at the first one that 
+ * fails (e.g., the name exists) and returns the entries it 
+ * created, with the error in \em result->rc.
+ */
+int naming_create_files(
+		const lwfs_remote_pid *caller,
+		const lwfs_create_files_args *args,
+		const lwfs_rma *data_addr,
+		lwfs_create_files_res *result)
+{
+	int rc = LWFS_OK;
+	int i;
+	int done = 0;
+	naming_db_entry *db_ents = NULL;
+	lwfs_ns_entry *ns_ents = NULL;
+
+	/* copy arguments */
+	const lwfs_ns_entry *parent = args->parent;
+	const int count = args->names.names_len;
+	const lwfs_cap *cap = args->cap;
+
+	trace_event(TRACE_NAMING_CREAT_BULK, 0, "create_files");
+
+	log_debug(naming_debug_level, "starting lwfs_create_files (%d files)", count);
+
+	/* initialize the result */
+	memset(result, 0, sizeof(lwfs_create_files_res));
+
+	if (args->objs.objs_len != (u_int)count) {
+		log_error(naming_debug_level, "%d names but %d objects",
+				count, args->objs.objs_len);
+		rc = LWFS_ERR;
+		goto cleanup;
+	}
+
+	/* make sure the parent is a directory */
+	if ((parent->entry_obj.type != LWFS_DIR_ENTRY) &&
+	    (parent->entry_obj.type != LWFS_NS_OBJ)) {
+		log_error(naming_debug_level, "parent is not a directory");
+		rc = LWFS_ERR_NOTDIR;
+		goto cleanup;
+	}
+
+	/* Check permissions. The caller needs to have the capability
+	 * to modify (i.e., WRITE) to the parent directory.
+	 */
+	rc = check_perm(&parent->dirent_oid, cap, LWFS_CONTAINER_WRITE);
+	if (rc != LWFS_OK) {
+		log_error(naming_debug_level, "unable to authorize operation: %s",
+			lwfs_err_str(rc));
+		goto cleanup;
+	}
+
+	if (count == 0) {
+		goto cleanup;
+	}
+
+	db_ents = (naming_db_entry *)malloc(count*sizeof(naming_db_entry));
+	ns_ents = (lwfs_ns_entry *)malloc(count*sizeof(lwfs_ns_entry));
+	if ((db_ents == NULL) || (ns_ents == NULL)) {
+		log_error(naming_debug_level, "could not allocate entries");
+		rc = LWFS_ERR_NOSPACE;
+		goto cleanup;
+	}
+
+	for (i=0; i<count; i++) {
+		init_file_entry(parent, args->names.names_val[i], 
+				&args->objs.objs_val[i], &db_ents[i]);
+	}
+
+	/* Insert the entries into the database */
+	result->rc = naming_db_put_batch(db_ents, count, DB_NOOVERWRITE, &done);
+	if (result->rc != LWFS_OK) {
+		log_warn(naming_debug_level, "created %d of %d files: %s",
+				done, count, lwfs_err_str(result->rc));
+	}
+
+	for (i=0; i<done; i++) {
+		copy_db_to_ns_entry(&ns_ents[i], &db_ents[i]);
+	}
+
+	if (done > 0) {
+		result->entries.lwfs_ns_entry_array_len = done;
+		result->entries.lwfs_ns_entry_array_val = ns_ents;
+		ns_ents = NULL;
+	}
+
+cleanup:
+	free(db_ents);
+	free(ns_ents);
+
+	log_debug(naming_debug_level, "finished lwfs_create_files");
+	return rc;
+}
+
 /**
  * @brief Create a link.
  *
@@ -1293,6 +1485,175 @@ int naming_lookup(
 }
 
 
+/**
+  * @brief Check that one of the caps of a resolve allows reading
+  * a directory in container \em cid.
+  *
+  * Each cap is verified only the first time it is used.
+  */
+static int check_resolve_cap(
+	const lwfs_cid cid,
+	const lwfs_cap *caps,
+	const u_int num_caps,
+	lwfs_bool *verified)
+{
+	int rc = LWFS_OK;
+	u_int i;
+
+	for (i=0; i<num_caps; i++) {
+		if ((cid == LWFS_CID_ANY) || (caps[i].data.cid == cid)) {
+			if (verified[i]) {
+				return LWFS_OK;
+			}
+
+			rc = check_cap(cid, &caps[i], LWFS_CONTAINER_READ);
+			if (rc == LWFS_OK) {
+				verified[i] = TRUE;
+			}
+			return rc;
+		}
+	}
+
+	log_warn(naming_debug_level, "no cap for container %lu on the path",
+		(unsigned long)cid);
+	return LWFS_ERR_ACCESS;
+}
+
+/**
+ * @brief Resolve a path in one request.
+ *
+ * The server looks up each name of the path in turn, so a cold
+ * lookup of a deep path costs one round trip instead of one per
+ * component.  The names are not normalized ("." and ".." are
+ * looked up like any other name).  The server stops at the first 
+ * name it can not resolve and returns the entries it found, with 
+ * the error in \em result->rc and the index of the name in 
+ * \em result->failed. 
+ */
+int naming_resolve_path(
+		const lwfs_remote_pid *caller,
+		const lwfs_resolve_path_args *args,
+		const lwfs_rma *data_addr,
+		lwfs_resolve_path_res *result)
+{
+	int rc = LWFS_OK;
+	u_int i;
+	u_int count = 0;
+	u_int found = 0;    /* entries in ns_ents */
+	naming_db_entry db_entry;
+	lwfs_oid dir_oid;
+	lwfs_bool *verified = NULL;
+	lwfs_ns_entry *ns_ents = NULL;
+	char ostr[33];
+
+	/* copy arguments */
+	const lwfs_ns_entry *start = args->start;
+	const u_int num_names = args->names.names_len;
+	const lwfs_name *names = args->names.names_val;
+	const u_int num_caps = args->caps.lwfs_cap_array_len;
+	const lwfs_cap *caps = args->caps.lwfs_cap_array_val;
+
+	trace_event(TRACE_NAMING_RESOLVE, 0, "resolve");
+
+	log_debug(naming_debug_level, "starting lwfs_resolve_path (%u names)", num_names);
+	if (logging_debug(naming_debug_level) && print_args) {
+		FILE *fp = logger_get_file();
+		fprint_lwfs_ns_entry(fp, "args->start", "DEBUG\t", start);
+		for (i=0; i<num_names; i++) {
+			fprint_lwfs_name(fp, "args->names[i]", "DEBUG\t", &names[i]);
+		}
+	}
+
+	/* initialize the result */
+	memset(result, 0, sizeof(lwfs_resolve_path_res));
+
+	if ((num_names == 0) || (num_caps == 0)) {
+		log_error(naming_debug_level, "need at least one name and one cap");
+		return LWFS_ERR;
+	}
+
+	count = (args->want_all) ? num_names : 1;
+
+	ns_ents = (lwfs_ns_entry *)calloc(count, sizeof(lwfs_ns_entry));
+	verified = (lwfs_bool *)calloc(num_caps, sizeof(lwfs_bool));
+	if ((ns_ents == NULL) || (verified == NULL)) {
+		log_error(naming_debug_level, "could not allocate entries");
+		rc = LWFS_ERR_NOSPACE;
+		goto cleanup;
+	}
+
+	/* start from what the database has, not what the client sent */
+	rc = naming_db_get_by_oid(&start->dirent_oid, &db_entry);
+	if (rc != LWFS_OK) {
+		log_warn(naming_debug_level, "could not get start entry: %s",
+			lwfs_err_str(rc));
+		goto cleanup;
+	}
+
+	for (i=0; i<num_names; i++) {
+
+		/* the entry in hand is the parent of the next name */
+		if ((db_entry.inode.entry_obj.type != LWFS_DIR_ENTRY) &&
+		    (db_entry.inode.entry_obj.type != LWFS_NS_OBJ)) {
+			log_warn(naming_debug_level, "\"%s\" is not a directory",
+				db_entry.dirent.name);
+			result->rc = LWFS_ERR_NOTDIR;
+			break;
+		}
+
+		/* the caller needs to READ the directory */
+		result->rc = check_resolve_cap(db_entry.inode.entry_obj.cid,
+				caps, num_caps, verified);
+		if (result->rc != LWFS_OK) {
+			log_warn(naming_debug_level, "unable to authorize lookup of \"%s\": %s",
+				names[i], lwfs_err_str(result->rc));
+			break;
+		}
+
+		memcpy(&dir_oid, &db_entry.dirent.oid, sizeof(lwfs_oid));
+		result->rc = naming_db_get_by_name(&dir_oid, names[i], &db_entry);
+		if (result->rc != LWFS_OK) {
+			log_debug(naming_debug_level,
+				"could not get entry for oid=%s, key=\"%s\": %s",
+				lwfs_oid_to_string(dir_oid, ostr), names[i], 
+				lwfs_err_str(result->rc));
+			break;
+		}
+
+		if (args->want_all) {
+			copy_db_to_ns_entry(&ns_ents[found++], &db_entry);
+		}
+		else {
+			/* keep only the deepest entry */
+			free(ns_ents[0].file_obj);
+			copy_db_to_ns_entry(&ns_ents[0], &db_entry);
+			found = 1;
+		}
+	}
+
+	/* set the result */
+	result->failed = i;
+	if (found > 0) {
+		result->entries.lwfs_ns_entry_array_len = found;
+		result->entries.lwfs_ns_entry_array_val = ns_ents;
+		ns_ents = NULL;
+	}
+
+cleanup:
+	if (ns_ents != NULL) {
+		for (i=0; i<found; i++) {
+			free(ns_ents[i].file_obj);
+		}
+		free(ns_ents);
+	}
+	free(verified);
+
+	log_debug(naming_debug_level, "finished lwfs_resolve_path");
+
+	return rc;
+}
+
+
 /**
  * @brief Read the contents of a directory.
  *
@@ -1416,6 +1777,108 @@ cleanup:
 	return rc;
 }
 
+/**
+ * @brief Read one page of the contents of a directory.
+ *
+ * The \b naming_list_dir_page method returns up to \em max_entries
+ * entries of the parent directory, in name order, starting after
+ * the cookie returned with the previous page.  Only names that
+ * match the pattern are returned, so the server does the filtering.
+ * With \em names_only set, the server does not look up the inodes
+ * (the entries only have the name and the oids).
+ */
+int naming_list_dir_page(
+		const lwfs_remote_pid *caller,
+		const lwfs_list_dir_page_args *args,
+		const lwfs_rma *data_addr,
+		lwfs_list_dir_page_res *result)
+{
+	int rc = LWFS_OK;
+	int i;
+	int count = 0;
+	lwfs_bool eof = FALSE;
+	naming_db_entry *db_ents = NULL;
+	lwfs_ns_entry *ns_ents = NULL;
+	int max_entries = args->max_entries;
+
+	/* copy arguments */
+	const lwfs_ns_entry *parent = args->parent;
+	const char *cookie = (args->cookie)? args->cookie : "";
+	const char *pattern = (args->pattern)? args->pattern : "";
+	const lwfs_cap *cap = args->cap;
+
+	trace_event(TRACE_NAMING_LS_PAGE, 0, "ls page");
+
+	/* initialize the result */
+	memset(result, 0, sizeof(lwfs_list_dir_page_res));
+
+	log_debug(naming_debug_level, "starting naming_list_dir_page (cookie=\"%s\", max=%d)",
+			cookie, max_entries);
+
+	/* make sure the parent is a directory */
+	if ((parent->entry_obj.type != LWFS_DIR_ENTRY) &&
+	    (parent->entry_obj.type != LWFS_NS_OBJ)) {
+		log_error(naming_debug_level, "parent is not a directory");
+		rc = LWFS_ERR_NOTDIR;
+		goto cleanup;
+	}
+
+	/* Check permissions. The caller needs to have the capability
+	 * to access (i.e., READ) from the parent directory.
+	 */
+	rc = check_perm(&parent->dirent_oid, cap, LWFS_CONTAINER_READ);
+	if (rc != LWFS_OK) {
+		log_error(naming_debug_level, "unable to authorize operation: %s",
+			lwfs_err_str(rc));
+		goto cleanup;
+	}
+
+	if ((max_entries <= 0) || (max_entries > LWFS_LIST_DIR_MAX_ENTRIES)) {
+		max_entries = LWFS_LIST_DIR_MAX_ENTRIES;
+	}
+
+	/* allocate space for the entries */
+	db_ents = (naming_db_entry *)malloc(max_entries*sizeof(naming_db_entry));
+	ns_ents = (lwfs_ns_entry *)malloc(max_entries*sizeof(lwfs_ns_entry));
+	if ((db_ents == NULL) || (ns_ents == NULL)) {
+		log_error(naming_debug_level, "could not allocate entries");
+		rc = LWFS_ERR_NOSPACE;
+		goto cleanup;
+	}
+
+	/* fetch the page */
+	rc = naming_db_get_page_by_parent(&parent->dirent_oid, cookie, pattern,
+			args->names_only, db_ents, max_entries, &count, &eof);
+	if (rc != LWFS_OK) {
+		log_error(naming_debug_level, "could not get entries: %s",
+				lwfs_err_str(rc));
+		goto cleanup;
+	}
+
+	/* copy the objects in the entries to the result array */
+	for (i=0; i<count; i++) {
+		copy_db_to_ns_entry(&ns_ents[i], &db_ents[i]);
+	}
+
+	/* the next page starts after the last name of this one */
+	result->cookie = strdup((count > 0)? ns_ents[count-1].name : cookie);
+	result->eof = eof;
+	if (count > 0) {
+		result->entries.lwfs_ns_entry_array_len = count;
+		result->entries.lwfs_ns_entry_array_val = ns_ents;
+		ns_ents = NULL;
+	}
+
+cleanup:
+	free(db_ents);
+	free(ns_ents);
+
+	log_debug(naming_debug_level, "finished naming_list_dir_page (count=%d, eof=%d)",
+			count, eof);
+
+	return rc;
+}
+
 int naming_list_all() {
 	return naming_db_print_all();
 }
@@ -1467,3 +1930,56 @@ int naming_stat(
 
 	return rc;
 }
+
+
+/**
+ * @brief Revoke operations of a container.
+ *
+ * The authorization server calls this function when the ACLs
+ * of a container change.  We send caps for the container to
+ * the authorization server from now on.  Requests from anyone 
+ * but the authorization server are rejected.
+ */
+int naming_revoke_caps(
+		const lwfs_remote_pid *caller,
+		const lwfs_revoke_caps_args *args,
+		const lwfs_rma *data_addr,
+		void *res)
+{
+	int rc = LWFS_OK;
+
+	rc = cap_verifier_check_sender(&authr_svc, caller);
+	if (rc != LWFS_OK) {
+		return rc;
+	}
+
+	log_debug(naming_debug_level, "revoking caps for cid=%llu, container_op=%d",
+			(unsigned long long)args->cid, (int)args->container_op);
+
+	return cap_verifier_revoke(args->cid, args->container_op, args->generation);
+}
+
+/**
+ * @brief Replace the key used to verify caps.
+ *
+ * The authorization server calls this function after it
+ * rotates its key.  Keys from anyone but the authorization 
+ * server are rejected.
+ */
+int naming_set_cap_key(
+		const lwfs_remote_pid *caller,
+		const lwfs_set_cap_key_args *args,
+		const lwfs_rma *data_addr,
+		void *res)
+{
+	int rc = LWFS_OK;
+
+	rc = cap_verifier_check_sender(&authr_svc, caller);
+	if (rc != LWFS_OK) {
+		return rc;
+	}
+
+	log_debug(naming_debug_level, "received new cap key");
+
+	return cap_verifier_set_key(args->info);
+}
@@ -38,6 +38,7 @@ extern "C" {
 		const char *dp_path,
 		const lwfs_bool db_clear,
 		const lwfs_bool db_recover,
+		const lwfs_bool local_caps,
 		const lwfs_service *authr_svc, 
 		lwfs_service *svc);
 
@@ -187,6 +188,18 @@ extern "C" {
 			const lwfs_rma *data_addr, 
 			lwfs_ns_entry *result);
 
+	/** 
+	 * @brief Create many files in one directory.
+	 * 
+	 * The \ref lwfs_create_files method creates a file entry 
+	 * for each name, with one check of the cap. 
+	 */
+	extern int naming_create_files(
+			const lwfs_remote_pid *caller, 
+			const lwfs_create_files_args *args,
+			const lwfs_rma *data_addr, 
+			lwfs_create_files_res *result);
+
 	/** 
 	 * @brief Remove a file. 
 	 *
@@ -255,6 +268,25 @@ extern "C" {
 			lwfs_ns_entry *result);
 
 
+	/** 
+	 * @brief Resolve a path in one request.
+	 *
+	 * Looks up each name of the path in turn, starting from 
+	 * \em args->start.  The caps in the args have to cover the 
+	 * container of each directory on the path; each cap is 
+	 * verified once, however many directories it covers.  The 
+	 * result holds the entry of every name if \em args->want_all 
+	 * is set, or just the entry of the last name.  If a name can not 
+	 * be resolved, the result holds the entries found before it, the 
+	 * error, and the index of the name. 
+	 */
+	extern int naming_resolve_path(
+			const lwfs_remote_pid *caller, 
+			const lwfs_resolve_path_args *args, 
+			const lwfs_rma *data_addr, 
+			lwfs_resolve_path_res *result);
+
+
 	/** 
 	 * @brief Read the contents of a directory.
 	 *
@@ -276,6 +308,18 @@ extern "C" {
 			const lwfs_rma *data_addr, 
 			lwfs_ns_entry_array *result);
 
+	/** 
+	 * @brief Read one page of the contents of a directory.
+	 *
+	 * Entries come back in name order, starting after the
+	 * cookie of the previous page, filtered by a name pattern.
+	 */
+	extern int naming_list_dir_page(
+			const lwfs_remote_pid *caller, 
+			const lwfs_list_dir_page_args *args, 
+			const lwfs_rma *data_addr, 
+			lwfs_list_dir_page_res *result);
+
 	extern int lwfs_list_all();
 
 	/**
@@ -288,6 +332,24 @@ extern "C" {
 			const lwfs_rma *data_addr,
 			lwfs_stat_data *res); 
 
+	/**
+	 * @brief Revoke operations of a container (sent by the authr server).
+	 */
+	extern int naming_revoke_caps(
+			const lwfs_remote_pid *caller,
+			const lwfs_revoke_caps_args *args,
+			const lwfs_rma *data_addr,
+			void *res); 
+
+	/**
+	 * @brief Replace the key used to verify caps (sent by the authr server).
+	 */
+	extern int naming_set_cap_key(
+			const lwfs_remote_pid *caller,
+			const lwfs_set_cap_key_args *args,
+			const lwfs_rma *data_addr,
+			void *res); 
+
 #else /* K&R C */
 
 #endif
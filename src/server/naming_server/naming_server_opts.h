@@ -27,6 +27,8 @@ void print_naming_server_opts(
 			((args_info->naming_db_clear_flag)?"true":"false"));
 	fprintf(fp, "%s \tnaming-db-recover = %s\n", prefix, 
 			((args_info->naming_db_recover_flag)?"true":"false"));
+	fprintf(fp, "%s \tnaming-local-caps = %s\n", prefix, 
+			((args_info->naming_local_caps_flag)?"true":"false"));
 }
 
 #endif
@@ -67,6 +67,7 @@
 #include "common/rpc_common/rpc_debug.h"
 #include "common/rpc_common/lwfs_ptls.h"
 #include "common/rpc_common/ptl_wrap.h"
+#include "common/rpc_common/ptl_pool.h"
 #include "common/rpc_common/rpc_opcodes.h"
 #include "common/rpc_common/rpc_trace.h"
 #include "common/rpc_common/service_args.h"
@@ -97,32 +98,6 @@ int rpc_trace_reset(
 #define lwfs_thread_pool_getrank() 0
 #endif
 
-/* to synchronize access to portals calls */
-/*
- *  On BSD (Darwin/MacOS), pthread_mutex_t is not recursive by default, and so the static
- *  initializer here doesn't work.  Instead, we have to play a little compiler trick, 
- *  getting gcc to generate a file-scope constructor for it.  I'm going to
- *  leave the bail-out #error if we're not being compiled with GCC, since porting
- *  to another compiler should make for a lot of work in other places, not just here.
- */
-#if (defined(__APPLE__) && defined(__GNUC__))
-
-static pthread_mutex_t meminfo_mutex;
-
-static void __attribute__ ((constructor)) thunk(void)
-{
-#if 0
-  pthread_mutexattr_t attr;
-  pthread_mutexattr_init( &attr );
-  pthread_mutexattr_settype( &attr, PTHREAD_MUTEX_RECURSIVE );
-  pthread_mutex_init( &portals_mutex, &attr );
-#endif
-}
-
-#else
-static pthread_mutex_t meminfo_mutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
-#endif          
-
 /**
   * @brief Array of operations supported by all services.
   *
@@ -167,20 +142,90 @@ typedef struct {
     lwfs_thread_pool_args *pool_args;
 } thread_args; 
 
+/* an operation registered with a service, and its counters */
+struct svc_op_entry {
+    lwfs_svc_op op;
+
+    pthread_mutex_t stats_mutex;
+    lwfs_svc_op_stats stats;
+};
+
+/* the operations of one service, indexed by opcode */
+struct svc_op_table {
+    lwfs_bool in_use;
+    lwfs_match_bits match_bits;
+
+    /* ops[opcode] is NULL if the service has no such op */
+    struct svc_op_entry **ops;
+    int len;    /* entries in ops (largest opcode + 1) */
+
+    /* requests with an opcode we do not have */
+    long unknown;
+};
+
+struct req_ring;
+
+/* a segment of the ring of request buffers */
+struct req_segment {
+    int index;
+    char *buf;
+    struct req_ring *ring;
+
+    ptl_md_t md;
+    ptl_handle_md_t md_h;
+    ptl_handle_me_t me_h;
+
+    pthread_mutex_t mutex;
+    lwfs_bool posted;
+    int received;   /* requests put in the segment since we posted it */
+    int refcount;   /* requests still using the segment */
+};
+
+/* the request buffers of a running service */
+struct req_ring {
+    int num_segments;
+    int reqs_per_segment;
+    int req_size;
+    struct req_segment *segments;
+
+    /* where the segments go */
+    ptl_handle_ni_t ni_h;
+    ptl_handle_eq_t eq_h;
+    ptl_pt_index_t pt_index;
+    ptl_process_id_t match_id;
+    ptl_match_bits_t match_bits;
+    ptl_match_bits_t ignore_bits;
+
+    /* counters */
+    pthread_mutex_t stats_mutex;
+    int num_posted;     /* segments Portals can put requests in */
+    int min_posted;     /* fewest posted at once */
+    long reposts;       /* segments posted again */
+    long deferred;      /* segments that filled up while still in use */
+};
+
 typedef struct {
     lwfs_service *svc;
+    struct svc_op_table *op_table;
     lwfs_remote_pid caller;
     char *req_buf;
     lwfs_size short_req_len;
+    struct req_segment *seg;   /* holds req_buf */
 } thr_request;
 
 
 
-static lwfs_svc_op *supported_ops = NULL;
-static int num_supported_ops = 0;
+/* one op table per service (keyed by match bits) in this process */
+static struct svc_op_table op_tables[LWFS_SVC_MAX_SERVICES];
+static pthread_mutex_t op_tables_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+/* memory in use (kB) above which we turn away requests (0 = no limit) */
 unsigned long max_mem_allowed=0;
 
+/* size of the ring of request buffers (see lwfs_service_set_request_ring) */
+static int req_segments = LWFS_SVC_REQ_SEGMENTS;
+static int reqs_per_segment = LWFS_SVC_REQS_PER_SEGMENT;
+
 /* ----------- Implementation of core services ----------- */
 
 /**
@@ -372,6 +417,7 @@ static int send_result(
 		void *result) 
 {
 	static uint32_t res_counter = 1;  
+	static pthread_mutex_t res_counter_mutex = PTHREAD_MUTEX_INITIALIZER; 
 
 	/* portals structs */
 	ptl_handle_ni_t ni_h; 
@@ -438,7 +484,12 @@ static int send_result(
 
 	/* allocated an xdr memory stream for the short result buffer */ 
 	assert(dest_addr->len > 0);
-	short_res_buf = calloc(dest_addr->len, 1);
+	short_res_buf = lwfs_ptl_pool_buf_get(dest_addr->len);
+	if (short_res_buf == NULL) {
+		log_fatal(rpc_debug_level, "out of space for the short result");
+		return LWFS_ERR_NOSPACE;
+	}
+	memset(short_res_buf, 0, dest_addr->len);
 	xdrmem_create(&hdr_xdrs, short_res_buf, 
 			dest_addr->len, XDR_ENCODE); 
 
@@ -478,7 +529,10 @@ static int send_result(
 	/* if result does not fit, client has to fetch result */
 	else { 
 
+		/* threads send results at the same time */
+		pthread_mutex_lock(&res_counter_mutex);
 		match_bits = res_counter++;
+		pthread_mutex_unlock(&res_counter_mutex);
 
 		log_debug(rpc_debug_level,"thread_id(%d): sending long result %lu, "
 				"available space = %d, result_size = %d", 
@@ -496,9 +550,8 @@ static int send_result(
 
 		/* post the memory descriptor for the long result */
 
-		/* create an event queue */
-		/* TODO: should we share an event queue? */
-		rc = lwfs_ptl_eq_alloc(ni_h, 5, PTL_EQ_HANDLER_NONE, &eq_h); 
+		/* get an event queue */
+		rc = lwfs_ptl_pool_eq_get(&eq_h); 
 		if (rc != LWFS_OK) {
 			log_error(rpc_debug_level, "failed to allocate eventq");
 			rc = LWFS_ERR_RPC;
@@ -670,10 +723,10 @@ cleanup:
 	if (header.fetch_result) {
 		int rc2; 
 
-		/* free the event queue */
-		rc2 = lwfs_ptl_eq_free(eq_h); 
+		/* recycle the event queue */
+		rc2 = (rc == LWFS_OK)? lwfs_ptl_pool_eq_put(eq_h) : lwfs_ptl_pool_eq_discard(eq_h); 
 		if (rc2 != LWFS_OK) {
-			log_error(rpc_debug_level, "unable to free EQ");
+			log_error(rpc_debug_level, "unable to release EQ");
 			rc2 = LWFS_ERR_RPC; 
 		}
 
@@ -681,8 +734,8 @@ cleanup:
 		free(long_res_buf);
 	}
 
-	/* free the short result buffer */
-	free(short_res_buf);
+	/* recycle the short result buffer */
+	lwfs_ptl_pool_buf_put(short_res_buf, dest_addr->len);
 
 	log_debug(rpc_debug_level, "thread_id(%d): result %lu sent", thread_id, id);
 
@@ -711,6 +764,322 @@ static void *thread_start(void *args)
 
 
 
+/**
+ * @brief Find the op table of a service.
+ *
+ * Call with op_tables_mutex held.  If \em create is true and
+ * the service has no table yet, take a free one.
+ */
+static struct svc_op_table *find_op_table(
+        const lwfs_service *svc,
+        const lwfs_bool create)
+{
+    int i;
+    struct svc_op_table *free_table = NULL;
+
+    for (i=0; i<LWFS_SVC_MAX_SERVICES; i++) {
+        if (!op_tables[i].in_use) {
+            if (free_table == NULL) free_table = &op_tables[i];
+            continue;
+        }
+        if (op_tables[i].match_bits == svc->req_addr.match_bits) {
+            return &op_tables[i];
+        }
+    }
+
+    if (!create || (free_table == NULL)) {
+        return NULL;
+    }
+
+    memset(free_table, 0, sizeof(struct svc_op_table));
+    free_table->in_use = TRUE;
+    free_table->match_bits = svc->req_addr.match_bits;
+
+    return free_table;
+}
+
+/**
+ * @brief Is this one of the ops every service has (\ref svc_op_array)?
+ */
+static lwfs_bool is_core_op(const lwfs_opcode opcode)
+{
+    int i;
+
+    for (i=0; svc_op_array[i].opcode != LWFS_OP_NULL; i++) {
+        if (svc_op_array[i].opcode == opcode) {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/**
+ * @brief Count a finished request in the stats of its operation.
+ */
+static void record_op_stats(
+        struct svc_op_entry *entry,
+        const int op_rc,
+        const double elapsed)
+{
+    int bucket = 0;
+    double usec = elapsed * 1.0e6;
+
+    /* bucket i holds [2^i, 2^(i+1)) usec */
+    while ((usec >= 2.0) && (bucket < LWFS_SVC_OP_HIST_BUCKETS-1)) {
+        usec /= 2.0;
+        bucket++;
+    }
+
+    pthread_mutex_lock(&entry->stats_mutex);
+    entry->stats.calls++;
+    if (op_rc != LWFS_OK) {
+        entry->stats.errors++;
+    }
+    entry->stats.total_time += elapsed;
+    if (elapsed > entry->stats.max_time) {
+        entry->stats.max_time = elapsed;
+    }
+    entry->stats.hist[bucket]++;
+    pthread_mutex_unlock(&entry->stats_mutex);
+}
+
+
+/* ----------- The ring of request buffers ----------- */
+
+/**
+ * @brief Post a segment of the ring, so clients can put requests in it.
+ *
+ * The match entry goes after the other entries, so Portals fills
+ * the posted segments in the order we posted them.
+ */
+static int post_segment(
+	struct req_segment *seg)
+{
+	int rc = LWFS_OK;
+	struct req_ring *ring = seg->ring;
+
+	rc = lwfs_ptl_me_attach(ring->ni_h, ring->pt_index,
+		ring->match_id, ring->match_bits, ring->ignore_bits,
+		PTL_RETAIN, PTL_INS_AFTER, &seg->me_h);
+	if (rc != LWFS_OK) {
+		log_error(rpc_debug_level, "could not attach ME for segment %d", seg->index);
+		return rc;
+	}
+
+	rc = lwfs_ptl_md_attach(seg->me_h, seg->md, PTL_RETAIN, &seg->md_h);
+	if (rc != LWFS_OK) {
+		log_error(rpc_debug_level, "could not attach MD for segment %d", seg->index);
+		lwfs_ptl_me_unlink(seg->me_h);
+		return rc;
+	}
+
+	seg->posted = TRUE;
+	seg->received = 0;
+
+	pthread_mutex_lock(&ring->stats_mutex);
+	ring->num_posted++;
+	pthread_mutex_unlock(&ring->stats_mutex);
+
+	return rc;
+}
+
+/**
+ * @brief Allocate and post the segments of the ring.
+ */
+static int req_ring_init(
+	struct req_ring *ring,
+	const lwfs_service *svc,
+	ptl_handle_ni_t ni_h,
+	ptl_handle_eq_t eq_h)
+{
+	int rc = LWFS_OK;
+	int i;
+	struct req_segment *seg;
+
+	memset(ring, 0, sizeof(struct req_ring));
+
+	ring->num_segments = req_segments;
+	ring->reqs_per_segment = reqs_per_segment;
+	ring->req_size = svc->req_addr.len;
+	ring->ni_h = ni_h;
+	ring->eq_h = eq_h;
+	ring->pt_index = svc->req_addr.buffer_id;
+	ring->match_id.nid = PTL_NID_ANY;
+	ring->match_id.pid = PTL_PID_ANY;
+	ring->match_bits = svc->req_addr.match_bits;
+	ring->ignore_bits = 0;
+	ring->min_posted = ring->num_segments;
+	pthread_mutex_init(&ring->stats_mutex, NULL);
+
+	ring->segments = (struct req_segment *)calloc(ring->num_segments,
+			sizeof(struct req_segment));
+	if (ring->segments == NULL) {
+		log_error(rpc_debug_level, "out of memory");
+		return LWFS_ERR_NOSPACE;
+	}
+
+	for (i=0; i<ring->num_segments; i++) {
+		seg = &ring->segments[i];
+
+		seg->index = i;
+		seg->ring = ring;
+		pthread_mutex_init(&seg->mutex, NULL);
+
+		/* allocate the buffer for the incoming MD */
+		seg->buf = (char *)calloc(ring->reqs_per_segment, ring->req_size);
+		if (seg->buf == NULL) {
+			log_error(rpc_debug_level, "out of memory");
+			return LWFS_ERR_NOSPACE;
+		}
+
+		/* initialize the MD */
+		seg->md.start = seg->buf;
+		seg->md.length = ring->reqs_per_segment*ring->req_size;
+		seg->md.threshold = ring->reqs_per_segment;
+		seg->md.max_size = ring->req_size;
+		seg->md.options = PTL_MD_OP_PUT | PTL_MD_MAX_SIZE;
+		seg->md.user_ptr = seg;
+		seg->md.eq_handle = eq_h;
+
+		log_debug(rpc_debug_level, "posting segment %d on index=%d",
+				i, ring->pt_index);
+
+		rc = post_segment(seg);
+		if (rc != LWFS_OK) {
+			return rc;
+		}
+	}
+
+	return rc;
+}
+
+/**
+ * @brief Unlink the posted segments and free the ring.
+ *
+ * Call only after every request is done (e.g., after the
+ * thread pool has shut down).
+ */
+static int req_ring_fini(
+	struct req_ring *ring)
+{
+	int rc = LWFS_OK;
+	int i;
+	struct req_segment *seg;
+
+	if (ring->segments == NULL) {
+		return rc;
+	}
+
+	for (i=0; i<ring->num_segments; i++) {
+		seg = &ring->segments[i];
+
+		/* unlink the ME (also unlinks the MD) */
+		if (seg->posted || (seg->received > 0)) {
+			if (lwfs_ptl_me_unlink(seg->me_h) != LWFS_OK) {
+				log_warn(rpc_debug_level, "unable to unlink segment %d", i);
+				rc = LWFS_ERR;
+			}
+		}
+
+		pthread_mutex_destroy(&seg->mutex);
+		free(seg->buf);
+	}
+
+	free(ring->segments);
+	ring->segments = NULL;
+	pthread_mutex_destroy(&ring->stats_mutex);
+
+	return rc;
+}
+
+/**
+ * @brief Count a request that arrived in a segment.
+ *
+ * The request holds a reference on the segment until it
+ * is done with the request buffer.
+ */
+static void segment_hold(
+	struct req_segment *seg)
+{
+	struct req_ring *ring = seg->ring;
+
+	pthread_mutex_lock(&seg->mutex);
+	seg->received++;
+	seg->refcount++;
+	if (seg->received >= ring->reqs_per_segment) {
+		/* Portals will not put anything else in here */
+		seg->posted = FALSE;
+
+		pthread_mutex_lock(&ring->stats_mutex);
+		ring->num_posted--;
+		if (ring->num_posted < ring->min_posted) {
+			ring->min_posted = ring->num_posted;
+		}
+		if (seg->refcount > 1) {
+			/* earlier requests still use the segment */
+			ring->deferred++;
+		}
+		pthread_mutex_unlock(&ring->stats_mutex);
+
+		if (ring->num_posted == 0) {
+			log_warn(rpc_debug_level, "all request segments are full");
+		}
+	}
+	pthread_mutex_unlock(&seg->mutex);
+}
+
+/**
+ * @brief A request is done with its buffer.
+ *
+ * The last request out of a full segment posts the
+ * segment again.
+ */
+static void segment_release(
+	struct req_segment *seg)
+{
+	struct req_ring *ring = seg->ring;
+
+	pthread_mutex_lock(&seg->mutex);
+	seg->refcount--;
+	if ((seg->refcount == 0) && (seg->received >= ring->reqs_per_segment)) {
+
+		log_debug(rpc_debug_level, "reposting segment %d", seg->index);
+
+		/* Unlink the ME (also unlinks the MD) */
+		if (lwfs_ptl_me_unlink(seg->me_h) != LWFS_OK) {
+			log_error(rpc_debug_level, "could not unlink segment %d", seg->index);
+		}
+		else if (post_segment(seg) != LWFS_OK) {
+			log_error(rpc_debug_level, "could not repost segment %d", seg->index);
+		}
+		else {
+			pthread_mutex_lock(&ring->stats_mutex);
+			ring->reposts++;
+			pthread_mutex_unlock(&ring->stats_mutex);
+		}
+	}
+	pthread_mutex_unlock(&seg->mutex);
+}
+
+/**
+ * @brief Print the counters of the ring.
+ */
+static void fprint_req_ring_stats(
+	FILE *fp,
+	const char *prefix,
+	struct req_ring *ring)
+{
+	pthread_mutex_lock(&ring->stats_mutex);
+	fprintf(fp, "%s request segments = %d x %d requests\n", prefix,
+			ring->num_segments, ring->reqs_per_segment);
+	fprintf(fp, "%s   reposts = %ld\n", prefix, ring->reposts);
+	fprintf(fp, "%s   filled while in use = %ld\n", prefix, ring->deferred);
+	fprintf(fp, "%s   fewest posted = %d\n", prefix, ring->min_posted);
+	pthread_mutex_unlock(&ring->stats_mutex);
+}
+
+
 /** 
  * @brief Process a received requests.
  * 
@@ -729,7 +1098,13 @@ int process_request(
 {
 	XDR xdrs; 
 	int rc; 
-	int index = 0;
+	int op_rc = LWFS_OK;
+	int admitted = FALSE;
+	double t_start = lwfs_get_time();
+	struct svc_op_entry *entry = NULL;
+	const lwfs_svc_op *op = NULL;
+	void *args = NULL;
+	void *res = NULL;
 
 	lwfs_request_header header; 
 	static volatile long req_count = 0;
@@ -740,7 +1115,7 @@ int process_request(
 	interval_id = req_count; 
 
 	thr_request *data = (thr_request *)a_request->client_data;
-	/*lwfs_service *svc = data->svc;*/
+	struct svc_op_table *op_table = data->op_table;
 	lwfs_remote_pid caller = data->caller;
 	char *req_buf = data->req_buf;
 	lwfs_size short_req_len = data->short_req_len;
@@ -748,25 +1123,6 @@ int process_request(
 	
 	log_debug(rpc_debug_level, "i'm doing the work.  my rank is %d", lwfs_thread_pool_getrank());
 
-	/* memory check - log memory statistics.  if memory in use 
-	 * is greater than maximum memory allowed, then exit.
-	 */
-        rc = pthread_mutex_lock(&meminfo_mutex);
-	log_meminfo(rpc_debug_level);
-	unsigned long main_memory_in_use = main_memory_used();
-        rc = pthread_mutex_unlock(&meminfo_mutex);
-	log_debug(rpc_debug_level, 
-	    	"max memory check (allowed=%lukB, in_use=%lukB, %%free=%f)", 
-	    	max_mem_allowed, main_memory_in_use, 100.0-(((float)main_memory_in_use/(float)max_mem_allowed)*100.0));
-	if ((max_mem_allowed > 0) && 
-	    (main_memory_in_use > max_mem_allowed)) {
-	    rc = LWFS_OK;
-	    log_error(rpc_debug_level, 
-	    	"max memory allowed exceeded (allowed=%lukB, in_use=%lukB), exiting", 
-	    	max_mem_allowed, main_memory_in_use);
-	    goto cleanup;
-	}
-
 	/* initialize the request header */
 	memset(&header, 0, sizeof(lwfs_request_header));
 
@@ -789,122 +1145,396 @@ int process_request(
 
 
 
-	/* linear search to find out if the operation is in our list of ops */
-	index = 0; 
-	for (index=0; index<num_supported_ops; index++) {
-
-		const lwfs_svc_op *op = &supported_ops[index]; 
+	/* find the operation in the service's table */
+	if ((op_table != NULL) && (header.opcode < (lwfs_opcode)op_table->len)) {
+		entry = op_table->ops[header.opcode];
+	}
 
-		/* if there is a match, extract the args and execute the function */
-		if (op->opcode == header.opcode) {
+	if (entry == NULL) {
+		log_warn(rpc_debug_level, "thread_id(%d): unrecognized request: opcode=%d", thread_id,
+				header.opcode);
+		if (op_table != NULL) {
+			pthread_mutex_lock(&op_tables_mutex);
+			op_table->unknown++;
+			pthread_mutex_unlock(&op_tables_mutex);
+		}
+		rc = LWFS_ERR_RPC; 
+		goto cleanup;
+	}
 
-			/* allocate space for args and result (these are passed in with the header) */
-			void *args = malloc(header.args_addr.len); 
-			void *res  = malloc(header.res_addr.len); 
+	op = &entry->op; 
 
-			/* initialize args and res */
-			memset(args, 0, header.args_addr.len); 
-			memset(res, 0, header.res_addr.len); 
-			log_debug(rpc_debug_level, "thread_id(%d): header.res_addr.len==%d\n", 
-					thread_id, header.res_addr.len);
+	/* admission control - if memory in use (sampled in the 
+	 * background) is greater than the maximum allowed, turn 
+	 * the request away.  Core ops still run, so we can kill
+	 * the server.
+	 */
+	if ((max_mem_allowed > 0) && !is_core_op(header.opcode)) {
+		unsigned long main_memory_in_use = sysmon_memory_used();
+		if (main_memory_in_use > max_mem_allowed) {
+			log_debug(rpc_debug_level, 
+					"max memory allowed exceeded (allowed=%lukB, in_use=%lukB), "
+					"rejecting request %lu", 
+					max_mem_allowed, main_memory_in_use, header.id);
+
+			pthread_mutex_lock(&entry->stats_mutex);
+			entry->stats.rejected++;
+			pthread_mutex_unlock(&entry->stats_mutex);
 
-			/* If the args fit in the header, extract them from the 
-			 * header buffer.  Otherwise, get them from the client 
-			 */
-			if (!header.fetch_args) {
-				if (! op->decode_args(&xdrs, args)) {
-					log_fatal(rpc_debug_level,"could not decode args");
-					rc = LWFS_ERR_DECODE; 
-					goto cleanup; 
-				}
-			}
-			else {
-				/* fetch the operation arguments */
-				log_debug(rpc_debug_level, "thread_id(%d): fetching args", thread_id);
-				// is reentrant??
-				rc = fetch_args(
-						&header, 
-						op->decode_args, 
-						args);
-				if (rc != LWFS_OK) {
-					log_fatal(rpc_debug_level, 
-							"thread_id(%d): unable to fetch args", thread_id);
-					goto cleanup; 
-				}
+			rc = send_result(thread_id, header.id, &header.res_addr, 
+					(xdrproc_t)&xdr_void, LWFS_ERR_BUSY, NULL);
+			if (rc != LWFS_OK) {
+				log_error(rpc_debug_level, "thread_id(%d): unable to send result %lu",
+						thread_id, header.id);
 			}
+			goto cleanup;
+		}
+	}
 
-			/*
-			 ** Process the request (print warning if method fails), but
-			 ** don't return error, because some operations are meant to fail
-			 */
-			log_debug(rpc_debug_level, "thread_id(%d): calling the server function", thread_id);
-
-			trace_start_interval(interval_id, thread_id);
+	admitted = TRUE;
 
-			// is reentrant??
-			rc = op->func(&caller, args, &header.data_addr, res); 
-			if (rc != LWFS_OK) {
-				log_warn(rpc_debug_level, "thread_id(%d): User op failed: rc=%d", thread_id, rc);
-			}
-			trace_end_interval(interval_id, TRACE_RPC_PROC, thread_id, "operation timer");
+	/* allocate space for args and result (these are passed in with the header) */
+	args = malloc(header.args_addr.len); 
+	res  = malloc(header.res_addr.len); 
 
-			/* send result back to client */
-			log_debug(rpc_debug_level, "thread_id(%d): sending result %lu back to client", 
-					thread_id, header.id);
-			// is reentrant??
+	/* initialize args and res */
+	memset(args, 0, header.args_addr.len); 
+	memset(res, 0, header.res_addr.len); 
+	log_debug(rpc_debug_level, "thread_id(%d): header.res_addr.len==%d\n", 
+			thread_id, header.res_addr.len);
 
+	/* If the args fit in the header, extract them from the 
+	 * header buffer.  Otherwise, get them from the client 
+	 */
+	if (!header.fetch_args) {
+		if (! op->decode_args(&xdrs, args)) {
+			log_fatal(rpc_debug_level,"could not decode args");
+			rc = LWFS_ERR_DECODE; 
+			op_rc = rc;
+			goto cleanup; 
+		}
+	}
+	else {
+		/* fetch the operation arguments */
+		log_debug(rpc_debug_level, "thread_id(%d): fetching args", thread_id);
+		// is reentrant??
+		rc = fetch_args(
+				&header, 
+				op->decode_args, 
+				args);
+		if (rc != LWFS_OK) {
+			log_fatal(rpc_debug_level, 
+					"thread_id(%d): unable to fetch args", thread_id);
+			op_rc = rc;
+			goto cleanup; 
+		}
+	}
 
-			/* measure time for the send result portion */
-			trace_start_interval(interval_id, thread_id);
+	/*
+	 ** Process the request (print warning if method fails), but
+	 ** don't return error, because some operations are meant to fail
+	 */
+	log_debug(rpc_debug_level, "thread_id(%d): calling the server function", thread_id);
 
-			lwfs_ptl_lock();
-			rc = send_result(thread_id, header.id, &header.res_addr, 
-					op->encode_res, rc, res);
-			lwfs_ptl_unlock();
+	trace_start_interval(interval_id, thread_id);
 
-			trace_end_interval(interval_id, TRACE_RPC_SENDRES, thread_id, "sendres timer");
+	// is reentrant??
+	rc = op->func(&caller, args, &header.data_addr, res); 
+	op_rc = rc;
+	if (rc != LWFS_OK) {
+		log_warn(rpc_debug_level, "thread_id(%d): User op failed: rc=%d", thread_id, rc);
+	}
+	trace_end_interval(interval_id, TRACE_RPC_PROC, thread_id, "operation timer");
 
-			if (rc != LWFS_OK) {
-				log_fatal(rpc_debug_level, "thread_id(%d): unable to send result %lu",
-						thread_id, header.id);
-				goto cleanup; 
-			}
+	/* send result back to client */
+	log_debug(rpc_debug_level, "thread_id(%d): sending result %lu back to client", 
+			thread_id, header.id);
+	// is reentrant??
 
-			/* free data structures created for the args and result */
-			log_debug(rpc_debug_level, "thread_id(%d): xdr_freeing args", thread_id);
-			xdr_free((xdrproc_t)op->decode_args, (char *)args); 
-			log_debug(rpc_debug_level, "thread_id(%d): xdr_freeing result", thread_id);
-			xdr_free((xdrproc_t)op->encode_res, (char *)res); 
 
-			log_debug(rpc_debug_level, "thread_id(%d): freeing args", thread_id);
-			free(args);
-			log_debug(rpc_debug_level, "thread_id(%d): freeing result", thread_id);
-			free(res);
+	/* measure time for the send result portion */
+	trace_start_interval(interval_id, thread_id);
 
-			log_debug(rpc_debug_level, "thread_id(%d): result freed", thread_id);
+	rc = send_result(thread_id, header.id, &header.res_addr, 
+			op->encode_res, rc, res);
 
-			rc = LWFS_OK; 
-			goto cleanup; 
-		}
+	trace_end_interval(interval_id, TRACE_RPC_SENDRES, thread_id, "sendres timer");
 
-		/* else if no match, check next item */
+	if (rc != LWFS_OK) {
+		log_fatal(rpc_debug_level, "thread_id(%d): unable to send result %lu",
+				thread_id, header.id);
+		op_rc = rc;
+		goto cleanup; 
 	}
 
-	/* if we get here, there is not match */
-	log_warn(rpc_debug_level, "thread_id(%d): unrecognized request: opcode=%d", thread_id,
-			header.opcode);
-	rc = LWFS_ERR_RPC; 
+	rc = LWFS_OK; 
 
 cleanup:
 
+	/* count the request (decode, op, and send result), even if 
+	 * it failed.  Rejected requests have their own counter. */
+	if (admitted) {
+		record_op_stats(entry, op_rc, lwfs_get_time() - t_start);
+	}
+
+	/* free data structures created for the args and result */
+	if (args != NULL) {
+		log_debug(rpc_debug_level, "thread_id(%d): xdr_freeing args", thread_id);
+		xdr_free((xdrproc_t)op->decode_args, (char *)args); 
+		log_debug(rpc_debug_level, "thread_id(%d): freeing args", thread_id);
+		free(args);
+	}
+	if (res != NULL) {
+		log_debug(rpc_debug_level, "thread_id(%d): xdr_freeing result", thread_id);
+		xdr_free((xdrproc_t)op->encode_res, (char *)res); 
+		log_debug(rpc_debug_level, "thread_id(%d): freeing result", thread_id);
+		free(res);
+	}
+
 	log_debug(thread_debug_level, "thread %d: finished processing request %lu\n", thread_id, header.id);
 
+	/* done with the request buffer */
+	if (data->seg != NULL) {
+		segment_release(data->seg);
+	}
+
 	/* free the client data */
 	free(data);
 	return rc; 
 }
 
 
+/**
+ * @brief Find the thread pool class of a request.
+ *
+ * Peeks at the opcode in the request header.  If the op has a
+ * classify function and the args came with the header, decode
+ * the args and let the op decide.  Requests we cannot classify
+ * are metadata; process_request sorts them out.
+ */
+static int request_class(
+        thr_request *req)
+{
+	XDR xdrs; 
+	lwfs_request_header header; 
+	struct svc_op_entry *entry; 
+	void *args = NULL; 
+	int req_class; 
+
+	memset(&header, 0, sizeof(lwfs_request_header));
+
+	xdrmem_create(&xdrs, req->req_buf, req->short_req_len, XDR_DECODE);
+	if (!xdr_lwfs_request_header(&xdrs, &header)) {
+		return LWFS_TP_CLASS_METADATA;
+	}
+
+	if (header.opcode >= (lwfs_opcode)req->op_table->len) {
+		return LWFS_TP_CLASS_METADATA;
+	}
+
+	entry = req->op_table->ops[header.opcode];
+	if (entry == NULL) {
+		return LWFS_TP_CLASS_METADATA;
+	}
+
+	if ((entry->op.classify == NULL) || header.fetch_args) {
+		return entry->op.op_class;
+	}
+
+	args = calloc(1, entry->op.sizeof_args); 
+	if (args == NULL) {
+		return entry->op.op_class;
+	}
+
+	if (entry->op.decode_args(&xdrs, args)) {
+		req_class = entry->op.classify(args); 
+	}
+	else {
+		req_class = entry->op.op_class; 
+	}
+
+	xdr_free((xdrproc_t)entry->op.decode_args, (char *)args); 
+	free(args); 
+
+	return req_class;
+}
+
+/**
+ * @brief Answer a request with an error, without processing it.
+ *
+ * Used when the server cannot take the request (e.g., the
+ * request queue is full).  The client's long args and data
+ * are left alone, so the client can send the same request again.
+ */
+static int reject_request(
+        thr_request *req,
+        const int return_code)
+{
+	XDR xdrs; 
+	int rc = LWFS_OK; 
+	lwfs_request_header header; 
+
+	memset(&header, 0, sizeof(lwfs_request_header));
+
+	xdrmem_create(&xdrs, req->req_buf, req->short_req_len, XDR_DECODE);
+	if (!xdr_lwfs_request_header(&xdrs, &header)) {
+		log_error(rpc_debug_level, "failed to decode header");
+		rc = LWFS_ERR_DECODE;
+		goto cleanup;
+	}
+
+	log_debug(rpc_debug_level, "rejecting request %lu (opcode=%d): %s", 
+			header.id, header.opcode, lwfs_err_str(return_code));
+
+	rc = send_result(0, header.id, &header.res_addr, 
+			(xdrproc_t)&xdr_void, return_code, NULL);
+	if (rc != LWFS_OK) {
+		log_error(rpc_debug_level, "unable to send result %lu", header.id);
+	}
+
+cleanup:
+	if (req->seg != NULL) {
+		segment_release(req->seg);
+	}
+	free(req);
+	return rc;
+}
+
+/* requests waiting for the reject thread to answer them */
+struct reject_queue {
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    thr_request **reqs;     /* ring of max_len entries */
+    int *return_codes;
+    int first;
+    int len;
+    int max_len;
+    lwfs_bool done;
+    long inline_rejects;    /* answered by the dispatcher (queue full) */
+};
+
+/**
+ * @brief Send the replies to rejected requests.
+ *
+ * The reply waits for the client's ack; on a separate thread that
+ * wait does not hold up the dispatcher, which would otherwise stop 
+ * draining the request queue exactly when the server is busiest. 
+ */
+static void *reject_thread(void *arg)
+{
+    struct reject_queue *q = (struct reject_queue *)arg;
+    thr_request *req;
+    int return_code;
+
+    pthread_mutex_lock(&q->mutex);
+    while (TRUE) {
+	while ((q->len == 0) && !q->done) {
+	    pthread_cond_wait(&q->cond, &q->mutex);
+	}
+
+	/* answer everything we have before we exit */
+	if (q->len == 0) {
+	    break;
+	}
+
+	req = q->reqs[q->first];
+	return_code = q->return_codes[q->first];
+	q->first = (q->first + 1) % q->max_len;
+	q->len--;
+
+	pthread_mutex_unlock(&q->mutex);
+	reject_request(req, return_code);
+	pthread_mutex_lock(&q->mutex);
+    }
+    pthread_mutex_unlock(&q->mutex);
+
+    return NULL;
+}
+
+static int reject_queue_init(
+	struct reject_queue *q,
+	const int max_len)
+{
+    int rc = LWFS_OK;
+
+    memset(q, 0, sizeof(struct reject_queue));
+    pthread_mutex_init(&q->mutex, NULL);
+    pthread_cond_init(&q->cond, NULL);
+
+    q->max_len = max_len;
+    q->reqs = (thr_request **)calloc(max_len, sizeof(thr_request *));
+    q->return_codes = (int *)calloc(max_len, sizeof(int));
+    if ((q->reqs == NULL) || (q->return_codes == NULL)) {
+	log_error(rpc_debug_level, "unable to allocate reject queue");
+	rc = LWFS_ERR_NOSPACE;
+	goto cleanup;
+    }
+
+    if (pthread_create(&q->thread, NULL, reject_thread, q) != 0) {
+	log_error(rpc_debug_level, "unable to start reject thread");
+	rc = LWFS_ERR;
+	goto cleanup;
+    }
+
+cleanup:
+    if (rc != LWFS_OK) {
+	free(q->reqs);
+	free(q->return_codes);
+	q->reqs = NULL;
+	q->return_codes = NULL;
+	q->max_len = 0;
+    }
+    return rc;
+}
+
+/**
+ * @brief Answer a request with an error from the reject thread.
+ *
+ * If the reject thread is behind (or did not start), the 
+ * dispatcher sends the reply itself rather than leave the client 
+ * waiting for an answer that never comes. 
+ */
+static void reject_request_async(
+	struct reject_queue *q,
+	thr_request *req,
+	const int return_code)
+{
+    pthread_mutex_lock(&q->mutex);
+    if (q->len < q->max_len) {
+	int last = (q->first + q->len) % q->max_len;
+	q->reqs[last] = req;
+	q->return_codes[last] = return_code;
+	q->len++;
+	pthread_cond_signal(&q->cond);
+	pthread_mutex_unlock(&q->mutex);
+	return;
+    }
+    q->inline_rejects++;
+    pthread_mutex_unlock(&q->mutex);
+
+    reject_request(req, return_code);
+}
+
+static void reject_queue_fini(
+	struct reject_queue *q)
+{
+    if (q->reqs != NULL) {
+	pthread_mutex_lock(&q->mutex);
+	q->done = TRUE;
+	pthread_cond_signal(&q->cond);
+	pthread_mutex_unlock(&q->mutex);
+
+	pthread_join(q->thread, NULL);
+    }
+
+    free(q->reqs);
+    free(q->return_codes);
+    pthread_cond_destroy(&q->cond);
+    pthread_mutex_destroy(&q->mutex);
+}
+
+
 /**
  * @brief An abstract method to get data from a remote memory descriptor.
  *
@@ -1029,6 +1659,8 @@ int lwfs_add_svc_op(
     new_list->svc_op.decode_args = svc_op->decode_args; 
     new_list->svc_op.sizeof_res  = svc_op->sizeof_res; 
     new_list->svc_op.encode_res  = svc_op->encode_res; 
+    new_list->svc_op.op_class    = svc_op->op_class; 
+    new_list->svc_op.classify    = svc_op->classify; 
 
     /* push entry onto the front of the list */
     new_list->next = *op_list; 
@@ -1076,7 +1708,8 @@ int lwfs_service_init(
     memcpy(&local_service, service, sizeof(lwfs_service));
 
     /* add the default services */
-    rc = lwfs_service_add_ops(service, svc_op_array, 3);
+    rc = lwfs_service_add_ops(service, svc_op_array, 
+	    lwfs_svc_op_count(svc_op_array));
     if (rc != LWFS_OK) {
 	log_error(rpc_debug_level, "unable to add default svc ops: %s",
 		lwfs_err_str(rc));
@@ -1084,9 +1717,33 @@ int lwfs_service_init(
     return LWFS_OK;
 }
 
+/**
+  * @brief Count the operations of an op array.
+  *
+  * @param ops  @input_type  The array, ending with {LWFS_OP_NULL}.
+  */
+int lwfs_svc_op_count(
+	const lwfs_svc_op *ops)
+{
+	int count = 0;
+
+	while (ops[count].opcode != LWFS_OP_NULL) {
+		count++;
+	}
+
+	return count;
+}
+
 /**
   * @brief Add operations to service. 
   *
+  * Each service gets a table indexed by opcode, so 
+  * \ref process_request finds an operation in constant time. 
+  * If the service already has an operation, we keep the 
+  * first one and warn.
+  * Entries without a function (the null op that ends 
+  * an op array) are skipped.
+  *
   * @param svc  @input_type  The service descriptor.
   * @param ops  @input_type  The array operations to add to the service.
   * @param len  @input_type  The number of operations to add.
@@ -1098,26 +1755,165 @@ int lwfs_service_add_ops(
 {
 	int rc = LWFS_OK;
 	int i;
-	int total = num_supported_ops + len;
-	int count = 0; 
-		
-	supported_ops = (lwfs_svc_op *)realloc(supported_ops, total*sizeof(lwfs_svc_op));
-	if (supported_ops == NULL) {
-		return LWFS_ERR_NOSPACE;
+	int new_len;
+	struct svc_op_table *table = NULL;
+	struct svc_op_entry **new_ops = NULL;
+	struct svc_op_entry *entry = NULL;
+
+	pthread_mutex_lock(&op_tables_mutex);
+
+	table = find_op_table(svc, TRUE);
+	if (table == NULL) {
+		log_error(rpc_debug_level, "more than %d services in this process",
+				LWFS_SVC_MAX_SERVICES);
+		rc = LWFS_ERR_NOSPACE;
+		goto cleanup;
 	}
-	
-	count = 0;
-	for (i=num_supported_ops; i<total; i++) {
-		memcpy(&supported_ops[i], &ops[count++], sizeof(lwfs_svc_op));
+
+	/* grow the table to fit the largest opcode */
+	new_len = table->len;
+	for (i=0; i<len; i++) {
+		if (ops[i].opcode > LWFS_SVC_MAX_OPCODE) {
+			log_error(rpc_debug_level, "opcode %u is larger than %d",
+					ops[i].opcode, LWFS_SVC_MAX_OPCODE);
+			rc = LWFS_ERR_RPC;
+			goto cleanup;
+		}
+		if ((int)ops[i].opcode >= new_len) {
+			new_len = ops[i].opcode + 1;
+		}
 	}
 
-	/* update the number of suported ops */
-	num_supported_ops = total; 
+	if (new_len > table->len) {
+		new_ops = (struct svc_op_entry **)realloc(table->ops,
+				new_len*sizeof(struct svc_op_entry *));
+		if (new_ops == NULL) {
+			rc = LWFS_ERR_NOSPACE;
+			goto cleanup;
+		}
+		memset(&new_ops[table->len], 0,
+				(new_len - table->len)*sizeof(struct svc_op_entry *));
+		table->ops = new_ops;
+		table->len = new_len;
+	}
+
+	for (i=0; i<len; i++) {
+		/* the op arrays end with {LWFS_OP_NULL} */
+		if (ops[i].func == NULL) {
+			continue;
+		}
+
+		if (table->ops[ops[i].opcode] != NULL) {
+			log_warn(rpc_debug_level, "service already has opcode %u, "
+					"ignoring the new one", ops[i].opcode);
+			continue;
+		}
+
+		entry = (struct svc_op_entry *)calloc(1, sizeof(struct svc_op_entry));
+		if (entry == NULL) {
+			rc = LWFS_ERR_NOSPACE;
+			goto cleanup;
+		}
+		memcpy(&entry->op, &ops[i], sizeof(lwfs_svc_op));
+		pthread_mutex_init(&entry->stats_mutex, NULL);
+		entry->stats.opcode = ops[i].opcode;
+
+		table->ops[ops[i].opcode] = entry;
+	}
+
+cleanup:
+	pthread_mutex_unlock(&op_tables_mutex);
 
 	return rc; 
 }
 
 
+/**
+ * @brief Get the counters for one operation of a service.
+ */
+int lwfs_service_get_op_stats(
+	const lwfs_service *svc,
+	const lwfs_opcode opcode,
+	lwfs_svc_op_stats *stats)
+{
+	int rc = LWFS_ERR_NOENT;
+	struct svc_op_table *table = NULL;
+	struct svc_op_entry *entry = NULL;
+
+	pthread_mutex_lock(&op_tables_mutex);
+	table = find_op_table(svc, FALSE);
+	if ((table != NULL) && (opcode < (lwfs_opcode)table->len)) {
+		entry = table->ops[opcode];
+	}
+	pthread_mutex_unlock(&op_tables_mutex);
+
+	if (entry != NULL) {
+		pthread_mutex_lock(&entry->stats_mutex);
+		memcpy(stats, &entry->stats, sizeof(lwfs_svc_op_stats));
+		pthread_mutex_unlock(&entry->stats_mutex);
+		rc = LWFS_OK;
+	}
+
+	return rc;
+}
+
+/**
+ * @brief Print the counters of every operation the service has called.
+ *
+ * One line per opcode (calls, errors, mean and max latency), 
+ * followed by the non-empty buckets of its latency histogram.
+ */
+void fprint_lwfs_service_op_stats(
+	FILE *fp,
+	const char *prefix,
+	const lwfs_service *svc)
+{
+	int i, b;
+	long unknown = 0;
+	lwfs_svc_op_stats stats;
+	struct svc_op_table *table = NULL;
+
+	pthread_mutex_lock(&op_tables_mutex);
+	table = find_op_table(svc, FALSE);
+	if (table == NULL) {
+		pthread_mutex_unlock(&op_tables_mutex);
+		return;
+	}
+	unknown = table->unknown;
+
+	fprintf(fp, "%s op stats (opcode: calls, errors, mean usec, max usec):\n", prefix);
+	for (i=0; i<table->len; i++) {
+		if (table->ops[i] == NULL) continue;
+
+		pthread_mutex_lock(&table->ops[i]->stats_mutex);
+		memcpy(&stats, &table->ops[i]->stats, sizeof(lwfs_svc_op_stats));
+		pthread_mutex_unlock(&table->ops[i]->stats_mutex);
+
+		if ((stats.calls == 0) && (stats.rejected == 0)) continue;
+
+		fprintf(fp, "%s   %4u: %ld, %ld, %.1f, %.1f\n", prefix,
+				stats.opcode, stats.calls, stats.errors,
+				(stats.calls > 0)? 1.0e6*stats.total_time/stats.calls : 0.0,
+				1.0e6*stats.max_time);
+		if (stats.rejected > 0) {
+			fprintf(fp, "%s         rejected: %ld\n", prefix, stats.rejected);
+		}
+
+		fprintf(fp, "%s         hist:", prefix);
+		for (b=0; b<LWFS_SVC_OP_HIST_BUCKETS; b++) {
+			if (stats.hist[b] > 0) {
+				fprintf(fp, " %s%lu=%ld", (b == 0)? "<" : "", 
+						(b == 0)? 2UL : (1UL << b), stats.hist[b]);
+			}
+		}
+		fprintf(fp, "\n");
+	}
+	fprintf(fp, "%s   unknown opcodes: %ld\n", prefix, unknown);
+
+	pthread_mutex_unlock(&op_tables_mutex);
+}
+
+
 
 /**
  * @brief Close down an active service.
@@ -1130,12 +1926,41 @@ int lwfs_service_add_ops(
  */
 int lwfs_service_fini(const lwfs_service *service)
 {
-	if (supported_ops != NULL) free(supported_ops);
+	int i;
+	struct svc_op_table *table = NULL;
+
+	pthread_mutex_lock(&op_tables_mutex);
+	table = find_op_table(service, FALSE);
+	if (table != NULL) {
+		for (i=0; i<table->len; i++) {
+			if (table->ops[i] != NULL) {
+				pthread_mutex_destroy(&table->ops[i]->stats_mutex);
+				free(table->ops[i]);
+			}
+		}
+		free(table->ops);
+		memset(table, 0, sizeof(struct svc_op_table));
+	}
+	pthread_mutex_unlock(&op_tables_mutex);
+
     return LWFS_OK;
 }
 
 
-#define NUM_QUEUES 2
+/**
+ * @brief Set the size of the ring of request buffers.
+ *
+ * Call before \ref lwfs_service_start.  A ring needs at least 
+ * two segments; out-of-range values keep the defaults.
+ */
+void lwfs_service_set_request_ring(
+	const int num_segments,
+	const int reqs_per_seg)
+{
+    req_segments = (num_segments > 1)? num_segments : LWFS_SVC_REQ_SEGMENTS;
+    reqs_per_segment = (reqs_per_seg > 0)? reqs_per_seg : LWFS_SVC_REQS_PER_SEGMENT;
+}
+
 
 /**
  * @brief Start the RPC server.
@@ -1143,9 +1968,10 @@ int lwfs_service_fini(const lwfs_service *service)
  * This method never returns.  It waits for an RPC request, and
  * calls the appropriate function from the list of services. 
  *
- * This implementation allocates two buffers that can hold a fixed
- * number of incoming requests each and alternates between 
- * processing requests from the two buffers.
+ * Requests arrive in a ring of buffer segments, each of which
+ * holds a fixed number of requests.  A request keeps a reference
+ * on its segment until it is done with the request buffer; the
+ * last request out of a full segment posts it again.
  *
  * @param service  @input The service descriptor. 
  * @param count @input The maximum number of requests to process.
@@ -1157,7 +1983,6 @@ int lwfs_service_start(
 {
     int rc = LWFS_OK, rc2;
     int req_count = 0;
-    int index = 0; 
     int offset = 0; 
     lwfs_bool done = FALSE; 
     lwfs_bool got_put_start_event = FALSE; 
@@ -1167,43 +1992,60 @@ int lwfs_service_start(
     double processing_time = 0; 
     lwfs_bool use_threads = (pool_args != NULL); 
 
-    /* two incoming queues */
-    char *req_queue[NUM_QUEUES]; 
+    /* incoming requests */
+    struct req_ring ring; 
+    struct req_segment *seg; 
     char *req_buf; 
 
-    /* each message is no larger than req_size */
-    int req_size = svc->req_addr.len;
-
-    /* each md can recv reqs_per_queue messages */
-    int reqs_per_queue = 10000;
-
-    /* keep track of the queue index and count */
-    int indices[NUM_QUEUES];
-    int queue_count[NUM_QUEUES];
-
     /* portals structs */
     ptl_handle_ni_t ni_h; 
     ptl_handle_eq_t eq_h; 
-    ptl_process_id_t match_id; 
-    ptl_match_bits_t match_bits = 0;
-    ptl_match_bits_t ignore_bits;
     ptl_event_t event; 
 
-    /* for each queue, we need these structs */
-    ptl_md_t md[NUM_QUEUES];
-    ptl_handle_md_t md_h[NUM_QUEUES]; 
-    ptl_handle_me_t  me_h[NUM_QUEUES];
-
     lwfs_remote_pid caller; 
 
     lwfs_thread_pool pool;
+    lwfs_thread_pool_args bounded_args;
     thr_request *req=NULL;
+    struct svc_op_table *op_table = NULL;
+    int busy_count = 0;
+    struct reject_queue rejects;
+
+    /* look up the op table once; requests carry a pointer to it */
+    pthread_mutex_lock(&op_tables_mutex);
+    op_table = find_op_table(svc, FALSE);
+    pthread_mutex_unlock(&op_tables_mutex);
+    if (op_table == NULL) {
+	log_error(rpc_debug_level, "service has no operations");
+	return LWFS_ERR_RPC;
+    }
+
+    /* sample memory use in the background for admission control */
+    if (max_mem_allowed > 0) {
+	sysmon_sampler_start(SYSMON_SAMPLE_INTERVAL, rpc_debug_level);
+    }
 
     if (use_threads) {
 	/* make our portals abstraction thread-safe */
 	lwfs_ptl_use_locks(1);
 
-	lwfs_thread_pool_init(&pool, pool_args);
+	/* Bound the request queue.  A queued request pins its 
+	 * segment of the ring, so leave room for at least one 
+	 * segment to be posted. */
+	memcpy(&bounded_args, pool_args, sizeof(lwfs_thread_pool_args));
+	if ((bounded_args.queue_high_watermark <= 0) || 
+		(bounded_args.queue_high_watermark > (req_segments-1)*reqs_per_segment)) {
+	    bounded_args.queue_high_watermark = (req_segments-1)*reqs_per_segment;
+	}
+
+	lwfs_thread_pool_init(&pool, &bounded_args);
+
+	/* BUSY replies go out on their own thread */
+	rc = reject_queue_init(&rejects, reqs_per_segment);
+	if (rc != LWFS_OK) {
+	    log_warn(rpc_debug_level, "dispatcher will send BUSY replies itself");
+	    rc = LWFS_OK;
+	}
     }
     else {
 	/* remove locks from our portals stuff */
@@ -1211,14 +2053,12 @@ int lwfs_service_start(
     }
 
 
-    match_id.nid = PTL_NID_ANY;
-    match_id.pid = PTL_PID_ANY;
-
     /* get the network interface */
     lwfs_ptl_get_ni(&ni_h); 
 
-    /* create an event queue */
-    rc = lwfs_ptl_eq_alloc(ni_h, reqs_per_queue, PTL_EQ_HANDLER_NONE, &eq_h);
+    /* create an event queue (two events per request) */
+    rc = lwfs_ptl_eq_alloc(ni_h, 2*req_segments*reqs_per_segment, 
+	    lwfs_ptl_eq_notify, &eq_h);
     if (rc != LWFS_OK) {
 	log_error(rpc_debug_level, "lwfs_ptl_eq_alloc() failed"); 
 	return (rc);
@@ -1228,66 +2068,17 @@ int lwfs_service_start(
     //service->req_thread = pthread_self(); 
 
 
-    /* Accept requests from anyone */
-    match_id.nid = PTL_NID_ANY;
-    match_id.pid = PTL_PID_ANY;
-    match_bits = svc->req_addr.match_bits;
-    ignore_bits = 0;
-
-
-    for (index=0; index<NUM_QUEUES; index++) {
-
-	/*void *addr = index; */
-
-	/* initialize the indices stored in the MD user pointer */
-	indices[index] = index; 
-	queue_count[index] = 0; 
-
-	/* allocate the buffer for the incoming MD */
-	req_queue[index] = (char *)malloc(reqs_per_queue*req_size);
-	if (req_queue[index] == NULL) {
-	    log_error(rpc_debug_level, "out of memory");
-	    return LWFS_ERR_NOSPACE; 
-	}
-
-	/* initialize the buffer */
-	memset(req_queue[index], 0, reqs_per_queue*req_size);
-
-	/* initialize the MD */
-	memset(&md[index], 0, sizeof(ptl_md_t)); 
-	md[index].start = req_queue[index];
-	md[index].length = reqs_per_queue*req_size;
-	md[index].threshold = reqs_per_queue;
-	md[index].max_size = req_size;
-	md[index].options = PTL_MD_OP_PUT | PTL_MD_MAX_SIZE; 
-	md[index].user_ptr = &indices[index];  /* used to store the index */
-	md[index].eq_handle = eq_h; 
-
-	log_debug(rpc_debug_level, "attaching match entry to index=%d",
-		svc->req_addr.buffer_id);
-
-	/* Attach the match entry to the portal index */
-	rc = lwfs_ptl_me_attach(ni_h, svc->req_addr.buffer_id, 
-		match_id, match_bits, ignore_bits,
-		PTL_RETAIN, PTL_INS_AFTER, &me_h[index]); 
-	if (rc != LWFS_OK) {
-	    log_error(rpc_debug_level, "could not attach ME");
-	    return (rc); 
-	}
-
-	/* Attach the MD to the match entry */
-	rc = lwfs_ptl_md_attach(me_h[index], md[index], PTL_RETAIN, &md_h[index]); 
-	if (rc != LWFS_OK) {
-	    log_error(rpc_debug_level, "could not alloc eq: %s",
-		    ptl_err_str[rc]);
-	    return (rc); 
-	}
+    /* post the ring of request buffers (accept requests from anyone) */
+    rc = req_ring_init(&ring, svc, ni_h, eq_h);
+    if (rc != LWFS_OK) {
+	log_error(rpc_debug_level, "could not post request buffers");
+	req_ring_fini(&ring);
+	return (rc);
     }
 
     /* initialize indices and counters */
     req_count = 0; /* number of reqs processed */
-    index = 0;     /* which queue to use */
-    offset = 0;    /* offset in the queue */
+    offset = 0;    /* offset in the segment */
 
     /* SIGINT (Ctrl-C) will get us out of this loop */
     while (!lwfs_exit_now()) {
@@ -1336,7 +2127,8 @@ int lwfs_service_start(
 	    log_debug(rpc_debug_level, "waiting for request...");
 
 
-	    rc = lwfs_ptl_eq_wait(eq_h, &event); 
+	    /* we are the only reader, so sleep until the EQ handler wakes us */
+	    rc = lwfs_ptl_eq_wait_drain(eq_h, &event); 
 
 
 	    if (rc != LWFS_OK) {
@@ -1390,21 +2182,20 @@ int lwfs_service_start(
 	idle_time += lwfs_get_time() - t1; 
 	/*trace_end_interval(req_count, TRACE_RPC_IDLE, 0, 0, "idle time");*/
 
-	/* get the index of the queue */
-	index = *(int *)event.md.user_ptr;
-
+	/* the request holds its segment until it is done */
+	seg = (struct req_segment *)event.md.user_ptr;
+	segment_hold(seg);
 
 	/* increment the number of requests */
 	req_count++; 
-	queue_count[index]++;
 
 	/* Now we can process the request */
 	log_info(rpc_debug_level, "received request %d from (%llu,%llu) "
-		"on queue=%d, offset=%d, req_size=%d", 
+		"on segment=%d, offset=%d, req_size=%d", 
 		(int)req_count,
 		(unsigned long long)event.initiator.nid,
 		(unsigned long long)event.initiator.pid,
-		*((int *)event.md.user_ptr), 
+		seg->index, 
 		(int)event.offset, 
 		(int)event.mlength);
 
@@ -1413,13 +2204,28 @@ int lwfs_service_start(
 
 	req = (thr_request *)calloc(1,sizeof(thr_request));
 	req->svc = svc;
+	req->op_table = op_table;
 	req->caller = caller;
 	req->req_buf = req_buf;
 	req->short_req_len = event.mlength;
+	req->seg = seg;
 
 	if (use_threads) {
 	    /* add the request to the thread pool */
-	    lwfs_thread_pool_add_request(&pool, req, &process_request);
+	    rc = lwfs_thread_pool_add_classified_request(&pool, req, &process_request,
+		    request_class(req), 
+		    ((uint64_t)caller.nid << 32) | (uint64_t)caller.pid);
+	    if (rc == LWFS_TP_BUSY) {
+		/* queue is full, tell the client to come back later */
+		busy_count++;
+		reject_request_async(&rejects, req, LWFS_ERR_BUSY);
+	    }
+	    else if (rc != 0) {
+		/* client retries (the pool was probably out of memory) */
+		log_error(rpc_debug_level, "unable to queue request");
+		reject_request_async(&rejects, req, LWFS_ERR_BUSY);
+	    }
+	    rc = LWFS_OK;
 	}
 	else {
 	    /* process the request directly */
@@ -1439,37 +2245,6 @@ int lwfs_service_start(
 	}
 
 
-	/* if we've processed all we can on this queue, reset */
-	if (queue_count[index] >= reqs_per_queue) {
-
-	    log_debug(rpc_debug_level, "Resetting MD on queue[%d]", index);
-
-	    /* Unlink the ME (also unlinks the MD) */
-	    rc = lwfs_PtlMEUnlink(me_h[index]);
-	    if (rc != PTL_OK) {
-		log_error(rpc_debug_level, "Could not unlink ME: %s", ptl_err_str[rc]);
-		goto cleanup; 
-	    }
-
-	    /* Re-attach the match-list entry */
-	    rc = lwfs_PtlMEAttach(ni_h, svc->req_addr.buffer_id, match_id, 
-		    match_bits, ignore_bits, PTL_RETAIN, PTL_INS_AFTER, 
-		    &me_h[index]);
-	    if (rc != PTL_OK) {
-		log_error(rpc_debug_level, "Could not reset ME: %s", ptl_err_str[rc]);
-		goto cleanup; 
-	    }
-
-	    /* Re-attach the MD */
-	    rc = lwfs_PtlMDAttach(me_h[index], md[index], PTL_RETAIN, &md_h[index]);
-	    if (rc != PTL_OK) {
-		log_error(rpc_debug_level, "Could not reset MD: %s", ptl_err_str[rc]);
-		goto cleanup; 
-	    }
-	    
-	    queue_count[index] = 0;
-	}
-
     }
 
 
@@ -1478,31 +2253,22 @@ cleanup:
     /* finish any tracing */
     trace_fini();
 
-    rc = LWFS_OK;
-    for (index=0; index<NUM_QUEUES; index++) {
-	/* unlink the memory descriptor */
-	rc2 = lwfs_ptl_md_unlink(md_h[index]); 
-	if (rc2 != LWFS_OK) {
-	    log_warn(rpc_debug_level, "unable to unlink memory descriptor for queue %d: %s",
-		    index, ptl_err_str[rc2]);
-	    rc = LWFS_ERR;
-	}
+    /* let the threads finish (they use the request buffers) */
+    if (use_threads) {
+	FILE *fp = logger_get_file();
+	fprintf(fp, "----- THREAD POOL STATS ----\n");
+	fprint_lwfs_thread_pool_stats(fp, "\t", &pool);
 
-	/* free the request queue buffers */
-	free(req_queue[index]);
-    }
+	log_debug(rpc_debug_level, "shutting down thread pool");
+	lwfs_thread_pool_fini(&pool);
 
-    /* free the event queue */
-    rc2 = lwfs_ptl_eq_free(eq_h); 
-    if (rc2 != LWFS_OK) {
-	log_fatal(rpc_debug_level, "unable to free event queue (%s)",
-		ptl_err_str[rc2]);
-	rc = LWFS_ERR;
+	/* answer the requests we turned away */
+	fprintf(fp, "\tBUSY replies sent by dispatcher = %ld\n", rejects.inline_rejects);
+	reject_queue_fini(&rejects);
     }
 
-    if (use_threads) {
-	log_debug(rpc_debug_level, "shutting down thread pool");
-	lwfs_thread_pool_fini(&pool);
+    if (max_mem_allowed > 0) {
+	sysmon_sampler_stop();
     }
 
     /* print out stats about the server */
@@ -1513,11 +2279,28 @@ cleanup:
     FILE *fp = logger_get_file();
     fprintf(fp, "----- SERVER STATS ---------\n");
     fprintf(fp, "\tprocessed requests = %d\n", req_count);
+    fprintf(fp, "\tbusy replies = %d\n", busy_count);
     //fprintf(fp, "\tidle time       = %g (sec)\n", idle_time);
     fprintf(fp, "\tprocessing time = %g (sec)\n", processing_time);
+    fprint_req_ring_stats(fp, "\t", &ring);
+    fprint_lwfs_service_op_stats(fp, "\t", svc);
     fprintf(fp, "----------------------------\n");
     //}
 
+    rc = LWFS_OK;
+    rc2 = req_ring_fini(&ring);
+    if (rc2 != LWFS_OK) {
+	rc = LWFS_ERR;
+    }
+
+    /* free the event queue */
+    rc2 = lwfs_ptl_eq_free(eq_h); 
+    if (rc2 != LWFS_OK) {
+	log_fatal(rpc_debug_level, "unable to free event queue (%s)",
+		ptl_err_str[rc2]);
+	rc = LWFS_ERR;
+    }
+
     return rc;
 }
 
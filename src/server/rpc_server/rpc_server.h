@@ -13,6 +13,8 @@
 #ifndef _LWFS_RPC_SRVR_H_
 #define _LWFS_RPC_SRVR_H_
 
+#include <stdio.h>
+
 #include "support/threadpool/thread_pool.h"
 
 #include "common/types/types.h"
@@ -40,6 +42,12 @@ extern "C" {
 	 */
 	typedef int (*lwfs_rpc_proc) (const lwfs_remote_pid *, const void *, const lwfs_rma *, void *);
 
+	/**
+	 * @brief Definition of a function pointer that finds the thread 
+	 * pool class (LWFS_TP_CLASS_*) of a request from its decoded args.
+	 */
+	typedef int (*lwfs_svc_classify) (const void *);
+
 
 	/**
 	 * @brief A structure associated with an operation made available
@@ -66,11 +74,83 @@ extern "C" {
 
 		/** @brief A function to encode the result after servicing the request. */
 		xdrproc_t encode_res;
-	} lwfs_svc_op; 
 
+		/** @brief Thread pool class of the requests (\ref LWFS_TP_CLASS_METADATA if not set). */
+		int op_class;
+
+		/** @brief Optional function that picks the class from the args.
+		 *
+		 * Only used when the args travel in the request header; 
+		 * requests with fetched args get \em op_class. */
+		lwfs_svc_classify classify;
+	} lwfs_svc_op;
+
+
+	/**
+	 * @brief Largest opcode a service can register.
+	 *
+	 * Each service dispatches requests through a table indexed
+	 * by opcode, so opcodes have to stay reasonably small.
+	 */
+#define LWFS_SVC_MAX_OPCODE 4095
+
+	/**
+	 * @brief Most services (distinct match bits) in one process.
+	 */
+#define LWFS_SVC_MAX_SERVICES 8
+
+	/**
+	 * @brief Default number of segments in the ring of request buffers.
+	 *
+	 * The server receives requests in a ring of buffer segments.
+	 * A full segment goes back to Portals once every request 
+	 * in it is done.
+	 */
+#define LWFS_SVC_REQ_SEGMENTS 4
 
 	/**
-	 * @brief Structure for a list of RPC services. 
+	 * @brief Default number of requests each segment of the ring holds.
+	 */
+#define LWFS_SVC_REQS_PER_SEGMENT 4096
+
+	/**
+	 * @brief Buckets in the latency histogram of an operation.
+	 *
+	 * Bucket 0 counts requests that took less than 2 usec, bucket
+	 * \em i (i>0) those that took [2^i, 2^(i+1)) usec, and the last
+	 * bucket everything slower.
+	 */
+#define LWFS_SVC_OP_HIST_BUCKETS 24
+
+	/**
+	 * @brief Counters kept by the server for each registered operation.
+	 */
+	typedef struct {
+		/** @brief The operation code. */
+		lwfs_opcode opcode;
+
+		/** @brief Number of requests processed. */
+		long calls;
+
+		/** @brief Number of requests where the server function failed. */
+		long errors;
+
+		/** @brief Number of requests turned away (server short of memory). */
+		long rejected;
+
+		/** @brief Total time spent on the requests (sec). */
+		double total_time;
+
+		/** @brief Slowest request (sec). */
+		double max_time;
+
+		/** @brief Histogram of request latencies (see \ref LWFS_SVC_OP_HIST_BUCKETS). */
+		long hist[LWFS_SVC_OP_HIST_BUCKETS];
+	} lwfs_svc_op_stats;
+
+
+	/**
+	 * @brief Structure for a list of RPC services.
 	 */
 	typedef struct lwfs_svc_op_list {
 
@@ -150,6 +230,22 @@ extern "C" {
 
 
 
+	/**
+	 * @brief Set the size of the ring of request buffers.
+	 *
+	 * @ingroup rpc_server_api
+	 *
+	 * Call before \ref lwfs_service_start.  Values out of range
+	 * keep the defaults (\ref LWFS_SVC_REQ_SEGMENTS and 
+	 * \ref LWFS_SVC_REQS_PER_SEGMENT).
+	 *
+	 * @param num_segments     @input_type  Segments in the ring (at least 2).
+	 * @param reqs_per_segment @input_type  Requests each segment holds.
+	 */
+	extern void lwfs_service_set_request_ring(
+			const int num_segments,
+			const int reqs_per_segment);
+
 	/**
 	 * @brief Start an RPC service.
 	 *
@@ -169,11 +265,59 @@ extern "C" {
 			const lwfs_thread_pool_args *pool_args);
 
 
+	/**
+	 * @brief Count the operations of an op array.
+	 *
+	 * @ingroup rpc_server_api
+	 *
+	 * Op arrays end with {LWFS_OP_NULL}; pass the result to
+	 * \ref lwfs_service_add_ops.
+	 *
+	 * @param ops  @input_type  The array of operations.
+	 */
+	extern int lwfs_svc_op_count(
+			const lwfs_svc_op *ops);
+
+	/**
+	 * @brief Add operations to a service.
+	 *
+	 * @ingroup rpc_server_api
+	 *
+	 * Each service (identified by its match bits) has its own
+	 * table of operations, so several services can share a process.
+	 * Add all operations before calling \ref lwfs_service_start.
+	 *
+	 * @param svc  @input_type  The service descriptor.
+	 * @param ops  @input_type  The array of operations to add.
+	 * @param len  @input_type  The number of operations to add.
+	 */
 	extern int lwfs_service_add_ops(
 			const lwfs_service *svc,
 			const lwfs_svc_op *ops,
 			const int len);
 
+	/**
+	 * @brief Get the counters for one operation of a service.
+	 *
+	 * @param svc    @input_type  The service descriptor.
+	 * @param opcode @input_type  The operation.
+	 * @param stats  @output_type A copy of the counters.
+	 *
+	 * @returns \ref LWFS_ERR_NOENT if the service does not have the operation.
+	 */
+	extern int lwfs_service_get_op_stats(
+			const lwfs_service *svc,
+			const lwfs_opcode opcode,
+			lwfs_svc_op_stats *stats);
+
+	/**
+	 * @brief Print the counters of every operation the service has called.
+	 */
+	extern void fprint_lwfs_service_op_stats(
+			FILE *fp,
+			const char *prefix,
+			const lwfs_service *svc);
+
 	/**
 	 * @brief Start an RPC service as a thread. 
 	 *
@@ -0,0 +1,45 @@
+
+#include <string.h>
+
+/*
+ * This file should be included in files that want 
+ * to use command-line options for the rpc server.  We 
+ * include the source code here because the definition
+ * of gengetopt_args_info (generated by gengetopt) 
+ * will change for each set of options generated by
+ * the gengetopt program. 
+ */
+
+#ifndef _RPC_SERVER_OPTS_H_
+#define _RPC_SERVER_OPTS_H_
+
+
+/**
+ * @brief Output the rpc server options to a specified file
+ *
+ * @param fp @input The file pointer.
+ * @param opts @input The options to print.
+ */
+void print_rpc_server_opts(
+		FILE *fp, 
+		const struct gengetopt_args_info *args_info, 
+		const char *prefix)
+{
+	fprintf(fp, "%s ------------ RPC Server Options -------\n", prefix);
+	fprintf(fp, "%s \trpc-req-segments = %d\n", prefix, args_info->rpc_req_segments_arg);
+	fprintf(fp, "%s \trpc-reqs-per-segment = %d\n", prefix, args_info->rpc_reqs_per_segment_arg);
+}
+
+
+/** 
+  * @brief Load default command-line options for the rpc server. 
+  */
+int load_default_rpc_server_opts(struct gengetopt_args_info *args_info)
+{
+	args_info->rpc_req_segments_arg = 0; 
+	args_info->rpc_reqs_per_segment_arg = 0; 
+	return 0;
+}
+
+
+#endif /* !_RPC_SERVER_OPTS_H_ */
@@ -38,13 +38,6 @@ typedef union sigval sigval_t;
 #include "aio_obj.h"
 #include "sysio_obj.h"
 
-struct aio_obj_args {
-    int rank;
-	lwfs_bool free_buf; 
-    struct aiocb *aiocb;
-};
-
-
 int aio_obj_init(
         const char *root_dir, 
         struct obj_funcs *obj_funcs)
@@ -111,42 +104,16 @@ lwfs_ssize aio_obj_read(
 }
 
 
-static volatile int pending_writes = 0; 
-
-
-/** 
- * @brief Callback for asynchronous write. 
- *
- * This function gets called when an asynchronous write completes.
- * 
- */
-static void write_callback(sigval_t s)
-{
-	struct aio_obj_args *args = (struct aio_obj_args *)s.sival_ptr;
-	struct aiocb *aiocb = args->aiocb; 
-
-	pending_writes--; 
-
-	log_debug(ss_debug_level, "%d: Finished async write, pending_writes=%d\n", 
-			args->rank, pending_writes);
-
-	if (args->free_buf) {
-		free((char *)aiocb->aio_buf);
-	}
-
-	/* free the aiocb structure */
-	free(aiocb);
-	
-	/* free the args structure */
-	free(args);
-}
-
-
 /* my_objs_write_obj()
  *
  * assumes that object already exists;
  *
- * returns one upon success;
+ * The caller owns the buffer, so we wait for the asynchronous
+ * write to complete before we return.  The storage server
+ * overlaps disk writes with network transfers in the writer
+ * thread (see io_threads.c).
+ *
+ * returns the number of bytes written.
  */
 lwfs_ssize aio_obj_write(
 		const lwfs_obj *obj, 
@@ -154,43 +121,51 @@ lwfs_ssize aio_obj_write(
 		void *src, 
 		const lwfs_ssize len)
 {
-	struct aio_obj_args *args = NULL;
+	struct aiocb aiocb; 
+	const struct aiocb *list[1]; 
+	lwfs_ssize result = 0; 
+	struct _oid_el *ref = NULL; 
 	int fd; 
 
-
-	/* get the file descriptor for the object */
-	fd = sysio_obj_getfd(obj); 
-	if (fd == -1) {
+	/* get the file descriptor for the object (the ref keeps it open) */
+	ref = sysio_obj_acquire_fd(obj, &fd); 
+	if (ref == NULL) {
 		log_error(ss_debug_level, "could not get file descriptor");
 		return 0;
 	}
 
-	args = malloc(sizeof(struct aio_obj_args));
-	args->rank = lwfs_thread_pool_getrank(); 
-	args->aiocb = (struct aiocb *)malloc(sizeof(struct aiocb));
-
 	/* initialize aoicb */
-	memset(args->aiocb, 0, sizeof(struct aiocb));
-	args->aiocb->aio_fildes = fd; 
-	args->aiocb->aio_offset = offset; 
-	args->aiocb->aio_sigevent.sigev_notify = SIGEV_THREAD;
-	args->aiocb->aio_sigevent.sigev_notify_function = write_callback;
-	args->aiocb->aio_sigevent.sigev_value.sival_ptr = args;
-
-	/* prepare for the write */
-	args->aiocb->aio_buf = src;
-	args->aiocb->aio_nbytes = len;
-	args->free_buf = TRUE;
-
-	if (aio_write(args->aiocb) != 0) {
+	memset(&aiocb, 0, sizeof(struct aiocb));
+	aiocb.aio_fildes = fd; 
+	aiocb.aio_offset = offset; 
+	aiocb.aio_buf = src;
+	aiocb.aio_nbytes = len;
+	aiocb.aio_sigevent.sigev_notify = SIGEV_NONE;
+
+	if (aio_write(&aiocb) != 0) {
 		log_error(ss_debug_level, "error calling aio_write: %s",
 				strerror(errno));
-		return 0; 
+		goto cleanup; 
+	}
+
+	/* wait for the write to complete */
+	list[0] = &aiocb; 
+	while (aio_error(&aiocb) == EINPROGRESS) {
+		aio_suspend(list, 1, NULL); 
 	}
-	pending_writes++; 
 
-	/* if we get here, we succeded */
-	return len; 
+	if (aio_error(&aiocb) != 0) {
+		log_error(ss_debug_level, "aio_write failed: %s",
+				strerror(aio_error(&aiocb)));
+		aio_return(&aiocb); 
+		goto cleanup; 
+	}
+
+	result = aio_return(&aiocb); 
+
+cleanup:
+	sysio_obj_release_fd(ref); 
+	return result; 
 } 
 
 
@@ -204,12 +179,14 @@ lwfs_ssize aio_obj_write(
 int aio_obj_fsync(
 	const lwfs_obj *obj)
 {
+	int rc = LWFS_OK; 
 	struct aiocb sync_aiocb; 
+	struct _oid_el *ref = NULL; 
 	int fd; 
 
-	/* get the file descriptor for the object */
-	fd = sysio_obj_getfd(obj); 
-	if (fd == -1) {
+	/* get the file descriptor for the object (the ref keeps it open) */
+	ref = sysio_obj_acquire_fd(obj, &fd); 
+	if (ref == NULL) {
 		log_error(ss_debug_level, "could not get file descriptor");
 		return LWFS_ERR_NO_OBJ;
 	}
@@ -226,7 +203,8 @@ int aio_obj_fsync(
 	if (aio_fsync(O_DSYNC, &sync_aiocb) != 0) {
 #endif
 		log_error(ss_debug_level, "unable to schedule fsync file");
-		return LWFS_ERR_STORAGE;
+		rc = LWFS_ERR_STORAGE;
+		goto cleanup;
 	}
 
 	/* wait for sync to complete */
@@ -235,10 +213,13 @@ int aio_obj_fsync(
 	if (aio_return(&sync_aiocb) != 0) { 
 		log_error(ss_debug_level, "fsync returned error: %s\n", 
 				strerror(errno));
-		return LWFS_ERR_STORAGE;
+		rc = LWFS_ERR_STORAGE;
+		goto cleanup;
 	}
-	log_debug(ss_debug_level, "fsync completed, pending=%d\n", pending_writes);
+	log_debug(ss_debug_level, "fsync completed\n");
 
-	return LWFS_OK;
+cleanup:
+	sysio_obj_release_fd(ref); 
+	return rc;
 } 
 
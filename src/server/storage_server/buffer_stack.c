@@ -164,6 +164,41 @@ unlock:
 	return result; 
 }
 
+/**
+ * @brief Pop a buffer off of the stack without waiting.
+ *
+ * @param buffer_stack @input The stack. 
+ *
+ * @returns A buffer, or NULL if the stack is empty.
+ */
+struct io_buffer *buffer_stack_trypop(struct buffer_stack *stack) 
+{
+	struct stack_node *node = NULL; 
+	struct io_buffer *result = NULL; 
+
+	if (pthread_mutex_lock(&stack->mutex) != 0) {
+		log_error(ss_debug_level, "unable to lock stack mutex");
+		return NULL; 
+	}
+
+	if (!buffer_stack_empty(stack)) {
+		/* remove the top item from the list */
+		node = stack->node; 
+		stack->node = node->next; 
+		result = node->buf; 
+
+		/* free the node */
+		free(node); 
+	}
+
+	if (pthread_mutex_unlock(&stack->mutex) != 0) {
+		log_error(ss_debug_level, "unable to unlock stack mutex");
+		return NULL; 
+	}
+
+	return result; 
+}
+
 int buffer_stack_push(struct buffer_stack *stack, struct io_buffer *buf) 
 {
 	int rc = LWFS_OK;
@@ -178,6 +213,7 @@ int buffer_stack_push(struct buffer_stack *stack, struct io_buffer *buf)
 	node = (struct stack_node *)malloc(1*sizeof(struct stack_node));
 	if (!node) {
 		log_error(ss_debug_level, "unable to allocate stack node");
+		rc = LWFS_ERR_NOSPACE;
 		goto unlock;
 	}
 
@@ -39,6 +39,7 @@
 	extern lwfs_bool buffer_stack_empty(struct buffer_stack *stack); 
 
 	extern struct io_buffer *buffer_stack_pop(struct buffer_stack *stack);
+	extern struct io_buffer *buffer_stack_trypop(struct buffer_stack *stack);
 
 	extern int buffer_stack_push(struct buffer_stack *stack, struct io_buffer *buf);
 
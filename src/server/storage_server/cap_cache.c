@@ -0,0 +1,433 @@
+/**
+ *   @file cap_cache.c
+ *
+ *   @brief A bounded cache of capabilities verified by the authr server.
+ *
+ *   Every storage server operation has to verify the capability
+ *   sent by the client.  Without a cache, each verification is a
+ *   synchronous round trip to the authorization server.  This cache
+ *   remembers caps that the authorization server already accepted so
+ *   that subsequent operations with the same cap skip the RPC.
+ *
+ *   Entries are keyed by the MAC of the cap and compared against the
+ *   full cap data (cid, container_op, credential) on a hit.  The cache
+ *   holds at most \em max_entries caps (least recently used entries are
+ *   evicted first) and an entry expires \em ttl seconds after it was
+ *   verified.  The authorization server invalidates entries through
+ *   \ref cap_cache_invalidate when the ACLs of a container change.
+ *
+ *   A verification that races with a revocation must not re-insert a
+ *   revoked cap, so callers take a snapshot of the cache epoch
+ *   (\ref cap_cache_epoch) before calling the authr server and pass it
+ *   to \ref cap_cache_insert.  The insert is dropped if an invalidation
+ *   happened in between.
+ *
+ *   @author Ron Oldfield (raoldfi\@sandia.gov)
+ */
+#include "config.h"
+
+#include <pthread.h>
+
+#if STDC_HEADERS
+#include <string.h>
+#include <stdlib.h>
+#endif
+
+#include "support/hashtable/hashtable.h"
+#include "support/hashtable/hash_funcs.h"
+#include "support/timer/timer.h"
+
+#include "storage_server.h"
+#include "cap_cache.h"
+
+
+/**
+ * @brief An entry in the cap cache.
+ *
+ * Entries are kept in a doubly-linked list ordered from most-recently
+ * used (head) to least-recently used (tail).
+ */
+struct cap_entry {
+	lwfs_cap cap;
+	double expires;
+	struct cap_entry *prev;
+	struct cap_entry *next;
+};
+
+static struct hashtable cap_ht;
+static struct cap_entry *lru_head = NULL;
+static struct cap_entry *lru_tail = NULL;
+
+static pthread_mutex_t cap_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static volatile lwfs_bool enabled = FALSE;
+static int max_entries = 0;
+static int ttl = 0;
+static unsigned long epoch = 0;
+
+static struct cap_cache_stats stats;
+
+
+/* make the hashtable functions a little more type-safe */
+static DEFINE_HASHTABLE_INSERT(insert_entry, lwfs_mac, struct cap_entry);
+static DEFINE_HASHTABLE_SEARCH(search_entry, lwfs_mac, struct cap_entry);
+static DEFINE_HASHTABLE_REMOVE(remove_entry, lwfs_mac, struct cap_entry);
+
+static unsigned int hashfromkey(void *key)
+{
+	/* hash an LWFS mac using a standard char * hash func */
+	return RSHash(key, sizeof(lwfs_mac));
+}
+
+static int equalkeys(void *k1, void *k2)
+{
+	/* macs are only equal if they are byte-wise identical */
+	return (0 == memcmp(k1, k2, sizeof(lwfs_mac)));
+}
+
+
+/* ---- Private methods (call with cap_mutex held) ---- */
+
+static void lru_unlink(struct cap_entry *entry)
+{
+	if (entry->prev) entry->prev->next = entry->next;
+	else lru_head = entry->next;
+
+	if (entry->next) entry->next->prev = entry->prev;
+	else lru_tail = entry->prev;
+
+	entry->prev = entry->next = NULL;
+}
+
+static void lru_push_front(struct cap_entry *entry)
+{
+	entry->prev = NULL;
+	entry->next = lru_head;
+	if (lru_head) lru_head->prev = entry;
+	lru_head = entry;
+	if (lru_tail == NULL) lru_tail = entry;
+}
+
+static void drop_entry(struct cap_entry *entry)
+{
+	lru_unlink(entry);
+	remove_entry(&cap_ht, (lwfs_mac *)&entry->cap.mac);
+	free(entry);
+}
+
+
+/* ---- Public methods ---- */
+
+/**
+ * @brief Initialize the cap cache.
+ *
+ * @param size  @input The maximum number of cached caps (0 disables the cache).
+ * @param secs  @input Seconds a verified cap stays valid in the cache 
+ *                     (at most \ref LWFS_MAX_CAP_CACHE_TTL).
+ */
+int cap_cache_init(
+		const int size,
+		const int secs)
+{
+	int rc = LWFS_OK;
+
+	memset(&stats, 0, sizeof(struct cap_cache_stats));
+
+	if (size <= 0) {
+		log_debug(ss_debug_level, "cap cache disabled");
+		enabled = FALSE;
+		return rc;
+	}
+
+	if (!create_hashtable(size, hashfromkey, equalkeys, &cap_ht)) {
+		log_error(ss_debug_level, "could not create cap cache");
+		return LWFS_ERR_NOSPACE;
+	}
+
+	lru_head = lru_tail = NULL;
+	max_entries = size;
+	ttl = secs;
+
+	/* the authr server stops resending revocations after a while */
+	if (ttl > LWFS_MAX_CAP_CACHE_TTL) {
+		log_warn(ss_debug_level, "cap cache ttl=%d is too long, using %d",
+				secs, LWFS_MAX_CAP_CACHE_TTL);
+		ttl = LWFS_MAX_CAP_CACHE_TTL;
+	}
+	epoch = 0;
+	enabled = TRUE;
+
+	log_debug(ss_debug_level, "cap cache enabled (size=%d, ttl=%d)", size, ttl);
+
+	return rc;
+}
+
+/**
+ * @brief Release the resources used by the cap cache.
+ */
+int cap_cache_fini()
+{
+	struct cap_entry *entry;
+
+	pthread_mutex_lock(&cap_mutex);
+
+	if (enabled) {
+		enabled = FALSE;
+
+		/* the hashtable frees the keys, we free the entries */
+		entry = lru_head;
+		while (entry != NULL) {
+			struct cap_entry *next = entry->next;
+			free(entry);
+			entry = next;
+		}
+		lru_head = lru_tail = NULL;
+
+		hashtable_destroy(&cap_ht, NULL);
+	}
+
+	pthread_mutex_unlock(&cap_mutex);
+
+	return LWFS_OK;
+}
+
+/**
+ * @brief Returns true if the cache is in use.
+ */
+lwfs_bool cap_cache_enabled()
+{
+	return enabled;
+}
+
+/**
+ * @brief Stop using the cache.
+ *
+ * The storage server calls this if it could not register the cache
+ * with the authorization server (i.e., it would not receive revocations).
+ */
+void cap_cache_disable()
+{
+	cap_cache_fini();
+}
+
+/**
+ * @brief Return the current invalidation epoch.
+ *
+ * The epoch changes every time the cache processes a revocation.
+ */
+unsigned long cap_cache_epoch()
+{
+	unsigned long result;
+
+	pthread_mutex_lock(&cap_mutex);
+	result = epoch;
+	pthread_mutex_unlock(&cap_mutex);
+
+	return result;
+}
+
+/**
+ * @brief Look for a verified cap in the cache.
+ *
+ * @param cap @input The cap to look for.
+ *
+ * @returns \ref LWFS_OK if the cap is in the cache and has not
+ *          expired, \ref LWFS_ERR_NOENT otherwise.
+ */
+int cap_cache_lookup(
+		const lwfs_cap *cap)
+{
+	int rc = LWFS_ERR_NOENT;
+	struct cap_entry *entry = NULL;
+
+	if (!enabled) {
+		return rc;
+	}
+
+	pthread_mutex_lock(&cap_mutex);
+
+	if (!enabled) {
+		goto unlock;
+	}
+
+	entry = search_entry(&cap_ht, (lwfs_mac *)&cap->mac);
+	if (entry == NULL) {
+		stats.misses++;
+		goto unlock;
+	}
+
+	/* the mac matched; the data has to match too */
+	if (memcmp(&entry->cap.data, &cap->data, sizeof(lwfs_cap_data)) != 0) {
+		log_warn(ss_debug_level, "cap found in cache, but full compare failed");
+		stats.misses++;
+		goto unlock;
+	}
+
+	/* remove the entry if it is too old */
+	if (lwfs_get_time() > entry->expires) {
+		drop_entry(entry);
+		stats.expirations++;
+		stats.misses++;
+		goto unlock;
+	}
+
+	/* move the entry to the front of the LRU list */
+	lru_unlink(entry);
+	lru_push_front(entry);
+
+	stats.hits++;
+	rc = LWFS_OK;
+
+unlock:
+	pthread_mutex_unlock(&cap_mutex);
+
+	return rc;
+}
+
+/**
+ * @brief Add a verified cap to the cache.
+ *
+ * @param cap    @input The cap verified by the authr server.
+ * @param snap   @input The value of \ref cap_cache_epoch before the
+ *                      cap was sent to the authr server.
+ */
+int cap_cache_insert(
+		const lwfs_cap *cap,
+		const unsigned long snap)
+{
+	int rc = LWFS_OK;
+	struct cap_entry *entry = NULL;
+	lwfs_mac *key = NULL;
+
+	if (!enabled) {
+		return rc;
+	}
+
+	pthread_mutex_lock(&cap_mutex);
+
+	if (!enabled) {
+		goto unlock;
+	}
+
+	/* a revocation arrived while we were verifying the cap */
+	if (snap != epoch) {
+		log_debug(ss_debug_level, "cap revoked during verification, not caching");
+		goto unlock;
+	}
+
+	/* another thread may have inserted the same cap */
+	entry = search_entry(&cap_ht, (lwfs_mac *)&cap->mac);
+	if (entry != NULL) {
+		drop_entry(entry);
+	}
+
+	/* make room for the new entry */
+	while ((int)hashtable_count(&cap_ht) >= max_entries) {
+		drop_entry(lru_tail);
+		stats.evictions++;
+	}
+
+	entry = (struct cap_entry *)malloc(sizeof(struct cap_entry));
+	key = (lwfs_mac *)malloc(sizeof(lwfs_mac));
+	if ((entry == NULL) || (key == NULL)) {
+		log_error(ss_debug_level, "could not allocate cap cache entry");
+		rc = LWFS_ERR_NOSPACE;
+		goto unlock;
+	}
+
+	memcpy(&entry->cap, cap, sizeof(lwfs_cap));
+	memcpy(key, &cap->mac, sizeof(lwfs_mac));
+	entry->expires = lwfs_get_time() + ttl;
+
+	/* the hashtable owns the key */
+	if (!insert_entry(&cap_ht, key, entry)) {
+		log_error(ss_debug_level, "could not insert into cap cache");
+		rc = LWFS_ERR_NOSPACE;
+		goto unlock;
+	}
+	key = NULL;
+
+	lru_push_front(entry);
+	entry = NULL;
+
+	stats.inserts++;
+
+unlock:
+	pthread_mutex_unlock(&cap_mutex);
+
+	if (entry) free(entry);
+	if (key) free(key);
+
+	return rc;
+}
+
+/**
+ * @brief Remove the cached caps for a container.
+ *
+ * Removes every cached cap for container \em cid that enables
+ * at least one of the operations in \em container_op.
+ *
+ * @param cid    @input The container ID.
+ * @param container_op @input The revoked operations.
+ */
+int cap_cache_invalidate(
+		const lwfs_cid cid,
+		const lwfs_container_op container_op)
+{
+	struct cap_entry *entry;
+
+	pthread_mutex_lock(&cap_mutex);
+
+	stats.revocations++;
+	epoch++;
+
+	if (enabled) {
+		entry = lru_head;
+		while (entry != NULL) {
+			struct cap_entry *next = entry->next;
+
+			if ((entry->cap.data.cid == cid) &&
+			    (entry->cap.data.container_op & container_op)) {
+				drop_entry(entry);
+				stats.invalidations++;
+			}
+
+			entry = next;
+		}
+	}
+
+	pthread_mutex_unlock(&cap_mutex);
+
+	return LWFS_OK;
+}
+
+/**
+ * @brief Get a copy of the cache counters.
+ */
+void cap_cache_get_stats(
+		struct cap_cache_stats *result)
+{
+	pthread_mutex_lock(&cap_mutex);
+	memcpy(result, &stats, sizeof(struct cap_cache_stats));
+	pthread_mutex_unlock(&cap_mutex);
+}
+
+/**
+ * @brief Print the cache counters.
+ */
+void fprint_cap_cache_stats(
+		FILE *fp)
+{
+	struct cap_cache_stats s;
+
+	cap_cache_get_stats(&s);
+
+	fprintf(fp, "  Cap cache:\n");
+	fprintf(fp, "\thits = %ld\n", s.hits);
+	fprintf(fp, "\tmisses = %ld\n", s.misses);
+	fprintf(fp, "\tinserts = %ld\n", s.inserts);
+	fprintf(fp, "\tevictions = %ld\n", s.evictions);
+	fprintf(fp, "\texpirations = %ld\n", s.expirations);
+	fprintf(fp, "\tinvalidations = %ld\n", s.invalidations);
+	fprintf(fp, "\trevocations = %ld\n", s.revocations);
+}
@@ -0,0 +1,82 @@
+/**
+ *   @file cap_cache.h
+ *
+ *   @brief Prototypes for the storage server's cache of verified caps.
+ *
+ *   @author Ron Oldfield (raoldfi\@sandia.gov)
+ */
+
+#ifndef _CAP_CACHE_H_
+#define _CAP_CACHE_H_
+
+#include <stdio.h>
+#include "common/types/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	/**
+	 * @brief Counters for the cap cache.
+	 */
+	struct cap_cache_stats {
+		/** @brief Caps found (and not expired) in the cache. */
+		long hits;
+
+		/** @brief Caps that required a call to the authr server. */
+		long misses;
+
+		/** @brief Caps added to the cache. */
+		long inserts;
+
+		/** @brief Entries removed to make room for new entries. */
+		long evictions;
+
+		/** @brief Entries removed because they were too old. */
+		long expirations;
+
+		/** @brief Entries removed by a revocation. */
+		long invalidations;
+
+		/** @brief Revocations received from the authr server. */
+		long revocations;
+	};
+
+#if defined(__STDC__) || defined(__cplusplus)
+
+	extern int cap_cache_init(
+			const int max_entries,
+			const int ttl);
+
+	extern int cap_cache_fini(void);
+
+	extern lwfs_bool cap_cache_enabled(void);
+
+	extern void cap_cache_disable(void);
+
+	extern unsigned long cap_cache_epoch(void);
+
+	extern int cap_cache_lookup(
+			const lwfs_cap *cap);
+
+	extern int cap_cache_insert(
+			const lwfs_cap *cap,
+			const unsigned long epoch);
+
+	extern int cap_cache_invalidate(
+			const lwfs_cid cid,
+			const lwfs_container_op container_op);
+
+	extern void cap_cache_get_stats(
+			struct cap_cache_stats *stats);
+
+	extern void fprint_cap_cache_stats(
+			FILE *fp);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
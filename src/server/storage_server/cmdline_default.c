@@ -35,12 +35,21 @@ const char *gengetopt_args_info_help[] = {
   "      --ss-pid=INT              The process ID to use for the server  \n                                  (default=`122')",
   "      --ss-numbufs=INT          The number of I/O buffers to use on the server  \n                                  (default=`10')",
   "      --ss-bufsize=LONG         The size (in bytes) of an I/O buffer  \n                                  (default=`1048576')",
+  "      --ss-io-threads=INT       Number of threads that read and write objects \n                                  (each extent of an object uses one thread)  \n                                  (default=`4')",
   "      --ss-root=STRING          Path to root  (default=`ss-root')",
-  "      --ss-iolib=STRING         Which I/O library to use  (possible \n                                  values=\"sysio\", \"aio\", \"sim\", \"ebofs\" \n                                  default=`sysio')",
+  "      --ss-iolib=STRING         Which I/O library to use  (possible \n                                  values=\"sysio\", \"aio\", \"kaio\", \"sim\", \n                                  \"ebofs\" default=`sysio')",
+  "      --ss-durability=STRING    When written data reaches the disk (sysio and \n                                  aio)  (possible values=\"sync\", \"dsync\", \n                                  \"writeback\", \"periodic\" default=`sync')",
+  "      --ss-flush-interval=INT   Seconds between background flushes (periodic \n                                  durability)  (default=`5')",
+  "      --ss-max-dirty=INT        Flush early when more than this many MB are \n                                  dirty (periodic durability, 0=no limit)  \n                                  (default=`256')",
+  "      --ss-dir-levels=INT       Directory levels (256 directories each) for the \n                                  objects of a new root (sysio and aio)  \n                                  (default=`2')",
+  "      --ss-direct-io            Bypass the page cache with O_DIRECT (kaio)  \n                                  (default=off)",
   "      --ss-xfer-only            A flag to only transfer data (no disk I/O)  \n                                  (default=off)",
   "      --ss-db-path=STRING       Path to the object attribute database  \n                                  (default=`ss-attr.db')",
   "      --ss-db-clear             Clear the object attribute database before use  \n                                  (default=off)",
   "      --ss-db-recover           Recover the object attribute database after a \n                                  crash  (default=off)",
+  "      --ss-cap-cache-size=INT   Max number of verified caps to cache (0 \n                                  disables the cache)  (default=`1024')",
+  "      --ss-cap-cache-ttl=INT    Seconds a verified cap stays in the cache  \n                                  (at most 60)  (default=`60')",
+  "      --ss-local-caps           Flag to verify caps with the key of the authr \n                                  server (requires authr-share-key)  \n                                  (default=off)",
   "      --ss-trace                Enable tracing  (default=off)",
   "      --ss-tracefile=STRING     Path to the trace file  \n                                  (default=`ss-trace.sddf')",
   "      --ss-traceftype=INT       Type of tracefile (0=binary,1=ASCII)  \n                                  (default=`0')",
@@ -48,9 +57,18 @@ const char *gengetopt_args_info_help[] = {
   "      --logfile=STRING          Path to logfile",
   "      --tp-init-thread-count=INT\n                                Initial number of thread in the pool  \n                                  (default=`1')",
   "      --tp-min-thread-count=INT Minimum number of thread in the pool  \n                                  (default=`1')",
-  "      --tp-max-thread-count=INT Maximum number of thread in the pool  \n                                  (default=`1')",
+  "      --tp-max-thread-count=INT Maximum number of thread in the pool  \n                                  (default=`999999999')",
   "      --tp-low-watermark=INT    Request queue size at which threads are removed \n                                  from the pool  (default=`1')",
-  "      --tp-high-watermark=INT   Request queue size at which threads are added \n                                  to the pool  (default=`1')",
+  "      --tp-high-watermark=INT   Request queue size at which threads are added \n                                  to the pool  (default=`999999999')",
+  "      --tp-queue-high-watermark=INT\n                                Request queue size at which the server turns \n                                  away new requests (0=default)  (default=`0')",
+  "      --tp-queue-low-watermark=INT\n                                Request queue size at which the pool accepts \n                                  requests again  (default=`0')",
+  "      --tp-metadata-weight=INT  Share of the threads for metadata requests \n                                  (0=default)  (default=`0')",
+  "      --tp-bulk-weight=INT      Share of the threads for bulk data requests \n                                  (0=default)  (default=`0')",
+  "      --tp-batch-size=INT       Requests a thread takes from the queue at once; \n                                  idle threads steal the rest (0=default)  \n                                  (default=`0')",
+  "      --tp-pin-threads          Run each thread on its own CPU  (default=off)",
+  "      --max-mem-allowed=INT     System memory usage in kilobytes above which \n                                  the server rejects new requests  (default=`0')",
+  "      --rpc-req-segments=INT    Segments in the ring of request buffers (0 = \n                                  default)  (default=`0')",
+  "      --rpc-reqs-per-segment=INT\n                                Requests each segment of the ring holds (0 = \n                                  default)  (default=`0')",
   "      --authr-pid=LONG          PID of the authr server  (default=`124')",
   "      --authr-nid=LONG          NID of the authr server  (default=`0')",
   "      --authr-cache-caps        Cache caps on the client  (default=off)",
@@ -90,7 +108,8 @@ free_cmd_list(void)
 }
 
 
-char *cmdline_parser_ss_iolib_values[] = {"sysio", "aio", "sim", "ebofs", 0} ;	/* Possible values for ss-iolib.  */
+char *cmdline_parser_ss_iolib_values[] = {"sysio", "aio", "kaio", "sim", "ebofs", 0} ;	/* Possible values for ss-iolib.  */
+char *cmdline_parser_ss_durability_values[] = {"sync", "dsync", "writeback", "periodic", 0} ;	/* Possible values for ss-durability.  */
 
 static char *
 gengetopt_strdup (const char *s);
@@ -107,12 +126,21 @@ void clear_given (struct gengetopt_args_info *args_info)
   args_info->ss_pid_given = 0 ;
   args_info->ss_numbufs_given = 0 ;
   args_info->ss_bufsize_given = 0 ;
+  args_info->ss_io_threads_given = 0 ;
   args_info->ss_root_given = 0 ;
   args_info->ss_iolib_given = 0 ;
+  args_info->ss_durability_given = 0 ;
+  args_info->ss_flush_interval_given = 0 ;
+  args_info->ss_max_dirty_given = 0 ;
+  args_info->ss_dir_levels_given = 0 ;
+  args_info->ss_direct_io_given = 0 ;
   args_info->ss_xfer_only_given = 0 ;
   args_info->ss_db_path_given = 0 ;
   args_info->ss_db_clear_given = 0 ;
   args_info->ss_db_recover_given = 0 ;
+  args_info->ss_cap_cache_size_given = 0 ;
+  args_info->ss_cap_cache_ttl_given = 0 ;
+  args_info->ss_local_caps_given = 0 ;
   args_info->ss_trace_given = 0 ;
   args_info->ss_tracefile_given = 0 ;
   args_info->ss_traceftype_given = 0 ;
@@ -123,6 +151,15 @@ void clear_given (struct gengetopt_args_info *args_info)
   args_info->tp_max_thread_count_given = 0 ;
   args_info->tp_low_watermark_given = 0 ;
   args_info->tp_high_watermark_given = 0 ;
+  args_info->tp_queue_high_watermark_given = 0 ;
+  args_info->tp_queue_low_watermark_given = 0 ;
+  args_info->tp_metadata_weight_given = 0 ;
+  args_info->tp_bulk_weight_given = 0 ;
+  args_info->tp_batch_size_given = 0 ;
+  args_info->tp_pin_threads_given = 0 ;
+  args_info->max_mem_allowed_given = 0 ;
+  args_info->rpc_req_segments_given = 0 ;
+  args_info->rpc_reqs_per_segment_given = 0 ;
   args_info->authr_pid_given = 0 ;
   args_info->authr_nid_given = 0 ;
   args_info->authr_cache_caps_given = 0 ;
@@ -143,15 +180,31 @@ void clear_args (struct gengetopt_args_info *args_info)
   args_info->ss_numbufs_orig = NULL;
   args_info->ss_bufsize_arg = 1048576;
   args_info->ss_bufsize_orig = NULL;
+  args_info->ss_io_threads_arg = 4;
+  args_info->ss_io_threads_orig = NULL;
   args_info->ss_root_arg = gengetopt_strdup ("ss-root");
   args_info->ss_root_orig = NULL;
   args_info->ss_iolib_arg = gengetopt_strdup ("sysio");
   args_info->ss_iolib_orig = NULL;
+  args_info->ss_durability_arg = gengetopt_strdup ("sync");
+  args_info->ss_durability_orig = NULL;
+  args_info->ss_flush_interval_arg = 5;
+  args_info->ss_flush_interval_orig = NULL;
+  args_info->ss_max_dirty_arg = 256;
+  args_info->ss_max_dirty_orig = NULL;
+  args_info->ss_dir_levels_arg = 2;
+  args_info->ss_dir_levels_orig = NULL;
+  args_info->ss_direct_io_flag = 0;
   args_info->ss_xfer_only_flag = 0;
   args_info->ss_db_path_arg = gengetopt_strdup ("ss-attr.db");
   args_info->ss_db_path_orig = NULL;
   args_info->ss_db_clear_flag = 0;
   args_info->ss_db_recover_flag = 0;
+  args_info->ss_cap_cache_size_arg = 1024;
+  args_info->ss_cap_cache_size_orig = NULL;
+  args_info->ss_cap_cache_ttl_arg = 60;
+  args_info->ss_cap_cache_ttl_orig = NULL;
+  args_info->ss_local_caps_flag = 0;
   args_info->ss_trace_flag = 0;
   args_info->ss_tracefile_arg = gengetopt_strdup ("ss-trace.sddf");
   args_info->ss_tracefile_orig = NULL;
@@ -165,12 +218,29 @@ void clear_args (struct gengetopt_args_info *args_info)
   args_info->tp_init_thread_count_orig = NULL;
   args_info->tp_min_thread_count_arg = 1;
   args_info->tp_min_thread_count_orig = NULL;
-  args_info->tp_max_thread_count_arg = 1;
+  args_info->tp_max_thread_count_arg = 999999999;
   args_info->tp_max_thread_count_orig = NULL;
   args_info->tp_low_watermark_arg = 1;
   args_info->tp_low_watermark_orig = NULL;
-  args_info->tp_high_watermark_arg = 1;
+  args_info->tp_high_watermark_arg = 999999999;
   args_info->tp_high_watermark_orig = NULL;
+  args_info->tp_queue_high_watermark_arg = 0;
+  args_info->tp_queue_high_watermark_orig = NULL;
+  args_info->tp_queue_low_watermark_arg = 0;
+  args_info->tp_queue_low_watermark_orig = NULL;
+  args_info->tp_metadata_weight_arg = 0;
+  args_info->tp_metadata_weight_orig = NULL;
+  args_info->tp_bulk_weight_arg = 0;
+  args_info->tp_bulk_weight_orig = NULL;
+  args_info->tp_batch_size_arg = 0;
+  args_info->tp_batch_size_orig = NULL;
+  args_info->tp_pin_threads_flag = 0;
+  args_info->max_mem_allowed_arg = 0;
+  args_info->max_mem_allowed_orig = NULL;
+  args_info->rpc_req_segments_arg = 0;
+  args_info->rpc_req_segments_orig = NULL;
+  args_info->rpc_reqs_per_segment_arg = 0;
+  args_info->rpc_reqs_per_segment_orig = NULL;
   args_info->authr_pid_arg = 124;
   args_info->authr_pid_orig = NULL;
   args_info->authr_nid_arg = 0;
@@ -191,25 +261,43 @@ void init_args_info(struct gengetopt_args_info *args_info)
   args_info->ss_pid_help = gengetopt_args_info_help[6] ;
   args_info->ss_numbufs_help = gengetopt_args_info_help[7] ;
   args_info->ss_bufsize_help = gengetopt_args_info_help[8] ;
-  args_info->ss_root_help = gengetopt_args_info_help[9] ;
-  args_info->ss_iolib_help = gengetopt_args_info_help[10] ;
-  args_info->ss_xfer_only_help = gengetopt_args_info_help[11] ;
-  args_info->ss_db_path_help = gengetopt_args_info_help[12] ;
-  args_info->ss_db_clear_help = gengetopt_args_info_help[13] ;
-  args_info->ss_db_recover_help = gengetopt_args_info_help[14] ;
-  args_info->ss_trace_help = gengetopt_args_info_help[15] ;
-  args_info->ss_tracefile_help = gengetopt_args_info_help[16] ;
-  args_info->ss_traceftype_help = gengetopt_args_info_help[17] ;
-  args_info->verbose_help = gengetopt_args_info_help[18] ;
-  args_info->logfile_help = gengetopt_args_info_help[19] ;
-  args_info->tp_init_thread_count_help = gengetopt_args_info_help[20] ;
-  args_info->tp_min_thread_count_help = gengetopt_args_info_help[21] ;
-  args_info->tp_max_thread_count_help = gengetopt_args_info_help[22] ;
-  args_info->tp_low_watermark_help = gengetopt_args_info_help[23] ;
-  args_info->tp_high_watermark_help = gengetopt_args_info_help[24] ;
-  args_info->authr_pid_help = gengetopt_args_info_help[25] ;
-  args_info->authr_nid_help = gengetopt_args_info_help[26] ;
-  args_info->authr_cache_caps_help = gengetopt_args_info_help[27] ;
+  args_info->ss_io_threads_help = gengetopt_args_info_help[9] ;
+  args_info->ss_root_help = gengetopt_args_info_help[10] ;
+  args_info->ss_iolib_help = gengetopt_args_info_help[11] ;
+  args_info->ss_durability_help = gengetopt_args_info_help[12] ;
+  args_info->ss_flush_interval_help = gengetopt_args_info_help[13] ;
+  args_info->ss_max_dirty_help = gengetopt_args_info_help[14] ;
+  args_info->ss_dir_levels_help = gengetopt_args_info_help[15] ;
+  args_info->ss_direct_io_help = gengetopt_args_info_help[16] ;
+  args_info->ss_xfer_only_help = gengetopt_args_info_help[17] ;
+  args_info->ss_db_path_help = gengetopt_args_info_help[18] ;
+  args_info->ss_db_clear_help = gengetopt_args_info_help[19] ;
+  args_info->ss_db_recover_help = gengetopt_args_info_help[20] ;
+  args_info->ss_cap_cache_size_help = gengetopt_args_info_help[21] ;
+  args_info->ss_cap_cache_ttl_help = gengetopt_args_info_help[22] ;
+  args_info->ss_local_caps_help = gengetopt_args_info_help[23] ;
+  args_info->ss_trace_help = gengetopt_args_info_help[24] ;
+  args_info->ss_tracefile_help = gengetopt_args_info_help[25] ;
+  args_info->ss_traceftype_help = gengetopt_args_info_help[26] ;
+  args_info->verbose_help = gengetopt_args_info_help[27] ;
+  args_info->logfile_help = gengetopt_args_info_help[28] ;
+  args_info->tp_init_thread_count_help = gengetopt_args_info_help[29] ;
+  args_info->tp_min_thread_count_help = gengetopt_args_info_help[30] ;
+  args_info->tp_max_thread_count_help = gengetopt_args_info_help[31] ;
+  args_info->tp_low_watermark_help = gengetopt_args_info_help[32] ;
+  args_info->tp_high_watermark_help = gengetopt_args_info_help[33] ;
+  args_info->tp_queue_high_watermark_help = gengetopt_args_info_help[34] ;
+  args_info->tp_queue_low_watermark_help = gengetopt_args_info_help[35] ;
+  args_info->tp_metadata_weight_help = gengetopt_args_info_help[36] ;
+  args_info->tp_bulk_weight_help = gengetopt_args_info_help[37] ;
+  args_info->tp_batch_size_help = gengetopt_args_info_help[38] ;
+  args_info->tp_pin_threads_help = gengetopt_args_info_help[39] ;
+  args_info->max_mem_allowed_help = gengetopt_args_info_help[40] ;
+  args_info->rpc_req_segments_help = gengetopt_args_info_help[41] ;
+  args_info->rpc_reqs_per_segment_help = gengetopt_args_info_help[42] ;
+  args_info->authr_pid_help = gengetopt_args_info_help[43] ;
+  args_info->authr_nid_help = gengetopt_args_info_help[44] ;
+  args_info->authr_cache_caps_help = gengetopt_args_info_help[45] ;
   
 }
 
@@ -275,6 +363,11 @@ cmdline_parser_release (struct gengetopt_args_info *args_info)
       free (args_info->ss_bufsize_orig); /* free previous argument */
       args_info->ss_bufsize_orig = 0;
     }
+  if (args_info->ss_io_threads_orig)
+    {
+      free (args_info->ss_io_threads_orig); /* free previous argument */
+      args_info->ss_io_threads_orig = 0;
+    }
   if (args_info->ss_root_arg)
     {
       free (args_info->ss_root_arg); /* free previous argument */
@@ -295,6 +388,31 @@ cmdline_parser_release (struct gengetopt_args_info *args_info)
       free (args_info->ss_iolib_orig); /* free previous argument */
       args_info->ss_iolib_orig = 0;
     }
+  if (args_info->ss_durability_arg)
+    {
+      free (args_info->ss_durability_arg); /* free previous argument */
+      args_info->ss_durability_arg = 0;
+    }
+  if (args_info->ss_durability_orig)
+    {
+      free (args_info->ss_durability_orig); /* free previous argument */
+      args_info->ss_durability_orig = 0;
+    }
+  if (args_info->ss_flush_interval_orig)
+    {
+      free (args_info->ss_flush_interval_orig); /* free previous argument */
+      args_info->ss_flush_interval_orig = 0;
+    }
+  if (args_info->ss_max_dirty_orig)
+    {
+      free (args_info->ss_max_dirty_orig); /* free previous argument */
+      args_info->ss_max_dirty_orig = 0;
+    }
+  if (args_info->ss_dir_levels_orig)
+    {
+      free (args_info->ss_dir_levels_orig); /* free previous argument */
+      args_info->ss_dir_levels_orig = 0;
+    }
   if (args_info->ss_db_path_arg)
     {
       free (args_info->ss_db_path_arg); /* free previous argument */
@@ -305,6 +423,16 @@ cmdline_parser_release (struct gengetopt_args_info *args_info)
       free (args_info->ss_db_path_orig); /* free previous argument */
       args_info->ss_db_path_orig = 0;
     }
+  if (args_info->ss_cap_cache_size_orig)
+    {
+      free (args_info->ss_cap_cache_size_orig); /* free previous argument */
+      args_info->ss_cap_cache_size_orig = 0;
+    }
+  if (args_info->ss_cap_cache_ttl_orig)
+    {
+      free (args_info->ss_cap_cache_ttl_orig); /* free previous argument */
+      args_info->ss_cap_cache_ttl_orig = 0;
+    }
   if (args_info->ss_tracefile_arg)
     {
       free (args_info->ss_tracefile_arg); /* free previous argument */
@@ -360,6 +488,46 @@ cmdline_parser_release (struct gengetopt_args_info *args_info)
       free (args_info->tp_high_watermark_orig); /* free previous argument */
       args_info->tp_high_watermark_orig = 0;
     }
+  if (args_info->tp_queue_high_watermark_orig)
+    {
+      free (args_info->tp_queue_high_watermark_orig); /* free previous argument */
+      args_info->tp_queue_high_watermark_orig = 0;
+    }
+  if (args_info->tp_queue_low_watermark_orig)
+    {
+      free (args_info->tp_queue_low_watermark_orig); /* free previous argument */
+      args_info->tp_queue_low_watermark_orig = 0;
+    }
+  if (args_info->tp_metadata_weight_orig)
+    {
+      free (args_info->tp_metadata_weight_orig); /* free previous argument */
+      args_info->tp_metadata_weight_orig = 0;
+    }
+  if (args_info->tp_bulk_weight_orig)
+    {
+      free (args_info->tp_bulk_weight_orig); /* free previous argument */
+      args_info->tp_bulk_weight_orig = 0;
+    }
+  if (args_info->tp_batch_size_orig)
+    {
+      free (args_info->tp_batch_size_orig); /* free previous argument */
+      args_info->tp_batch_size_orig = 0;
+    }
+  if (args_info->max_mem_allowed_orig)
+    {
+      free (args_info->max_mem_allowed_orig); /* free previous argument */
+      args_info->max_mem_allowed_orig = 0;
+    }
+  if (args_info->rpc_req_segments_orig)
+    {
+      free (args_info->rpc_req_segments_orig); /* free previous argument */
+      args_info->rpc_req_segments_orig = 0;
+    }
+  if (args_info->rpc_reqs_per_segment_orig)
+    {
+      free (args_info->rpc_reqs_per_segment_orig); /* free previous argument */
+      args_info->rpc_reqs_per_segment_orig = 0;
+    }
   if (args_info->authr_pid_orig)
     {
       free (args_info->authr_pid_orig); /* free previous argument */
@@ -435,6 +603,13 @@ cmdline_parser_file_save(const char *filename, struct gengetopt_args_info *args_
       fprintf(outfile, "%s\n", "ss-bufsize");
     }
   }
+  if (args_info->ss_io_threads_given) {
+    if (args_info->ss_io_threads_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "ss-io-threads", args_info->ss_io_threads_orig);
+    } else {
+      fprintf(outfile, "%s\n", "ss-io-threads");
+    }
+  }
   if (args_info->ss_root_given) {
     if (args_info->ss_root_orig) {
       fprintf(outfile, "%s=\"%s\"\n", "ss-root", args_info->ss_root_orig);
@@ -449,6 +624,37 @@ cmdline_parser_file_save(const char *filename, struct gengetopt_args_info *args_
       fprintf(outfile, "%s\n", "ss-iolib");
     }
   }
+  if (args_info->ss_durability_given) {
+    if (args_info->ss_durability_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "ss-durability", args_info->ss_durability_orig);
+    } else {
+      fprintf(outfile, "%s\n", "ss-durability");
+    }
+  }
+  if (args_info->ss_flush_interval_given) {
+    if (args_info->ss_flush_interval_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "ss-flush-interval", args_info->ss_flush_interval_orig);
+    } else {
+      fprintf(outfile, "%s\n", "ss-flush-interval");
+    }
+  }
+  if (args_info->ss_max_dirty_given) {
+    if (args_info->ss_max_dirty_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "ss-max-dirty", args_info->ss_max_dirty_orig);
+    } else {
+      fprintf(outfile, "%s\n", "ss-max-dirty");
+    }
+  }
+  if (args_info->ss_dir_levels_given) {
+    if (args_info->ss_dir_levels_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "ss-dir-levels", args_info->ss_dir_levels_orig);
+    } else {
+      fprintf(outfile, "%s\n", "ss-dir-levels");
+    }
+  }
+  if (args_info->ss_direct_io_given) {
+    fprintf(outfile, "%s\n", "ss-direct-io");
+  }
   if (args_info->ss_xfer_only_given) {
     fprintf(outfile, "%s\n", "ss-xfer-only");
   }
@@ -465,6 +671,23 @@ cmdline_parser_file_save(const char *filename, struct gengetopt_args_info *args_
   if (args_info->ss_db_recover_given) {
     fprintf(outfile, "%s\n", "ss-db-recover");
   }
+  if (args_info->ss_cap_cache_size_given) {
+    if (args_info->ss_cap_cache_size_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "ss-cap-cache-size", args_info->ss_cap_cache_size_orig);
+    } else {
+      fprintf(outfile, "%s\n", "ss-cap-cache-size");
+    }
+  }
+  if (args_info->ss_cap_cache_ttl_given) {
+    if (args_info->ss_cap_cache_ttl_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "ss-cap-cache-ttl", args_info->ss_cap_cache_ttl_orig);
+    } else {
+      fprintf(outfile, "%s\n", "ss-cap-cache-ttl");
+    }
+  }
+  if (args_info->ss_local_caps_given) {
+    fprintf(outfile, "%s\n", "ss-local-caps");
+  }
   if (args_info->ss_trace_given) {
     fprintf(outfile, "%s\n", "ss-trace");
   }
@@ -531,6 +754,65 @@ cmdline_parser_file_save(const char *filename, struct gengetopt_args_info *args_
       fprintf(outfile, "%s\n", "tp-high-watermark");
     }
   }
+  if (args_info->tp_queue_high_watermark_given) {
+    if (args_info->tp_queue_high_watermark_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "tp-queue-high-watermark", args_info->tp_queue_high_watermark_orig);
+    } else {
+      fprintf(outfile, "%s\n", "tp-queue-high-watermark");
+    }
+  }
+  if (args_info->tp_queue_low_watermark_given) {
+    if (args_info->tp_queue_low_watermark_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "tp-queue-low-watermark", args_info->tp_queue_low_watermark_orig);
+    } else {
+      fprintf(outfile, "%s\n", "tp-queue-low-watermark");
+    }
+  }
+  if (args_info->tp_metadata_weight_given) {
+    if (args_info->tp_metadata_weight_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "tp-metadata-weight", args_info->tp_metadata_weight_orig);
+    } else {
+      fprintf(outfile, "%s\n", "tp-metadata-weight");
+    }
+  }
+  if (args_info->tp_bulk_weight_given) {
+    if (args_info->tp_bulk_weight_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "tp-bulk-weight", args_info->tp_bulk_weight_orig);
+    } else {
+      fprintf(outfile, "%s\n", "tp-bulk-weight");
+    }
+  }
+  if (args_info->tp_batch_size_given) {
+    if (args_info->tp_batch_size_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "tp-batch-size", args_info->tp_batch_size_orig);
+    } else {
+      fprintf(outfile, "%s\n", "tp-batch-size");
+    }
+  }
+  if (args_info->tp_pin_threads_given) {
+    fprintf(outfile, "%s\n", "tp-pin-threads");
+  }
+  if (args_info->max_mem_allowed_given) {
+    if (args_info->max_mem_allowed_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "max-mem-allowed", args_info->max_mem_allowed_orig);
+    } else {
+      fprintf(outfile, "%s\n", "max-mem-allowed");
+    }
+  }
+  if (args_info->rpc_req_segments_given) {
+    if (args_info->rpc_req_segments_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "rpc-req-segments", args_info->rpc_req_segments_orig);
+    } else {
+      fprintf(outfile, "%s\n", "rpc-req-segments");
+    }
+  }
+  if (args_info->rpc_reqs_per_segment_given) {
+    if (args_info->rpc_reqs_per_segment_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "rpc-reqs-per-segment", args_info->rpc_reqs_per_segment_orig);
+    } else {
+      fprintf(outfile, "%s\n", "rpc-reqs-per-segment");
+    }
+  }
   if (args_info->authr_pid_given) {
     if (args_info->authr_pid_orig) {
       fprintf(outfile, "%s=\"%s\"\n", "authr-pid", args_info->authr_pid_orig);
@@ -674,12 +956,21 @@ cmdline_parser_internal (int argc, char * const *argv, struct gengetopt_args_inf
         { "ss-pid",	1, NULL, 0 },
         { "ss-numbufs",	1, NULL, 0 },
         { "ss-bufsize",	1, NULL, 0 },
+        { "ss-io-threads",	1, NULL, 0 },
         { "ss-root",	1, NULL, 0 },
         { "ss-iolib",	1, NULL, 0 },
+        { "ss-durability",	1, NULL, 0 },
+        { "ss-flush-interval",	1, NULL, 0 },
+        { "ss-max-dirty",	1, NULL, 0 },
+        { "ss-dir-levels",	1, NULL, 0 },
+        { "ss-direct-io",	0, NULL, 0 },
         { "ss-xfer-only",	0, NULL, 0 },
         { "ss-db-path",	1, NULL, 0 },
         { "ss-db-clear",	0, NULL, 0 },
         { "ss-db-recover",	0, NULL, 0 },
+        { "ss-cap-cache-size",	1, NULL, 0 },
+        { "ss-cap-cache-ttl",	1, NULL, 0 },
+        { "ss-local-caps",	0, NULL, 0 },
         { "ss-trace",	0, NULL, 0 },
         { "ss-tracefile",	1, NULL, 0 },
         { "ss-traceftype",	1, NULL, 0 },
@@ -690,6 +981,15 @@ cmdline_parser_internal (int argc, char * const *argv, struct gengetopt_args_inf
         { "tp-max-thread-count",	1, NULL, 0 },
         { "tp-low-watermark",	1, NULL, 0 },
         { "tp-high-watermark",	1, NULL, 0 },
+        { "tp-queue-high-watermark",	1, NULL, 0 },
+        { "tp-queue-low-watermark",	1, NULL, 0 },
+        { "tp-metadata-weight",	1, NULL, 0 },
+        { "tp-bulk-weight",	1, NULL, 0 },
+        { "tp-batch-size",	1, NULL, 0 },
+        { "tp-pin-threads",	0, NULL, 0 },
+        { "max-mem-allowed",	1, NULL, 0 },
+        { "rpc-req-segments",	1, NULL, 0 },
+        { "rpc-reqs-per-segment",	1, NULL, 0 },
         { "authr-pid",	1, NULL, 0 },
         { "authr-nid",	1, NULL, 0 },
         { "authr-cache-caps",	0, NULL, 0 },
@@ -846,6 +1146,27 @@ cmdline_parser_internal (int argc, char * const *argv, struct gengetopt_args_inf
               free (args_info->ss_bufsize_orig); /* free previous string */
             args_info->ss_bufsize_orig = gengetopt_strdup (optarg);
           }
+          /* Number of threads that read and write objects (each extent of an object uses one thread).  */
+          else if (strcmp (long_options[option_index].name, "ss-io-threads") == 0)
+          {
+            if (local_args_info.ss_io_threads_given)
+              {
+                fprintf (stderr, "%s: `--ss-io-threads' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->ss_io_threads_given && ! override)
+              continue;
+            local_args_info.ss_io_threads_given = 1;
+            args_info->ss_io_threads_given = 1;
+            args_info->ss_io_threads_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->ss_io_threads_orig)
+              free (args_info->ss_io_threads_orig); /* free previous string */
+            args_info->ss_io_threads_orig = gengetopt_strdup (optarg);
+          }
           /* Path to root.  */
           else if (strcmp (long_options[option_index].name, "ss-root") == 0)
           {
@@ -889,6 +1210,107 @@ cmdline_parser_internal (int argc, char * const *argv, struct gengetopt_args_inf
               free (args_info->ss_iolib_orig); /* free previous string */
             args_info->ss_iolib_orig = gengetopt_strdup (optarg);
           }
+          /* When written data reaches the disk (sysio and aio).  */
+          else if (strcmp (long_options[option_index].name, "ss-durability") == 0)
+          {
+            if (local_args_info.ss_durability_given)
+              {
+                fprintf (stderr, "%s: `--ss-durability' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if ((found = check_possible_values(optarg, cmdline_parser_ss_durability_values)) < 0)
+              {
+                fprintf (stderr, "%s: %s argument, \"%s\", for option `--ss-durability'%s\n", argv[0], (found == -2) ? "ambiguous" : "invalid", optarg, (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->ss_durability_given && ! override)
+              continue;
+            local_args_info.ss_durability_given = 1;
+            args_info->ss_durability_given = 1;
+            if (args_info->ss_durability_arg)
+              free (args_info->ss_durability_arg); /* free previous string */
+            args_info->ss_durability_arg = gengetopt_strdup (cmdline_parser_ss_durability_values[found]);
+            if (args_info->ss_durability_orig)
+              free (args_info->ss_durability_orig); /* free previous string */
+            args_info->ss_durability_orig = gengetopt_strdup (optarg);
+          }
+          /* Seconds between background flushes (periodic durability).  */
+          else if (strcmp (long_options[option_index].name, "ss-flush-interval") == 0)
+          {
+            if (local_args_info.ss_flush_interval_given)
+              {
+                fprintf (stderr, "%s: `--ss-flush-interval' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->ss_flush_interval_given && ! override)
+              continue;
+            local_args_info.ss_flush_interval_given = 1;
+            args_info->ss_flush_interval_given = 1;
+            args_info->ss_flush_interval_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->ss_flush_interval_orig)
+              free (args_info->ss_flush_interval_orig); /* free previous string */
+            args_info->ss_flush_interval_orig = gengetopt_strdup (optarg);
+          }
+          /* Flush early when more than this many MB are dirty (periodic durability, 0=no limit).  */
+          else if (strcmp (long_options[option_index].name, "ss-max-dirty") == 0)
+          {
+            if (local_args_info.ss_max_dirty_given)
+              {
+                fprintf (stderr, "%s: `--ss-max-dirty' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->ss_max_dirty_given && ! override)
+              continue;
+            local_args_info.ss_max_dirty_given = 1;
+            args_info->ss_max_dirty_given = 1;
+            args_info->ss_max_dirty_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->ss_max_dirty_orig)
+              free (args_info->ss_max_dirty_orig); /* free previous string */
+            args_info->ss_max_dirty_orig = gengetopt_strdup (optarg);
+          }
+          /* Directory levels (256 directories each) for the objects of a new root (sysio and aio).  */
+          else if (strcmp (long_options[option_index].name, "ss-dir-levels") == 0)
+          {
+            if (local_args_info.ss_dir_levels_given)
+              {
+                fprintf (stderr, "%s: `--ss-dir-levels' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->ss_dir_levels_given && ! override)
+              continue;
+            local_args_info.ss_dir_levels_given = 1;
+            args_info->ss_dir_levels_given = 1;
+            args_info->ss_dir_levels_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->ss_dir_levels_orig)
+              free (args_info->ss_dir_levels_orig); /* free previous string */
+            args_info->ss_dir_levels_orig = gengetopt_strdup (optarg);
+          }
+          /* Bypass the page cache with O_DIRECT (kaio).  */
+          else if (strcmp (long_options[option_index].name, "ss-direct-io") == 0)
+          {
+            if (local_args_info.ss_direct_io_given)
+              {
+                fprintf (stderr, "%s: `--ss-direct-io' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->ss_direct_io_given && ! override)
+              continue;
+            local_args_info.ss_direct_io_given = 1;
+            args_info->ss_direct_io_given = 1;
+            args_info->ss_direct_io_flag = !(args_info->ss_direct_io_flag);
+          }
           /* A flag to only transfer data (no disk I/O).  */
           else if (strcmp (long_options[option_index].name, "ss-xfer-only") == 0)
           {
@@ -950,6 +1372,62 @@ cmdline_parser_internal (int argc, char * const *argv, struct gengetopt_args_inf
             args_info->ss_db_recover_given = 1;
             args_info->ss_db_recover_flag = !(args_info->ss_db_recover_flag);
           }
+          /* Max number of verified caps to cache (0 disables the cache).  */
+          else if (strcmp (long_options[option_index].name, "ss-cap-cache-size") == 0)
+          {
+            if (local_args_info.ss_cap_cache_size_given)
+              {
+                fprintf (stderr, "%s: `--ss-cap-cache-size' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->ss_cap_cache_size_given && ! override)
+              continue;
+            local_args_info.ss_cap_cache_size_given = 1;
+            args_info->ss_cap_cache_size_given = 1;
+            args_info->ss_cap_cache_size_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->ss_cap_cache_size_orig)
+              free (args_info->ss_cap_cache_size_orig); /* free previous string */
+            args_info->ss_cap_cache_size_orig = gengetopt_strdup (optarg);
+          }
+          /* Seconds a verified cap stays in the cache.  */
+          else if (strcmp (long_options[option_index].name, "ss-cap-cache-ttl") == 0)
+          {
+            if (local_args_info.ss_cap_cache_ttl_given)
+              {
+                fprintf (stderr, "%s: `--ss-cap-cache-ttl' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->ss_cap_cache_ttl_given && ! override)
+              continue;
+            local_args_info.ss_cap_cache_ttl_given = 1;
+            args_info->ss_cap_cache_ttl_given = 1;
+            args_info->ss_cap_cache_ttl_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->ss_cap_cache_ttl_orig)
+              free (args_info->ss_cap_cache_ttl_orig); /* free previous string */
+            args_info->ss_cap_cache_ttl_orig = gengetopt_strdup (optarg);
+          }
+          /* Flag to verify caps with the key of the authr server (requires authr-share-key).  */
+          else if (strcmp (long_options[option_index].name, "ss-local-caps") == 0)
+          {
+            if (local_args_info.ss_local_caps_given)
+              {
+                fprintf (stderr, "%s: `--ss-local-caps' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->ss_local_caps_given && ! override)
+              continue;
+            local_args_info.ss_local_caps_given = 1;
+            args_info->ss_local_caps_given = 1;
+            args_info->ss_local_caps_flag = !(args_info->ss_local_caps_flag);
+          }
           /* Enable tracing.  */
           else if (strcmp (long_options[option_index].name, "ss-trace") == 0)
           {
@@ -1149,6 +1627,188 @@ cmdline_parser_internal (int argc, char * const *argv, struct gengetopt_args_inf
               free (args_info->tp_high_watermark_orig); /* free previous string */
             args_info->tp_high_watermark_orig = gengetopt_strdup (optarg);
           }
+          /* Request queue size at which the server turns away new requests (0=default).  */
+          else if (strcmp (long_options[option_index].name, "tp-queue-high-watermark") == 0)
+          {
+            if (local_args_info.tp_queue_high_watermark_given)
+              {
+                fprintf (stderr, "%s: `--tp-queue-high-watermark' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->tp_queue_high_watermark_given && ! override)
+              continue;
+            local_args_info.tp_queue_high_watermark_given = 1;
+            args_info->tp_queue_high_watermark_given = 1;
+            args_info->tp_queue_high_watermark_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->tp_queue_high_watermark_orig)
+              free (args_info->tp_queue_high_watermark_orig); /* free previous string */
+            args_info->tp_queue_high_watermark_orig = gengetopt_strdup (optarg);
+          }
+          /* Request queue size at which the pool accepts requests again.  */
+          else if (strcmp (long_options[option_index].name, "tp-queue-low-watermark") == 0)
+          {
+            if (local_args_info.tp_queue_low_watermark_given)
+              {
+                fprintf (stderr, "%s: `--tp-queue-low-watermark' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->tp_queue_low_watermark_given && ! override)
+              continue;
+            local_args_info.tp_queue_low_watermark_given = 1;
+            args_info->tp_queue_low_watermark_given = 1;
+            args_info->tp_queue_low_watermark_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->tp_queue_low_watermark_orig)
+              free (args_info->tp_queue_low_watermark_orig); /* free previous string */
+            args_info->tp_queue_low_watermark_orig = gengetopt_strdup (optarg);
+          }
+          /* Share of the threads for metadata requests (0=default).  */
+          else if (strcmp (long_options[option_index].name, "tp-metadata-weight") == 0)
+          {
+            if (local_args_info.tp_metadata_weight_given)
+              {
+                fprintf (stderr, "%s: `--tp-metadata-weight' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->tp_metadata_weight_given && ! override)
+              continue;
+            local_args_info.tp_metadata_weight_given = 1;
+            args_info->tp_metadata_weight_given = 1;
+            args_info->tp_metadata_weight_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->tp_metadata_weight_orig)
+              free (args_info->tp_metadata_weight_orig); /* free previous string */
+            args_info->tp_metadata_weight_orig = gengetopt_strdup (optarg);
+          }
+          /* Share of the threads for bulk data requests (0=default).  */
+          else if (strcmp (long_options[option_index].name, "tp-bulk-weight") == 0)
+          {
+            if (local_args_info.tp_bulk_weight_given)
+              {
+                fprintf (stderr, "%s: `--tp-bulk-weight' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->tp_bulk_weight_given && ! override)
+              continue;
+            local_args_info.tp_bulk_weight_given = 1;
+            args_info->tp_bulk_weight_given = 1;
+            args_info->tp_bulk_weight_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->tp_bulk_weight_orig)
+              free (args_info->tp_bulk_weight_orig); /* free previous string */
+            args_info->tp_bulk_weight_orig = gengetopt_strdup (optarg);
+          }
+          /* Requests a thread takes from the queue at once; idle threads steal the rest (0=default).  */
+          else if (strcmp (long_options[option_index].name, "tp-batch-size") == 0)
+          {
+            if (local_args_info.tp_batch_size_given)
+              {
+                fprintf (stderr, "%s: `--tp-batch-size' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->tp_batch_size_given && ! override)
+              continue;
+            local_args_info.tp_batch_size_given = 1;
+            args_info->tp_batch_size_given = 1;
+            args_info->tp_batch_size_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->tp_batch_size_orig)
+              free (args_info->tp_batch_size_orig); /* free previous string */
+            args_info->tp_batch_size_orig = gengetopt_strdup (optarg);
+          }
+          /* Run each thread on its own CPU.  */
+          else if (strcmp (long_options[option_index].name, "tp-pin-threads") == 0)
+          {
+            if (local_args_info.tp_pin_threads_given)
+              {
+                fprintf (stderr, "%s: `--tp-pin-threads' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->tp_pin_threads_given && ! override)
+              continue;
+            local_args_info.tp_pin_threads_given = 1;
+            args_info->tp_pin_threads_given = 1;
+            args_info->tp_pin_threads_flag = !(args_info->tp_pin_threads_flag);
+          }
+          /* System memory usage in kilobytes above which the server rejects new requests.  */
+          else if (strcmp (long_options[option_index].name, "max-mem-allowed") == 0)
+          {
+            if (local_args_info.max_mem_allowed_given)
+              {
+                fprintf (stderr, "%s: `--max-mem-allowed' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->max_mem_allowed_given && ! override)
+              continue;
+            local_args_info.max_mem_allowed_given = 1;
+            args_info->max_mem_allowed_given = 1;
+            args_info->max_mem_allowed_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->max_mem_allowed_orig)
+              free (args_info->max_mem_allowed_orig); /* free previous string */
+            args_info->max_mem_allowed_orig = gengetopt_strdup (optarg);
+          }
+          /* Segments in the ring of request buffers (0 = default).  */
+          else if (strcmp (long_options[option_index].name, "rpc-req-segments") == 0)
+          {
+            if (local_args_info.rpc_req_segments_given)
+              {
+                fprintf (stderr, "%s: `--rpc-req-segments' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->rpc_req_segments_given && ! override)
+              continue;
+            local_args_info.rpc_req_segments_given = 1;
+            args_info->rpc_req_segments_given = 1;
+            args_info->rpc_req_segments_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->rpc_req_segments_orig)
+              free (args_info->rpc_req_segments_orig); /* free previous string */
+            args_info->rpc_req_segments_orig = gengetopt_strdup (optarg);
+          }
+          /* Requests each segment of the ring holds (0 = default).  */
+          else if (strcmp (long_options[option_index].name, "rpc-reqs-per-segment") == 0)
+          {
+            if (local_args_info.rpc_reqs_per_segment_given)
+              {
+                fprintf (stderr, "%s: `--rpc-reqs-per-segment' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->rpc_reqs_per_segment_given && ! override)
+              continue;
+            local_args_info.rpc_reqs_per_segment_given = 1;
+            args_info->rpc_reqs_per_segment_given = 1;
+            args_info->rpc_reqs_per_segment_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->rpc_reqs_per_segment_orig)
+              free (args_info->rpc_reqs_per_segment_orig); /* free previous string */
+            args_info->rpc_reqs_per_segment_orig = gengetopt_strdup (optarg);
+          }
           /* PID of the authr server.  */
           else if (strcmp (long_options[option_index].name, "authr-pid") == 0)
           {
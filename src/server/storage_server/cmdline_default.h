@@ -45,12 +45,29 @@ struct gengetopt_args_info
   long ss_bufsize_arg;	/* The size (in bytes) of an I/O buffer (default='1048576').  */
   char * ss_bufsize_orig;	/* The size (in bytes) of an I/O buffer original value given at command line.  */
   const char *ss_bufsize_help; /* The size (in bytes) of an I/O buffer help description.  */
+  int ss_io_threads_arg;	/* Number of threads that read and write objects (each extent of an object uses one thread) (default='4').  */
+  char * ss_io_threads_orig;	/* Number of threads that read and write objects (each extent of an object uses one thread) original value given at command line.  */
+  const char *ss_io_threads_help; /* Number of threads that read and write objects (each extent of an object uses one thread) help description.  */
   char * ss_root_arg;	/* Path to root (default='ss-root').  */
   char * ss_root_orig;	/* Path to root original value given at command line.  */
   const char *ss_root_help; /* Path to root help description.  */
   char * ss_iolib_arg;	/* Which I/O library to use (default='sysio').  */
   char * ss_iolib_orig;	/* Which I/O library to use original value given at command line.  */
   const char *ss_iolib_help; /* Which I/O library to use help description.  */
+  char * ss_durability_arg;	/* When written data reaches the disk (sysio and aio) (default='sync').  */
+  char * ss_durability_orig;	/* When written data reaches the disk (sysio and aio) original value given at command line.  */
+  const char *ss_durability_help; /* When written data reaches the disk (sysio and aio) help description.  */
+  int ss_flush_interval_arg;	/* Seconds between background flushes (periodic durability) (default='5').  */
+  char * ss_flush_interval_orig;	/* Seconds between background flushes (periodic durability) original value given at command line.  */
+  const char *ss_flush_interval_help; /* Seconds between background flushes (periodic durability) help description.  */
+  int ss_max_dirty_arg;	/* Flush early when more than this many MB are dirty (periodic durability, 0=no limit) (default='256').  */
+  char * ss_max_dirty_orig;	/* Flush early when more than this many MB are dirty (periodic durability, 0=no limit) original value given at command line.  */
+  const char *ss_max_dirty_help; /* Flush early when more than this many MB are dirty (periodic durability, 0=no limit) help description.  */
+  int ss_dir_levels_arg;	/* Directory levels (256 directories each) for the objects of a new root (sysio and aio) (default='2').  */
+  char * ss_dir_levels_orig;	/* Directory levels (256 directories each) for the objects of a new root (sysio and aio) original value given at command line.  */
+  const char *ss_dir_levels_help; /* Directory levels (256 directories each) for the objects of a new root (sysio and aio) help description.  */
+  int ss_direct_io_flag;	/* Bypass the page cache with O_DIRECT (kaio) (default=off).  */
+  const char *ss_direct_io_help; /* Bypass the page cache with O_DIRECT (kaio) help description.  */
   int ss_xfer_only_flag;	/* A flag to only transfer data (no disk I/O) (default=off).  */
   const char *ss_xfer_only_help; /* A flag to only transfer data (no disk I/O) help description.  */
   char * ss_db_path_arg;	/* Path to the object attribute database (default='ss-attr.db').  */
@@ -60,6 +77,14 @@ struct gengetopt_args_info
   const char *ss_db_clear_help; /* Clear the object attribute database before use help description.  */
   int ss_db_recover_flag;	/* Recover the object attribute database after a crash (default=off).  */
   const char *ss_db_recover_help; /* Recover the object attribute database after a crash help description.  */
+  int ss_cap_cache_size_arg;	/* Max number of verified caps to cache (0 disables the cache) (default='1024').  */
+  char * ss_cap_cache_size_orig;	/* Max number of verified caps to cache (0 disables the cache) original value given at command line.  */
+  const char *ss_cap_cache_size_help; /* Max number of verified caps to cache (0 disables the cache) help description.  */
+  int ss_cap_cache_ttl_arg;	/* Seconds a verified cap stays in the cache (default='60').  */
+  char * ss_cap_cache_ttl_orig;	/* Seconds a verified cap stays in the cache original value given at command line.  */
+  const char *ss_cap_cache_ttl_help; /* Seconds a verified cap stays in the cache help description.  */
+  int ss_local_caps_flag;	/* Flag to verify caps with the key of the authr server (requires authr-share-key) (default=off).  */
+  const char *ss_local_caps_help; /* Flag to verify caps with the key of the authr server (requires authr-share-key) help description.  */
   int ss_trace_flag;	/* Enable tracing (default=off).  */
   const char *ss_trace_help; /* Enable tracing help description.  */
   char * ss_tracefile_arg;	/* Path to the trace file (default='ss-trace.sddf').  */
@@ -80,15 +105,41 @@ struct gengetopt_args_info
   int tp_min_thread_count_arg;	/* Minimum number of thread in the pool (default='1').  */
   char * tp_min_thread_count_orig;	/* Minimum number of thread in the pool original value given at command line.  */
   const char *tp_min_thread_count_help; /* Minimum number of thread in the pool help description.  */
-  int tp_max_thread_count_arg;	/* Maximum number of thread in the pool (default='1').  */
+  int tp_max_thread_count_arg;	/* Maximum number of thread in the pool (default='999999999').  */
   char * tp_max_thread_count_orig;	/* Maximum number of thread in the pool original value given at command line.  */
   const char *tp_max_thread_count_help; /* Maximum number of thread in the pool help description.  */
   int tp_low_watermark_arg;	/* Request queue size at which threads are removed from the pool (default='1').  */
   char * tp_low_watermark_orig;	/* Request queue size at which threads are removed from the pool original value given at command line.  */
   const char *tp_low_watermark_help; /* Request queue size at which threads are removed from the pool help description.  */
-  int tp_high_watermark_arg;	/* Request queue size at which threads are added to the pool (default='1').  */
+  int tp_high_watermark_arg;	/* Request queue size at which threads are added to the pool (default='999999999').  */
   char * tp_high_watermark_orig;	/* Request queue size at which threads are added to the pool original value given at command line.  */
   const char *tp_high_watermark_help; /* Request queue size at which threads are added to the pool help description.  */
+  int tp_queue_high_watermark_arg;	/* Request queue size at which the server turns away new requests (0=default) (default='0').  */
+  char * tp_queue_high_watermark_orig;	/* Request queue size at which the server turns away new requests (0=default) original value given at command line.  */
+  const char *tp_queue_high_watermark_help; /* Request queue size at which the server turns away new requests (0=default) help description.  */
+  int tp_queue_low_watermark_arg;	/* Request queue size at which the pool accepts requests again (default='0').  */
+  char * tp_queue_low_watermark_orig;	/* Request queue size at which the pool accepts requests again original value given at command line.  */
+  const char *tp_queue_low_watermark_help; /* Request queue size at which the pool accepts requests again help description.  */
+  int tp_metadata_weight_arg;	/* Share of the threads for metadata requests (0=default) (default='0').  */
+  char * tp_metadata_weight_orig;	/* Share of the threads for metadata requests (0=default) original value given at command line.  */
+  const char *tp_metadata_weight_help; /* Share of the threads for metadata requests (0=default) help description.  */
+  int tp_bulk_weight_arg;	/* Share of the threads for bulk data requests (0=default) (default='0').  */
+  char * tp_bulk_weight_orig;	/* Share of the threads for bulk data requests (0=default) original value given at command line.  */
+  const char *tp_bulk_weight_help; /* Share of the threads for bulk data requests (0=default) help description.  */
+  int tp_batch_size_arg;	/* Requests a thread takes from the queue at once; idle threads steal the rest (0=default) (default='0').  */
+  char * tp_batch_size_orig;	/* Requests a thread takes from the queue at once; idle threads steal the rest (0=default) original value given at command line.  */
+  const char *tp_batch_size_help; /* Requests a thread takes from the queue at once; idle threads steal the rest (0=default) help description.  */
+  int tp_pin_threads_flag;	/* Run each thread on its own CPU (default=off).  */
+  const char *tp_pin_threads_help; /* Run each thread on its own CPU help description.  */
+  int max_mem_allowed_arg;	/* System memory usage in kilobytes above which the server rejects new requests (default='0').  */
+  char * max_mem_allowed_orig;	/* System memory usage in kilobytes above which the server rejects new requests original value given at command line.  */
+  const char *max_mem_allowed_help; /* System memory usage in kilobytes above which the server rejects new requests help description.  */
+  int rpc_req_segments_arg;	/* Segments in the ring of request buffers (0 = default) (default='0').  */
+  char * rpc_req_segments_orig;	/* Segments in the ring of request buffers (0 = default) original value given at command line.  */
+  const char *rpc_req_segments_help; /* Segments in the ring of request buffers (0 = default) help description.  */
+  int rpc_reqs_per_segment_arg;	/* Requests each segment of the ring holds (0 = default) (default='0').  */
+  char * rpc_reqs_per_segment_orig;	/* Requests each segment of the ring holds (0 = default) original value given at command line.  */
+  const char *rpc_reqs_per_segment_help; /* Requests each segment of the ring holds (0 = default) help description.  */
   long authr_pid_arg;	/* PID of the authr server (default='124').  */
   char * authr_pid_orig;	/* PID of the authr server original value given at command line.  */
   const char *authr_pid_help; /* PID of the authr server help description.  */
@@ -107,12 +158,21 @@ struct gengetopt_args_info
   int ss_pid_given ;	/* Whether ss-pid was given.  */
   int ss_numbufs_given ;	/* Whether ss-numbufs was given.  */
   int ss_bufsize_given ;	/* Whether ss-bufsize was given.  */
+  int ss_io_threads_given ;	/* Whether ss-io-threads was given.  */
   int ss_root_given ;	/* Whether ss-root was given.  */
   int ss_iolib_given ;	/* Whether ss-iolib was given.  */
+  int ss_durability_given ;	/* Whether ss-durability was given.  */
+  int ss_flush_interval_given ;	/* Whether ss-flush-interval was given.  */
+  int ss_max_dirty_given ;	/* Whether ss-max-dirty was given.  */
+  int ss_dir_levels_given ;	/* Whether ss-dir-levels was given.  */
+  int ss_direct_io_given ;	/* Whether ss-direct-io was given.  */
   int ss_xfer_only_given ;	/* Whether ss-xfer-only was given.  */
   int ss_db_path_given ;	/* Whether ss-db-path was given.  */
   int ss_db_clear_given ;	/* Whether ss-db-clear was given.  */
   int ss_db_recover_given ;	/* Whether ss-db-recover was given.  */
+  int ss_cap_cache_size_given ;	/* Whether ss-cap-cache-size was given.  */
+  int ss_cap_cache_ttl_given ;	/* Whether ss-cap-cache-ttl was given.  */
+  int ss_local_caps_given ;	/* Whether ss-local-caps was given.  */
   int ss_trace_given ;	/* Whether ss-trace was given.  */
   int ss_tracefile_given ;	/* Whether ss-tracefile was given.  */
   int ss_traceftype_given ;	/* Whether ss-traceftype was given.  */
@@ -123,6 +183,15 @@ struct gengetopt_args_info
   int tp_max_thread_count_given ;	/* Whether tp-max-thread-count was given.  */
   int tp_low_watermark_given ;	/* Whether tp-low-watermark was given.  */
   int tp_high_watermark_given ;	/* Whether tp-high-watermark was given.  */
+  int tp_queue_high_watermark_given ;	/* Whether tp-queue-high-watermark was given.  */
+  int tp_queue_low_watermark_given ;	/* Whether tp-queue-low-watermark was given.  */
+  int tp_metadata_weight_given ;	/* Whether tp-metadata-weight was given.  */
+  int tp_bulk_weight_given ;	/* Whether tp-bulk-weight was given.  */
+  int tp_batch_size_given ;	/* Whether tp-batch-size was given.  */
+  int tp_pin_threads_given ;	/* Whether tp-pin-threads was given.  */
+  int max_mem_allowed_given ;	/* Whether max-mem-allowed was given.  */
+  int rpc_req_segments_given ;	/* Whether rpc-req-segments was given.  */
+  int rpc_reqs_per_segment_given ;	/* Whether rpc-reqs-per-segment was given.  */
   int authr_pid_given ;	/* Whether authr-pid was given.  */
   int authr_nid_given ;	/* Whether authr-nid was given.  */
   int authr_cache_caps_given ;	/* Whether authr-cache-caps was given.  */
@@ -157,6 +226,7 @@ int cmdline_parser_required (struct gengetopt_args_info *args_info,
   const char *prog_name);
 
 extern char *cmdline_parser_ss_iolib_values[] ;	/* Possible values for ss-iolib.  */
+extern char *cmdline_parser_ss_durability_values[] ;	/* Possible values for ss-durability.  */
 
 
 #ifdef __cplusplus
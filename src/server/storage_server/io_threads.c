@@ -1,187 +1,409 @@
 /**
  * @file io_threads.c
  *
- * The code in this file implements the reader and writer threads
- * used by the LWFS storage server. 
+ * The code in this file implements the I/O threads used by the
+ * LWFS storage server.
+ *
+ * A server thread that handles a large write pops a buffer from
+ * the buffer stack, fetches the next chunk of data from the client
+ * into the buffer, and hands the buffer to an I/O thread
+ * (\ref writer_add_req).  While the I/O thread writes the
+ * chunk to disk, the server thread fetches the next chunk.  The
+ * I/O thread pushes the buffer back onto the stack when the
+ * write completes, so the memory used for writes never exceeds
+ * the size of the buffer stack.
+ *
+ * Large reads work the other way around.  The server thread sends
+ * a request for chunk N+1 to an I/O thread (\ref reader_add_req)
+ * before it puts chunk N on the client, so the disk read overlaps
+ * the wait for the network.  The
+ * server thread owns read requests and their buffers; it waits for
+ * each one with \ref io_req_wait.
+ *
+ * There are several I/O threads, each with its own queue.  A
+ * request goes to the thread chosen by its object and extent (the
+ * offset divided by the extent size, normally the buffer size), so
+ * the chunks of one large write, or the writes of many clients to
+ * one shared object, run in parallel.  Requests for the same extent
+ * of an object always go to the same thread, so they reach the disk
+ * in the order they were submitted.
  *
  * @author Ron Oldfield (raoldfi\@sandia.gov)
  */
 
+#include "config.h"
+
 #include <pthread.h>
 #include <sched.h>
 
+#if STDC_HEADERS
+#include <stdlib.h>
+#include <string.h>
+#endif
+
 #include "storage_server.h"
-#include "sysio_obj.h"
 #include "io_threads.h"
 #include "buffer_stack.h"
 #include "queue.h"
+#include "support/hashtable/hash_funcs.h"
 
-static char root_dir[256]; 
+static struct obj_funcs *obj_funcs = NULL;
 
-struct buffer_stack *buffer_stack=NULL;
+static struct buffer_stack *buffer_stack=NULL;
 
-static pthread_t       reader_thread; 
-static struct queue    reader_queue; 
+/** @brief One I/O thread and the requests it has to process. */
+struct io_thread {
+    pthread_t    thread;
+    struct queue queue;
+};
 
-static pthread_t       writer_thread; 
-static struct queue    writer_queue; 
+static struct io_thread *io_threads = NULL;
+static int num_io_threads = 0;
 
-/* Ctrl-C sets this value to 1 */
-extern volatile int exit_now; 
+/* requests in the same extent of an object use the same thread */
+static lwfs_size io_extent_size = 0;
 
-static lwfs_bool use_simdisk = FALSE; 
+/* stop_io_threads sets this value to TRUE */
+static volatile lwfs_bool io_threads_done = FALSE;
 
 
 /**
- *  This code processes requests from the writer queue.  The request
- *  structure includes a buffer that has already been filled by data
- *  from a remote client. 
- */ 
-void *run_writer()
+ * @brief Mark a request as finished and wake the server thread.
+ */
+static void io_req_done(struct io_req *ioreq, const int rc)
 {
-    log_debug(ss_debug_level, "starting IO Writer");
+    struct io_pipe *pipe = ioreq->pipe;
 
-    while (!exit_now) {
+    pthread_mutex_lock(&pipe->mutex);
+    ioreq->rc = rc;
+    ioreq->state = (rc == LWFS_OK)? IO_REQ_COMPLETE : IO_REQ_ERROR;
+    if ((rc != LWFS_OK) && (pipe->rc == LWFS_OK)) {
+	pipe->rc = rc;
+    }
+    pipe->pending--;
 
-	/* get next ioreq (if empty, this waits for a push) */
-	log_debug(ss_debug_level, "waiting for next write request; exit_now==%d", exit_now);
-	struct io_req *ioreq = (struct io_req *)queue_pop(&writer_queue); 
+    /* the server thread may be waiting for this request (reads) 
+     * or for the whole pipe (writes) */
+    pthread_cond_broadcast(&pipe->cond);
+    pthread_mutex_unlock(&pipe->mutex);
+}
 
-	if (!exit_now && ioreq) {
-	    int rc = LWFS_OK; 
 
-	    log_debug(ss_debug_level, "processing write request");
+/**
+ *  Process a write request.  The request structure includes a 
+ *  buffer that has already been filled by data from a remote client.
+ */
+static void process_write(struct io_req *ioreq)
+{
+    int rc = LWFS_OK;
+    lwfs_ssize bytes_written;
 
-	    if (!use_simdisk) {
-		if (!my_objs_write_obj(root_dir, ioreq->obj, ioreq->offset, 
-			    ioreq->iobuf->buf, ioreq->len)) {
-		    log_error(ss_debug_level, "unable to write buffer");
-		    rc = LWFS_ERR_STORAGE;
-		}
-	    }
+    log_debug(ss_debug_level, "processing write request");
 
-	    /* add the buffer back to the buffer_stack */
-	    buffer_stack_push(buffer_stack, ioreq->iobuf);
-	    if (rc != LWFS_OK) {
-		log_error(ss_debug_level, "unable to push buffer onto stack");
-	    }
+    ioreq->state = IO_REQ_PROCESSING;
 
-	    /* free the ioreq */
-	    free(ioreq); 
+    bytes_written = obj_funcs->write(ioreq->obj, ioreq->offset,
+	    ioreq->iobuf->buf, ioreq->len);
+    ioreq->result = bytes_written;
+    if (bytes_written != (lwfs_ssize)ioreq->len) {
+	log_error(ss_debug_level, "unable to write buffer");
+	rc = LWFS_ERR_STORAGE;
+    }
 
-	    /* decrement the number of pending reqs */
-	    my_objs_decrement_pending(ioreq->obj);
+    /* add the buffer back to the buffer_stack */
+    if (buffer_stack_push(buffer_stack, ioreq->iobuf) != LWFS_OK) {
+	log_error(ss_debug_level, "unable to push buffer onto stack");
+    }
 
-	}
+    io_req_done(ioreq, rc);
+
+    /* free the ioreq */
+    free(ioreq);
+}
+
+/**
+ *  Process a read request.  The server thread that submitted the 
+ *  request puts the data on the client, so we leave the buffer and 
+ *  the request alone.
+ */
+static void process_read(struct io_req *ioreq)
+{
+    int rc = LWFS_OK;
+
+    log_debug(ss_debug_level, "processing read request");
+
+    ioreq->state = IO_REQ_PROCESSING;
+
+    /* a short read means we reached the end of the object */
+    ioreq->result = obj_funcs->read(ioreq->obj, ioreq->offset,
+	    ioreq->iobuf->buf, ioreq->len);
+    if (ioreq->result < 0) {
+	log_error(ss_debug_level, "unable to read buffer");
+	rc = LWFS_ERR_STORAGE;
     }
 
-    log_debug(ss_debug_level, "stopping IO Writer");
-    return NULL;
+    io_req_done(ioreq, rc);
 }
 
 /**
- *  This code processes requests from the reader queue.  The request
- *  structure includes a buffer that has already been filled by data
- *  from a remote client. 
- */ 
-void *run_reader()
+ *  This code processes the requests in the queue of one I/O thread.
+ */
+static void *run_io_thread(void *arg)
 {
-    log_debug(ss_debug_level, "starting IO Reader");
+    struct io_thread *me = (struct io_thread *)arg;
+
+    log_debug(ss_debug_level, "starting IO thread %d", (int)(me - io_threads));
 
-    while (!exit_now) {
+    while (!io_threads_done) {
 
 	/* get next ioreq (if empty, this waits for a push) */
-	//struct io_req *ioreq = (struct io_req *)queue_pop(&reader_queue); 
+	struct io_req *ioreq = (struct io_req *)queue_pop(&me->queue);
 
-	if (!exit_now) {
-	    struct io_req *ioreq; 
+	if (ioreq == NULL) {
+	    continue;
+	}
 
-	    /* process the request */
-	    if (ioreq != NULL) {
-		/* read */
-	    }
+	if (ioreq->type == IO_REQ_WRITE) {
+	    process_write(ioreq);
+	}
+	else {
+	    process_read(ioreq);
 	}
     }
 
-    log_debug(ss_debug_level, "stopping IO Reader");
+    log_debug(ss_debug_level, "stopping IO thread %d", (int)(me - io_threads));
     return NULL;
 }
 
+/**
+ * @brief Choose the thread for a request (by object and extent).
+ */
+static struct io_thread *io_thread_of(const struct io_req *ioreq)
+{
+    unsigned int h;
+    uint64_t extent = ioreq->offset / io_extent_size;
+
+    h = RSHash((char *)ioreq->obj->oid, sizeof(lwfs_oid));
+    h ^= (unsigned int)(extent ^ (extent >> 32)) * 2654435761U;
 
+    return &io_threads[h % num_io_threads];
+}
 
-int start_io_threads(
-		const char *root, 
-		struct buffer_stack *bufs, 
-		const lwfs_bool simdisk)
+/**
+ * @brief Give a request to its I/O thread.
+ */
+static int io_submit_req(struct io_req *ioreq)
 {
     int rc = LWFS_OK;
-    strncpy(root_dir, root, sizeof(root_dir));
 
-    /* should we simulate I/O? */
-    use_simdisk = simdisk; 
+    ioreq->state = IO_REQ_PENDING;
 
-    buffer_stack = bufs; 
+    /* increment the pending count */
+    pthread_mutex_lock(&ioreq->pipe->mutex);
+    ioreq->pipe->pending++;
+    pthread_mutex_unlock(&ioreq->pipe->mutex);
+
+    rc = queue_append(&io_thread_of(ioreq)->queue, ioreq);
+    if (rc != LWFS_OK) {
+	io_req_done(ioreq, rc);
+	return rc;
+    }
 
-    queue_init(&writer_queue);
-    queue_init(&reader_queue); 
+    return rc;
+}
 
-    /* start the writer */
-    pthread_create(&writer_thread, NULL, run_writer, NULL);
 
-    /* start the reader */
-    pthread_create(&reader_thread, NULL, run_reader, NULL);
+/**
+ * @brief Start the I/O threads.
+ *
+ * @param funcs       the object functions of the I/O library.
+ * @param bufs        the stack write buffers go back to.
+ * @param num_threads the number of I/O threads (at least one).
+ * @param extent_size requests in the same extent of an object use
+ *                    the same thread (normally the buffer size).
+ */
+int start_io_threads(
+		struct obj_funcs *funcs,
+		struct buffer_stack *bufs,
+		const int num_threads,
+		const lwfs_size extent_size)
+{
+    int rc = LWFS_OK;
+    int i;
+
+    obj_funcs = funcs;
+    buffer_stack = bufs;
+    io_threads_done = FALSE;
+    io_extent_size = (extent_size > 0)? extent_size : 1;
+
+    io_threads = (struct io_thread *)calloc(
+	    (num_threads > 0)? num_threads : 1, sizeof(struct io_thread));
+    if (io_threads == NULL) {
+	log_error(ss_debug_level, "could not allocate IO threads");
+	return LWFS_ERR_NOSPACE;
+    }
+
+    for (i=0; i<((num_threads > 0)? num_threads : 1); i++) {
+	queue_init(&io_threads[i].queue);
+
+	if (pthread_create(&io_threads[i].thread, NULL, run_io_thread, &io_threads[i]) != 0) {
+	    log_error(ss_debug_level, "could not start IO thread %d", i);
+	    queue_destroy(&io_threads[i].queue, free);
+	    rc = LWFS_ERR;
+	    break;
+	}
+	num_io_threads++;
+    }
 
-    return rc; 
+    if (rc != LWFS_OK) {
+	stop_io_threads();
+	return rc;
+    }
+
+    log_debug(ss_debug_level, "started %d IO threads", num_io_threads);
+
+    return rc;
 }
 
 
 int stop_io_threads()
 {
     int rc = LWFS_OK;
+    int i;
 
     log_debug(ss_debug_level, "stopping IO threads");
 
-    exit_now = TRUE; 
+    io_threads_done = TRUE;
 
-    /* wake the threads */
-    //	pthread_cond_broadcast(&reader_queue.cond); 
-    //	pthread_cond_broadcast(&writer_queue.cond);
+    /* wake the threads (they ignore the NULL request) */
+    for (i=0; i<num_io_threads; i++) {
+	queue_append(&io_threads[i].queue, NULL);
+    }
 
-    pthread_join(writer_thread, NULL); 
-    pthread_join(reader_thread, NULL);
+    for (i=0; i<num_io_threads; i++) {
+	pthread_join(io_threads[i].thread, NULL);
+	queue_destroy(&io_threads[i].queue, free);
+    }
+
+    free(io_threads);
+    io_threads = NULL;
+    num_io_threads = 0;
 
     log_debug(ss_debug_level, "stopped IO threads");
 
-    return rc; 
+    return rc;
 }
 
 
-int writer_add_req(struct io_req *ioreq)
+/**
+ * @brief Initialize the tracker for the I/O requests of an operation.
+ */
+int io_pipe_init(struct io_pipe *pipe)
 {
-    int rc = LWFS_OK;
+    memset(pipe, 0, sizeof(struct io_pipe));
+    pthread_mutex_init(&pipe->mutex, NULL);
+    pthread_cond_init(&pipe->cond, NULL);
+    pipe->pending = 0;
+    pipe->rc = LWFS_OK;
 
-    /* increment the pending count */
-    my_objs_increment_pending(ioreq->obj);
+    return LWFS_OK;
+}
 
-    /* add the request to the writer queue. */
-    queue_append(&writer_queue, ioreq); 
+/**
+ * @brief Return the first error reported for the pipe (without waiting).
+ */
+int io_pipe_status(struct io_pipe *pipe)
+{
+    int rc;
 
-    log_debug(ss_debug_level, "submitted write request");
+    pthread_mutex_lock(&pipe->mutex);
+    rc = pipe->rc;
+    pthread_mutex_unlock(&pipe->mutex);
 
-    return rc; 
+    return rc;
 }
 
+/**
+ * @brief Wait for the I/O threads to finish every request of the pipe.
+ *
+ * The pipe cannot be used after this call.
+ *
+ * @returns The first error reported by an I/O thread (or \ref LWFS_OK).
+ */
+int io_pipe_wait(struct io_pipe *pipe)
+{
+    int rc;
 
-int reader_add_req(struct io_req *ioreq)
+    pthread_mutex_lock(&pipe->mutex);
+    while (pipe->pending > 0) {
+	pthread_cond_wait(&pipe->cond, &pipe->mutex);
+    }
+    rc = pipe->rc;
+    pthread_mutex_unlock(&pipe->mutex);
+
+    pthread_mutex_destroy(&pipe->mutex);
+    pthread_cond_destroy(&pipe->cond);
+
+    return rc;
+}
+
+
+/**
+ * @brief Wait for the I/O thread to finish one request.
+ *
+ * @returns The error reported by the I/O thread (or \ref LWFS_OK).
+ */
+int io_req_wait(struct io_req *ioreq)
+{
+    int rc;
+    struct io_pipe *pipe = ioreq->pipe;
+
+    pthread_mutex_lock(&pipe->mutex);
+    while ((ioreq->state == IO_REQ_PENDING) ||
+	   (ioreq->state == IO_REQ_PROCESSING)) {
+	pthread_cond_wait(&pipe->cond, &pipe->mutex);
+    }
+    rc = ioreq->rc;
+    pthread_mutex_unlock(&pipe->mutex);
+
+    return rc;
+}
+
+
+/**
+ * @brief Send a filled buffer to an I/O thread to write.
+ *
+ * The I/O thread pushes the buffer back onto the buffer stack
+ * and frees the request.  If this function returns an error, the
+ * caller still owns both.
+ */
+int writer_add_req(struct io_req *ioreq)
 {
     int rc = LWFS_OK;
 
-    /* increment the pending count */
-    my_objs_increment_pending(ioreq->obj);
+    ioreq->type = IO_REQ_WRITE;
 
-    /* add the request to the writer queue */
-    queue_append(&reader_queue, ioreq); 
+    rc = io_submit_req(ioreq);
+    if (rc != LWFS_OK) {
+	return rc;
+    }
 
-    return rc; 
+    log_debug(ss_debug_level, "submitted write request");
+
+    return rc;
 }
 
+
+/**
+ * @brief Ask an I/O thread to fill a buffer.
+ *
+ * The caller owns the request and the buffer.  It has to wait
+ * for the request (\ref io_req_wait) before it uses or frees them,
+ * even if this function returns an error.
+ */
+int reader_add_req(struct io_req *ioreq)
+{
+    ioreq->type = IO_REQ_READ;
+
+    return io_submit_req(ioreq);
+}
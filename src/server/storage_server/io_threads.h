@@ -1,7 +1,7 @@
-/**  
+/**
  *   @file io_threads.h
- * 
- *   @brief Prototypes and structure definitions for io_threads. 
+ *
+ *   @brief Prototypes and structure definitions for io_threads.
  *
  *   @author Ron Oldfield (raoldfi\@sandia.gov)
  *   $Revision: 791 $
@@ -24,36 +24,75 @@ extern "C" {
 
 	enum io_req_state {
 		IO_REQ_PENDING,
-		IO_REQ_PROCESSING, 
-		IO_REQ_ERROR, 
+		IO_REQ_PROCESSING,
+		IO_REQ_ERROR,
 		IO_REQ_COMPLETE
 	};
 
+	enum io_req_type {
+		IO_REQ_READ,
+		IO_REQ_WRITE
+	};
+
+	/**
+	 * @brief Tracks the outstanding I/O requests of one
+	 * storage server operation.
+	 *
+	 * A server thread splits a large read or write into
+	 * chunks (one io_req per chunk) and waits on the pipe
+	 * for the I/O threads to finish all of them.
+	 */
+	struct io_pipe {
+		pthread_mutex_t mutex;
+		pthread_cond_t cond;
+
+		/** @brief Number of requests the I/O threads have not finished. */
+		int pending;
+
+		/** @brief The first error reported by an I/O thread. */
+		int rc;
+	};
+
 	struct io_req {
-		pthread_cond_t cond; 
-		pthread_mutex_t mutex; 
-		enum io_req_state state; 
-		lwfs_rma src_addr; 
+		struct io_pipe *pipe;
+		enum io_req_type type;
+		enum io_req_state state;
+		lwfs_rma src_addr;
 		struct io_buffer *iobuf;
-		lwfs_obj *obj;
+		const lwfs_obj *obj;
 		lwfs_size offset;
 		lwfs_size len;
+
+		/** @brief Bytes read or written by the I/O thread. */
+		lwfs_ssize result;
+
+		/** @brief The error reported by the I/O thread. */
+		int rc;
 	};
 
 #if defined(__STDC__) || defined(__cplusplus)
 
 	extern int start_io_threads(
-			const char *root, 
+			struct obj_funcs *funcs,
 			buffer_stack_t *bufs,
-			const lwfs_bool simdisk);
+			const int num_threads,
+			const lwfs_size extent_size);
 
 	extern int stop_io_threads();
 
+	extern int io_pipe_init(struct io_pipe *pipe);
+
+	extern int io_pipe_status(struct io_pipe *pipe);
+
+	extern int io_pipe_wait(struct io_pipe *pipe);
+
+	extern int io_req_wait(struct io_req *ioreq);
+
 	extern int writer_add_req(struct io_req *ioreq);
 
 	extern int reader_add_req(struct io_req *ioreq);
 
-#else 
+#else
 
 #endif
 
@@ -0,0 +1,716 @@
+/**
+ *   @file kaio_obj.c
+ *
+ *   This is the object api that uses the Linux kernel asynchronous
+ *   I/O interface (libaio).
+ *
+ *   A read or write is split into extents of KAIO_EXTENT bytes and
+ *   all the extents go to the kernel in one io_submit call, so the
+ *   disk sees many outstanding requests for one large transfer.  A
+ *   reaper thread collects the completions (io_getevents) and wakes
+ *   the thread that submitted them; nobody spins.  The objects, their
+ *   layout, and the open files come from sysio_obj.c, so fsync uses
+ *   the group commit of that library and honors ss-durability.
+ *
+ *   With direct I/O (O_DIRECT), the kernel moves the data straight
+ *   between the disk and our buffers.  That requires buffers, offsets,
+ *   and sizes aligned to KAIO_ALIGN.  The storage server allocates
+ *   aligned I/O buffers, so large aligned transfers go straight to
+ *   the kernel; other requests are copied through a small pool of
+ *   aligned bounce buffers.
+ *
+ *   This object api is used by the registered storage server
+ *   functions.  See storage_server.c.
+ *
+ *   @author Ron Oldfield (raoldfi\@sandia.gov)
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE   /* O_DIRECT */
+#endif
+
+#include "config.h"
+
+#if STDC_HEADERS
+#include <string.h>
+#include <stdlib.h>
+#endif
+
+#include <stdio.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#include <libaio.h>
+
+#include "storage_server.h"
+#include "storage_db.h"
+#include "kaio_obj.h"
+#include "sysio_obj.h"
+
+/* iocbs in flight (for all the threads) */
+#define KAIO_QUEUE_DEPTH 256
+
+/* bytes per iocb */
+#define KAIO_EXTENT (256*1024)
+
+/* iocbs of a request we keep on the stack */
+#define KAIO_LOCAL_REQS 8
+
+/* alignment of buffers, offsets, and sizes for O_DIRECT */
+#define KAIO_ALIGN 4096
+
+/* aligned buffers for unaligned direct I/O */
+#define KAIO_NUM_BOUNCE 16
+
+/**
+ * @brief The iocbs of one read or write call.
+ */
+struct kaio_batch {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+
+	/** @brief iocbs the kernel has not finished. */
+	int pending;
+};
+
+/**
+ * @brief One extent of a read or write.
+ */
+struct kaio_req {
+	struct iocb iocb;
+	struct kaio_batch *batch;
+
+	/** @brief Bytes transferred (or -errno). */
+	long res;
+};
+
+static io_context_t ctx;
+
+static pthread_t reaper_thread;
+static volatile lwfs_bool reaper_done = FALSE;
+
+static lwfs_bool direct = FALSE;
+
+/* pool of aligned bounce buffers */
+static void *bounce_bufs[KAIO_NUM_BOUNCE];
+static int num_free_bounce = 0;
+static pthread_mutex_t bounce_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t bounce_cond = PTHREAD_COND_INITIALIZER;
+
+/* signaled by the reaper when it frees queue slots */
+static pthread_mutex_t slots_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t slots_cond = PTHREAD_COND_INITIALIZER;
+
+/* serializes read-modify-write of partial blocks */
+static pthread_mutex_t rmw_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static struct kaio_stats stats;
+static pthread_mutex_t stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+/* ---------------- private functions ------------------ */
+
+/* run_reaper()
+ *
+ * collects completed iocbs and wakes the threads that wait for them;
+ */
+static void *run_reaper(void *arg)
+{
+	struct io_event events[KAIO_QUEUE_DEPTH];
+	struct timespec timeout;
+	int n, i;
+
+	log_debug(ss_debug_level, "starting kaio reaper");
+
+	while (!reaper_done) {
+
+		/* wake up now and then to check reaper_done */
+		timeout.tv_sec = 0;
+		timeout.tv_nsec = 100000000;
+
+		n = io_getevents(ctx, 1, KAIO_QUEUE_DEPTH, events, &timeout);
+		if (n < 0) {
+			if (n != -EINTR) {
+				log_error(ss_debug_level, "io_getevents failed: %s",
+						strerror(-n));
+			}
+			continue;
+		}
+
+		for (i=0; i<n; i++) {
+			struct kaio_req *req = (struct kaio_req *)events[i].data;
+			struct kaio_batch *batch = req->batch;
+
+			req->res = (long)events[i].res;
+
+			pthread_mutex_lock(&batch->mutex);
+			batch->pending--;
+			if (batch->pending == 0) {
+				pthread_cond_signal(&batch->cond);
+			}
+			pthread_mutex_unlock(&batch->mutex);
+		}
+
+		if (n > 0) {
+			pthread_mutex_lock(&slots_mutex);
+			pthread_cond_broadcast(&slots_cond);
+			pthread_mutex_unlock(&slots_mutex);
+
+			pthread_mutex_lock(&stats_mutex);
+			stats.events += n;
+			pthread_mutex_unlock(&stats_mutex);
+		}
+	}
+
+	log_debug(ss_debug_level, "stopping kaio reaper");
+	return NULL;
+}
+
+/* wait_for_slots()
+ *
+ * waits until the reaper collects some iocbs; used when the queue
+ * is full of other threads' iocbs.  io_submit can also return EAGAIN
+ * when the kernel is short of resources, and then nobody signals us,
+ * so we give up after a while and retry;
+ */
+static void wait_for_slots(void)
+{
+	struct timespec abstime;
+
+	clock_gettime(CLOCK_REALTIME, &abstime);
+	abstime.tv_nsec += 10000000;    /* 10 ms */
+	if (abstime.tv_nsec >= 1000000000) {
+		abstime.tv_sec++;
+		abstime.tv_nsec -= 1000000000;
+	}
+
+	pthread_mutex_lock(&slots_mutex);
+	pthread_cond_timedwait(&slots_cond, &slots_mutex, &abstime);
+	pthread_mutex_unlock(&slots_mutex);
+}
+
+/* submit_batch()
+ *
+ * submits the iocbs of a request and waits for all of them;
+ * returns LWFS_OK if the kernel accepted every iocb;
+ */
+static int submit_batch(
+		struct kaio_batch *batch,
+		struct iocb **iocbs,
+		const int n)
+{
+	int rc = LWFS_OK;
+	int submitted = 0;
+	int calls = 0;
+	int full = 0;
+
+	while (submitted < n) {
+		int want = n - submitted;
+		int got;
+
+		/* count the iocbs first, the reaper may finish them at once */
+		pthread_mutex_lock(&batch->mutex);
+		batch->pending += want;
+		pthread_mutex_unlock(&batch->mutex);
+
+		got = io_submit(ctx, want, &iocbs[submitted]);
+		calls++;
+
+		pthread_mutex_lock(&batch->mutex);
+		batch->pending -= want - ((got > 0)? got : 0);
+
+		if (got > 0) {
+			submitted += got;
+		}
+		else if (got == -EAGAIN) {
+			/* the queue is full; wait for our iocbs or someone else's */
+			full++;
+			if (batch->pending > 0) {
+				pthread_cond_wait(&batch->cond, &batch->mutex);
+			}
+			else {
+				pthread_mutex_unlock(&batch->mutex);
+				wait_for_slots();
+				pthread_mutex_lock(&batch->mutex);
+			}
+		}
+		else {
+			log_error(ss_debug_level, "io_submit failed: %s",
+					strerror(-got));
+			rc = LWFS_ERR_STORAGE;
+		}
+		pthread_mutex_unlock(&batch->mutex);
+
+		if (rc != LWFS_OK) {
+			break;
+		}
+	}
+
+	/* wait for the iocbs the kernel accepted */
+	pthread_mutex_lock(&batch->mutex);
+	while (batch->pending > 0) {
+		pthread_cond_wait(&batch->cond, &batch->mutex);
+	}
+	pthread_mutex_unlock(&batch->mutex);
+
+	pthread_mutex_lock(&stats_mutex);
+	stats.submits += calls;
+	stats.iocbs += submitted;
+	stats.queue_full += full;
+	pthread_mutex_unlock(&stats_mutex);
+
+	return rc;
+}
+
+/* get_bounce()
+ *
+ * returns an aligned buffer of KAIO_EXTENT bytes (waits if the pool
+ * is empty);
+ */
+static void *get_bounce(void)
+{
+	void *buf;
+
+	pthread_mutex_lock(&bounce_mutex);
+	while (num_free_bounce == 0) {
+		pthread_cond_wait(&bounce_cond, &bounce_mutex);
+	}
+	buf = bounce_bufs[--num_free_bounce];
+	pthread_mutex_unlock(&bounce_mutex);
+
+	return buf;
+}
+
+static void free_bounce(void)
+{
+	int i;
+
+	for (i=0; i<num_free_bounce; i++) {
+		free(bounce_bufs[i]);
+	}
+	num_free_bounce = 0;
+}
+
+static void put_bounce(void *buf)
+{
+	pthread_mutex_lock(&bounce_mutex);
+	bounce_bufs[num_free_bounce++] = buf;
+	pthread_cond_signal(&bounce_cond);
+	pthread_mutex_unlock(&bounce_mutex);
+}
+
+/* bounce_rw()
+ *
+ * Reads or writes an unaligned extent of a file opened with O_DIRECT
+ * through an aligned buffer, one KAIO_EXTENT window at a time.  A
+ * write reads the blocks at the edges first (read-modify-write) and
+ * restores the file size if the last block went past the end.  These
+ * requests are small or rare, so we do them synchronously.
+ *
+ * returns the number of bytes transferred, -1 on error;
+ */
+static lwfs_ssize bounce_rw(
+		const int fd,
+		const lwfs_bool write_op,
+		const lwfs_size offset,
+		char *buf,
+		const lwfs_size len)
+{
+	lwfs_ssize result = 0;
+	lwfs_size pos = offset;
+	lwfs_size end = offset + len;
+	char *bounce = get_bounce();
+
+	if (write_op) {
+		pthread_mutex_lock(&rmw_mutex);
+	}
+
+	while (pos < end) {
+		lwfs_size win = pos & ~((lwfs_size)KAIO_ALIGN - 1);
+		lwfs_size skip = pos - win;
+		lwfs_size n = KAIO_EXTENT - skip;
+		lwfs_size win_len;
+		ssize_t got;
+
+		if (n > end - pos) n = end - pos;
+		win_len = (skip + n + KAIO_ALIGN - 1) & ~((lwfs_size)KAIO_ALIGN - 1);
+
+		got = pread(fd, bounce, win_len, win);
+		if (got < 0) {
+			log_error(ss_debug_level, "pread failed: %s", strerror(errno));
+			result = -1;
+			break;
+		}
+
+		if (!write_op) {
+			/* stop at the end of the file */
+			if ((lwfs_size)got <= skip) break;
+			if ((lwfs_size)got < skip + n) n = got - skip;
+			memcpy(buf + (pos - offset), bounce + skip, n);
+		}
+		else {
+			struct stat sbuf;
+
+			if (fstat(fd, &sbuf) != 0) {
+				result = -1;
+				break;
+			}
+
+			/* the file ends in this window */
+			if ((lwfs_size)got < win_len) {
+				memset(bounce + got, 0, win_len - got);
+			}
+			memcpy(bounce + skip, buf + (pos - offset), n);
+
+			if (pwrite(fd, bounce, win_len, win) != (ssize_t)win_len) {
+				log_error(ss_debug_level, "pwrite failed: %s", strerror(errno));
+				result = -1;
+				break;
+			}
+
+			/* don't grow the file past the data we wrote */
+			if ((win + win_len > (lwfs_size)sbuf.st_size) &&
+			    (win + win_len > pos + n)) {
+				lwfs_size size = pos + n;
+				if ((lwfs_size)sbuf.st_size > size) size = sbuf.st_size;
+				if (ftruncate(fd, size) != 0) {
+					result = -1;
+					break;
+				}
+			}
+		}
+
+		result += n;
+		pos += n;
+	}
+
+	if (write_op) {
+		pthread_mutex_unlock(&rmw_mutex);
+	}
+
+	put_bounce(bounce);
+
+	pthread_mutex_lock(&stats_mutex);
+	stats.bounced++;
+	pthread_mutex_unlock(&stats_mutex);
+
+	return result;
+}
+
+/* finish_write()
+ *
+ * writes the part of an extent the kernel did not write (with
+ * O_DIRECT, through a bounce buffer, since the rest is rarely
+ * aligned);
+ */
+static int finish_write(
+		const int fd,
+		const lwfs_size offset,
+		const char *buf,
+		const lwfs_size len)
+{
+	lwfs_size done = 0;
+
+	if (direct) {
+		if (bounce_rw(fd, TRUE, offset, (char *)buf, len) != (lwfs_ssize)len) {
+			return LWFS_ERR_STORAGE;
+		}
+		return LWFS_OK;
+	}
+
+	while (done < len) {
+		ssize_t n = pwrite(fd, buf + done, len - done, offset + done);
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			log_error(ss_debug_level, "pwrite failed: %s", strerror(errno));
+			return LWFS_ERR_STORAGE;
+		}
+		done += n;
+	}
+
+	return LWFS_OK;
+}
+
+/* kaio_rw()
+ *
+ * Reads or writes an extent of an object.
+ *
+ * returns the number of bytes transferred, -1 on error;
+ */
+static lwfs_ssize kaio_rw(
+		const lwfs_obj *obj,
+		const lwfs_bool write_op,
+		const lwfs_size offset,
+		char *buf,
+		const lwfs_size len)
+{
+	lwfs_ssize result = 0;
+	struct _oid_el *ref = NULL;
+	struct kaio_req local_reqs[KAIO_LOCAL_REQS];
+	struct iocb *local_iocbs[KAIO_LOCAL_REQS];
+	struct kaio_req *reqs = local_reqs;
+	struct iocb **iocbs = local_iocbs;
+	struct kaio_batch batch;
+	int fd;
+	int n, i;
+
+	if (len == 0) {
+		return 0;
+	}
+
+	ref = sysio_obj_acquire_fd(obj, &fd);
+	if (ref == NULL) {
+		log_error(ss_debug_level, "could not get file descriptor");
+		return -1;
+	}
+
+	/* O_DIRECT needs aligned buffers, offsets, and sizes */
+	if (direct &&
+	    ((((unsigned long)buf | offset | len) & (KAIO_ALIGN - 1)) != 0)) {
+		result = bounce_rw(fd, write_op, offset, buf, len);
+		goto cleanup;
+	}
+
+	n = (int)((len + KAIO_EXTENT - 1) / KAIO_EXTENT);
+	if (n > KAIO_LOCAL_REQS) {
+		reqs = (struct kaio_req *)malloc(n*sizeof(struct kaio_req));
+		iocbs = (struct iocb **)malloc(n*sizeof(struct iocb *));
+		if ((reqs == NULL) || (iocbs == NULL)) {
+			log_error(ss_debug_level, "could not allocate iocbs");
+			result = -1;
+			goto cleanup;
+		}
+	}
+
+	memset(&batch, 0, sizeof(struct kaio_batch));
+	pthread_mutex_init(&batch.mutex, NULL);
+	pthread_cond_init(&batch.cond, NULL);
+
+	for (i=0; i<n; i++) {
+		lwfs_size off = (lwfs_size)i*KAIO_EXTENT;
+		lwfs_size count = (len - off < KAIO_EXTENT)? len - off : KAIO_EXTENT;
+
+		memset(&reqs[i], 0, sizeof(struct kaio_req));
+		if (write_op) {
+			io_prep_pwrite(&reqs[i].iocb, fd, buf + off, count, offset + off);
+		}
+		else {
+			io_prep_pread(&reqs[i].iocb, fd, buf + off, count, offset + off);
+		}
+		reqs[i].iocb.data = &reqs[i];
+		reqs[i].batch = &batch;
+		reqs[i].res = -EIO;
+		iocbs[i] = &reqs[i].iocb;
+	}
+
+	if (submit_batch(&batch, iocbs, n) != LWFS_OK) {
+		result = -1;
+	}
+
+	pthread_mutex_destroy(&batch.mutex);
+	pthread_cond_destroy(&batch.cond);
+
+	/* add up the extents (a short read is the end of the object) */
+	for (i=0; (i<n) && (result >= 0); i++) {
+		lwfs_size off = (lwfs_size)i*KAIO_EXTENT;
+		lwfs_size count = (len - off < KAIO_EXTENT)? len - off : KAIO_EXTENT;
+
+		if (reqs[i].res < 0) {
+			log_error(ss_debug_level, "%s failed: %s",
+					(write_op)? "write" : "read", strerror(-reqs[i].res));
+			result = -1;
+			break;
+		}
+
+		if ((lwfs_size)reqs[i].res < count) {
+			if (!write_op) {
+				result += reqs[i].res;
+				break;
+			}
+
+			/* the kernel may split a write; finish it ourselves */
+			if (finish_write(fd, offset + off + reqs[i].res,
+					buf + off + reqs[i].res,
+					count - reqs[i].res) != LWFS_OK) {
+				result = -1;
+				break;
+			}
+			pthread_mutex_lock(&stats_mutex);
+			stats.short_writes++;
+			pthread_mutex_unlock(&stats_mutex);
+		}
+
+		result += count;
+	}
+
+cleanup:
+	if (reqs != local_reqs) {
+		free(reqs);
+		free(iocbs);
+	}
+
+	/* let sysio track the dirty data for fsync and the flusher */
+	if (write_op && (result > 0)) {
+		sysio_obj_mark_dirty(ref, result);
+	}
+	sysio_obj_release_fd(ref);
+
+	return result;
+}
+
+
+/* ---------------- public functions ------------------ */
+
+int kaio_obj_init(
+		const char *root_dir,
+		const lwfs_bool direct_io,
+		struct obj_funcs *obj_funcs)
+{
+	int rc = LWFS_OK;
+	int i;
+
+	memset(&stats, 0, sizeof(struct kaio_stats));
+	direct = direct_io;
+
+	/* sysio opens the files for us */
+	if (direct) {
+		sysio_obj_set_open_flags(O_DIRECT);
+	}
+
+	rc = sysio_obj_init(root_dir, obj_funcs);
+	if (rc != LWFS_OK) {
+		log_error(ss_debug_level, "unable to initialize kaio");
+		return rc;
+	}
+
+	/* the rest of the functions come from sysio */
+	obj_funcs->read = kaio_obj_read;
+	obj_funcs->write = kaio_obj_write;
+	obj_funcs->fsync = kaio_obj_fsync;
+
+	memset(&ctx, 0, sizeof(io_context_t));
+	rc = io_setup(KAIO_QUEUE_DEPTH, &ctx);
+	if (rc != 0) {
+		log_error(ss_debug_level, "io_setup failed: %s", strerror(-rc));
+		sysio_obj_fini();
+		return LWFS_ERR_STORAGE;
+	}
+
+	/* allocate the bounce buffers */
+	num_free_bounce = 0;
+	if (direct) {
+		for (i=0; i<KAIO_NUM_BOUNCE; i++) {
+			if (posix_memalign(&bounce_bufs[i], KAIO_ALIGN, KAIO_EXTENT) != 0) {
+				log_error(ss_debug_level, "could not allocate bounce buffer");
+				free_bounce();
+				io_destroy(ctx);
+				sysio_obj_fini();
+				return LWFS_ERR_NOSPACE;
+			}
+			num_free_bounce++;
+		}
+	}
+
+	reaper_done = FALSE;
+	if (pthread_create(&reaper_thread, NULL, run_reaper, NULL) != 0) {
+		log_error(ss_debug_level, "could not start kaio reaper");
+		free_bounce();
+		io_destroy(ctx);
+		sysio_obj_fini();
+		return LWFS_ERR;
+	}
+
+	log_debug(ss_debug_level, "kaio ready (queue depth=%d, extent=%d, direct=%s)",
+			KAIO_QUEUE_DEPTH, KAIO_EXTENT, (direct)? "yes" : "no");
+
+	return LWFS_OK;
+}
+
+int kaio_obj_fini()
+{
+	/* the server threads waited for all of their iocbs */
+	reaper_done = TRUE;
+	pthread_join(reaper_thread, NULL);
+
+	io_destroy(ctx);
+	free_bounce();
+
+	sysio_obj_set_open_flags(0);
+
+	return sysio_obj_fini();
+}
+
+/* kaio_obj_read()
+ *
+ * assumes that object already exists;
+ *
+ * returns the number of bytes read, -1 on error;
+ */
+lwfs_ssize kaio_obj_read(
+		const lwfs_obj *obj,
+		const lwfs_ssize src_offset,
+		void *dest,
+		const lwfs_ssize len)
+{
+	return kaio_rw(obj, FALSE, src_offset, (char *)dest, len);
+}
+
+/* kaio_obj_write()
+ *
+ * assumes that object already exists;
+ *
+ * returns the number of bytes written, -1 on error;
+ */
+lwfs_ssize kaio_obj_write(
+		const lwfs_obj *obj,
+		const lwfs_ssize dest_offset,
+		void *src,
+		const lwfs_ssize len)
+{
+	return kaio_rw(obj, TRUE, dest_offset, (char *)src, len);
+}
+
+/* kaio_obj_fsync()
+ *
+ * the kernel aio fsync is not supported by most file systems, so we
+ * use the group commit of sysio (the caller sleeps, it doesn't spin);
+ */
+int kaio_obj_fsync(
+		const lwfs_obj *obj)
+{
+	return sysio_obj_fsync(obj);
+}
+
+/**
+ * @brief Get a copy of the kaio counters.
+ */
+void kaio_obj_get_stats(
+		struct kaio_stats *result)
+{
+	pthread_mutex_lock(&stats_mutex);
+	memcpy(result, &stats, sizeof(struct kaio_stats));
+	pthread_mutex_unlock(&stats_mutex);
+}
+
+/**
+ * @brief Print the kaio counters.
+ */
+void fprint_kaio_stats(
+		FILE *fp)
+{
+	struct kaio_stats s;
+
+	kaio_obj_get_stats(&s);
+
+	fprintf(fp, "  Kernel aio:\n");
+	fprintf(fp, "\tsubmits = %ld\n", s.submits);
+	fprintf(fp, "\tiocbs = %ld\n", s.iocbs);
+	fprintf(fp, "\tevents = %ld\n", s.events);
+	fprintf(fp, "\tqueue_full = %ld\n", s.queue_full);
+	fprintf(fp, "\tbounced = %ld\n", s.bounced);
+	fprintf(fp, "\tshort_writes = %ld\n", s.short_writes);
+}
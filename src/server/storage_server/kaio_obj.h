@@ -0,0 +1,61 @@
+#ifndef KAIO_OBJ_H
+#define KAIO_OBJ_H
+
+/* see kaio_obj.c for description of this object api */
+
+#include <stdio.h>
+#include "storage_server.h"
+
+
+/**
+ * @brief Counters for the kernel aio backend.
+ */
+struct kaio_stats {
+	/** @brief Calls to io_submit. */
+	long submits;
+
+	/** @brief Extents submitted to the kernel. */
+	long iocbs;
+
+	/** @brief Completions collected by the reaper thread. */
+	long events;
+
+	/** @brief Times the kernel queue was full (EAGAIN). */
+	long queue_full;
+
+	/** @brief Unaligned direct requests copied through a bounce buffer. */
+	long bounced;
+
+	/** @brief Writes the kernel did not finish (we finish them). */
+	long short_writes;
+};
+
+
+extern int kaio_obj_init(
+		const char *root,
+		const lwfs_bool direct_io,
+		struct obj_funcs *obj_funcs);
+
+extern int kaio_obj_fini(void);
+
+extern lwfs_ssize kaio_obj_read(
+		const lwfs_obj *obj,
+		const lwfs_ssize src_offset,
+		void *dest,
+		const lwfs_ssize len);
+
+extern lwfs_ssize kaio_obj_write(
+		const lwfs_obj *dest_obj,
+		const lwfs_ssize dest_offset,
+		void *src,
+		const lwfs_ssize len);
+
+extern int kaio_obj_fsync(const lwfs_obj *obj);
+
+extern void kaio_obj_get_stats(
+		struct kaio_stats *stats);
+
+extern void fprint_kaio_stats(
+		FILE *fp);
+
+#endif
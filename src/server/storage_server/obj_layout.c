@@ -0,0 +1,278 @@
+/**
+ *   @file obj_layout.c
+ *
+ *   @brief Directory layout of the objects of the sysio backend.
+ *
+ *   Putting millions of objects in one directory makes open, create,
+ *   and the startup scan slow on every local file system we use.  We
+ *   spread the objects over 256^levels directories instead.  The root
+ *   records its layout in ROOT/.layout, so the storage server and
+ *   lwfs-ss-migrate agree on where each object lives.  A root without
+ *   a .layout file is either new or flat (created before layouts).
+ *
+ *   @author Ron Oldfield (raoldfi\@sandia.gov)
+ */
+#include "config.h"
+
+#if STDC_HEADERS
+#include <string.h>
+#include <stdlib.h>
+#endif
+
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "common/types/types.h"
+#include "common/storage_common/ss_debug.h"
+#include "support/logger/logger.h"
+#include "support/hashtable/hash_funcs.h"
+
+#include "obj_layout.h"
+
+
+/* dir_hash()
+ *
+ * returns the hash that picks the directories of an oid; level
+ * i uses byte i of the result;
+ */
+static unsigned int dir_hash(const lwfs_oid oid)
+{
+	unsigned int h = RSHash((char *)oid, sizeof(lwfs_oid));
+
+	return h * 2654435761U;
+}
+
+/* sync_dir()
+ *
+ * makes renames in a directory durable;
+ */
+static void sync_dir(const char *dir)
+{
+	int fd = open(dir, O_RDONLY);
+
+	if (fd != -1) {
+		fsync(fd);
+		close(fd);
+	}
+}
+
+
+/**
+ * @brief Read the layout of a root.
+ *
+ * @returns \ref LWFS_ERR_NOENT if the root has no layout file.
+ */
+int obj_layout_read(
+		const char *root,
+		struct obj_layout *layout)
+{
+	int rc = LWFS_OK;
+	char fname[OBJ_LAYOUT_PATH_LEN];
+	char state[32];
+	FILE *fp = NULL;
+	int n;
+
+	snprintf(fname, sizeof(fname), "%s/%s", root, OBJ_LAYOUT_NAME);
+
+	fp = fopen(fname, "r");
+	if (fp == NULL) {
+		if (errno == ENOENT) {
+			return LWFS_ERR_NOENT;
+		}
+		log_error(ss_debug_level, "could not open %s: %s",
+				fname, strerror(errno));
+		return LWFS_ERR_STORAGE;
+	}
+
+	memset(layout, 0, sizeof(struct obj_layout));
+	state[0] = '\0';
+
+	n = fscanf(fp, "levels=%d %31s", &layout->levels, state);
+	if ((n < 1) ||
+	    (layout->levels < 0) ||
+	    (layout->levels > OBJ_LAYOUT_MAX_LEVELS)) {
+		log_error(ss_debug_level, "invalid layout in %s", fname);
+		rc = LWFS_ERR_STORAGE;
+	}
+	layout->migrating = (strcmp(state, "migrating") == 0);
+
+	fclose(fp);
+
+	return rc;
+}
+
+/**
+ * @brief Record the layout of a root.
+ */
+int obj_layout_write(
+		const char *root,
+		const struct obj_layout *layout)
+{
+	char fname[OBJ_LAYOUT_PATH_LEN];
+	char tmp_name[OBJ_LAYOUT_PATH_LEN];
+	FILE *fp = NULL;
+	int rc = LWFS_OK;
+
+	snprintf(fname, sizeof(fname), "%s/%s", root, OBJ_LAYOUT_NAME);
+	snprintf(tmp_name, sizeof(tmp_name), "%s/%s.tmp", root, OBJ_LAYOUT_NAME);
+
+	fp = fopen(tmp_name, "w");
+	if (fp == NULL) {
+		log_error(ss_debug_level, "could not create %s: %s",
+				tmp_name, strerror(errno));
+		return LWFS_ERR_STORAGE;
+	}
+
+	fprintf(fp, "levels=%d%s\n", layout->levels,
+			(layout->migrating)? " migrating" : "");
+
+	if ((fflush(fp) != 0) || (fsync(fileno(fp)) != 0)) {
+		rc = LWFS_ERR_STORAGE;
+	}
+	if (fclose(fp) != 0) {
+		rc = LWFS_ERR_STORAGE;
+	}
+
+	/* replace the old file in one step */
+	if ((rc != LWFS_OK) || (rename(tmp_name, fname) != 0)) {
+		log_error(ss_debug_level, "could not write %s: %s",
+				fname, strerror(errno));
+		unlink(tmp_name);
+		return LWFS_ERR_STORAGE;
+	}
+	sync_dir(root);
+
+	return rc;
+}
+
+/**
+ * @brief Find the layout of a root, recording one if it has none.
+ *
+ * A root without a layout file that already holds objects is
+ * flat.  An empty root gets \em new_levels levels.
+ */
+int obj_layout_detect(
+		const char *root,
+		const int new_levels,
+		struct obj_layout *layout)
+{
+	int rc = LWFS_OK;
+	DIR *d = NULL;
+	struct dirent *dent = NULL;
+	lwfs_bool has_objs = FALSE;
+
+	rc = obj_layout_read(root, layout);
+	if (rc != LWFS_ERR_NOENT) {
+		return rc;
+	}
+
+	/* look for objects of the flat layout */
+	d = opendir(root);
+	if (d == NULL) {
+		log_error(ss_debug_level, "could not open %s: %s",
+				root, strerror(errno));
+		return LWFS_ERR_STORAGE;
+	}
+	while ((dent = readdir(d)) != NULL) {
+		if (obj_layout_is_obj(dent->d_name)) {
+			has_objs = TRUE;
+			break;
+		}
+	}
+	closedir(d);
+
+	memset(layout, 0, sizeof(struct obj_layout));
+	layout->levels = (has_objs)? 0 : new_levels;
+
+	return obj_layout_write(root, layout);
+}
+
+/**
+ * @brief Generate the path of an object.
+ *
+ * @returns \ref LWFS_ERR_STORAGE if the path does not fit.
+ */
+int obj_layout_path(
+		const char *root,
+		const int levels,
+		const lwfs_oid oid,
+		char *path,
+		const int len)
+{
+	unsigned int h = dir_hash(oid);
+	char ostr[33];
+	int n;
+	int i;
+
+	n = snprintf(path, len, "%s", root);
+	for (i=0; (i<levels) && (n < len); i++) {
+		n += snprintf(path+n, len-n, "/%02x", (h >> (24 - 8*i)) & 0xff);
+	}
+	if (n < len) {
+		n += snprintf(path+n, len-n, "/0x%s", lwfs_oid_to_string(oid, ostr));
+	}
+
+	if (n >= len) {
+		log_error(ss_debug_level, "path of object too long (root=%s)", root);
+		return LWFS_ERR_STORAGE;
+	}
+
+	return LWFS_OK;
+}
+
+/**
+ * @brief Create the directories that hold an object.
+ */
+int obj_layout_mkdirs(
+		const char *root,
+		const int levels,
+		const lwfs_oid oid)
+{
+	unsigned int h = dir_hash(oid);
+	char path[OBJ_LAYOUT_PATH_LEN];
+	int n;
+	int i;
+
+	n = snprintf(path, sizeof(path), "%s", root);
+	for (i=0; i<levels; i++) {
+		n += snprintf(path+n, sizeof(path)-n, "/%02x", (h >> (24 - 8*i)) & 0xff);
+		if (n >= (int)sizeof(path)) {
+			return LWFS_ERR_STORAGE;
+		}
+
+		if ((mkdir(path, S_IRWXU) != 0) && (errno != EEXIST)) {
+			log_error(ss_debug_level, "could not create %s: %s",
+					path, strerror(errno));
+			return LWFS_ERR_STORAGE;
+		}
+	}
+
+	return LWFS_OK;
+}
+
+/**
+ * @brief Returns TRUE if a file name is the name of an object.
+ */
+lwfs_bool obj_layout_is_obj(
+		const char *name)
+{
+	return (strncmp(name, "0x", 2) == 0);
+}
+
+/**
+ * @brief Returns TRUE if a file name is the name of a layout directory.
+ */
+lwfs_bool obj_layout_is_dir(
+		const char *name)
+{
+	const char *hex = "0123456789abcdef";
+
+	return ((strlen(name) == 2) &&
+		(strchr(hex, name[0]) != NULL) &&
+		(strchr(hex, name[1]) != NULL));
+}
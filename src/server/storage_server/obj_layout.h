@@ -0,0 +1,82 @@
+/**
+ *   @file obj_layout.h
+ *
+ *   @brief Prototypes for the directory layout of the sysio objects.
+ *
+ *   @author Ron Oldfield (raoldfi\@sandia.gov)
+ */
+
+#ifndef _OBJ_LAYOUT_H_
+#define _OBJ_LAYOUT_H_
+
+#include "common/types/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+	/** @brief The deepest layout we support (256^3 directories). */
+#define OBJ_LAYOUT_MAX_LEVELS 3
+
+	/** @brief The file in the root that records the layout. */
+#define OBJ_LAYOUT_NAME ".layout"
+
+	/** @brief Size of a buffer for the path of an object. */
+#define OBJ_LAYOUT_PATH_LEN 512
+
+	/**
+	 * @brief The directory layout of a storage root.
+	 *
+	 * An object lives at ROOT/xx/.../0x<oid>, with one two-digit
+	 * hex directory for each level.  The directories come from a
+	 * hash of the oid, so objects spread evenly even if the oids
+	 * are sequential.
+	 */
+	struct obj_layout {
+		/** @brief Number of directory levels (0 is the flat layout). */
+		int levels;
+
+		/** @brief TRUE while lwfs-ss-migrate moves the objects. */
+		lwfs_bool migrating;
+	};
+
+#if defined(__STDC__) || defined(__cplusplus)
+
+	extern int obj_layout_read(
+			const char *root,
+			struct obj_layout *layout);
+
+	extern int obj_layout_write(
+			const char *root,
+			const struct obj_layout *layout);
+
+	extern int obj_layout_detect(
+			const char *root,
+			const int new_levels,
+			struct obj_layout *layout);
+
+	extern int obj_layout_path(
+			const char *root,
+			const int levels,
+			const lwfs_oid oid,
+			char *path,
+			const int len);
+
+	extern int obj_layout_mkdirs(
+			const char *root,
+			const int levels,
+			const lwfs_oid oid);
+
+	extern lwfs_bool obj_layout_is_obj(
+			const char *name);
+
+	extern lwfs_bool obj_layout_is_dir(
+			const char *name);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
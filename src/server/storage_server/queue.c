@@ -155,6 +155,7 @@ int queue_append(struct queue *q, void *data)
 	node = (struct queue_node *)malloc(1*sizeof(struct queue_node));
 	if (!node) {
 		log_error(ss_debug_level, "unable to allocate queue node");
+		rc = LWFS_ERR_NOSPACE;
 		goto unlock;
 	}
 
@@ -0,0 +1,213 @@
+/**
+ *   @file ss_migrate.c
+ *
+ *   @brief Move the objects of a storage root to a new directory layout.
+ *
+ *   Usage: lwfs-ss-migrate [-v] --root=DIR --levels=N
+ *
+ *   The storage server must not be running.  We rename every object
+ *   to its place in the new layout (see obj_layout.c), so the root
+ *   has to fit on one file system, but no data is copied.  The root
+ *   is marked "migrating" until all objects have moved; if the tool
+ *   stops early, run it again with the same arguments.  The index
+ *   snapshot (.oid_index) only holds oids, so it stays valid.
+ *
+ *   @author Ron Oldfield (raoldfi\@sandia.gov)
+ */
+#include "config.h"
+
+#if STDC_HEADERS
+#include <string.h>
+#include <stdlib.h>
+#endif
+
+#include <stdio.h>
+#include <errno.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "common/types/types.h"
+#include "common/storage_common/ss_debug.h"
+#include "support/logger/logger.h"
+
+#include "obj_layout.h"
+
+
+static const char *root = NULL;
+static int new_levels = -1;
+static lwfs_bool verbose = FALSE;
+
+static long num_moved = 0;
+static long num_objs = 0;
+
+static struct option long_options[] = {
+	{"root",    1, 0, 'r'},
+	{"levels",  1, 0, 'l'},
+	{"verbose", 0, 0, 'v'},
+	{"help",    0, 0, 'h'},
+	{0, 0, 0, 0}
+};
+
+static void usage(const char *prog)
+{
+	fprintf(stderr, "usage: %s [-v] --root=DIR --levels=N\n", prog);
+	fprintf(stderr, "  moves the objects of a storage root to a layout with N\n");
+	fprintf(stderr, "  directory levels (0 to %d); stop the storage server first\n",
+			OBJ_LAYOUT_MAX_LEVELS);
+}
+
+
+/* move_obj()
+ *
+ * moves one object to its place in the new layout;
+ */
+static int move_obj(const char *path, const char *name)
+{
+	int rc = LWFS_OK;
+	char new_path[OBJ_LAYOUT_PATH_LEN];
+	lwfs_oid oid;
+
+	lwfs_string_to_oid(&name[2], oid);
+	num_objs++;
+
+	rc = obj_layout_path(root, new_levels, oid, new_path, sizeof(new_path));
+	if (rc != LWFS_OK) {
+		return rc;
+	}
+
+	/* already in place (or moved earlier in this walk) */
+	if (strcmp(path, new_path) == 0) {
+		return LWFS_OK;
+	}
+
+	rc = obj_layout_mkdirs(root, new_levels, oid);
+	if (rc != LWFS_OK) {
+		return rc;
+	}
+
+	if (rename(path, new_path) != 0) {
+		fprintf(stderr, "could not move %s to %s: %s\n",
+				path, new_path, strerror(errno));
+		return LWFS_ERR_STORAGE;
+	}
+
+	if (verbose) {
+		fprintf(stdout, "%s -> %s\n", path, new_path);
+	}
+	num_moved++;
+
+	return LWFS_OK;
+}
+
+/* migrate_dir()
+ *
+ * moves the objects under dir; an interrupted run can leave objects
+ * at any depth, so we look in every layout directory;
+ */
+static int migrate_dir(const char *dir, const int depth)
+{
+	int rc = LWFS_OK;
+	DIR *d = NULL;
+	struct dirent *dent = NULL;
+	char path[OBJ_LAYOUT_PATH_LEN];
+
+	d = opendir(dir);
+	if (d == NULL) {
+		fprintf(stderr, "could not open %s: %s\n", dir, strerror(errno));
+		return LWFS_ERR_STORAGE;
+	}
+
+	while ((rc == LWFS_OK) && ((dent = readdir(d)) != NULL)) {
+		snprintf(path, sizeof(path), "%s/%s", dir, dent->d_name);
+
+		if (obj_layout_is_obj(dent->d_name)) {
+			rc = move_obj(path, dent->d_name);
+		}
+		else if ((depth < OBJ_LAYOUT_MAX_LEVELS) &&
+			 obj_layout_is_dir(dent->d_name)) {
+			rc = migrate_dir(path, depth+1);
+
+			/* remove directories the new layout doesn't use */
+			if ((rc == LWFS_OK) && (depth >= new_levels)) {
+				rmdir(path);
+			}
+		}
+	}
+	closedir(d);
+
+	return rc;
+}
+
+
+int main(int argc, char *argv[])
+{
+	int rc = LWFS_OK;
+	int c;
+	struct obj_layout layout;
+
+	while ((c = getopt_long(argc, argv, "r:l:vh", long_options, NULL)) != -1) {
+		switch (c) {
+			case 'r':
+				root = optarg;
+				break;
+			case 'l':
+				new_levels = atoi(optarg);
+				break;
+			case 'v':
+				verbose = TRUE;
+				break;
+			default:
+				usage(argv[0]);
+				return 1;
+		}
+	}
+
+	if ((root == NULL) || (new_levels < 0) ||
+	    (new_levels > OBJ_LAYOUT_MAX_LEVELS)) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	logger_init(LOG_WARN, "stderr");
+
+	/* a root without a layout file is flat (or empty) */
+	rc = obj_layout_detect(root, new_levels, &layout);
+	if (rc != LWFS_OK) {
+		fprintf(stderr, "could not get the layout of %s\n", root);
+		return 1;
+	}
+
+	if ((layout.levels == new_levels) && !layout.migrating) {
+		fprintf(stdout, "%s already uses %d directory levels\n", root, new_levels);
+		return 0;
+	}
+
+	/* keep the server from starting until we finish */
+	layout.levels = new_levels;
+	layout.migrating = TRUE;
+	rc = obj_layout_write(root, &layout);
+	if (rc != LWFS_OK) {
+		return 1;
+	}
+
+	rc = migrate_dir(root, 0);
+	if (rc != LWFS_OK) {
+		fprintf(stderr, "migration of %s stopped after %ld objects, "
+				"run %s again to finish\n", root, num_objs, argv[0]);
+		return 1;
+	}
+
+	layout.migrating = FALSE;
+	rc = obj_layout_write(root, &layout);
+	if (rc != LWFS_OK) {
+		return 1;
+	}
+
+	fprintf(stdout, "moved %ld of %ld objects in %s to %d directory levels\n",
+			num_moved, num_objs, root, new_levels);
+
+	return 0;
+}
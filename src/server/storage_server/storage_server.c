@@ -33,8 +33,13 @@
 #include "io_threads.h"
 #include "buffer_stack.h"
 #include "aio_obj.h"
+#ifdef HAVE_LIBAIO
+#include "kaio_obj.h"
+#endif
 #include "sysio_obj.h"
 #include "ebofs_obj.h"
+#include "cap_cache.h"
+#include "server/authr_server/cap_verifier.h"
 
 #include "client/authr_client/authr_client_sync.h"
 #include "support/trace/trace.h"
@@ -66,10 +71,15 @@ struct ss_counter {
     long rmattr;
     long stat;
     long trunc;
+    long compound;
+    long compound_ops;
 };
 
 static struct ss_counter ss_counter; 
 
+static int compound_class(
+		const ss_compound_args *args); 
+
 static const lwfs_svc_op _op_array[] = {
 	{
 		LWFS_OP_CREATE,
@@ -94,7 +104,8 @@ static const lwfs_svc_op _op_array[] = {
 		sizeof(ss_read_args), 
 		(xdrproc_t)&xdr_ss_read_args, 
 		sizeof(lwfs_size), 
-		(xdrproc_t)&xdr_lwfs_size 
+		(xdrproc_t)&xdr_lwfs_size,
+		LWFS_TP_CLASS_BULK
 	},
 	{
 		LWFS_OP_WRITE, 
@@ -102,7 +113,8 @@ static const lwfs_svc_op _op_array[] = {
 		sizeof(ss_write_args), 
 		(xdrproc_t)&xdr_ss_write_args, 
 		sizeof(void), 
-		(xdrproc_t)&xdr_void 
+		(xdrproc_t)&xdr_void,
+		LWFS_TP_CLASS_BULK
 	},
 	{
 		LWFS_OP_FSYNC, 
@@ -110,7 +122,8 @@ static const lwfs_svc_op _op_array[] = {
 		sizeof(ss_fsync_args), 
 		(xdrproc_t)&xdr_ss_fsync_args, 
 		sizeof(void), 
-		(xdrproc_t)&xdr_void 
+		(xdrproc_t)&xdr_void,
+		LWFS_TP_CLASS_BULK
 	},
 	{
 		LWFS_OP_LISTATTRS,
@@ -182,6 +195,33 @@ static const lwfs_svc_op _op_array[] = {
 		sizeof(ss_truncate_args),
 		(xdrproc_t)&xdr_ss_truncate_args,
 		sizeof(void),
+		(xdrproc_t)&xdr_void,
+		LWFS_TP_CLASS_BULK
+	},
+	{
+		LWFS_OP_COMPOUND,
+		(lwfs_rpc_proc)&ss_compound,
+		sizeof(ss_compound_args),
+		(xdrproc_t)&xdr_ss_compound_args,
+		sizeof(ss_compound_res),
+		(xdrproc_t)&xdr_ss_compound_res, 
+		LWFS_TP_CLASS_BULK,
+		(lwfs_svc_classify)&compound_class
+	},
+	{
+		LWFS_OP_REVOKE_CAPS,
+		(lwfs_rpc_proc)&ss_revoke_caps,
+		sizeof(lwfs_revoke_caps_args),
+		(xdrproc_t)&xdr_lwfs_revoke_caps_args,
+		sizeof(void),
+		(xdrproc_t)&xdr_void 
+	},
+	{
+		LWFS_OP_SET_CAP_KEY,
+		(lwfs_rpc_proc)&ss_set_cap_key,
+		sizeof(lwfs_set_cap_key_args),
+		(xdrproc_t)&xdr_lwfs_set_cap_key_args,
+		sizeof(void),
 		(xdrproc_t)&xdr_void 
 	},
 	{LWFS_OP_NULL}
@@ -202,6 +242,7 @@ static int ss_verify_cap(
     int rc = LWFS_OK; 
     lwfs_cid real_cid; 
     lwfs_attr cid_attr; 
+    unsigned long epoch; 
     
     memset(&real_cid, 0, sizeof(lwfs_cid));
     memset(&cid_attr, 0, sizeof(lwfs_attr));
@@ -248,8 +289,21 @@ static int ss_verify_cap(
 //	}
 //    }
 
+    /* the authr svc already verified caps in the cache */
+    if (cap_cache_lookup(cap) == LWFS_OK) {
+	log_debug(ss_debug_level, "found cap in cache");
+	goto cleanup; 
+    }
+
+    /* check the MAC with the key from the authr svc */
+    if (cap_verifier_check(cap) == LWFS_OK) {
+	log_debug(ss_debug_level, "verified cap locally");
+	goto cleanup; 
+    }
+
     /* Last step is to call verify the cap with the authr svc */
     log_debug(ss_debug_level, "verify caps with authorization svc");
+    epoch = cap_cache_epoch(); 
     rc = lwfs_verify_caps_sync(&_authr_svc, cap, 1); 
     if (rc != LWFS_OK) {
 	log_error(ss_debug_level, "could not call verify caps: %s",
@@ -257,6 +311,12 @@ static int ss_verify_cap(
 	goto cleanup; 
     }
 
+    /* fetch the key again if we missed a rotation */
+    cap_verifier_confirm(cap); 
+
+    /* remember the cap (unless it was revoked while we waited) */
+    cap_cache_insert(cap, epoch); 
+
 cleanup:
     if (cid_attr.value.lwfs_attr_data_val)
         free(cid_attr.value.lwfs_attr_data_val);
@@ -279,9 +339,18 @@ int storage_server_init(
 		const lwfs_bool db_clear,
 		const lwfs_bool db_recover,
 		const char *iolib_str,
+		const char *durability_str,
+		const int flush_interval,
+		const int max_dirty_mb,
+		const int dir_levels,
+		const lwfs_bool direct_io,
 		const char *root,
 		const int num_bufs,
 		const lwfs_size bufsize, 
+		const int num_io_threads, 
+		const int cap_cache_size,
+		const int cap_cache_ttl,
+		const lwfs_bool local_caps,
 		const lwfs_service *a_svc,
 		lwfs_service *svc)
 {
@@ -289,6 +358,8 @@ int storage_server_init(
 
 	int rc = LWFS_OK; 
 	int i; 
+	int nbufs; 
+	enum ss_durability durability; 
 
 
 	if (initialized) {
@@ -314,6 +385,37 @@ int storage_server_init(
 	trace_reset_count(TRACE_SS_TRUNC, 0, "init trunc count");
 
 
+	/* select when data reaches the disk (sysio and aio) */
+	if (strcmp(durability_str, "sync") == 0) {
+		durability = SS_DURABILITY_SYNC; 
+	}
+	else if (strcmp(durability_str, "dsync") == 0) {
+		durability = SS_DURABILITY_DSYNC; 
+	}
+	else if (strcmp(durability_str, "writeback") == 0) {
+		durability = SS_DURABILITY_WRITEBACK; 
+	}
+	else if (strcmp(durability_str, "periodic") == 0) {
+		durability = SS_DURABILITY_PERIODIC; 
+	}
+	else {
+		log_error(ss_debug_level, "durability \"%s\" not supported", durability_str);
+		return LWFS_ERR_NOTSUPP; 
+	}
+
+	rc = sysio_obj_set_durability(durability, flush_interval, 
+			(lwfs_size)max_dirty_mb*1024*1024); 
+	if (rc != LWFS_OK) {
+		log_error(ss_debug_level, "could not set durability");
+		return rc; 
+	}
+
+	rc = sysio_obj_set_layout(dir_levels); 
+	if (rc != LWFS_OK) {
+		log_error(ss_debug_level, "could not set the directory layout");
+		return rc; 
+	}
+
 	/* configure the sysio library */
 	if (strcmp(iolib_str, "sysio") == 0) {
 
@@ -343,6 +445,30 @@ int storage_server_init(
 		}
 	}
 
+	/* configure the kernel aio library */
+	else if (strcmp(iolib_str, "kaio") == 0) {
+		_iolib = SS_KAIO;
+
+#ifdef HAVE_LIBAIO
+		rc = kaio_obj_init(root, direct_io, &_obj_funcs); 
+		if (rc != LWFS_OK) {
+			log_error(ss_debug_level, "could not initialize kaio objects");
+			return rc; 
+		}
+
+		/* kaio uses the sysio attributes */
+		rc = ss_db_init(db_path, db_clear, db_recover);
+		if (rc != LWFS_OK) {
+			log_error(ss_debug_level, "unable to initialize the ss attr db: %s",
+				lwfs_err_str(rc));
+			return rc;
+		}
+#else
+		log_error(ss_debug_level, "kernel aio (libaio) is not available");
+		return LWFS_ERR_NOTSUPP;
+#endif
+	}
+
 	/* configure the sim library */
 	else if (strcmp(iolib_str, "sim") == 0) {
 		_iolib = SS_SIMIO;
@@ -377,8 +503,19 @@ int storage_server_init(
 		return LWFS_ERR_NOTSUPP; 
 	}
 
+	/* the I/O threads need at least one buffer */
+	nbufs = num_bufs; 
+	if (nbufs < 1) {
+		log_warn(ss_debug_level, "need at least one I/O buffer (num_bufs=%d), using 1",
+				num_bufs);
+		nbufs = 1; 
+	}
+
+	/* store bufsize in a global variable */
+	_bufsize = bufsize; 
+
 	log_debug(ss_debug_level, "allocating %d buffers for the I/O threads", 
-			num_bufs);
+			nbufs);
 
 	/* initialize the buffer stack */
 	rc = buffer_stack_init(&_buffer_stack); 
@@ -388,7 +525,7 @@ int storage_server_init(
 	}
 
 	/* fill the buffer stack */
-	for (i=0; i<num_bufs; i++) {
+	for (i=0; i<nbufs; i++) {
 
 		/* allocate the buffer structure */
 		struct io_buffer *iobuf = (struct io_buffer *)
@@ -399,16 +536,16 @@ int storage_server_init(
 			goto abort; 
 		}
 
-		/* allocate the buffer */
-		iobuf->buf = malloc(bufsize);
+		/* allocate the buffer (aligned, so kaio can use direct I/O) */
+		if (posix_memalign(&iobuf->buf, SS_BUF_ALIGN, bufsize) != 0) {
+			iobuf->buf = NULL; 
+		}
 		if (!iobuf->buf) {
 			log_error(ss_debug_level, "unable to allocate io buffer");
 			rc = LWFS_ERR_NOSPACE;
 			goto abort; 
 		}
 
-		/* store bufsize in a global variable */
-		_bufsize = bufsize; 
 		iobuf->len = bufsize; 
 
 		/* push onto the stack */
@@ -419,6 +556,14 @@ int storage_server_init(
 		}
 	}
 
+	/* start the I/O threads */
+	rc = start_io_threads(&_obj_funcs, &_buffer_stack, 
+			(num_io_threads > 0)? num_io_threads : 1, _bufsize); 
+	if (rc != LWFS_OK) {
+		log_error(ss_debug_level, "could not start IO threads");
+		return rc; 
+	}
+
 	/* initialize the service to receive requests */
 	rc = lwfs_service_init(LWFS_SS_MATCH_BITS, LWFS_SHORT_REQUEST_SIZE, svc); 
 	if (rc != LWFS_OK) {
@@ -426,8 +571,9 @@ int storage_server_init(
 		return rc; 
 	}
 
-	/* copy the 15 storage server ops into our list of supported operations */
-	rc = lwfs_service_add_ops(svc, lwfs_ss_op_array(), 15);
+	/* copy the storage server ops into our list of supported operations */
+	rc = lwfs_service_add_ops(svc, lwfs_ss_op_array(), 
+		lwfs_svc_op_count(lwfs_ss_op_array()));
 	if (rc != LWFS_OK) {
 		log_fatal(ss_debug_level, "Could not add storage server ops");
 		return rc; 
@@ -437,6 +583,36 @@ int storage_server_init(
 	memcpy(&_storage_svc, svc, sizeof(lwfs_service)); 
 	memcpy(&_authr_svc, a_svc, sizeof(lwfs_service)); 
 
+	/* initialize the cache of verified caps */
+	rc = cap_cache_init(cap_cache_size, cap_cache_ttl); 
+	if (rc != LWFS_OK) {
+		log_error(ss_debug_level, "could not initialize cap cache");
+		return rc; 
+	}
+
+	/* The authr svc has to tell us when caps are revoked. If we 
+	 * can't register, caching caps is not safe. */
+	if (cap_cache_enabled()) {
+		rc = lwfs_register_cap_cache_sync(&_authr_svc, svc); 
+		if (rc != LWFS_OK) {
+			log_warn(ss_debug_level, "could not register cap cache, "
+					"disabling cache: %s", lwfs_err_str(rc));
+			cap_cache_disable(); 
+			rc = LWFS_OK; 
+		}
+	}
+
+	/* Get the key to verify caps without the authr svc. If the 
+	 * authr svc does not share its key, we call it for every cap
+	 * that is not in the cache. */
+	if (local_caps) {
+		rc = cap_verifier_init(&_authr_svc, svc); 
+		if (rc != LWFS_OK) {
+			log_warn(ss_debug_level, "could not get cap key, "
+					"verifying caps with authr svc: %s", lwfs_err_str(rc));
+			rc = LWFS_OK; 
+		}
+	}
 	
 
 	return rc; 
@@ -480,6 +656,16 @@ int storage_server_fini(
 	    }
 	    break;
 
+#ifdef HAVE_LIBAIO
+	case SS_KAIO:
+	    rc = kaio_obj_fini(); 
+	    if (rc != LWFS_OK) {
+		log_error(ss_debug_level, "could not finialize kaio objects");
+		return rc; 
+	    }
+	    break;
+#endif
+
 	case SS_SIMIO:
 	    /*
 	       rc = sim_obj_fini(); 
@@ -498,14 +684,12 @@ int storage_server_fini(
 	    return LWFS_ERR_NOTSUPP; 
     }
 
-    /* stop the io_threads */
-    /*
-       rc = stop_io_threads();
-       if (rc != LWFS_OK){
-       log_error(ss_debug_level, "could not stop IO threads");
-       return rc; 
-       }
-     */
+    /* stop the io_threads (they return buffers to the stack) */
+    rc = stop_io_threads();
+    if (rc != LWFS_OK){
+	log_error(ss_debug_level, "could not stop IO threads");
+	return rc; 
+    }
 
     /* clean up the buffer stack */
     rc = buffer_stack_destroy(&_buffer_stack);
@@ -528,8 +712,42 @@ int storage_server_fini(
     fprintf(logger_get_file(), "\trmattr = %ld\n", ss_counter.rmattrs+ss_counter.rmattr);
     fprintf(logger_get_file(), "\tstat = %ld\n", ss_counter.stat);
     fprintf(logger_get_file(), "\ttrunc = %ld\n", ss_counter.trunc);
+    fprintf(logger_get_file(), "\tcompound = %ld (%ld ops)\n", 
+	    ss_counter.compound, ss_counter.compound_ops);
+    fprint_cap_cache_stats(logger_get_file()); 
+    if (cap_verifier_enabled()) {
+	fprint_cap_verifier_stats(logger_get_file()); 
+    }
+#ifdef HAVE_LIBAIO
+    if (_iolib == SS_KAIO) {
+	fprint_kaio_stats(logger_get_file()); 
+    }
+#endif
+    if ((_iolib == SS_SYSIO) || (_iolib == SS_AIO) || (_iolib == SS_KAIO)) {
+	struct sysio_flush_stats fs; 
+	struct sysio_fd_stats fds; 
+
+	sysio_obj_get_fd_stats(&fds); 
+	fprintf(logger_get_file(), "  Open files:\n");
+	fprintf(logger_get_file(), "\thits = %ld\n", fds.hits);
+	fprintf(logger_get_file(), "\tmisses = %ld\n", fds.misses);
+	fprintf(logger_get_file(), "\tevictions = %ld\n", fds.evictions);
+	fprintf(logger_get_file(), "\toverflows = %ld\n", fds.overflows);
+	fprintf(logger_get_file(), "\tmax_open = %ld\n", fds.max_open);
+
+	sysio_obj_get_flush_stats(&fs); 
+	fprintf(logger_get_file(), "  Flushes:\n");
+	fprintf(logger_get_file(), "\tfsync_requests = %ld\n", fs.fsync_requests);
+	fprintf(logger_get_file(), "\tfsync_flushes = %ld\n", fs.fsync_flushes);
+	fprintf(logger_get_file(), "\tperiodic_flushes = %ld\n", fs.periodic_flushes);
+	fprintf(logger_get_file(), "\tfiles_flushed = %ld\n", fs.files_flushed);
+	fprintf(logger_get_file(), "\tevict_flushes = %ld\n", fs.evict_flushes);
+    }
     fprintf(logger_get_file(), "-----------------------------\n");
 
+    cap_cache_fini(); 
+    cap_verifier_fini(); 
+
     if (log_file){
 	fclose(log_file);
     }
@@ -655,6 +873,70 @@ cleanup:
     return rc;
 } /* ss_remove_object() */
 
+/**
+ * @brief Send a read request for the next chunk to an I/O thread.
+ *
+ * If \em wait is false and no buffer is free, \em result is NULL.
+ */
+static int submit_read(
+	struct io_pipe *pipe,
+	const lwfs_obj *obj,
+	const lwfs_size offset,
+	const lwfs_size len,
+	const lwfs_bool wait,
+	struct io_req **result)
+{
+    int rc = LWFS_OK;
+    struct io_buffer *iobuf = NULL; 
+    struct io_req *ioreq = NULL; 
+
+    *result = NULL; 
+
+    if (wait) {
+	/* wait for another thread to release a buffer */
+	while ((iobuf = buffer_stack_pop(&_buffer_stack)) == NULL) {
+	    log_debug(ss_debug_level, "waiting for an IO buffer");
+	}
+    }
+    else {
+	iobuf = buffer_stack_trypop(&_buffer_stack); 
+	if (iobuf == NULL) {
+	    return rc; 
+	}
+    }
+
+    ioreq = (struct io_req *)malloc(sizeof(struct io_req)); 
+    if (ioreq == NULL) {
+	log_error(ss_debug_level, "could not allocate io request");
+	buffer_stack_push(&_buffer_stack, iobuf); 
+	return LWFS_ERR_NOSPACE; 
+    }
+
+    memset(ioreq, 0, sizeof(struct io_req)); 
+    ioreq->pipe = pipe; 
+    ioreq->iobuf = iobuf; 
+    ioreq->obj = obj; 
+    ioreq->offset = offset; 
+    ioreq->len = (len > (lwfs_size)_bufsize)? _bufsize : len; 
+
+    /* errors are reported to io_req_wait */
+    reader_add_req(ioreq); 
+
+    *result = ioreq; 
+    return rc; 
+}
+
+/**
+ * @brief Wait for a read request and release its buffer.
+ */
+static void release_read(
+	struct io_req *ioreq)
+{
+    io_req_wait(ioreq); 
+    buffer_stack_push(&_buffer_stack, ioreq->iobuf); 
+    free(ioreq); 
+}
+
 int ss_read(
 	const lwfs_remote_pid *caller, 
 	const ss_read_args *args, 
@@ -662,8 +944,10 @@ int ss_read(
 	lwfs_size *res)
 {
     int rc = LWFS_OK;
-    void *buf = NULL; 
-    uint32_t count; 
+    lwfs_size count = 0; 
+    struct io_pipe pipe; 
+    struct io_req *cur = NULL; 
+    struct io_req *next = NULL; 
 
     /* extract the arguments */
     //const lwfs_txn *txn_id = args->txn_id; 
@@ -678,6 +962,8 @@ int ss_read(
 
     trace_start_interval(interval_id, thread_id); 
 
+    io_pipe_init(&pipe); 
+    *res = 0; 
 
     log_debug(ss_debug_level, "entered ss_read");
 
@@ -696,34 +982,63 @@ int ss_read(
 	goto cleanup; 
     }
 
-    /* allocate space for data */
-    if (len){
-	buf = malloc(len);
-	if (buf == NULL) {
-	    rc = LWFS_ERR_NOSPACE;
-	    log_warn(ss_debug_level, 
-		    "could not malloc a read buffer (len==%d)"
-		    " Returning %s to client", len,
-		    lwfs_err_str(rc));
+    /* Read the data one buffer at a time.  An I/O thread 
+     * reads chunk N+1 while we put chunk N on the client.  */
+    if (len > 0) {
+	rc = submit_read(&pipe, src_obj, src_offset, len, TRUE, &cur); 
+	if (rc != LWFS_OK) {
 	    goto cleanup; 
 	}
     }
 
-    /* read the data */
-    count = _obj_funcs.read(src_obj, src_offset, 
-	    buf, args->len);
-    if (count == -1) {
-	rc = LWFS_ERR_STORAGE;
-	*res = 0; 
-	goto cleanup; 
-    }
+    while (cur != NULL) {
+	lwfs_rma chunk_addr; 
+	lwfs_bool eof; 
 
-    /* send the data to the client along the special data path */
-    if (count > 0){
-	rc = lwfs_put_data(buf, count, data_addr); 
+	rc = io_req_wait(cur); 
 	if (rc != LWFS_OK) {
-	    log_error(ss_debug_level, "could not \"put\" data on client: %s",
+	    log_error(ss_debug_level, "unable to read data: %s",
 		    lwfs_err_str(rc));
+	    goto cleanup; 
+	}
+
+	/* a short read means there is nothing left to read */
+	eof = (cur->result < (lwfs_ssize)cur->len); 
+	count += cur->result; 
+
+	/* prefetch the next chunk (skip it if no buffer is free) */
+	if (!eof && (count < len)) {
+	    rc = submit_read(&pipe, src_obj, src_offset + count, 
+		    len - count, FALSE, &next); 
+	    if (rc != LWFS_OK) {
+		goto cleanup; 
+	    }
+	}
+
+	/* send the data to the client along the special data path */
+	if (cur->result > 0) {
+	    memcpy(&chunk_addr, data_addr, sizeof(lwfs_rma)); 
+	    chunk_addr.offset += cur->offset - src_offset; 
+
+	    rc = lwfs_put_data(cur->iobuf->buf, cur->result, &chunk_addr); 
+	    if (rc != LWFS_OK) {
+		log_error(ss_debug_level, "could not \"put\" data on client: %s",
+			lwfs_err_str(rc));
+		goto cleanup; 
+	    }
+	}
+
+	release_read(cur); 
+	cur = next; 
+	next = NULL; 
+
+	/* no buffer was free for the prefetch */
+	if ((cur == NULL) && !eof && (count < len)) {
+	    rc = submit_read(&pipe, src_obj, src_offset + count, 
+		    len - count, TRUE, &cur); 
+	    if (rc != LWFS_OK) {
+		goto cleanup; 
+	    }
 	}
     }
 
@@ -732,9 +1047,13 @@ int ss_read(
 cleanup:
 //malloc_report();
 
+    /* return the buffers of unfinished requests */
+    if (cur != NULL) release_read(cur); 
+    if (next != NULL) release_read(next); 
+    io_pipe_wait(&pipe); 
+
     trace_end_interval(interval_id, TRACE_SS_READ, thread_id, "read");
 
-    if (buf != NULL) free(buf); 
     return rc;
 
 } /* ss_read() */
@@ -748,7 +1067,9 @@ int ss_write(
 		void *res)
 {
 	int rc = LWFS_OK;
-	ssize_t bytes_written = 0; 
+	int rc2 = LWFS_OK;
+	lwfs_size done = 0; 
+	struct io_pipe pipe; 
 
 	/* extract the arguments */
 	//const lwfs_txn *txn_id = args->txn_id; 
@@ -757,14 +1078,6 @@ int ss_write(
 	const lwfs_size len = args->len; 
 	const lwfs_cap *cap = args->cap;
 
-	/* allocate the buffer 
-	 * TODO: Where should this buffer be freed? 
-	 * Right now it is in the write func. This 
-	 * is necessary in case we are using threaded
-	 * I/O operations. 
-	 */
-	void *buf = malloc(len); 
-
 	ss_counter.write++;
 	int interval_id = ss_counter.write; 
 	int thread_id = lwfs_thread_pool_getrank(); 
@@ -787,32 +1100,86 @@ int ss_write(
 		goto cleanup;
 	}
 
-	/* Get the data from the client */
+	/* Fetch the data one buffer at a time.  The I/O threads 
+	 * write chunk N (and earlier ones) while we fetch chunk N+1 
+	 * from the client.  */
+	io_pipe_init(&pipe); 
+
 	log_debug(ss_debug_level, "thread %d: start transferring data\n", 
 			lwfs_thread_pool_getrank());
-	rc = lwfs_get_data(buf, len, data_addr); 
-	if (rc != LWFS_OK) {
-		log_error(ss_debug_level, "unable to fetch data: %s",
-				lwfs_err_str(rc));
-		goto cleanup;
+
+	while ((done < len) && (io_pipe_status(&pipe) == LWFS_OK)) {
+		struct io_buffer *iobuf = NULL; 
+		struct io_req *ioreq = NULL; 
+		lwfs_rma chunk_addr; 
+		lwfs_size chunk = len - done; 
+
+		if (chunk > (lwfs_size)_bufsize) {
+			chunk = _bufsize; 
+		}
+
+		/* wait for an I/O thread to release a buffer */
+		while ((iobuf = buffer_stack_pop(&_buffer_stack)) == NULL) {
+			log_debug(ss_debug_level, "waiting for an IO buffer");
+		}
+
+		/* fetch the next chunk from the client */
+		memcpy(&chunk_addr, data_addr, sizeof(lwfs_rma)); 
+		chunk_addr.offset += done; 
+
+		rc = lwfs_get_data(iobuf->buf, chunk, &chunk_addr); 
+		if (rc != LWFS_OK) {
+			log_error(ss_debug_level, "unable to fetch data: %s",
+					lwfs_err_str(rc));
+			buffer_stack_push(&_buffer_stack, iobuf); 
+			break; 
+		}
+
+		ioreq = (struct io_req *)malloc(sizeof(struct io_req)); 
+		if (ioreq == NULL) {
+			log_error(ss_debug_level, "could not allocate io request");
+			rc = LWFS_ERR_NOSPACE; 
+			buffer_stack_push(&_buffer_stack, iobuf); 
+			break; 
+		}
+
+		memset(ioreq, 0, sizeof(struct io_req)); 
+		ioreq->pipe = &pipe; 
+		ioreq->iobuf = iobuf; 
+		ioreq->obj = dest_obj; 
+		ioreq->offset = dest_offset + done; 
+		ioreq->len = chunk; 
+
+		/* the I/O thread pushes the buffer back on the stack */
+		rc = writer_add_req(ioreq); 
+		if (rc != LWFS_OK) {
+			log_error(ss_debug_level, "could not submit write request: %s",
+					lwfs_err_str(rc));
+			buffer_stack_push(&_buffer_stack, iobuf); 
+			free(ioreq); 
+			break; 
+		}
+
+		done += chunk; 
 	}
-	log_debug(ss_debug_level, "thread %d: finished transferring data", 
-				lwfs_thread_pool_getrank() );
 
-	bytes_written = _obj_funcs.write(dest_obj, dest_offset, buf, len);
-	if (bytes_written != len) {
-		rc = LWFS_ERR_STORAGE;
-		goto cleanup;
+	/* wait for the I/O threads to finish our chunks */
+	rc2 = io_pipe_wait(&pipe); 
+	if (rc2 != LWFS_OK) {
+		log_error(ss_debug_level, "unable to write data: %s",
+				lwfs_err_str(rc2));
+		if (rc == LWFS_OK) {
+			rc = rc2; 
+		}
 	}
 
+	log_debug(ss_debug_level, "thread %d: finished transferring data", 
+				lwfs_thread_pool_getrank() );
+
 cleanup: 
 
 	trace_end_interval(interval_id, TRACE_SS_WRITE, thread_id, "write");
 
-	/* check for an error before we free the buffer */
-	if (rc != LWFS_OK) {
-	    if (buf) free(buf);
-	}
 	return rc;
 
 }/* ss_write() */
@@ -1369,3 +1736,332 @@ cleanup:
 	return rc;
 } /* ss_get_attr() */
 
+
+
+/**
+ * @brief Write the data of a compound request.
+ *
+ * The data goes through a buffer from the buffer stack, 
+ * since the object library may need aligned buffers. 
+ */
+static int compound_write(
+		const lwfs_obj *obj, 
+		const ss_compound_write *write)
+{
+	int rc = LWFS_OK;
+	struct io_buffer *iobuf = NULL; 
+	lwfs_size len = write->data.data_len; 
+	lwfs_size done = 0; 
+	lwfs_size chunk; 
+	lwfs_ssize nbytes; 
+
+	/* wait for another thread to release a buffer */
+	while ((iobuf = buffer_stack_pop(&_buffer_stack)) == NULL) {
+		log_debug(ss_debug_level, "waiting for an IO buffer");
+	}
+
+	while (done < len) {
+		chunk = len - done; 
+		if (chunk > (lwfs_size)_bufsize) {
+			chunk = _bufsize; 
+		}
+
+		memcpy(iobuf->buf, write->data.data_val + done, chunk); 
+
+		nbytes = _obj_funcs.write(obj, write->offset + done, iobuf->buf, chunk); 
+		if (nbytes != (lwfs_ssize)chunk) {
+			log_error(ss_debug_level, "unable to write buffer");
+			rc = LWFS_ERR_STORAGE; 
+			break; 
+		}
+
+		done += chunk; 
+	}
+
+	buffer_stack_push(&_buffer_stack, iobuf); 
+
+	return rc; 
+}
+
+/**
+ * @brief Find the thread pool class of a compound request.
+ *
+ * Compounds that move or flush data (write, truncate, fsync) 
+ * are bulk requests, like \ref ss_write and friends.  The rest 
+ * are metadata.  Compounds with args too large for the request 
+ * header carry write data, so they stay in the bulk class. 
+ */
+static int compound_class(
+		const ss_compound_args *args)
+{
+	u_int i; 
+
+	for (i=0; i<args->ops.ops_len; i++) {
+		switch (args->ops.ops_val[i].args.op) {
+			case SS_COMPOUND_WRITE:
+			case SS_COMPOUND_TRUNCATE:
+			case SS_COMPOUND_FSYNC:
+				return LWFS_TP_CLASS_BULK; 
+			default:
+				break; 
+		}
+	}
+
+	return LWFS_TP_CLASS_METADATA; 
+}
+
+/**
+ * @brief Run one operation of a compound request.
+ *
+ * The caller already checked the cap. 
+ */
+static int run_compound_op(
+		const ss_compound_op *op, 
+		const lwfs_cid cid, 
+		ss_compound_op_res *res)
+{
+	int rc = LWFS_OK;
+	const lwfs_obj *obj = &op->obj; 
+	const ss_compound_op_args *args = &op->args; 
+
+	/* everything but create needs an existing object */
+	if ((args->op != SS_COMPOUND_CREATE) && !_obj_funcs.exists(obj)) {
+		return LWFS_ERR_NO_OBJ; 
+	}
+
+	switch (args->op) {
+
+		case SS_COMPOUND_CREATE:
+			rc = _obj_funcs.create(obj); 
+			if (rc != LWFS_OK) {
+				log_error(ss_debug_level, "unable to create object: %s",
+						lwfs_err_str(rc));
+				break; 
+			}
+
+			/* create container ID attribute for the object */
+			rc = _obj_funcs.setattr(obj, "_lwfs_cid", &cid, sizeof(lwfs_cid));  
+			if (rc != LWFS_OK) {
+				log_error(ss_debug_level, "could not set attribute");
+				rc = LWFS_ERR_STORAGE;
+			}
+			break;
+
+		case SS_COMPOUND_WRITE:
+			rc = compound_write(obj, &args->ss_compound_op_args_u.write); 
+			break;
+
+		case SS_COMPOUND_SETATTR:
+			if (_obj_funcs.setattr == NULL) {
+				rc = LWFS_ERR_NOTSUPP; 
+				break; 
+			}
+			rc = _obj_funcs.setattr(obj, 
+					args->ss_compound_op_args_u.attr.name, 
+					args->ss_compound_op_args_u.attr.value.lwfs_attr_data_val, 
+					args->ss_compound_op_args_u.attr.value.lwfs_attr_data_len);  
+			if (rc != LWFS_OK) {
+				log_error(ss_debug_level, "could not set attribute");
+				rc = LWFS_ERR_STORAGE;
+			}
+			break;
+
+		case SS_COMPOUND_TRUNCATE:
+			rc = _obj_funcs.trunc(obj, args->ss_compound_op_args_u.size);
+			if (rc != LWFS_OK) {
+				log_error(ss_debug_level, "could not truncate object");
+				rc = LWFS_ERR_STORAGE;
+			}
+			break;
+
+		case SS_COMPOUND_FSYNC:
+			rc = _obj_funcs.fsync(obj); 
+			if (rc != LWFS_OK) {
+				log_error(ss_debug_level, "unable to fsync");
+			}
+			break;
+
+		case SS_COMPOUND_STAT:
+			if (_obj_funcs.stat == NULL) {
+				rc = LWFS_ERR_NOTSUPP; 
+				break; 
+			}
+			rc = _obj_funcs.stat(obj, &res->ss_compound_op_res_u.stat);  
+			if (rc != LWFS_OK) {
+				log_error(ss_debug_level, "could not stat object");
+				rc = LWFS_ERR_STORAGE;
+			}
+			break;
+
+		default:
+			rc = LWFS_ERR_NOTSUPP; 
+			break;
+	}
+
+	return rc; 
+}
+
+/**
+ * @brief Run a list of operations in one request. 
+ *
+ * The operations run in order, after a single check of the cap 
+ * (which has to allow everything the list does).  We stop at 
+ * the first operation that fails; the client finds its error 
+ * in the last result.  A failed operation does not fail the 
+ * request, so the client gets the results that came before it. 
+ */
+int ss_compound(
+		const lwfs_remote_pid *caller, 
+		const ss_compound_args *args, 
+		const lwfs_rma *data_addr, 
+		ss_compound_res *res)
+{
+	int rc = LWFS_OK;
+	u_int i; 
+	lwfs_container_op container_op = 0; 
+	const ss_compound_op *op; 
+	ss_compound_result *result; 
+
+	/* extract the arguments */
+	//const lwfs_txn *txn_id = args->txn_id; 
+	const u_int count = args->ops.ops_len; 
+	const lwfs_cap *cap = args->cap;
+
+	ss_counter.compound++;
+	int interval_id = ss_counter.compound; 
+	int thread_id = lwfs_thread_pool_getrank(); 
+
+	trace_start_interval(interval_id, thread_id); 
+
+	log_debug(ss_debug_level, "entered ss_compound (%u ops)", count);
+
+	memset(res, 0, sizeof(ss_compound_res)); 
+
+	/* find out what the cap has to allow */
+	for (i=0; i<count; i++) {
+		op = &args->ops.ops_val[i]; 
+
+		switch (op->args.op) {
+			case SS_COMPOUND_STAT:
+				container_op |= LWFS_CONTAINER_READ; 
+				break; 
+			case SS_COMPOUND_CREATE:
+			case SS_COMPOUND_WRITE:
+			case SS_COMPOUND_SETATTR:
+			case SS_COMPOUND_TRUNCATE:
+			case SS_COMPOUND_FSYNC:
+				container_op |= LWFS_CONTAINER_WRITE; 
+				break; 
+			default:
+				log_error(ss_debug_level, "invalid operation %d in compound request",
+						(int)op->args.op);
+				rc = LWFS_ERR_NOTSUPP; 
+				goto cleanup; 
+		}
+
+		/* one cap covers one container */
+		if (op->obj.cid != cap->data.cid) {
+			log_error(ss_debug_level, "object %u is not in the container of the cap", i);
+			rc = LWFS_ERR_ACCESS; 
+			goto cleanup; 
+		}
+	}
+
+	if (count == 0) {
+		goto cleanup; 
+	}
+
+	/* verify the capability */
+	rc = ss_verify_cap(cap, NULL, container_op); 
+	if (rc != LWFS_OK) {
+		log_error(ss_debug_level, "could not verify capability : %s",
+				lwfs_err_str(rc));
+		goto cleanup;
+	}
+
+	res->results.results_val = (ss_compound_result *)
+		calloc(count, sizeof(ss_compound_result)); 
+	if (res->results.results_val == NULL) {
+		log_error(ss_debug_level, "out of memory");
+		rc = LWFS_ERR_NOSPACE; 
+		goto cleanup; 
+	}
+
+	for (i=0; i<count; i++) {
+		op = &args->ops.ops_val[i]; 
+		result = &res->results.results_val[i]; 
+
+		res->results.results_len++; 
+		ss_counter.compound_ops++;
+
+		result->res.op = op->args.op; 
+		result->rc = run_compound_op(op, cap->data.cid, &result->res); 
+		if (result->rc != LWFS_OK) {
+			log_debug(ss_debug_level, "compound op %u failed: %s",
+					i, lwfs_err_str(result->rc));
+			break; 
+		}
+	}
+
+cleanup:
+	trace_end_interval(interval_id, TRACE_SS_COMPOUND, thread_id, "compound");
+	return rc;
+} /* ss_compound() */
+
+
+/**
+ * @brief Revoke cached caps. 
+ *
+ * The authorization server calls this function when the ACLs 
+ * of a container change.  We drop every cached cap for the 
+ * container that enables one of the revoked operations, so the 
+ * next request with such a cap goes back to the authr server. 
+ *
+ * This function needs no cap, but we only take revocations 
+ * from the authr server. 
+ */
+int ss_revoke_caps(
+		const lwfs_remote_pid *caller, 
+		const lwfs_revoke_caps_args *args, 
+		const lwfs_rma *data_addr, 
+		void *res)
+{
+	int rc = LWFS_OK; 
+
+	rc = cap_verifier_check_sender(&_authr_svc, caller); 
+	if (rc != LWFS_OK) {
+		return rc; 
+	}
+
+	log_debug(ss_debug_level, "revoking caps for cid=%llu, container_op=%d",
+			(unsigned long long)args->cid, (int)args->container_op);
+
+	cap_verifier_revoke(args->cid, args->container_op, args->generation); 
+
+	return cap_cache_invalidate(args->cid, args->container_op); 
+}
+
+/**
+ * @brief Replace the key used to verify caps. 
+ *
+ * The authorization server calls this function after it 
+ * rotates its key.  Keys from anyone but the authr server 
+ * are rejected. 
+ */
+int ss_set_cap_key(
+		const lwfs_remote_pid *caller, 
+		const lwfs_set_cap_key_args *args, 
+		const lwfs_rma *data_addr, 
+		void *res)
+{
+	int rc = LWFS_OK; 
+
+	rc = cap_verifier_check_sender(&_authr_svc, caller); 
+	if (rc != LWFS_OK) {
+		return rc; 
+	}
+
+	log_debug(ss_debug_level, "received new cap key");
+
+	return cap_verifier_set_key(args->info); 
+}
@@ -29,6 +29,9 @@ extern "C" {
 #define DEFAULT_SS_NUM_BUFS 10
 #define DEFAULT_SS_BUFSIZE 1048576
 
+/* alignment of the I/O buffers (direct I/O needs at least 4096) */
+#define SS_BUF_ALIGN 4096
+
 	/**
 	 * @brief Enumerate the differnt types of supported 
 	 * backend libraries. 
@@ -37,7 +40,26 @@ extern "C" {
 		SS_SYSIO = 0,
 		SS_AIO = 1,
 		SS_SIMIO = 2,
-		SS_EBOFS = 3
+		SS_EBOFS = 3,
+		SS_KAIO = 4
+	};
+
+	/**
+	 * @brief When the storage server writes data to disk. 
+	 */
+	enum ss_durability {
+		/** @brief Every write is synchronous (O_SYNC). */
+		SS_DURABILITY_SYNC = 0,
+
+		/** @brief Every write flushes data, not metadata (O_DSYNC). */
+		SS_DURABILITY_DSYNC = 1,
+
+		/** @brief Data reaches the disk at fsync requests. */
+		SS_DURABILITY_WRITEBACK = 2,
+
+		/** @brief Like WRITEBACK, plus a background flush thread 
+		 * that bounds the amount of dirty data. */
+		SS_DURABILITY_PERIODIC = 3
 	};
 
 
@@ -136,9 +158,18 @@ extern "C" {
 			const lwfs_bool db_clear,
 			const lwfs_bool db_recover,
 			const char *iolib,
+			const char *durability,
+			const int flush_interval,
+			const int max_dirty_mb,
+			const int dir_levels,
+			const lwfs_bool direct_io,
 			const char *root,
 			const int num_bufs,
 			const lwfs_size bufsize, 
+			const int num_io_threads, 
+			const int cap_cache_size,
+			const int cap_cache_ttl,
+			const lwfs_bool local_caps,
 			const lwfs_service *a_svc,
 			lwfs_service *svc); 
 
@@ -231,6 +262,24 @@ extern "C" {
             const lwfs_rma *data_addr,
             void *res);
 
+    extern int ss_compound(
+            const lwfs_remote_pid *caller, 
+            const ss_compound_args *args,
+            const lwfs_rma *data_addr,
+            ss_compound_res *res);
+
+    extern int ss_revoke_caps(
+            const lwfs_remote_pid *caller, 
+            const lwfs_revoke_caps_args *args,
+            const lwfs_rma *data_addr,
+            void *res);
+
+    extern int ss_set_cap_key(
+            const lwfs_remote_pid *caller, 
+            const lwfs_set_cap_key_args *args,
+            const lwfs_rma *data_addr,
+            void *res);
+
 #else /* K&R C */
 
 #endif
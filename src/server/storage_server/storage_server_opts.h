@@ -24,6 +24,15 @@ void print_storage_server_opts(
 			(unsigned long long)args_info->ss_pid_arg);
 	fprintf(fp, "%s \tss-root = %s\n", prefix, args_info->ss_root_arg);
 	fprintf(fp, "%s \tss-iolib = %s\n", prefix, args_info->ss_iolib_arg);
+	fprintf(fp, "%s \tss-io-threads = %d\n", prefix, args_info->ss_io_threads_arg);
+	fprintf(fp, "%s \tss-durability = %s\n", prefix, args_info->ss_durability_arg);
+	fprintf(fp, "%s \tss-flush-interval = %d\n", prefix, args_info->ss_flush_interval_arg);
+	fprintf(fp, "%s \tss-max-dirty = %d\n", prefix, args_info->ss_max_dirty_arg);
+	fprintf(fp, "%s \tss-dir-levels = %d\n", prefix, args_info->ss_dir_levels_arg);
+	fprintf(fp, "%s \tss-direct-io = %s\n", prefix, (args_info->ss_direct_io_flag)? "true" : "false");
+	fprintf(fp, "%s \tss-cap-cache-size = %d\n", prefix, args_info->ss_cap_cache_size_arg);
+	fprintf(fp, "%s \tss-cap-cache-ttl = %d\n", prefix, args_info->ss_cap_cache_ttl_arg);
+	fprintf(fp, "%s \tss-local-caps = %s\n", prefix, (args_info->ss_local_caps_flag)?"true":"false");
 }
 
 #endif
@@ -3,8 +3,12 @@
  * 
  *   This is the object api.  There are two basic structures to
  *   maintain object status and info: all ojbects are maintained in a
- *   hash table while objects with open files are also maintained in a
- *   doubly linked list. 
+ *   hash table (split into shards with separate locks) while objects 
+ *   with open files are also maintained in a doubly linked list. 
+ *
+ *   At a clean shutdown we save the oids to ROOT/.oid_index, so the
+ *   next start doesn't have to scan the root directory.  Remove that
+ *   file to force a scan (e.g., after changing objects by hand).
  *
  *   This object api is used by the registered storage server
  *   functions.  See storage_srvr.c.
@@ -13,6 +17,11 @@
  *   @author Todd Kordenbrock (tkorde\@sandia.gov)
  *   @author Ron Oldfield (raoldfi\@sandia.gov)
  */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE   /* sync_file_range */
+#endif
+
 #include "config.h"
 
 #if STDC_HEADERS
@@ -30,20 +39,25 @@
 #include <pthread.h>
 
 #include <dirent.h>
+#include <sys/uio.h>
+#include <sys/time.h>
+#include <sys/resource.h>
 
 #include "sysio_obj.h"
 #include "storage_server.h"
 #include "storage_db.h"
+#include "obj_layout.h"
 
 #include "common/types/xdr_types.h"
 #include "common/types/types.h"
-#include "support/list/tclist.h"
 
 #include "support/hashtable/mt_hashtable.h"
+#include "support/hashtable/hashtable_itr.h"
 #include "support/hashtable/hash_funcs.h"
 
-/* PATH_STR is used to generate file name paths */
-#define PATH_STR "%s/0x%s"
+/* objects live in ROOT/xx/.../0x<oid> (see obj_layout.c) */
+static int new_dir_levels = 2;       /* levels of a new root */
+static struct obj_layout layout;     /* the layout of our root */
 
 /* keep track of an object */
 typedef struct _oid_el
@@ -60,16 +74,86 @@ typedef struct _oid_el
 		       * a    open for appending;
 		       * a+   open for reading and appending;
 		       */
+
+	/* durability bookkeeping (protected by fd_mutex) */
+	lwfs_size dirty;        /* bytes written since the last flush */
+	lwfs_bool dirty_listed; /* TRUE if the object is on dirty_list */
+	struct _oid_el *dirty_next;
+	unsigned long write_gen;  /* number of completed writes */
+	unsigned long synced_gen; /* write_gen at the last fsync */
+	lwfs_bool flushing;       /* an fsync is in progress */
+
+	/* open file cache (protected by fd_mutex) */
+	int refs;                 /* threads using the fd */
+	lwfs_bool removed;        /* the last release frees the object */
+	struct _oid_el *lru_prev; /* more recently used */
+	struct _oid_el *lru_next; /* less recently used */
 }oid_el;
 
-static struct mt_hashtable oid_hash;
-static tclist_t *open_files_list=NULL;
+/* the object index is split into shards, each with its own lock, 
+ * so threads that look up different objects rarely contend */
+#define OID_SHARD_BITS 6
+#define OID_SHARDS (1 << OID_SHARD_BITS)
+#define MIN_SHARD_SIZE 53
+static struct mt_hashtable oid_hash[OID_SHARDS];
+
+/* snapshot of the object index, written at clean shutdown */
+#define OID_INDEX_NAME ".oid_index"
+#define OID_INDEX_MAGIC 0x4f494458   /* "OIDX" */
+#define OID_INDEX_CHUNK 4096         /* oids per read or write */
+
+struct oid_index_header {
+	uint32_t magic; 
+	uint32_t oid_size; 
+	uint64_t count; 
+};
+
+/* open files, most recently used first (protected by fd_mutex) */
+static oid_el *lru_head = NULL; 
+static oid_el *lru_tail = NULL; 
+static int open_count = 0; 
+static int max_open_files = 0; 
+static struct sysio_fd_stats fd_stats; 
 
 static int openflags = O_RDWR | O_SYNC;
+static int extra_openflags = 0;      /* e.g., O_DIRECT for kaio */
+
+/* how (and when) written data reaches the disk */
+static enum ss_durability durability = SS_DURABILITY_SYNC; 
+static int flush_interval = 5;      /* seconds between background flushes */
+static lwfs_size max_dirty = 0;     /* flush early above this many bytes */
+
+/* objects with unflushed writes (protected by fd_mutex) */
+static oid_el *dirty_list = NULL; 
+static lwfs_size dirty_bytes = 0; 
 
-/* we maintain 10 fewer than the max number of open file descriptors - 10 */
-#define MAX_OPEN_FILES (FD_SETSIZE-10)
-#define MAX_HASHTABLE 100
+/* the background flush thread (SS_DURABILITY_PERIODIC) */
+static pthread_t flush_thread; 
+static pthread_cond_t flush_cond = PTHREAD_COND_INITIALIZER; 
+static lwfs_bool flush_running = FALSE; 
+static lwfs_bool flush_done = FALSE; 
+
+/* evicted fds with dirty data, flushed and closed outside fd_mutex */
+struct evicted_fd {
+	int fd; 
+	struct evicted_fd *next; 
+};
+static struct evicted_fd *evicted_list = NULL; 
+
+/* wakes threads waiting for an fsync of the same object */
+static pthread_cond_t fsync_cond = PTHREAD_COND_INITIALIZER; 
+
+static struct sysio_flush_stats flush_stats; 
+
+/* descriptors we leave for sockets, databases, and log files */
+#define FD_RESERVE 64
+#define MIN_OPEN_FILES 16
+
+/* serializes opening and closing of the file descriptors */
+static pthread_mutex_t fd_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* number of iovecs transfer_iov() copies without a malloc */
+#define IOV_LOCAL 16
 
 /* to synchronize access to object id counter */
 static pthread_mutex_t obj_id_mutex = PTHREAD_MUTEX_INITIALIZER;
@@ -121,108 +205,602 @@ lwfs_oid get_new_obj_id(int cid)
 } /* get_new_obj_id() */
 #endif
 
-/* repopulate the oid hash table */
-int repopulate_oid_hashtable(void)
+static unsigned int oid_hash_func(void *data)
 {
-	int rc;
+	return(RSHash((char *)data, sizeof(lwfs_oid)));
+}
 
-	DIR *d=NULL;
-	struct dirent *dent=NULL;
+static int compare_oids(void *a, void *b)
+{
+	// the two are equal if memcmp returns 0
+	return (0 == memcmp(a, b, sizeof(lwfs_oid)));
+}
+
+
+/* oid_shard()
+ *
+ * returns the shard of the object index that holds the oid; the
+ * multiplicative hash uses the high bits of the hash value, so the
+ * shards don't correlate with the buckets of the shard tables;
+ */
+static struct mt_hashtable *oid_shard(const lwfs_oid *oid)
+{
+	unsigned int h = oid_hash_func((void *)oid); 
+
+	return &oid_hash[(h * 2654435761U) >> (32 - OID_SHARD_BITS)]; 
+}
 
+/* oid_count()
+ *
+ * returns the number of objects in the index; 
+ */
+static unsigned int oid_count(void)
+{
+	unsigned int count = 0; 
+	int i; 
+
+	for (i=0; i<OID_SHARDS; i++) {
+		count += mt_hashtable_count(&oid_hash[i]); 
+	}
+
+	return count; 
+}
+
+/* create_oid_index()
+ *
+ * creates the shards of the object index, sized for about 
+ * num_objs objects;
+ */
+static int create_oid_index(unsigned long num_objs)
+{
+	unsigned long shard_size = num_objs/OID_SHARDS + 1; 
+	int i; 
+
+	if (shard_size < MIN_SHARD_SIZE) {
+		shard_size = MIN_SHARD_SIZE; 
+	}
+
+	for (i=0; i<OID_SHARDS; i++) {
+		if (!create_mt_hashtable((unsigned int)shard_size, oid_hash_func, 
+					compare_oids, &oid_hash[i])) {
+			log_error(ss_debug_level, "failed to create shard %d of the oid index", i);
+			while (--i >= 0) {
+				mt_hashtable_destroy(&oid_hash[i], free); 
+			}
+			return LWFS_ERR_NOSPACE; 
+		}
+	}
+
+	return LWFS_OK; 
+}
+
+/* insert_oid()
+ *
+ * creates an element for the oid and adds it to the index;
+ * returns NULL on failure;
+ */
+static oid_el* insert_oid(const lwfs_oid *oid)
+{
 	char ostr[33];
 	lwfs_oid *new_oid = NULL;
 	oid_el   *new_oid_el = NULL;
 
-	d = opendir(root);
-	log_debug(ss_debug_level, "root == %s", root);
-	while (dent = readdir(d))
-	{
-		char file_name[64];
-		log_debug(ss_debug_level, "dent->d_name == %s", dent->d_name);
-		if ((strcmp(dent->d_name, ".") == 0) || 
-		    (strcmp(dent->d_name, "..") == 0)) {
-			continue;
+	new_oid    = malloc(sizeof(lwfs_oid));
+	new_oid_el = malloc(sizeof(oid_el));
+	if ((new_oid == NULL) || (new_oid_el == NULL)) {
+		log_error(ss_debug_level, "could not malloc element for oid (0x%s)",
+			       lwfs_oid_to_string(*oid, ostr));
+		goto error; 
+	}
+
+	memcpy(*new_oid, *oid, sizeof(lwfs_oid));
+	memset(new_oid_el, 0, sizeof(oid_el));
+	memcpy(new_oid_el->id, *oid, sizeof(lwfs_oid));
+	new_oid_el->mode[0] = '\0';
+
+	/* the hashtable owns the key */
+	if (!mt_hashtable_insert(oid_shard(oid), new_oid, new_oid_el)) {
+		log_error(ss_debug_level, "failed to insert oid=0x%s into hashtable", 
+				lwfs_oid_to_string(*oid, ostr));
+		goto error; 
+	}
+
+	return new_oid_el;
+
+error:
+	if (new_oid) free(new_oid); 
+	if (new_oid_el) free(new_oid_el); 
+	return NULL; 
+}
+
+/* sync_root()
+ *
+ * makes renames and unlinks in the root directory durable;
+ */
+static void sync_root(void)
+{
+	int fd = open(root, O_RDONLY); 
+
+	if (fd != -1) {
+		fsync(fd); 
+		close(fd); 
+	}
+}
+
+/* load_oid_index()
+ *
+ * Builds the object index from the snapshot that sysio_obj_fini() 
+ * wrote at the last clean shutdown, so we don't have to walk the
+ * root directory.  We remove the snapshot once it is loaded; if 
+ * the server does not shut down cleanly, the next start walks the
+ * directory.
+ *
+ * returns LWFS_ERR_NOENT if there is no usable snapshot;
+ */
+static int load_oid_index(void)
+{
+	int rc = LWFS_OK; 
+	int fd = -1; 
+	char index_name[MAX_ROOT_LEN+32]; 
+	struct oid_index_header hdr; 
+	struct stat sbuf; 
+	lwfs_oid *oids = NULL; 
+	uint64_t i, n; 
+
+	snprintf(index_name, sizeof(index_name), "%s/%s", root, OID_INDEX_NAME); 
+
+	fd = open(index_name, O_RDONLY); 
+	if (fd == -1) {
+		if (errno != ENOENT) {
+			log_warn(ss_debug_level, "could not open %s: %s", 
+					index_name, strerror(errno)); 
 		}
-	        snprintf(file_name, 64, "%s/%s", root, dent->d_name);
-		log_debug(ss_debug_level, "file_name == %s", file_name);
-		/* check for the existence of the file */
-		if (access(file_name, F_OK) != 0) {
-			log_error(ss_debug_level, "HOW IS THIS POSSIBLE: file doesn't exists (%s)", file_name);
-			return LWFS_ERR_NO_OBJ;
+		return LWFS_ERR_NOENT; 
+	}
+
+	/* check the header (and that the file is complete) */
+	if ((read(fd, &hdr, sizeof(hdr)) != sizeof(hdr)) ||
+	    (hdr.magic != OID_INDEX_MAGIC) ||
+	    (hdr.oid_size != sizeof(lwfs_oid)) ||
+	    (fstat(fd, &sbuf) != 0) ||
+	    ((uint64_t)sbuf.st_size != sizeof(hdr) + hdr.count*sizeof(lwfs_oid))) {
+		log_warn(ss_debug_level, "ignoring invalid oid index %s", index_name); 
+		rc = LWFS_ERR_NOENT; 
+		goto cleanup; 
+	}
+
+	rc = create_oid_index(hdr.count); 
+	if (rc != LWFS_OK) {
+		goto cleanup; 
+	}
+
+	oids = (lwfs_oid *)malloc(OID_INDEX_CHUNK*sizeof(lwfs_oid)); 
+	if (oids == NULL) {
+		rc = LWFS_ERR_NOSPACE; 
+		goto destroy; 
+	}
+
+	/* read the oids a chunk at a time */
+	for (i=0; i<hdr.count; i+=n) {
+		uint64_t j; 
+		size_t len; 
+
+		n = hdr.count - i; 
+		if (n > OID_INDEX_CHUNK) n = OID_INDEX_CHUNK; 
+		len = (size_t)n*sizeof(lwfs_oid); 
+
+		if (read(fd, oids, len) != (ssize_t)len) {
+			log_warn(ss_debug_level, "short read from %s", index_name); 
+			rc = LWFS_ERR_NOENT; 
+			goto destroy; 
 		}
-	
-		new_oid    = malloc(sizeof(lwfs_oid));
-		new_oid_el = malloc(sizeof(oid_el));
-		if ((new_oid == NULL) || (new_oid_el == NULL)) {
-			(void) sprintf(log_line, "could not malloc element for oid (%s)",
-				       &(dent->d_name[2]));
-			log_error(LOG_UNDEFINED, log_line);
+
+		for (j=0; j<n; j++) {
+			if (insert_oid((const lwfs_oid *)&oids[j]) == NULL) {
+				rc = LWFS_ERR_NOSPACE; 
+				goto destroy; 
+			}
+		}
+	}
+
+	/* the snapshot is stale as soon as we change an object */
+	if (unlink(index_name) != 0) {
+		log_error(ss_debug_level, "could not remove %s: %s", 
+				index_name, strerror(errno)); 
+		rc = LWFS_ERR_STORAGE; 
+		goto destroy; 
+	}
+	sync_root(); 
+
+	log_debug(ss_debug_level, "loaded %llu oids from %s", 
+			(unsigned long long)hdr.count, index_name); 
+	goto cleanup; 
+
+destroy:
+	for (i=0; i<OID_SHARDS; i++) {
+		mt_hashtable_destroy(&oid_hash[i], free); 
+	}
+
+cleanup:
+	if (oids) free(oids); 
+	close(fd); 
+	return rc; 
+}
+
+/* save_oid_index()
+ *
+ * writes the oids of the index to the snapshot file; we write a 
+ * temporary file and rename it, so a crash never leaves a partial
+ * snapshot;
+ */
+static int save_oid_index(void)
+{
+	int rc = LWFS_OK; 
+	int fd = -1; 
+	int i; 
+	char index_name[MAX_ROOT_LEN+32]; 
+	char tmp_name[MAX_ROOT_LEN+32]; 
+	struct oid_index_header hdr; 
+	lwfs_oid *oids = NULL; 
+	size_t n = 0; 
+
+	snprintf(index_name, sizeof(index_name), "%s/%s", root, OID_INDEX_NAME); 
+	snprintf(tmp_name, sizeof(tmp_name), "%s/%s.tmp", root, OID_INDEX_NAME); 
+
+	oids = (lwfs_oid *)malloc(OID_INDEX_CHUNK*sizeof(lwfs_oid)); 
+	if (oids == NULL) {
+		return LWFS_ERR_NOSPACE; 
+	}
+
+	fd = open(tmp_name, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR); 
+	if (fd == -1) {
+		log_error(ss_debug_level, "could not create %s: %s", 
+				tmp_name, strerror(errno)); 
+		free(oids); 
+		return LWFS_ERR_STORAGE; 
+	}
+
+	memset(&hdr, 0, sizeof(hdr)); 
+	hdr.magic = OID_INDEX_MAGIC; 
+	hdr.oid_size = sizeof(lwfs_oid); 
+	hdr.count = oid_count(); 
+	if (write(fd, &hdr, sizeof(hdr)) != sizeof(hdr)) {
+		rc = LWFS_ERR_STORAGE; 
+		goto cleanup; 
+	}
+
+	for (i=0; (i<OID_SHARDS) && (rc == LWFS_OK); i++) {
+		struct mt_hashtable *shard = &oid_hash[i]; 
+		struct hashtable_itr *itr = NULL; 
+
+		pthread_mutex_lock(&shard->mutex); 
+		if (hashtable_count(&shard->table) > 0) {
+			itr = hashtable_iterator(&shard->table); 
+			do {
+				memcpy(oids[n++], hashtable_iterator_key(itr), sizeof(lwfs_oid)); 
+				if (n == OID_INDEX_CHUNK) {
+					if (write(fd, oids, n*sizeof(lwfs_oid)) != (ssize_t)(n*sizeof(lwfs_oid))) {
+						rc = LWFS_ERR_STORAGE; 
+						break; 
+					}
+					n = 0; 
+				}
+			} while (hashtable_iterator_advance(itr)); 
+			free(itr); 
+		}
+		pthread_mutex_unlock(&shard->mutex); 
+	}
+
+	if ((rc == LWFS_OK) && (n > 0) &&
+	    (write(fd, oids, n*sizeof(lwfs_oid)) != (ssize_t)(n*sizeof(lwfs_oid)))) {
+		rc = LWFS_ERR_STORAGE; 
+	}
+
+	if ((rc == LWFS_OK) && (fsync(fd) != 0)) {
+		rc = LWFS_ERR_STORAGE; 
+	}
+
+cleanup:
+	close(fd); 
+	free(oids); 
+
+	if (rc == LWFS_OK) {
+		if (rename(tmp_name, index_name) != 0) {
+			rc = LWFS_ERR_STORAGE; 
 		}
 		else {
-			lwfs_string_to_oid(&(dent->d_name[2]), *new_oid);
-			memset(new_oid_el, 0, sizeof(oid_el));
+			sync_root(); 
+			log_debug(ss_debug_level, "saved %llu oids to %s", 
+					(unsigned long long)hdr.count, index_name); 
+		}
+	}
+
+	if (rc != LWFS_OK) {
+		log_error(ss_debug_level, "could not save the oid index: %s", 
+				strerror(errno)); 
+		unlink(tmp_name); 
+	}
+
+	return rc; 
+}
+
+/* scan_dir()
+ *
+ * adds the objects under dir to the index; depth is the number of
+ * layout directories between dir and the objects;
+ */
+static int scan_dir(const char *dir, const int depth)
+{
+	int rc = LWFS_OK;
+
+	DIR *d=NULL;
+	struct dirent *dent=NULL;
+
+	lwfs_oid oid; 
+
+	d = opendir(dir);
+	if (d == NULL) {
+		log_error(ss_debug_level, "could not open %s: %s", dir, strerror(errno));
+		return LWFS_ERR_STORAGE; 
+	}
 
-			memcpy(new_oid_el->id, *new_oid, sizeof(lwfs_oid));
-			new_oid_el->mode[0] = '\0';
+	/* readdir only returns files that exist, so we don't stat them */
+	while ((rc == LWFS_OK) && ((dent = readdir(d)) != NULL))
+	{
+		if (depth > 0) {
+			char subdir[OBJ_LAYOUT_PATH_LEN]; 
 
-			rc = mt_hashtable_insert(&oid_hash, new_oid, new_oid_el);
-			if (!rc)
-			{
-				char ostr[33];
-				log_error(LOG_ERROR, "failed to insert oid=0x%s into hashtable", lwfs_oid_to_string(*new_oid, ostr));
+			if (obj_layout_is_dir(dent->d_name)) {
+				snprintf(subdir, sizeof(subdir), "%s/%s", dir, dent->d_name); 
+				rc = scan_dir(subdir, depth-1); 
 			}
-			log_debug(LOG_UNDEFINED, "repopulate_oid_hashtable().oid_hash.count == %d\n", mt_hashtable_count(&oid_hash));
+			continue; 
+		}
+
+		/* objects are named "0x<oid>" */
+		if (!obj_layout_is_obj(dent->d_name)) {
+			continue;
+		}
+
+		lwfs_string_to_oid(&(dent->d_name[2]), oid);
+		if (insert_oid((const lwfs_oid *)&oid) == NULL) {
+			rc = LWFS_ERR_NOSPACE; 
 		}
 	}
 	closedir(d);
 
-	return LWFS_OK;
+	return rc;
+}
+
+/* repopulate the oid hash table */
+int repopulate_oid_hashtable(void)
+{
+	int rc = LWFS_OK;
+
+	/* a clean shutdown left a snapshot of the index */
+	rc = load_oid_index(); 
+	if (rc != LWFS_ERR_NOENT) {
+		return rc; 
+	}
+
+	rc = create_oid_index(0); 
+	if (rc != LWFS_OK) {
+		return rc; 
+	}
+
+	log_debug(ss_debug_level, "scanning %s for objects", root);
+
+	rc = scan_dir(root, layout.levels); 
+
+	log_debug(ss_debug_level, "found %u objects in %s", oid_count(), root);
+
+	return rc;
 } /* repopulate_oid_hashtable() */
 
 
 /* create and add new object to hash table */
 oid_el* add_oid(const lwfs_oid *oid)
 {
-	int rc;
-	char ostr[33];
-	lwfs_oid *new_oid = NULL;
-	oid_el   *new_oid_el = NULL;
+	oid_el *new_oid_el = insert_oid(oid); 
 
-	new_oid    = malloc(sizeof(lwfs_oid));
-	new_oid_el = malloc(sizeof(oid_el));
-	if ((new_oid == NULL) || (new_oid_el == NULL)) {
-		(void) sprintf(log_line, "could not malloc element for oid (%s)",
-			       lwfs_oid_to_string(*oid, ostr));
-		log_error(LOG_UNDEFINED, log_line);
+	log_debug(LOG_UNDEFINED, "add_oid().oid_hash.count == %u\n", oid_count());
+
+	return new_oid_el;
+} /* add_oid() */
+
+
+/* flush_fd()
+ *
+ * write the data of a file to disk;
+ */
+static int flush_fd(int fd)
+{
+#ifdef HAVE_FDATASYNC
+	if (fdatasync(fd) == -1) {
+#else
+	if (fsync(fd) == -1) {
+#endif
+		log_error(ss_debug_level, "could not fsync file (fd=%d): %s",
+				fd, strerror(errno));
+		return LWFS_ERR_STORAGE; 
 	}
-	else {
-		memcpy(*new_oid, *oid, sizeof(lwfs_oid));
-		memset(new_oid_el, 0, sizeof(oid_el));
 
-		memcpy(new_oid_el->id, *oid, sizeof(lwfs_oid));
-		new_oid_el->mode[0] = '\0';
+	return LWFS_OK; 
+}
+
+/* mark_dirty()
+ *
+ * records a write for the durability policy (call with fd_mutex held);
+ */
+static void mark_dirty(oid_el *el, lwfs_size bytes)
+{
+	el->write_gen++; 
+
+	if ((durability == SS_DURABILITY_SYNC) ||
+	    (durability == SS_DURABILITY_DSYNC) ||
+	    el->removed) {
+		return; 
+	}
+
+	el->dirty += bytes; 
+	dirty_bytes += bytes; 
+
+	if (!el->dirty_listed) {
+		el->dirty_listed = TRUE; 
+		el->dirty_next = dirty_list; 
+		dirty_list = el; 
+	}
+
+	/* too much dirty data, wake the flush thread */
+	if ((durability == SS_DURABILITY_PERIODIC) && 
+	    (max_dirty > 0) && (dirty_bytes > max_dirty)) {
+		pthread_cond_signal(&flush_cond); 
+	}
+}
 
-		rc = mt_hashtable_insert(&oid_hash, new_oid, new_oid_el);
-		if (!rc)
-		{
-			char ostr[33];
-			log_error(LOG_ERROR, "failed to insert oid=0x%s into hashtable", lwfs_oid_to_string(*oid, ostr));
+/* clear_dirty()
+ *
+ * forget the dirty bytes of an object (call with fd_mutex held); the
+ * object stays on dirty_list until the flush thread walks the list;
+ */
+static void clear_dirty(oid_el *el)
+{
+	dirty_bytes -= el->dirty; 
+	el->dirty = 0; 
+}
+
+/* unlist_dirty()
+ *
+ * remove an object from dirty_list (call with fd_mutex held);
+ */
+static void unlist_dirty(oid_el *el)
+{
+	oid_el **pp = &dirty_list; 
+
+	clear_dirty(el); 
+
+	if (!el->dirty_listed) {
+		return; 
+	}
+
+	while (*pp != NULL) {
+		if (*pp == el) {
+			*pp = el->dirty_next; 
+			break; 
 		}
-		log_debug(LOG_UNDEFINED, "add_oid().oid_hash.count == %d\n", mt_hashtable_count(&oid_hash));
+		pp = &(*pp)->dirty_next; 
 	}
+	el->dirty_listed = FALSE; 
+	el->dirty_next = NULL; 
+}
 
-	return new_oid_el;
-} /* add_oid() */
+/* run_flusher()
+ *
+ * the background flush thread for SS_DURABILITY_PERIODIC; every
+ * flush_interval seconds (or when the dirty bytes exceed max_dirty)
+ * it starts writeback on every dirty file, then waits for each one;
+ */
+static void *run_flusher(void *arg)
+{
+	log_debug(ss_debug_level, "starting flush thread");
+
+	pthread_mutex_lock(&fd_mutex);
+
+	while (!flush_done) {
+		struct timespec ts; 
+		struct timeval tp; 
+		oid_el *el; 
+		int *fds = NULL; 
+		int nfds = 0; 
+		int count = 0; 
+		int i; 
+
+		/* wait for the next interval (or for too many dirty bytes) */
+		if ((max_dirty == 0) || (dirty_bytes <= max_dirty)) {
+			gettimeofday(&tp, NULL); 
+			ts.tv_sec = tp.tv_sec + flush_interval; 
+			ts.tv_nsec = tp.tv_usec * 1000; 
+			pthread_cond_timedwait(&flush_cond, &fd_mutex, &ts); 
+		}
+
+		if (flush_done || (dirty_list == NULL)) {
+			continue; 
+		}
+
+		/* take the dirty files; dup the fds so an eviction 
+		 * can close the originals while we flush */
+		for (el = dirty_list; el != NULL; el = el->dirty_next) {
+			count++; 
+		}
+		fds = (int *)malloc(count*sizeof(int)); 
+		if (fds == NULL) {
+			log_error(ss_debug_level, "could not allocate flush list");
+			continue; 
+		}
+		while (dirty_list != NULL) {
+			el = dirty_list; 
+			dirty_list = el->dirty_next; 
+			el->dirty_listed = FALSE; 
+			el->dirty_next = NULL; 
+
+			if ((el->fd > 0) && (el->dirty > 0)) {
+				fds[nfds] = dup(el->fd); 
+				if (fds[nfds] != -1) nfds++; 
+			}
+			clear_dirty(el); 
+		}
+
+		pthread_mutex_unlock(&fd_mutex);
+
+#ifdef SYNC_FILE_RANGE_WRITE
+		/* start writeback on all the files before we wait for any */
+		for (i=0; i<nfds; i++) {
+			sync_file_range(fds[i], 0, 0, SYNC_FILE_RANGE_WRITE); 
+		}
+#endif
+		for (i=0; i<nfds; i++) {
+			flush_fd(fds[i]); 
+			close(fds[i]); 
+		}
+		free(fds); 
+
+		pthread_mutex_lock(&fd_mutex);
+		flush_stats.periodic_flushes++; 
+		flush_stats.files_flushed += nfds; 
+	}
+
+	pthread_mutex_unlock(&fd_mutex);
 
+	log_debug(ss_debug_level, "stopping flush thread");
+	return NULL; 
+}
 
-static int compare_oid_els(const void *a, const void *b)
+/* lru_unlink()
+ *
+ * (call with fd_mutex held)
+ */
+static void lru_unlink(oid_el *el)
 {
-	char ostr[33];
-	log_debug(LOG_UNDEFINED, "***** enter compare_oid_els");
-	log_debug(LOG_UNDEFINED, "oid1==0x%s", lwfs_oid_to_string(((const oid_el *)a)->id, ostr));
-	log_debug(LOG_UNDEFINED, "oid2==0x%s", lwfs_oid_to_string(((const oid_el *)b)->id, ostr));
-// return !0 for success - huh?!?
-	return (memcmp(a, b, sizeof(oid_el)));
+	if (el->lru_prev) el->lru_prev->lru_next = el->lru_next;
+	else lru_head = el->lru_next;
+
+	if (el->lru_next) el->lru_next->lru_prev = el->lru_prev;
+	else lru_tail = el->lru_prev;
+
+	el->lru_prev = el->lru_next = NULL;
+}
+
+/* lru_push_front()
+ *
+ * (call with fd_mutex held)
+ */
+static void lru_push_front(oid_el *el)
+{
+	el->lru_prev = NULL;
+	el->lru_next = lru_head;
+	if (lru_head) lru_head->lru_prev = el;
+	lru_head = el;
+	if (lru_tail == NULL) lru_tail = el;
 }
 
 /* close an open file  */
@@ -235,93 +813,112 @@ void close_the_open_file(oid_el *el)
 		log_info(LOG_UNDEFINED, log_line);
 	}
 	else{
-		sprintf(log_line, "closing file %d", el->fd);
-		log_info(LOG_UNDEFINED, log_line);
+		log_debug(ss_debug_level, "closing file %d", el->fd);
+
+		/* we lose track of dirty data once the file is closed, 
+		 * so flush it (after the caller drops fd_mutex) */
+		if (el->dirty > 0) {
+			struct evicted_fd *ev = (struct evicted_fd *)malloc(sizeof(struct evicted_fd)); 
+
+			clear_dirty(el); 
+			flush_stats.evict_flushes++; 
+
+			if (ev != NULL) {
+				ev->fd = el->fd; 
+				ev->next = evicted_list; 
+				evicted_list = ev; 
+				el->fd = 0; 
+				el->mode[0] = '\0';
+				return; 
+			}
+			flush_fd(el->fd); 
+		}
 
 		/* error checking? */
 		if (close(el->fd) == -1) {
 			log_error(ss_debug_level, "could not close file: %s",
 					strerror(errno));
-			return;
 		}
 		el->fd = 0;
 		el->mode[0] = '\0';
 	}
 } /* close_the_open_file() */
 
+/* flush_evicted()
+ *
+ * flush and close the dirty files we evicted (call without fd_mutex,
+ * so other threads can open files while we wait for the disk);
+ */
+static void flush_evicted(void)
+{
+	struct evicted_fd *ev; 
+
+	pthread_mutex_lock(&fd_mutex);
+	ev = evicted_list; 
+	evicted_list = NULL; 
+	pthread_mutex_unlock(&fd_mutex);
+
+	while (ev != NULL) {
+		struct evicted_fd *next = ev->next; 
+
+		flush_fd(ev->fd); 
+		if (close(ev->fd) == -1) {
+			log_error(ss_debug_level, "could not close file: %s",
+					strerror(errno));
+		}
+		free(ev); 
+		ev = next; 
+	}
+}
+
 /* remove_from_open_files()
  *
- * removes the object from the open files list; includes closure of an
- * open file;
+ * removes the object from the open files list and closes the file
+ * (call with fd_mutex held);
  */
 void remove_from_open_files(oid_el * el)
 {
-	char ostr[33];
-	
 	log_debug(LOG_UNDEFINED, "entered remove_from_open_files");
 
-	tclist_delete(open_files_list, el, compare_oid_els, NULL);
-
+	lru_unlink(el);
 	close_the_open_file(el);
-
-	(void)sprintf(log_line, "removed oid 0x%s from open file list",
-		      lwfs_oid_to_string(el->id, ostr));
-	log_info(LOG_UNDEFINED, log_line);
+	open_count--;
 
 } /* remove_from_open_files() */
 
-/* add_to_open_files()
+/* make_room()
  *
- * closes files if at maximum open count;
+ * closes the least recently used files that nobody is using until 
+ * we are below the maximum open count (call with fd_mutex held);
  */
-void add_to_open_files(oid_el * el)
+static void make_room(void)
 {
-	char ostr[33];
-	int open_files_count = tclist_items(open_files_list);
-	
-	switch(open_files_count){
-	    case 0:
-		
-		/* nothing to do here */
-		break;
-
-	    case MAX_OPEN_FILES:
-
-		/* close the one at the end */
-		/* perf (FIXME): LRU policy? */
-		remove_from_open_files(tclist_tail(open_files_list));
-		break;
-
-	    default:
-
-		if (open_files_count < 0){
-		    (void)sprintf(log_line, "open file count (%d) less than zero!?!",
-			    open_files_count);
-		    log_error(LOG_UNDEFINED, log_line);
-		    return;
-		}
-		else if(open_files_count > MAX_OPEN_FILES){
-		    (void)sprintf(log_line, "open file count (%d) is greater than MAX_OPEN_FILES!?!",
-			    open_files_count);
-		    log_error(LOG_UNDEFINED, log_line);
-		    return;
-		}
-	}
-	/* the list is ready for a new entry */
-	tclist_unshift(open_files_list, el);
+	oid_el *victim = lru_tail; 
 
-	(void)sprintf(log_line, "added oid (0x%s) to open file list", lwfs_oid_to_string(el->id, ostr));
-	log_info(LOG_UNDEFINED, log_line);
+	while ((open_count >= max_open_files) && (victim != NULL)) {
+		oid_el *prev = victim->lru_prev; 
 
-} /* add_to_open_files() */
+		/* never close an fd under in-flight I/O */
+		if (victim->refs == 0) {
+			remove_from_open_files(victim); 
+			fd_stats.evictions++; 
+		}
 
+		victim = prev; 
+	}
+
+	/* every open file is in use; go over the limit for now */
+	if (open_count >= max_open_files) {
+		fd_stats.overflows++; 
+	}
+}
 
 
 /* return NULL if it does not exist */
 oid_el* find_oid(
 	const lwfs_oid *oid)
 {
-    oid_el *result = mt_hashtable_search(&oid_hash, oid);
+    oid_el *result = mt_hashtable_search(oid_shard(oid), oid);
 
     if (result == NULL){
     	char ostr[33];
@@ -337,44 +934,90 @@ oid_el* find_oid(
 } /* find_oid() */
 
 
-/* return NULL if it does not exist */
-oid_el* open_oid(const lwfs_oid *oid)
+/* acquire_oid()
+ *
+ * returns the object with an open fd, NULL if it does not exist;
+ * the fd stays open until the caller calls release_oid();
+ */
+static oid_el* acquire_oid(const lwfs_oid *oid)
 {
-    int rc; 
-    oid_el *result = find_oid(oid);
-    char file_name[256];
+    oid_el *result = NULL;
+    char file_name[OBJ_LAYOUT_PATH_LEN];
     char ostr[33];
 
+    pthread_mutex_lock(&fd_mutex);
+
+    /* search with the lock held, so remove_oid can't free the object */
+    result = find_oid(oid);
     if (result == NULL) {
         log_error(ss_debug_level, "could not find object for oid 0x%s",
                 lwfs_oid_to_string(*oid, ostr));
+	goto unlock; 
     }
 
-    /* if the result is found, but the fd is not open, open the file */
-    else if (result->fd == 0) {
-	char ostr[33];
-        rc = snprintf(file_name, 256, PATH_STR, root, lwfs_oid_to_string(*oid, ostr));            
+    if (result->fd != 0) {
+	/* move the file to the front of the LRU list */
+	lru_unlink(result);
+	lru_push_front(result);
+	fd_stats.hits++; 
+    }
 
-        if (rc == 0 || rc == EOF){
-            log_error(LOG_UNDEFINED, "sprintf() failed");
-            return 0;
-        }
+    /* the fd is not open, open the file */
+    else {
+	int fd; 
+
+	if (obj_layout_path(root, layout.levels, *oid, file_name, sizeof(file_name)) != LWFS_OK) {
+	    result = NULL; 
+	    goto unlock; 
+	}
 
-        result->fd = open(file_name, openflags);
+	make_room(); 
 
-        if (result->fd < 0){
-            log_error(ss_debug_level, "open() failed for file %s: %s", file_name, strerror(errno));
-            return 0;
-        }
+	fd = open(file_name, openflags | extra_openflags);
+	if (fd < 0){
+	    log_error(ss_debug_level, "open() failed for file %s: %s", file_name, strerror(errno));
+	    result = NULL; 
+	    goto unlock; 
+	}
 
-        /* need error checking? */
-        (void)strcpy(result->mode, "r+");
-        log_info(ss_debug_level, "adding file (0x%s) to open list so can write", lwfs_oid_to_string(result->id, ostr));
-        add_to_open_files(result);
+	result->fd = fd; 
+	(void)strcpy(result->mode, "r+");
+	lru_push_front(result);
+	open_count++; 
+	fd_stats.misses++; 
     }
 
+    result->refs++; 
+
+unlock:
+    pthread_mutex_unlock(&fd_mutex);
+
+    /* make_room() may have left dirty files for us to flush */
+    flush_evicted(); 
+
     return result; 
-}
+} /* acquire_oid() */
+
+/* release_oid()
+ *
+ * the caller is done with the fd of the object;
+ */
+static void release_oid(oid_el *el)
+{
+    pthread_mutex_lock(&fd_mutex);
+
+    el->refs--; 
+
+    /* the object was removed while we used it */
+    if ((el->refs == 0) && el->removed) {
+	if (el->fd != 0) {
+	    remove_from_open_files(el);
+	}
+	free(el); 
+    }
+
+    pthread_mutex_unlock(&fd_mutex);
+} /* release_oid() */
 
 
 
@@ -388,14 +1031,25 @@ int remove_oid(const lwfs_oid *oid)
 	oid_el * result = NULL;
 	int rc = 0;
 
-	result = mt_hashtable_remove(&oid_hash, oid);
+	pthread_mutex_lock(&fd_mutex);
+
+	result = mt_hashtable_remove(oid_shard(oid), oid);
 	if (result){
-		log_debug(LOG_UNDEFINED, "remove_oid().oid_hash.count == %d\n", mt_hashtable_count(&oid_hash));
-		if (result->fd != 0){
-			remove_from_open_files(result);
-		}
+		log_debug(LOG_UNDEFINED, "remove_oid().oid_hash.count == %u\n", oid_count());
 
-		free(result);
+		/* the data is about to be removed, don't flush it */
+		unlist_dirty(result);
+
+		/* threads still use the fd; the last one frees it */
+		if (result->refs > 0) {
+			result->removed = TRUE; 
+		}
+		else {
+			if (result->fd != 0){
+				remove_from_open_files(result);
+			}
+			free(result);
+		}
 		rc = 1;
 	}
 	else {
@@ -405,6 +1059,8 @@ int remove_oid(const lwfs_oid *oid)
 		log_info(LOG_UNDEFINED, log_line);
 	}
 
+	pthread_mutex_unlock(&fd_mutex);
+
 	return rc;
 } /* remove_oid() */
 
@@ -493,7 +1149,7 @@ int can_write_file(char *mode)
 void close_all_open_files(void)
 {
 	oid_el *el=NULL;
-	int open_file_count = mt_hashtable_count(&oid_hash);
+	int open_file_count = oid_count();
 	
 	if(open_file_count < 0) {
 		(void)sprintf(log_line, "open file count is %lu!?!", open_file_count);
@@ -506,7 +1162,7 @@ void close_all_open_files(void)
 		return;
 	}
 	
-	while ((el = tclist_tail(open_files_list)) != NULL){
+	while ((el = lru_tail) != NULL){
 		remove_from_open_files(el);
 	}
 } /* close_all_open_files() */
@@ -515,7 +1171,7 @@ void close_all_open_files(void)
 /* convenience function */
 int objs_is_empty(void)
 {
-	int count = mt_hashtable_count(&oid_hash);
+	int count = oid_count();
 	
 	if (count < 0){
 
@@ -532,7 +1188,7 @@ int objs_is_empty(void)
 /* convenience function used when removing all objects */
 lwfs_oid get_top_obj_id(void)
 {
-	oid_el *el = tclist_head(open_files_list);
+	oid_el *el = lru_head;
 	if (el != NULL)
 	{
 		return(el->id);
@@ -541,22 +1197,6 @@ lwfs_oid get_top_obj_id(void)
 } /* get_top_obj_id() */
 #endif
 
-static unsigned int oid_hash_func(void *data)
-{
-	return(RSHash((char *)data, sizeof(lwfs_oid)));
-}
-
-static int compare_oids(void *a, void *b)
-{
-	char ostr[33];
-	log_debug(LOG_UNDEFINED, "***** enter compare_oids");
-	log_debug(LOG_UNDEFINED, "oid1==0x%s", lwfs_oid_to_string(a, ostr));
-	log_debug(LOG_UNDEFINED, "oid2==0x%s", lwfs_oid_to_string(b, ostr));
-	// the two are equal if memcmp returns 0
-	return (0 == memcmp(a, b, sizeof(lwfs_oid)));
-}
-
-
 /* objs_remove_obj()
  *
  * assumes that object already exists;
@@ -567,16 +1207,12 @@ int remove_obj_by_oid(const lwfs_oid *oid)
 {
     int rc = LWFS_OK;
 
-    char file_name[64];
+    char file_name[OBJ_LAYOUT_PATH_LEN];
     char ostr[33];
 
-    /* FIXME: unsigned long may not work everywhere */
-    rc = snprintf(file_name, 64, PATH_STR, root, lwfs_oid_to_string(*oid, ostr));
-
-
-    if (!rc || rc == EOF){
-        log_error(LOG_UNDEFINED, "sprintf() failed");
-        return LWFS_ERR_STORAGE;
+    rc = obj_layout_path(root, layout.levels, *oid, file_name, sizeof(file_name));
+    if (rc != LWFS_OK){
+        return rc;
     }    
     else{
 
@@ -603,6 +1239,49 @@ int remove_obj_by_oid(const lwfs_oid *oid)
 } 
 
 
+/* get_max_open_files()
+ *
+ * returns the size of the open file cache; we raise the soft limit 
+ * on descriptors to the hard limit and keep FD_RESERVE descriptors 
+ * for everything else;
+ */
+static int get_max_open_files(void)
+{
+	struct rlimit rl; 
+	rlim_t limit = FD_SETSIZE; 
+	int result; 
+
+	if (getrlimit(RLIMIT_NOFILE, &rl) == 0) {
+		if (rl.rlim_cur < rl.rlim_max) {
+			struct rlimit want = rl; 
+
+			want.rlim_cur = (rl.rlim_max == RLIM_INFINITY)? 
+				(rlim_t)65536 : rl.rlim_max; 
+			if (setrlimit(RLIMIT_NOFILE, &want) == 0) {
+				rl = want; 
+			}
+			else {
+				log_warn(ss_debug_level, "could not raise RLIMIT_NOFILE: %s",
+						strerror(errno));
+			}
+		}
+		limit = rl.rlim_cur; 
+	}
+	else {
+		log_warn(ss_debug_level, "getrlimit failed, using FD_SETSIZE: %s",
+				strerror(errno));
+	}
+
+	if (limit == RLIM_INFINITY) {
+		limit = 65536; 
+	}
+
+	result = (limit > FD_RESERVE + MIN_OPEN_FILES)? 
+		(int)(limit - FD_RESERVE) : MIN_OPEN_FILES; 
+
+	return result; 
+}
+
 int sysio_obj_init(
         const char *root_dir,
         struct obj_funcs *obj_funcs)
@@ -626,41 +1305,162 @@ int sysio_obj_init(
 		 * something like a file with same name exists */
 	}
 
-	if (!create_mt_hashtable(MAX_HASHTABLE, oid_hash_func, compare_oids, &oid_hash)) {
-		log_error(LOG_ERROR, "failed to create a new hashtable");
-		rc = LWFS_ERR;
+	/* find out where the objects are */
+	if (obj_layout_detect(root, new_dir_levels, &layout) != LWFS_OK) {
+		log_error(ss_debug_level, "could not get the layout of %s", root);
+		return LWFS_ERR_STORAGE;
 	}
-	
+	if (layout.migrating) {
+		log_error(ss_debug_level, "%s is being migrated, finish with lwfs-ss-migrate", root);
+		return LWFS_ERR_STORAGE;
+	}
+	if (layout.levels != new_dir_levels) {
+		log_warn(ss_debug_level, "%s uses %d directory levels (not %d), "
+				"use lwfs-ss-migrate to change it", root, 
+				layout.levels, new_dir_levels);
+	}
+	log_debug(ss_debug_level, "%s uses %d directory levels", root, layout.levels);
+
 	if (repopulate_oid_hashtable() != LWFS_OK) {
 		log_error(LOG_ERROR, "failed to repopulate the oid hashtable");
 		rc = LWFS_ERR;
 	}
 	
-	open_files_list = tclist_new(TC_LOCK_STRICT);
-	if (open_files_list == NULL)
-	{
-		log_error(LOG_ERROR, "failed to get a new open_files_list");
-		rc = LWFS_ERR;
-	}
+	/* size the open file cache */
+	memset(&fd_stats, 0, sizeof(struct sysio_fd_stats));
+	lru_head = lru_tail = NULL; 
+	open_count = 0; 
+	max_open_files = get_max_open_files(); 
+	fd_stats.max_open = max_open_files; 
+	log_debug(ss_debug_level, "keeping at most %d files open", max_open_files);
 
 	/* assign function pointers to the ss_funcs structure */
 	memcpy(obj_funcs, &sysio_obj_funcs, sizeof(struct obj_funcs));
 
+	/* start the background flush thread */
+	memset(&flush_stats, 0, sizeof(struct sysio_flush_stats));
+	if (durability == SS_DURABILITY_PERIODIC) {
+		flush_done = FALSE; 
+		if (pthread_create(&flush_thread, NULL, run_flusher, NULL) != 0) {
+			log_error(ss_debug_level, "could not start flush thread");
+			return LWFS_ERR; 
+		}
+		flush_running = TRUE; 
+	}
+
 	return rc; 
 }
 
+/**
+ * @brief Select when written data reaches the disk.
+ *
+ * Call this before \ref sysio_obj_init.
+ *
+ * @param mode      @input The durability policy.
+ * @param interval  @input Seconds between background flushes 
+ *                         (\ref SS_DURABILITY_PERIODIC).
+ * @param max_bytes @input Flush early when more than this many
+ *                         bytes are dirty (0 means no limit).
+ */
+int sysio_obj_set_durability(
+		const enum ss_durability mode,
+		const int interval,
+		const lwfs_size max_bytes)
+{
+	durability = mode; 
+	flush_interval = (interval > 0)? interval : 1; 
+	max_dirty = max_bytes; 
+
+	switch (mode) {
+		case SS_DURABILITY_SYNC:
+			openflags = O_RDWR | O_SYNC; 
+			break; 
+
+		case SS_DURABILITY_DSYNC:
+#ifdef HAVE_FLAG_O_DSYNC
+			openflags = O_RDWR | O_DSYNC; 
+#else
+			log_warn(ss_debug_level, "O_DSYNC not available, using O_SYNC");
+			openflags = O_RDWR | O_SYNC; 
+#endif
+			break; 
+
+		case SS_DURABILITY_WRITEBACK:
+		case SS_DURABILITY_PERIODIC:
+			openflags = O_RDWR; 
+			break; 
+
+		default:
+			log_error(ss_debug_level, "unknown durability mode %d", mode);
+			return LWFS_ERR_NOTSUPP; 
+	}
+
+	return LWFS_OK; 
+}
+
+/**
+ * @brief Select the number of directory levels for a new root.
+ *
+ * Call this before \ref sysio_obj_init.  A root that already
+ * has objects keeps its layout until lwfs-ss-migrate changes it.
+ *
+ * @param levels @input Directory levels (0 puts every object 
+ *                      in the root).
+ */
+int sysio_obj_set_layout(
+		const int levels)
+{
+	if ((levels < 0) || (levels > OBJ_LAYOUT_MAX_LEVELS)) {
+		log_error(ss_debug_level, "directory levels must be in [0,%d]",
+				OBJ_LAYOUT_MAX_LEVELS);
+		return LWFS_ERR_NOTSUPP; 
+	}
+
+	new_dir_levels = levels; 
+
+	return LWFS_OK; 
+}
+
+/**
+ * @brief Get a copy of the flush counters.
+ */
+void sysio_obj_get_flush_stats(
+		struct sysio_flush_stats *result)
+{
+	pthread_mutex_lock(&fd_mutex);
+	memcpy(result, &flush_stats, sizeof(struct sysio_flush_stats));
+	pthread_mutex_unlock(&fd_mutex);
+}
+
 /* fini_objects()
  *
  * teardown structures;
- * does not persist any objects
+ * saves the object index, but does not persist any objects
  *
  * returns non-zero upon success;
  */
 int sysio_obj_fini()
 {
 	int rc=LWFS_OK;
+	int i;
+
+	/* stop the flush thread (closing the files flushes the rest) */
+	if (flush_running) {
+		pthread_mutex_lock(&fd_mutex);
+		flush_done = TRUE; 
+		pthread_cond_signal(&flush_cond); 
+		pthread_mutex_unlock(&fd_mutex);
+
+		pthread_join(flush_thread, NULL); 
+		flush_running = FALSE; 
+	}
 
+	pthread_mutex_lock(&fd_mutex);
 	close_all_open_files();
+	dirty_list = NULL; 
+	dirty_bytes = 0; 
+	pthread_mutex_unlock(&fd_mutex);
+	flush_evicted(); 
 
 	/*
 	while(!objs_is_empty()){
@@ -680,9 +1480,13 @@ int sysio_obj_fini()
 	}
 	*/
 
-	tclist_destroy(open_files_list, NULL);
 
-	mt_hashtable_destroy(&oid_hash, free);
+	/* the next start loads the index instead of scanning root */
+	save_oid_index(); 
+
+	for (i=0; i<OID_SHARDS; i++) {
+		mt_hashtable_destroy(&oid_hash[i], free);
+	}
 
 	return(rc);
 } /* fini_objects() */
@@ -690,19 +1494,67 @@ int sysio_obj_fini()
 
 /** 
  * @brief Returns the file descriptor of an object. 
+ *
+ * The fd stays open until the caller passes the result 
+ * to \ref sysio_obj_release_fd.
+ *
+ * @param obj @input The object.
+ * @param fd  @output The file descriptor (-1 on error).
+ *
+ * @returns A reference to the open file, NULL if the object 
+ *          does not exist or could not be opened. 
  */
-int sysio_obj_getfd(const lwfs_obj *obj)
+struct _oid_el *sysio_obj_acquire_fd(const lwfs_obj *obj, int *fd)
 {
-    oid_el *ptr = open_oid(&obj->oid);
+    oid_el *ptr = acquire_oid(&obj->oid);
 
-    if (ptr == NULL) {
-        return -1; 
-    }
-    else {
-        return ptr->fd;
+    *fd = (ptr == NULL)? -1 : ptr->fd; 
+
+    return ptr; 
+}
+
+/** 
+ * @brief Release a reference from \ref sysio_obj_acquire_fd. 
+ */
+void sysio_obj_release_fd(struct _oid_el *ref)
+{
+    if (ref != NULL) {
+	release_oid(ref); 
     }
 }
 
+/** 
+ * @brief Record data written through a reference from 
+ * \ref sysio_obj_acquire_fd, so fsync and the flusher see it.
+ */
+void sysio_obj_mark_dirty(struct _oid_el *ref, const lwfs_size bytes)
+{
+    pthread_mutex_lock(&fd_mutex);
+    mark_dirty(ref, bytes); 
+    pthread_mutex_unlock(&fd_mutex);
+}
+
+/**
+ * @brief Add flags (e.g., O_DIRECT) to the flags we open files with.
+ *
+ * Call this before \ref sysio_obj_init.
+ */
+void sysio_obj_set_open_flags(const int flags)
+{
+    extra_openflags = flags; 
+}
+
+/**
+ * @brief Get a copy of the open file cache counters.
+ */
+void sysio_obj_get_fd_stats(
+		struct sysio_fd_stats *result)
+{
+	pthread_mutex_lock(&fd_mutex);
+	memcpy(result, &fd_stats, sizeof(struct sysio_fd_stats));
+	pthread_mutex_unlock(&fd_mutex);
+}
+
 
 
 
@@ -735,16 +1587,14 @@ int sysio_obj_create(const lwfs_obj *obj)
 	int fd; 
 	oid_el * new_oid = NULL;
 
-	char file_name[64];
+	char file_name[OBJ_LAYOUT_PATH_LEN];
 	char ostr[33];
 
 	log_debug(ss_debug_level, "entered sysio_obj_create");
 
-	/* FIXME: unsigned long may not work everywhere */
-	rc = snprintf(file_name, 64, PATH_STR, root, lwfs_oid_to_string(obj->oid, ostr));
-	if (rc == 0 || rc == EOF){
-		log_error(LOG_UNDEFINED, "sprintf() failure;");
-		return LWFS_ERR_STORAGE;
+	rc = obj_layout_path(root, layout.levels, obj->oid, file_name, sizeof(file_name));
+	if (rc != LWFS_OK){
+		return rc;
 	}
 
 	/* check for the existence of the file */
@@ -753,8 +1603,14 @@ int sysio_obj_create(const lwfs_obj *obj)
 		return LWFS_ERR_EXIST;
 	}
 
-	/* now really create it (with mode = "rw") */
+	/* now really create it (with mode = "rw"); we create the 
+	 * layout directories the first time we use them */
 	fd = creat(file_name, S_IRUSR | S_IWUSR);
+	if ((fd == -1) && (errno == ENOENT) && (layout.levels > 0)) {
+		if (obj_layout_mkdirs(root, layout.levels, obj->oid) == LWFS_OK) {
+			fd = creat(file_name, S_IRUSR | S_IWUSR);
+		}
+	}
 	if (fd == -1){
 		log_error(ss_debug_level, "failed to open file %s: %s",
 			file_name, strerror(errno));
@@ -780,10 +1636,7 @@ int sysio_obj_create(const lwfs_obj *obj)
 	/* brittle? */
 	strcpy(new_oid->mode, "\0");
 
-	/* Add this object to the list of open files.
-	 * This will close files if we're over the limit. 
-	 */
-	add_to_open_files(new_oid); 
+	/* the file is opened (and cached) on first use */
 
 	log_debug(ss_debug_level, "created obj oid=0x%s", lwfs_oid_to_string(new_oid->id, ostr)); 
 	
@@ -825,190 +1678,218 @@ int sysio_obj_remove(const lwfs_obj *obj)
 }
 
 
-/* read_obj()
+/* transfer_iov()
  *
- * assumes that object already exists;
+ * Reads or writes a list of buffers at an offset of the file.  We use
+ * positional I/O (no lseek), so threads can access disjoint extents 
+ * of the same file at the same time.  Partial transfers are retried 
+ * until all the data is transferred or a read reaches the end of
+ * the file.
  *
- * return one upon success;
+ * returns the number of bytes transferred, -1 on error;
  */
-lwfs_ssize sysio_obj_read(
-		const lwfs_obj *obj, 
-		const lwfs_ssize src_offset, 
-		void *dest, 
-		const lwfs_ssize len)
+static lwfs_ssize transfer_iov(
+		const int fd, 
+		const lwfs_bool write_op,
+		const lwfs_ssize offset, 
+		const struct iovec *iov, 
+		const int iovcnt)
 {
-	size_t offset; 
-	oid_el *current = NULL;
-	lwfs_ssize count = 0;
+	struct iovec *base = NULL;
+	struct iovec *vec = NULL;
+	struct iovec local[IOV_LOCAL];
+	int cnt = iovcnt; 
+	lwfs_ssize count = 0; 
+
+	/* we modify the list when a transfer is partial */
+	if (iovcnt > IOV_LOCAL) {
+		base = (struct iovec *)malloc(iovcnt*sizeof(struct iovec));
+		if (base == NULL) {
+			log_error(ss_debug_level, "could not allocate iovec");
+			return -1; 
+		}
+	}
+	else {
+		base = local; 
+	}
+	memcpy(base, iov, iovcnt*sizeof(struct iovec)); 
+	vec = base; 
 
-	char file_name[64];
-	char ostr[33];
+	while (cnt > 0) {
+		ssize_t bytes; 
 
-	log_debug(ss_debug_level, "entered sysio_obj_read");
+		/* skip empty buffers */
+		if (vec->iov_len == 0) {
+			vec++; 
+			cnt--; 
+			continue; 
+		}
 
-	current = open_oid(&obj->oid);
-	if (current == NULL) {
-		log_error(ss_debug_level,
-                "could not read because object (0x%s) not found", 
-                lwfs_oid_to_string(obj->oid, ostr));
-		return count; 
-	}
+#if defined(HAVE_PREADV) && defined(HAVE_PWRITEV)
+		if (write_op) 
+			bytes = pwritev(fd, vec, cnt, offset + count); 
+		else 
+			bytes = preadv(fd, vec, cnt, offset + count); 
+#else
+		if (write_op) 
+			bytes = pwrite(fd, vec->iov_base, vec->iov_len, offset + count); 
+		else 
+			bytes = pread(fd, vec->iov_base, vec->iov_len, offset + count); 
+#endif
 
-	/* see if the mode is set to allows reads */
-	if (current->fd){
-		if (!can_read_file(current->mode))
-		{
-			remove_from_open_files(current);
+		if (bytes == -1) {
+			if (errno == EINTR) {
+				continue; 
+			}
+			log_error(ss_debug_level, "unable to %s: %s",
+					(write_op)? "write" : "read", strerror(errno));
+			count = -1; 
+			break; 
 		}
-	}
 
-	/* do we need to open the file? */
-	/*
-	close(current->fd); 
-	current->fd = 0; 
-	*/
-	if (current->fd == 0){
-		int ret = 0;
-		ret = snprintf(file_name, 64, PATH_STR, root, lwfs_oid_to_string(obj->oid, ostr));
-		if (ret == 0 || ret == EOF){
-			log_error(ss_debug_level, "sprintf() failed;");
-			return count;
+		/* end of file */
+		if (bytes == 0) {
+			break; 
 		}
 
+		count += bytes; 
 
-		/* need error checking? */
-		current->fd = open(file_name, openflags);
-		if (current->fd == -1){
-			log_error(ss_debug_level, "could not open file for read");
-			return count;
+		/* advance past the transferred bytes */
+		while ((cnt > 0) && (bytes >= (ssize_t)vec->iov_len)) {
+			bytes -= vec->iov_len; 
+			vec++; 
+			cnt--; 
+		}
+		if (bytes > 0) {
+			vec->iov_base = (char *)vec->iov_base + bytes; 
+			vec->iov_len -= bytes; 
 		}
-
-		/* brittle? */
-		(void)strcpy(current->mode, "r+");
-
-		add_to_open_files(current);
 	}
 
-	/* seek to the right location */
-	offset = lseek(current->fd, src_offset, SEEK_SET); 
-	if(offset == -1) {
-		log_error(ss_debug_level, "lseek() failed: %s",
-				strerror(errno));
-		return LWFS_ERR;
+	if (base != local) {
+		free(base); 
 	}
 
-	/* now we can do the read */
-	if (len > 0) {
-
-		ssize_t bytes_read = read(current->fd, dest, len); 
-		log_debug(ss_debug_level, "bytes_read == %ld", bytes_read);
-		if (bytes_read == -1) {
-			log_error(ss_debug_level, "unable to read: %s",
-					strerror(errno));
-			count = 0; 
-			return count; 
-		}
+	return count; 
+}
 
-		count = bytes_read; 
-	}
-	else {
-		/* nothing to do here */
-		count = 0;
-	}
 
-	log_debug(ss_debug_level, "finished sysio_obj_read");
+/* read_obj()
+ *
+ * assumes that object already exists;
+ *
+ * returns the number of bytes read, -1 on error;
+ */
+lwfs_ssize sysio_obj_read(
+		const lwfs_obj *obj, 
+		const lwfs_ssize src_offset, 
+		void *dest, 
+		const lwfs_ssize len)
+{
+	struct iovec iov; 
 
-	return count;
+	iov.iov_base = dest; 
+	iov.iov_len = len; 
 
+	return sysio_obj_readv(obj, src_offset, &iov, 1); 
 } /* read_obj() */
 
 
-/* write_obj()
+/* readv_obj()
  *
  * assumes that object already exists;
  *
- * returns one upon success;
+ * returns the number of bytes read, -1 on error;
  */
-lwfs_ssize sysio_obj_write(
-		const lwfs_obj *dest_obj, 
-		const lwfs_ssize dest_offset, 
-		void *src, 
-		const lwfs_ssize len)
+lwfs_ssize sysio_obj_readv(
+		const lwfs_obj *obj, 
+		const lwfs_ssize src_offset, 
+		const struct iovec *iov, 
+		const int iovcnt)
 {
-    lwfs_ssize count=0; 
-    int rc = 0;
-
-    oid_el * result = NULL;
+	oid_el *el = NULL; 
+	lwfs_ssize count;
+	char ostr[33];
 
-    char file_name[64];
-    char ostr[33];
+	log_debug(ss_debug_level, "entered sysio_obj_readv");
 
-    log_debug(ss_debug_level, "entered sysio_obj_write");
-	
-    result = open_oid(&dest_obj->oid);
+	el = acquire_oid(&obj->oid); 
+	if (el == NULL) {
+		log_error(ss_debug_level,
+                "could not read because object (0x%s) not found", 
+                lwfs_oid_to_string(obj->oid, ostr));
+		return -1; 
+	}
 
-    if (result){
+	count = transfer_iov(el->fd, FALSE, src_offset, iov, iovcnt); 
+	log_debug(ss_debug_level, "bytes_read == %ld", count);
 
-        if (result->fd && !can_write_file(result->mode)){
-            (void)sprintf(log_line, "removing file (0x%s) from open list since can't write", lwfs_oid_to_string(result->id, ostr));
-            log_info(LOG_UNDEFINED, log_line);
-            remove_from_open_files(result);
-        }
+	release_oid(el); 
 
-        if (result->fd == 0){
-	    rc = snprintf(file_name, 64, PATH_STR, root, lwfs_oid_to_string(result->id, ostr));
-            if (rc == 0 || rc == EOF){
-                log_error(LOG_UNDEFINED, "sprintf() failed");
-                return 0;
-            }
+	return count;
+} /* readv_obj() */
 
-            result->fd = open(file_name, openflags);
 
-            if (result->fd < 0){
-                (void) sprintf(log_line, "open() failed for file %s", file_name);
-                log_error(LOG_UNDEFINED, log_line);
-                return 0;
-            }
+/* write_obj()
+ *
+ * assumes that object already exists;
+ *
+ * returns the number of bytes written, -1 on error;
+ */
+lwfs_ssize sysio_obj_write(
+		const lwfs_obj *dest_obj, 
+		const lwfs_ssize dest_offset, 
+		void *src, 
+		const lwfs_ssize len)
+{
+	struct iovec iov; 
 
-            /* need error checking? */
-            (void)strcpy(result->mode, "r+");
-            (void)sprintf(log_line, "adding file (0x%s) to open list so can write", lwfs_oid_to_string(result->id, ostr));
-            log_info(LOG_UNDEFINED, log_line);
+	iov.iov_base = src; 
+	iov.iov_len = len; 
 
-            add_to_open_files(result);
-        }
+	return sysio_obj_writev(dest_obj, dest_offset, &iov, 1); 
+} /* write_obj() */
 
-        log_debug(ss_debug_level, "seeking to offset %ld", dest_offset); 
 
-        if (lseek(result->fd, dest_offset, SEEK_SET) == -1) {
-            (void) sprintf(log_line, "lseek() failed for file %s, offset=%ld", 
-                           file_name, (unsigned long)dest_offset);
-            log_error(LOG_UNDEFINED, log_line);
-        }
-        else{
-            /* do the write */
-            if (len > 0) {
-                log_debug(ss_debug_level, "bytes written == %ld", len); 
+/* writev_obj()
+ *
+ * assumes that object already exists;
+ *
+ * returns the number of bytes written, -1 on error;
+ */
+lwfs_ssize sysio_obj_writev(
+		const lwfs_obj *dest_obj, 
+		const lwfs_ssize dest_offset, 
+		const struct iovec *iov, 
+		const int iovcnt)
+{
+	oid_el *el = NULL; 
+	lwfs_ssize count;
+	char ostr[33];
 
-                count = write(result->fd, src, len);
-            }
+	log_debug(ss_debug_level, "entered sysio_obj_writev");
 
-            rc = 1;
-        }
-    }
-    else{
-        (void)sprintf(log_line, "could not write because object id (%s) not found", lwfs_oid_to_string(result->id, ostr));
-        log_info(LOG_UNDEFINED, log_line);
-    }
+	el = acquire_oid(&dest_obj->oid); 
+	if (el == NULL) {
+		log_error(ss_debug_level,
+                "could not write because object (0x%s) not found", 
+                lwfs_oid_to_string(dest_obj->oid, ostr));
+		return -1; 
+	}
 
-    log_debug(ss_debug_level, "finished write", len); 
+	count = transfer_iov(el->fd, TRUE, dest_offset, iov, iovcnt); 
+	log_debug(ss_debug_level, "bytes written == %ld", count); 
 
-	/* this is where we free the buffer */
-	free(src); 
+	if (count > 0) {
+		pthread_mutex_lock(&fd_mutex);
+		mark_dirty(el, count); 
+		pthread_mutex_unlock(&fd_mutex);
+	}
 
-    return count;
+	release_oid(el); 
 
-} /* write_obj() */
+	return count;
+} /* writev_obj() */
 
 
 /* fsync()
@@ -1023,27 +1904,70 @@ int sysio_obj_fsync(
 {
     int rc = LWFS_OK;
     oid_el * result = NULL;
+    unsigned long target; 
 
     log_debug(ss_debug_level, "entered sysio_obj_fsync");
 	
-    result = open_oid(&obj->oid);
+    result = acquire_oid(&obj->oid);
+    if (result == NULL) {
+        return LWFS_ERR_STORAGE;
+    }
 
-    if (result){
-        /* flush all data to disk */
-#ifdef HAVE_FDATASYNC
-        if (fdatasync(result->fd) == -1) {
-#else
-	  if (fsync(result->fd) == -1) {
-#endif
-            log_error(ss_debug_level, "could not fsync file (fd=%d): %s",
-                    result->fd, strerror(errno));
-            rc = LWFS_ERR_STORAGE; 
-        }
+    pthread_mutex_lock(&fd_mutex);
+    flush_stats.fsync_requests++; 
+
+    /* every write already went to disk */
+    if ((durability == SS_DURABILITY_SYNC) ||
+        (durability == SS_DURABILITY_DSYNC)) {
+        pthread_mutex_unlock(&fd_mutex);
+        release_oid(result); 
+        return rc; 
     }
-    else {
-        rc = LWFS_ERR_STORAGE;
+
+    /* Wait for every write that completed before this call.  If 
+     * another thread is already flushing the object, wait for it 
+     * and flush again only if it started before our writes 
+     * finished; concurrent fsyncs share one fdatasync. */
+    target = result->write_gen; 
+    while (result->synced_gen < target) {
+        unsigned long gen; 
+        lwfs_size bytes; 
+
+        if (result->flushing) {
+            pthread_cond_wait(&fsync_cond, &fd_mutex); 
+            continue; 
+        }
+
+        result->flushing = TRUE; 
+        gen = result->write_gen; 
+        bytes = result->dirty; 
+        pthread_mutex_unlock(&fd_mutex);
+
+        /* our reference keeps the fd open */
+        rc = flush_fd(result->fd); 
+
+        pthread_mutex_lock(&fd_mutex);
+        result->flushing = FALSE; 
+        flush_stats.fsync_flushes++; 
+        if (rc == LWFS_OK) {
+            result->synced_gen = gen; 
+
+            /* writes that arrived during the flush stay dirty */
+            bytes = (bytes < result->dirty)? bytes : result->dirty; 
+            result->dirty -= bytes; 
+            dirty_bytes -= bytes; 
+        }
+        pthread_cond_broadcast(&fsync_cond); 
+
+        if (rc != LWFS_OK) {
+            break; 
+        }
     }
 
+    pthread_mutex_unlock(&fd_mutex);
+
+    release_oid(result); 
+
     return rc;
 
 } /*  get_attr() */
@@ -1065,7 +1989,7 @@ int sysio_obj_stat(
 
 	log_debug(ss_debug_level, "entered sysio_obj_stat");
 	
-	result = open_oid(&obj->oid);
+	result = acquire_oid(&obj->oid);
 
 	if (result){
 		struct stat stats; 
@@ -1073,8 +1997,10 @@ int sysio_obj_stat(
 		if (fstat(result->fd, &stats) == -1) {
 			log_error(ss_debug_level, "count not fstat file: %s",
 					strerror(errno));
+			release_oid(result); 
 			return LWFS_ERR; 
 		}
+		release_oid(result); 
 
 		memset(res, 0, sizeof(lwfs_stat_data));
 
@@ -1108,14 +2034,16 @@ int sysio_obj_trunc(
 
 	log_debug(ss_debug_level, "entered sysio_obj_trunc");
 	
-	result = open_oid(&obj->oid);
+	result = acquire_oid(&obj->oid);
 
 	if (result){
 		if (ftruncate(result->fd, size) == -1) {
 			log_error(ss_debug_level, "could not truncate file: %s",
 				strerror(errno));
+			release_oid(result); 
 			return 0; 
 		}
+		release_oid(result); 
 		rc = 1;
 	}
 
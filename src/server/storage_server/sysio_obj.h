@@ -6,6 +6,7 @@
 #include "storage_server.h"
 #include <unistd.h> 
 #include <pthread.h>
+#include <sys/uio.h>
 
 
 #define ROOT_DIRECTORY  "ss_test_dir"
@@ -13,6 +14,49 @@
 
 
 
+/**
+ * @brief Counters for the durability policy.
+ */
+struct sysio_flush_stats {
+	/** @brief fsync requests from clients. */
+	long fsync_requests;
+
+	/** @brief fdatasync calls made for fsync requests. */
+	long fsync_flushes;
+
+	/** @brief Passes of the background flush thread. */
+	long periodic_flushes;
+
+	/** @brief Files flushed by the background flush thread. */
+	long files_flushed;
+
+	/** @brief Dirty files flushed because they were closed. */
+	long evict_flushes;
+};
+
+/**
+ * @brief Counters for the open file cache.
+ */
+struct sysio_fd_stats {
+	/** @brief Requests for an fd that was already open. */
+	long hits;
+
+	/** @brief Requests that had to open the file. */
+	long misses;
+
+	/** @brief Files closed to make room for another. */
+	long evictions;
+
+	/** @brief Opens that exceeded the limit because every file was in use. */
+	long overflows;
+
+	/** @brief The maximum number of open files. */
+	long max_open;
+};
+
+/* an open file (see sysio_obj.c) */
+struct _oid_el;
+
 /*----------- THE CORE FUNCTIONS ------------- */
 extern int sysio_obj_init(
         const char *root, 
@@ -20,6 +64,34 @@ extern int sysio_obj_init(
 
 extern int sysio_obj_fini();
 
+extern int sysio_obj_set_durability(
+		const enum ss_durability mode,
+		const int interval,
+		const lwfs_size max_bytes);
+
+extern int sysio_obj_set_layout(
+		const int levels);
+
+extern void sysio_obj_get_flush_stats(
+		struct sysio_flush_stats *stats);
+
+extern void sysio_obj_get_fd_stats(
+		struct sysio_fd_stats *stats);
+
+extern struct _oid_el *sysio_obj_acquire_fd(
+		const lwfs_obj *obj, 
+		int *fd);
+
+extern void sysio_obj_release_fd(
+		struct _oid_el *ref);
+
+extern void sysio_obj_mark_dirty(
+		struct _oid_el *ref,
+		const lwfs_size bytes);
+
+extern void sysio_obj_set_open_flags(
+		const int flags);
+
 extern lwfs_bool sysio_obj_exists(const lwfs_obj *obj);
 
 extern int sysio_obj_fsync(const lwfs_obj *obj);
@@ -42,6 +114,18 @@ extern lwfs_ssize sysio_obj_write(
 		void *src, 
 		const lwfs_ssize len);
 
+extern lwfs_ssize sysio_obj_readv(
+		const lwfs_obj *obj, 
+		const lwfs_ssize src_offset, 
+		const struct iovec *iov, 
+		const int iovcnt);
+
+extern lwfs_ssize sysio_obj_writev(
+		const lwfs_obj *dest_obj, 
+		const lwfs_ssize dest_offset, 
+		const struct iovec *iov, 
+		const int iovcnt);
+
 extern int sysio_obj_listattrs(
 		const lwfs_obj *obj, 
 		lwfs_name_array *names);
@@ -82,10 +166,4 @@ extern int sysio_obj_trunc(
 		const lwfs_obj *obj, 
 		const lwfs_ssize size);
 
-/*----------- SUPPORT FUNCTIONS ------------- */
-
-/* returns the file descriptor */
-extern int sysio_obj_getfd(
-        const lwfs_obj *obj);
-
 #endif /* SYSIO_OBJ_H */
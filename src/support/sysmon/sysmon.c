@@ -15,6 +15,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <errno.h>
+#include <sys/time.h>
+#include <pthread.h>
 
 #include "sysmon.h"
 #include "meminfo.h"
@@ -23,25 +26,36 @@
 #include "support/logger/logger.h"
 
 
-void log_meminfo(const log_level debug_level)
-{
-	struct lwfs_meminfo mi;
+/* state of the memory sampler thread */
+static pthread_mutex_t sampler_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sampler_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t sampler_thread;
+static int sampler_users = 0;
+static int sampler_stop = 0;
+static double sampler_interval = SYSMON_SAMPLE_INTERVAL;
+static log_level sampler_debug_level = LOG_UNDEFINED;
+
+/* last sample of main memory in use (kB).  A single aligned 
+ * word, so readers never see a torn value; at worst they 
+ * see the previous sample. */
+static volatile unsigned long sampled_kb_used = 0;
 
+
+static void log_mi(const log_level debug_level, const struct lwfs_meminfo *mi)
+{
 	int show_high=0;
 	int show_total=0;
 
-	meminfo(&mi);
-
 	log_debug(debug_level, "               total         used         free       shared      buffers       cached");
 	log_debug(debug_level, 
 		"%-7s %10lukB %10lukB %10lukB %10lukB %10lukB %10lukB", 
 		"Mem:",
-		mi.kb_main_total,
-		mi.kb_main_used,
-		mi.kb_main_free,
-		mi.kb_main_shared,
-		mi.kb_main_buffers,
-		mi.kb_main_cached
+		mi->kb_main_total,
+		mi->kb_main_used,
+		mi->kb_main_free,
+		mi->kb_main_shared,
+		mi->kb_main_buffers,
+		mi->kb_main_cached
 	);
 	// Print low vs. high information, if the user requested it.
 	// Note we check if low_total==0: if so, then this kernel does
@@ -51,36 +65,44 @@ void log_meminfo(const log_level debug_level)
 		log_debug(debug_level, 
 			"%-7s %10lukB %10lukB %10lukB", 
 			"Low:",
-			mi.kb_low_total,
-			mi.kb_low_total - mi.kb_low_free,
-			mi.kb_low_free
+			mi->kb_low_total,
+			mi->kb_low_total - mi->kb_low_free,
+			mi->kb_low_free
 		);
 		log_debug(debug_level, 
 			"%-7s %10lukB %10lukB %10lukB", 
 			"High:",
-			mi.kb_high_total,
-			mi.kb_high_total - mi.kb_high_free,
-			mi.kb_high_free
+			mi->kb_high_total,
+			mi->kb_high_total - mi->kb_high_free,
+			mi->kb_high_free
 		);
 	}
 	log_debug(debug_level, 
 		"%-7s %10lukB %10lukB %10lukB", 
 		"Swap:",
-		mi.kb_swap_total,
-		mi.kb_swap_used,
-		mi.kb_swap_free
+		mi->kb_swap_total,
+		mi->kb_swap_used,
+		mi->kb_swap_free
 	);
 	if(show_total){
 		log_debug(debug_level, 
 			"%-7s %10lukB %10lukB %10lukB", 
 			"Total:",
-			mi.kb_main_total + mi.kb_swap_total,
-			mi.kb_main_used  + mi.kb_swap_used,
-			mi.kb_main_free  + mi.kb_swap_free
+			mi->kb_main_total + mi->kb_swap_total,
+			mi->kb_main_used  + mi->kb_swap_used,
+			mi->kb_main_free  + mi->kb_swap_free
 		);
 	}
 }
 
+void log_meminfo(const log_level debug_level)
+{
+	struct lwfs_meminfo mi;
+
+	meminfo(&mi);
+	log_mi(debug_level, &mi);
+}
+
 unsigned long main_memory_used(void)
 {
 	struct lwfs_meminfo mi;
@@ -89,3 +111,123 @@ unsigned long main_memory_used(void)
 
 	return mi.kb_main_used;
 }
+
+
+/* take one sample of /proc/meminfo */
+static void take_sample(void)
+{
+	struct lwfs_meminfo mi;
+
+	meminfo(&mi);
+	sampled_kb_used = mi.kb_main_used;
+
+	if (logging_debug(sampler_debug_level)) {
+		log_mi(sampler_debug_level, &mi);
+	}
+}
+
+static void *sampler_run(void *args)
+{
+	struct timeval now;
+	struct timespec wakeup;
+	double t;
+
+	pthread_mutex_lock(&sampler_mutex);
+	while (!sampler_stop) {
+
+		/* sleep for an interval (or until told to stop) */
+		gettimeofday(&now, NULL);
+		t = now.tv_sec + now.tv_usec/1.0e6 + sampler_interval;
+		wakeup.tv_sec = (time_t)t;
+		wakeup.tv_nsec = (long)((t - wakeup.tv_sec) * 1.0e9);
+
+		while (!sampler_stop) {
+			if (pthread_cond_timedwait(&sampler_cond, &sampler_mutex, 
+						&wakeup) == ETIMEDOUT) {
+				break;
+			}
+		}
+		if (sampler_stop) {
+			break;
+		}
+
+		/* parse the file without holding the lock */
+		pthread_mutex_unlock(&sampler_mutex);
+		take_sample();
+		pthread_mutex_lock(&sampler_mutex);
+	}
+	pthread_mutex_unlock(&sampler_mutex);
+
+	return NULL;
+}
+
+
+/**
+ * @brief Start sampling /proc/meminfo in a background thread.
+ *
+ * The first sample is taken before this returns, so 
+ * \ref sysmon_memory_used is valid right away.  Calls 
+ * nest; each needs a matching \ref sysmon_sampler_stop.
+ *
+ * @param interval     @input Seconds between samples.
+ * @param debug_level  @input Log each sample at this (debug) level.
+ */
+int sysmon_sampler_start(
+		const double interval,
+		const log_level debug_level)
+{
+	int rc = 0;
+
+	pthread_mutex_lock(&sampler_mutex);
+	if (sampler_users++ > 0) {
+		goto cleanup;
+	}
+
+	sampler_interval = (interval > 0.0)? interval : SYSMON_SAMPLE_INTERVAL;
+	sampler_debug_level = debug_level;
+	sampler_stop = 0;
+
+	take_sample();
+
+	rc = pthread_create(&sampler_thread, NULL, sampler_run, NULL);
+	if (rc != 0) {
+		log_error(debug_level, "could not start the memory sampler: %s",
+				strerror(rc));
+		sampler_users = 0;
+	}
+
+cleanup:
+	pthread_mutex_unlock(&sampler_mutex);
+	return rc;
+}
+
+/**
+ * @brief Stop the memory sampler (when the last user stops it).
+ */
+void sysmon_sampler_stop(void)
+{
+	pthread_mutex_lock(&sampler_mutex);
+	if ((sampler_users == 0) || (--sampler_users > 0)) {
+		pthread_mutex_unlock(&sampler_mutex);
+		return;
+	}
+	sampler_stop = 1;
+	pthread_cond_signal(&sampler_cond);
+	pthread_mutex_unlock(&sampler_mutex);
+
+	pthread_join(sampler_thread, NULL);
+}
+
+/**
+ * @brief Main memory in use (kB) as of the last sample.
+ *
+ * Cheap enough to call on every request.  If the sampler
+ * is not running, this parses /proc/meminfo instead.
+ */
+unsigned long sysmon_memory_used(void)
+{
+	if (sampler_users == 0) {
+		return main_memory_used();
+	}
+	return sampled_kb_used;
+}
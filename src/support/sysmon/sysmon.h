@@ -25,6 +25,9 @@
 extern "C" {
 #endif
 
+/** @brief Default seconds between samples of the memory sampler. */
+#define SYSMON_SAMPLE_INTERVAL 0.1
+
 /* the functions */
 
 #if defined(__STDC__) || defined(__cplusplus)
@@ -32,6 +35,10 @@ extern "C" {
 void log_meminfo(const log_level debug_level);
 unsigned long main_memory_used(void);
 
+int sysmon_sampler_start(const double interval, const log_level debug_level);
+void sysmon_sampler_stop(void);
+unsigned long sysmon_memory_used(void);
+
 #endif
 
 
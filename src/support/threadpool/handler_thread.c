@@ -1,42 +1,198 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE   /* CPU_SET, pthread_setaffinity_np */
+#endif
+
+#include "config.h"
+
 #include <stdio.h>       /* standard I/O routines                     */
 #include <pthread.h>     /* pthread functions and data structures     */
+#include <sched.h>       /* cpu_set_t                                 */
 #include <stdlib.h>      /* malloc() and free()                       */
 #include <assert.h>      /* assert()                                  */
 
 #include "handler_thread.h"   /* handler thread functions/structs     */
+#include "handler_threads_pool.h"
 #include "thread_pool_debug.h"
 #include "support/logger/logger.h"
 #include "support/signal/lwfs_signal.h"
 #include "support/trace/trace.h"
 
 /*
- * function cleanup_free_mutex(): free the mutex, if it's locked.
- * input:     pointer to a mutex structure.
+ * function pop_local(): take the oldest request from a thread's
+ *                       local queue.
+ * input:     the thread's parameters.
+ * output:    the request, or NULL if the local queue is empty.
+ */
+static struct lwfs_thread_pool_request*
+pop_local(struct handler_thread_params* data)
+{
+    struct lwfs_thread_pool_request* a_request = NULL;
+
+    /* quick look without the lock (the owner and thieves only remove) */
+    if (data->local_count == 0) {
+	return NULL;
+    }
+
+    pthread_mutex_lock(&data->local_mutex);
+    if (data->local_count > 0) {
+	a_request = data->local[data->local_head];
+	data->local_head = (data->local_head + 1) % LOCAL_QUEUE_MAX;
+	data->local_count--;
+    }
+    pthread_mutex_unlock(&data->local_mutex);
+
+    return a_request;
+}
+
+/*
+ * function local_work_pending(): check if any thread has requests
+ *                                in its local queue.
+ * algorithm: reads the counters without the local locks.  The caller
+ *            holds the request mutex, and push_local() callers take
+ *            it after the push to wake an idle thread, so a push we
+ *            miss here wakes us once we wait.
+ * input:     the thread's parameters.
+ * output:    1 if some thread has local requests, 0 otherwise.
+ */
+static int
+local_work_pending(struct handler_thread_params* data)
+{
+    int i;
+    int num_workers = data->threads->num_workers;
+    struct handler_thread_params* worker;
+
+    for (i=0; i<num_workers; i++) {
+	worker = data->threads->workers[i];
+	if ((worker != NULL) && (worker->local_count > 0)) {
+	    return 1;
+	}
+    }
+
+    return 0;
+}
+
+/*
+ * function wake_idle_thread(): wake a thread to steal local requests.
+ * input:     the thread's parameters.
+ * output:    none.
+ */
+static void
+wake_idle_thread(struct handler_thread_params* data)
+{
+    pthread_mutex_lock(data->request_mutex);
+    if (data->requests->num_idle > 0) {
+	pthread_cond_signal(data->got_request);
+    }
+    pthread_mutex_unlock(data->request_mutex);
+}
+
+/*
+ * function push_local(): append requests to the thread's local queue
+ *                        and wake an idle thread to steal them.
+ * input:     the thread's parameters, the requests, how many.
+ * output:    none.
+ */
+static void
+push_local(struct handler_thread_params* data,
+	   struct lwfs_thread_pool_request** reqs, int count)
+{
+    int i;
+
+    pthread_mutex_lock(&data->local_mutex);
+    assert(data->local_count + count <= LOCAL_QUEUE_MAX);
+    for (i=0; i<count; i++) {
+	data->local[(data->local_head + data->local_count) % LOCAL_QUEUE_MAX] = reqs[i];
+	data->local_count++;
+    }
+    pthread_mutex_unlock(&data->local_mutex);
+
+    wake_idle_thread(data);
+}
+
+/*
+ * function steal_request(): take a request another thread took
+ *                           from the shared queue but did not start.
+ * algorithm: looks at the other threads in turn, starting with the
+ *            next one, and takes the oldest request it finds (so the
+ *            order the shared queue chose is mostly kept).
+ * input:     the thread's parameters.
+ * output:    the request, or NULL if nobody has one to spare.
+ */
+static struct lwfs_thread_pool_request*
+steal_request(struct handler_thread_params* data)
+{
+    int i;
+    int num_workers = data->threads->num_workers;
+    struct handler_thread_params* victim;
+    struct lwfs_thread_pool_request* a_request;
+
+    for (i=1; i<num_workers; i++) {
+	victim = data->threads->workers[(data->thread_id + i) % num_workers];
+	if ((victim == NULL) || (victim == data)) {
+	    continue;
+	}
+	a_request = pop_local(victim);
+	if (a_request) {
+	    data->stolen++;
+	    return a_request;
+	}
+    }
+
+    return NULL;
+}
+
+/*
+ * function pin_thread(): run the thread on one CPU, if asked to.
+ * input:     the thread's parameters.
  * output:    none.
  */
 static void
-cleanup_free_mutex(void* a_mutex)
+pin_thread(struct handler_thread_params* data)
 {
-    pthread_mutex_t* p_mutex = (pthread_mutex_t*)a_mutex;
+#ifdef HAVE_PTHREAD_SETAFFINITY_NP
+    cpu_set_t cpus;
 
-    if (p_mutex)
-        pthread_mutex_unlock(p_mutex);
+    if (data->cpu < 0) {
+	return;
+    }
+
+    CPU_ZERO(&cpus);
+    CPU_SET(data->cpu, &cpus);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus) != 0) {
+	log_warn(thread_debug_level, "thread '%d' could not run on cpu %d",
+		 data->thread_id, data->cpu);
+    }
+    else {
+	log_debug(thread_debug_level, "thread '%d' runs on cpu %d",
+		  data->thread_id, data->cpu);
+    }
+#else
+    if (data->cpu >= 0) {
+	log_warn(thread_debug_level, "cannot pin threads to cpus on this system");
+    }
+#endif
 }
 
 /*
- * function handle_requests_loop(): infinite loop of requests handling
- * algorithm: forever, if there are requests to handle, take the first
- *            and handle it. Then wait on the given condition variable,
- *            and when it is signaled, re-do the loop.
- *            increases number of pending requests by one.
- * input:     id of thread, for printing purposes.
+ * function handle_requests_loop(): loop of requests handling
+ * algorithm: take the next request from the local queue; if it is
+ *            empty, take a batch of requests from the shared queue
+ *            (waking an idle thread to help with the rest); if that
+ *            is empty too, steal a request from another thread.
+ *            With no work anywhere (shared or local queues), wait on
+ *            the given condition variable.  The thread exits when the
+ *            pool shuts down (after the queues drain), when asked to
+ *            retire, or on lwfs_exit_now() (after handling the
+ *            requests in its local queue).
+ * input:     the thread's parameters.
  * output:    none.
  */
 void*
 handle_requests_loop(void* thread_params)
 {
-	int rc;	                    /* return code of pthreads functions.  */
+	int count;
 	struct lwfs_thread_pool_request* a_request;   /* pointer to a request. */
+	struct lwfs_thread_pool_request* batch[LOCAL_QUEUE_MAX];
 	struct handler_thread_params *data;
 	/* hadler thread's parameters */
 
@@ -45,71 +201,75 @@ handle_requests_loop(void* thread_params)
 	assert(data);
 
 	lwfs_thread_pool_setrank(data->thread_id+1);
-	data->requests->id = data->thread_id+1; 
+	data->requests->id = data->thread_id+1;
 
-	log_debug(thread_debug_level, "Starting thread. thread_pool id is '%d'.  Assigned rank is '%d'.\n", 
+	log_debug(thread_debug_level, "Starting thread. thread_pool id is '%d'.  Assigned rank is '%d'.\n",
 		data->thread_id, lwfs_thread_pool_getrank());
 
-	/* set my cancel state to 'enabled', and cancel type to 'defered'. */
-	pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
-	pthread_setcanceltype(PTHREAD_CANCEL_DEFERRED, NULL);
-
-	/* set thread cleanup handler */
-	pthread_cleanup_push(cleanup_free_mutex, (void*)data->request_mutex);
-
-	/* lock the mutex, to access the requests list exclusively. */
-	rc = pthread_mutex_lock(data->request_mutex);
+	pin_thread(data);
 
 	/* do forever.... */
 	while (!lwfs_exit_now()) {
 
-		int num_requests = get_requests_number(data->requests);
-
-		if (num_requests > 0) { /* a request is pending */
-			a_request = get_request(data->requests);
-			if (a_request) { 
+		/* finish what we took before we go */
+		if (data->retire && (data->local_count == 0)) {
+			break;
+		}
 
-				/* got a request - handle it and free it */
-				/* unlock mutex - so other threads would be able to handle */
-				/* other reqeusts waiting in the queue paralelly.          */
-				rc = pthread_mutex_unlock(data->request_mutex);
+		a_request = pop_local(data);
 
-				//log_debug(thread_debug_level, "thread '%d' processing request", data->thread_id);
-				a_request->handler(a_request, lwfs_thread_pool_getrank());
-				free(a_request);
+		if (!a_request) {
+			count = get_requests(data->requests, batch, data->batch_size);
+			if (count > 0) {
+				a_request = batch[0];
+				if (count > 1) {
+					/* an idle thread can steal the rest */
+					push_local(data, &batch[1], count-1);
+				}
+			}
+		}
 
-				/* and lock the mutex again. */
-				rc = pthread_mutex_lock(data->request_mutex);
+		if (!a_request) {
+			a_request = steal_request(data);
+		}
 
-				/* ADDED BY RON --- wake threads, just in case we missed a signal */
-				//pthread_cond_broadcast(data->got_request); 
-				/* END ADDED BY RON */
-			}
+		if (a_request) {
+			/* got a request - handle it and free it */
+			//log_debug(thread_debug_level, "thread '%d' processing request", data->thread_id);
+			a_request->handler(a_request, lwfs_thread_pool_getrank());
+			free(a_request);
+			data->processed++;
+			continue;
 		}
-		else {
-			/* the thread checks the flag before waiting            */
+
+		/* nothing to do: wait for a request to arrive (a thread 
+		 * busy with a long request may still have some for us). */
+		pthread_mutex_lock(data->request_mutex);
+		if ((data->requests->num_requests == 0) && !local_work_pending(data)) {
+			/* the thread checks the flags before waiting           */
 			/* on the condition variable.                           */
 			/* if no new requests are going to be generated, exit.  */
-			if (*data->shutdown_now) {
-				goto cleanup;
+			if (*data->shutdown_now || data->retire) {
+				pthread_mutex_unlock(data->request_mutex);
+				break;
 			}
-			/* wait for a request to arrive. note the mutex will be */
-			/* unlocked here, thus allowing other threads access to */
-			/* requests list.                                       */
-			rc = pthread_cond_wait(data->got_request, data->request_mutex);
-			/* and after we return from pthread_cond_wait, the mutex  */
-			/* is locked again, so we don't need to lock it ourselves */
+			data->requests->num_idle++;
+			pthread_cond_wait(data->got_request, data->request_mutex);
+			data->requests->num_idle--;
 		}
+		pthread_mutex_unlock(data->request_mutex);
 	}
 
-cleanup:
-	pthread_mutex_unlock(data->request_mutex);
-
-	/* remove thread cleanup handler. never reached, but we must use */
-	/* it here, according to pthread_cleanup_push's manual page.     */
-	pthread_cleanup_pop(0);
+	/* lwfs_exit_now() ends the loop early: the requests we took 
+	 * from the shared queue still need an answer */
+	while ((a_request = pop_local(data)) != NULL) {
+		a_request->handler(a_request, lwfs_thread_pool_getrank());
+		free(a_request);
+		data->processed++;
+	}
 
-	log_debug(thread_debug_level, "thread '%d' exiting\n", data->thread_id);
+	log_debug(thread_debug_level, "thread '%d' exiting (processed=%ld, stolen=%ld)\n",
+		data->thread_id, data->processed, data->stolen);
 
 	return NULL;
 }
@@ -7,6 +7,9 @@
 #include "requests_queue.h"
 #include "thread_pool.h"
 
+/* most requests a handler thread takes from the shared queue at once */
+#define LOCAL_QUEUE_MAX 32
+
 /* handler thread parameters structure.                      */
 /* this is used to pass a thread several parameters,         */
 /* even thought a thread's function gets only one parameter. */
@@ -17,6 +20,22 @@ struct handler_thread_params {
     struct requests_queue* requests;    /* queue of pending requests.      */
     int *shutdown_now;                  /* flag indicating if this pool is done working */
     request_handler_proc handler;
+    struct handler_threads_pool* threads; /* the other threads (to steal from) */
+
+    int batch_size;                     /* requests to take from the shared queue */
+    int cpu;                            /* CPU to run on (-1 = any)        */
+    volatile int retire;                /* set to ask the thread to exit   */
+
+    /* requests this thread took from the shared queue but did not
+     * start yet (other threads may steal them) */
+    pthread_mutex_t local_mutex;
+    struct lwfs_thread_pool_request* local[LOCAL_QUEUE_MAX];
+    int local_head;
+    int local_count;
+
+    /* counters (only this thread writes them) */
+    long processed;                     /* requests handled                */
+    long stolen;                        /* requests taken from other threads */
 };
 
 /* a handler thread's main loop function */
@@ -1,6 +1,7 @@
 #include <stdio.h>              /* standard I/O routines                    */
 #include <pthread.h>            /* pthread functions and data structures    */
 #include <stdlib.h>             /* malloc() and free()                      */
+#include <unistd.h>             /* sysconf()                                */
 #include <assert.h>      /* assert()                                  */
 #include "thread_pool_debug.h"
 
@@ -16,7 +17,7 @@ init_handler_threads_pool(pthread_mutex_t* p_mutex,
 			  struct requests_queue* requests)
 {
     struct handler_threads_pool* pool =
-      (struct handler_threads_pool*)malloc(sizeof(struct handler_threads_pool));
+      (struct handler_threads_pool*)calloc(1, sizeof(struct handler_threads_pool));
 
     if (!pool) {
 	fprintf(stderr, "init_handler_threads_pool: out of memory. exiting\n");
@@ -26,7 +27,9 @@ init_handler_threads_pool(pthread_mutex_t* p_mutex,
     pool->threads = NULL;
     pool->last_thread = NULL;
     pool->num_threads = 0;
+    pool->num_retired = 0;
     pool->max_thr_id = 0;
+    pool->num_workers = 0;
     pool->p_mutex = p_mutex;
     pool->p_cond_var = p_cond_var;
     pool->requests = requests;
@@ -44,6 +47,12 @@ add_handler_thread(lwfs_thread_pool* pool)
     /* sanity check */
     assert(pool);
 
+    if (pool->handler_threads->num_workers >= MAX_WORKERS) {
+	log_warn(thread_debug_level, "pool already has %d threads, not adding more",
+		 MAX_WORKERS);
+	return;
+    }
+
     /* create the new thread's structure and initialize it */
     a_thread = (struct handler_thread*)calloc(1,sizeof(struct handler_thread));
     if (!a_thread) {
@@ -55,7 +64,7 @@ add_handler_thread(lwfs_thread_pool* pool)
 
     /* create the thread's parameters structure */
     params = (struct handler_thread_params*)
-	                           malloc(sizeof(struct handler_thread_params));
+	                           calloc(1, sizeof(struct handler_thread_params));
     if (!params) {
 	fprintf(stderr, "add_handler_thread: out of memory. exiting\n");
 	exit(1);
@@ -65,9 +74,25 @@ add_handler_thread(lwfs_thread_pool* pool)
     params->got_request = pool->handler_threads->p_cond_var;
     params->requests = pool->handler_threads->requests;
     params->shutdown_now = &pool->shutdown_now;
+    params->threads = pool->handler_threads;
+    params->batch_size = pool->args.batch_size;
+    params->cpu = -1;
+    if (pool->args.pin_threads) {
+	long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+	if (ncpus > 0) {
+	    params->cpu = a_thread->thr_id % ncpus;
+	}
+    }
+    pthread_mutex_init(&params->local_mutex, NULL);
 
 	a_thread->params = params; 
 
+    /* let the other threads steal from this one (fill in the
+     * entry before anyone can see it) */
+    pool->handler_threads->workers[pool->handler_threads->num_workers] = params;
+    __sync_synchronize();
+    pool->handler_threads->num_workers++;
+
     /* spawn the thread, and place its ID in the thread's structure */
     pthread_create(&a_thread->thread,
 		   NULL,
@@ -107,21 +132,30 @@ remove_first_handler_thread(lwfs_thread_pool* pool)
     return a_thread;
 }
 
-/* delete the first thread from the threads pool (and cancel the thread) */
+/*
+ * ask a thread to exit.  it finishes the requests it already took
+ * (no cancellation, so no request is abandoned half done); the
+ * thread is joined when the pool goes away.
+ */
 void
 delete_handler_thread(lwfs_thread_pool* pool)
 {
-	struct handler_thread* a_thread; /* the thread to cancel */
+	struct handler_thread* a_thread; /* the thread to retire */
 
 	/* sanity check */
 	assert(pool);
 
-	a_thread = remove_first_handler_thread(pool);
-	if (a_thread) {
-		log_debug(thread_debug_level, "Removing thread '%d'\n",a_thread->thr_id);
-		pthread_cancel(a_thread->thread);
-		free(a_thread);
+	pthread_mutex_lock(&pool->request_mutex);
+	for (a_thread = pool->handler_threads->threads; a_thread; a_thread = a_thread->next) {
+		if (!a_thread->params->retire) {
+			log_debug(thread_debug_level, "Retiring thread '%d'\n",a_thread->thr_id);
+			a_thread->params->retire = 1;
+			pool->handler_threads->num_retired++;
+			pthread_cond_broadcast(&pool->got_request);
+			break;
+		}
 	}
+	pthread_mutex_unlock(&pool->request_mutex);
 }
 
 /* get the number of handler threads currently in the threads pool */
@@ -131,7 +165,7 @@ get_handler_threads_number(lwfs_thread_pool* pool)
     /* sanity check */
     assert(pool);
 
-    return pool->handler_threads->num_threads;
+    return pool->handler_threads->num_threads - pool->handler_threads->num_retired;
 }
 
 
@@ -156,12 +190,23 @@ cancel_handler_threads(lwfs_thread_pool* pool)
     pthread_mutex_unlock(&pool->request_mutex);
 
     /* use pthread_join() to wait for all threads to terminate. */
+	for (a_thread = pool->handler_threads->threads; a_thread; a_thread = a_thread->next) {
+		pthread_join(a_thread->thread, &thr_retval);
+	}
+
+    /* now nobody steals from anybody, free the threads */
+    pool->handler_threads->num_workers = 0;
 	while (pool->handler_threads->num_threads > 0) {
 		a_thread = remove_first_handler_thread(pool);
 		assert(a_thread);	/* sanity check */
 
-		/* wait for thread to complete */
-		pthread_join(a_thread->thread, &thr_retval);
+		/* drop requests the thread did not get to (lwfs_exit_now) */
+		while (a_thread->params->local_count > 0) {
+			free(a_thread->params->local[a_thread->params->local_head]);
+			a_thread->params->local_head = (a_thread->params->local_head + 1) % LOCAL_QUEUE_MAX;
+			a_thread->params->local_count--;
+		}
+		pthread_mutex_destroy(&a_thread->params->local_mutex);
 
 		/* free the params structure */
 		free(a_thread->params);
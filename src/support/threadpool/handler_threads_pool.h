@@ -17,12 +17,23 @@ struct handler_thread {
     struct handler_thread* next;   /* pointer to next thread, NULL if none. */
 };
 
+/* most handler threads a pool ever starts */
+#define MAX_WORKERS 256
+
 /* structure for a handler threads pool */
 struct handler_threads_pool {
     struct handler_thread* threads;     /* head of linked list of threads.  */
     struct handler_thread* last_thread; /* pointer to last thread.          */
     int num_threads;		        /* number of threads in pool.       */
+    int num_retired;                    /* threads asked to exit (not joined) */
     int max_thr_id;			/* maximal thread 'id' used so far. */
+
+    /* parameters of every thread started (threads steal from
+     * each other through these; entries are never removed
+     * before the pool goes away) */
+    struct handler_thread_params* workers[MAX_WORKERS];
+    volatile int num_workers;
+
     pthread_mutex_t* p_mutex;	        /* pool's mutex.                    */
     pthread_cond_t*  p_cond_var;        /* pool's condition variable.       */
     struct requests_queue* requests;    /* requests queue                   */
@@ -40,7 +51,7 @@ init_handler_threads_pool(pthread_mutex_t* p_mutex,
 /* spawn a new handler thread and add it to the threads pool. */
 void add_handler_thread(lwfs_thread_pool* pool);
 
-/* delete the first thread from the threads pool (and cancel the thread) */
+/* ask a thread to exit when it finishes its current request */
 void
 delete_handler_thread(lwfs_thread_pool* pool);
 
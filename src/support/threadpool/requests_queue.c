@@ -1,12 +1,21 @@
 #include <stdlib.h>      /* malloc() and free()                       */
+#include <string.h>      /* memcpy()                                  */
 #include <assert.h>      /* assert()                                  */
 
 #include "requests_queue.h"      /* requests queue functions and structs */
 #include "thread_pool_debug.h"
 #include "support/logger/logger.h"
 #include "support/trace/trace.h"
+#include "support/timer/timer.h"
 
 
+/* stride of a class with weight 1 (see get_request) */
+#define STRIDE1 (1 << 20)
+
+/* default weights of the classes */
+#define METADATA_WEIGHT 4
+#define BULK_WEIGHT 1
+
 /*
  * function init_requests_queue(): create a requests queue.
  * algorithm: creates a request queue structure, initialize with given
@@ -18,71 +27,243 @@ struct requests_queue*
 init_requests_queue(pthread_mutex_t* p_mutex, pthread_cond_t*  p_cond_var)
 {
     struct requests_queue* queue =
-		(struct requests_queue*)malloc(sizeof(struct requests_queue));
+		(struct requests_queue*)calloc(1, sizeof(struct requests_queue));
     if (!queue) {
 	fprintf(stderr, "out of memory. exiting\n");
 	exit(1);
     }
     /* initialize queue */
-    queue->requests = NULL;
-    queue->last_request = NULL;
     queue->num_requests = 0;
+    queue->num_idle = 0;
+    queue->pass = 0;
     queue->p_mutex = p_mutex;
     queue->p_cond_var = p_cond_var;
 
+    queue->classes[LWFS_TP_CLASS_METADATA].weight = METADATA_WEIGHT;
+    queue->classes[LWFS_TP_CLASS_BULK].weight = BULK_WEIGHT;
 
     return queue;
 }
 
+/*
+ * function set_request_class_weight(): set the share of a class.
+ * algorithm: a class with weight w gets w/W of the requests handed
+ *            to threads (W is the sum of the weights of the classes
+ *            with pending requests).
+ * input:     pointer to queue, class, weight (>0).
+ * output:    none.
+ */
+void
+set_request_class_weight(struct requests_queue* queue, int req_class, int weight)
+{
+    assert(queue);
+
+    if ((req_class < 0) || (req_class >= LWFS_TP_NUM_CLASSES) || (weight < 1)) {
+	return;
+    }
+
+    pthread_mutex_lock(queue->p_mutex);
+    queue->classes[req_class].weight = weight;
+    pthread_mutex_unlock(queue->p_mutex);
+}
+
+/* hash a client id to a bucket */
+static int
+client_hash(uint64_t client)
+{
+    return (int)((client ^ (client >> 32) ^ (client >> 7)) % CLIENT_HASH_SIZE);
+}
+
 /*
  * function add_request(): add a request to the requests list
- * algorithm: creates a request structure, adds to the list, and
- *            increases number of pending requests by one.
- * input:     pointer to queue, request number.
+ * algorithm: appends the request to the queue of its client in its
+ *            class (making the client active if it had no requests),
+ *            and increases number of pending requests by one.
+ * input:     pointer to queue, request.
  * output:    none.
  */
 void
 add_request(struct requests_queue* queue, struct lwfs_thread_pool_request *a_request)
 {
     int rc;	                    /* return code of pthreads functions.  */
+    int bucket;
+    struct request_class* cls;
+    struct client_queue* cq;
 
     /* sanity check - amke sure queue is not NULL */
     assert(queue);
 
     a_request->next = NULL;
+    if ((a_request->req_class < 0) || (a_request->req_class >= LWFS_TP_NUM_CLASSES)) {
+	a_request->req_class = LWFS_TP_CLASS_METADATA;
+    }
+    a_request->enqueue_time = lwfs_get_time();
 
     /* lock the mutex, to assure exclusive access to the list */
     rc = pthread_mutex_lock(queue->p_mutex);
 
-    /* add new request to the end of the list, updating list */
-    /* pointers as required */
-    if (queue->num_requests == 0) { /* special case - list is empty */
-	queue->requests = a_request;
-	queue->last_request = a_request;
+    cls = &queue->classes[a_request->req_class];
+
+    /* a class that was idle does not get credit for the time it was idle */
+    if ((cls->num_requests == 0) && (cls->pass < queue->pass)) {
+	cls->pass = queue->pass;
+    }
+
+    /* find the client's queue */
+    bucket = client_hash(a_request->client);
+    for (cq = cls->hash[bucket]; cq != NULL; cq = cq->next_hash) {
+	if (cq->client == a_request->client) {
+	    break;
+	}
+    }
+
+    if (cq == NULL) { /* first pending request of this client */
+	if (cls->idle != NULL) {
+	    cq = cls->idle;
+	    cls->idle = cq->next_hash;
+	}
+	else {
+	    cq = (struct client_queue*)malloc(sizeof(struct client_queue));
+	    if (!cq) {
+		fprintf(stderr, "out of memory. exiting\n");
+		exit(1);
+	    }
+	}
+	cq->client = a_request->client;
+	cq->requests = NULL;
+	cq->last_request = NULL;
+	cq->next_active = NULL;
+	cq->next_hash = cls->hash[bucket];
+	cls->hash[bucket] = cq;
+
+	/* the client waits its turn behind the other active clients */
+	if (cls->active == NULL) {
+	    cls->active = cq;
+	}
+	else {
+	    cls->last_active->next_active = cq;
+	}
+	cls->last_active = cq;
+	cls->stats.clients++;
+    }
+
+    /* add new request to the end of the client's list */
+    if (cq->requests == NULL) {
+	cq->requests = a_request;
     }
     else {
-	queue->last_request->next = a_request;
-	queue->last_request = a_request;
+	cq->last_request->next = a_request;
     }
+    cq->last_request = a_request;
 
     /* increase total number of pending requests by one. */
+    cls->num_requests++;
+    cls->stats.requests++;
+    if (cls->num_requests > cls->stats.max_depth) {
+	cls->stats.max_depth = cls->num_requests;
+    }
     queue->num_requests++;
     trace_inc_count(TRACE_PENDING_REQS, queue->id, "pending++");
 
     //log_debug(thread_debug_level, "add_request: added request with id '%d'\n", a_request->number);
 
-    /* signal the condition variable - there's a new request to handle */
-    rc = pthread_cond_signal(queue->p_cond_var);
+    /* wake a thread if one is waiting (busy threads look at the
+     * queue again before they wait, so they will find the request) */
+    if (queue->num_idle > 0) {
+	rc = pthread_cond_signal(queue->p_cond_var);
+    }
 
     /* unlock mutex */
     rc = pthread_mutex_unlock(queue->p_mutex);
 }
 
 /*
- * function get_request(): gets the first pending request from the requests list
+ * function dequeue_request(): removes the next pending request.
+ * algorithm: stride scheduling picks the class (the class with
+ *            pending requests and the smallest pass; its pass then
+ *            advances by STRIDE1/weight).  Within the class, clients
+ *            take turns, one request each.
+ * input:     pointer to requests queue (locked by the caller).
+ * output:    pointer to the removed request, or NULL if none.
+ */
+static struct lwfs_thread_pool_request*
+dequeue_request(struct requests_queue* queue)
+{
+    int i;
+    double wait;
+    struct lwfs_thread_pool_request* a_request = NULL;  /* pointer to request. */
+    struct request_class* cls = NULL;
+    struct client_queue* cq;
+    struct client_queue** link;
+
+    if (queue->num_requests == 0) { /* requests list is empty */
+	return NULL;
+    }
+
+    /* pick the class */
+    for (i=0; i<LWFS_TP_NUM_CLASSES; i++) {
+	if ((queue->classes[i].num_requests > 0) &&
+	    ((cls == NULL) || (queue->classes[i].pass < cls->pass))) {
+	    cls = &queue->classes[i];
+	}
+    }
+    assert(cls);
+
+    queue->pass = cls->pass;
+    cls->pass += STRIDE1/cls->weight;
+
+    /* take the first request of the first active client */
+    cq = cls->active;
+    a_request = cq->requests;
+    cq->requests = a_request->next;
+    a_request->next = NULL;
+
+    cls->active = cq->next_active;
+    if (cls->active == NULL) {
+	cls->last_active = NULL;
+    }
+    cq->next_active = NULL;
+
+    if (cq->requests != NULL) {
+	/* back of the line */
+	if (cls->active == NULL) {
+	    cls->active = cq;
+	}
+	else {
+	    cls->last_active->next_active = cq;
+	}
+	cls->last_active = cq;
+    }
+    else {
+	/* no more requests from this client, forget it */
+	cq->last_request = NULL;
+	link = &cls->hash[client_hash(cq->client)];
+	while (*link != cq) {
+	    link = &(*link)->next_hash;
+	}
+	*link = cq->next_hash;
+	cq->next_hash = cls->idle;
+	cls->idle = cq;
+	cls->stats.clients--;
+    }
+
+    /* decrease the total number of pending requests */
+    cls->num_requests--;
+    queue->num_requests--;
+    trace_dec_count(TRACE_PENDING_REQS, queue->id, "pending--");
+
+    wait = lwfs_get_time() - a_request->enqueue_time;
+    cls->stats.total_wait += wait;
+    if (wait > cls->stats.max_wait) {
+	cls->stats.max_wait = wait;
+    }
+
+    return a_request;
+}
+
+/*
+ * function get_request(): gets the next pending request,
  *                         removing it from the list.
- * algorithm: creates a request structure, adds to the list, and
- *            increases number of pending requests by one.
  * input:     pointer to requests queue.
  * output:    pointer to the removed request, or NULL if none.
  * memory:    the returned request need to be freed by the caller.
@@ -99,19 +280,7 @@ get_request(struct requests_queue* queue)
     /* lock the mutex, to assure exclusive access to the list */
     rc = pthread_mutex_lock(queue->p_mutex);
 
-    if (queue->num_requests > 0) {
-	a_request = queue->requests;
-	queue->requests = a_request->next;
-	if (queue->requests == NULL) { /* this was last request on the list */
-	    queue->last_request = NULL;
-	}
-	/* decrease the total number of pending requests */
-	queue->num_requests--;
-	trace_dec_count(TRACE_PENDING_REQS, queue->id, "pending--");
-    }
-	else { /* requests list is empty */
-		a_request = NULL;
-	}
+    a_request = dequeue_request(queue);
 
     /* unlock mutex */
     rc = pthread_mutex_unlock(queue->p_mutex);
@@ -120,6 +289,35 @@ get_request(struct requests_queue* queue)
     return a_request;
 }
 
+/*
+ * function get_requests(): gets up to max pending requests (one lock
+ *                          for all of them).
+ * input:     pointer to requests queue, where to put the requests, max.
+ * output:    number of requests removed.
+ * memory:    the returned requests need to be freed by the caller.
+ */
+int
+get_requests(struct requests_queue* queue, struct lwfs_thread_pool_request **reqs, int max)
+{
+    int rc;	                    /* return code of pthreads functions.  */
+    int count = 0;
+
+    /* sanity check - amke sure queue is not NULL */
+    assert(queue);
+
+    /* lock the mutex, to assure exclusive access to the list */
+    rc = pthread_mutex_lock(queue->p_mutex);
+
+    while ((count < max) && ((reqs[count] = dequeue_request(queue)) != NULL)) {
+	count++;
+    }
+
+    /* unlock mutex */
+    rc = pthread_mutex_unlock(queue->p_mutex);
+
+    return count;
+}
+
 /*
  * function get_requests_number(): get the number of requests in the list.
  * input:     pointer to requests queue.
@@ -145,6 +343,25 @@ get_requests_number(struct requests_queue* queue)
     return num_requests;
 }
 
+/*
+ * function get_request_class_stats(): get the counters of a class.
+ * input:     pointer to requests queue, class, where to put the counters.
+ * output:    none.
+ */
+void
+get_request_class_stats(struct requests_queue* queue, int req_class,
+                        struct lwfs_thread_pool_class_stats *stats)
+{
+    assert(queue);
+    assert((req_class >= 0) && (req_class < LWFS_TP_NUM_CLASSES));
+
+    pthread_mutex_lock(queue->p_mutex);
+    memcpy(stats, &queue->classes[req_class].stats,
+	   sizeof(struct lwfs_thread_pool_class_stats));
+    stats->depth = queue->classes[req_class].num_requests;
+    pthread_mutex_unlock(queue->p_mutex);
+}
+
 /*
  * function delete_requests_queue(): delete a requests queue.
  * algorithm: delete a request queue structure, and free all memory it uses.
@@ -155,6 +372,8 @@ void
 delete_requests_queue(struct requests_queue* queue)
 {
     struct lwfs_thread_pool_request* a_request;      /* pointer to a request.               */
+    struct client_queue* cq;
+    int i;
 
     /* sanity check - amke sure queue is not NULL */
     assert(queue);
@@ -165,6 +384,15 @@ delete_requests_queue(struct requests_queue* queue)
 		free(a_request);
 	}
 
+    /* then the client queues (all idle now) */
+    for (i=0; i<LWFS_TP_NUM_CLASSES; i++) {
+	while (queue->classes[i].idle != NULL) {
+	    cq = queue->classes[i].idle;
+	    queue->classes[i].idle = cq->next_hash;
+	    free(cq);
+	}
+    }
+
     /* finally, free the queue's struct itself */
     free(queue);
 }
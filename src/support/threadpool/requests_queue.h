@@ -6,12 +6,40 @@
 
 #include "thread_pool.h"
 
+/* buckets in the hash of clients (per class) */
+#define CLIENT_HASH_SIZE 64
+
+/* pending requests of one client in one class */
+struct client_queue {
+    uint64_t client;                                 /* who sent the requests            */
+    struct lwfs_thread_pool_request* requests;       /* head of the client's requests    */
+    struct lwfs_thread_pool_request* last_request;   /* tail of the client's requests    */
+    struct client_queue* next_active;                /* next client with requests        */
+    struct client_queue* next_hash;                  /* next client in the hash bucket   */
+};
+
+/* one class of requests (e.g., metadata or bulk data) */
+struct request_class {
+    int weight;                      /* share of the threads (relative)  */
+    unsigned long pass;              /* stride scheduling: virtual time  */
+    int num_requests;                /* number of requests in the class  */
+
+    /* clients with pending requests, served round robin */
+    struct client_queue* active;
+    struct client_queue* last_active;
+    struct client_queue* hash[CLIENT_HASH_SIZE];
+    struct client_queue* idle;       /* unused client queues             */
+
+    struct lwfs_thread_pool_class_stats stats;
+};
+
 /* structure for a requests queue */
 struct requests_queue {
-    struct lwfs_thread_pool_request* requests;       /* head of linked list of requests. */
-    struct lwfs_thread_pool_request* last_request;   /* pointer to last request.         */
     int num_requests;		    /* number of requests in queue.     */
+    int num_idle;                   /* threads waiting for a request    */
     int id;                         /* identifier for this queue        */
+    unsigned long pass;             /* pass of the last class served    */
+    struct request_class classes[LWFS_TP_NUM_CLASSES];
     pthread_mutex_t* p_mutex;	    /* queue's mutex.                   */
     pthread_cond_t*  p_cond_var;    /* queue's condition variable.      */
 };
@@ -23,18 +51,31 @@ struct requests_queue {
 extern struct requests_queue*
 init_requests_queue(pthread_mutex_t* p_mutex, pthread_cond_t*  p_cond_var);
 
+/* set the share of the threads a class of requests gets */
+extern void
+set_request_class_weight(struct requests_queue* queue, int req_class, int weight);
+
 /* add a request to the requests list */
 extern void
 add_request(struct requests_queue* queue, struct lwfs_thread_pool_request *a_request);
 
-/* get the first pending request from the requests list */
+/* get the next pending request (fair across classes and clients) */
 extern struct lwfs_thread_pool_request*
 get_request(struct requests_queue* queue);
 
+/* get up to max pending requests, in the same order as get_request */
+extern int
+get_requests(struct requests_queue* queue, struct lwfs_thread_pool_request **reqs, int max);
+
 /* get the number of requests in the list */
 extern int
 get_requests_number(struct requests_queue* queue);
 
+/* get a copy of the counters of a class */
+extern void
+get_request_class_stats(struct requests_queue* queue, int req_class,
+                        struct lwfs_thread_pool_class_stats *stats);
+
 /* free the resources taken by the given requests queue */
 extern void
 delete_requests_queue(struct requests_queue* queue);
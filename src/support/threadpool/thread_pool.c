@@ -21,6 +21,13 @@
 #define LOW_WATERMARK 3
 #define HIGH_WATERMARK 15
 
+/* requests a thread takes from the shared queue at once */
+#define BATCH_SIZE 4
+
+/* shares of the threads for the classes of requests */
+#define METADATA_WEIGHT 4
+#define BULK_WEIGHT 1
+
 /*
  *  On BSD (MacOS), pthread_mutex_t is not recursive by default, and so the static
  *  initializer here doesn't work.  Instead, we have to play a little compiler trick, 
@@ -142,7 +149,38 @@ int lwfs_thread_pool_init(lwfs_thread_pool *pool,
     	pool->args.high_watermark = pool->args.low_watermark + (HIGH_WATERMARK-LOW_WATERMARK);
     }
     
+    /* bound on the request queue (0 means no bound) */
+    pool->args.queue_high_watermark = pool_args->queue_high_watermark;
+    pool->args.queue_low_watermark  = pool_args->queue_low_watermark;
+    if (pool->args.queue_high_watermark < 0) {
+    	pool->args.queue_high_watermark = 0;
+    }
+    if ((pool->args.queue_low_watermark < 1) || 
+        (pool->args.queue_low_watermark > pool->args.queue_high_watermark)) {
+    	pool->args.queue_low_watermark = pool->args.queue_high_watermark/2;
+    }
+
+    pool->args.metadata_weight = pool_args->metadata_weight;
+    pool->args.bulk_weight     = pool_args->bulk_weight;
+    if (pool->args.metadata_weight < 1) {
+    	pool->args.metadata_weight = METADATA_WEIGHT;
+    }
+    if (pool->args.bulk_weight < 1) {
+    	pool->args.bulk_weight = BULK_WEIGHT;
+    }
+
+    pool->args.batch_size  = pool_args->batch_size;
+    pool->args.pin_threads = pool_args->pin_threads;
+    if (pool->args.batch_size < 1) {
+    	pool->args.batch_size = BATCH_SIZE;
+    }
+    if (pool->args.batch_size > LOCAL_QUEUE_MAX) {
+    	pool->args.batch_size = LOCAL_QUEUE_MAX;
+    }
+
     pool->shutdown_now = 0;
+    pool->busy = 0;
+    pool->busy_rejects = 0;
 
     /* initialize the rank key */
     init_rank_key(); 
@@ -154,6 +192,9 @@ int lwfs_thread_pool_init(lwfs_thread_pool *pool,
 
     assert(pool->requests);
 
+    set_request_class_weight(pool->requests, LWFS_TP_CLASS_METADATA, pool->args.metadata_weight);
+    set_request_class_weight(pool->requests, LWFS_TP_CLASS_BULK, pool->args.bulk_weight);
+
     /* create the handler threads list */
 	pool->handler_threads =
 		init_handler_threads_pool(&pool->request_mutex, &pool->got_request, pool->requests);
@@ -173,11 +214,43 @@ int lwfs_thread_pool_init(lwfs_thread_pool *pool,
 int lwfs_thread_pool_add_request(lwfs_thread_pool *pool,
                                  void *client_data, 
                                  request_handler_proc handler)
+{
+    return lwfs_thread_pool_add_classified_request(pool, client_data, handler,
+            LWFS_TP_CLASS_METADATA, 0);
+}
+
+int lwfs_thread_pool_add_classified_request(lwfs_thread_pool *pool,
+                                            void *client_data, 
+                                            request_handler_proc handler,
+                                            const int req_class,
+                                            const uint64_t client)
 {
     int num_requests; // number of requests waiting to be handled.
     int num_threads;  // number of active handler threads.
     
     struct lwfs_thread_pool_request *a_request;
+
+    /* backpressure: refuse work while the queue is too long */
+    if (pool->args.queue_high_watermark > 0) {
+        pthread_mutex_lock(&pool->request_mutex);
+        num_requests = pool->requests->num_requests;
+        if (pool->busy && (num_requests <= pool->args.queue_low_watermark)) {
+            log_debug(thread_debug_level, "queue drained to %d requests, accepting requests",
+                    num_requests);
+            pool->busy = 0;
+        }
+        else if (!pool->busy && (num_requests >= pool->args.queue_high_watermark)) {
+            log_debug(thread_debug_level, "queue reached %d requests, refusing requests",
+                    num_requests);
+            pool->busy = 1;
+        }
+        if (pool->busy) {
+            pool->busy_rejects++;
+            pthread_mutex_unlock(&pool->request_mutex);
+            return LWFS_TP_BUSY;
+        }
+        pthread_mutex_unlock(&pool->request_mutex);
+    }
     
     a_request=calloc(1,sizeof(struct lwfs_thread_pool_request));
     if (a_request == NULL)
@@ -187,6 +260,8 @@ int lwfs_thread_pool_add_request(lwfs_thread_pool *pool,
     }
     a_request->client_data = client_data;
     a_request->handler = handler;
+    a_request->req_class = req_class;
+    a_request->client = client;
 
     add_request(pool->requests, a_request);
 
@@ -215,6 +290,48 @@ int lwfs_thread_pool_add_request(lwfs_thread_pool *pool,
     return(0);
 }
 
+int lwfs_thread_pool_get_class_stats(lwfs_thread_pool *pool,
+                                     const int req_class,
+                                     struct lwfs_thread_pool_class_stats *stats)
+{
+    if ((req_class < 0) || (req_class >= LWFS_TP_NUM_CLASSES)) {
+        return(1);
+    }
+
+    get_request_class_stats(pool->requests, req_class, stats);
+
+    return(0);
+}
+
+void fprint_lwfs_thread_pool_stats(FILE *fp,
+                                   const char *prefix,
+                                   lwfs_thread_pool *pool)
+{
+    static const char *class_names[LWFS_TP_NUM_CLASSES] = {"metadata", "bulk"};
+    struct lwfs_thread_pool_class_stats stats;
+    int i;
+
+    for (i=0; i<LWFS_TP_NUM_CLASSES; i++) {
+        lwfs_thread_pool_get_class_stats(pool, i, &stats);
+
+        fprintf(fp, "%s %s requests (weight=%d):\n", prefix, class_names[i],
+                (i == LWFS_TP_CLASS_BULK)? pool->args.bulk_weight : pool->args.metadata_weight);
+        fprintf(fp, "%s   queued = %ld\n", prefix, stats.requests);
+        fprintf(fp, "%s   queue depth = %d (max %d)\n", prefix, stats.depth, stats.max_depth);
+        fprintf(fp, "%s   waiting clients = %d\n", prefix, stats.clients);
+        fprintf(fp, "%s   avg wait = %g sec\n", prefix,
+                (stats.requests > 0)? stats.total_wait/stats.requests : 0.0);
+        fprintf(fp, "%s   max wait = %g sec\n", prefix, stats.max_wait);
+    }
+
+    for (i=0; i<pool->handler_threads->num_workers; i++) {
+        struct handler_thread_params *params = pool->handler_threads->workers[i];
+        fprintf(fp, "%s thread %d: processed = %ld, stolen = %ld%s\n", prefix,
+                params->thread_id, params->processed, params->stolen,
+                (params->retire)? " (retired)" : "");
+    }
+}
+
 int lwfs_thread_pool_fini(lwfs_thread_pool *pool)
 {
     /* cancel threads and wait for completion */
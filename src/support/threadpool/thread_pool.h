@@ -2,6 +2,7 @@
 # define THREAD_POOL_H
 
 #include <pthread.h>           /* pthread functions and data structures      */
+#include <stdint.h>            /* uint64_t                                   */
 #include "thread_pool_options.h"
 
 enum tp_trace_ids {
@@ -9,6 +10,30 @@ enum tp_trace_ids {
 };
 
 
+/**
+ * @brief Classes of requests.
+ *
+ * Each class gets a share of the threads in proportion to its
+ * weight (see \ref thread_pool_options), so a flood of bulk
+ * transfers does not starve small metadata requests.
+ */
+#define LWFS_TP_CLASS_METADATA 0
+#define LWFS_TP_CLASS_BULK     1
+#define LWFS_TP_NUM_CLASSES    2
+
+/**
+ * @brief Counters kept by the pool for each class of requests.
+ */
+struct lwfs_thread_pool_class_stats {
+    long requests;      /* requests queued so far                  */
+    int depth;          /* requests in the queue now               */
+    int max_depth;      /* most requests ever in the queue         */
+    int clients;        /* clients with requests in the queue now  */
+    double total_wait;  /* time requests spent in the queue (sec)  */
+    double max_wait;    /* longest time a request waited (sec)     */
+};
+
+
 typedef struct {
     /* global mutex for our program. */
     pthread_mutex_t request_mutex;
@@ -20,6 +45,12 @@ typedef struct {
     
     int shutdown_now;
 
+    /* set while the request queue is above its high watermark */
+    int busy;
+
+    /* number of requests turned away while busy */
+    long busy_rejects;
+
     struct requests_queue*       requests;         /* pointer to requests queue */
     struct handler_threads_pool* handler_threads;  /* list of handler threads */
 } lwfs_thread_pool;
@@ -30,6 +61,9 @@ struct lwfs_thread_pool_request {
     void *client_data;            /* data to process                              */
     request_handler_proc handler; /* a re-entrant function to process the request */
     int number;                   /* number of the request                        */
+    int req_class;                /* class of the request (LWFS_TP_CLASS_*)       */
+    uint64_t client;              /* who sent it (clients share a class fairly)   */
+    double enqueue_time;          /* when the request was queued                  */
     struct lwfs_thread_pool_request* next;         /* pointer to next request, NULL if none.       */
 } ;
 
@@ -46,9 +80,16 @@ struct lwfs_thread_pool_request {
 int lwfs_thread_pool_init(lwfs_thread_pool *pool,
                           const lwfs_thread_pool_args *pool_args);
 
+/** @brief Return code of \ref lwfs_thread_pool_add_request when the queue is full. */
+#define LWFS_TP_BUSY 2
+
 /**
  * @brief  add a request to the pool
  *
+ * Once the queue reaches its high watermark, the pool refuses
+ * requests (returns \ref LWFS_TP_BUSY) until the queue drains
+ * to its low watermark.  The caller still owns a refused request.
+ *
  * @param pool  a pointer to the pool
  * @param client_data  any data required by the thread to process this request
  * @param handler  the function the thread will call to process this request
@@ -57,6 +98,40 @@ int lwfs_thread_pool_add_request(lwfs_thread_pool *pool,
                                  void *client_data, 
                                  request_handler_proc handler);
 
+/**
+ * @brief  add a request of a given class to the pool
+ *
+ * Threads take requests from the classes in proportion to the
+ * class weights and, within a class, from the clients in turn.
+ * \ref lwfs_thread_pool_add_request queues a metadata request
+ * from client 0.
+ *
+ * @param pool  a pointer to the pool
+ * @param client_data  any data required by the thread to process this request
+ * @param handler  the function the thread will call to process this request
+ * @param req_class  the class of the request (LWFS_TP_CLASS_*)
+ * @param client  the client that sent the request
+ */
+int lwfs_thread_pool_add_classified_request(lwfs_thread_pool *pool,
+                                            void *client_data, 
+                                            request_handler_proc handler,
+                                            const int req_class,
+                                            const uint64_t client);
+
+/**
+ * @brief  get the counters of a class of requests
+ */
+int lwfs_thread_pool_get_class_stats(lwfs_thread_pool *pool,
+                                     const int req_class,
+                                     struct lwfs_thread_pool_class_stats *stats);
+
+/**
+ * @brief  print the counters of every class of requests
+ */
+void fprint_lwfs_thread_pool_stats(FILE *fp,
+                                   const char *prefix,
+                                   lwfs_thread_pool *pool);
+
 /**
  * @brief  cleanup the pool
  *
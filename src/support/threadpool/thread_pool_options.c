@@ -25,6 +25,12 @@ void print_thread_pool_opts(FILE *fp, struct thread_pool_options *opts, const ch
     fprintf(fp, "%s \ttp-max-thread-count  = %d\n", prefix, opts->max_thread_count);
     fprintf(fp, "%s \ttp-low-watermark     = %d\n", prefix, opts->low_watermark);
     fprintf(fp, "%s \ttp-high-watermark    = %d\n", prefix, opts->high_watermark);
+    fprintf(fp, "%s \ttp-queue-high-watermark = %d\n", prefix, opts->queue_high_watermark);
+    fprintf(fp, "%s \ttp-queue-low-watermark  = %d\n", prefix, opts->queue_low_watermark);
+    fprintf(fp, "%s \ttp-metadata-weight   = %d\n", prefix, opts->metadata_weight);
+    fprintf(fp, "%s \ttp-bulk-weight       = %d\n", prefix, opts->bulk_weight);
+    fprintf(fp, "%s \ttp-batch-size        = %d\n", prefix, opts->batch_size);
+    fprintf(fp, "%s \ttp-pin-threads       = %s\n", prefix, (opts->pin_threads)? "true" : "false");
 }
 
 int parse_thread_pool_opt(
@@ -53,6 +59,30 @@ int parse_thread_pool_opt(
 			tp_opts->high_watermark = atoi(arg);
 			break;
 
+		case TP_QUEUE_LOW_WATERMARK_OPT:
+			tp_opts->queue_low_watermark = atoi(arg);
+			break;
+
+		case TP_QUEUE_HIGH_WATERMARK_OPT:
+			tp_opts->queue_high_watermark = atoi(arg);
+			break;
+
+		case TP_METADATA_WEIGHT_OPT:
+			tp_opts->metadata_weight = atoi(arg);
+			break;
+
+		case TP_BULK_WEIGHT_OPT:
+			tp_opts->bulk_weight = atoi(arg);
+			break;
+
+		case TP_BATCH_SIZE_OPT:
+			tp_opts->batch_size = atoi(arg);
+			break;
+
+		case TP_PIN_THREADS_OPT:
+			tp_opts->pin_threads = 1;
+			break;
+
 		default: 
 			return ARGP_ERR_UNKNOWN;
 	}
@@ -68,6 +98,12 @@ int load_default_thread_pool_opts(struct thread_pool_options *tp_opts)
     tp_opts->max_thread_count = 1;
     tp_opts->low_watermark = 1;
     tp_opts->high_watermark = 1;
+    tp_opts->queue_low_watermark = 0;
+    tp_opts->queue_high_watermark = 0;
+    tp_opts->metadata_weight = 0;
+    tp_opts->bulk_weight = 0;
+    tp_opts->batch_size = 0;
+    tp_opts->pin_threads = 0;
 
     return 0;
 }
@@ -14,7 +14,19 @@
 	{"tp-low-watermark",  TP_LOW_WATERMARK_OPT, "<val>", 0, \
 		"Request queue size at which threads are removed from the pool." }, \
 	{"tp-high-watermark",  TP_HIGH_WATERMARK_OPT, "<val>", 0, \
-		"Request queue size at which threads are added to the pool." }
+		"Request queue size at which threads are added to the pool." }, \
+	{"tp-queue-high-watermark",  TP_QUEUE_HIGH_WATERMARK_OPT, "<val>", 0, \
+		"Request queue size at which the server turns away new requests (0=default)." }, \
+	{"tp-queue-low-watermark",  TP_QUEUE_LOW_WATERMARK_OPT, "<val>", 0, \
+		"Request queue size at which the pool accepts requests again." }, \
+	{"tp-metadata-weight",  TP_METADATA_WEIGHT_OPT, "<val>", 0, \
+		"Share of the threads for metadata requests (0=default)." }, \
+	{"tp-bulk-weight",  TP_BULK_WEIGHT_OPT, "<val>", 0, \
+		"Share of the threads for bulk data requests (0=default)." }, \
+	{"tp-batch-size",  TP_BATCH_SIZE_OPT, "<val>", 0, \
+		"Requests a thread takes from the queue at once; idle threads steal the rest (0=default)." }, \
+	{"tp-pin-threads",  TP_PIN_THREADS_OPT, 0, 0, \
+		"Run each thread on its own CPU." }
 
 #ifdef __cplusplus
 extern "C" {
@@ -26,6 +38,12 @@ extern "C" {
 		int max_thread_count;
 		int low_watermark;
 		int high_watermark;
+		int queue_low_watermark;
+		int queue_high_watermark;
+		int metadata_weight;
+		int bulk_weight;
+		int batch_size;
+		int pin_threads;
 	};
 
 	typedef struct thread_pool_options lwfs_thread_pool_args;
@@ -35,7 +53,13 @@ extern "C" {
 		TP_MIN_COUNT_OPT = 1001,
 		TP_MAX_COUNT_OPT = 1002,
 		TP_LOW_WATERMARK_OPT = 1003,
-		TP_HIGH_WATERMARK_OPT = 1004
+		TP_HIGH_WATERMARK_OPT = 1004,
+		TP_QUEUE_LOW_WATERMARK_OPT = 1005,
+		TP_QUEUE_HIGH_WATERMARK_OPT = 1006,
+		TP_METADATA_WEIGHT_OPT = 1007,
+		TP_BULK_WEIGHT_OPT = 1008,
+		TP_BATCH_SIZE_OPT = 1009,
+		TP_PIN_THREADS_OPT = 1010
 	};
 
 #if defined(__STDC__) || defined(__cplusplus)
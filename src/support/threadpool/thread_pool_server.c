@@ -33,6 +33,12 @@ main(int argc, char* argv[])
     pool_args.max_thread_count=10;
     pool_args.low_watermark=3;
     pool_args.high_watermark=15;
+    pool_args.queue_low_watermark=0;
+    pool_args.queue_high_watermark=0;
+    pool_args.metadata_weight=0;
+    pool_args.bulk_weight=0;
+    pool_args.batch_size=0;
+    pool_args.pin_threads=0;
 
     rc = lwfs_thread_pool_init(&pool, &pool_args);
 
@@ -37,6 +37,18 @@ void print_threadpool_opts(
 			args_info->tp_low_watermark_arg);
 	fprintf(fp, "%s \ttp-high-watermark = %d\n", prefix, 
 			args_info->tp_high_watermark_arg);
+	fprintf(fp, "%s \ttp-queue-high-watermark = %d\n", prefix, 
+			args_info->tp_queue_high_watermark_arg);
+	fprintf(fp, "%s \ttp-queue-low-watermark = %d\n", prefix, 
+			args_info->tp_queue_low_watermark_arg);
+	fprintf(fp, "%s \ttp-metadata-weight = %d\n", prefix, 
+			args_info->tp_metadata_weight_arg);
+	fprintf(fp, "%s \ttp-bulk-weight = %d\n", prefix, 
+			args_info->tp_bulk_weight_arg);
+	fprintf(fp, "%s \ttp-batch-size = %d\n", prefix, 
+			args_info->tp_batch_size_arg);
+	fprintf(fp, "%s \ttp-pin-threads = %s\n", prefix, 
+			(args_info->tp_pin_threads_flag)? "true" : "false");
 }
 
 #endif 
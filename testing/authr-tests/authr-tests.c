@@ -16,6 +16,9 @@
 #include "client/authr_client/authr_client.h"
 #include "client/authr_client/authr_client_sync.h"
 #include "client/authr_client/authr_client_opts.h"
+#include "client/storage_client/storage_client.h"
+#include "client/storage_client/storage_client_sync.h"
+#include "client/storage_client/storage_client_opts.h"
 
 
 
@@ -28,9 +31,17 @@ enum testid {
 	GET_ACL=4,
 	MOD_ACL=5,
 	GET_CAP=6,
-	VERIFY=7
+	VERIFY=7,
+	REVOKE=8,
+	KEY_FETCH=9,
+	KEY_PUSH=10
 };
 
+/* Revocations are asynchronous, so we try the revoked cap 
+ * REVOKE_TRIES times (REVOKE_PAUSE usec apart) before giving up. */
+#define REVOKE_TRIES 50
+#define REVOKE_PAUSE 100000
+
 
 /* -------------- private methods -------------------*/
 
@@ -55,6 +66,7 @@ static int print_args(
 
     print_authr_client_opts(fp, args_info, prefix); 
     print_logger_opts(fp, args_info, prefix); 
+    print_storage_client_opts(fp, args_info, prefix); 
 
     fprintf(fp, "%s -----------------------------------\n", prefix);
     return 0;
@@ -62,8 +74,28 @@ static int print_args(
 
 
 
+/**
+ * @brief Create an object on the storage server with a new oid. 
+ */
+static int create_next_obj(
+	const lwfs_service *ss_svc, 
+	const lwfs_cid cid, 
+	lwfs_oid oid, 
+	const lwfs_cap *cap)
+{
+    lwfs_obj obj; 
+    uint64_t *id = (uint64_t *)oid; 
+
+    id[1]++; 
+    lwfs_init_obj(ss_svc, 0, cid, oid, &obj); 
+
+    return lwfs_create_obj_sync(NULL, &obj, cap); 
+}
+
+
 static int run_tests(
 	const lwfs_service *authr_svc, 
+	const lwfs_service *ss_svc, 
 	const int testid, 
 	const lwfs_cid cid) 
 {
@@ -226,6 +258,165 @@ static int run_tests(
 	    break;
 
 
+	    /* Take away the write access of user1 and make sure the 
+	     * storage server stops honoring the write cap it cached. */
+	case REVOKE:
+	    {
+		int rc2 = LWFS_OK; 
+		int tries; 
+		lwfs_cap write_cap, modacl_cap; 
+		lwfs_uid_array none, user1; 
+		lwfs_uid uids[1]; 
+		lwfs_oid oid; 
+
+		memset(oid, 0, sizeof(lwfs_oid));
+		((uint64_t *)oid)[0] = (uint64_t)getpid(); 
+
+		memset(&none, 0, sizeof(lwfs_uid_array));
+		memcpy(&uids[0], &cred1.data.uid, sizeof(lwfs_uid)); 
+		user1.lwfs_uid_array_val = uids; 
+		user1.lwfs_uid_array_len = 1; 
+
+		rc = lwfs_get_cap_sync(authr_svc, cid, 
+			LWFS_CONTAINER_WRITE, &cred1, &write_cap); 
+		if (rc != LWFS_OK) {
+		    log_error(authr_debug_level, "unable to getcap for write op: %s",
+			    lwfs_err_str(rc));
+		    return rc; 
+		}
+
+		rc = lwfs_get_cap_sync(authr_svc, cid, 
+			LWFS_CONTAINER_MODACL, &cred1, &modacl_cap); 
+		if (rc != LWFS_OK) {
+		    log_error(authr_debug_level, "unable to getcap for modacl op: %s",
+			    lwfs_err_str(rc));
+		    return rc; 
+		}
+
+		/* the storage server verifies the cap and caches it */
+		rc = create_next_obj(ss_svc, cid, oid, &write_cap); 
+		if (rc != LWFS_OK) {
+		    log_error(authr_debug_level, "unable to create obj with "
+			    "a valid cap: %s", lwfs_err_str(rc));
+		    return rc; 
+		}
+
+		/* remove user1 from the write acl (revokes the cap) */
+		rc = lwfs_mod_acl_sync(
+			authr_svc, txn, cid, LWFS_CONTAINER_WRITE, 
+			&none, &user1, &modacl_cap); 
+		if (rc != LWFS_OK) {
+		    log_error(authr_debug_level, "unable to modify the acl: %s",
+			    lwfs_err_str(rc));
+		    return rc; 
+		}
+
+		/* the storage server has to refuse the cached cap */
+		for (tries=0; tries<REVOKE_TRIES; tries++) {
+		    rc = create_next_obj(ss_svc, cid, oid, &write_cap); 
+		    if (rc != LWFS_OK) {
+			break; 
+		    }
+		    usleep(REVOKE_PAUSE); 
+		}
+
+		if (rc == LWFS_ERR_ACCESS) {
+		    log_debug(authr_debug_level, "revoked cap refused after %d tries", 
+			    tries+1); 
+		    rc = LWFS_OK; 
+		}
+		else if (rc == LWFS_OK) {
+		    log_error(authr_debug_level, "storage server still honors "
+			    "a revoked cap");
+		    rc = LWFS_ERR_ACCESS; 
+		}
+		else {
+		    log_error(authr_debug_level, "unexpected error using "
+			    "a revoked cap: %s", lwfs_err_str(rc));
+		}
+
+		/* give user1 the write access back for the other tests */
+		rc2 = lwfs_mod_acl_sync(
+			authr_svc, txn, cid, LWFS_CONTAINER_WRITE, 
+			&user1, &none, &modacl_cap); 
+		if (rc2 != LWFS_OK) {
+		    log_error(authr_debug_level, "unable to restore the acl: %s",
+			    lwfs_err_str(rc2));
+		    if (rc == LWFS_OK) rc = rc2; 
+		}
+	    }
+	    break; 
+
+
+	    /* Only the servers listed with --authr-key-holders may fetch 
+	     * the cap key, and only for their own service. */
+	case KEY_FETCH:
+	    {
+		lwfs_service my_svc; 
+		lwfs_cap_key_info info; 
+
+		/* ask for the key for our own (unlisted) process */
+		memcpy(&my_svc, ss_svc, sizeof(lwfs_service)); 
+		lwfs_get_id(&my_svc.req_addr.match_id); 
+
+		memset(&info, 0, sizeof(lwfs_cap_key_info)); 
+		rc = lwfs_get_cap_key_sync(authr_svc, &my_svc, &info); 
+		if (rc != LWFS_ERR_ACCESS) {
+		    log_error(authr_debug_level, "client fetched the key for "
+			    "itself: %s", lwfs_err_str(rc));
+		    return (rc == LWFS_OK)? LWFS_ERR : rc; 
+		}
+
+		/* ask for the key in the name of the storage server */
+		memset(&info, 0, sizeof(lwfs_cap_key_info)); 
+		rc = lwfs_get_cap_key_sync(authr_svc, ss_svc, &info); 
+		if (rc != LWFS_ERR_ACCESS) {
+		    log_error(authr_debug_level, "client fetched the key for "
+			    "the storage server: %s", lwfs_err_str(rc));
+		    return (rc == LWFS_OK)? LWFS_ERR : rc; 
+		}
+
+		rc = LWFS_OK; 
+	    }
+	    break; 
+
+
+	    /* A key push from anyone but the authr server has to be 
+	     * refused (the storage server would accept caps we forge). */
+	case KEY_PUSH:
+	    {
+		int rc2 = LWFS_OK; 
+		lwfs_cap_key_info info; 
+		lwfs_request req; 
+
+		memset(&info, 0, sizeof(lwfs_cap_key_info)); 
+		memset(info.key, 0xab, sizeof(lwfs_key)); 
+		memset(info.prev_key, 0xab, sizeof(lwfs_key)); 
+		info.generation = 0xffffffff; 
+
+		rc = lwfs_set_cap_key(ss_svc, &info, &req); 
+		if (rc != LWFS_OK) {
+		    log_error(authr_debug_level, "unable to send key: %s", 
+			    lwfs_err_str(rc));
+		    return rc; 
+		}
+
+		rc = lwfs_wait(&req, &rc2); 
+		if (rc != LWFS_OK) {
+		    log_error(authr_debug_level, "error waiting for key push: %s", 
+			    lwfs_err_str(rc));
+		    return rc; 
+		}
+
+		if (rc2 != LWFS_ERR_ACCESS) {
+		    log_error(authr_debug_level, "storage server accepted a key "
+			    "from a client: %s", lwfs_err_str(rc2));
+		    return (rc2 == LWFS_OK)? LWFS_ERR : rc2; 
+		}
+	    }
+	    break; 
+
+
 	case REMOVE_CID:
 	    {
 		lwfs_cap cap; 
@@ -268,7 +459,9 @@ int main(int argc, char **argv)
     int rc = LWFS_OK;
     struct gengetopt_args_info args_info; 
     lwfs_service authr_svc;
+    lwfs_service ss_svc;
     lwfs_remote_pid authr_id; 
+    lwfs_remote_pid ss_id; 
 
     /* Parse command line options to override defaults */
     if (cmdline_parser(argc, argv, &args_info) != 0) {
@@ -292,13 +485,28 @@ int main(int argc, char **argv)
 	return rc; 
     }
 
+    /* the storage service (only used by the revocation and key tests) */
+    memset(&ss_svc, 0, sizeof(lwfs_service));
+    if ((args_info.testid_arg == REVOKE) || 
+	(args_info.testid_arg == KEY_FETCH) || 
+	(args_info.testid_arg == KEY_PUSH)) {
+	ss_id.nid = args_info.ss_nid_arg; 
+	ss_id.pid = args_info.ss_pid_arg; 
+	rc = lwfs_get_service(ss_id, &ss_svc); 
+	if (rc != LWFS_OK) {
+	    log_error(authr_debug_level, "could not get storage service descriptor: %s",
+		    lwfs_err_str(rc));
+	    return rc; 
+	}
+    }
+
 
     if (authr_debug_level > 2) {
 	print_args(logger_get_file(), &args_info, ""); 
 	fflush(logger_get_file());
     }
 
-    rc = run_tests(&authr_svc, args_info.testid_arg, args_info.cid_arg); 
+    rc = run_tests(&authr_svc, &ss_svc, args_info.testid_arg, args_info.cid_arg); 
 
     if (rc != LWFS_OK) {
 	log_info(authr_debug_level, "Test %d failed!  %s", 
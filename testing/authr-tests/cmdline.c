@@ -26,15 +26,19 @@ const char *gengetopt_args_info_purpose = "";
 const char *gengetopt_args_info_usage = "Usage: authr-opts [OPTIONS]...";
 
 const char *gengetopt_args_info_help[] = {
-  "  -h, --help              Print help and exit",
-  "  -V, --version           Print version and exit",
-  "      --cid=INT           The container ID to use  (default=`1')",
-  "      --testid=INT        ID of the test  (default=`1')",
-  "      --authr-pid=LONG    PID of the authr server  (default=`124')",
-  "      --authr-nid=LONG    NID of the authr server  (default=`0')",
-  "      --authr-cache-caps  Cache caps on the client  (default=off)",
-  "      --verbose=INT       Debug level of logger [0-5]  (default=`5')",
-  "      --logfile=STRING    Path to logfile",
+  "  -h, --help                   Print help and exit",
+  "  -V, --version                Print version and exit",
+  "      --cid=INT                The container ID to use  (default=`1')",
+  "      --testid=INT             ID of the test  (default=`1')",
+  "      --authr-pid=LONG         PID of the authr server  (default=`124')",
+  "      --authr-nid=LONG         NID of the authr server  (default=`0')",
+  "      --authr-cache-caps       Cache caps on the client  (default=off)",
+  "      --verbose=INT            Debug level of logger [0-5]  (default=`5')",
+  "      --logfile=STRING         Path to logfile",
+  "      --ss-server-file=STRING  Path to a file with a list of storage servers",
+  "      --ss-num-servers=INT     Number of servers to use from the server file  \n                                 (default=`1')",
+  "      --ss-pid=INT             The PID of a single remote storage storage \n                                 server (ignored if using --ss=server-file)  \n                                 (default=`122')",
+  "      --ss-nid=LONG            The NID of a single remote storage server \n                                 (ignored if using --ss-server-file)  \n                                 (default=`0')",
     0
 };
 
@@ -46,6 +50,8 @@ void clear_args (struct gengetopt_args_info *args_info);
 static int
 cmdline_parser_internal (int argc, char * const *argv, struct gengetopt_args_info *args_info, int override, int initialize, int check_required, const char *additional_error);
 
+static int
+cmdline_parser_required2 (struct gengetopt_args_info *args_info, const char *prog_name, const char *additional_error);
 struct line_list
 {
   char * string_arg;
@@ -86,6 +92,10 @@ void clear_given (struct gengetopt_args_info *args_info)
   args_info->authr_cache_caps_given = 0 ;
   args_info->verbose_given = 0 ;
   args_info->logfile_given = 0 ;
+  args_info->ss_server_file_given = 0 ;
+  args_info->ss_num_servers_given = 0 ;
+  args_info->ss_pid_given = 0 ;
+  args_info->ss_nid_given = 0 ;
 }
 
 static
@@ -104,6 +114,14 @@ void clear_args (struct gengetopt_args_info *args_info)
   args_info->verbose_orig = NULL;
   args_info->logfile_arg = NULL;
   args_info->logfile_orig = NULL;
+  args_info->ss_server_file_arg = NULL;
+  args_info->ss_server_file_orig = NULL;
+  args_info->ss_num_servers_arg = 1;
+  args_info->ss_num_servers_orig = NULL;
+  args_info->ss_pid_arg = 122;
+  args_info->ss_pid_orig = NULL;
+  args_info->ss_nid_arg = 0;
+  args_info->ss_nid_orig = NULL;
   
 }
 
@@ -119,6 +137,10 @@ void init_args_info(struct gengetopt_args_info *args_info)
   args_info->authr_cache_caps_help = gengetopt_args_info_help[6] ;
   args_info->verbose_help = gengetopt_args_info_help[7] ;
   args_info->logfile_help = gengetopt_args_info_help[8] ;
+  args_info->ss_server_file_help = gengetopt_args_info_help[9] ;
+  args_info->ss_num_servers_help = gengetopt_args_info_help[10] ;
+  args_info->ss_pid_help = gengetopt_args_info_help[11] ;
+  args_info->ss_nid_help = gengetopt_args_info_help[12] ;
   
 }
 
@@ -189,6 +211,31 @@ cmdline_parser_release (struct gengetopt_args_info *args_info)
       free (args_info->logfile_orig); /* free previous argument */
       args_info->logfile_orig = 0;
     }
+  if (args_info->ss_server_file_arg)
+    {
+      free (args_info->ss_server_file_arg); /* free previous argument */
+      args_info->ss_server_file_arg = 0;
+    }
+  if (args_info->ss_server_file_orig)
+    {
+      free (args_info->ss_server_file_orig); /* free previous argument */
+      args_info->ss_server_file_orig = 0;
+    }
+  if (args_info->ss_num_servers_orig)
+    {
+      free (args_info->ss_num_servers_orig); /* free previous argument */
+      args_info->ss_num_servers_orig = 0;
+    }
+  if (args_info->ss_pid_orig)
+    {
+      free (args_info->ss_pid_orig); /* free previous argument */
+      args_info->ss_pid_orig = 0;
+    }
+  if (args_info->ss_nid_orig)
+    {
+      free (args_info->ss_nid_orig); /* free previous argument */
+      args_info->ss_nid_orig = 0;
+    }
   
   clear_given (args_info);
 }
@@ -258,6 +305,34 @@ cmdline_parser_file_save(const char *filename, struct gengetopt_args_info *args_
       fprintf(outfile, "%s\n", "logfile");
     }
   }
+  if (args_info->ss_server_file_given) {
+    if (args_info->ss_server_file_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "ss-server-file", args_info->ss_server_file_orig);
+    } else {
+      fprintf(outfile, "%s\n", "ss-server-file");
+    }
+  }
+  if (args_info->ss_num_servers_given) {
+    if (args_info->ss_num_servers_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "ss-num-servers", args_info->ss_num_servers_orig);
+    } else {
+      fprintf(outfile, "%s\n", "ss-num-servers");
+    }
+  }
+  if (args_info->ss_pid_given) {
+    if (args_info->ss_pid_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "ss-pid", args_info->ss_pid_orig);
+    } else {
+      fprintf(outfile, "%s\n", "ss-pid");
+    }
+  }
+  if (args_info->ss_nid_given) {
+    if (args_info->ss_nid_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "ss-nid", args_info->ss_nid_orig);
+    } else {
+      fprintf(outfile, "%s\n", "ss-nid");
+    }
+  }
   
   fclose (outfile);
 
@@ -313,7 +388,35 @@ cmdline_parser2 (int argc, char * const *argv, struct gengetopt_args_info *args_
 int
 cmdline_parser_required (struct gengetopt_args_info *args_info, const char *prog_name)
 {
-  return EXIT_SUCCESS;
+  int result = EXIT_SUCCESS;
+
+  if (cmdline_parser_required2(args_info, prog_name, NULL) > 0)
+    result = EXIT_FAILURE;
+
+  if (result == EXIT_FAILURE)
+    {
+      cmdline_parser_free (args_info);
+      exit (EXIT_FAILURE);
+    }
+  
+  return result;
+}
+
+int
+cmdline_parser_required2 (struct gengetopt_args_info *args_info, const char *prog_name, const char *additional_error)
+{
+  int error = 0;
+
+  /* checks for required options */
+  
+  /* checks for dependences among options */
+  if (args_info->ss_num_servers_given && ! args_info->ss_server_file_given)
+    {
+      fprintf (stderr, "%s: '--ss-num-servers' option depends on option 'ss-server-file'%s\n", prog_name, (additional_error ? additional_error : ""));
+      error = 1;
+    }
+
+  return error;
 }
 
 int
@@ -349,6 +452,10 @@ cmdline_parser_internal (int argc, char * const *argv, struct gengetopt_args_inf
         { "authr-cache-caps",	0, NULL, 0 },
         { "verbose",	1, NULL, 0 },
         { "logfile",	1, NULL, 0 },
+        { "ss-server-file",	1, NULL, 0 },
+        { "ss-num-servers",	1, NULL, 0 },
+        { "ss-pid",	1, NULL, 0 },
+        { "ss-nid",	1, NULL, 0 },
         { NULL,	0, NULL, 0 }
       };
 
@@ -509,6 +616,88 @@ cmdline_parser_internal (int argc, char * const *argv, struct gengetopt_args_inf
               free (args_info->logfile_orig); /* free previous string */
             args_info->logfile_orig = gengetopt_strdup (optarg);
           }
+          /* Path to a file with a list of storage servers.  */
+          else if (strcmp (long_options[option_index].name, "ss-server-file") == 0)
+          {
+            if (local_args_info.ss_server_file_given)
+              {
+                fprintf (stderr, "%s: `--ss-server-file' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->ss_server_file_given && ! override)
+              continue;
+            local_args_info.ss_server_file_given = 1;
+            args_info->ss_server_file_given = 1;
+            if (args_info->ss_server_file_arg)
+              free (args_info->ss_server_file_arg); /* free previous string */
+            args_info->ss_server_file_arg = gengetopt_strdup (optarg);
+            if (args_info->ss_server_file_orig)
+              free (args_info->ss_server_file_orig); /* free previous string */
+            args_info->ss_server_file_orig = gengetopt_strdup (optarg);
+          }
+          /* Number of servers to use from the server file.  */
+          else if (strcmp (long_options[option_index].name, "ss-num-servers") == 0)
+          {
+            if (local_args_info.ss_num_servers_given)
+              {
+                fprintf (stderr, "%s: `--ss-num-servers' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->ss_num_servers_given && ! override)
+              continue;
+            local_args_info.ss_num_servers_given = 1;
+            args_info->ss_num_servers_given = 1;
+            args_info->ss_num_servers_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->ss_num_servers_orig)
+              free (args_info->ss_num_servers_orig); /* free previous string */
+            args_info->ss_num_servers_orig = gengetopt_strdup (optarg);
+          }
+          /* The PID of a single remote storage storage server (ignored if using --ss=server-file).  */
+          else if (strcmp (long_options[option_index].name, "ss-pid") == 0)
+          {
+            if (local_args_info.ss_pid_given)
+              {
+                fprintf (stderr, "%s: `--ss-pid' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->ss_pid_given && ! override)
+              continue;
+            local_args_info.ss_pid_given = 1;
+            args_info->ss_pid_given = 1;
+            args_info->ss_pid_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->ss_pid_orig)
+              free (args_info->ss_pid_orig); /* free previous string */
+            args_info->ss_pid_orig = gengetopt_strdup (optarg);
+          }
+          /* The NID of a single remote storage server (ignored if using --ss-server-file).  */
+          else if (strcmp (long_options[option_index].name, "ss-nid") == 0)
+          {
+            if (local_args_info.ss_nid_given)
+              {
+                fprintf (stderr, "%s: `--ss-nid' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->ss_nid_given && ! override)
+              continue;
+            local_args_info.ss_nid_given = 1;
+            args_info->ss_nid_given = 1;
+            args_info->ss_nid_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->ss_nid_orig)
+              free (args_info->ss_nid_orig); /* free previous string */
+            args_info->ss_nid_orig = gengetopt_strdup (optarg);
+          }
           
           break;
         case '?':	/* Invalid option.  */
@@ -523,6 +712,10 @@ cmdline_parser_internal (int argc, char * const *argv, struct gengetopt_args_inf
 
 
 
+  if (check_required)
+    {
+      error += cmdline_parser_required2 (args_info, argv[0], additional_error);
+    }
 
   cmdline_parser_release (&local_args_info);
 
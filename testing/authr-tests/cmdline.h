@@ -46,6 +46,18 @@ struct gengetopt_args_info
   char * logfile_arg;	/* Path to logfile.  */
   char * logfile_orig;	/* Path to logfile original value given at command line.  */
   const char *logfile_help; /* Path to logfile help description.  */
+  char * ss_server_file_arg;	/* Path to a file with a list of storage servers.  */
+  char * ss_server_file_orig;	/* Path to a file with a list of storage servers original value given at command line.  */
+  const char *ss_server_file_help; /* Path to a file with a list of storage servers help description.  */
+  int ss_num_servers_arg;	/* Number of servers to use from the server file (default='1').  */
+  char * ss_num_servers_orig;	/* Number of servers to use from the server file original value given at command line.  */
+  const char *ss_num_servers_help; /* Number of servers to use from the server file help description.  */
+  int ss_pid_arg;	/* The PID of a single remote storage storage server (ignored if using --ss=server-file) (default='122').  */
+  char * ss_pid_orig;	/* The PID of a single remote storage storage server (ignored if using --ss=server-file) original value given at command line.  */
+  const char *ss_pid_help; /* The PID of a single remote storage storage server (ignored if using --ss=server-file) help description.  */
+  long ss_nid_arg;	/* The NID of a single remote storage server (ignored if using --ss-server-file) (default='0').  */
+  char * ss_nid_orig;	/* The NID of a single remote storage server (ignored if using --ss-server-file) original value given at command line.  */
+  const char *ss_nid_help; /* The NID of a single remote storage server (ignored if using --ss-server-file) help description.  */
   
   int help_given ;	/* Whether help was given.  */
   int version_given ;	/* Whether version was given.  */
@@ -56,6 +68,10 @@ struct gengetopt_args_info
   int authr_cache_caps_given ;	/* Whether authr-cache-caps was given.  */
   int verbose_given ;	/* Whether verbose was given.  */
   int logfile_given ;	/* Whether logfile was given.  */
+  int ss_server_file_given ;	/* Whether ss-server-file was given.  */
+  int ss_num_servers_given ;	/* Whether ss-num-servers was given.  */
+  int ss_pid_given ;	/* Whether ss-pid was given.  */
+  int ss_nid_given ;	/* Whether ss-nid was given.  */
 
 } ;
 
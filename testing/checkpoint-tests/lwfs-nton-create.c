@@ -5,6 +5,8 @@
 #include "client/authr_client/authr_client.h"
 #include "client/authr_client/authr_client_sync.h"
 #include "client/authr_client/authr_client_opts.h"
+#include "client/naming_client/naming_client.h"
+#include "client/naming_client/naming_client_sync.h"
 #include "common/rpc_common/lwfs_ptls.h"
 #include "common/config_parser/config_parser.h"
 
@@ -46,6 +48,12 @@ static void print_args(
 		fprintf(fp, "%s \tin-transit = %d\n", prefix, 
 				args_info->in_transit_arg);
 	}
+	fprintf(fp, "%s \tcreate-mode = %s\n",prefix , 
+			args_info->create_mode_arg);
+	if (strcmp(args_info->create_mode_arg, "bulk") == 0) {
+		fprintf(fp, "%s \tbatch-size = %d\n", prefix, 
+				args_info->batch_size_arg);
+	}
 	fprintf(fp, "%s \tnum-trials = %d\n",prefix , 
 			args_info->num_trials_arg);
 	fprintf(fp, "%s \tbytes-per-op = %lu\n",prefix , 
@@ -261,6 +269,132 @@ cleanup:
 }
 
 
+/**
+ * @brief Name of the i'th file a process creates.
+ */
+static void file_name(
+	const int rank,
+	const int i,
+	char *name)
+{
+    snprintf(name, LWFS_NAME_LEN, "%05d.%06d", rank, i);
+}
+
+
+/**
+ * @brief Create files one at a time (an object, then a name for it).
+ */
+static int create_files_sync(
+	const lwfs_service *naming_svc,
+	const lwfs_service *svc,
+	const lwfs_txn *txn,
+	const lwfs_cid cid,
+	const lwfs_cap *cap,
+	const lwfs_ns_entry *dir,
+	const int rank,
+	const int num_ops, 
+	lwfs_obj *obj)
+{
+    int rc = LWFS_OK;
+    int i; 
+    char name[LWFS_NAME_LEN];
+    lwfs_ns_entry ent;
+
+    for (i=0; i<num_ops; i++) {
+	rc = lwfs_init_obj(svc, 0, cid, LWFS_OID_ANY, &obj[i]);
+	if (rc != LWFS_OK) {
+	    log_error(debug_level, "unable to initialize obj structure\n");
+	    goto cleanup;
+	}
+
+	rc = lwfs_create_obj_sync(txn, &obj[i], cap);
+	if (rc != LWFS_OK) {
+	    log_error(debug_level, "unable to create obj\n");
+	    goto cleanup;
+	}
+
+	file_name(rank, i, name);
+	rc = lwfs_create_file_sync(naming_svc, txn, dir, name, &obj[i], cap, &ent);
+	if (rc != LWFS_OK) {
+	    log_error(debug_level, "unable to create file %s: %s\n", 
+		    name, lwfs_err_str(rc));
+	    goto cleanup;
+	}
+	xdr_free((xdrproc_t)xdr_lwfs_ns_entry, (char *)&ent);
+    }
+
+cleanup:
+    return rc; 
+}
+
+
+/**
+ * @brief Create files in batches: one request creates the objects 
+ * of a batch, and one request creates their names. 
+ */
+static int create_files_bulk(
+	const lwfs_service *naming_svc,
+	const lwfs_service *svc,
+	const lwfs_txn *txn,
+	const lwfs_cid cid,
+	const lwfs_cap *cap,
+	const lwfs_ns_entry *dir,
+	const int rank,
+	const int num_ops, 
+	const int batch_size, 
+	lwfs_obj *obj)
+{
+    int rc = LWFS_OK;
+    int i, j, len; 
+    char (*names)[LWFS_NAME_LEN] = NULL;
+    const char **name_ptrs = NULL;
+    lwfs_create_files_res res;
+
+    names = malloc(batch_size * LWFS_NAME_LEN);
+    name_ptrs = (const char **)malloc(batch_size * sizeof(char *));
+    if ((names == NULL) || (name_ptrs == NULL)) {
+	log_error(debug_level, "out of memory");
+	rc = LWFS_ERR_NOSPACE;
+	goto cleanup;
+    }
+
+    for (i=0; i<num_ops; i+=len) {
+	len = ((num_ops - i) < batch_size)? (num_ops - i) : batch_size;
+
+	for (j=0; j<len; j++) {
+	    rc = lwfs_init_obj(svc, 0, cid, LWFS_OID_ANY, &obj[i+j]);
+	    if (rc != LWFS_OK) {
+		log_error(debug_level, "unable to initialize obj structure\n");
+		goto cleanup;
+	    }
+
+	    file_name(rank, i+j, names[j]);
+	    name_ptrs[j] = names[j];
+	}
+
+	rc = lwfs_create_objs_sync(txn, &obj[i], len, cap, NULL);
+	if (rc != LWFS_OK) {
+	    log_error(debug_level, "unable to create objs: %s\n", lwfs_err_str(rc));
+	    goto cleanup;
+	}
+
+	memset(&res, 0, sizeof(lwfs_create_files_res));
+	rc = lwfs_create_files_sync(naming_svc, txn, dir, name_ptrs, &obj[i], 
+		len, cap, &res);
+	xdr_free((xdrproc_t)xdr_lwfs_create_files_res, (char *)&res);
+	if (rc != LWFS_OK) {
+	    log_error(debug_level, "unable to create files: %s\n", lwfs_err_str(rc));
+	    goto cleanup;
+	}
+    }
+
+cleanup:
+    free(names);
+    free(name_ptrs);
+    return rc; 
+}
+
+
 typedef struct {
     double val;
     double index;
@@ -396,6 +530,14 @@ int main(int argc, char *argv[])
 	exit(1);
     }
 
+    /* one lwfs_create_files request per batch */
+    if ((args_info.batch_size_arg < 1) || 
+	    (args_info.batch_size_arg > LWFS_CREATE_FILES_MAX)) {
+	fprintf(stderr, "--batch-size must be between 1 and %d\n", 
+		LWFS_CREATE_FILES_MAX);
+	exit(1);
+    }
+
     /* initialize the logger */
     debug_level = args_info.verbose_arg; 
     logger_init(debug_level, args_info.logfile_arg);
@@ -511,6 +653,8 @@ int main(int argc, char *argv[])
 	lwfs_cid cid = LWFS_CID_ANY; 
 	lwfs_service *svc = &lwfs_core_svc.storage_svc[myrank % lwfs_core_svc.ss_num_servers];
 	lwfs_txn *txn = NULL;
+	lwfs_namespace ns; 
+	char ns_name[LWFS_NAME_LEN]; 
 
 	if (myrank == 0) {
 	    fprintf(stdout, "trial %d\n", i);
@@ -542,13 +686,55 @@ int main(int argc, char *argv[])
 
 	/* scatter the capability to all clients O(lg n) */
 	MPI_Bcast(&cap, sizeof(lwfs_cap), MPI_BYTE, 0, MPI_COMM_WORLD); 
+	cid = cap.data.cid; 
+
+	/* files go in the root of a new namespace (one directory for all) */
+	memset(&ns, 0, sizeof(lwfs_namespace));
+	if (strcmp(args_info.create_mode_arg, "obj") != 0) {
+	    if (myrank == 0) {
+		snprintf(ns_name, sizeof(ns_name), "lwfs-nton-create.%d.%d", 
+			(int)getpid(), i);
+		rc = lwfs_create_namespace_sync(&lwfs_core_svc.naming_svc, txn, 
+			ns_name, cid, &ns);
+		if (rc != LWFS_OK) {
+		    log_error(debug_level, "unable to create namespace: %s",
+			    lwfs_err_str(rc));
+		    MPI_Abort(MPI_COMM_WORLD, -1);
+		}
+	    }
+	    MPI_Bcast(ns_name, sizeof(ns_name), MPI_BYTE, 0, MPI_COMM_WORLD); 
+	    MPI_Bcast(&ns.ns_entry, sizeof(lwfs_ns_entry), MPI_BYTE, 0, MPI_COMM_WORLD); 
+
+	    /* the pointers only make sense on node 0 */
+	    if (myrank != 0) {
+		ns.ns_entry.file_obj = NULL; 
+		ns.ns_entry.d_obj = NULL; 
+	    }
+	}
 
 	log_debug(debug_level, "creating objects");
 
 	MPI_Barrier(MPI_COMM_WORLD); 
 	t_start = MPI_Wtime(); 
 
-	if (args_info.async_flag) {
+	if (strcmp(args_info.create_mode_arg, "bulk") == 0) {
+	    /* batches of files (objects and names) */
+	    rc = create_files_bulk(&lwfs_core_svc.naming_svc, svc, txn, cid, &cap, 
+		    &ns.ns_entry, myrank, args_info.ops_per_trial_arg, 
+		    args_info.batch_size_arg, objs);
+	    if (rc != LWFS_OK) {
+		goto cleanup;
+	    }
+	}
+	else if (strcmp(args_info.create_mode_arg, "file") == 0) {
+	    /* one file (object and name) at a time */
+	    rc = create_files_sync(&lwfs_core_svc.naming_svc, svc, txn, cid, &cap, 
+		    &ns.ns_entry, myrank, args_info.ops_per_trial_arg, objs);
+	    if (rc != LWFS_OK) {
+		goto cleanup;
+	    }
+	}
+	else if (args_info.async_flag) {
 	    /* asynchronous creates */
 	    rc = create_objs_async(svc, txn, cid, &cap, 
 		    args_info.ops_per_trial_arg, args_info.in_transit_arg, objs);
@@ -570,8 +756,32 @@ int main(int argc, char *argv[])
 	if (args_info.remove_file_flag) {
 	    int j; 
 	    for (j=0; j<args_info.ops_per_trial_arg; j++) {
+		if (strcmp(args_info.create_mode_arg, "obj") != 0) {
+		    char name[LWFS_NAME_LEN];
+		    lwfs_ns_entry ent; 
+
+		    file_name(myrank, j, name);
+		    if (lwfs_unlink_sync(&lwfs_core_svc.naming_svc, txn, &ns.ns_entry, 
+				name, &cap, &ent) == LWFS_OK) {
+			xdr_free((xdrproc_t)xdr_lwfs_ns_entry, (char *)&ent);
+		    }
+		}
 		lwfs_remove_obj_sync(NULL, &objs[j], &cap);
 	    }
+
+	    MPI_Barrier(MPI_COMM_WORLD); 
+	    if ((myrank == 0) && (strcmp(args_info.create_mode_arg, "obj") != 0)) {
+		lwfs_namespace removed; 
+
+		if (lwfs_remove_namespace_sync(&lwfs_core_svc.naming_svc, txn, 
+			    ns_name, &cap, &removed) == LWFS_OK) {
+		    xdr_free((xdrproc_t)xdr_lwfs_namespace, (char *)&removed);
+		}
+	    }
+	}
+
+	if (myrank == 0) {
+	    xdr_free((xdrproc_t)xdr_lwfs_namespace, (char *)&ns);
 	}
 
 	print_stats(result_fp, &args_info, t_total);
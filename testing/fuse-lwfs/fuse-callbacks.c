@@ -31,6 +31,7 @@
 #include "naming/naming_clnt.h"
 #include "storage/ss_clnt.h"
 #include "authr/authr_clnt.h"
+#include "client/naming_client/ns_cache.h"
 #include "fuse-debug.h"
 
 /* ---- Local variables ---- */
@@ -51,6 +52,9 @@ static lwfs_cid cid;
 /* single txn used for all methods */
 static lwfs_txn txn; 
 
+/* entries found by traverse_path (see ns_cache.h) */
+static lwfs_ns_cache ns_cache; 
+
 
 int fuse_callbacks_init(
 	const lwfs_service *a_svc, 
@@ -105,9 +109,32 @@ int fuse_callbacks_init(
 		return rc; 
 	}
 
+	/* FUSE asks for the same paths over and over */
+	rc = lwfs_ns_cache_init(&ns_cache, LWFS_NS_CACHE_SIZE, 
+			LWFS_NS_CACHE_TTL, LWFS_NS_CACHE_NEG_TTL);
+	if (rc != LWFS_OK) {
+		log_error(fuse_debug_level, "unable to create namespace cache: %s",
+			lwfs_err_str(rc));
+		return rc; 
+	}
+
 	return rc; 
 }
 
+/**
+ * @brief Release the data structures used by the callbacks. 
+ */
+int fuse_callbacks_fini()
+{
+	if (logging_debug(fuse_debug_level)) {
+		fprint_lwfs_ns_cache_stats(logger_get_file(), "DEBUG", &ns_cache);
+	}
+
+	lwfs_ns_cache_fini(&ns_cache);
+
+	return LWFS_OK; 
+}
+
 
 /* ---- Private methods ---- */
 
@@ -177,9 +204,6 @@ static int traverse_path(
 	}
 
 
-	/* TODO: look for the entry in a cache */
-
-
 	/* Are we looking up the root? */
 	if (strcmp(path, "/") == 0) {
 		memcpy(result, LWFS_NAMING_ROOT, sizeof(lwfs_ns_entry)); 
@@ -207,10 +231,24 @@ static int traverse_path(
 		goto cleanup; 
 	}
 
+	/* look in the cache first */
+	rc = lwfs_ns_cache_lookup(&ns_cache, &parent_ent, name, result); 
+	if (rc == LWFS_OK) {
+		goto cleanup; 
+	}
+
 	/* lookup the entry */
-	log_debug(fuse_call_debug_level, "lookup %s", name); 
-	rc = lwfs_blookup(NULL, &parent_ent, name, 
-			LWFS_LOCK_NULL, &cap, result);
+	if (rc != LWFS_ERR_NOENT) {
+		log_debug(fuse_call_debug_level, "lookup %s", name); 
+		rc = lwfs_blookup(NULL, &parent_ent, name, 
+				LWFS_LOCK_NULL, &cap, result);
+		if (rc == LWFS_OK) {
+			lwfs_ns_cache_insert(&ns_cache, &parent_ent, name, result); 
+		}
+		else if (rc == LWFS_ERR_NOENT) {
+			lwfs_ns_cache_insert(&ns_cache, &parent_ent, name, NULL); 
+		}
+	}
 	if (rc != LWFS_OK) {
 		errno = ENOENT; 
 		rc = -ENOENT; 
@@ -526,6 +564,7 @@ int lwfs_fuse_mknod(const char *path, mode_t mode, dev_t rdev)
 
 	/* associate the object with the file name */
 	rc = lwfs_bcreate_file(&txn, &parent_ent, name, &obj, &cap, &file_ent); 
+	lwfs_ns_cache_invalidate(&ns_cache, &parent_ent, name); 
 	if (rc != LWFS_OK) {
 		log_error(fuse_debug_level, "could not create file: %s",
 			lwfs_err_str(rc));
@@ -578,6 +617,7 @@ int lwfs_fuse_mkdir(const char *path, mode_t mode)
 	/* create the directory */
 	rc = lwfs_bcreate_dir(NULL, &parent_ent, name, 
 			cid, &cap, &dir_ent); 
+	lwfs_ns_cache_invalidate(&ns_cache, &parent_ent, name); 
 	if (rc != LWFS_OK) {
 		log_error(fuse_debug_level, "error creating dir: %s", 
 				lwfs_err_str(rc));
@@ -636,6 +676,7 @@ int lwfs_fuse_unlink(const char *path)
 	/* remove the file from the namespace */
 	rc = lwfs_bunlink(NULL, &parent_ent, name, 
 			&cap, &entry); 
+	lwfs_ns_cache_invalidate(&ns_cache, &parent_ent, name); 
 	if (rc != LWFS_OK) {
 		log_error(fuse_debug_level, "error removing file: %s", 
 				lwfs_err_str(rc));
@@ -695,6 +736,7 @@ int lwfs_fuse_rmdir(const char *path)
 	/* remove the directory from the namespace */
 	rc = lwfs_bremove_dir(NULL, &parent_ent, name, 
 			&cap, &dir_ent); 
+	lwfs_ns_cache_invalidate(&ns_cache, &parent_ent, name); 
 	if (rc != LWFS_OK) {
 		log_error(fuse_debug_level, "error removing file: %s", 
 				lwfs_err_str(rc));
@@ -800,6 +842,9 @@ int lwfs_fuse_link(const char *from, const char *to)
 	rc = lwfs_bcreate_link(NULL, &parent_ent, name, &cap, 
 			&target_parent_ent, target_name, &cap, 
 			&link_ent); 
+	lwfs_ns_cache_invalidate(&ns_cache, &parent_ent, name); 
+	/* the target's link count changed */
+	lwfs_ns_cache_invalidate(&ns_cache, &target_parent_ent, target_name); 
 	if (rc != LWFS_OK) {
 		log_error(fuse_debug_level, "error creating link: %s", 
 				lwfs_err_str(rc));
@@ -33,6 +33,7 @@ extern int fuse_callbacks_init(
 	const lwfs_service *authr_svc, 
 	const lwfs_service *naming_svc, 
 	const lwfs_service *ss_svc); 
+extern int fuse_callbacks_fini(); 
 
 
 /* ----------------- COMMAND-LINE OPTIONS --------------- */
@@ -640,6 +641,7 @@ int main(int argc, char *argv[])
 	rc = fuse_main(fuse_argc, fuse_argv, &lwfs_fuse_oper);
 
 	/* cleanup */
+	fuse_callbacks_fini(); 
 
 	/* close the storage server client */
 	/* close the authr server client */
@@ -26,6 +26,7 @@
 #include "client/naming_client/naming_client.h"
 #include "client/naming_client/naming_client_opts.h"
 #include "client/naming_client/naming_client_sync.h"
+#include "client/naming_client/ns_cache.h"
 #include "client/storage_client/storage_client.h"
 #include "client/storage_client/storage_client_opts.h"
 #include "client/storage_client/storage_client_sync.h"
@@ -117,6 +118,405 @@ int test_str(FILE *fp, const char* name, const char* val, const char *expected)
 	}
 }
 
+/* check one lwfs_resolve_path result */
+static int test_resolve(
+		FILE *fp,
+		const char *desc,
+		const lwfs_ns_entry *start,
+		const char **names,
+		const int num_names,
+		const lwfs_cap *caps,
+		const lwfs_bool want_all,
+		const int expected_rc,
+		const char **expected_names,
+		const int num_expected,
+		const int expected_failed)
+{
+	int rc = LWFS_OK;
+	int i;
+	int ok = FALSE;
+	char path[256];
+	lwfs_resolve_path_res res;
+
+	memset(&res, 0, sizeof(lwfs_resolve_path_res));
+	rc = lwfs_resolve_path_sync(&naming_svc, NULL, start, names, num_names,
+			caps, 1, want_all, &res);
+	sprintf(path, "lwfs_resolve_path(%s)", desc);
+	if (!test_result(fp, path, rc, expected_rc))
+		goto cleanup;
+	if (!test_int(fp, "num_entries", res.entries.lwfs_ns_entry_array_len, num_expected))
+		goto cleanup;
+	for (i=0; i<num_expected; i++) {
+		sprintf(path, "entry[%d]", i);
+		if (!test_str(fp, path, res.entries.lwfs_ns_entry_array_val[i].name, expected_names[i]))
+			goto cleanup;
+	}
+	if (!test_int(fp, "failed", res.failed, expected_failed))
+		goto cleanup;
+
+	ok = TRUE;
+
+cleanup:
+	xdr_free((xdrproc_t)xdr_lwfs_resolve_path_res, (char *)&res);
+	return ok;
+}
+
+/* resolve /tmp/test/file (and a few broken paths) in one request */
+static int run_resolve_tests(
+		FILE *fp,
+		const lwfs_ns_entry *root,
+		const char *dir1_str,
+		const char *dir2_str,
+		const char *file1_str)
+{
+	int rc = LWFS_OK;
+	lwfs_cid other_cid = LWFS_CID_ANY;
+	lwfs_cap other_cap;
+
+	const char *path[] = {dir1_str, dir2_str, file1_str};
+	const char *missing[] = {dir1_str, "missing", file1_str};
+	const char *notdir[] = {dir1_str, dir2_str, file1_str, "below-a-file"};
+
+	/* the target only */
+	if (!test_resolve(fp, "tmp/test/file", root, path, 3, &cap, FALSE,
+				LWFS_OK, &path[2], 1, 3))
+		return FALSE;
+
+	/* every entry on the path */
+	if (!test_resolve(fp, "tmp/test/file, want_all", root, path, 3, &cap, TRUE,
+				LWFS_OK, path, 3, 3))
+		return FALSE;
+
+	/* the server stops at the missing name */
+	if (!test_resolve(fp, "tmp/missing/file", root, missing, 3, &cap, TRUE,
+				LWFS_ERR_NOENT, missing, 1, 1))
+		return FALSE;
+
+	/* and at a name below a file */
+	if (!test_resolve(fp, "tmp/test/file/below-a-file", root, notdir, 4, &cap, TRUE,
+				LWFS_ERR_NOTDIR, notdir, 3, 3))
+		return FALSE;
+
+	/* a cap for another container does not let us read the root */
+	rc = get_perms(&authr_svc, &cred, &other_cid, opcodes, &other_cap);
+	if (!test_result(fp, "get_perms(other container)", rc, LWFS_OK))
+		return FALSE;
+
+	if (!test_resolve(fp, "tmp/test/file, wrong cap", root, path, 3, &other_cap, TRUE,
+				LWFS_ERR_ACCESS, NULL, 0, 0))
+		return FALSE;
+
+	return TRUE;
+}
+
+#define PAGE_NUM_FILES 25
+
+/* read the directory a page at a time, check the names against expected */
+static int test_pages(
+		FILE *fp,
+		const char *desc,
+		const lwfs_ns_entry *dir,
+		const int max_entries,
+		const lwfs_bool names_only,
+		const char *pattern,
+		const char **expected,
+		const int num_expected)
+{
+	int rc = LWFS_OK;
+	int i;
+	int count = 0;
+	int pages = 0;
+	int ok = FALSE;
+	char cookie[LWFS_NAME_LEN];
+	char name[256];
+	lwfs_bool eof = FALSE;
+	lwfs_list_dir_page_res res;
+
+	cookie[0] = '\0';
+
+	while (!eof) {
+		memset(&res, 0, sizeof(res));
+		rc = lwfs_list_dir_page_sync(&naming_svc, dir, cookie, max_entries,
+				names_only, pattern, &cap, &res);
+		sprintf(name, "lwfs_list_dir_page(%s, page %d)", desc, pages);
+		if (!test_result(fp, name, rc, LWFS_OK))
+			goto cleanup;
+
+		if ((int)res.entries.lwfs_ns_entry_array_len > max_entries) {
+			fprintf(fp, "%s ... FAILED (%d entries, max %d)\n", name,
+					res.entries.lwfs_ns_entry_array_len, max_entries);
+			goto cleanup;
+		}
+
+		for (i=0; i<(int)res.entries.lwfs_ns_entry_array_len; i++) {
+			lwfs_ns_entry *ent = &res.entries.lwfs_ns_entry_array_val[i];
+
+			/* more names than expected, or a name twice */
+			if (count >= num_expected) {
+				fprintf(fp, "%s ... FAILED (extra entry %s)\n", name, ent->name);
+				goto cleanup;
+			}
+
+			if (strcmp(ent->name, expected[count]) != 0) {
+				fprintf(fp, "%s, entry[%d] ... FAILED (val=%s, expected %s)\n",
+						desc, count, ent->name, expected[count]);
+				goto cleanup;
+			}
+
+			/* names_only skips the inode (link_cnt comes from it) */
+			if (ent->link_cnt != ((names_only)? 0 : 1)) {
+				fprintf(fp, "%s, entry[%d] ... FAILED (link_cnt=%d)\n",
+						desc, count, ent->link_cnt);
+				goto cleanup;
+			}
+
+			count++;
+		}
+
+		strncpy(cookie, res.cookie, LWFS_NAME_LEN-1);
+		cookie[LWFS_NAME_LEN-1] = '\0';
+		eof = res.eof;
+		xdr_free((xdrproc_t)xdr_lwfs_list_dir_page_res, (char *)&res);
+
+		/* a page that is not the last one is never empty */
+		if (++pages > num_expected + 1) {
+			fprintf(fp, "%s ... FAILED (no eof after %d pages)\n", desc, pages);
+			return FALSE;
+		}
+	}
+
+	sprintf(name, "%s, entries", desc);
+	return test_int(fp, name, count, num_expected);
+
+cleanup:
+	xdr_free((xdrproc_t)xdr_lwfs_list_dir_page_res, (char *)&res);
+	return ok;
+}
+
+/* page through a directory larger than one page */
+static int run_page_tests(
+		FILE *fp,
+		const lwfs_ns_entry *parent)
+{
+	int rc = LWFS_OK;
+	int i;
+	int ok = FALSE;
+	char path[256];
+	char names[PAGE_NUM_FILES][LWFS_NAME_LEN];
+	const char *all[PAGE_NUM_FILES];
+	const char *rest[PAGE_NUM_FILES];
+	const char *ps_1x[10];
+	int num_rest = 0;
+	const char *dir_str = "page";
+	lwfs_obj obj;
+	lwfs_ns_entry dir, file;
+	lwfs_list_dir_page_res res;
+
+	memset(&res, 0, sizeof(res));
+
+	rc = lwfs_create_dir_sync(&naming_svc, NULL, parent,
+			dir_str, cid, &cap, &dir);
+	sprintf(path, "lwfs_create_dir(%s)", dir_str);
+	if (!test_result(fp, path, rc, LWFS_OK))
+		return FALSE;
+
+	/* the naming server only records the file object */
+	memset(&obj, 0, sizeof(lwfs_obj));
+	obj.cid = cid;
+
+	/* create them out of order, the pages come back in name order */
+	for (i=PAGE_NUM_FILES-1; i>=0; i--) {
+		sprintf(names[i], "p%03d", i);
+		all[i] = names[i];
+		rc = lwfs_create_file_sync(&naming_svc, NULL, &dir,
+				names[i], &obj, &cap, &file);
+		sprintf(path, "lwfs_create_file(%s/%s)", dir_str, names[i]);
+		if (!test_result(fp, path, rc, LWFS_OK))
+			goto cleanup;
+	}
+
+	/* every name once and in order, 7 at a time */
+	if (!test_pages(fp, "7 per page", &dir, 7, FALSE, NULL, all, PAGE_NUM_FILES))
+		goto cleanup;
+
+	/* the same with names only */
+	if (!test_pages(fp, "names only", &dir, 7, TRUE, NULL, all, PAGE_NUM_FILES))
+		goto cleanup;
+
+	/* only the names that match the pattern */
+	for (i=0; i<10; i++) {
+		ps_1x[i] = names[10+i];
+	}
+	if (!test_pages(fp, "pattern p01?", &dir, 4, FALSE, "p01?", ps_1x, 10))
+		goto cleanup;
+	if (!test_pages(fp, "pattern x*", &dir, 4, FALSE, "x*", NULL, 0))
+		goto cleanup;
+
+	/* remove the entry the cookie names between two pages */
+	rc = lwfs_list_dir_page_sync(&naming_svc, &dir, "", 7, TRUE, NULL, &cap, &res);
+	if (!test_result(fp, "lwfs_list_dir_page(first page)", rc, LWFS_OK))
+		goto cleanup;
+	if (!test_str(fp, "cookie", res.cookie, names[6]))
+		goto cleanup;
+
+	rc = lwfs_unlink_sync(&naming_svc, NULL, &dir, names[6], &cap, &file);
+	sprintf(path, "lwfs_unlink(%s/%s)", dir_str, names[6]);
+	if (!test_result(fp, path, rc, LWFS_OK))
+		goto cleanup;
+
+	/* the next page still starts after the removed name */
+	xdr_free((xdrproc_t)xdr_lwfs_list_dir_page_res, (char *)&res);
+	memset(&res, 0, sizeof(res));
+	rc = lwfs_list_dir_page_sync(&naming_svc, &dir, names[6], 7, TRUE, NULL, &cap, &res);
+	if (!test_result(fp, "lwfs_list_dir_page(after removed cookie)", rc, LWFS_OK))
+		goto cleanup;
+	if (!test_int(fp, "entries", res.entries.lwfs_ns_entry_array_len, 7))
+		goto cleanup;
+	if (!test_str(fp, "entry[0]", res.entries.lwfs_ns_entry_array_val[0].name, names[7]))
+		goto cleanup;
+
+	for (i=0; i<PAGE_NUM_FILES; i++) {
+		if (i != 6)
+			rest[num_rest++] = names[i];
+	}
+	if (!test_pages(fp, "after unlink", &dir, 7, FALSE, NULL, rest, num_rest))
+		goto cleanup;
+
+	ok = TRUE;
+
+cleanup:
+	xdr_free((xdrproc_t)xdr_lwfs_list_dir_page_res, (char *)&res);
+
+	/* empty and remove the directory */
+	for (i=0; i<PAGE_NUM_FILES; i++) {
+		lwfs_unlink_sync(&naming_svc, NULL, &dir, names[i], &cap, &file);
+	}
+	rc = lwfs_remove_dir_sync(&naming_svc, NULL, parent, dir_str, &cap, &dir);
+	sprintf(path, "lwfs_remove_dir(%s)", dir_str);
+	if (!test_result(fp, path, rc, LWFS_OK))
+		return FALSE;
+
+	return ok;
+}
+
+/* the client-side namespace cache (see ns_cache.h) */
+static int run_ns_cache_tests(
+		FILE *fp,
+		const lwfs_ns_entry *parent)
+{
+	int rc = LWFS_OK;
+	int i;
+	int ok = FALSE;
+	char path[256];
+	char fake[LWFS_NAME_LEN];
+	const char *name = "cached";
+	lwfs_obj obj;
+	lwfs_ns_entry ent, file;
+	lwfs_ns_cache cache;
+
+	memset(&ent, 0, sizeof(ent));
+
+	/* 4 entries, half a second leases */
+	rc = lwfs_ns_cache_init(&cache, 4, 0.5, 0.5);
+	if (!test_result(fp, "lwfs_ns_cache_init", rc, LWFS_OK))
+		return FALSE;
+
+	/* the server has no such name; the cache remembers that */
+	rc = lwfs_ns_cache_lookup_sync(&cache, &naming_svc, NULL, parent,
+			name, LWFS_LOCK_NULL, &cap, &ent);
+	if (!test_result(fp, "lwfs_ns_cache_lookup_sync(missing)", rc, LWFS_ERR_NOENT))
+		goto cleanup;
+	rc = lwfs_ns_cache_lookup(&cache, parent, name, &ent);
+	if (!test_result(fp, "lwfs_ns_cache_lookup(missing)", rc, LWFS_ERR_NOENT))
+		goto cleanup;
+	if (!test_int(fp, "neg_hits", cache.stats.neg_hits, 1))
+		goto cleanup;
+
+	/* create the name; the creator drops the negative entry */
+	memset(&obj, 0, sizeof(lwfs_obj));
+	obj.cid = cid;
+	rc = lwfs_create_file_sync(&naming_svc, NULL, parent, name, &obj, &cap, &file);
+	sprintf(path, "lwfs_create_file(%s)", name);
+	if (!test_result(fp, path, rc, LWFS_OK))
+		goto cleanup;
+	lwfs_ns_cache_invalidate(&cache, parent, name);
+
+	rc = lwfs_ns_cache_lookup(&cache, parent, name, &ent);
+	if (!test_result(fp, "lwfs_ns_cache_lookup(after create)", rc, LWFS_ERR))
+		goto cleanup;
+
+	/* a miss fills the cache, the next lookup hits */
+	rc = lwfs_ns_cache_lookup_sync(&cache, &naming_svc, NULL, parent,
+			name, LWFS_LOCK_NULL, &cap, &ent);
+	if (!test_result(fp, "lwfs_ns_cache_lookup_sync(created)", rc, LWFS_OK))
+		goto cleanup;
+	xdr_free((xdrproc_t)xdr_lwfs_ns_entry, (char *)&ent);
+
+	rc = lwfs_ns_cache_lookup(&cache, parent, name, &ent);
+	if (!test_result(fp, "lwfs_ns_cache_lookup(created)", rc, LWFS_OK))
+		goto cleanup;
+	if (!test_str(fp, "cached name", ent.name, name))
+		goto cleanup;
+	if (!test_int(fp, "hits", cache.stats.hits, 1))
+		goto cleanup;
+	xdr_free((xdrproc_t)xdr_lwfs_ns_entry, (char *)&ent);
+
+	/* the lease runs out */
+	usleep(600000);
+	rc = lwfs_ns_cache_lookup(&cache, parent, name, &ent);
+	if (!test_result(fp, "lwfs_ns_cache_lookup(expired)", rc, LWFS_ERR))
+		goto cleanup;
+	if (!test_int(fp, "expired", cache.stats.expired, 1))
+		goto cleanup;
+
+	/* cache it again, unlink it, and drop it */
+	rc = lwfs_ns_cache_lookup_sync(&cache, &naming_svc, NULL, parent,
+			name, LWFS_LOCK_NULL, &cap, &ent);
+	if (!test_result(fp, "lwfs_ns_cache_lookup_sync(again)", rc, LWFS_OK))
+		goto cleanup;
+	xdr_free((xdrproc_t)xdr_lwfs_ns_entry, (char *)&ent);
+
+	rc = lwfs_unlink_sync(&naming_svc, NULL, parent, name, &cap, &file);
+	sprintf(path, "lwfs_unlink(%s)", name);
+	if (!test_result(fp, path, rc, LWFS_OK))
+		goto cleanup;
+	lwfs_ns_cache_invalidate(&cache, parent, name);
+	if (!test_int(fp, "invalidations", cache.stats.invalidations, 2))
+		goto cleanup;
+
+	rc = lwfs_ns_cache_lookup_sync(&cache, &naming_svc, NULL, parent,
+			name, LWFS_LOCK_NULL, &cap, &ent);
+	if (!test_result(fp, "lwfs_ns_cache_lookup_sync(unlinked)", rc, LWFS_ERR_NOENT))
+		goto cleanup;
+
+	/* a full cache starts over */
+	lwfs_ns_cache_invalidate_all(&cache);
+	for (i=0; i<5; i++) {
+		sprintf(fake, "fake%d", i);
+		rc = lwfs_ns_cache_insert(&cache, parent, fake, NULL);
+		sprintf(path, "lwfs_ns_cache_insert(%s)", fake);
+		if (!test_result(fp, path, rc, LWFS_OK))
+			goto cleanup;
+	}
+	if (!test_int(fp, "flushes", cache.stats.flushes, 1))
+		goto cleanup;
+	rc = lwfs_ns_cache_lookup(&cache, parent, "fake0", &ent);
+	if (!test_result(fp, "lwfs_ns_cache_lookup(flushed)", rc, LWFS_ERR))
+		goto cleanup;
+	rc = lwfs_ns_cache_lookup(&cache, parent, "fake4", &ent);
+	if (!test_result(fp, "lwfs_ns_cache_lookup(after flush)", rc, LWFS_ERR_NOENT))
+		goto cleanup;
+
+	ok = TRUE;
+
+cleanup:
+	if (logging_debug(args_info.verbose_arg)) {
+		fprint_lwfs_ns_cache_stats(fp, "DEBUG", &cache);
+	}
+	lwfs_ns_cache_fini(&cache);
+	return ok;
+}
+
 void run_tests()
 {
 	FILE *fp = stdout;
@@ -206,6 +606,18 @@ void run_tests()
 	if (!test_result(fp, path, rc, LWFS_OK))
 		return;
 
+	/* resolve the path in one request */
+	if (!run_resolve_tests(fp, namespace_root, dir1_str, dir2_str, file1_str))
+		return;
+
+	/* read a directory a page at a time */
+	if (!run_page_tests(fp, &dir1))
+		return;
+
+	/* cache lookups on the client */
+	if (!run_ns_cache_tests(fp, &dir1))
+		return;
+
 	/* make sure file_2 is the same as file1 */
 	//if (!test_equiv(fp, "file object", file1.file_obj, file2.file_obj, sizeof(lwfs_obj)))
 	//	return; 
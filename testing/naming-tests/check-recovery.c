@@ -0,0 +1,340 @@
+/**  @file check-recovery.c
+ *
+ *   @brief Check that the naming database survives a crash.
+ *
+ *   The test runs in two phases.  The \em create phase creates
+ *   files in one directory and records every create the server
+ *   acknowledged in the ack file.  The Makefile kills the naming
+ *   server (kill -9) while the creates are running and restarts it.
+ *   The \em verify phase then checks that
+ *
+ *   - every acknowledged create is still in the directory,
+ *   - at most the one create that was in flight is extra,
+ *   - every dirent has its inode (lookup returns the file object),
+ *   - the database takes new creates after recovery.
+ *
+ *   @version $Revision$
+ *   @date $Date$
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <getopt.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "cmdline.h"
+#include "client/authr_client/authr_client.h"
+#include "client/authr_client/authr_client_sync.h"
+#include "client/authr_client/authr_client_opts.h"
+#include "client/naming_client/naming_client.h"
+#include "client/naming_client/naming_client_opts.h"
+#include "client/naming_client/naming_client_sync.h"
+#include "support/logger/logger.h"
+#include "support/logger/logger_opts.h"
+#include "perms.h"
+
+
+static const lwfs_name ns_name = "check-recovery.ns";
+static const char *dir_str = "crash";
+
+lwfs_remote_pid authr_id;
+lwfs_remote_pid naming_id;
+
+lwfs_service authr_svc;      /* service descriptor for the authr service */
+lwfs_service naming_svc;     /* service descriptor for the naming service */
+
+lwfs_cred cred;
+lwfs_opcode opcodes = LWFS_CONTAINER_WRITE | LWFS_CONTAINER_READ;
+lwfs_cap cap;
+lwfs_cid cid = LWFS_CID_ANY;
+
+struct gengetopt_args_info args_info;
+
+
+static int test_result(FILE *fp, const char* func_name, int rc, int expected) {
+	if (rc != expected) {
+		fprintf(fp, "%s ... FAILED (rc=%s, expected %s)\n",
+				func_name, lwfs_err_str(rc), lwfs_err_str(expected));
+		return FALSE;
+	}
+	fprintf(fp, "%s ... passed\n", func_name);
+	return TRUE;
+}
+
+static int test_int(FILE *fp, const char* name, int val, int expected) {
+	if (val != expected) {
+		fprintf(fp, "%s ... FAILED (val=%d, expected %d)\n",
+				name, val, expected);
+		return FALSE;
+	}
+	fprintf(fp, "%s ... passed\n", name);
+	return TRUE;
+}
+
+
+/**
+ * @brief Record the container and the last acknowledged create.
+ *
+ * The record has a fixed width, so a rewrite replaces the old one.
+ * The client may be killed with the server, so flush every record.
+ */
+static void write_ack(
+		FILE *ack,
+		const int last)
+{
+	rewind(ack);
+	fprintf(ack, "%20llu %10d\n", (unsigned long long)cid, last);
+	fflush(ack);
+}
+
+static int read_ack(
+		const char *fname,
+		int *last)
+{
+	unsigned long long c;
+	FILE *ack = fopen(fname, "r");
+
+	if (ack == NULL) {
+		log_error(args_info.verbose_arg, "unable to open %s", fname);
+		return LWFS_ERR;
+	}
+	if (fscanf(ack, "%llu %d", &c, last) != 2) {
+		log_error(args_info.verbose_arg, "unable to read %s", fname);
+		fclose(ack);
+		return LWFS_ERR;
+	}
+	fclose(ack);
+
+	cid = (lwfs_cid)c;
+	return LWFS_OK;
+}
+
+
+/**
+ * @brief Create files until the server stops answering.
+ */
+static void run_create(FILE *fp)
+{
+	int rc = LWFS_OK;
+	int i;
+	char name[LWFS_NAME_LEN];
+	FILE *ack = NULL;
+	lwfs_obj obj;
+
+	lwfs_namespace namespace;
+	lwfs_ns_entry dir, file;
+
+	/* the container for the namespace and the files */
+	rc = get_perms(&authr_svc, &cred, &cid, opcodes, &cap);
+	if (!test_result(fp, "get_perms", rc, LWFS_OK))
+		return;
+
+	rc = lwfs_create_namespace_sync(&naming_svc, NULL, ns_name, cid, &namespace);
+	if (!test_result(fp, "lwfs_create_namespace", rc, LWFS_OK))
+		return;
+
+	rc = lwfs_create_dir_sync(&naming_svc, NULL, &namespace.ns_entry,
+			dir_str, cid, &cap, &dir);
+	if (!test_result(fp, "lwfs_create_dir", rc, LWFS_OK))
+		return;
+
+	ack = fopen(args_info.ack_file_arg, "w");
+	if (ack == NULL) {
+		log_error(args_info.verbose_arg, "unable to create %s",
+				args_info.ack_file_arg);
+		return;
+	}
+	write_ack(ack, -1);
+
+	/* the naming server only records the file object */
+	memset(&obj, 0, sizeof(lwfs_obj));
+	obj.cid = cid;
+
+	for (i=0; i<args_info.num_files_arg; i++) {
+		sprintf(name, "f%08d", i);
+
+		rc = lwfs_create_file_sync(&naming_svc, NULL, &dir,
+				name, &obj, &cap, &file);
+		if (rc != LWFS_OK) {
+			break;
+		}
+
+		write_ack(ack, i);
+	}
+
+	fprintf(fp, "created %d files (%s)\n", i, lwfs_err_str(rc));
+	fclose(ack);
+}
+
+
+/**
+ * @brief Check the directory after the server restarted.
+ */
+static void run_verify(FILE *fp)
+{
+	int rc = LWFS_OK;
+	int i, n;
+	int last = -1;
+	char name[LWFS_NAME_LEN];
+	char desc[256];
+	lwfs_obj obj;
+	int *seen = NULL;
+
+	lwfs_namespace namespace;
+	lwfs_ns_entry dir, file;
+	lwfs_ns_entry_array listing;
+
+	memset(&listing, 0, sizeof(listing));
+
+	rc = read_ack(args_info.ack_file_arg, &last);
+	if (!test_result(fp, "read ack file", rc, LWFS_OK))
+		return;
+	fprintf(fp, "last acknowledged create: %d\n", last);
+
+	rc = lwfs_get_cap_sync(&authr_svc, cid, opcodes, &cred, &cap);
+	if (!test_result(fp, "lwfs_get_cap", rc, LWFS_OK))
+		return;
+
+	rc = lwfs_get_namespace_sync(&naming_svc, ns_name, &namespace);
+	if (!test_result(fp, "lwfs_get_namespace", rc, LWFS_OK))
+		return;
+
+	rc = lwfs_lookup_sync(&naming_svc, NULL, &namespace.ns_entry,
+			dir_str, LWFS_LOCK_NULL, &cap, &dir);
+	if (!test_result(fp, "lwfs_lookup(dir)", rc, LWFS_OK))
+		return;
+
+	rc = lwfs_list_dir_sync(&naming_svc, &dir, &cap, &listing);
+	if (!test_result(fp, "lwfs_list_dir", rc, LWFS_OK))
+		return;
+
+	/* every acknowledged create, plus at most the one in flight */
+	n = listing.lwfs_ns_entry_array_len;
+	if ((n < last+1) || (n > last+2)) {
+		fprintf(fp, "dirlen ... FAILED (val=%d, expected %d or %d)\n",
+				n, last+1, last+2);
+		goto cleanup;
+	}
+	fprintf(fp, "dirlen ... passed (%d)\n", n);
+
+	/* the names must be f0 .. f(n-1), each one once */
+	seen = (int *)calloc(n, sizeof(int));
+	for (i=0; i<n; i++) {
+		lwfs_ns_entry *ent = &listing.lwfs_ns_entry_array_val[i];
+		int index = -1;
+
+		if ((sscanf(ent->name, "f%08d", &index) != 1)
+				|| (index < 0) || (index >= n) || seen[index]) {
+			fprintf(fp, "entry %s ... FAILED (unexpected name)\n", ent->name);
+			goto cleanup;
+		}
+		seen[index] = 1;
+
+		/* the dirent must still reach its inode */
+		rc = lwfs_lookup_sync(&naming_svc, NULL, &dir,
+				ent->name, LWFS_LOCK_NULL, &cap, &file);
+		if (rc != LWFS_OK) {
+			sprintf(desc, "lwfs_lookup(%s)", ent->name);
+			test_result(fp, desc, rc, LWFS_OK);
+			goto cleanup;
+		}
+		if ((memcmp(&file.inode_oid, &ent->inode_oid, sizeof(lwfs_oid)) != 0)
+				|| (memcmp(&file.entry_obj.oid, &file.inode_oid, sizeof(lwfs_oid)) != 0)
+				|| (file.entry_obj.type != LWFS_FILE_ENTRY)
+				|| (file.file_obj == NULL)
+				|| (file.file_obj->cid != cid)) {
+			fprintf(fp, "inode of %s ... FAILED\n", ent->name);
+			goto cleanup;
+		}
+	}
+	fprintf(fp, "dirents and inodes ... passed\n");
+
+	/* the recovered database must take new creates */
+	memset(&obj, 0, sizeof(lwfs_obj));
+	obj.cid = cid;
+	sprintf(name, "f%08d", n);
+	rc = lwfs_create_file_sync(&naming_svc, NULL, &dir,
+			name, &obj, &cap, &file);
+	sprintf(desc, "lwfs_create_file(%s)", name);
+	if (!test_result(fp, desc, rc, LWFS_OK))
+		goto cleanup;
+
+	rc = lwfs_lookup_sync(&naming_svc, NULL, &dir,
+			name, LWFS_LOCK_NULL, &cap, &file);
+	sprintf(desc, "lwfs_lookup(%s)", name);
+	if (!test_result(fp, desc, rc, LWFS_OK))
+		goto cleanup;
+
+	if (!test_int(fp, "link_cnt", file.link_cnt, 1))
+		goto cleanup;
+
+	fprintf(fp, "FINISHED!\n");
+
+cleanup:
+	free(seen);
+	free(listing.lwfs_ns_entry_array_val);
+}
+
+
+static int setup(void)
+{
+	int rc = LWFS_OK;
+
+	/* initialize the logger */
+	logger_init(args_info.verbose_arg, args_info.logfile_arg);
+
+	/* initialize RPC before we do anything */
+	lwfs_rpc_init(LWFS_RPC_PTL, LWFS_RPC_XDR);
+
+	/* get the descriptor for the authorization service */
+	authr_id.nid = args_info.authr_nid_arg;
+	authr_id.pid = args_info.authr_pid_arg;
+	rc = lwfs_get_service(authr_id, &authr_svc);
+	if (rc != LWFS_OK) {
+		log_error(args_info.verbose_arg, "unable to get authr service descriptor: %s",
+				lwfs_err_str(rc));
+		return rc;
+	}
+
+	/* get the descriptor for the naming service */
+	naming_id.nid = args_info.naming_nid_arg;
+	naming_id.pid = args_info.naming_pid_arg;
+	rc = lwfs_get_service(naming_id, &naming_svc);
+	if (rc != LWFS_OK) {
+		log_error(args_info.verbose_arg, "unable to get naming service descriptor: %s",
+				lwfs_err_str(rc));
+		return rc;
+	}
+
+	return rc;
+}
+
+/**
+ * Check recovery of the naming database.
+ */
+int main(int argc, char *argv[])
+{
+	/* Parse command line options */
+	if (cmdline_parser(argc, argv, &args_info) != 0)
+		exit(1);
+
+	if (setup() != LWFS_OK)
+		exit(1);
+
+	if (strcmp(args_info.phase_arg, "create") == 0) {
+		run_create(stdout);
+	}
+	else if (strcmp(args_info.phase_arg, "verify") == 0) {
+		run_verify(stdout);
+	}
+	else {
+		fprintf(stderr, "unknown phase \"%s\"\n", args_info.phase_arg);
+		exit(1);
+	}
+
+	return LWFS_OK;
+}
@@ -0,0 +1,223 @@
+#!/usr/bin/perl
+
+# Measure how the aggregate bandwidth of a threaded lwfs-xfer-server
+# scales with the number of threads in its pool.  Every client rank
+# keeps many async data-portal requests outstanding, so with N
+# threads the server can have N transfers in flight.
+#
+# Output: output/lwfs-xfer-threads-{data,read}-noblk-<threads>.out
+# (column 10 of each row is the number of server threads).
+#
+# Worker threads poll their transfer EQs with a backoff of up to
+# --poll-backoff usecs (1000 by default).  To see what the backoff
+# costs, pass a list (e.g. --poll-backoff=1000,0); runs with other
+# values go to output/lwfs-xfer-threads-{data,read}-backoff<usecs>-<threads>.out.
+# The server log of every run is saved next to its output file, and
+# output/lwfs-xfer-threads-poll.out gets one row per run with the
+# poll counters of the server:
+#
+#   type threads backoff events empty-polls late-usecs/event wakeups timeouts
+#
+# late-usecs/event bounds the latency the backoff added to each
+# transfer event; wakeups/timeouts count how the dispatcher woke up.
+
+use Getopt::Long;
+use POSIX ":sys_wait_h";
+
+my $mpirun = "mpirun";
+my $kill_server = "lwfs-kill";
+my $server_exec = "lwfs-xfer-server";
+my $client_exec = "lwfs-xfer-client";
+my $num_clients = 16;
+my $num_trials = 5;
+my $num_reqs = 1024;
+my $len = 65536;     # data_t structs per request (1 MB)
+my $rsh = "rsh";
+my $server = "localhost";
+my $server_nid = 0;
+my $server_pid = 122;
+my $iface = $ENV{'PTL_IFACE'};
+my $dryrun = 0;
+my $poll_backoff = "1000";
+my $poll_file = "output/lwfs-xfer-threads-poll.out";
+
+GetOptions(
+	   "server=s" => \$server,
+	   "rsh=s" => \$rsh,
+	   "num-clients=i" => \$num_clients,
+	   "num-trials=i" => \$num_trials,
+	   "num-reqs=i" => \$num_reqs,
+	   "len=i" => \$len,
+	   "mpirun=s" => \$mpirun,
+	   "poll-backoff=s" => \$poll_backoff,
+	   "dryrun=i" => \$dryrun);
+
+
+# Get the nid of the server
+$server_nid = `$rsh $server utcp_nid $iface`;
+$server_nid =~ s/Running.*\n//g;
+$server_nid =~ s/\n//g;
+
+$dir = $ENV{'PWD'};
+
+print ("server_nid=$server_nid\n");
+
+# 3 = client puts (server gets), 5 = server puts (client reads)
+%outfiles = (3 => "output/lwfs-xfer-threads-data-noblk",
+		5 => "output/lwfs-xfer-threads-read-noblk");
+
+@types = (3, 5);
+
+@thread_list = (1, 2, 4, 8, 16);
+
+@backoff_list = split(/,/, $poll_backoff);
+
+
+# Append the poll counters from a server log to the poll file.
+sub report_polls {
+	my ($type, $num_threads, $backoff, $logfile) = @_;
+	my %stats = ();
+
+	open(LOG, "<$logfile") or return;
+	while (<LOG>) {
+		if (/^\s*(events|empty polls|late usecs\/event|drain wakeups|drain timeouts) = (\S+)/) {
+			$stats{$1} = $2;
+		}
+	}
+	close(LOG);
+
+	my $row = join(" ", $type, $num_threads, $backoff,
+			$stats{'events'}, $stats{'empty polls'},
+			$stats{'late usecs/event'},
+			$stats{'drain wakeups'}, $stats{'drain timeouts'});
+
+	print ("poll: $row\n");
+
+	if (! -e $poll_file) {
+		open(POLL, ">$poll_file");
+		print POLL ("% type threads backoff events empty-polls ",
+				"late-usecs/event wakeups timeouts\n");
+	}
+	else {
+		open(POLL, ">>$poll_file");
+	}
+	print POLL ("$row\n");
+	close(POLL);
+}
+
+
+foreach $type (@types) {
+
+	print ("\n====================================\n");
+	print ("Starting experiments for type $type\n\n");
+
+	foreach $backoff (@backoff_list) {
+
+	$prefix = $outfiles{$type};
+	if ($backoff != 1000) {
+		$prefix =~ s/noblk/backoff$backoff/;
+	}
+
+	foreach $num_threads (@thread_list) {
+
+		print ("\n------------------------------------\n");
+		$outfile = $prefix."-$num_threads.out";
+		$logfile = $prefix."-$num_threads.server";
+
+		if (-e $outfile) {
+			$lines = `grep -v \% $outfile | wc -l`;
+			$lines =~ s/\n//g;
+
+			$trials_left = $num_trials - $lines;
+			$result_mode = "a";
+
+			print ("File $outfile exists, $trials_left ",
+					"trials remaining \n");
+		}
+		else {
+			$trials_left = $num_trials;
+			$result_mode = "w";
+			print ("Creating $outfile, $trials_left ",
+					"trials remaining \n");
+		}
+
+		next if ($trials_left <= 0);
+
+		$kidpid = fork();
+
+		if (!defined($kidpid)) {
+			die "Cannot fork: $!";
+		}
+
+		elsif ($kidpid == 0) {
+			# start the server with a fixed-size pool
+			print("Starting server on $server ...\n");
+			@args = ("$rsh $server",
+					"$dir/$server_exec",
+					"--pid=$server_pid",
+					"--verbose=2",
+					"--use-threads",
+					"--tp-min-thread-count=$num_threads",
+					"--tp-max-thread-count=$num_threads",
+					"--tp-init-thread-count=$num_threads",
+					"--poll-backoff=$backoff",
+					"> $dir/$logfile 2>&1",
+					"");
+
+			print(join(" ", @args), "\n");
+			if ($dryrun == 0) {
+				exec(join(" ", @args));
+
+				die "exec @args failed: $?"
+			}
+			exit(0);
+		}
+
+		else {
+			# start the clients
+			sleep(3);
+
+			print("Starting clients ...\n");
+
+			@args = ("$mpirun -np $num_clients",
+					"$dir/$client_exec",
+					"--verbose=2",
+					"--len=$len",
+					"--count=".$trials_left,
+					"--num-reqs=$num_reqs",
+					"--type=$type",
+					"--server-threads=$num_threads",
+					"--result-file=$dir/$outfile",
+					"--result-file-mode=$result_mode",
+					"--server-nid=$server_nid",
+					"--server-pid=$server_pid",
+					"");
+
+			print (join(" ", @args), "\n");
+			if ($dryrun == 0) {
+				system(join(" ",@args)) == 0
+					or die "exec @args failed: $?"
+			}
+
+			# kill the server process
+			@args = ("$dir/$kill_server",
+					"--server-nid=$server_nid",
+					"--server-pid=$server_pid",
+					"--verbose=2",
+					"");
+
+			print (join(" ", @args), "\n");
+			if ($dryrun == 0) {
+				system(join(" ",@args)) == 0
+					or die "exec @args failed: $?"
+			}
+
+			waitpid($kidpid, 0);
+
+			report_polls($type, $num_threads, $backoff, $logfile);
+		}
+	}
+	}
+
+	print ("Finished experiments for type $type\n");
+}
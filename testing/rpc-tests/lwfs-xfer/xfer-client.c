@@ -21,6 +21,7 @@
 #include "common/rpc_common/lwfs_ptls.h"
 #include "common/rpc_common/rpc_common.h"
 #include "common/rpc_common/rpc_xdr.h"
+#include "common/rpc_common/ptl_pool.h"
 
 #include "client/rpc_client/rpc_client.h"
 
@@ -34,12 +35,15 @@ log_level xfer_debug_level = LOG_UNDEFINED;
 
 const int LWFS_XFER_1_ID = 1;
 const int LWFS_XFER_2_ID = 2;
+const int LWFS_XFER_3_ID = 3;
 
 enum {
 	XFER_ARGS_BLK = 0,
 	XFER_ARGS_NOBLK,
 	XFER_DATA_BLK,
-	XFER_DATA_NOBLK
+	XFER_DATA_NOBLK,
+	XFER_READ_BLK,
+	XFER_READ_NOBLK
 };
 
 
@@ -86,6 +90,9 @@ struct arguments {
 
 	/** @brief Process ID of the remote server. */
 	lwfs_remote_pid server; 
+
+	/** @brief Threads in the server's pool (only recorded in the results). */
+	int server_threads; 
 }; 
 
 static int print_args(FILE *fp, const char *prefix, struct arguments *args) 
@@ -115,6 +122,12 @@ static int print_args(FILE *fp, const char *prefix, struct arguments *args)
 			case XFER_DATA_NOBLK:
 				fprintf(fp, " (async calls, array in data portal)\n");
 				break;
+			case XFER_READ_BLK:
+				fprintf(fp, " (blocking calls, array from server data portal)\n");
+				break;
+			case XFER_READ_NOBLK:
+				fprintf(fp, " (async calls, array from server data portal)\n");
+				break;
 			default:
 				fprintf(fp, " (undefined type)\n");
 				break;
@@ -133,6 +146,7 @@ static int print_args(FILE *fp, const char *prefix, struct arguments *args)
 		fprintf(fp, "%s \t--server-name = \"%s\"\n", prefix, args->server_name);
 		fprintf(fp, "%s \t--server-nid = %u\n", prefix, args->server.nid);
 		fprintf(fp, "%s \t--server-pid = %u\n", prefix, args->server.pid);
+		fprintf(fp, "%s \t--server-threads = %d\n", prefix, args->server_threads);
 		fprintf(fp, "%s -----------------------------------\n", prefix);
 
 		fflush(fp);
@@ -153,6 +167,7 @@ static struct argp_option options[] = {
 	{"server-name",    13, "<val>", 0, "Hostname of the server."},
 	{"result-file",    14, "<val>", 0, "File for results."},
 	{"result-file-mode",    15, "<val>", 0, "Mode for the result file."},
+	{"server-threads",    16, "<val>", 0, "Threads in the server pool (recorded in the results)."},
 	{ 0 }
 };
 
@@ -212,6 +227,10 @@ static error_t parse_opt(
 			arguments->result_file_mode = arg;
 			break;
 
+		case 16: /* server-threads */
+			arguments->server_threads = atoi(arg);
+			break;
+
 
 
 		case ARGP_KEY_ARG:
@@ -284,6 +303,7 @@ void output_stats(
 			fprintf(result_fp, "%s   7     min throughput (MB/sec)\n","%");
 			fprintf(result_fp, "%s   8     max throughput (MB/sec)\n","%");
 			fprintf(result_fp, "%s   9     avg throughput (MB/sec)\n","%");
+			fprintf(result_fp, "%s  10     server threads\n","%");
 			fprintf(result_fp, "%s ----------------------------------------------------\n", "%");
 			first = 0; 
 		}
@@ -298,7 +318,8 @@ void output_stats(
 		fprintf(result_fp, "%1.6e  ", t_total_avg); 
 		fprintf(result_fp, "%1.6e  ", nbytes/(t_total_max*1024*1024)); 
 		fprintf(result_fp, "%1.6e  ", nbytes/(t_total_min*1024*1024)); 
-		fprintf(result_fp, "%1.6e\n", nbytes/(t_total_avg*1024*1024)); 
+		fprintf(result_fp, "%1.6e  ", nbytes/(t_total_avg*1024*1024)); 
+		fprintf(result_fp, "%04d\n", args->server_threads); 
 		fprintf(result_fp, "%s ----------------------------------------------------\n", "%");
 		fflush(result_fp);
 	}
@@ -343,7 +364,7 @@ int xfer_1_clnt(
 	int sizeof_header; 
 	int xdrsizeof_header; 
 	lwfs_request_header hdr; 
-	lwfs_opcode opcode = 1;
+	lwfs_opcode opcode = XFER_1_OP;
 
 
 	/* initialize the arguments */
@@ -422,7 +443,7 @@ int xfer_2_clnt(
     int rc = LWFS_OK;
     xfer_2_args args; 
     int nbytes; 
-	lwfs_opcode opcode=2;
+	lwfs_opcode opcode=XFER_2_OP;
 
     /* the buffer to send to the server */
     const data_t *buf = array->data_array_t_val; 
@@ -487,6 +508,78 @@ int xfer_2_clnt_blk(
 
 }
 
+int xfer_3_clnt(
+	const lwfs_service *svc, 
+	data_array_t *array, 
+	data_t *result, 
+	lwfs_request *req)
+{
+    int rc = LWFS_OK;
+    xfer_2_args args; 
+    int nbytes; 
+	lwfs_opcode opcode=XFER_3_OP;
+
+    /* the server puts the array into this buffer */
+    data_t *buf = array->data_array_t_val; 
+
+    args.len = array->data_array_t_len; 
+    nbytes = args.len*sizeof(data_t); 
+
+    /* call the remote method (server puts the buffer in the data portal) */
+    rc = lwfs_call_rpc(svc, opcode,  &args, (char *)buf, nbytes, result, req); 
+    if (rc != LWFS_OK) {
+        log_error(xfer_debug_level, "unable to call xfer_3: %s",
+                lwfs_err_str(rc));
+    }
+
+    return rc; 
+}
+
+int xfer_3_clnt_blk(
+	const lwfs_service *svc, 
+	data_array_t *array, 
+	data_t *result)
+{
+	int rc = LWFS_OK;
+	int rc2 = LWFS_OK;
+	lwfs_request req; 
+	int len = array->data_array_t_len; 
+
+	/* call the async function */
+	rc = xfer_3_clnt(svc, array, result, &req);
+	if (rc != LWFS_OK) {
+		log_error(xfer_debug_level, "unable to call async method: %s",
+			lwfs_err_str(rc));
+		return rc; 
+	}
+
+	/* wait for completion */
+	rc2 = lwfs_wait(&req, &rc);
+	if (rc2 != LWFS_OK) {
+		log_error(xfer_debug_level, "failed waiting for request: %s",
+			lwfs_err_str(rc));
+		return rc2; 
+	}
+
+	if (rc != LWFS_OK) {
+		log_error(xfer_debug_level, "remote method failed: %s",
+			lwfs_err_str(rc));
+		return rc; 
+	}
+
+	/* verify the result and the last entry the server put */
+	rc = verify_result(len, result); 
+	if (rc == LWFS_OK) {
+		rc = verify_result(len, &array->data_array_t_val[len-1]); 
+	}
+	if (rc != LWFS_OK) {
+		log_error(xfer_debug_level, "invalid result");
+		return rc; 
+	}
+
+	return rc; 
+}
+
 
 
 
@@ -516,6 +609,7 @@ main (int argc, char *argv[])
 	args.server_name = NULL;
 	args.result_file = NULL;
 	args.result_file_mode = "w";
+	args.server_threads = 0;
 
 	/* unique to each process */
 	int num_reqs; 
@@ -594,6 +688,11 @@ main (int argc, char *argv[])
 		(xdrproc_t)NULL,
 		(xdrproc_t)&xdr_data_t);
 
+	lwfs_register_xdr_encoding(3,
+		(xdrproc_t)&xdr_xfer_2_args,
+		(xdrproc_t)NULL,
+		(xdrproc_t)&xdr_data_t);
+
 
 	/* get the service description from the server */
 	if (myrank == 0) {
@@ -734,6 +833,44 @@ main (int argc, char *argv[])
 				time = lwfs_get_time() - start_time; 
                 break;
 
+            case XFER_READ_BLK:
+				start_time = lwfs_get_time();
+
+                for (j=0; j<args.num_reqs; j++) {
+                    rc = xfer_3_clnt_blk(&xfer_svc, &array, &result);
+                    if (rc != LWFS_OK) {
+                        log_error(xfer_debug_level, "could not transfer data: %s",
+                                lwfs_err_str(rc));
+                        goto cleanup;
+                    }
+                }
+
+				time = lwfs_get_time() - start_time; 
+                break;
+
+            case XFER_READ_NOBLK:
+				start_time = lwfs_get_time();
+
+                /* submit requests (all of them share one receive buffer) */
+                for (j=0; j<args.num_reqs; j++) {
+                    rc = xfer_3_clnt(&xfer_svc, &array, &results[j], &reqs[j]);
+                    if (rc != LWFS_OK) {
+                        log_error(xfer_debug_level, "could not transfer data: %s",
+                                lwfs_err_str(rc));
+                        goto cleanup;
+                    }
+                }
+
+                /* wait for results */
+                rc = lwfs_waitall(reqs, args.num_reqs, -1); 
+                if (rc != LWFS_OK) {
+                    log_error(xfer_debug_level, "error transferring data");
+                    goto cleanup; 
+                }	
+
+				time = lwfs_get_time() - start_time; 
+                break;
+
             default:
                 log_error(xfer_debug_level, "unrecognized experiment type");
                 return -1;
@@ -746,6 +883,11 @@ main (int argc, char *argv[])
 
 cleanup:
 
+	/* in steady state, the pools should only report reuses */
+	if (myrank == 0) {
+		fprint_lwfs_ptl_pool_stats(result_fp, "%");
+	}
+
 	free(array.data_array_t_val); 
 	free(results);
 	free(reqs); 
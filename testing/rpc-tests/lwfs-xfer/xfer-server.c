@@ -18,6 +18,7 @@
 #include "support/threadpool/thread_pool_debug.h"
 
 #include "common/rpc_common/lwfs_ptls.h"
+#include "common/rpc_common/ptl_pool.h"
 #include "common/types/types.h"
 #include "common/types/fprint_types.h"
 
@@ -87,11 +88,57 @@ int xfer_2_srvr(
 	return LWFS_OK; 
 }
 
+/**
+ * @brief Transfer an array of \ref data_t structures back to 
+ *        the client through the data portal. 
+ *
+ * This is the "read" direction: the server puts the array
+ * into the client's data buffer. 
+ */
+int xfer_3_srvr(
+	const lwfs_remote_pid *caller, 
+	const xfer_2_args *args,
+	const lwfs_rma *data_addr,
+	data_t *result)
+{
+	int rc = LWFS_OK;
+	int i; 
+
+	const int len = args->len; 
+	int nbytes = len*sizeof(data_t); 
+
+	/* allocate and fill the outgoing buffer */
+	data_t *buf = (data_t *)malloc(nbytes); 
+	if (buf == NULL) {
+		return LWFS_ERR_NOSPACE; 
+	}
+	for (i=0; i<len; i++) {
+		buf[i].int_val = (int)i;
+		buf[i].float_val = (float)i;
+		buf[i].double_val = (double)i;
+	}
+
+	/* send the data to the client */
+	rc = lwfs_put_data(buf, nbytes, data_addr); 
+	if (rc != LWFS_OK) {
+		log_warn(rpc_debug_level, "could not put data to client");
+		free(buf);
+		return LWFS_ERR_RPC; 
+	}
+
+	/* copy the last entry into the result */
+	memcpy(result, &buf[len-1], sizeof(data_t));
+
+	free(buf);
+
+	return LWFS_OK; 
+}
+
 
 
 static const lwfs_svc_op xfer_op_array[] = {
 	{
-		1,                                /* opcode */
+		XFER_1_OP,                        /* opcode */
 		(lwfs_rpc_proc)&xfer_1_srvr,        /* func */
 		sizeof(xfer_1_args),             /* sizeof args */
 		(xdrproc_t)&xdr_xfer_1_args,     /* decode args */
@@ -99,13 +146,21 @@ static const lwfs_svc_op xfer_op_array[] = {
 		(xdrproc_t)&xdr_data_t            /* encode res */
 	},
 	{
-		2,                                /* opcode */
+		XFER_2_OP,                        /* opcode */
 		(lwfs_rpc_proc)&xfer_2_srvr,        /* func */
 		sizeof(xfer_2_args),             /* sizeof args */
 		(xdrproc_t)&xdr_xfer_2_args,     /* decode args */
 		sizeof(data_t),                   /* sizeof res */
 		(xdrproc_t)&xdr_data_t            /* encode res */
 	},
+	{
+		XFER_3_OP,                        /* opcode */
+		(lwfs_rpc_proc)&xfer_3_srvr,        /* func */
+		sizeof(xfer_2_args),             /* sizeof args */
+		(xdrproc_t)&xdr_xfer_2_args,     /* decode args */
+		sizeof(data_t),                   /* sizeof res */
+		(xdrproc_t)&xdr_data_t            /* encode res */
+	},
 	{LWFS_OP_NULL}
 };
 
@@ -138,6 +193,9 @@ struct arguments {
 
 	/** @brief Use a threaded server. */
 	lwfs_bool use_threads;
+
+	/** @brief Longest sleep (in usecs) between polls of a transfer EQ. */
+	int poll_backoff;
 	
 	/** @brief Options to control the thread pool behavior */
 	struct thread_pool_options tp_opts;
@@ -160,6 +218,7 @@ static int print_args(FILE *fp, const char *prefix, struct arguments *args)
 	fprintf(fp, "%s \t--count = %d\n", prefix, args->count);
 	fprintf(fp, "%s \t--req-len = %d\n", prefix, args->req_len);
 	fprintf(fp, "%s \t--use-threads = %s\n", prefix, (args->use_threads)?"yes":"no");
+	fprintf(fp, "%s \t--poll-backoff = %d\n", prefix, args->poll_backoff);
 
     if (args->use_threads) {
 	    fprintf(fp, "%s \t--thread-debug-level = %d\n", prefix, args->thread_debug_level);
@@ -177,6 +236,7 @@ static struct argp_option options[] = {
 	{"index",      5, "<val>", 0, "Index of request portal"},
 	{"req-len",      6, "<val>", 0, "Length of a short request"},
     {"use-threads",   7, 0, 0, "Use a threaded server."},
+	{"poll-backoff",      8, "<usecs>", 0, "Longest sleep between polls of a transfer EQ (0=yield)"},
 
 	THREAD_POOL_OPTIONS,
 
@@ -228,6 +288,10 @@ static error_t parse_opt(
 			arguments->use_threads= TRUE;
 			break;
 
+		case 8: /* poll-backoff */
+			arguments->poll_backoff= atoi(arg);
+			break;
+
 		case ARGP_KEY_ARG:
 			/* we don't expect any arguments */
 			if (state->arg_num >= 0) {
@@ -275,6 +339,7 @@ int main(int argc, char **argv)
 	args.id.pid = 122; 
 	args.req_len = LWFS_SHORT_REQUEST_SIZE; 
 	args.use_threads = FALSE;
+	args.poll_backoff = 1000; 
 
 	/* defaults for thread pool */
 	load_default_thread_pool_opts(&args.tp_opts);
@@ -299,6 +364,7 @@ int main(int argc, char **argv)
 
 	/* initialize RPC */
 	lwfs_ptl_init(PTL_IFACE_DEFAULT, args.id.pid); 
+	lwfs_ptl_set_poll_backoff(args.poll_backoff); 
 	rc = lwfs_rpc_init(LWFS_RPC_PTL, LWFS_RPC_XDR);
 	if (rc != LWFS_OK) {
 		log_error(xfer_debug_level, "could not init RPC: %s",
@@ -319,7 +385,7 @@ int main(int argc, char **argv)
 	}
 
 	/* add the xfer operations to the list of supported ops */
-	rc = lwfs_service_add_ops(&xfer_svc, xfer_op_array, 2);
+	rc = lwfs_service_add_ops(&xfer_svc, xfer_op_array, 3);
 
 	/* print the arguments */
 	print_args(stdout, "", &args);
@@ -339,6 +405,9 @@ int main(int argc, char **argv)
 			lwfs_err_str(rc));
 	}
 
+	fprint_lwfs_ptl_pool_stats(stdout, "");
+	fprint_lwfs_ptl_poll_stats(stdout, "");
+
 	/* shutdown the xfer_svc */
 	log_debug(xfer_debug_level, "shutting down service library");
 	lwfs_service_fini(&xfer_svc); 
@@ -35,6 +35,9 @@ struct xfer_2_args {
 	int len;
 };
 typedef struct xfer_2_args xfer_2_args;
+#define XFER_1_OP 11
+#define XFER_2_OP 12
+#define XFER_3_OP 13
 
 #define XFER_PROG 0x23451111
 #define XFER_VERS 1
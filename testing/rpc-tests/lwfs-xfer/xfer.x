@@ -30,6 +30,11 @@ struct xfer_2_args {
 	int len; 
 }; 
 
+/* opcodes (the core service ops use 1-3) */
+const XFER_1_OP = 11;
+const XFER_2_OP = 12;
+const XFER_3_OP = 13;
+
 
 program XFER_PROG {
 	version XFER_VERS {
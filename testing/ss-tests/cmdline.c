@@ -1,7 +1,7 @@
 /*
   File autogenerated by gengetopt version 2.17
   generated with the following command:
-  /home/raoldfi/software/i386/bin/gengetopt -S --set-package=lwfs-tests --set-version=0.1 --output-dir=../../../../testing/ss-tests 
+  /home/raoldfi/software/i386/bin/gengetopt -S --set-package=lwfs-tests --set-version=0.1 --output-dir=../../../../testing/ss-tests
 
   The developers of gengetopt consider the fixed text that goes in all
   gengetopt output files to be in the public domain:
@@ -29,13 +29,15 @@ const char *gengetopt_args_info_help[] = {
   "  -h, --help                   Print help and exit",
   "  -V, --version                Print version and exit",
   "      --cid=INT                The container ID to use  (default=`1')",
-  "      --oid=INT                The object ID to use  (default=`1')",
+  "      --oid=STRING             The object ID to use  \n                                 (default=`00000000000000000000000000000000')",
   "      --num-objs=INT           The number of object to create/remove/...  \n                                 (default=`1')",
   "      --data=STRING            Character string stored in an object  \n                                 (default=`hello world')",
   "      --trunc-size=INT         Size (bytes) of a file after the trunc test  \n                                 (default=`32')",
   "      --attr-name=STRING       Name of an attribute  (default=`testattr')",
   "      --attr-val=STRING        Value to store in an attribute  \n                                 (default=`testvalue')",
-  "      --test=STRING            Name of the test  (possible values=\"exists\", \n                                 \"create\", \"read\", \"write\", \"setattr\", \n                                 \"getattr\", \"listattr\", \"rmattr\", \n                                 \"stat\", \"remove\" default=`exists')",
+  "      --test=STRING            Name of the test  (possible values=\"exists\", \n                                 \"create\", \"read\", \"aread\", \"write\", \n                                 \"awrite\", \"setattr\", \"getattr\", \n                                 \"listattr\", \"rmattr\", \"stat\", \n                                 \"remove\", \"compound\", \"vector\" \n                                 default=`exists')",
+  "      --vector-ss-pid=INT      PID of the second storage server in the vector \n                                 test  (default=`123')",
+  "      --test-pid=INT           The process ID to use for the test client  \n                                 (default=`128')",
   "      --verbose=INT            Debug level of logger [0-5]  (default=`5')",
   "      --logfile=STRING         Path to logfile",
   "      --authr-pid=LONG         PID of the authr server  (default=`124')",
@@ -83,7 +85,7 @@ free_cmd_list(void)
 }
 
 
-char *cmdline_parser_test_values[] = {"exists", "create", "read", "write", "setattr", "getattr", "listattr", "rmattr", "stat", "remove", 0} ;	/* Possible values for test.  */
+char *cmdline_parser_test_values[] = {"exists", "create", "read", "aread", "write", "awrite", "setattr", "getattr", "listattr", "rmattr", "stat", "remove", "compound", "vector", 0} ;	/* Possible values for test.  */
 
 static char *
 gengetopt_strdup (const char *s);
@@ -101,6 +103,8 @@ void clear_given (struct gengetopt_args_info *args_info)
   args_info->attr_name_given = 0 ;
   args_info->attr_val_given = 0 ;
   args_info->test_given = 0 ;
+  args_info->vector_ss_pid_given = 0 ;
+  args_info->test_pid_given = 0 ;
   args_info->verbose_given = 0 ;
   args_info->logfile_given = 0 ;
   args_info->authr_pid_given = 0 ;
@@ -117,7 +121,7 @@ void clear_args (struct gengetopt_args_info *args_info)
 {
   args_info->cid_arg = 1;
   args_info->cid_orig = NULL;
-  args_info->oid_arg = 1;
+  args_info->oid_arg = gengetopt_strdup ("00000000000000000000000000000000");
   args_info->oid_orig = NULL;
   args_info->num_objs_arg = 1;
   args_info->num_objs_orig = NULL;
@@ -131,6 +135,10 @@ void clear_args (struct gengetopt_args_info *args_info)
   args_info->attr_val_orig = NULL;
   args_info->test_arg = gengetopt_strdup ("exists");
   args_info->test_orig = NULL;
+  args_info->vector_ss_pid_arg = 123;
+  args_info->vector_ss_pid_orig = NULL;
+  args_info->test_pid_arg = 128;
+  args_info->test_pid_orig = NULL;
   args_info->verbose_arg = 5;
   args_info->verbose_orig = NULL;
   args_info->logfile_arg = NULL;
@@ -164,15 +172,17 @@ void init_args_info(struct gengetopt_args_info *args_info)
   args_info->attr_name_help = gengetopt_args_info_help[7] ;
   args_info->attr_val_help = gengetopt_args_info_help[8] ;
   args_info->test_help = gengetopt_args_info_help[9] ;
-  args_info->verbose_help = gengetopt_args_info_help[10] ;
-  args_info->logfile_help = gengetopt_args_info_help[11] ;
-  args_info->authr_pid_help = gengetopt_args_info_help[12] ;
-  args_info->authr_nid_help = gengetopt_args_info_help[13] ;
-  args_info->authr_cache_caps_help = gengetopt_args_info_help[14] ;
-  args_info->ss_server_file_help = gengetopt_args_info_help[15] ;
-  args_info->ss_num_servers_help = gengetopt_args_info_help[16] ;
-  args_info->ss_pid_help = gengetopt_args_info_help[17] ;
-  args_info->ss_nid_help = gengetopt_args_info_help[18] ;
+  args_info->vector_ss_pid_help = gengetopt_args_info_help[10] ;
+  args_info->test_pid_help = gengetopt_args_info_help[11] ;
+  args_info->verbose_help = gengetopt_args_info_help[12] ;
+  args_info->logfile_help = gengetopt_args_info_help[13] ;
+  args_info->authr_pid_help = gengetopt_args_info_help[14] ;
+  args_info->authr_nid_help = gengetopt_args_info_help[15] ;
+  args_info->authr_cache_caps_help = gengetopt_args_info_help[16] ;
+  args_info->ss_server_file_help = gengetopt_args_info_help[17] ;
+  args_info->ss_num_servers_help = gengetopt_args_info_help[18] ;
+  args_info->ss_pid_help = gengetopt_args_info_help[19] ;
+  args_info->ss_nid_help = gengetopt_args_info_help[20] ;
   
 }
 
@@ -213,6 +223,11 @@ cmdline_parser_release (struct gengetopt_args_info *args_info)
       free (args_info->cid_orig); /* free previous argument */
       args_info->cid_orig = 0;
     }
+  if (args_info->oid_arg)
+    {
+      free (args_info->oid_arg); /* free previous argument */
+      args_info->oid_arg = 0;
+    }
   if (args_info->oid_orig)
     {
       free (args_info->oid_orig); /* free previous argument */
@@ -268,6 +283,16 @@ cmdline_parser_release (struct gengetopt_args_info *args_info)
       free (args_info->test_orig); /* free previous argument */
       args_info->test_orig = 0;
     }
+  if (args_info->vector_ss_pid_orig)
+    {
+      free (args_info->vector_ss_pid_orig); /* free previous argument */
+      args_info->vector_ss_pid_orig = 0;
+    }
+  if (args_info->test_pid_orig)
+    {
+      free (args_info->test_pid_orig); /* free previous argument */
+      args_info->test_pid_orig = 0;
+    }
   if (args_info->verbose_orig)
     {
       free (args_info->verbose_orig); /* free previous argument */
@@ -398,6 +423,20 @@ cmdline_parser_file_save(const char *filename, struct gengetopt_args_info *args_
       fprintf(outfile, "%s\n", "test");
     }
   }
+  if (args_info->vector_ss_pid_given) {
+    if (args_info->vector_ss_pid_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "vector-ss-pid", args_info->vector_ss_pid_orig);
+    } else {
+      fprintf(outfile, "%s\n", "vector-ss-pid");
+    }
+  }
+  if (args_info->test_pid_given) {
+    if (args_info->test_pid_orig) {
+      fprintf(outfile, "%s=\"%s\"\n", "test-pid", args_info->test_pid_orig);
+    } else {
+      fprintf(outfile, "%s\n", "test-pid");
+    }
+  }
   if (args_info->verbose_given) {
     if (args_info->verbose_orig) {
       fprintf(outfile, "%s=\"%s\"\n", "verbose", args_info->verbose_orig);
@@ -612,6 +651,8 @@ cmdline_parser_internal (int argc, char * const *argv, struct gengetopt_args_inf
         { "attr-name",	1, NULL, 0 },
         { "attr-val",	1, NULL, 0 },
         { "test",	1, NULL, 0 },
+        { "vector-ss-pid",	1, NULL, 0 },
+        { "test-pid",	1, NULL, 0 },
         { "verbose",	1, NULL, 0 },
         { "logfile",	1, NULL, 0 },
         { "authr-pid",	1, NULL, 0 },
@@ -676,11 +717,9 @@ cmdline_parser_internal (int argc, char * const *argv, struct gengetopt_args_inf
               continue;
             local_args_info.oid_given = 1;
             args_info->oid_given = 1;
-            args_info->oid_arg = strtol (optarg, &stop_char, 0);
-            if (!(stop_char && *stop_char == '\0')) {
-              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
-              goto failure;
-            }
+            if (args_info->oid_arg)
+              free (args_info->oid_arg); /* free previous string */
+            args_info->oid_arg = gengetopt_strdup (optarg);
             if (args_info->oid_orig)
               free (args_info->oid_orig); /* free previous string */
             args_info->oid_orig = gengetopt_strdup (optarg);
@@ -808,6 +847,48 @@ cmdline_parser_internal (int argc, char * const *argv, struct gengetopt_args_inf
               free (args_info->test_orig); /* free previous string */
             args_info->test_orig = gengetopt_strdup (optarg);
           }
+          /* PID of the second storage server in the vector test.  */
+          else if (strcmp (long_options[option_index].name, "vector-ss-pid") == 0)
+          {
+            if (local_args_info.vector_ss_pid_given)
+              {
+                fprintf (stderr, "%s: `--vector-ss-pid' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->vector_ss_pid_given && ! override)
+              continue;
+            local_args_info.vector_ss_pid_given = 1;
+            args_info->vector_ss_pid_given = 1;
+            args_info->vector_ss_pid_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->vector_ss_pid_orig)
+              free (args_info->vector_ss_pid_orig); /* free previous string */
+            args_info->vector_ss_pid_orig = gengetopt_strdup (optarg);
+          }
+          /* The process ID to use for the test client.  */
+          else if (strcmp (long_options[option_index].name, "test-pid") == 0)
+          {
+            if (local_args_info.test_pid_given)
+              {
+                fprintf (stderr, "%s: `--test-pid' option given more than once%s\n", argv[0], (additional_error ? additional_error : ""));
+                goto failure;
+              }
+            if (args_info->test_pid_given && ! override)
+              continue;
+            local_args_info.test_pid_given = 1;
+            args_info->test_pid_given = 1;
+            args_info->test_pid_arg = strtol (optarg, &stop_char, 0);
+            if (!(stop_char && *stop_char == '\0')) {
+              fprintf(stderr, "%s: invalid numeric value: %s\n", argv[0], optarg);
+              goto failure;
+            }
+            if (args_info->test_pid_orig)
+              free (args_info->test_pid_orig); /* free previous string */
+            args_info->test_pid_orig = gengetopt_strdup (optarg);
+          }
           /* Debug level of logger [0-5].  */
           else if (strcmp (long_options[option_index].name, "verbose") == 0)
           {
@@ -29,7 +29,7 @@ struct gengetopt_args_info
   int cid_arg;	/* The container ID to use (default='1').  */
   char * cid_orig;	/* The container ID to use original value given at command line.  */
   const char *cid_help; /* The container ID to use help description.  */
-  int oid_arg;	/* The object ID to use (default='1').  */
+  char * oid_arg;	/* The object ID to use (default='00000000000000000000000000000000').  */
   char * oid_orig;	/* The object ID to use original value given at command line.  */
   const char *oid_help; /* The object ID to use help description.  */
   int num_objs_arg;	/* The number of object to create/remove/... (default='1').  */
@@ -50,6 +50,12 @@ struct gengetopt_args_info
   char * test_arg;	/* Name of the test (default='exists').  */
   char * test_orig;	/* Name of the test original value given at command line.  */
   const char *test_help; /* Name of the test help description.  */
+  int vector_ss_pid_arg;	/* PID of the second storage server in the vector test (default='123').  */
+  char * vector_ss_pid_orig;	/* PID of the second storage server in the vector test original value given at command line.  */
+  const char *vector_ss_pid_help; /* PID of the second storage server in the vector test help description.  */
+  int test_pid_arg;	/* The process ID to use for the test client (default='128').  */
+  char * test_pid_orig;	/* The process ID to use for the test client original value given at command line.  */
+  const char *test_pid_help; /* The process ID to use for the test client help description.  */
   int verbose_arg;	/* Debug level of logger [0-5] (default='5').  */
   char * verbose_orig;	/* Debug level of logger [0-5] original value given at command line.  */
   const char *verbose_help; /* Debug level of logger [0-5] help description.  */
@@ -87,6 +93,8 @@ struct gengetopt_args_info
   int attr_name_given ;	/* Whether attr-name was given.  */
   int attr_val_given ;	/* Whether attr-val was given.  */
   int test_given ;	/* Whether test was given.  */
+  int vector_ss_pid_given ;	/* Whether vector-ss-pid was given.  */
+  int test_pid_given ;	/* Whether test-pid was given.  */
   int verbose_given ;	/* Whether verbose was given.  */
   int logfile_given ;	/* Whether logfile was given.  */
   int authr_pid_given ;	/* Whether authr-pid was given.  */
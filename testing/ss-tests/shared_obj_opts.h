@@ -0,0 +1,139 @@
+/* shared_obj_opts.h */
+
+/* File autogenerated by gengetopt version 2.17  */
+
+#ifndef SHARED_OBJ_OPTS_H
+#define SHARED_OBJ_OPTS_H
+
+/* If we use autoconf.  */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#ifndef CMDLINE_PARSER_PACKAGE
+#define CMDLINE_PARSER_PACKAGE "lwfs-tests"
+#endif
+
+#ifndef CMDLINE_PARSER_VERSION
+#define CMDLINE_PARSER_VERSION "0.1"
+#endif
+
+struct gengetopt_args_info
+{
+  const char *help_help; /* Print help and exit help description.  */
+  const char *version_help; /* Print version and exit help description.  */
+  int cid_arg;	/* The container ID to use (default='1').  */
+  char * cid_orig;	/* The container ID to use original value given at command line.  */
+  const char *cid_help; /* The container ID to use help description.  */
+  char * oid_arg;	/* The object ID to use (default='00000000000000000000000000000001').  */
+  char * oid_orig;	/* The object ID to use original value given at command line.  */
+  const char *oid_help; /* The object ID to use help description.  */
+  char * test_arg;	/* Name of the test (default='write').  */
+  char * test_orig;	/* Name of the test original value given at command line.  */
+  const char *test_help; /* Name of the test help description.  */
+  int max_threads_arg;	/* Run with 1, 2, 4, ... up to this many threads (default='8').  */
+  char * max_threads_orig;	/* Run with 1, 2, 4, ... up to this many threads original value given at command line.  */
+  const char *max_threads_help; /* Run with 1, 2, 4, ... up to this many threads help description.  */
+  int blk_size_arg;	/* Bytes per read/write request (default='1048576').  */
+  char * blk_size_orig;	/* Bytes per read/write request original value given at command line.  */
+  const char *blk_size_help; /* Bytes per read/write request help description.  */
+  int blks_per_thread_arg;	/* Requests issued by each thread (default='16').  */
+  char * blks_per_thread_orig;	/* Requests issued by each thread original value given at command line.  */
+  const char *blks_per_thread_help; /* Requests issued by each thread help description.  */
+  int num_trials_arg;	/* Number of trials for each thread count (default='3').  */
+  char * num_trials_orig;	/* Number of trials for each thread count original value given at command line.  */
+  const char *num_trials_help; /* Number of trials for each thread count help description.  */
+  char * result_file_arg;	/* Where to append the results (default='').  */
+  char * result_file_orig;	/* Where to append the results original value given at command line.  */
+  const char *result_file_help; /* Where to append the results help description.  */
+  int test_pid_arg;	/* The process ID to use for the test client (default='128').  */
+  char * test_pid_orig;	/* The process ID to use for the test client original value given at command line.  */
+  const char *test_pid_help; /* The process ID to use for the test client help description.  */
+  int verbose_arg;	/* Debug level of logger [0-5] (default='5').  */
+  char * verbose_orig;	/* Debug level of logger [0-5] original value given at command line.  */
+  const char *verbose_help; /* Debug level of logger [0-5] help description.  */
+  char * logfile_arg;	/* Path to logfile.  */
+  char * logfile_orig;	/* Path to logfile original value given at command line.  */
+  const char *logfile_help; /* Path to logfile help description.  */
+  long authr_pid_arg;	/* PID of the authr server (default='124').  */
+  char * authr_pid_orig;	/* PID of the authr server original value given at command line.  */
+  const char *authr_pid_help; /* PID of the authr server help description.  */
+  long authr_nid_arg;	/* NID of the authr server (default='0').  */
+  char * authr_nid_orig;	/* NID of the authr server original value given at command line.  */
+  const char *authr_nid_help; /* NID of the authr server help description.  */
+  int authr_cache_caps_flag;	/* Cache caps on the client (default=off).  */
+  const char *authr_cache_caps_help; /* Cache caps on the client help description.  */
+  char * ss_server_file_arg;	/* Path to a file with a list of storage servers.  */
+  char * ss_server_file_orig;	/* Path to a file with a list of storage servers original value given at command line.  */
+  const char *ss_server_file_help; /* Path to a file with a list of storage servers help description.  */
+  int ss_num_servers_arg;	/* Number of servers to use from the server file (default='1').  */
+  char * ss_num_servers_orig;	/* Number of servers to use from the server file original value given at command line.  */
+  const char *ss_num_servers_help; /* Number of servers to use from the server file help description.  */
+  int ss_pid_arg;	/* The PID of a single remote storage storage server (ignored if using --ss=server-file) (default='122').  */
+  char * ss_pid_orig;	/* The PID of a single remote storage storage server (ignored if using --ss=server-file) original value given at command line.  */
+  const char *ss_pid_help; /* The PID of a single remote storage storage server (ignored if using --ss=server-file) help description.  */
+  long ss_nid_arg;	/* The NID of a single remote storage server (ignored if using --ss-server-file) (default='0').  */
+  char * ss_nid_orig;	/* The NID of a single remote storage server (ignored if using --ss-server-file) original value given at command line.  */
+  const char *ss_nid_help; /* The NID of a single remote storage server (ignored if using --ss-server-file) help description.  */
+  
+  int help_given ;	/* Whether help was given.  */
+  int version_given ;	/* Whether version was given.  */
+  int cid_given ;	/* Whether cid was given.  */
+  int oid_given ;	/* Whether oid was given.  */
+  int test_given ;	/* Whether test was given.  */
+  int max_threads_given ;	/* Whether max-threads was given.  */
+  int blk_size_given ;	/* Whether blk-size was given.  */
+  int blks_per_thread_given ;	/* Whether blks-per-thread was given.  */
+  int num_trials_given ;	/* Whether num-trials was given.  */
+  int result_file_given ;	/* Whether result-file was given.  */
+  int test_pid_given ;	/* Whether test-pid was given.  */
+  int verbose_given ;	/* Whether verbose was given.  */
+  int logfile_given ;	/* Whether logfile was given.  */
+  int authr_pid_given ;	/* Whether authr-pid was given.  */
+  int authr_nid_given ;	/* Whether authr-nid was given.  */
+  int authr_cache_caps_given ;	/* Whether authr-cache-caps was given.  */
+  int ss_server_file_given ;	/* Whether ss-server-file was given.  */
+  int ss_num_servers_given ;	/* Whether ss-num-servers was given.  */
+  int ss_pid_given ;	/* Whether ss-pid was given.  */
+  int ss_nid_given ;	/* Whether ss-nid was given.  */
+
+} ;
+
+extern const char *gengetopt_args_info_purpose;
+extern const char *gengetopt_args_info_usage;
+extern const char *gengetopt_args_info_help[];
+
+int cmdline_parser (int argc, char * const *argv,
+  struct gengetopt_args_info *args_info);
+int cmdline_parser2 (int argc, char * const *argv,
+  struct gengetopt_args_info *args_info,
+  int override, int initialize, int check_required);
+int cmdline_parser_file_save(const char *filename,
+  struct gengetopt_args_info *args_info);
+
+void cmdline_parser_print_help(void);
+void cmdline_parser_print_version(void);
+
+void cmdline_parser_init (struct gengetopt_args_info *args_info);
+void cmdline_parser_free (struct gengetopt_args_info *args_info);
+
+int cmdline_parser_string (const char *cmdline, struct gengetopt_args_info *args_info,
+  const char *prog_name);
+int cmdline_parser_string2 (const char *cmdline, struct gengetopt_args_info *args_info,
+  const char *prog_name,
+  int override, int initialize, int check_required);
+
+int cmdline_parser_required (struct gengetopt_args_info *args_info,
+  const char *prog_name);
+
+extern char *cmdline_parser_test_values[] ;	/* Possible values for test.  */
+
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* SHARED_OBJ_OPTS_H */
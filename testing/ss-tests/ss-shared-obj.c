@@ -0,0 +1,361 @@
+/**  @file ss-shared-obj.c
+ *
+ *   @brief Measure the throughput of threads that share one object.
+ *
+ *   Each thread reads or writes its own extent of a single
+ *   object (thread i owns blocks i*blks-per-thread through
+ *   (i+1)*blks-per-thread-1).  The test runs with 1, 2, 4, ...
+ *   threads, up to max-threads, and reports the aggregate
+ *   throughput for each thread count.  If the storage server
+ *   serializes I/O to an object, the throughput stays flat as
+ *   the number of threads grows.
+ *
+ *   Run the "write" test before the "read" test so the object
+ *   has data.
+ *
+ *   @author Ron Oldfield (raoldfi@sandia.gov)
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <pthread.h>
+#include <getopt.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "shared_obj_opts.h"
+#include "common/types/types.h"
+#include "client/storage_client/storage_client.h"
+#include "client/storage_client/storage_client_sync.h"
+#include "client/storage_client/storage_client_opts.h"
+#include "client/authr_client/authr_client_opts.h"
+#include "support/timer/timer.h"
+#include "support/logger/logger_opts.h"
+#include "perms.h"
+
+
+const int FAILED = -1;
+const int PASSED = 0;
+
+/**
+ * @brief Arguments for one I/O thread.
+ */
+struct thread_args {
+	int rank;
+	lwfs_bool write_op;
+	const lwfs_obj *obj;
+	const lwfs_cap *cap;
+	int blk_size;
+	int blks_per_thread;
+	char *buf;
+	int rc;
+};
+
+/* -------------- PRIVATE METHODS -------------- */
+
+static void print_args(
+		FILE *fp,
+		const struct gengetopt_args_info *args_info,
+		const char *prefix)
+{
+	fprintf(fp, "%s test = %s\n", prefix, args_info->test_arg);
+	fprintf(fp, "%s max-threads = %d\n", prefix, args_info->max_threads_arg);
+	fprintf(fp, "%s blk-size = %d\n", prefix, args_info->blk_size_arg);
+	fprintf(fp, "%s blks-per-thread = %d\n", prefix, args_info->blks_per_thread_arg);
+	fprintf(fp, "%s num-trials = %d\n", prefix, args_info->num_trials_arg);
+	print_logger_opts(fp, args_info, prefix);
+	print_authr_client_opts(fp, args_info, prefix);
+	print_storage_client_opts(fp, args_info, prefix);
+}
+
+static void str_to_oid(char *str, lwfs_oid oid)
+{
+	char *oid_char = (char*)oid;
+
+	sscanf(str, "%08X%08X%08X%08X",
+		(uint32_t *)&(oid_char[0]), (uint32_t *)&(oid_char[4]), (uint32_t *)&(oid_char[8]), (uint32_t *)&(oid_char[12]));
+}
+
+/**
+ * @brief Read or write the extent of one thread.
+ */
+static void *do_io(void *arg)
+{
+	struct thread_args *targs = (struct thread_args *)arg;
+	lwfs_size offset;
+	lwfs_size bytes;
+	int i;
+
+	targs->rc = LWFS_OK;
+
+	for (i=0; i<targs->blks_per_thread; i++) {
+		offset = ((lwfs_size)targs->rank*targs->blks_per_thread + i)
+			* targs->blk_size;
+
+		if (targs->write_op) {
+			targs->rc = lwfs_write_sync(NULL, targs->obj, offset,
+					targs->buf, targs->blk_size, targs->cap);
+		}
+		else {
+			targs->rc = lwfs_read_sync(NULL, targs->obj, offset,
+					targs->buf, targs->blk_size, targs->cap, &bytes);
+			if ((targs->rc == LWFS_OK) && (bytes != (lwfs_size)targs->blk_size)) {
+				log_error(ss_debug_level, "thread %d: short read (%d of %d bytes)",
+						targs->rank, (int)bytes, targs->blk_size);
+				targs->rc = LWFS_ERR_STORAGE;
+			}
+		}
+
+		if (targs->rc != LWFS_OK) {
+			log_error(ss_debug_level, "thread %d: I/O failed: %s",
+					targs->rank, lwfs_err_str(targs->rc));
+			break;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Run one trial with \em num_threads threads.
+ *
+ * @returns the elapsed time (in seconds), or a negative value on error.
+ */
+static double run_trial(
+		const int num_threads,
+		struct thread_args *targs)
+{
+	pthread_t *threads = NULL;
+	double start;
+	double elapsed;
+	int i;
+
+	threads = (pthread_t *)calloc(num_threads, sizeof(pthread_t));
+	if (threads == NULL) {
+		return -1.0;
+	}
+
+	start = lwfs_get_time();
+
+	for (i=0; i<num_threads; i++) {
+		if (pthread_create(&threads[i], NULL, do_io, &targs[i]) != 0) {
+			log_error(ss_debug_level, "could not start thread %d", i);
+			targs[i].rc = LWFS_ERR;
+			threads[i] = pthread_self();
+		}
+	}
+
+	for (i=0; i<num_threads; i++) {
+		if (!pthread_equal(threads[i], pthread_self())) {
+			pthread_join(threads[i], NULL);
+		}
+	}
+
+	elapsed = lwfs_get_time() - start;
+	free(threads);
+
+	for (i=0; i<num_threads; i++) {
+		if (targs[i].rc != LWFS_OK) {
+			return -1.0;
+		}
+	}
+
+	return elapsed;
+}
+
+
+int main(int argc, char *argv[])
+{
+	int rc = PASSED;
+	int i, j;
+	int num_threads;
+	char ostr[33];
+	FILE *result_fp = stdout;
+
+	lwfs_remote_pid authr_id;
+	lwfs_remote_pid ss_id;
+
+	/* arguments */
+	struct gengetopt_args_info args_info;
+
+	lwfs_service storage_svc;
+	lwfs_service authr_svc;
+
+	lwfs_cred cred;
+	lwfs_opcode opcodes;
+	lwfs_cap cap;
+	lwfs_obj obj;
+	lwfs_oid cli_oid;
+	lwfs_bool write_op;
+
+	struct thread_args *targs = NULL;
+
+	/* Parse the command-line arguments */
+	if (cmdline_parser(argc, argv, &args_info) != 0)
+		return (1);
+
+	/* initialize RPC before we do anything */
+#ifdef PTL_IFACE_CLIENT
+	lwfs_ptl_init(PTL_IFACE_CLIENT, args_info.test_pid_arg);
+#else
+	lwfs_ptl_init(PTL_IFACE_DEFAULT, args_info.test_pid_arg);
+#endif
+	lwfs_rpc_init(LWFS_RPC_PTL, LWFS_RPC_XDR);
+
+	/* initialize the logger */
+	logger_init(args_info.verbose_arg, args_info.logfile_arg);
+
+	if ((args_info.max_threads_arg < 1) ||
+	    (args_info.blk_size_arg < 1) ||
+	    (args_info.blks_per_thread_arg < 1) ||
+	    (args_info.num_trials_arg < 1)) {
+		log_error(ss_debug_level, "thread, block, and trial counts must be positive");
+		return 1;
+	}
+
+	write_op = (strcmp("write", args_info.test_arg) == 0);
+
+	/* initialize credentials */
+	memset(&cred, 0, sizeof(lwfs_cred));
+	cred.data.uid[0] = 1;
+
+	/* get the descriptor for the authorization service */
+	authr_id.nid = args_info.authr_nid_arg;
+	authr_id.pid = args_info.authr_pid_arg;
+	rc = lwfs_get_service(authr_id, &authr_svc);
+	if (rc != LWFS_OK) {
+		log_error(ss_debug_level, "unable to get authr service descriptor: %s",
+				lwfs_err_str(rc));
+		return rc;
+	}
+
+	/* get the storage service descriptor */
+	ss_id.nid = args_info.ss_nid_arg;
+	ss_id.pid = args_info.ss_pid_arg;
+	rc = lwfs_get_service(ss_id, &storage_svc);
+	if (rc != LWFS_OK) {
+		log_error(ss_debug_level, "unable to get storage service descriptor: %s",
+				lwfs_err_str(rc));
+		return rc;
+	}
+
+	print_args(logger_get_file(), &args_info, "");
+
+	if (strlen(args_info.result_file_arg) > 0) {
+		result_fp = fopen(args_info.result_file_arg, "a");
+		if (result_fp == NULL) {
+			log_error(ss_debug_level, "could not open %s",
+					args_info.result_file_arg);
+			return 1;
+		}
+	}
+
+	/* get a cap to read and write the container */
+	opcodes = LWFS_CONTAINER_WRITE | LWFS_CONTAINER_READ;
+	rc = get_perms(&authr_svc, &cred, args_info.cid_arg, opcodes, &cap);
+	if (rc != LWFS_OK) {
+		log_error(ss_debug_level, "unable to get perms: %s",
+				lwfs_err_str(rc));
+		rc = FAILED;
+		goto cleanup;
+	}
+
+	/* every thread uses the same object */
+	str_to_oid(args_info.oid_arg, cli_oid);
+	lwfs_init_obj(&storage_svc, 0, args_info.cid_arg, cli_oid, &obj);
+
+	if (write_op) {
+		rc = lwfs_create_obj_sync(NULL, &obj, &cap);
+		if ((rc != LWFS_OK) && (rc != LWFS_ERR_EXIST)) {
+			log_error(ss_debug_level, "could not create obj 0x%s: %s",
+					lwfs_oid_to_string(cli_oid, ostr), lwfs_err_str(rc));
+			rc = FAILED;
+			goto cleanup;
+		}
+	}
+
+	/* allocate the thread arguments (one buffer per thread) */
+	targs = (struct thread_args *)calloc(args_info.max_threads_arg,
+			sizeof(struct thread_args));
+	if (targs == NULL) {
+		rc = FAILED;
+		goto cleanup;
+	}
+	for (i=0; i<args_info.max_threads_arg; i++) {
+		targs[i].rank = i;
+		targs[i].write_op = write_op;
+		targs[i].obj = &obj;
+		targs[i].cap = &cap;
+		targs[i].blk_size = args_info.blk_size_arg;
+		targs[i].blks_per_thread = args_info.blks_per_thread_arg;
+		targs[i].buf = (char *)malloc(args_info.blk_size_arg);
+		if (targs[i].buf == NULL) {
+			log_error(ss_debug_level, "could not allocate buffer");
+			rc = FAILED;
+			goto cleanup;
+		}
+		memset(targs[i].buf, 'a' + (i % 26), args_info.blk_size_arg);
+	}
+
+	fprintf(result_fp, "%% %s shared object, blk-size=%d, blks-per-thread=%d\n",
+			args_info.test_arg, args_info.blk_size_arg,
+			args_info.blks_per_thread_arg);
+	fprintf(result_fp, "%% threads   trial   bytes          time(s)        MB/s\n");
+
+	/* run the trials for 1, 2, 4, ... threads */
+	for (num_threads = 1; ; num_threads *= 2) {
+
+		if (num_threads > args_info.max_threads_arg) {
+			num_threads = args_info.max_threads_arg;
+		}
+
+		for (j=0; j<args_info.num_trials_arg; j++) {
+			double bytes = (double)num_threads
+				* args_info.blks_per_thread_arg
+				* args_info.blk_size_arg;
+			double elapsed = run_trial(num_threads, targs);
+
+			if (elapsed < 0) {
+				log_error(ss_debug_level, "trial failed (threads=%d)", num_threads);
+				rc = FAILED;
+				goto cleanup;
+			}
+
+			fprintf(result_fp, "%9d   %5d   %12.0f   %1.6e   %1.6e\n",
+					num_threads, j, bytes, elapsed,
+					(bytes/(1024.0*1024.0))/elapsed);
+			fflush(result_fp);
+		}
+
+		if (num_threads == args_info.max_threads_arg) {
+			break;
+		}
+	}
+
+	rc = PASSED;
+
+cleanup:
+	if (targs != NULL) {
+		for (i=0; i<args_info.max_threads_arg; i++) {
+			if (targs[i].buf) free(targs[i].buf);
+		}
+		free(targs);
+	}
+
+	if (result_fp != stdout) {
+		fclose(result_fp);
+	}
+
+	cmdline_parser_free(&args_info);
+
+	if (rc == PASSED) {
+		fprintf(stdout, "PASSED\n");
+	}
+	else {
+		fprintf(stdout, "FAILED\n");
+	}
+	return rc;
+}
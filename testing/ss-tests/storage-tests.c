@@ -60,6 +60,264 @@ struct async_req {
 	lwfs_size bytes;
 };
 
+/**
+ * Test LWFS_OP_COMPOUND on one object: create+write+fsync+stat, 
+ * a list that fails in the middle, and a bad cap. 
+ */
+static int compound_test(
+		const lwfs_txn *txn, 
+		const lwfs_obj *obj, 
+		const lwfs_cap *cap, 
+		const char *data)
+{
+	int rc = LWFS_OK;
+	int result = FAILED;
+	ss_compound_op ops[4];
+	ss_compound_res res;
+	lwfs_obj missing;
+	lwfs_cap bad_cap;
+	u_int i;
+
+	memset(ops, 0, sizeof(ops));
+	memset(&res, 0, sizeof(res));
+
+	/* create, write, fsync, and stat in one request */
+	for (i=0; i<4; i++) {
+		memcpy(&ops[i].obj, obj, sizeof(lwfs_obj));
+	}
+	ops[0].args.op = SS_COMPOUND_CREATE;
+	ops[1].args.op = SS_COMPOUND_WRITE;
+	ops[1].args.ss_compound_op_args_u.write.offset = 0;
+	ops[1].args.ss_compound_op_args_u.write.data.data_len = strlen(data);
+	ops[1].args.ss_compound_op_args_u.write.data.data_val = (char *)data;
+	ops[2].args.op = SS_COMPOUND_FSYNC;
+	ops[3].args.op = SS_COMPOUND_STAT;
+
+	rc = lwfs_compound_sync(txn, ops, 4, cap, &res);
+	if (rc != LWFS_OK) {
+		log_error(ss_debug_level, "compound create/write/fsync failed: %s",
+				lwfs_err_str(rc));
+		goto cleanup;
+	}
+	if (res.results.results_len != 4) {
+		log_error(ss_debug_level, "expected 4 results, got %u",
+				res.results.results_len);
+		goto cleanup;
+	}
+	for (i=0; i<4; i++) {
+		if (res.results.results_val[i].rc != LWFS_OK) {
+			log_error(ss_debug_level, "compound op %u failed: %s",
+					i, lwfs_err_str(res.results.results_val[i].rc));
+			goto cleanup;
+		}
+	}
+	if (res.results.results_val[3].res.ss_compound_op_res_u.stat.size != strlen(data)) {
+		log_error(ss_debug_level, "stat size=%d, expected %d",
+				(int)res.results.results_val[3].res.ss_compound_op_res_u.stat.size,
+				(int)strlen(data));
+		goto cleanup;
+	}
+	xdr_free((xdrproc_t)xdr_ss_compound_res, (char *)&res);
+	memset(&res, 0, sizeof(res));
+
+	/* the second op names an object that does not exist; the 
+	 * server stops there, so the third op never runs */
+	memcpy(&missing, obj, sizeof(lwfs_obj));
+	missing.oid[0] ^= 0xff;
+
+	memset(ops, 0, sizeof(ops));
+	memcpy(&ops[0].obj, obj, sizeof(lwfs_obj));
+	ops[0].args.op = SS_COMPOUND_STAT;
+	memcpy(&ops[1].obj, &missing, sizeof(lwfs_obj));
+	ops[1].args.op = SS_COMPOUND_TRUNCATE;
+	ops[1].args.ss_compound_op_args_u.size = 0;
+	memcpy(&ops[2].obj, obj, sizeof(lwfs_obj));
+	ops[2].args.op = SS_COMPOUND_TRUNCATE;
+	ops[2].args.ss_compound_op_args_u.size = 0;
+
+	rc = lwfs_compound_sync(txn, ops, 3, cap, &res);
+	if (rc == LWFS_OK) {
+		log_error(ss_debug_level, "compound with a missing object succeeded");
+		goto cleanup;
+	}
+	if ((res.results.results_len != 2)
+			|| (res.results.results_val[0].rc != LWFS_OK)
+			|| (res.results.results_val[1].rc != rc)) {
+		log_error(ss_debug_level, "expected 2 results (OK, %s), got %u",
+				lwfs_err_str(rc), res.results.results_len);
+		goto cleanup;
+	}
+	xdr_free((xdrproc_t)xdr_ss_compound_res, (char *)&res);
+	memset(&res, 0, sizeof(res));
+
+	/* the third op did not run, the data is still there */
+	memset(ops, 0, sizeof(ops));
+	memcpy(&ops[0].obj, obj, sizeof(lwfs_obj));
+	ops[0].args.op = SS_COMPOUND_STAT;
+	rc = lwfs_compound_sync(txn, ops, 1, cap, &res);
+	if ((rc != LWFS_OK) || (res.results.results_len != 1)
+			|| (res.results.results_val[0].res.ss_compound_op_res_u.stat.size != strlen(data))) {
+		log_error(ss_debug_level, "compound ran past the failed op");
+		goto cleanup;
+	}
+	xdr_free((xdrproc_t)xdr_ss_compound_res, (char *)&res);
+	memset(&res, 0, sizeof(res));
+
+	/* a cap with a broken mac runs nothing */
+	memcpy(&bad_cap, cap, sizeof(lwfs_cap));
+	bad_cap.mac[0] ^= 0xff;
+
+	rc = lwfs_compound_sync(txn, ops, 1, &bad_cap, &res);
+	if ((rc == LWFS_OK) || (res.results.results_len != 0)) {
+		log_error(ss_debug_level, "compound with a bad cap: rc=%s, %u results",
+				lwfs_err_str(rc), res.results.results_len);
+		goto cleanup;
+	}
+
+	result = PASSED;
+
+cleanup:
+	xdr_free((xdrproc_t)xdr_ss_compound_res, (char *)&res);
+	lwfs_remove_obj_sync(txn, obj, cap);
+	return result;
+}
+
+/**
+ * Harvest one vector of requests from a completion queue. 
+ *
+ * The requests went to different servers, so the test only passes 
+ * when a single harvest collects all of them. 
+ */
+static int harvest_vector(
+		lwfs_completion_queue *cq, 
+		lwfs_request *reqs, 
+		const int count)
+{
+	int rc = LWFS_OK;
+	lwfs_request *done[2];
+	int num_done = 0;
+	int i;
+
+	/* give both servers time to answer, so the results are 
+	 * already queued when we harvest */
+	sleep(1);
+
+	rc = lwfs_cq_harvest(cq, -1, done, count, &num_done);
+	if (rc != LWFS_OK) {
+		log_error(ss_debug_level, "harvest failed: %s",
+				lwfs_err_str(rc));
+		return FAILED;
+	}
+	if (num_done != count) {
+		log_error(ss_debug_level, "harvested %d of %d requests in one pass",
+				num_done, count);
+		return FAILED;
+	}
+	for (i=0; i<count; i++) {
+		if (reqs[i].status != LWFS_REQUEST_COMPLETE) {
+			log_error(ss_debug_level, "request to server %d failed: %s",
+					i, lwfs_err_str(reqs[i].error_code));
+			return FAILED;
+		}
+	}
+
+	return PASSED;
+}
+
+/**
+ * Test vector submission: write and read one object on each of 
+ * two storage servers through one completion queue. 
+ */
+static int vector_test(
+		const lwfs_txn *txn, 
+		const lwfs_obj *obj, 
+		const lwfs_service *svc2, 
+		const lwfs_cap *cap, 
+		const char *data)
+{
+	int rc = LWFS_OK;
+	int result = FAILED;
+	lwfs_completion_queue cq;
+	lwfs_obj objs[2];
+	lwfs_obj_extent extents[2];
+	lwfs_request reqs[2];
+	lwfs_size bytes[2];
+	char input[2][256];
+	int num_sent = 0;
+	int i;
+
+	/* the same object on both servers */
+	memcpy(&objs[0], obj, sizeof(lwfs_obj));
+	lwfs_init_obj(svc2, 0, obj->cid, obj->oid, &objs[1]);
+
+	rc = lwfs_cq_init(2, &cq);
+	if (rc != LWFS_OK) {
+		log_error(ss_debug_level, "could not create completion queue: %s",
+				lwfs_err_str(rc));
+		return FAILED;
+	}
+
+	for (i=0; i<2; i++) {
+		rc = lwfs_create_obj_sync(txn, &objs[i], cap);
+		if (rc != LWFS_OK) {
+			log_error(ss_debug_level, "could not create obj on server %d: %s",
+					i, lwfs_err_str(rc));
+			goto cleanup;
+		}
+	}
+
+	/* write to both servers in one vector */
+	memset(reqs, 0, sizeof(reqs));
+	for (i=0; i<2; i++) {
+		extents[i].obj = &objs[i];
+		extents[i].offset = 0;
+		extents[i].buf = (void *)data;
+		extents[i].len = strlen(data);
+	}
+	rc = lwfs_writev(txn, extents, 2, cap, &cq, reqs, &num_sent);
+	if ((rc != LWFS_OK) || (num_sent != 2)) {
+		log_error(ss_debug_level, "sent %d of 2 writes: %s",
+				num_sent, lwfs_err_str(rc));
+		goto cleanup;
+	}
+	if (harvest_vector(&cq, reqs, 2) != PASSED) {
+		goto cleanup;
+	}
+
+	/* read them back the same way */
+	memset(reqs, 0, sizeof(reqs));
+	memset(input, 0, sizeof(input));
+	for (i=0; i<2; i++) {
+		extents[i].buf = input[i];
+		extents[i].len = sizeof(input[i]);
+	}
+	rc = lwfs_readv(txn, extents, 2, cap, bytes, &cq, reqs, &num_sent);
+	if ((rc != LWFS_OK) || (num_sent != 2)) {
+		log_error(ss_debug_level, "sent %d of 2 reads: %s",
+				num_sent, lwfs_err_str(rc));
+		goto cleanup;
+	}
+	if (harvest_vector(&cq, reqs, 2) != PASSED) {
+		goto cleanup;
+	}
+	for (i=0; i<2; i++) {
+		if ((bytes[i] != strlen(data)) || (strcmp(data, input[i]) != 0)) {
+			log_error(ss_debug_level, "server %d: expected \"%s\", read %d bytes \"%s\"",
+					i, data, (int)bytes[i], input[i]);
+			goto cleanup;
+		}
+	}
+
+	result = PASSED;
+
+cleanup:
+	for (i=0; i<2; i++) {
+		lwfs_remove_obj_sync(txn, &objs[i], cap);
+	}
+	lwfs_cq_fini(&cq);
+	return result;
+}
+
 /**
  * Tests a single SS client. 
  */
@@ -71,6 +329,7 @@ int main(int argc, char *argv[])
 	
 	lwfs_remote_pid authr_id; 
 	lwfs_remote_pid ss_id; 
+	lwfs_remote_pid ss2_id; 
 
 	/* arguments */
 	struct gengetopt_args_info args_info; 
@@ -78,6 +337,7 @@ int main(int argc, char *argv[])
 	/* variables used in the test */
 	lwfs_service storage_svc;   /* service descriptor for the storage service */
 	lwfs_service authr_svc;  /* service descriptor for the authorization service */
+	lwfs_service storage_svc2;  /* the second storage service (vector test) */
 
 	lwfs_txn *txn = NULL;
 	lwfs_cred cred; 
@@ -85,6 +345,8 @@ int main(int argc, char *argv[])
 	lwfs_cap cap;
 	
 	lwfs_oid cli_oid; /* the oid provided on the command-line */
+
+	double start;     /* used to report the latency of the test */
 	
 	rpc_debug_level = LOG_ALL;
 
@@ -131,6 +393,18 @@ int main(int argc, char *argv[])
 		return rc; 
 	}
 
+	/* the vector test also needs a second storage server */
+	if (strcmp("vector", args_info.test_arg) == 0) {
+		ss2_id.nid = args_info.ss_nid_arg; 
+		ss2_id.pid = args_info.vector_ss_pid_arg; 
+		rc = lwfs_get_service(ss2_id, &storage_svc2);
+		if (rc != LWFS_OK) {
+			log_error(ss_debug_level, "unable to get second storage service descriptor: %s",
+					lwfs_err_str(rc));
+			return rc; 
+		}
+	}
+
 	str_to_oid(args_info.oid_arg, cli_oid);
 	log_debug(ss_debug_level, "oid=0x%s", lwfs_oid_to_string(cli_oid, ostr));
 	
@@ -165,6 +439,7 @@ int main(int argc, char *argv[])
         uint64_t *id=(uint64_t *)cli_oid;
         struct async_req *async_reqs=calloc(args_info.num_objs_arg, sizeof(struct async_req));
         int async_op = FALSE;
+	start = lwfs_get_time();
 	for (i=0; i<args_info.num_objs_arg; i++) {
 	    /* assign the object for this operation */
 	    lwfs_obj *obj = &obj_array[i]; 
@@ -414,6 +689,24 @@ int main(int argc, char *argv[])
 		}
 	    }
 
+	    /* COMPOUND */
+	    else if (strcmp("compound", args_info.test_arg) == 0) {
+		log_debug(ss_debug_level, "calling lwfs_compound(oid=0x%s)", 
+			lwfs_oid_to_string(cli_oid, ostr));
+		rc = compound_test(txn, obj, &cap, args_info.data_arg);
+		if (rc != PASSED)
+		    break;
+	    }
+
+	    /* VECTOR */
+	    else if (strcmp("vector", args_info.test_arg) == 0) {
+		log_debug(ss_debug_level, "calling lwfs_writev/lwfs_readv(oid=0x%s)", 
+			lwfs_oid_to_string(cli_oid, ostr));
+		rc = vector_test(txn, obj, &storage_svc2, &cap, args_info.data_arg);
+		if (rc != PASSED)
+		    break;
+	    }
+
 	    else {
 		log_error(ss_debug_level, "unrecognized test=%s", 
 			args_info.test_arg);
@@ -455,6 +748,14 @@ int main(int argc, char *argv[])
 	}
 	free(async_reqs);
 
+	/* e.g., compare create and stat (open) latency across layouts */
+	if ((rc == LWFS_OK) && (args_info.num_objs_arg > 0)) {
+		double elapsed = lwfs_get_time() - start;
+		fprintf(stdout, "%s: %d ops in %1.6f s (%1.3f us/op)\n",
+				args_info.test_arg, args_info.num_objs_arg, elapsed,
+				1.0e6*elapsed/args_info.num_objs_arg);
+	}
+
 cleanup:
 	free(obj_array);
 	cmdline_parser_free (&args_info);
@@ -14,10 +14,12 @@
 #include <unistd.h>
 #include <argp.h>
 #include <string.h>
+#include <pthread.h>
 
 #include "support/threadpool/thread_pool.h"
 #include "support/threadpool/thread_pool_options.h"
 #include "support/threadpool/thread_pool_debug.h"
+#include "support/timer/timer.h"
 
 
 log_level xfer_debug_level = LOG_UNDEFINED; 
@@ -43,6 +45,18 @@ struct arguments {
 	/** @brief The number of experiments to run. */
 	int count; 
 
+	/** @brief Measure dispatch latency and throughput instead. */
+	int bench; 
+
+	/** @brief Number of requests per benchmark run. */
+	int num_reqs; 
+
+	/** @brief Largest pool to benchmark (1, 2, 4, ... max-threads). */
+	int max_threads; 
+
+	/** @brief Check that short requests do not wait for a long one. */
+	int long_short; 
+
 	/** @brief Options to control the thread pool behavior */
 	struct thread_pool_options tp_opts;
 }; 
@@ -61,6 +75,10 @@ static int print_args(FILE *fp, const char *prefix, struct arguments *args)
 	fprintf(fp, "%s \t--verbose = %d\n", prefix, args->debug_level);
 	fprintf(fp, "%s \t--count = %d\n", prefix, args->count);
 	fprintf(fp, "%s \t--thread-debug-level = %d\n", prefix, args->thread_debug_level);
+	fprintf(fp, "%s \t--bench = %s\n", prefix, (args->bench)? "true" : "false");
+	fprintf(fp, "%s \t--num-reqs = %d\n", prefix, args->num_reqs);
+	fprintf(fp, "%s \t--max-threads = %d\n", prefix, args->max_threads);
+	fprintf(fp, "%s \t--long-short = %s\n", prefix, (args->long_short)? "true" : "false");
 	print_thread_pool_opts(fp, &args->tp_opts, prefix);
 	return 0;
 }
@@ -70,6 +88,10 @@ static struct argp_option options[] = {
 	{"verbose",    1, "<0=none,1=fatal,2=error,3=warn,4=info,5=debug,6=all>", 0, "Produce verbose output"},
 	{"count",      3, "<val>", 0, "Number of tests to run"},
 	{"thread-debug-level",    2, "<0=none,1=fatal,2=error,3=warn,4=info,5=debug,6=all>", 0, "Produce verbose output"},
+	{"bench",      4, 0, 0, "Measure dispatch latency and requests/sec vs. thread count"},
+	{"num-reqs",   5, "<val>", 0, "Number of requests per benchmark run"},
+	{"max-threads", 6, "<val>", 0, "Largest pool to benchmark"},
+	{"long-short", 7, 0, 0, "Check that short requests do not wait behind a long one"},
 	THREAD_POOL_OPTIONS,
 
 	{ 0 }
@@ -108,6 +130,22 @@ static error_t parse_opt(
 			arguments->count= atoi(arg);
 			break;
 
+		case 4: /* bench */
+			arguments->bench = 1;
+			break;
+
+		case 5: /* num-reqs */
+			arguments->num_reqs = atoi(arg);
+			break;
+
+		case 6: /* max-threads */
+			arguments->max_threads = atoi(arg);
+			break;
+
+		case 7: /* long-short */
+			arguments->long_short = 1;
+			break;
+
 		case ARGP_KEY_ARG:
 			/* we don't expect any arguments */
 			if (state->arg_num >= 0) {
@@ -155,6 +193,228 @@ static int process_request(
 }
 
 
+/* ----------------------- benchmark --------------------------- */
+
+struct bench_req {
+	double t_submit;   /* when the request went into the pool  */
+	double latency;    /* time until a thread started it (sec) */
+};
+
+static pthread_mutex_t bench_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t bench_cond = PTHREAD_COND_INITIALIZER;
+static volatile int bench_done = 0;
+static int bench_expected = 0;
+
+/* an empty request: note the dispatch latency and count it */
+static int bench_request(
+	struct lwfs_thread_pool_request *a_request,
+	const int thread_id)
+{
+	struct bench_req *req = (struct bench_req *)(a_request->client_data);
+
+	req->latency = lwfs_get_time() - req->t_submit;
+
+	if (__sync_add_and_fetch(&bench_done, 1) == bench_expected) {
+		pthread_mutex_lock(&bench_mutex);
+		pthread_cond_signal(&bench_cond);
+		pthread_mutex_unlock(&bench_mutex);
+	}
+	return 0;
+}
+
+/* wait for bench_expected requests to finish */
+static void bench_wait(void)
+{
+	pthread_mutex_lock(&bench_mutex);
+	while (bench_done < bench_expected) {
+		pthread_cond_wait(&bench_cond, &bench_mutex);
+	}
+	pthread_mutex_unlock(&bench_mutex);
+}
+
+static void bench_latency_stats(
+	struct bench_req *reqs,
+	const int n,
+	double *avg,
+	double *max)
+{
+	int i;
+
+	*avg = 0.0;
+	*max = 0.0;
+	for (i=0; i<n; i++) {
+		*avg += reqs[i].latency;
+		if (reqs[i].latency > *max) {
+			*max = reqs[i].latency;
+		}
+	}
+	if (n > 0) {
+		*avg /= n;
+	}
+}
+
+/**
+ * @brief Measure the pool with 1, 2, 4, ... max_threads threads.
+ *
+ * For each pool size, we first submit one request at a time and
+ * wait for it (the time until a thread starts the request is the
+ * dispatch latency of an idle pool), then submit all the requests
+ * at once (requests/sec with the queue always full).
+ */
+static int run_bench(FILE *fp, struct arguments *args)
+{
+	int i, n;
+	int num_pings;
+	double t_start, elapsed;
+	double ping_avg, ping_max, burst_avg, burst_max;
+	lwfs_thread_pool pool;
+	struct thread_pool_options tp_opts;
+	struct bench_req *reqs;
+
+	reqs = (struct bench_req *)calloc(args->num_reqs, sizeof(struct bench_req));
+	if (reqs == NULL) {
+		fprintf(stderr, "out of memory\n");
+		return -1;
+	}
+
+	num_pings = (args->num_reqs < 1000)? args->num_reqs : 1000;
+
+	fprintf(fp, "%% threads  reqs  ping-avg(us)  ping-max(us)  "
+			"burst-time(s)  reqs/sec  burst-avg(us)  burst-max(us)\n");
+
+	for (n=1; n<=args->max_threads; n*=2) {
+
+		memcpy(&tp_opts, &args->tp_opts, sizeof(struct thread_pool_options));
+		tp_opts.initial_thread_count = n;
+		tp_opts.min_thread_count = n;
+		tp_opts.max_thread_count = n;
+		tp_opts.high_watermark = args->num_reqs + 1;
+		tp_opts.queue_high_watermark = 0;
+
+		lwfs_thread_pool_init(&pool, &tp_opts);
+
+		/* one request at a time */
+		bench_done = 0;
+		for (i=0; i<num_pings; i++) {
+			bench_expected = i+1;
+			reqs[i].t_submit = lwfs_get_time();
+			lwfs_thread_pool_add_request(&pool, &reqs[i], bench_request);
+			bench_wait();
+		}
+		bench_latency_stats(reqs, num_pings, &ping_avg, &ping_max);
+
+		/* everything at once */
+		bench_done = 0;
+		bench_expected = args->num_reqs;
+		t_start = lwfs_get_time();
+		for (i=0; i<args->num_reqs; i++) {
+			reqs[i].t_submit = lwfs_get_time();
+			lwfs_thread_pool_add_request(&pool, &reqs[i], bench_request);
+		}
+		bench_wait();
+		elapsed = lwfs_get_time() - t_start;
+		bench_latency_stats(reqs, args->num_reqs, &burst_avg, &burst_max);
+
+		fprintf(fp, "%9d  %d  %12.2f  %12.2f  %13.6f  %8.0f  %13.2f  %13.2f\n",
+				n, args->num_reqs, ping_avg*1e6, ping_max*1e6,
+				elapsed, args->num_reqs/elapsed, burst_avg*1e6, burst_max*1e6);
+
+		if (logging_info(thread_debug_level)) {
+			fprint_lwfs_thread_pool_stats(fp, "%", &pool);
+		}
+
+		lwfs_thread_pool_fini(&pool);
+	}
+
+	free(reqs);
+	return 0;
+}
+
+
+/* ----------------------- long/short ------------------------- */
+
+/* seconds the long request runs */
+#define LONG_SLEEP 2
+
+/* short requests submitted after the long one */
+#define NUM_SHORT 16
+
+struct timed_req {
+	int sleep_time;    /* seconds to run                    */
+	double t_done;     /* when the request finished         */
+};
+
+static int timed_request(
+	struct lwfs_thread_pool_request *a_request,
+	const int thread_id)
+{
+	struct timed_req *req = (struct timed_req *)(a_request->client_data);
+
+	if (req->sleep_time > 0) {
+		sleep(req->sleep_time);
+	}
+	req->t_done = lwfs_get_time();
+	return 0;
+}
+
+/**
+ * @brief Check that short requests do not wait for a long one.
+ *
+ * One long request and NUM_SHORT short ones go into a pool of two
+ * threads whose batch size lets one thread take all of them.  The
+ * thread that starts the long request keeps the short ones in its
+ * local queue, so the other thread has to steal them (it must not
+ * sleep while they are there).  Every short request has to finish
+ * before the long one does.
+ */
+static int run_long_short(FILE *fp, struct arguments *args)
+{
+	int i;
+	int rc = 0;
+	double t_start, t_short = 0.0;
+	lwfs_thread_pool pool;
+	struct thread_pool_options tp_opts;
+	struct timed_req reqs[NUM_SHORT+1];
+
+	memcpy(&tp_opts, &args->tp_opts, sizeof(struct thread_pool_options));
+	tp_opts.initial_thread_count = 2;
+	tp_opts.min_thread_count = 2;
+	tp_opts.max_thread_count = 2;
+	tp_opts.high_watermark = NUM_SHORT + 2;
+	tp_opts.queue_high_watermark = 0;
+	tp_opts.batch_size = NUM_SHORT + 1;
+
+	lwfs_thread_pool_init(&pool, &tp_opts);
+
+	memset(reqs, 0, sizeof(reqs));
+	reqs[0].sleep_time = LONG_SLEEP;
+
+	t_start = lwfs_get_time();
+	for (i=0; i<=NUM_SHORT; i++) {
+		lwfs_thread_pool_add_request(&pool, &reqs[i], timed_request);
+	}
+
+	/* waits for every request */
+	lwfs_thread_pool_fini(&pool);
+
+	for (i=1; i<=NUM_SHORT; i++) {
+		if (reqs[i].t_done > t_short) {
+			t_short = reqs[i].t_done;
+		}
+	}
+
+	fprintf(fp, "%% long request: %f sec, last short request: %f sec\n",
+			reqs[0].t_done - t_start, t_short - t_start);
+
+	if (t_short >= reqs[0].t_done) {
+		fprintf(fp, "short requests waited for the long one\n");
+		rc = -1;
+	}
+
+	return rc;
+}
+
+
 /**
  * @brief The LWFS xfer-server.
  */
@@ -172,6 +432,9 @@ int main(int argc, char **argv)
 	args.debug_level = 0;
 	args.count = 10;  /* run forever */
 	args.thread_debug_level = 2; 
+	args.bench = 0;
+	args.num_reqs = 100000;
+	args.max_threads = 16;
 
 
 	/* defaults for thread pool */
@@ -189,6 +452,16 @@ int main(int argc, char **argv)
 	print_args(stdout, "", &args);
 
 
+	if (args.bench) {
+		return run_bench(stdout, &args);
+	}
+
+	if (args.long_short) {
+		rc = run_long_short(stdout, &args);
+		fprintf(stdout, (rc == 0)? "PASSED\n" : "FAILED\n");
+		return rc;
+	}
+
 	/* allocate a thread pool */
 	lwfs_thread_pool_init(&pool, &args.tp_opts);
 